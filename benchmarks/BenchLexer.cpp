@@ -0,0 +1,78 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <stdlib.h>
+
+#include "../src/Lexer.h"
+#include "../src/utilities.h"
+
+using namespace std;
+
+
+/* Benchmarks lex_line on a large expanded program, and compares it with tokenize_line followed by the string classifiers.
+ * The program is the expansion of an N component dot product, as the Preprocessor writes it:
+ *	declare intvar z.i, define z.i = mul x.i w.i, and the sums of the products, some of them scaled by constants.
+ *
+ * Usage: ./bench_lexer [number of components]	(defaults to 10^6)
+ *
+ * Reports the size of the program, and the time and rate (in MB/s) of each way of reading it.
+ */
+
+
+/* Returns the number of seconds since START. */
+double seconds_since(chrono::steady_clock::time_point start) {
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+
+int main(int argc, char *argv[]) {
+
+	long num_components = (argc > 1 ? atol(argv[1]) : 1000000);
+
+	vector<string> lines;
+	size_t num_bytes = 0;
+	for (long i = 0; i < num_components; i++) {
+		string index = to_string(i);
+		lines.push_back("declare intvar z." + index);
+		lines.push_back("define z." + index + " = mul x." + index + " w." + index);
+		lines.push_back("declare intvar s." + index);
+		lines.push_back(i % 2 == 0 ? "define s." + index + " = add z." + index + " 0.5" : "define s." + index + " = mul z." + index + " -1");
+	}
+	for (size_t i = 0; i < lines.size(); i++) num_bytes += lines[i].length() + 1;
+	double megabytes = num_bytes / 1e6;
+
+	// lex every line, reusing one vector of Tokens
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	vector<Token> tokens;
+	long num_numbers = 0;
+	for (size_t i = 0; i < lines.size(); i++) {
+		lex_line(lines[i], ' ', &tokens);
+		for (size_t t = 0; t < tokens.size(); t++) num_numbers += tokens[t].token_class == TokenClass::NUMBER;
+	}
+	double lex_seconds = seconds_since(start);
+
+	// tokenize every line into strings, and classify the tokens the way the phases did before the Lexer
+	start = chrono::steady_clock::now();
+	long num_string_numbers = 0;
+	for (size_t i = 0; i < lines.size(); i++) {
+		vector<string> string_tokens;
+		tokenize_line(lines[i], &string_tokens, " ");
+		get_instruction_type(string_tokens[0]);
+		for (size_t t = 1; t < string_tokens.size(); t++) {
+			num_string_numbers += is_constant(string_tokens[t]);
+			get_operation_type(string_tokens[t]);
+		}
+	}
+	double tokenize_seconds = seconds_since(start);
+
+	cout << "lines:                  " << lines.size() << endl;
+	cout << "program size (MB):      " << megabytes << endl;
+	cout << "numbers found:          " << num_numbers << " (" << num_string_numbers << " by tokenize_line)" << endl;
+	cout << "lex_line time (s):      " << lex_seconds << endl;
+	cout << "lex_line rate (MB/s):   " << megabytes / lex_seconds << endl;
+	cout << "tokenize_line time (s): " << tokenize_seconds << endl;
+	cout << "tokenize_line rate (MB/s): " << megabytes / tokenize_seconds << endl;
+
+	return 0;
+}
@@ -0,0 +1,144 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <stdlib.h>
+
+#include "../src/Preprocessor.h"
+#include "../src/OutputSink.h"
+
+using namespace std;
+
+
+/* Benchmarks writing a large Expanded Program, and counts the write system calls it takes.
+ * The Shape Program has N blocks, each of which multiplies two BLOCK_DIMENSION component vectors component-wise,
+ *  and takes their dot product, so its expansion has about 6 * BLOCK_DIMENSION * N lines.
+ *
+ * Usage: ./bench_output_sink [number of blocks]	(defaults to 1000)
+ *
+ * Compares ways of writing the same Expanded Program:
+ *  - its lines written to an ofstream flushed after every line with endl, as the Preprocessor and Compiler used to write,
+ *  - its lines written through an OutputSink,
+ *  - the Preprocessor expanding it and writing it through an OutputSink, with and without a background writer.
+ * Reports the time and the write system calls of each (counted by the kernel, in /proc/self/io).
+ */
+
+static const char *SHAPE_PROG_FILENAME = "bench_output_sink_shape.tf";
+static const char *EXP_PROG_FILENAME = "bench_output_sink_expanded.tf";
+
+/* The number of components in each block's vectors. */
+static const int BLOCK_DIMENSION = 1000;
+
+
+/* Returns the number of seconds since START. */
+double seconds_since(chrono::steady_clock::time_point start) {
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+
+/* Returns the name of PREFIX's vector in block B. Vector names cannot have digits, so B is spelled in letters. */
+string block_name(const string& prefix, long b) {
+	string name = prefix;
+	do {
+		name += (char) ('a' + b % 26);
+		b /= 26;
+	} while (b > 0);
+	return name;
+}
+
+
+/* Returns the number of write system calls this process has made, or -1 if the kernel does not say. */
+long count_write_syscalls() {
+	ifstream io("/proc/self/io");
+	string field;
+	long value;
+	while (io >> field >> value) {
+		if (field == "syscw:") return value;
+	}
+	return -1;
+}
+
+
+/* Expands the Shape Program into the Expanded Program file, and prints the time and write system calls it took. */
+void bench_preprocessor(const string& name, bool background_writer) {
+	Preprocessor p;
+	p.set_background_writer(background_writer);
+
+	long writes_before = count_write_syscalls();
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	int success = p.expand_program(SHAPE_PROG_FILENAME, EXP_PROG_FILENAME);
+	double seconds = seconds_since(start);
+	long writes = count_write_syscalls() - writes_before;
+
+	if (success != 0) cout << name << " failed with error " << success << endl;
+	cout << name << " time (s): " << seconds << endl;
+	cout << name << " write syscalls: " << writes << endl;
+}
+
+
+int main(int argc, char *argv[]) {
+
+	long num_blocks = (argc > 1 ? atol(argv[1]) : 1000);
+
+	ofstream shape_prog(SHAPE_PROG_FILENAME);
+	for (long b = 0; b < num_blocks; b++) {
+		string x = block_name("x", b), w = block_name("w", b), z = block_name("z", b), y = block_name("y", b);
+		shape_prog << "declare_vector input " << x << " " << BLOCK_DIMENSION << '\n';
+		shape_prog << "declare_vector weight " << w << " " << BLOCK_DIMENSION << '\n';
+		shape_prog << "declare_vector intvar " << z << " " << BLOCK_DIMENSION << '\n';
+		shape_prog << "define_vector " << z << " = mul " << x << " " << w << '\n';
+		shape_prog << "declare output " << y << '\n';
+		shape_prog << "define " << y << " = dot " << x << " " << w << '\n';
+	}
+	shape_prog.close();
+
+	// the Expanded Program, as every way of writing it writes it
+	stringstream expanded;
+	Preprocessor p;
+	p.expand_program(SHAPE_PROG_FILENAME, EXP_PROG_FILENAME);
+	ifstream exp_prog(EXP_PROG_FILENAME);
+	expanded << exp_prog.rdbuf();
+	exp_prog.close();
+	string text = expanded.str();
+
+	long num_lines = 0;
+	for (size_t i = 0; i < text.length(); i++) num_lines += text[i] == '\n';
+	cout << "lines:                        " << num_lines << endl;
+	cout << "program size (MB):            " << text.length() / 1e6 << endl;
+
+	// write the lines with endl, flushing after each one
+	long writes_before = count_write_syscalls();
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	ofstream endl_file(EXP_PROG_FILENAME);
+	string line;
+	while (getline(expanded, line)) endl_file << line << endl;
+	endl_file.close();
+	double endl_seconds = seconds_since(start);
+	long endl_writes = count_write_syscalls() - writes_before;
+	cout << "endl time (s):                " << endl_seconds << endl;
+	cout << "endl write syscalls:          " << endl_writes << endl;
+
+	// write the same lines through an OutputSink
+	expanded.clear();
+	expanded.seekg(0);
+	writes_before = count_write_syscalls();
+	start = chrono::steady_clock::now();
+	OutputSink sink;
+	sink.open(EXP_PROG_FILENAME);
+	ostream sink_file(&sink);
+	while (getline(expanded, line)) sink_file << line << '\n';
+	sink.close();
+	double sink_seconds = seconds_since(start);
+	long sink_writes = count_write_syscalls() - writes_before;
+	cout << "sink time (s):                " << sink_seconds << endl;
+	cout << "sink write syscalls:          " << sink_writes << " (" << sink.get_num_writes() << " counted by the sink)" << endl;
+
+	// expand the Shape Program again, timing the expansion along with the writing
+	bench_preprocessor("expand + sink", false);
+	bench_preprocessor("expand + background sink", true);
+
+	remove(SHAPE_PROG_FILENAME);
+	remove(EXP_PROG_FILENAME);
+	return 0;
+}
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#include "../src/DataFlowGraph.h"
+
+using namespace std;
+
+
+/* Benchmarks building a DataFlowGraph, and DataFlowGraph::top_sort, on a reduce_vector-like chain.
+ * The graph is the expansion of "define loss = reduce_vector x add" over an N/2 element vector:
+ *	acc.0 = add x.0 0, acc.i = add acc.(i-1) x.i, and the last accumulator is the loss.
+ * This is the deepest graph of N nodes the Preprocessor can produce.
+ *
+ * Usage: ./bench_top_sort [number of nodes]	(defaults to 10^7)
+ *
+ * Reports the time (and rate) to build the graph, the bytes of graph storage per node, the time to sort it,
+ *  and the peak resident set size before and after the sort.
+ * The sort itself needs 4 bytes per node for the result, 1 for the marks and at most 4 for the stack.
+ */
+
+
+/* Returns the peak resident set size of this process in megabytes. */
+double peak_rss_mb() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss / 1024.0;
+}
+
+
+int main(int argc, char *argv[]) {
+
+	long num_nodes = (argc > 1 ? atol(argv[1]) : 10000000);
+	long length = num_nodes / 2;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	DataFlowGraph dfg;
+	string prev_acc_name = "0";
+	for (long i = 0; i < length; i++) {
+		string x_name = "x." + to_string(i), acc_name = "acc." + to_string(i);
+
+		dfg.add_node(x_name, VariableType::INPUT);
+		dfg.add_node(acc_name, i == length - 1 ? VariableType::LOSS : VariableType::INTVAR);
+		dfg.set_operation(dfg.get_node(acc_name), OperationType::ADD);
+
+		dfg.add_flow_edge(prev_acc_name, acc_name);
+		dfg.add_flow_edge(x_name, acc_name);
+		prev_acc_name = acc_name;
+	}
+
+	// the parents are built lazily, so ask for them once to include them in the build
+	dfg.has_parent(0);
+
+	chrono::steady_clock::time_point built = chrono::steady_clock::now();
+	double rss_before_sort = peak_rss_mb();
+	double build_seconds = chrono::duration<double>(built - start).count();
+
+	vector<uint32_t> sorted_ids;
+	dfg.top_sort(&sorted_ids);
+
+	chrono::steady_clock::time_point sorted = chrono::steady_clock::now();
+
+	cout << "nodes:                  " << dfg.get_num_nodes() << endl;
+	cout << "sorted nodes:           " << sorted_ids.size() << endl;
+	cout << "build time (s):         " << build_seconds << endl;
+	cout << "build rate (nodes/s):   " << dfg.get_num_nodes() / build_seconds << endl;
+	cout << "graph bytes per node:   " << (double) dfg.get_bytes_allocated() / dfg.get_num_nodes() << endl;
+	cout << "sort time (s):          " << chrono::duration<double>(sorted - built).count() << endl;
+	cout << "peak RSS before sort:   " << rss_before_sort << " MB" << endl;
+	cout << "peak RSS after sort:    " << peak_rss_mb() << " MB" << endl;
+
+	return 0;
+}
@@ -0,0 +1,237 @@
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+#include <new>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <linux/futex.h>
+#include <unistd.h>
+
+#include "Allreduce.h"
+#include "DenseVector.h"
+
+using namespace std;
+
+
+Communicator::~Communicator() {
+}
+
+
+Worker::~Worker() {
+}
+
+
+/* The start of the shared memory. The atomics are lock-free, so they work between processes as they do between threads. */
+struct SharedHeader {
+	/* Incremented every time every worker has reached the barrier, and by an abort. Workers sleep on it. */
+	atomic<uint32_t> generation;
+	/* The number of workers that have reached the barrier since the generation last changed. */
+	atomic<uint32_t> num_arrived;
+	/* The error the group was aborted with, or 0. */
+	atomic<int32_t> error;
+};
+
+
+/* Sleeps until *ADDRESS is no longer EXPECTED, or until it is woken (possibly for nothing), if *ADDRESS is EXPECTED when it is called. */
+static void futex_wait(atomic<uint32_t> *address, uint32_t expected) {
+	syscall(SYS_futex, (uint32_t *) address, FUTEX_WAIT, expected, NULL, NULL, 0);
+}
+
+
+/* Wakes every process sleeping on ADDRESS. */
+static void futex_wake_all(atomic<uint32_t> *address) {
+	syscall(SYS_futex, (uint32_t *) address, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+
+
+/* ---------------- Constructor/Destructor --------------- */
+
+SharedMemoryCommunicator::SharedMemoryCommunicator() {
+	memory = NULL;
+	num_bytes = 0;
+	header = NULL;
+	rows = NULL;
+	sums = NULL;
+	results = NULL;
+	rank = 0;
+	size = 0;
+	num_values = 0;
+}
+
+
+SharedMemoryCommunicator::~SharedMemoryCommunicator() {
+	if (memory != NULL) munmap(memory, num_bytes);
+}
+
+
+
+/* ---------------- Setup --------------- */
+
+int SharedMemoryCommunicator::open(size_t num_workers, size_t num_values) {
+	if (memory != NULL || num_workers == 0) return OTHER_ERROR;
+
+	// the header is padded to a whole cache line, so the rows of values do not share one with it
+	size_t header_bytes = 64;
+	num_bytes = header_bytes + (num_workers + 2) * max(num_values, (size_t) 1) * sizeof(double);
+	memory = mmap(NULL, num_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED) {
+		memory = NULL;
+		return OTHER_ERROR;
+	}
+
+	header = new (memory) SharedHeader();
+	header->generation.store(0);
+	header->num_arrived.store(0);
+	header->error.store(0);
+	rows = (double *) ((char *) memory + header_bytes);
+	sums = rows + num_workers * num_values;
+	results = sums + num_values;
+
+	rank = 0;
+	size = num_workers;
+	this->num_values = num_values;
+	return 0;
+}
+
+
+void SharedMemoryCommunicator::set_rank(size_t rank) {
+	this->rank = rank;
+}
+
+
+
+/* ---------------- Communication --------------- */
+
+int SharedMemoryCommunicator::barrier() {
+	uint32_t generation = header->generation.load(memory_order_acquire);
+
+	if (header->num_arrived.fetch_add(1, memory_order_acq_rel) + 1 == size) {
+		// the count is reset before the generation changes, so no worker can arrive at the next barrier before it is reset
+		header->num_arrived.store(0, memory_order_relaxed);
+		header->generation.fetch_add(1, memory_order_release);
+		futex_wake_all(&header->generation);
+	} else {
+		while (header->generation.load(memory_order_acquire) == generation) futex_wait(&header->generation, generation);
+	}
+
+	return header->error.load(memory_order_acquire);
+}
+
+
+int SharedMemoryCommunicator::allreduce_sum(double *values, size_t n) {
+	if (n > num_values) return OTHER_ERROR;
+	int error = header->error.load(memory_order_acquire);
+	if (error != 0) return error;
+
+	memcpy(rows + rank * num_values, values, n * sizeof(double));
+	error = barrier();
+	if (error != 0) return error;
+
+	// this worker sums its share of the columns, adding the rows in rank order
+	size_t first = rank * n / size, last = (rank + 1) * n / size;
+	memcpy(sums + first, rows + first, (last - first) * sizeof(double));
+	for (size_t r = 1; r < size; r++) {
+		dense_axpy(1, rows + r * num_values + first, sums + first, last - first);
+	}
+	error = barrier();
+	if (error != 0) return error;
+
+	memcpy(values, sums, n * sizeof(double));
+	return 0;
+}
+
+
+void SharedMemoryCommunicator::abort(int error) {
+	int32_t no_error = 0;
+	header->error.compare_exchange_strong(no_error, error, memory_order_acq_rel);
+
+	// changing the generation wakes every worker at the barrier, and keeps the ones about to sleep from sleeping
+	header->generation.fetch_add(1, memory_order_release);
+	futex_wake_all(&header->generation);
+}
+
+
+int SharedMemoryCommunicator::write_result(const double *values, size_t n) {
+	if (n > num_values) return OTHER_ERROR;
+	memcpy(results, values, n * sizeof(double));
+	return 0;
+}
+
+
+void SharedMemoryCommunicator::read_result(vector<double> *result) const {
+	result->assign(results, results + num_values);
+}
+
+
+
+/* ---------------- Accessors --------------- */
+
+int SharedMemoryCommunicator::get_error() const {
+	return header == NULL ? 0 : header->error.load(memory_order_acquire);
+}
+
+size_t SharedMemoryCommunicator::get_rank() const {
+	return rank;
+}
+
+size_t SharedMemoryCommunicator::get_size() const {
+	return size;
+}
+
+
+
+/* ---------------- Worker Processes --------------- */
+
+int run_worker_processes(size_t num_workers, size_t num_values, Worker *worker, vector<double> *result) {
+
+	SharedMemoryCommunicator communicator;
+	if (communicator.open(num_workers, num_values) != 0) return OTHER_ERROR;
+
+	vector<pid_t> pids;
+	for (size_t r = 0; r < num_workers; r++) {
+		pid_t pid = fork();
+		if (pid == 0) {
+			// a worker never returns: it leaves without running the exit handlers of the process it was forked from
+			communicator.set_rank(r);
+			int error = worker->run(&communicator);
+			if (error != 0) communicator.abort(error);
+			_exit(error == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+		if (pid < 0) {
+			communicator.abort(OTHER_ERROR);
+			break;
+		}
+		pids.push_back(pid);
+	}
+
+	// the workers are waited for in the order they finish, since one that dies cannot abort the others itself,
+	//  and they would wait for it forever
+	// only the workers are polled, so the exit statuses of this process's other children are left for whoever waits for them
+	vector<bool> finished(pids.size(), false);
+	size_t num_running = pids.size();
+	while (num_running > 0) {
+		bool any_finished = false;
+		for (size_t w = 0; w < pids.size(); w++) {
+			if (finished[w]) continue;
+			int status = 0;
+			pid_t pid = waitpid(pids[w], &status, WNOHANG);
+			if (pid == 0 || (pid < 0 && errno == EINTR)) continue;
+
+			// a worker whose status cannot be had (because someone else waited for it) is taken to have failed
+			finished[w] = true;
+			any_finished = true;
+			num_running--;
+			if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) communicator.abort(OTHER_ERROR);
+		}
+		if (!any_finished && num_running > 0) usleep(1000);
+	}
+
+	int error = communicator.get_error();
+	if (error == 0) communicator.read_result(result);
+	return error;
+}
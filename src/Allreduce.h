@@ -0,0 +1,144 @@
+#ifndef ALLREDUCE_H
+#define ALLREDUCE_H
+
+#include <vector>
+#include <cstdint>
+
+#include "utilities.h"
+
+using namespace std;
+
+
+/* This file defines how the worker processes of data-parallel training combine their gradients.
+ * Every worker holds a shard of the training data, computes the sum of the partials over its shard, and then all the workers
+ *  sum their sums with an allreduce: afterwards, every worker holds the same total, and takes the same step with it.
+ *
+ * A Communicator is what a worker sees of the others: its rank, how many there are, and the allreduce.
+ * The workers of one machine share memory (see SharedMemoryCommunicator);
+ *  workers on other machines would implement the same interface over sockets, and the training code would not change.
+ */
+
+
+/* A Communicator connects one worker to the others of its group. */
+class Communicator {
+
+public:
+
+	virtual ~Communicator();
+
+	/* Returns the number of this worker, from 0 to the number of workers - 1. */
+	virtual size_t get_rank() const = 0;
+
+	/* Returns the number of workers. */
+	virtual size_t get_size() const = 0;
+
+	/* Replaces the N VALUES of every worker by their sum over all the workers. Every worker must call it, with the same N.
+	 * The sums are added in the same order for every worker, so every worker gets exactly the same values.
+	 * Returns 0 on success, or the error the group was aborted with (see abort), in which case VALUES are not summed.
+	 */
+	virtual int allreduce_sum(double *values, size_t n) = 0;
+
+	/* Stops the group: every worker waiting in an allreduce, or that starts one, gets ERROR (which is not 0) instead.
+	 * Only the first error a group is aborted with is kept.
+	 */
+	virtual void abort(int error) = 0;
+
+	/* Hands the N VALUES back to whoever started the workers (see run_worker_processes). Only worker 0 calls it. */
+	virtual int write_result(const double *values, size_t n) = 0;
+
+};
+
+
+/* A SharedMemoryCommunicator connects worker processes forked from one parent through memory they all share.
+ * The memory is mapped, shared and anonymous, before the workers are forked, and holds, for N values:
+ *
+ 	a header: the barrier (a generation number, and the number of workers that have reached it), and the error of an abort
+ 	one row of N values for every worker
+ 	the row of N sums
+ 	the row of N results, for the parent
+ *
+ * An allreduce is a reduce-scatter and an allgather: every worker writes its values into its own row, and waits at the barrier;
+ *  then it sums its own share of the columns over every row, in rank order, into the row of sums, and waits at the barrier again;
+ *  then it copies the whole row of sums. Every value is summed once, by one worker, so the work (and memory traffic) is split evenly.
+ * Workers wait at the barrier by sleeping on a futex on the generation number, which the last worker to arrive increments and wakes.
+ */
+class SharedMemoryCommunicator : public Communicator {
+
+private:
+
+	/* The shared memory, how many bytes it has, and where its parts begin. */
+	void *memory;
+	size_t num_bytes;
+	struct SharedHeader *header;
+	double *rows;
+	double *sums;
+	double *results;
+
+	size_t rank;
+	size_t size;
+	size_t num_values;
+
+	/* Waits until every worker has reached the barrier. Returns the error of an abort, if there was one, and 0 otherwise. */
+	int barrier();
+
+
+public:
+
+	/* Constructor. Creates a Communicator with no shared memory. */
+	SharedMemoryCommunicator();
+
+	/* Destructor. Unmaps the shared memory of this process. */
+	~SharedMemoryCommunicator();
+
+	/* Maps the shared memory for NUM_WORKERS workers, whose allreduces sum at most NUM_VALUES values.
+	 * Must be called before the workers are forked, so they all share it.
+	 * Returns OTHER_ERROR if there are no workers, or if the memory cannot be mapped, and 0 otherwise.
+	 */
+	int open(size_t num_workers, size_t num_values);
+
+	/* Makes this process worker RANK. Called in every worker, after it is forked. */
+	void set_rank(size_t rank);
+
+	/* Copies the result written by worker 0 (see write_result) into RESULT. */
+	void read_result(vector<double> *result) const;
+
+	/* Returns the error the group was aborted with, or 0 if it was not. */
+	int get_error() const;
+
+	size_t get_rank() const;
+	size_t get_size() const;
+	int allreduce_sum(double *values, size_t n);
+	void abort(int error);
+	int write_result(const double *values, size_t n);
+
+};
+
+
+/* A Worker is what every worker process runs (see run_worker_processes). Data-parallel training implements it (see GradientDescent.h). */
+class Worker {
+
+public:
+
+	virtual ~Worker();
+
+	/* Does the work of one worker, which talks to the others through COMMUNICATOR. Returns 0 on success, and an error code otherwise. */
+	virtual int run(Communicator *communicator) = 0;
+
+};
+
+
+/* Runs WORKER in NUM_WORKERS forked worker processes, which share a SharedMemoryCommunicator for NUM_VALUES values,
+ *  and waits for all of them. Every worker is a copy of this process: it holds whatever this process held when it was forked.
+ * A worker fails if WORKER returns an error, or if it dies (it is killed, or crashes): the others are then aborted,
+ *  and this process carries on, since every worker is a process of its own.
+ * The workers are waited for as they finish, by polling each of them, so the other children of this process are left alone.
+ * Writes the result of worker 0 (see Communicator::write_result) into RESULT.
+ *
+ * Returns the error of the first worker that failed, OTHER_ERROR if it died or the shared memory could not be mapped,
+ *  or if a worker could not be forked, and 0 otherwise.
+ */
+int run_worker_processes(size_t num_workers, size_t num_values, Worker *worker, vector<double> *result);
+
+
+
+#endif
@@ -0,0 +1,69 @@
+#include <stdlib.h>
+#include <new>
+
+#include "Arena.h"
+
+using namespace std;
+
+
+/* ---------------- Constructor/Destructor --------------- */
+
+Arena::Arena() {
+	blocks = new vector<char *>();
+	current = NULL;
+	remaining = 0;
+	bytes_allocated = 0;
+	bytes_reserved = 0;
+}
+
+
+Arena::~Arena() {
+	for (vector<char *>::iterator it = blocks->begin(); it != blocks->end(); ++it) {
+		free(*it);
+	}
+	delete blocks;
+}
+
+
+/* ---------------- Allocation -------------- */
+
+void *Arena::allocate(size_t num_bytes, size_t alignment) {
+
+	// large requests get a block of their own, so they don't waste the rest of the current block
+	if (num_bytes > ARENA_BLOCK_SIZE / 4) {
+		char *block = static_cast<char *>(malloc(num_bytes));
+		if (block == NULL) throw bad_alloc();
+		blocks->push_back(block);
+		bytes_allocated += num_bytes;
+		bytes_reserved += num_bytes;
+		return block;
+	}
+
+	// pad the current position up to the requested alignment
+	size_t padding = (alignment - (reinterpret_cast<uintptr_t>(current) & (alignment - 1))) & (alignment - 1);
+
+	// start a new block if this request doesn't fit in the current one
+	if (current == NULL || padding + num_bytes > remaining) {
+		current = static_cast<char *>(malloc(ARENA_BLOCK_SIZE));
+		if (current == NULL) throw bad_alloc();
+		blocks->push_back(current);
+		remaining = ARENA_BLOCK_SIZE;
+		bytes_reserved += ARENA_BLOCK_SIZE;
+		padding = 0;
+	}
+
+	char *result = current + padding;
+	current = result + num_bytes;
+	remaining -= padding + num_bytes;
+	bytes_allocated += num_bytes;
+	return result;
+}
+
+
+size_t Arena::get_bytes_allocated() const {
+	return bytes_allocated;
+}
+
+size_t Arena::get_bytes_reserved() const {
+	return bytes_reserved;
+}
@@ -0,0 +1,120 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+
+/* The size of the blocks an Arena reserves at a time. */
+#define ARENA_BLOCK_SIZE (1 << 20)
+
+/* A ChunkedArray stores 2^CHUNK_BITS elements per chunk. */
+#define CHUNK_BITS 12
+#define CHUNK_SIZE (1 << CHUNK_BITS)
+
+
+/* An Arena is a bump allocator.
+ * It reserves memory in large blocks, and hands out consecutive pieces of the current block.
+ * Nothing is freed individually; all the memory is released at once when the Arena is destroyed.
+ * Destructors of the objects placed in an Arena are never called, so only plain data should live in one.
+ *
+ * Graphs with millions of nodes allocate all their storage from a single Arena,
+ *  instead of making several small heap allocations per node.
+ */
+class Arena {
+
+	vector<char *> *blocks;
+	char *current;
+	size_t remaining;
+	size_t bytes_allocated;
+	size_t bytes_reserved;
+
+public:
+
+	/* Constructor.
+	 * Reserves no memory until the first allocation.
+	 */
+	Arena();
+
+	/* Destructor.
+	 * Frees every block reserved by this Arena.
+	 */
+	~Arena();
+
+	/* Returns a pointer to NUM_BYTES bytes of uninitialized memory, aligned to ALIGNMENT (a power of 2).
+	 * Requests larger than a quarter of a block get a block of their own.
+	 */
+	void *allocate(size_t num_bytes, size_t alignment);
+
+	/* Returns a pointer to an uninitialized array of NUM_ELEMENTS elements of type T. */
+	template <typename T>
+	T *allocate_array(size_t num_elements) {
+		return static_cast<T *>(allocate(num_elements * sizeof(T), alignof(T)));
+	}
+
+	/* Returns the number of bytes handed out by this Arena. */
+	size_t get_bytes_allocated() const;
+
+	/* Returns the number of bytes reserved by this Arena (handed out or not). */
+	size_t get_bytes_reserved() const;
+
+};
+
+
+/* A ChunkedArray is a growable array whose storage comes from an Arena.
+ * Elements are stored in chunks of CHUNK_SIZE elements, so growing never copies or moves elements,
+ *  and no memory is wasted on reallocation.
+ * T must be plain data (it is never constructed or destroyed).
+ */
+template <typename T>
+class ChunkedArray {
+
+	Arena *arena;
+	vector<T *> *chunks;
+	size_t size;
+
+public:
+
+	/* Constructor.
+	 * Creates an empty array whose chunks are allocated from ARENA.
+	 */
+	ChunkedArray(Arena *arena) : arena(arena), size(0) {
+		chunks = new vector<T *>();
+	}
+
+	/* Destructor.
+	 * Frees the table of chunks. The chunks themselves belong to the Arena.
+	 */
+	~ChunkedArray() {
+		delete chunks;
+	}
+
+	/* Appends VALUE to the end of the array. */
+	void push_back(const T& value) {
+		if ((size & (CHUNK_SIZE - 1)) == 0) {
+			chunks->push_back(arena->template allocate_array<T>(CHUNK_SIZE));
+		}
+		(*chunks)[size >> CHUNK_BITS][size & (CHUNK_SIZE - 1)] = value;
+		size++;
+	}
+
+	/* Returns a reference to the INDEX-th element. INDEX must be less than the size of the array. */
+	T& operator[](size_t index) {
+		return (*chunks)[index >> CHUNK_BITS][index & (CHUNK_SIZE - 1)];
+	}
+	const T& operator[](size_t index) const {
+		return (*chunks)[index >> CHUNK_BITS][index & (CHUNK_SIZE - 1)];
+	}
+
+	/* Returns the number of elements in the array. */
+	size_t get_size() const {
+		return size;
+	}
+
+};
+
+
+#endif
@@ -1,8 +1,10 @@
 #include <iostream>
 #include <cfloat>
+#include <cstring>
 #include <string>
 
 #include "BindingsDictionary.h"
+#include "utilities.h"
 
 using namespace std;
 
@@ -12,35 +14,81 @@ using namespace std;
 
 BindingsDictionary::BindingsDictionary() {
 
-	bindings = new unordered_map<string, double> ();
+	bindings = new unordered_map<Symbol, double> ();
+	vectors = new unordered_map<Symbol, vector<double>*> ();
 
 }
 
 
 BindingsDictionary::~BindingsDictionary() {
 	delete bindings;
+	for (unordered_map<Symbol, vector<double>*>::iterator it = vectors->begin(); it != vectors->end(); ++it) {
+		delete it->second;
+	}
+	delete vectors;
+}
+
+
+/* ------------------ Private Methods ---------------------- */
+
+
+bool BindingsDictionary::find_component(const char *name, size_t length, double **value) const {
+
+	size_t vec_name_length;
+	int64_t component_num;
+	if (!split_component(name, length, &vec_name_length, &component_num)) return false;
+
+	*value = NULL;
+	unordered_map<Symbol, vector<double>*>::const_iterator vec = vectors->find(Symbol(name, vec_name_length));
+	if (vec != vectors->end() && (uint64_t) component_num < vec->second->size()) {
+		*value = vec->second->data() + component_num;
+	}
+	return true;
+
 }
 
 
 /* ------------------ Public Methods ---------------------- */
 
 
-int BindingsDictionary::add_variable(string name) {
+int BindingsDictionary::add_variable(Symbol name) {
+	return add_variable(name.c_str(), strlen(name.c_str()));
+}
+
+
+int BindingsDictionary::add_variable(const char *name, size_t length) {
 
-	if (has_been_declared(name)) {
+	if (has_been_declared(name, length)) {
 		return -1;
 	}
 
-	(*bindings)[name] = DBL_MAX;
+	// a component goes into its vector's buffer, which grows to hold it
+	// components are declared in order, so the buffer grows by doubling, and each component is copied a constant number of times
+	size_t vec_name_length;
+	int64_t component_num;
+	if (split_component(name, length, &vec_name_length, &component_num)) {
+		vector<double> *&buffer = (*vectors)[Symbol(name, vec_name_length)];
+		if (buffer == NULL) buffer = new vector<double>();
+		if ((uint64_t) component_num >= buffer->size()) buffer->resize(component_num + 1, DBL_MIN);
+		(*buffer)[component_num] = DBL_MAX;
+		return 0;
+	}
+
+	(*bindings)[Symbol(name, length)] = DBL_MAX;
 	return 0;
 
 
 }
 
 	
-int BindingsDictionary::bind_value(string name, double value) {
+int BindingsDictionary::bind_value(Symbol name, double value) {
+	return bind_value(name.c_str(), strlen(name.c_str()), value);
+}
+
+
+int BindingsDictionary::bind_value(const char *name, size_t length, double value) {
 	
-	if (!has_been_declared(name) || has_been_defined(name)) {
+	if (!has_been_declared(name, length) || has_been_defined(name, length)) {
 		return -1;
 	}
 
@@ -48,28 +96,62 @@ int BindingsDictionary::bind_value(string name, double value) {
 		return -1;
 	}
 
-	(*bindings)[name] = value;
+	double *component;
+	if (find_component(name, length, &component)) {
+		*component = value;
+		return 0;
+	}
+
+	(*bindings)[Symbol(name, length)] = value;
 	return 0;
 
 }
 
 
-double BindingsDictionary::get_value(const string& name) const {
+double BindingsDictionary::get_value(Symbol name) const {
+	return get_value(name.c_str(), strlen(name.c_str()));
+}
+
 
-	if (!has_been_declared(name)) {
+double BindingsDictionary::get_value(const char *name, size_t length) const {
+
+	double *component;
+	if (find_component(name, length, &component)) {
+		return component == NULL ? DBL_MIN : *component;
+	}
+
+	unordered_map<Symbol, double>::const_iterator binding = bindings->find(Symbol(name, length));
+	if (binding == bindings->end()) {
 		return DBL_MIN;
 	}
 
-	return (*bindings)[name];
+	return binding->second;
+
+}
+
+
+bool BindingsDictionary::has_been_declared(Symbol name) const {
+	return has_been_declared(name.c_str(), strlen(name.c_str()));
+}
+
+
+bool BindingsDictionary::has_been_declared(const char *name, size_t length) const {
+	return get_value(name, length) != DBL_MIN;
+}
+
 
+bool BindingsDictionary::has_been_defined(Symbol name) const {
+	return has_been_defined(name.c_str(), strlen(name.c_str()));
 }
 
 
-bool BindingsDictionary::has_been_declared(const string& name) const {
-	return (bindings->count(name) != 0);
+bool BindingsDictionary::has_been_defined(const char *name, size_t length) const {
+	double value = get_value(name, length);
+	return ((value != DBL_MIN) && (value != DBL_MAX));
 }
 
 
-bool BindingsDictionary::has_been_defined(const string& name) const {
-	return ((get_value(name) != DBL_MIN) && (get_value(name) != DBL_MAX));
+bool BindingsDictionary::split_component(const char *name, size_t length, size_t *vec_name_length, int64_t *component_num) {
+	// a component number past the largest vector cannot belong to a vector, so such a name is bound like any other
+	return split_vector_component(name, length, vec_name_length, component_num) && *component_num < MAX_VECTOR_SIZE;
 }
@@ -3,31 +3,49 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+#include "Symbol.h"
 
 using namespace std;
 
 
 /* The BindingsDictionary is the main data structure used to interpret TenFlang Programs.
  * It contains bindings between variable names and their values.
+ * Names are interned (see Symbol.h); every method can also be called with a string name.
+ *
+ * Vector components ("<vector name>.<component number>", see split_vector_component in utilities.h) are not bound one by one.
+ * Each vector's components are stored in one contiguous buffer, indexed by component number, and only the vector's name is interned.
+ * So a vector of N components takes N doubles, however long its components' names are.
+ * A component with no value yet holds DBL_MAX, as any other declared variable does, and a component that was never declared holds DBL_MIN.
  */
 
 class BindingsDictionary {
 
+	/* If the NAME of the given LENGTH is a vector component, sets VALUE to the place in its vector's buffer that holds its value, and returns true.
+	 * VALUE is set to NULL if the component is past the end of its vector's buffer (and so has not been declared).
+	 * Returns false if NAME is not a vector component.
+	 */
+	bool find_component(const char *name, size_t length, double **value) const;
+
 
 public:
-	unordered_map<string, double> *bindings;
+	unordered_map<Symbol, double> *bindings;
+
+	/* Maps vector names to the buffers holding their components' values. */
+	unordered_map<Symbol, vector<double>*> *vectors;
 
 
 	/* ---------------------- Constructor/Destructor ------------------ */
 
 
 	/* Constructor.
-	 * Initializes bindings to be an empty dictionary.
+	 * Initializes bindings and vectors to be empty dictionaries.
 	 */
 	BindingsDictionary();
 
 	/* Destructor.
-	 * Deletes bindings map.
+	 * Deletes the bindings map, and the vectors map with its buffers.
 	 */
 	~BindingsDictionary();
 
@@ -39,7 +57,8 @@ public:
 	 * If the given name is already in the dictionary, returns -1 and does not create the binding.
 	 * Returns 0 on success.
 	 */
-	int add_variable(string name);
+	int add_variable(Symbol name);
+	int add_variable(const char *name, size_t length);
 
 	/* Binds the given value to the given name.
 	 * If the given name is not found, returns -1.
@@ -49,20 +68,30 @@ public:
 	 * DBL_MIN and DBL_MAX are not valid values.
 	 * Returns 0 on success.
 	 */
-	int bind_value(string name, double value);
+	int bind_value(Symbol name, double value);
+	int bind_value(const char *name, size_t length, double value);
 
 	/* Returns the value bound to the given name.
 	 * If the given name is not found, returns DBL_MIN (negative infinity).
 	 */
-	double get_value(const string& name) const;
+	double get_value(Symbol name) const;
+	double get_value(const char *name, size_t length) const;
 
 	/* Returns true if a variable with the given name has been declared, and false otherwise.
 	 */
-	bool has_been_declared(const string& name) const;
+	bool has_been_declared(Symbol name) const;
+	bool has_been_declared(const char *name, size_t length) const;
 
 	/* Returns true if a variable with the given name has been declared and defined.
 	 */
-	bool has_been_defined(const string& name) const;
+	bool has_been_defined(Symbol name) const;
+	bool has_been_defined(const char *name, size_t length) const;
+
+	/* Splits the NAME of the given LENGTH into a vector name and a component number (see split_vector_component in utilities.h).
+	 * Returns false if NAME is not a vector component, or if its component number is not less than MAX_VECTOR_SIZE:
+	 *  such names are bound one by one, like any other variable.
+	 */
+	static bool split_component(const char *name, size_t length, size_t *vec_name_length, int64_t *component_num);
 
 
 };
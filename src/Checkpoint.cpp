@@ -0,0 +1,217 @@
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Checkpoint.h"
+
+using namespace std;
+
+
+/* The first 8 bytes of every checkpoint: the magic number, and the version of the format. */
+static const char CHECKPOINT_MAGIC[8] = {'T', 'F', 'C', 'K', 'P', 'T', '0', '1'};
+
+
+/* ---------------- Writing --------------- */
+
+/* An empty vector may have no storage, so nothing is written for it, rather than writing from a null pointer. */
+static void write_bytes(FILE *file, const void *bytes, size_t n) {
+	if (n != 0) fwrite(bytes, 1, n, file);
+}
+
+static void write_int(FILE *file, int64_t value) {
+	write_bytes(file, &value, sizeof(value));
+}
+
+static void write_string(FILE *file, const string& value) {
+	write_int(file, value.size());
+	write_bytes(file, value.data(), value.size());
+}
+
+static void write_doubles(FILE *file, const vector<double>& values) {
+	write_int(file, values.size());
+	write_bytes(file, values.data(), values.size() * sizeof(double));
+}
+
+
+/* Syncs the directory holding the file FILENAME to disk, so a file renamed into it stays renamed after a crash.
+ * Returns false if the directory cannot be opened or synced.
+ */
+static bool sync_directory(const string& filename) {
+	size_t slash = filename.rfind('/');
+	string directory = slash == string::npos ? "." : slash == 0 ? "/" : filename.substr(0, slash);
+	int fd = open(directory.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+	bool synced = fsync(fd) == 0;
+	close(fd);
+	return synced;
+}
+
+
+int write_training_state(const string& filename, const TrainingState& state) {
+
+	string temporary_filename = filename + ".tmp";
+	FILE *file = fopen(temporary_filename.c_str(), "wb");
+	if (file == NULL) return INVALID_FILE_NAME;
+
+	write_bytes(file, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+	write_int(file, state.weight_names.size());
+	for (size_t i = 0; i < state.weight_names.size(); i++) write_string(file, state.weight_names[i]);
+	write_doubles(file, state.weights);
+	write_int(file, state.num_steps);
+
+	write_int(file, state.optimizer_steps);
+	write_int(file, state.optimizer_state.size());
+	for (size_t i = 0; i < state.optimizer_state.size(); i++) write_doubles(file, state.optimizer_state[i]);
+
+	write_int(file, state.epoch);
+	write_int(file, state.next_batch);
+	write_int(file, state.order.size());
+	write_bytes(file, state.order.data(), state.order.size() * sizeof(uint64_t));
+	write_string(file, state.rng_state);
+
+	// the checkpoint is on disk before it replaces the previous one
+	bool written = !ferror(file) && fflush(file) == 0 && fsync(fileno(file)) == 0;
+	if (fclose(file) != 0) written = false;
+	if (!written || rename(temporary_filename.c_str(), filename.c_str()) != 0) {
+		remove(temporary_filename.c_str());
+		return INVALID_FILE_NAME;
+	}
+
+	// the rename is only on disk once the directory is
+	if (!sync_directory(filename)) return INVALID_FILE_NAME;
+	return 0;
+}
+
+
+
+/* ---------------- Reading --------------- */
+
+/* Every read checks that there was enough to read, and, for counts, that they are not more than the rest of the file could hold. */
+
+static bool read_bytes(FILE *file, void *bytes, size_t n) {
+	return n == 0 || fread(bytes, 1, n, file) == n;
+}
+
+static bool read_int(FILE *file, int64_t *value) {
+	return read_bytes(file, value, sizeof(*value));
+}
+
+static bool read_count(FILE *file, int64_t max_count, int64_t *count) {
+	return read_int(file, count) && *count >= 0 && *count <= max_count;
+}
+
+static bool read_string(FILE *file, int64_t file_size, string *value) {
+	int64_t size;
+	if (!read_count(file, file_size, &size)) return false;
+	value->resize(size);
+	return read_bytes(file, &(*value)[0], size);
+}
+
+static bool read_doubles(FILE *file, int64_t file_size, vector<double> *values) {
+	int64_t size;
+	if (!read_count(file, file_size / sizeof(double), &size)) return false;
+	values->resize(size);
+	return read_bytes(file, values->data(), size * sizeof(double));
+}
+
+
+int read_training_state(const string& filename, TrainingState *state) {
+
+	FILE *file = fopen(filename.c_str(), "rb");
+	if (file == NULL) return INVALID_FILE_NAME;
+
+	fseek(file, 0, SEEK_END);
+	int64_t file_size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	*state = TrainingState();
+	char magic[sizeof(CHECKPOINT_MAGIC)];
+	bool valid = read_bytes(file, magic, sizeof(magic)) && memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) == 0;
+
+	int64_t count;
+	valid = valid && read_count(file, file_size / sizeof(int64_t), &count);
+	for (int64_t i = 0; valid && i < count; i++) {
+		state->weight_names.push_back("");
+		valid = read_string(file, file_size, &state->weight_names.back());
+	}
+	valid = valid && read_doubles(file, file_size, &state->weights) && read_int(file, &state->num_steps);
+
+	valid = valid && read_int(file, &state->optimizer_steps) && read_count(file, file_size / sizeof(int64_t), &count);
+	if (valid) state->optimizer_state.resize(count);
+	for (int64_t i = 0; valid && i < count; i++) valid = read_doubles(file, file_size, &state->optimizer_state[i]);
+
+	valid = valid && read_int(file, &state->epoch) && read_int(file, &state->next_batch);
+	valid = valid && read_count(file, file_size / sizeof(uint64_t), &count);
+	if (valid) state->order.resize(count);
+	valid = valid && read_bytes(file, state->order.data(), count * sizeof(uint64_t));
+	valid = valid && read_string(file, file_size, &state->rng_state);
+
+	// nothing may follow the checkpoint
+	valid = valid && fgetc(file) == EOF;
+	fclose(file);
+	return valid ? 0 : OTHER_ERROR;
+}
+
+
+
+/* ---------------- Writer --------------- */
+
+CheckpointWriter::CheckpointWriter(const string& filename) {
+	this->filename = filename;
+	pending = new TrainingState();
+	has_pending = false;
+	stopping = false;
+	error = 0;
+	lock = new mutex();
+	wakeup = new condition_variable();
+	writer = new thread(&CheckpointWriter::run, this);
+}
+
+
+CheckpointWriter::~CheckpointWriter() {
+	finish();
+	delete pending;
+	delete lock;
+	delete wakeup;
+	delete writer;
+}
+
+
+void CheckpointWriter::submit(TrainingState *state) {
+	unique_lock<mutex> guard(*lock);
+	swap(*pending, *state);
+	has_pending = true;
+	wakeup->notify_all();
+}
+
+
+void CheckpointWriter::run() {
+	TrainingState state;
+	unique_lock<mutex> guard(*lock);
+
+	while (true) {
+		while (!has_pending && !stopping) wakeup->wait(guard);
+		if (!has_pending) return;
+
+		// the state is taken out, so the next one can be submitted while this one is written
+		swap(state, *pending);
+		has_pending = false;
+		guard.unlock();
+		int success = write_training_state(filename, state);
+		guard.lock();
+		if (error == 0) error = success;
+	}
+}
+
+
+int CheckpointWriter::finish() {
+	{
+		unique_lock<mutex> guard(*lock);
+		stopping = true;
+		wakeup->notify_all();
+	}
+	if (writer->joinable()) writer->join();
+	return error;
+}
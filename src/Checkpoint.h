@@ -0,0 +1,121 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "utilities.h"
+
+using namespace std;
+
+
+/* This file defines the checkpoints of training, from which a run that was stopped resumes exactly where it left off.
+ *
+ * A checkpoint is a binary file holding the whole state of a run:
+ *
+ 	the magic number "TFCKPT", and the version of the format		8 bytes
+ 	the names of the weights, and their values						so a checkpoint is only resumed by the same program
+ 	the number of steps taken so far
+ 	the steps and the arrays of state of the Optimizer				(see Optimizer::restore_state)
+ 	the epoch, the position of the next batch in it, and the order of the data in it		for stochastic training
+ 	the state of the random number generator that shuffles the data				as its operator<< writes it
+ *
+ * Every integer is 64 bits, and every count is written before what it counts. Values are in the byte order of the machine.
+ * A checkpoint is written to a temporary file, which is then renamed over the checkpoint,
+ *  so a run stopped while it writes one leaves the previous checkpoint whole.
+ */
+
+
+/* Where and how often training writes checkpoints. */
+struct CheckpointOptions {
+	/* The file checkpoints are written to, and resumed from. If it is empty, no checkpoints are written. */
+	string filename;
+	/* A checkpoint is written every INTERVAL steps (if it is not 0), and once training ends. */
+	int64_t interval = 100;
+	/* If true, training resumes from the checkpoint in FILENAME, if there is one, rather than starting over. */
+	bool resume = false;
+};
+
+
+/* The state of a training run, as a checkpoint holds it. The fields for stochastic training are empty for full-batch training.
+ * Stochastic training on a DataSource has no order: NEXT_BATCH counts the batches of the pass read so far,
+ *  and RNG_STATE is the state the pass started from (see the streamed stochastic_gradient_descent).
+ */
+struct TrainingState {
+	vector<string> weight_names;
+	vector<double> weights;
+	int64_t num_steps = 0;
+
+	int64_t optimizer_steps = 0;
+	vector<vector<double> > optimizer_state;
+
+	int64_t epoch = 0;
+	int64_t next_batch = 0;
+	vector<uint64_t> order;
+	string rng_state;
+};
+
+
+/* Writes STATE into the file FILENAME, through a temporary file named FILENAME.tmp, which is synced to disk and renamed over it.
+ * The directory holding FILENAME is then synced too, so the new checkpoint survives a crash.
+ * Returns INVALID_FILE_NAME if the temporary file cannot be written or renamed, or the directory cannot be synced, and 0 otherwise.
+ */
+int write_training_state(const string& filename, const TrainingState& state);
+
+/* Reads the checkpoint in the file FILENAME into STATE.
+ * Returns INVALID_FILE_NAME if there is no such file, OTHER_ERROR if it is not a whole checkpoint, and 0 otherwise.
+ */
+int read_training_state(const string& filename, TrainingState *state);
+
+
+/* A CheckpointWriter writes checkpoints on a thread of its own, so training does not wait for the disk.
+ * Training only waits to hand over the state it submits, which is swapped, not copied; if the previous checkpoint is still being written,
+ *  the state waits for it, and is replaced by any state submitted meanwhile, so at most one checkpoint is ever waiting.
+ */
+class CheckpointWriter {
+
+private:
+
+	string filename;
+
+	/* The state waiting to be written, if there is one, and whether the thread should stop once it has written it. */
+	TrainingState *pending;
+	bool has_pending;
+	bool stopping;
+
+	/* The error of the first checkpoint that could not be written, or 0. */
+	int error;
+
+	mutex *lock;
+	condition_variable *wakeup;
+	thread *writer;
+
+	/* Writes every state submitted, until it is told to stop. */
+	void run();
+
+
+public:
+
+	/* Constructor. Starts the thread that writes checkpoints into the file FILENAME. */
+	CheckpointWriter(const string& filename);
+
+	/* Destructor. Waits for the last checkpoint to be written (see finish). */
+	~CheckpointWriter();
+
+	/* Takes STATE, to be written as soon as the thread is free, and leaves another state (whose contents are unspecified) in its place. */
+	void submit(TrainingState *state);
+
+	/* Waits until every state submitted has been written, and stops the thread.
+	 * Returns the error of the first checkpoint that could not be written (see write_training_state), and 0 if they all were.
+	 */
+	int finish();
+
+};
+
+
+
+#endif
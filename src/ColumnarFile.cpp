@@ -0,0 +1,437 @@
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ColumnarFile.h"
+
+using namespace std;
+
+
+/* The first 8 bytes of every columnar file: the magic number, and the version of the format. */
+static const char COLUMNAR_MAGIC[8] = {'T', 'F', 'C', 'O', 'L', '0', '0', '1'};
+
+/* The bytes of the fixed part of the header, and of the fixed part of every column's descriptor. */
+static const uint64_t COLUMNAR_HEADER_BYTES = 40;
+static const uint64_t COLUMN_DESCRIPTOR_BYTES = 24;
+
+/* The alignment of the statistics, and of every column. Columns are aligned to cache lines, so they are also aligned for any load. */
+static const uint64_t STATISTICS_ALIGNMENT = 8;
+static const uint64_t COLUMN_ALIGNMENT = 64;
+
+
+/* Marks that no chunk of a column's statistics has ended yet. */
+#define NO_CHUNK UINT64_MAX
+
+
+/* Returns POSITION rounded up to a multiple of ALIGNMENT. */
+static uint64_t align_up(uint64_t position, uint64_t alignment) {
+	return (position + alignment - 1) / alignment * alignment;
+}
+
+
+/* Returns the bytes of one value of TYPE. */
+static uint64_t value_bytes(ColumnType type) {
+	return type == ColumnType::FLOAT32 ? sizeof(float) : sizeof(double);
+}
+
+
+
+/* ---------------- Writing --------------- */
+
+ColumnarWriter::ColumnarWriter() {
+	file = NULL;
+	column_names = new vector<string>();
+	column_kinds = new vector<VariableType>();
+	rows = NULL;
+	num_rows = 0;
+	failed = false;
+}
+
+
+ColumnarWriter::~ColumnarWriter() {
+	if (file != NULL) close();
+	delete column_names;
+	delete column_kinds;
+}
+
+
+int ColumnarWriter::open(const string& filename, const vector<string>& column_names, const vector<VariableType>& column_kinds,
+	const ColumnarOptions& options) {
+
+	if (file != NULL) close();
+	if (column_names.empty() || column_kinds.size() != column_names.size()) return OTHER_ERROR;
+	for (size_t c = 0; c < column_kinds.size(); c++) {
+		if (column_kinds[c] != VariableType::INPUT && column_kinds[c] != VariableType::EXP_OUTPUT) return OTHER_ERROR;
+	}
+
+	// the rows are kept beside the file, rather than in a temporary directory that may be in memory
+	string rows_filename = filename + ".tmp";
+	rows = fopen(rows_filename.c_str(), "w+b");
+	if (rows == NULL) return INVALID_FILE_NAME;
+	remove(rows_filename.c_str());
+	file = fopen(filename.c_str(), "wb");
+	if (file == NULL) {
+		fclose(rows);
+		rows = NULL;
+		return INVALID_FILE_NAME;
+	}
+
+	*this->column_names = column_names;
+	*this->column_kinds = column_kinds;
+	this->options = options;
+	num_rows = 0;
+	failed = false;
+	return 0;
+}
+
+
+void ColumnarWriter::write_row(const double *values) {
+	if (file == NULL) return;
+	size_t num_columns = column_names->size();
+	if (fwrite(values, sizeof(double), num_columns, rows) != num_columns) failed = true;
+	num_rows++;
+}
+
+
+/* Writes the N BYTES into FILE at OFFSET. Returns false if the write failed. */
+static bool write_at(FILE *file, uint64_t offset, const char *bytes, size_t n) {
+	return fseeko(file, offset, SEEK_SET) == 0 && fwrite(bytes, 1, n, file) == n;
+}
+
+
+int ColumnarWriter::close() {
+	if (file == NULL) return OTHER_ERROR;
+
+	size_t num_columns = column_names->size();
+	uint64_t value_size = value_bytes(options.type);
+	bool narrow = options.type == ColumnType::FLOAT32;
+
+	// lay the file out: the header, the statistics, then every column
+	uint64_t position = COLUMNAR_HEADER_BYTES;
+	for (size_t c = 0; c < num_columns; c++) position += COLUMN_DESCRIPTOR_BYTES + (*column_names)[c].size();
+	uint64_t num_chunks = options.chunk_rows == 0 ? 0 : (num_rows + options.chunk_rows - 1) / options.chunk_rows;
+	uint64_t statistics_offset = 0;
+	if (options.chunk_rows != 0) {
+		statistics_offset = align_up(position, STATISTICS_ALIGNMENT);
+		position = statistics_offset + num_columns * num_chunks * 3 * sizeof(double);
+	}
+	vector<uint64_t> column_offsets(num_columns);
+	for (size_t c = 0; c < num_columns; c++) {
+		column_offsets[c] = align_up(position, COLUMN_ALIGNMENT);
+		position = column_offsets[c] + num_rows * value_size;
+	}
+
+	vector<char> bytes(COLUMNAR_HEADER_BYTES);
+	memcpy(bytes.data(), COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC));
+	encode_uint64(num_columns, bytes.data() + 8);
+	encode_uint64(num_rows, bytes.data() + 16);
+	encode_uint64(options.chunk_rows, bytes.data() + 24);
+	encode_uint64(statistics_offset, bytes.data() + 32);
+	for (size_t c = 0; c < num_columns; c++) {
+		const string& name = (*column_names)[c];
+		size_t start = bytes.size();
+		bytes.resize(start + COLUMN_DESCRIPTOR_BYTES + name.size());
+		encode_uint32((*column_kinds)[c] == VariableType::INPUT ? 0 : 1, bytes.data() + start);
+		encode_uint32(narrow ? 1 : 0, bytes.data() + start + 4);
+		encode_uint64(column_offsets[c], bytes.data() + start + 8);
+		encode_uint64(name.size(), bytes.data() + start + 16);
+		memcpy(bytes.data() + start + COLUMN_DESCRIPTOR_BYTES, name.data(), name.size());
+	}
+	failed = !write_at(file, 0, bytes.data(), bytes.size()) || failed;
+
+	// read the rows back a block at a time, and write each column's part of the block, and of its statistics, where it belongs
+	// the statistics of the chunk each column is in are kept until the chunk ends
+	const uint64_t block_values = 1 << 20;
+	uint64_t block_rows = max((uint64_t) 1, block_values / num_columns);
+	vector<double> block;
+	vector<char> statistics_bytes;
+	vector<ColumnStatistics> statistics(num_columns);
+	if (fflush(rows) != 0 || fseeko(rows, 0, SEEK_SET) != 0) failed = true;
+
+	for (uint64_t first = 0; first < num_rows && !failed; first += block_rows) {
+		uint64_t n = min(block_rows, num_rows - first);
+		block.resize(n * num_columns);
+		if (fread(block.data(), sizeof(double), block.size(), rows) != block.size()) {
+			failed = true;
+			break;
+		}
+
+		bytes.resize(n * value_size);
+		for (size_t c = 0; c < num_columns; c++) {
+			statistics_bytes.clear();
+			uint64_t first_chunk = NO_CHUNK;
+
+			for (uint64_t r = 0; r < n; r++) {
+				// a float32 column keeps its values as they are stored, so the statistics are those of the stored values
+				double value = block[r * num_columns + c];
+				if (narrow) value = (float) value;
+				if (narrow) encode_float((float) value, bytes.data() + r * value_size);
+				else encode_double(value, bytes.data() + r * value_size);
+				if (options.chunk_rows == 0) continue;
+
+				uint64_t row = first + r;
+				ColumnStatistics& chunk = statistics[c];
+				if (row % options.chunk_rows == 0) {
+					chunk.min = chunk.max = value;
+					chunk.sum = 0;
+				}
+				chunk.min = min(chunk.min, value);
+				chunk.max = max(chunk.max, value);
+				chunk.sum += value;
+
+				// the chunks that end in this block are consecutive, so their statistics are written at once
+				if ((row + 1) % options.chunk_rows == 0 || row + 1 == num_rows) {
+					if (first_chunk == NO_CHUNK) first_chunk = row / options.chunk_rows;
+					size_t start = statistics_bytes.size();
+					statistics_bytes.resize(start + 3 * sizeof(double));
+					encode_double(chunk.min, statistics_bytes.data() + start);
+					encode_double(chunk.max, statistics_bytes.data() + start + 8);
+					encode_double(chunk.sum, statistics_bytes.data() + start + 16);
+				}
+			}
+
+			failed = !write_at(file, column_offsets[c] + first * value_size, bytes.data(), n * value_size) || failed;
+			if (first_chunk != NO_CHUNK) {
+				uint64_t offset = statistics_offset + (c * num_chunks + first_chunk) * 3 * sizeof(double);
+				failed = !write_at(file, offset, statistics_bytes.data(), statistics_bytes.size()) || failed;
+			}
+		}
+	}
+
+	// the padding between the parts was skipped over, and reads as zeros; the file ends where the last column does
+	if (ferror(file) || fflush(file) != 0 || ftruncate(fileno(file), position) != 0) failed = true;
+	if (fclose(file) != 0) failed = true;
+	fclose(rows);
+	file = NULL;
+	rows = NULL;
+	return failed ? INVALID_FILE_NAME : 0;
+}
+
+
+
+/* ---------------- Reading --------------- */
+
+ColumnarSource::ColumnarSource() {
+	data = NULL;
+	size = 0;
+	column_names = new vector<string>();
+	column_kinds = new vector<VariableType>();
+	column_types = new vector<ColumnType>();
+	column_offsets = new vector<uint64_t>();
+	num_rows = 0;
+	chunk_rows = 0;
+	statistics_offset = 0;
+	started = false;
+	batch_size = 0;
+	next_row = 0;
+	order = new vector<uint64_t>();
+}
+
+
+ColumnarSource::~ColumnarSource() {
+	close();
+	delete column_names;
+	delete column_kinds;
+	delete column_types;
+	delete column_offsets;
+	delete order;
+}
+
+
+int ColumnarSource::open(const string& filename) {
+
+	close();
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) return INVALID_FILE_NAME;
+	struct stat status;
+	if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode)) {
+		::close(fd);
+		return INVALID_FILE_NAME;
+	}
+
+	// the mapping outlives the descriptor
+	size = status.st_size;
+	void *mapping = size < COLUMNAR_HEADER_BYTES ? MAP_FAILED : mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (mapping == MAP_FAILED) {
+		size = 0;
+		return OTHER_ERROR;
+	}
+	data = (const char *) mapping;
+
+	if (!read_layout()) {
+		close();
+		return OTHER_ERROR;
+	}
+	return 0;
+}
+
+
+bool ColumnarSource::read_layout() {
+
+	// every offset and count is checked against the size of the file, before anything is read at it
+	if (memcmp(data, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC)) != 0) return false;
+	uint64_t num_columns = decode_uint64(data + 8);
+	uint64_t rows = decode_uint64(data + 16);
+	chunk_rows = decode_uint64(data + 24);
+	statistics_offset = decode_uint64(data + 32);
+	if (num_columns == 0 || num_columns > size / COLUMN_DESCRIPTOR_BYTES || rows > size) return false;
+
+	uint64_t position = COLUMNAR_HEADER_BYTES;
+	for (uint64_t c = 0; c < num_columns; c++) {
+		if (position + COLUMN_DESCRIPTOR_BYTES > size) return false;
+		uint32_t kind = decode_uint32(data + position);
+		uint32_t type = decode_uint32(data + position + 4);
+		uint64_t offset = decode_uint64(data + position + 8);
+		uint64_t length = decode_uint64(data + position + 16);
+		position += COLUMN_DESCRIPTOR_BYTES;
+		if (kind > 1 || type > 1 || length > size - position) return false;
+
+		ColumnType column_type = type == 0 ? ColumnType::FLOAT64 : ColumnType::FLOAT32;
+		uint64_t value_size = value_bytes(column_type);
+		if (offset % value_size != 0 || offset > size || rows > (size - offset) / value_size) return false;
+
+		column_names->push_back(string(data + position, length));
+		column_kinds->push_back(kind == 0 ? VariableType::INPUT : VariableType::EXP_OUTPUT);
+		column_types->push_back(column_type);
+		column_offsets->push_back(offset);
+		position += length;
+	}
+
+	// statistics come with chunks, and chunks with statistics
+	if ((chunk_rows == 0) != (statistics_offset == 0)) return false;
+	if (chunk_rows != 0) {
+		uint64_t num_chunks = (rows + chunk_rows - 1) / chunk_rows;
+		if (statistics_offset % STATISTICS_ALIGNMENT != 0 || statistics_offset > size ||
+			num_chunks > (size - statistics_offset) / (num_columns * 3 * sizeof(double))) {
+			return false;
+		}
+	}
+
+	num_rows = rows;
+	return true;
+}
+
+
+void ColumnarSource::close() {
+	if (data != NULL) munmap((void *) data, size);
+	data = NULL;
+	size = 0;
+	column_names->clear();
+	column_kinds->clear();
+	column_types->clear();
+	column_offsets->clear();
+	num_rows = 0;
+	chunk_rows = 0;
+	statistics_offset = 0;
+	started = false;
+	order->clear();
+}
+
+
+const vector<string>& ColumnarSource::get_column_names() const {
+	return *column_names;
+}
+
+
+int64_t ColumnarSource::get_num_records() const {
+	return num_rows;
+}
+
+
+VariableType ColumnarSource::get_column_kind(size_t column) const {
+	return (*column_kinds)[column];
+}
+
+
+ColumnType ColumnarSource::get_column_type(size_t column) const {
+	return (*column_types)[column];
+}
+
+
+uint64_t ColumnarSource::get_chunk_rows() const {
+	return chunk_rows;
+}
+
+
+bool ColumnarSource::get_statistics(size_t column, uint64_t chunk, ColumnStatistics *statistics) const {
+	if (chunk_rows == 0) return false;
+	uint64_t num_chunks = (num_rows + chunk_rows - 1) / chunk_rows;
+	if (column >= column_names->size() || chunk >= num_chunks) return false;
+
+	const char *stored = data + statistics_offset + (column * num_chunks + chunk) * 3 * sizeof(double);
+	statistics->min = decode_double(stored);
+	statistics->max = decode_double(stored + 8);
+	statistics->sum = decode_double(stored + 16);
+	return true;
+}
+
+
+
+/* ---------------- Passes --------------- */
+
+int ColumnarSource::start_pass(size_t batch_size, mt19937_64 *rng) {
+	if (batch_size == 0 || data == NULL) return OTHER_ERROR;
+
+	this->batch_size = batch_size;
+	next_row = 0;
+	started = true;
+	order->clear();
+	if (rng != NULL) {
+		order->resize(num_rows);
+		for (int64_t r = 0; r < num_rows; r++) (*order)[r] = r;
+		shuffle_rows(order, rng);
+	}
+
+	// the kernel reads ahead of a pass in order, and only the pages asked for in a shuffled one
+	madvise((void *) data, size, rng == NULL ? MADV_SEQUENTIAL : MADV_RANDOM);
+	return 0;
+}
+
+
+int ColumnarSource::next_batch(DataBatch *batch) {
+	if (!started) return OTHER_ERROR;
+
+	size_t n = min((int64_t) batch_size, num_rows - next_row);
+	batch->num_rows = n;
+	if (n == 0) return 0;
+
+	size_t num_columns = column_names->size();
+	batch->columns.resize(num_columns);
+	if (batch->storage.size() < num_columns * batch_size) batch->storage.resize(num_columns * batch_size);
+	bool in_place = order->empty() && is_little_endian();
+
+	for (size_t c = 0; c < num_columns; c++) {
+		const char *column = data + (*column_offsets)[c];
+		bool narrow = (*column_types)[c] == ColumnType::FLOAT32;
+
+		// the rows of a pass in order are the next N of the column, which is used where it is mapped
+		if (in_place && !narrow) {
+			batch->columns[c] = (const double *) column + next_row;
+			continue;
+		}
+
+		double *values = batch->storage.data() + c * batch_size;
+		for (size_t r = 0; r < n; r++) {
+			uint64_t row = order->empty() ? next_row + r : (*order)[next_row + r];
+			values[r] = narrow ? decode_float(column + row * sizeof(float)) : decode_double(column + row * sizeof(double));
+		}
+		batch->columns[c] = values;
+	}
+
+	next_row += n;
+	return 0;
+}
+
+
+bool is_columnar_file(const string& filename) {
+	FILE *file = fopen(filename.c_str(), "rb");
+	if (file == NULL) return false;
+	char magic[sizeof(COLUMNAR_MAGIC)];
+	bool is_columnar = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, COLUMNAR_MAGIC, sizeof(magic)) == 0;
+	fclose(file);
+	return is_columnar;
+}
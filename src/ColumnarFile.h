@@ -0,0 +1,192 @@
+#ifndef COLUMNAR_FILE_H
+#define COLUMNAR_FILE_H
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdio>
+#include <cstdint>
+
+#include "DataSource.h"
+#include "utilities.h"
+
+using namespace std;
+
+
+/* This file defines columnar files, which hold training data in binary, one column after another, to be read through a memory mapping.
+ *
+ * A columnar file is a header, the statistics of its chunks (if it has them), then its columns:
+ *
+ 	the magic number "TFCOL", and the version of the format			8 bytes
+ 	the number of columns, and the number of rows						uint64, uint64
+ 	the number of rows of a chunk (0 if there are no statistics)		uint64
+ 	the offset of the statistics (0 if there are none)					uint64
+ 	for every column:
+ 		its kind: 0 for an input, 1 for an expected output				uint32
+ 		its type: 0 for float64, 1 for float32							uint32
+ 		the offset of its values										uint64
+ 		its name: its length, and its characters						uint64, then the characters
+ 	the statistics, 8-byte aligned: for every column, for every chunk, the min, max and sum of its values		float64 * 3
+ 	every column, 64-byte aligned: one value for every row, in order	the number of rows * 8 (or 4) bytes
+ *
+ * Every number is little-endian, and every row stands for one datum. The values of a column are contiguous, and aligned,
+ *  so on a little-endian machine a float64 column is used where it is mapped, as a column of a DataBatch, without being copied or decoded.
+ * Float32 columns take half the space (and the disk time), and are widened to float64 as they are read.
+ */
+
+
+/* The type of the values of a column of a columnar file. */
+enum class ColumnType {
+	FLOAT64,
+	FLOAT32
+};
+
+
+/* The statistics of a column over a chunk of rows, as they are stored (so those of a float32 column are of its rounded values). */
+struct ColumnStatistics {
+	double min = 0;
+	double max = 0;
+	double sum = 0;
+};
+
+
+/* How a columnar file is written. */
+struct ColumnarOptions {
+	/* The type every column is stored as. */
+	ColumnType type = ColumnType::FLOAT64;
+	/* If not 0, the statistics of every chunk of this many rows (the last chunk may have fewer) are stored too. */
+	uint64_t chunk_rows = 0;
+};
+
+
+/* A ColumnarWriter writes a columnar file one row at a time.
+ * The columns are only laid out once the number of rows is known, so the rows are first appended to a temporary file beside it.
+ * Closing the writer reads them back a block of rows at a time, and writes each column's part of the block (and its statistics) where it belongs.
+ * So however many rows there are, the writer holds one block of them in memory, and the data is written to disk twice.
+ */
+class ColumnarWriter {
+
+private:
+
+	/* The file being written, if one is open, and its layout. */
+	FILE *file;
+	vector<string> *column_names;
+	vector<VariableType> *column_kinds;
+	ColumnarOptions options;
+
+	/* The rows written so far, in order, as native doubles, and their number.
+	 * The temporary file is removed as soon as it is created, so it goes away when it is closed, even if this process dies.
+	 */
+	FILE *rows;
+	uint64_t num_rows;
+
+	/* Whether a row could not be written. */
+	bool failed;
+
+
+public:
+
+	/* Constructor. Creates a writer with no file. */
+	ColumnarWriter();
+
+	/* Destructor. Closes the file, if it is still open (see close). */
+	~ColumnarWriter();
+
+	/* Creates the columnar file FILENAME, whose columns are COLUMN_NAMES, of the kinds COLUMN_KINDS (INPUT or EXP_OUTPUT), stored as OPTIONS says,
+	 *  and the temporary file FILENAME.tmp, which holds the rows until they are laid out.
+	 * Nothing is written into the columnar file until it is closed.
+	 * Returns OTHER_ERROR if there are no columns, or not one kind for every column, or a kind that is neither,
+	 *  INVALID_FILE_NAME if either file cannot be created, and 0 otherwise.
+	 */
+	int open(const string& filename, const vector<string>& column_names, const vector<VariableType>& column_kinds, const ColumnarOptions& options);
+
+	/* Appends the row VALUES, which holds one value for every column, in order. */
+	void write_row(const double *values);
+
+	/* Writes the header, the statistics and the columns of every row, and closes the file and the temporary file.
+	 * Returns INVALID_FILE_NAME if either file could not be written or read, OTHER_ERROR if no file is open, and 0 otherwise.
+	 */
+	int close();
+
+};
+
+
+/* A ColumnarSource reads the rows of a columnar file, as a DataSource, through a read-only mapping of the whole file.
+ * The kernel reads the pages of the mapping as they are used (and is told whether a pass reads them in order),
+ *  so there is no thread and no buffer of its own, and a file far larger than memory is read a page at a time.
+ *
+ * A pass in order, on a little-endian machine, hands out batches whose float64 columns point into the mapping: nothing is copied.
+ * Float32 columns, and every column on a big-endian machine, are decoded into the storage of the batch.
+ * A shuffled pass reads the rows in a uniformly random order, which the columns make cheap: a row is one load from every column.
+ * Its rows are gathered into the storage of the batch.
+ */
+class ColumnarSource : public DataSource {
+
+private:
+
+	/* The mapping of the file, and its size. */
+	const char *data;
+	size_t size;
+
+	/* The layout of the file. */
+	vector<string> *column_names;
+	vector<VariableType> *column_kinds;
+	vector<ColumnType> *column_types;
+	vector<uint64_t> *column_offsets;
+	int64_t num_rows;
+	uint64_t chunk_rows;
+	uint64_t statistics_offset;
+
+	/* Whether a pass was started, its batch size, the position of its next row, and the order of its rows (empty for a pass in order). */
+	bool started;
+	size_t batch_size;
+	int64_t next_row;
+	vector<uint64_t> *order;
+
+	/* Reads the layout of the mapped file. Returns false if it is not a whole columnar file. */
+	bool read_layout();
+
+
+public:
+
+	/* Constructor. Creates a source with no file. */
+	ColumnarSource();
+
+	/* Destructor. Unmaps the file. */
+	~ColumnarSource();
+
+	/* Maps the columnar file FILENAME, and reads its layout.
+	 * Returns INVALID_FILE_NAME if the file cannot be opened, OTHER_ERROR if it is not a columnar file,
+	 *  or if a column or the statistics would lie beyond its end, and 0 otherwise.
+	 */
+	int open(const string& filename);
+
+	/* Unmaps the file. */
+	void close();
+
+	const vector<string>& get_column_names() const;
+	int64_t get_num_records() const;
+	int start_pass(size_t batch_size, mt19937_64 *rng);
+	int next_batch(DataBatch *batch);
+
+	/* Returns the kind (INPUT or EXP_OUTPUT), and the type, of the column COLUMN. */
+	VariableType get_column_kind(size_t column) const;
+	ColumnType get_column_type(size_t column) const;
+
+	/* Returns the number of rows of a chunk of the statistics, or 0 if the file has none. */
+	uint64_t get_chunk_rows() const;
+
+	/* Reads the statistics of the column COLUMN over the chunk CHUNK (rows CHUNK * get_chunk_rows() on) into STATISTICS.
+	 * Returns false if the file has no statistics, or no such column or chunk.
+	 */
+	bool get_statistics(size_t column, uint64_t chunk, ColumnStatistics *statistics) const;
+
+};
+
+
+/* Returns true if the file FILENAME begins as a columnar file does. */
+bool is_columnar_file(const string& filename);
+
+
+
+#endif
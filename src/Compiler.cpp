@@ -1,13 +1,12 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <list>
 #include <stdio.h>
 #include <vector>
+#include <unordered_set>
 
 #include "Compiler.h"
 #include "utilities.h"
-#include "Node.h"
 
 using namespace std;
 
@@ -17,15 +16,19 @@ using namespace std;
 
 Compiler::Compiler() {
     dfg = new DataFlowGraph();
-    visited_nodes = new unordered_set<Node *>();
-    visited_node_names = new unordered_set<string>();
+    visited_nodes = new vector<bool>();
+    tangent_names = new unordered_map<string, string>();
+    per_objective_partials = false;
+    background_writer = false;
+    line_tokens = new vector<Token>();
 }
 
 
 Compiler::~Compiler() {
     delete dfg;
     delete visited_nodes;
-    delete visited_node_names;
+    delete tangent_names;
+    delete line_tokens;
 }
 
 
@@ -34,17 +37,46 @@ Compiler::~Compiler() {
 
 int Compiler::compile(const string& shape_prog_filename, const string& gcp_filename) {
 
-    if (!is_valid_file_name(shape_prog_filename)) {
+    // Map the Shape Program
+    LineReader shape_prog;
+    if (shape_prog.open(shape_prog_filename) != 0) {
         cerr << "\nInvalid Shape Program file name: " << shape_prog_filename << endl << endl;
         return OTHER_ERROR;
     }
 
-    // Open Shape Program and GCP file streams
-    ifstream shape_prog(shape_prog_filename);
-    ofstream gcp(gcp_filename);
+    // Write the GCP in large blocks; a file that cannot be opened makes a stream that cannot be written
+    OutputSink gcp_sink(DEFAULT_OUTPUT_BUFFER_SIZE, background_writer);
+    ostream gcp(&gcp_sink);
+    if (gcp_sink.open(gcp_filename) != 0) gcp.setstate(ios::badbit);
 
-    // buffer into which we read a line from the file
-    string shape_line;
+    int compile_success = compile(shape_prog, gcp);
+
+    shape_prog.close();
+    int write_success = gcp_sink.close();
+    if (compile_success == 0) compile_success = write_success;
+
+    // if there was an error, clear the GCP
+    if (compile_success != 0) {
+        ofstream clear_gcp(gcp_filename);
+        clear_gcp.close();
+    }
+
+    return compile_success;
+
+}
+
+
+int Compiler::compile(istream& shape_prog, ostream& gcp) {
+    LineReader reader(shape_prog);
+    return compile(reader, gcp);
+}
+
+
+int Compiler::compile(LineReader& shape_prog, ostream& gcp) {
+
+    // the line read from the Shape Program, which is not copied
+    const char *shape_line;
+    size_t length;
 
     // indicates whether the GCP-near-duplicate was created successfully
     int duplicate_success = 0;
@@ -55,96 +87,127 @@ int Compiler::compile(const string& shape_prog_filename, const string& gcp_filen
     // Iterate through all the lines of the Shape Program
     // Copy the GCP-near-duplicate line into the GCP, then send the line to be parsed.
     int line_num = 0;
-    while(!shape_prog.eof())
+    while(shape_prog.next_line(&shape_line, &length))
     {
-        getline(shape_prog, shape_line);
-
         // copy the near-duplicate line into the GCP
-        duplicate_success = duplicate_line_for_gcp(shape_line, gcp);
-        // if there is an error duplicating this line into the gcp:
-        // print the error message, clear the GCP, and exit
+        duplicate_success = duplicate_line_for_gcp(shape_line, length, gcp);
+        // if there is an error duplicating this line into the gcp, print the error message and exit
         if (duplicate_success != 0) {
             cerr << "\nERROR, Line " << line_num << ":" << endl;
-            cerr << shape_line << endl;
+            cerr.write(shape_line, length) << endl;
             cerr << get_error_message(duplicate_success) << endl << endl;
-            shape_prog.close();
-            gcp.close();
-            ofstream clear_gcp(gcp_filename);
-            clear_gcp.close();
             return duplicate_success;
         }
         
         // parse the line
-        parse_success = parse_line(shape_line);
-        // if there is an error parsing this line:
-        // print the error message, clear the GCP, and exit
+        parse_success = parse_line(shape_line, length);
+        // if there is an error parsing this line, print the error message and exit
         if (parse_success != 0) {
             cerr << "\nERROR, Line " << line_num << ":" << endl;
-            cerr << shape_line << endl;
+            cerr.write(shape_line, length) << endl;
             cerr << get_error_message(parse_success) << endl << endl;
-            shape_prog.close();
-            gcp.close();
-            ofstream clear_gcp(gcp_filename);
-            clear_gcp.close();
             return parse_success;
         }
 
         line_num++;
     }
 
-    shape_prog.close();
-
 
     // After the while loop, the Data Flow Graph is assembled.
     // Topologically sort the nodes of the Data Flow Graph.
-    list<Node *> *top_sorted_nodes = new list<Node *>();
-    dfg->top_sort(top_sorted_nodes);
+    vector<uint32_t> top_sorted_ids;
+    dfg->top_sort(&top_sorted_ids);
 
-    // Grab the Loss node
-    Node *loss_node = dfg->get_loss_node();
-    string loss_var_name = dfg->get_loss_var_name();
+    const vector<uint32_t>& loss_nodes = dfg->get_loss_nodes();
 
-    // Iterate through the sorted nodes
+    // With one loss, iterate through the sorted nodes
     // Define partial/loss/partial/current = partial/loss/partial/parent * partial/parent/partial/current
     // Define partial/current/partial/child using basic differentiation
-    for (list<Node *>::iterator it = top_sorted_nodes->begin(); it != top_sorted_nodes->end(); ++it) {
-        
-        Node *curr_node = *it;
-        
-        string partial_var_name = declare_partial_lambda(curr_node, loss_node, gcp);
-        define_partial_lambda(curr_node, loss_var_name, gcp, partial_var_name);
+    if (loss_nodes.size() <= 1) {
+        uint32_t loss_node = dfg->get_loss_node();
+        string loss_var_name = dfg->get_loss_var_name();
+
+        for (vector<uint32_t>::iterator it = top_sorted_ids.begin(); it != top_sorted_ids.end(); ++it) {
+            
+            uint32_t curr_node = *it;
+            
+            string partial_var_name = declare_partial_lambda(curr_node, loss_node, gcp);
+            define_partial_lambda(curr_node, loss_var_name, gcp, partial_var_name);
+
+            string child_one_partial = declare_child_one_partial(curr_node, gcp);
+            string child_two_partial = declare_child_two_partial(curr_node, gcp);
+            define_child_one_partial(curr_node, gcp, child_one_partial);
+            define_child_two_partial(curr_node, gcp, child_two_partial);
+
+            mark_visited(curr_node);
+                    
+        }
+        return 0;
+    }
+
+    // With several losses, declare their seeds, and sweep backward from all of them at once
+    // Define partial/total/partial/loss = seed/loss
+    // Define partial/total/partial/current = sum over visited parents of partial/total/partial/parent * partial/parent/partial/current
+    for (vector<uint32_t>::const_iterator it = loss_nodes.begin(); it != loss_nodes.end(); ++it) {
+        gcp << "declare input " << generate_seed_name(dfg->get_name(*it)) << '\n';
+    }
+
+    for (vector<uint32_t>::iterator it = top_sorted_ids.begin(); it != top_sorted_ids.end(); ++it) {
+
+        uint32_t curr_node = *it;
+
+        string partial_var_name = declare_partial_objective(curr_node, COMBINED_OBJECTIVE_NAME, gcp);
+        string seed = dfg->get_type(curr_node) == VariableType::LOSS ? generate_seed_name(dfg->get_name(curr_node)) : "";
+        define_partial_objective(curr_node, COMBINED_OBJECTIVE_NAME, seed, gcp, partial_var_name);
 
         string child_one_partial = declare_child_one_partial(curr_node, gcp);
         string child_two_partial = declare_child_two_partial(curr_node, gcp);
         define_child_one_partial(curr_node, gcp, child_one_partial);
         define_child_two_partial(curr_node, gcp, child_two_partial);
 
-        visited_nodes->insert(curr_node);
-        visited_node_names->insert(curr_node->get_name());
-                
+        mark_visited(curr_node);
+    }
+
+    // The partials of each node with respect to its children are already in the GCP,
+    // so the sweep for each loss only combines them, seeding the loss with 1
+    if (per_objective_partials) {
+        for (vector<uint32_t>::const_iterator loss = loss_nodes.begin(); loss != loss_nodes.end(); ++loss) {
+            visited_nodes->assign(visited_nodes->size(), false);
+            string objective_name = generate_objective_name(dfg->get_name(*loss));
+            dfg->top_sort(*loss, &top_sorted_ids);
+
+            for (vector<uint32_t>::iterator it = top_sorted_ids.begin(); it != top_sorted_ids.end(); ++it) {
+                string partial_var_name = declare_partial_objective(*it, objective_name, gcp);
+                define_partial_objective(*it, objective_name, "1", gcp, partial_var_name);
+                mark_visited(*it);
+            }
+        }
     }
 
-    gcp.close();
     return 0;
 
 }
 
 
 int Compiler::parse_line(const string& line) {
+    return parse_line(line.data(), line.length());
+}
+
 
-    if (line.compare("") == 0) return 0;
+int Compiler::parse_line(const char *line, size_t length) {
 
-    // tokenize the line
-    vector<string> *tokens = new vector<string>();
-    int num_tokens = tokenize_line(line, tokens, " ");
+    if (length == 0) return 0;
+
+    // lex the line
+    vector<Token>& tokens = *line_tokens;
+    int num_tokens = lex_line(line, length, ' ', &tokens);
     if (num_tokens < 3) return INVALID_LINE;
 
     // Grab the first token of the instruction (first token in the line).
     // Use this to determine what actions to take.
-    InstructionType inst_type = get_instruction_type(tokens->at(0));
+    InstructionType inst_type = tokens[0].instruction_type;
     if (inst_type == InstructionType::INVALID_INST) return INVALID_LINE;
 
-    string var_name;
     VariableType var_type;
 
     // If the line is a declaration of a variable,
@@ -153,17 +216,18 @@ int Compiler::parse_line(const string& line) {
         
         if (num_tokens != 3) return INVALID_LINE;
         // grab the variable type
-        var_type = get_variable_type(tokens->at(1));
+        var_type = tokens[1].variable_type;
         if (var_type == VariableType::INVALID_VAR_TYPE) return BAD_VAR_TYPE;
 
         // grab the variable name
-        var_name = tokens->at(2);
-        if (!is_valid_expanded_var_name(var_name)) return INVALID_VAR_NAME;
+        if (!is_valid_expanded_var_name(tokens[2])) return INVALID_VAR_NAME;
 
-        Node *new_node = new Node(var_name, false);
-        new_node->set_type(var_type);
-        
-        return dfg->add_node(new_node);
+        // the name has no Symbol if the Symbol Table is full
+        if (dfg->get_num_nodes() >= MAX_COMPILED_VARIABLES) return TOO_MANY_VARIABLES;
+        Symbol var_name(tokens[2].start, tokens[2].length);
+        if (!var_name.is_valid()) return TOO_MANY_VARIABLES;
+
+        return dfg->add_node(var_name, var_type);
     } 
 
     // If the instruction is an expression that defines a variable:
@@ -174,12 +238,12 @@ int Compiler::parse_line(const string& line) {
         if (num_tokens < 4) return INVALID_LINE;
 
         // grab the variable name
-        var_name = tokens->at(1);
-        if (!is_valid_expanded_var_name(var_name)) return INVALID_VAR_NAME;
+        if (!is_valid_expanded_var_name(tokens[1])) return INVALID_VAR_NAME;
+        Symbol var_name(tokens[1].start, tokens[1].length);
 
         // grab the node with this name
-        Node *node = dfg->get_node(var_name);
-        if (node == NULL) {
+        uint32_t node = dfg->get_node(var_name);
+        if (node == INVALID_NODE_ID) {
             return INVALID_LINE;
         }
 
@@ -189,12 +253,13 @@ int Compiler::parse_line(const string& line) {
         // act based on the value of this token
         // A variable can defined as a constant, as equivalent to another variable,
         //  or as a function of one or two operands (the operands may be other variables or doubles)
-        string fourth_token = tokens->at(3);
+        const Token& fourth_token = tokens[3];
+        Symbol fourth_name(fourth_token.start, fourth_token.length);
 
         // if the variable is being defined as a constant c, define it as "add c 0"
-        if (is_constant(fourth_token)) {
-            node->set_operation(OperationType::ADD);
-            success = dfg->add_flow_edge(fourth_token, var_name);
+        if (fourth_token.token_class == TokenClass::NUMBER) {
+            dfg->set_operation(node, OperationType::ADD);
+            success = dfg->add_flow_edge(fourth_name, var_name);
             success = success && dfg->add_flow_edge("0", var_name);
         }
 
@@ -206,23 +271,23 @@ int Compiler::parse_line(const string& line) {
         // We trust the Preprocessor won't define variables in this cyclic manner.
         
         else if (is_valid_expanded_var_name(fourth_token)) {
-            if (dfg->get_node(fourth_token) == NULL) return VAR_REFERENCED_BEFORE_DEFINED;
-            node->set_operation(OperationType::ADD);
-            success = dfg->add_flow_edge(fourth_token, var_name);
+            if (dfg->get_node(fourth_name) == INVALID_NODE_ID) return VAR_REFERENCED_BEFORE_DEFINED;
+            dfg->set_operation(node, OperationType::ADD);
+            success = dfg->add_flow_edge(fourth_name, var_name);
             success = success && dfg->add_flow_edge("0", var_name);
         }
 
-        else if (is_unary_primitive(fourth_token)) {
+        else if (is_unary_primitive(fourth_token.operation_type)) {
             if (num_tokens != 5) return INVALID_LINE;
-            node->set_operation(get_operation_type(fourth_token));
-            success = dfg->add_flow_edge(tokens->at(4), var_name);
+            dfg->set_operation(node, fourth_token.operation_type);
+            success = dfg->add_flow_edge(Symbol(tokens[4].start, tokens[4].length), var_name);
         }
 
-        else if (is_binary_primitive(fourth_token)) {
+        else if (is_binary_primitive(fourth_token.operation_type)) {
             if (num_tokens != 6) return INVALID_LINE;
-            node->set_operation(get_operation_type(fourth_token));
-            success = dfg->add_flow_edge(tokens->at(4), var_name);
-            success = success && dfg->add_flow_edge(tokens->at(5), var_name);
+            dfg->set_operation(node, fourth_token.operation_type);
+            success = dfg->add_flow_edge(Symbol(tokens[4].start, tokens[4].length), var_name);
+            success = success && dfg->add_flow_edge(Symbol(tokens[5].start, tokens[5].length), var_name);
         }
 
         else return INVALID_LINE;
@@ -248,93 +313,158 @@ string generate_intvar_name(const string& var_name, int intvar_num) {
     return string(var_name).append(":").append(to_string(intvar_num));
 }
 
+string generate_seed_name(const string& loss_name) {
+    if (loss_name == "") return "";
+    return string("s/").append(loss_name);
+}
 
-string Compiler::declare_partial_lambda(Node *node, Node *loss_node, ofstream& gcp) {
-    
-    if (!node || !loss_node || !gcp.is_open() || node->get_type() == VariableType::INVALID_VAR_TYPE) return "";
+string generate_objective_name(const string& loss_name) {
+    if (loss_name == "") return "";
+    return string("objective/").append(loss_name);
+}
+
+string generate_direction_name(const string& weight_name) {
+    if (weight_name == "") return "";
+    return string("v/").append(weight_name);
+}
+
+string generate_tangent_name(const string& var_name) {
+    if (var_name == "") return "";
+    return string("t/").append(var_name);
+}
+
+string generate_hvp_name(const string& weight_name) {
+    if (weight_name == "") return "";
+    return string("Hv/").append(weight_name);
+}
+
+string generate_loss_edge_partial_name(const string& loss_name, const string& child_name) {
+    if (loss_name == "" || child_name == "") return "";
+    return generate_partial_var_name(loss_name, child_name).append(":edge");
+}
+
+
+/* Returns the name of the partial of NODE with respect to its child CHILD, as the GCP declares it.
+ * This is d/NODE/d/CHILD, except for the children of a loss, whose partials are named by generate_loss_edge_partial_name.
+ */
+static Symbol child_partial_symbol(const DataFlowGraph& dfg, uint32_t node, uint32_t child) {
+    if (dfg.get_type(node) == VariableType::LOSS) return Symbol(generate_loss_edge_partial_name(dfg.get_name(node), dfg.get_name(child)));
+    return generate_partial_var_symbol(dfg.get_symbol(node), dfg.get_symbol(child));
+}
 
-    // Checks if the current node is a child of the Loss node. 
-    // Consider node x, a child of the Loss node.
-    // The loss node will have alreay defined partial/loss/partial/x.
-    // We must make sure x does not redefine this variable.
-    if (loss_node->has_child_with_name(node->get_name())) return "";
+
+string Compiler::declare_partial_lambda(uint32_t node, uint32_t loss_node, ostream& gcp) {
+    
+    if (node == INVALID_NODE_ID || loss_node == INVALID_NODE_ID || !is_writable(gcp) || dfg->get_type(node) == VariableType::INVALID_VAR_TYPE) return "";
 
     // We also check if the current node has a parent.
     // If not, then the loss node is independent of the current node.
-    if (!node->has_parent()) {
+    if (!dfg->has_parent(node)) {
         return "";
     }
 
-    string line("declare ");
-    if (node->get_type() == VariableType::WEIGHT) {
-        line.append("output ");
-    } else {
-        line.append("intvar ");
+    Symbol partial_name = generate_partial_var_symbol(dfg->get_symbol(loss_node), dfg->get_symbol(node));
+    gcp << "declare " << (dfg->get_type(node) == VariableType::WEIGHT ? "output " : "intvar ") << partial_name << '\n';
+    return partial_name.str();
+}
+
+
+/* Adds the definition of PARTIAL_VAR_NAME, the partial of LOSS_NAME with respect to NODE, to the GCP.
+ * It is the sum, over the visited parents p of NODE, of partial(LOSS_NAME, p) * partial(p, NODE).
+ * With several terms, each term and each partial sum but the last is an intvar of PARTIAL_VAR_NAME.
+ */
+static void define_sum_over_parents(const DataFlowGraph& dfg, const vector<bool>& visited_nodes, uint32_t node,
+    Symbol loss_name, const string& partial_var_name, ostream& gcp) {
+
+    const uint32_t *parents = dfg.get_parents(node);
+    uint32_t num_parents = dfg.get_num_parents(node);
+
+    // d/LOSS/d/PARENT was generated when the parent was visited, so these lookups hit the cache
+    vector<string> terms;
+    for (uint32_t i = 0; i < num_parents; i++) {
+        if (parents[i] >= visited_nodes.size() || !visited_nodes[parents[i]]) continue;
+        Symbol parent_name = dfg.get_symbol(parents[i]);
+        Symbol partial_lambda_parent = generate_partial_var_symbol(loss_name, parent_name);
+        Symbol partial_parent_child = child_partial_symbol(dfg, parents[i], node);
+        terms.push_back(string("mul ").append(partial_lambda_parent.c_str()).append(" ").append(partial_parent_child.c_str()));
     }
 
-    string partial_name = generate_partial_var_name(loss_node->get_name(), node->get_name());
-    line.append(partial_name);
-    gcp << line << endl;
-    return partial_name;
-}
+    if (terms.empty()) return;
+    if (terms.size() == 1) {
+        gcp << "define " << partial_var_name << " = " << terms[0] << '\n';
+        return;
+    }
 
+    // say x has parents p and q: d/L/d/x:0 = d/L/d/p * d/p/d/x, d/L/d/x:1 = d/L/d/q * d/q/d/x, d/L/d/x = d/L/d/x:0 + d/L/d/x:1
+    int num_terms = terms.size();
+    for (int i = 0; i < 2 * num_terms - 2; i++) gcp << "declare intvar " << generate_intvar_name(partial_var_name, i) << '\n';
+    for (int i = 0; i < num_terms; i++) gcp << "define " << generate_intvar_name(partial_var_name, i) << " = " << terms[i] << '\n';
+
+    string sum = generate_intvar_name(partial_var_name, 0);
+    for (int i = 1; i < num_terms; i++) {
+        string next_sum = i == num_terms - 1 ? partial_var_name : generate_intvar_name(partial_var_name, num_terms + i - 1);
+        gcp << "define " << next_sum << " = add " << sum << " " << generate_intvar_name(partial_var_name, i) << '\n';
+        sum = next_sum;
+    }
+}
 
-void Compiler::define_partial_lambda(Node *node, string loss_name, ofstream& gcp, string partial_var_name) {
 
-    if (!node || loss_name == "" || !gcp.is_open() || partial_var_name == "") return;
+void Compiler::define_partial_lambda(uint32_t node, string loss_name, ostream& gcp, string partial_var_name) {
 
-    string line("define ");
-    line.append(partial_var_name);
-    line.append(" = ");
+    if (node == INVALID_NODE_ID || loss_name == "" || !is_writable(gcp) || partial_var_name == "") return;
 
     // partial(x, x) = 1 for any variable x.
     // This usually applies when the given NODE is the loss node.
-    if (loss_name.compare(node->get_name()) == 0) {
-        line.append("1");
+    if (Symbol(loss_name) == dfg->get_symbol(node)) {
+        gcp << "define " << partial_var_name << " = 1" << '\n';
+        return;
     }
 
-    else {
-        string visited_parent_name = "";
-        set<string> *parent_names = node->get_parent_names();
+    define_sum_over_parents(*dfg, *visited_nodes, node, loss_name, partial_var_name, gcp);
 
-        for (set<string>::iterator it = parent_names->begin(); it != parent_names->end(); ++it) {
-            if (visited_node_names->count(*it) > 0) {
-                visited_parent_name = *it;
-                break;
-            }
-        }
-        
-        if (visited_parent_name == "") return;
+}
+
+
+string Compiler::declare_partial_objective(uint32_t node, const string& objective_name, ostream& gcp) {
 
-        string partial_lambda_parent = generate_partial_var_name(loss_name, visited_parent_name);
-        string partial_parent_child = generate_partial_var_name(visited_parent_name, node->get_name());
+    if (node == INVALID_NODE_ID || !is_writable(gcp) || dfg->get_type(node) == VariableType::INVALID_VAR_TYPE) return "";
 
-        line.append("mul ");
-        line.append(partial_lambda_parent);
-        line.append(" ");
-        line.append(partial_parent_child);
+    // the objective is independent of a node without parents
+    if (!dfg->has_parent(node)) return "";
+
+    Symbol partial_name = generate_partial_var_symbol(objective_name, dfg->get_symbol(node));
+    gcp << "declare " << (dfg->get_type(node) == VariableType::WEIGHT ? "output " : "intvar ") << partial_name << '\n';
+    return partial_name.str();
+}
+
+
+void Compiler::define_partial_objective(uint32_t node, const string& objective_name, const string& seed, ostream& gcp, string partial_var_name) {
+
+    if (node == INVALID_NODE_ID || objective_name == "" || !is_writable(gcp) || partial_var_name == "") return;
+
+    // the seed of a loss is its cotangent, such as partial(total, L) = s/L
+    if (dfg->get_type(node) == VariableType::LOSS) {
+        gcp << "define " << partial_var_name << " = " << seed << '\n';
+        return;
     }
 
-    gcp << line << endl;
+    define_sum_over_parents(*dfg, *visited_nodes, node, objective_name, partial_var_name, gcp);
 
 }
 
 
-string Compiler::declare_child_one_partial(Node *node, ofstream& gcp) {
+string Compiler::declare_child_one_partial(uint32_t node, ostream& gcp) {
 
-    if (!node || !gcp.is_open()) return "";
+    if (node == INVALID_NODE_ID || !is_writable(gcp)) return "";
 
-    int num_children = node->get_num_children();
-    string line;
+    int num_children = dfg->get_num_children(node);
 
     // make sure there is a first child and it's not a constant(double) node
-    if (num_children >= 1 && !node->get_child_one()->is_constant()) {
-        line = "declare intvar ";
-        string child_one_partial = generate_partial_var_name(node->get_name(), node->get_child_one_name());
-        line.append(child_one_partial);
+    if (num_children >= 1 && !dfg->is_constant(dfg->get_child_one(node))) {
+        Symbol child_one_partial = child_partial_symbol(*dfg, node, dfg->get_child_one(node));
         
-        gcp << line << endl;
-        return child_one_partial;
+        gcp << "declare intvar " << child_one_partial << '\n';
+        return child_one_partial.str();
     }
 
     return "";
@@ -342,21 +472,18 @@ string Compiler::declare_child_one_partial(Node *node, ofstream& gcp) {
 }
 
 
-string Compiler::declare_child_two_partial(Node *node, ofstream& gcp) {
+string Compiler::declare_child_two_partial(uint32_t node, ostream& gcp) {
 
-    if (!node || !gcp.is_open()) return "";
+    if (node == INVALID_NODE_ID || !is_writable(gcp)) return "";
 
-    int num_children = node->get_num_children();
-    string line;
+    int num_children = dfg->get_num_children(node);
 
     // make sure there is a second child, it's not a constant(double) node, and it's different from the first child
-    if (num_children >= 2 && node->get_child_one_name().compare(node->get_child_two_name()) != 0 && !node->get_child_two()->is_constant()) {
-        line = "declare intvar ";
-        string child_two_partial = generate_partial_var_name(node->get_name(), node->get_child_two_name());
-        line.append(child_two_partial);
+    if (num_children >= 2 && dfg->get_child_one(node) != dfg->get_child_two(node) && !dfg->is_constant(dfg->get_child_two(node))) {
+        Symbol child_two_partial = child_partial_symbol(*dfg, node, dfg->get_child_two(node));
         
-        gcp << line << endl;        
-        return child_two_partial;
+        gcp << "declare intvar " << child_two_partial << '\n';        
+        return child_two_partial.str();
     }
 
     return "";
@@ -364,31 +491,33 @@ string Compiler::declare_child_two_partial(Node *node, ofstream& gcp) {
 }
 
 
-void Compiler::define_child_one_partial(Node *node, ofstream& gcp, string child_one_partial) {
+void Compiler::define_child_one_partial(uint32_t node, ostream& gcp, string child_one_partial) {
 
-    if (!node || !gcp.is_open() || child_one_partial == "") return;
+    if (node == INVALID_NODE_ID || !is_writable(gcp) || child_one_partial == "" || dfg->get_num_children(node) < 1) return;
 
-    OperationType node_oper = node->get_operation();
+    OperationType node_oper = dfg->get_operation(node);
+    string child_one_name = dfg->get_name(dfg->get_child_one(node));
+    string child_two_name = dfg->get_num_children(node) >= 2 ? dfg->get_name(dfg->get_child_two(node)) : "";
     if (node_oper == OperationType::INVALID_OPERATION) return;
 
     // if c = a + b, partial(c, a) = 1
     if (node_oper == OperationType::ADD) {
-        gcp << "define " + child_one_partial + " = 1" << endl;
+        gcp << "define " << child_one_partial << " = 1" << '\n';
     }
 
     else if (node_oper == OperationType::SUB) {
-        gcp << "define " + child_one_partial + " = 1" << endl; 
+        gcp << "define " << child_one_partial << " = 1" << '\n'; 
     }
 
     else if (node_oper == OperationType::MUL) {
 
         // if c = a * a, partial(c, a) = 2a
-        if (node->get_child_one_name().compare(node->get_child_two_name()) == 0) {
-            gcp << "define " + child_one_partial + " = mul 2 " + node->get_child_one_name() << endl;
+        if (child_one_name.compare(child_two_name) == 0) {
+            gcp << "define " << child_one_partial << " = mul 2 " << child_one_name << '\n';
         } 
         // if c = a * b, where b != a, partial(c, a) = b
         else {
-            gcp << "define " + child_one_partial + " = " + node->get_child_two_name() << endl;
+            gcp << "define " << child_one_partial << " = " << child_two_name << '\n';
         }
     } 
 
@@ -398,69 +527,71 @@ void Compiler::define_child_one_partial(Node *node, ofstream& gcp, string child_
         string intvars[4];
         intvars[0] = generate_intvar_name(child_one_partial, 0); intvars[1] = generate_intvar_name(child_one_partial, 1);
         intvars[2] = generate_intvar_name(child_one_partial, 2); intvars[3] = generate_intvar_name(child_one_partial, 3);
-        for (int i = 0; i < 4; i++) gcp << "declare intvar " + intvars[i] << endl;
+        for (int i = 0; i < 4; i++) gcp << "declare intvar " << intvars[i] << '\n';
 
         // say f = logistic x
-        gcp << "define " + intvars[0] + " = exp " + node->get_child_one_name() << endl;             // d/f/d/x_0 = e^x
-        gcp << "define " + intvars[1] + " = add 1 " + intvars[0] << endl;                           // d/f/d/x_1 = 1 + d/f/d/x_0
-        gcp << "define " + intvars[2] + " = pow " + intvars[1] + " 2" << endl;                      // d/f/d/x_2 = (d/f/d/x_1)^2
-        gcp << "define " + intvars[3] + " = pow " + intvars[2] + " -1" << endl;                     // d/f/d/x_3 = 1 / d/f/d/x_2 
+        gcp << "define " << intvars[0] << " = exp " << child_one_name << '\n';             // d/f/d/x_0 = e^x
+        gcp << "define " << intvars[1] << " = add 1 " << intvars[0] << '\n';                           // d/f/d/x_1 = 1 + d/f/d/x_0
+        gcp << "define " << intvars[2] << " = pow " << intvars[1] << " 2" << '\n';                      // d/f/d/x_2 = (d/f/d/x_1)^2
+        gcp << "define " << intvars[3] << " = pow " << intvars[2] << " -1" << '\n';                     // d/f/d/x_3 = 1 / d/f/d/x_2 
 
-        gcp << "define " + child_one_partial + " = mul " + intvars[0] + " " + intvars[3] << endl;   // d/f/d/x = d/f/d/x_0 * d/f/d/x_3
+        gcp << "define " << child_one_partial << " = mul " << intvars[0] << " " << intvars[3] << '\n';   // d/f/d/x = d/f/d/x_0 * d/f/d/x_3
     }
 
     // if c = e^a, partial(c, a) = e^a
     else if (node_oper == OperationType::EXP) {
-        gcp << "define " + child_one_partial + " = exp " + node->get_child_one_name() << endl;
+        gcp << "define " << child_one_partial << " = exp " << child_one_name << '\n';
     }
 
     // if c = ln a, partial(c, a) = 1/a
     else if (node_oper == OperationType::LN) {
-        gcp << "define " + child_one_partial + " = pow " + node->get_child_one_name() + " -1" << endl;
+        gcp << "define " << child_one_partial << " = pow " << child_one_name << " -1" << '\n';
     }
 
     // if c = a^b, partial(c, a) = b * a^(b - 1)
     else if (node_oper == OperationType::POW) {
         string intvars[2];
         intvars[0] = generate_intvar_name(child_one_partial, 0); intvars[1] = generate_intvar_name(child_one_partial, 1);
-        for (int i = 0; i < 2; i++) gcp << "declare intvar " + intvars[i] << endl;
+        for (int i = 0; i < 2; i++) gcp << "declare intvar " << intvars[i] << '\n';
 
         // say f = pow x y
-        gcp << "define " + intvars[0] + " = sub " + node->get_child_two_name() + " 1" << endl;                          // d/f/d/x_0 = y - 1 
-        gcp << "define " + intvars[1] + " = pow " + node->get_child_one_name() + " " + intvars[0] << endl;       // d/f/d/x_1 = x ^ d/f/d/x_0
+        gcp << "define " << intvars[0] << " = sub " << child_two_name << " 1" << '\n';                          // d/f/d/x_0 = y - 1 
+        gcp << "define " << intvars[1] << " = pow " << child_one_name << " " << intvars[0] << '\n';       // d/f/d/x_1 = x ^ d/f/d/x_0
 
-        gcp << "define " + child_one_partial + " = mul " + node->get_child_two_name() + " " + intvars[1] << endl;   // d/f/d/x = y * d/f/d/x_1
+        gcp << "define " << child_one_partial << " = mul " << child_two_name << " " << intvars[1] << '\n';   // d/f/d/x = y * d/f/d/x_1
 
     }
 
 }
 
 
-void Compiler::define_child_two_partial(Node *node, ofstream& gcp, string child_two_partial) {
+void Compiler::define_child_two_partial(uint32_t node, ostream& gcp, string child_two_partial) {
      
-    if (!node || !gcp.is_open() || child_two_partial == "") return;
+    if (node == INVALID_NODE_ID || !is_writable(gcp) || child_two_partial == "" || dfg->get_num_children(node) < 2) return;
 
-    OperationType node_oper = node->get_operation();
+    OperationType node_oper = dfg->get_operation(node);
+    string child_one_name = dfg->get_name(dfg->get_child_one(node));
+    string child_two_name = dfg->get_name(dfg->get_child_two(node));
     if (node_oper == OperationType::INVALID_OPERATION) return;
 
     // if c = a + b, partial(c, b) = 1
     if (node_oper == OperationType::ADD) {
-        gcp << "define " + child_two_partial + " = 1" << endl;
+        gcp << "define " << child_two_partial << " = 1" << '\n';
     }
 
     else if (node_oper == OperationType::SUB) {
-        gcp << "define " + child_two_partial + " = -1" << endl; 
+        gcp << "define " << child_two_partial << " = -1" << '\n'; 
     }
 
     else if (node_oper == OperationType::MUL) {
 
         // if c = b * b, partial(c, b) = 2b
-        if (node->get_child_one_name().compare(node->get_child_two_name()) == 0) {
-            gcp << "define " + child_two_partial + " = mul 2 " + node->get_child_two_name() << endl;
+        if (child_one_name.compare(child_two_name) == 0) {
+            gcp << "define " << child_two_partial << " = mul 2 " << child_two_name << '\n';
         } 
         // if c = a * b, where b != a, partial(c, b) = a
         else {
-            gcp << "define " + child_two_partial + " = " + node->get_child_one_name() << endl;
+            gcp << "define " << child_two_partial << " = " << child_one_name << '\n';
         }
     } 
 
@@ -468,36 +599,41 @@ void Compiler::define_child_two_partial(Node *node, ofstream& gcp, string child_
     else if (node_oper == OperationType::POW) {
         string intvars[2];
         intvars[0] = generate_intvar_name(child_two_partial, 0); intvars[1] = generate_intvar_name(child_two_partial, 1);
-        for (int i = 0; i < 2; i++) gcp << "declare intvar " << intvars[i] << endl;
+        for (int i = 0; i < 2; i++) gcp << "declare intvar " << intvars[i] << '\n';
 
         // say f = pow x y
-        gcp << "define " + intvars[0] + " = pow " + node->get_child_one_name() + " " + node->get_child_two_name() << endl;     // d/f/d/y_0 = x^y 
-        gcp << "define " + intvars[1] + " = ln " + node->get_child_one_name() << endl;                                          // d/f/d/y_1 = ln(x)
+        gcp << "define " << intvars[0] << " = pow " << child_one_name << " " << child_two_name << '\n';     // d/f/d/y_0 = x^y 
+        gcp << "define " << intvars[1] << " = ln " << child_one_name << '\n';                                          // d/f/d/y_1 = ln(x)
 
-        gcp << "define " + child_two_partial + " = mul " + intvars[0] + " " + intvars[1] << endl;   // d/f/d/y = d/f/d/y_0 * d/f/d/y_1
+        gcp << "define " << child_two_partial << " = mul " << intvars[0] << " " << intvars[1] << '\n';   // d/f/d/y = d/f/d/y_0 * d/f/d/y_1
 
     }
 }
 
 
-int Compiler::duplicate_line_for_gcp(const string& shape_line, ofstream& gcp) {
+int Compiler::duplicate_line_for_gcp(const string& shape_line, ostream& gcp) {
+    return duplicate_line_for_gcp(shape_line.data(), shape_line.length(), gcp);
+}
+
+
+int Compiler::duplicate_line_for_gcp(const char *shape_line, size_t length, ostream& gcp) {
     
-    if (shape_line.compare("") == 0) return 0;
-    if (!gcp.is_open()) return OTHER_ERROR;
+    if (length == 0) return 0;
+    if (!is_writable(gcp)) return OTHER_ERROR;
 
-    // tokenize the shape line
-    vector<string> *tokens = new vector<string> ();
-    int num_tokens = tokenize_line(shape_line, tokens, " ");
+    // lex the shape line
+    vector<Token>& tokens = *line_tokens;
+    int num_tokens = lex_line(shape_line, length, ' ', &tokens);
     if (num_tokens < 3) return INVALID_LINE;
     
     // determine instruction type
-    InstructionType inst_type = get_instruction_type(tokens->at(0));
+    InstructionType inst_type = tokens[0].instruction_type;
     if (inst_type == InstructionType::INVALID_INST) return INVALID_LINE;
 
 
     // If define, make sure we're not defining an input, weight or exp_output
     if (inst_type == InstructionType::DEFINE) {
-        gcp << shape_line << endl;
+        gcp.write(shape_line, length) << '\n';
         return 0;
     }
 
@@ -505,7 +641,7 @@ int Compiler::duplicate_line_for_gcp(const string& shape_line, ofstream& gcp) {
     if (inst_type == InstructionType::DECLARE) {
 
         if (num_tokens != 3) return INVALID_LINE;
-        VariableType var_type = get_variable_type(tokens->at(1));
+        VariableType var_type = tokens[1].variable_type;
         if (var_type == VariableType::INVALID_VAR_TYPE) return BAD_VAR_TYPE;
 
         string gcp_var_type;
@@ -515,45 +651,279 @@ int Compiler::duplicate_line_for_gcp(const string& shape_line, ofstream& gcp) {
             gcp_var_type = "intvar";
         }
 
-        string var_name = tokens->at(2);
-        gcp << "declare " << gcp_var_type << " " << var_name << endl;
+        gcp << "declare " << gcp_var_type << " ";
+        gcp.write(tokens[2].start, tokens[2].length);
+        gcp << '\n';
         return 0;
     }
 
     return INVALID_LINE;
 }
 
+void Compiler::set_per_objective_partials(bool keep) {
+    per_objective_partials = keep;
+}
+
+void Compiler::set_background_writer(bool background_writer) {
+    this->background_writer = background_writer;
+}
+
+string Compiler::get_objective_name() const {
+    if (dfg->get_loss_nodes().size() > 1) return COMBINED_OBJECTIVE_NAME;
+    return dfg->get_loss_var_name();
+}
+
 DataFlowGraph *Compiler::get_dfg() {
     return dfg;
 }
 
-unordered_set<Node *> *Compiler::get_visited_nodes() {
-    return visited_nodes;
+void Compiler::mark_visited(uint32_t node) {
+    if (node >= visited_nodes->size()) visited_nodes->resize(node + 1, false);
+    (*visited_nodes)[node] = true;
 }
 
-unordered_set<string> *Compiler::get_visited_node_names() {
-    return visited_node_names;
+bool Compiler::is_visited(uint32_t node) const {
+    return node < visited_nodes->size() && (*visited_nodes)[node];
 }
 
 
 
+/* ---------------- Hessian-Vector Products -------------- */
+
+
+int Compiler::compile_hvp(const string& gcp_filename, const string& hvp_filename) {
+
+    LineReader gcp;
+    if (gcp.open(gcp_filename) != 0) {
+        cerr << "\nInvalid GCP file name: " << gcp_filename << endl << endl;
+        return OTHER_ERROR;
+    }
 
-/*int main(int argc, char *argv[]) {
+    // Read the whole GCP, since the outputs (which determine the weights) are declared after the weights are used.
+    vector<string> gcp_lines;
+    string gcp_line;
+    while (gcp.next_line(&gcp_line)) {
+        gcp_lines.push_back(gcp_line);
+    }
+    gcp.close();
 
-    Node *a = new Node("a", false); 
-    Node *b = new Node("-7", true);
-    Node *c = new Node("c", false);
-    c->set_operation(OperationType::LN);
-    c->set_child(a);
-    //c->set_child(b);
+    // First pass: collect the inputs and outputs of the GCP
+    unordered_set<string> gcp_inputs;
+    vector<string> partial_names;
+    for (size_t line_num = 0; line_num < gcp_lines.size(); line_num++) {
+        vector<string> tokens;
+        int num_tokens = tokenize_line(gcp_lines[line_num], &tokens, " ");
+        if (num_tokens == 0) continue;
 
-    ofstream gcp("foo.tf");
+        InstructionType inst_type = get_instruction_type(tokens[0]);
+        if (num_tokens < 3 || (inst_type != InstructionType::DECLARE && inst_type != InstructionType::DEFINE)) {
+            cerr << "\nERROR, Line " << line_num << ":" << endl;
+            cerr << gcp_lines[line_num] << endl;
+            cerr << get_error_message(INVALID_LINE) << endl << endl;
+            return INVALID_LINE;
+        }
 
-    string partial1 = declare_child_one_partial(c, gcp);
-    string partial2 = declare_child_two_partial(c, gcp);
-    if (partial1.compare("") != 0) define_child_one_partial(c, gcp, partial1);
-    if (partial2.compare("") != 0) define_child_two_partial(c, gcp, partial2);
+        if (inst_type == InstructionType::DECLARE) {
+            VariableType var_type = get_variable_type(tokens[1]);
+            if (var_type == VariableType::INPUT) gcp_inputs.insert(tokens[2]);
+            if (var_type == VariableType::OUTPUT) partial_names.push_back(tokens[2]);
+        }
+    }
 
-    
+    // Every output d/LAMBDA/d/w names the weight w it is taken with respect to.
+    // The weight name is the suffix after some "/d/" that matches a GCP input.
+    vector<string> weight_names;
+    for (vector<string>::iterator it = partial_names.begin(); it != partial_names.end(); ++it) {
+        string weight_name = "";
+        size_t d_pos = it->find("/d/");
+        while (d_pos != string::npos) {
+            string candidate = it->substr(d_pos + 3);
+            if (gcp_inputs.count(candidate) != 0) {
+                weight_name = candidate;
+                break;
+            }
+            d_pos = it->find("/d/", d_pos + 1);
+        }
+
+        if (weight_name == "") {
+            cerr << "\nThe GCP output " << *it << " is not the partial derivative with respect to an input." << endl << endl;
+            return INVALID_VAR_NAME;
+        }
+        weight_names.push_back(weight_name);
+    }
+
+    OutputSink hvp_sink(DEFAULT_OUTPUT_BUFFER_SIZE, background_writer);
+    ostream hvp(&hvp_sink);
+    if (hvp_sink.open(hvp_filename) != 0) {
+        cerr << "\nInvalid HVP file name: " << hvp_filename << endl << endl;
+        return OTHER_ERROR;
+    }
+    tangent_names->clear();
+
+    // The direction vector is a new set of inputs, one per weight.
+    // The tangent of each weight is its direction component.
+    for (vector<string>::iterator it = weight_names.begin(); it != weight_names.end(); ++it) {
+        string direction_name = generate_direction_name(*it);
+        hvp << "declare input " << direction_name << '\n';
+        (*tangent_names)[*it] = direction_name;
+    }
+
+    // Second pass: copy the GCP, following every definition with the definition of its tangent.
+    // The partials are no longer outputs of the program.
+    for (size_t line_num = 0; line_num < gcp_lines.size(); line_num++) {
+        vector<string> tokens;
+        int num_tokens = tokenize_line(gcp_lines[line_num], &tokens, " ");
+        if (num_tokens == 0) continue;
+
+        if (get_instruction_type(tokens[0]) == InstructionType::DECLARE) {
+            if (get_variable_type(tokens[1]) == VariableType::OUTPUT) {
+                hvp << "declare intvar " << tokens[2] << '\n';
+            } else {
+                hvp << gcp_lines[line_num] << '\n';
+            }
+            continue;
+        }
+
+        hvp << gcp_lines[line_num] << '\n';
+        define_tangent(gcp_lines[line_num], hvp);
+    }
+
+    // Hv/w is the tangent of d/LAMBDA/d/w.
+    for (size_t i = 0; i < weight_names.size(); i++) {
+        string hvp_name = generate_hvp_name(weight_names[i]);
+        string partial_tangent = get_tangent_name(partial_names[i]);
+        hvp << "declare output " << hvp_name << '\n';
+        hvp << "define " << hvp_name << " = " << (partial_tangent == "" ? "0" : partial_tangent) << '\n';
+    }
+
+    if (hvp_sink.close() != 0) {
+        cerr << "\nCould not write the HVP file " << hvp_filename << endl << endl;
+        return OTHER_ERROR;
+    }
+    return 0;
+}
+
+
+string Compiler::define_tangent(const string& gcp_line, ostream& hvp) {
+
+    if (!is_writable(hvp)) return "";
+
+    vector<string> tokens;
+    int num_tokens = tokenize_line(gcp_line, &tokens, " ");
+    if (num_tokens < 4 || get_instruction_type(tokens[0]) != InstructionType::DEFINE) return "";
+
+    string var_name = tokens[1];
+    string tangent = generate_tangent_name(var_name);
+
+    // if x = c, the tangent of x is zero.
+    // if x = y, the tangent of x is the tangent of y, so no new lines are needed.
+    if (num_tokens == 4) {
+        string equiv_tangent = get_tangent_name(tokens[3]);
+        if (equiv_tangent != "") (*tangent_names)[var_name] = equiv_tangent;
+        return equiv_tangent;
+    }
+
+    OperationType oper = get_operation_type(tokens[3]);
+    string operand1 = tokens[4];
+    string operand2 = (num_tokens == 6 ? tokens[5] : "");
+    string tangent1 = get_tangent_name(operand1);
+    string tangent2 = get_tangent_name(operand2);
+
+    // if neither operand depends on a weight, neither does x
+    if (tangent1 == "" && tangent2 == "") return "";
+
+    // t/x is the sum of one term per operand with a nonzero tangent.
+    // Each term is either the name of a variable, or an expression partial(x, y) * t/y.
+    vector<string> terms;
+    vector<bool> term_is_name;
+    int intvar_num = 0;
+
+    // if c = a + b, t/c = t/a + t/b
+    if (oper == OperationType::ADD) {
+        if (tangent1 != "") { terms.push_back(tangent1); term_is_name.push_back(true); }
+        if (tangent2 != "") { terms.push_back(tangent2); term_is_name.push_back(true); }
+    }
+
+    // if c = a - b, t/c = t/a - t/b
+    else if (oper == OperationType::SUB) {
+        if (tangent1 != "") { terms.push_back(tangent1); term_is_name.push_back(true); }
+        if (tangent2 != "") { terms.push_back("mul -1 " + tangent2); term_is_name.push_back(false); }
+    }
+
+    // if c = a * b, t/c = b * t/a + a * t/b
+    else if (oper == OperationType::MUL) {
+        if (tangent1 != "") { terms.push_back("mul " + tangent1 + " " + operand2); term_is_name.push_back(false); }
+        if (tangent2 != "") { terms.push_back("mul " + operand1 + " " + tangent2); term_is_name.push_back(false); }
+    }
+
+    // if c = e^a, t/c = c * t/a
+    else if (oper == OperationType::EXP) {
+        terms.push_back("mul " + var_name + " " + tangent1); term_is_name.push_back(false);
+    }
+
+    // if c = ln a, t/c = t/a * a^-1
+    else if (oper == OperationType::LN) {
+        string inverse = define_tangent_intvar(var_name, &intvar_num, "pow " + operand1 + " -1", hvp);
+        terms.push_back("mul " + tangent1 + " " + inverse); term_is_name.push_back(false);
+    }
+
+    // if c = logistic a, t/c = c * (1 - c) * t/a
+    else if (oper == OperationType::LOGISTIC) {
+        string one_minus = define_tangent_intvar(var_name, &intvar_num, "sub 1 " + var_name, hvp);
+        string partial = define_tangent_intvar(var_name, &intvar_num, "mul " + var_name + " " + one_minus, hvp);
+        terms.push_back("mul " + partial + " " + tangent1); term_is_name.push_back(false);
+    }
+
+    // if c = a^b, t/c = b * a^(b - 1) * t/a + c * ln(a) * t/b
+    else if (oper == OperationType::POW) {
+        if (tangent1 != "") {
+            string exponent = define_tangent_intvar(var_name, &intvar_num, "sub " + operand2 + " 1", hvp);
+            string power = define_tangent_intvar(var_name, &intvar_num, "pow " + operand1 + " " + exponent, hvp);
+            string partial = define_tangent_intvar(var_name, &intvar_num, "mul " + operand2 + " " + power, hvp);
+            terms.push_back("mul " + partial + " " + tangent1); term_is_name.push_back(false);
+        }
+        if (tangent2 != "") {
+            string log = define_tangent_intvar(var_name, &intvar_num, "ln " + operand1, hvp);
+            string partial = define_tangent_intvar(var_name, &intvar_num, "mul " + var_name + " " + log, hvp);
+            terms.push_back("mul " + partial + " " + tangent2); term_is_name.push_back(false);
+        }
+    }
+
+    else return "";
+
+    // a single tangent that is already a variable needs no new lines
+    if (terms.size() == 1 && term_is_name[0]) {
+        (*tangent_names)[var_name] = terms[0];
+        return terms[0];
+    }
+
+    hvp << "declare intvar " << tangent << '\n';
+    if (terms.size() == 1) {
+        hvp << "define " << tangent << " = " << terms[0] << '\n';
+    } else {
+        string summands[2];
+        for (int i = 0; i < 2; i++) {
+            summands[i] = term_is_name[i] ? terms[i] : define_tangent_intvar(var_name, &intvar_num, terms[i], hvp);
+        }
+        hvp << "define " << tangent << " = add " << summands[0] << " " << summands[1] << '\n';
+    }
+
+    (*tangent_names)[var_name] = tangent;
+    return tangent;
+}
+
+
+string Compiler::get_tangent_name(const string& operand) {
+    if (operand == "" || is_constant(operand) || tangent_names->count(operand) == 0) return "";
+    return tangent_names->at(operand);
+}
+
+
+string Compiler::define_tangent_intvar(const string& var_name, int *intvar_num, const string& expression, ostream& hvp) {
+    // "t:0/x" cannot collide with the tangent "t/y" of any GCP variable y
+    string intvar = generate_intvar_name("t", *intvar_num).append("/").append(var_name);
+    hvp << "declare intvar " << intvar << '\n';
+    hvp << "define " << intvar << " = " << expression << '\n';
+    (*intvar_num)++;
+    return intvar;
 }
-*/
\ No newline at end of file
@@ -1,16 +1,31 @@
 #ifndef COMPILER_H
 #define COMPILER_H
 
+#include <iostream>
 #include <vector>
-#include <unordered_set>
+#include <unordered_map>
+#include <cstdint>
 
-#include "Node.h"
 #include "DataFlowGraph.h"
+#include "Lexer.h"
+#include "LineReader.h"
+#include "OutputSink.h"
 #include "utilities.h"
 
 using namespace std;
 
 
+/* The most variables a Shape Program may declare.
+ * The Data Flow Graph numbers its nodes, and the edges to their parents, with uint32_t,
+ *  and the GCP needs several slots for every variable (see MAX_SLOTS in Program.h).
+ * So a larger program is refused with TOO_MANY_VARIABLES, rather than having its numbers wrap around.
+ * This is what limits the vectors the Compiler accepts: a vector of MAX_VECTOR_SIZE components has more than 2^30 variables.
+ * Every component of an expanded vector is its own node of the Data Flow Graph, and its partials are their own variables of the GCP;
+ *  the Compiler has no vector-level nodes, so vector operations are differentiated one component at a time.
+ */
+#define MAX_COMPILED_VARIABLES (INT64_C(1) << 30)
+
+
 /* The purpose of compilation is to translate the Shape Program into the Gradient Computing Program (GCP).
  * Compilation occurs in these three steps:
  *
@@ -19,6 +34,16 @@ using namespace std;
  *  2. Topologically sort the Data Flow Graph.
  *  3. Visit the nodes in the sorted order.
  *      At each node, add lines to the GCP that declare and define the appropriate partial derivative variables.
+ *
+ * A Shape Program may declare several loss variables L1, ..., Ln, such as the terms of a weighted objective.
+ * Each loss Li then gets a seed weight, the new GCP input "s/Li",
+ *  and the GCP computes the partials of the combined objective "total/objective" = s/L1 * L1 + ... + s/Ln * Ln
+ *  in a single backward sweep, whose partials are named d/total/objective/d/x.
+ * The sweep starts at every loss at once, with partial(total/objective, Li) = s/Li as the seed cotangent of Li.
+ * The seeds are inputs, so the weighting of the objectives can change without recompiling.
+ * If per-objective partials are kept (see set_per_objective_partials), the GCP also outputs the partials of every loss Li
+ *  with respect to every weight w, named d/objective/Li/d/w, from one more sweep per loss.
+ *  These sweeps reuse the partials of each node with respect to its children, which the first sweep defined.
  */
  
 class Compiler {
@@ -31,14 +56,25 @@ class Compiler {
      */
     DataFlowGraph *dfg;
 
-    /* This set holds the nodes visited topologically.
+    /* Indexed by node id, this records which nodes have been visited topologically.
      * Nodes are visited after every line is parsed and the DFG is built.
      */
-    unordered_set<Node *> *visited_nodes;
+    vector<bool> *visited_nodes;
 
-    /* This set holds the names of the nodes visited topologically.
+    /* Maps each variable of a GCP to the name of the variable holding its tangent.
+     * Used when building a Hessian-vector product program (see compile_hvp).
+     * Variables whose tangent is zero have no entry.
      */
-    unordered_set<string> *visited_node_names;
+    unordered_map<string, string> *tangent_names;
+
+    /* True if a program with several losses also gets the partials of each loss (see the top of this file). */
+    bool per_objective_partials;
+
+    /* True if GCP and HVP files are written by a background thread (see set_background_writer). */
+    bool background_writer;
+
+    /* The Tokens of the line being parsed, reused for every line. */
+    vector<Token> *line_tokens;
 
 public:
 
@@ -60,10 +96,21 @@ public:
      * Topologically sorts the DFG.
      * Visits each node in order, copying the declarations and definitions of partial derivative variables into the GCP.
      * 
-     * Returns 0 on success, and the appropriate error code otherwise (see utilities.h).
+     * Returns TOO_MANY_VARIABLES if the program declares more than MAX_COMPILED_VARIABLES variables,
+     *  0 on success, and the appropriate error code otherwise (see utilities.h).
      */
     int compile(const string& shape_prog_filename, const string& gcp_filename);
 
+    /* Compiles the Shape Program read from SHAPE_PROG, writing the GCP to GCP (see above).
+     * The streams may be files or in-memory strings, so a program can be compiled without touching the disk.
+     * The file version above reads the Shape Program through a memory mapping (see LineReader.h).
+     * On failure, the lines already written to GCP are left in it; the file version above clears its file.
+     *
+     * Returns 0 on success, and the appropriate error code otherwise (see utilities.h).
+     */
+    int compile(istream& shape_prog, ostream& gcp);
+    int compile(LineReader& shape_prog, ostream& gcp);
+
     /* Reads one line of code, and takes the appropriate actions.
      * If the line is the declaration of a variable, a node is added to the Data Flow Graph.
      * If the line defines an expression for the variable, the respective node is updated.
@@ -74,6 +121,7 @@ public:
      * Returns the appropriate error code otherwise (see utilities.h).
      */
     int parse_line(const string& line);
+    int parse_line(const char *line, size_t length);
 
     /* Writes a near duplicate of SHAPE_LINE into GCP.
      * Define instructions are copied directly.
@@ -82,44 +130,71 @@ public:
      * Outputs, intvars, and loss variables from the Shape Program all become intvars in the GCP.
      * Returns 0 on success, or an error code (see utilities.h) on failure.
      */
-    int duplicate_line_for_gcp(const string& shape_line, ofstream& gcp);
+    int duplicate_line_for_gcp(const string& shape_line, ostream& gcp);
+    int duplicate_line_for_gcp(const char *shape_line, size_t length, ostream& gcp);
+
+    /* Sets whether a program with several losses also gets the partials of each loss, and not just of the combined objective.
+     * This is off by default. It has no effect on programs with one loss.
+     */
+    void set_per_objective_partials(bool keep);
+
+    /* Chooses whether the file versions of compile and compile_hvp write their program from a background thread.
+     * Those files are always written through an OutputSink, in large blocks (see OutputSink.h).
+     * With BACKGROUND_WRITER, each full block is written by a writer thread while the next one is generated. This is off by default.
+     */
+    void set_background_writer(bool background_writer);
+
+    /* Returns the name of the objective whose partials with respect to the weights are the GCP's main outputs:
+     *  the loss variable if there is one, COMBINED_OBJECTIVE_NAME if there are several, and an empty string if there is none.
+     * The partial of the objective with respect to weight w is generate_partial_var_name(get_objective_name(), w).
+     */
+    string get_objective_name() const;
 
     /* Returns a pointer to the DFG.
      * This is used mainly for testing purposes, so the DFG can be examined.
      */
     DataFlowGraph *get_dfg();
 
-    /* Returns a pointer to the set of visited nodes.
-     * This is used mainly for testing purposes.
+    /* Records that the node with the given id has been visited topologically.
+     * This is called by compile, and is also used for testing purposes.
      */
-    unordered_set<Node *> *get_visited_nodes();
+    void mark_visited(uint32_t node);
 
-    /* Returns a pointer to the set of visited node names.
-     * This is used mainly for testing purposes.
-     */
-    unordered_set<string> *get_visited_node_names();
+    /* Returns true if the node with the given id has been visited topologically. */
+    bool is_visited(uint32_t node) const;
 
     /* Adds the declaration of a partial derivative to the GCP.
      * The variable is the partial derivative of the Loss variable with respect to the variable represented by the given node.
      * Returns the name of this variable.
      *
-     * Returns an empty string if NODE or LOSS_NODE is NULL, or if the GCP ofstream is not open.
-     * Returns an empty string if NODE is a child of the loss node.
-     * Consider node X, a child of the loss node.
-     * The loss node (visited previously), will have already defined partial(loss, X).
-     * We must make sure this call to declare_partial_lambda(X, Loss, GCP) does not redefine partial(loss, X).
+     * NODE and LOSS_NODE are ids of nodes in the DFG.
+     * Returns an empty string if NODE or LOSS_NODE is INVALID_NODE_ID, or if the GCP ofstream is not open.
+     * A child X of the loss node is no exception: partial(loss, X) sums over all of X's parents, the loss among them,
+     *  and the partial along the edge from the loss alone has its own name (see generate_loss_edge_partial_name).
      *
      * Also returns an empty string if NODE has no parent.
      * If this is the case, then LOSS_NODE is independent of NODE.
      * partial(loss, X) is 0, and this is an unnecessary line in the GCP
      */
-    string declare_partial_lambda(Node *node, Node *loss_node, ofstream& gcp);
+    string declare_partial_lambda(uint32_t node, uint32_t loss_node, ostream& gcp);
 
     /* Adds the definition of a partial derivative to the GCP.
      * The variable defined is the partial derivative of the Loss variable with respect to the variable represented by the given node.
-     * partial(Loss, x) = partial(Loss, x.parent) * partial(x.parent, x)
+     * partial(Loss, x) = sum over the visited parents p of x of partial(Loss, p) * partial(p, x)
+     * With more than one visited parent, each term and each partial sum is an intvar of the partial (see generate_intvar_name).
      */ 
-    void define_partial_lambda(Node *node, string loss_name, ofstream &gcp, string partial_var_name);
+    void define_partial_lambda(uint32_t node, string loss_name, ostream& gcp, string partial_var_name);
+
+    /* Adds the declaration of the partial of the objective OBJECTIVE_NAME (see the top of this file) with respect to the given node to the GCP.
+     * The partials with respect to weights are outputs.
+     * Returns the name of this variable, or an empty string if NODE has no parent, so the objective does not depend on it.
+     */
+    string declare_partial_objective(uint32_t node, const string& objective_name, ostream& gcp);
+
+    /* Adds the definition of the partial of the objective OBJECTIVE_NAME with respect to the given node to the GCP.
+     * The partial with respect to a loss is SEED (a variable or a constant). Any other partial is defined as in define_partial_lambda.
+     */
+    void define_partial_objective(uint32_t node, const string& objective_name, const string& seed, ostream& gcp, string partial_var_name);
 
     /* These two methods are nearly identical.
      * They add the declaration of a partial derivative to the GCP.
@@ -127,8 +202,8 @@ public:
      * Returns the name of this variable.
      * If the given node doesn't have a first/second child (or its first/second child is constant), returns an empty string.
      */
-    string declare_child_one_partial(Node *node, ofstream &gcp);
-    string declare_child_two_partial(Node *node, ofstream &gcp);
+    string declare_child_one_partial(uint32_t node, ostream& gcp);
+    string declare_child_two_partial(uint32_t node, ostream& gcp);
 
     /* These two methods are nearly identical.
      * They add the definition of a partial derivative to the GCP.
@@ -136,8 +211,49 @@ public:
      * This partial derivative is calculated using basic Calculus rules for partial differentiation.
      * If the given CHILD_ONE/TWO_PARTIAL is an empty string, does nothing.
      */
-    void define_child_one_partial(Node *node, ofstream &gcp, string child_one_partial);
-    void define_child_two_partial(Node *node, ofstream &gcp, string child_two_partial);
+    void define_child_one_partial(uint32_t node, ostream& gcp, string child_one_partial);
+    void define_child_two_partial(uint32_t node, ostream& gcp, string child_two_partial);
+
+
+    /* ---------------------- Hessian-Vector Products ----------------------- */
+
+    /* Builds a Hessian-vector product (HVP) program from the GCP stored in GCP_FILENAME.
+     * The GCP is treated as a Shape Program whose outputs are the partials d/LAMBDA/d/w.
+     * Each weight w gets a new input "v/w", and together these form the direction vector v.
+     *
+     * The GCP is differentiated in forward mode along v (forward-over-reverse differentiation):
+     *  every line of the GCP is copied into the HVP program, and after each definition of a variable x,
+     *  lines defining its tangent t/x = sum over operands y of partial(x, y) * t/y are added.
+     * The tangent of d/LAMBDA/d/w is the w-th component of Hv, which becomes the output "Hv/w".
+     * The former GCP outputs become intvars.
+     *
+     * Each GCP line adds at most a handful of tangent lines, so one HVP evaluation costs
+     *  a small constant multiple of one gradient evaluation.
+     *
+     * Returns 0 on success, and the appropriate error code otherwise (see utilities.h).
+     */
+    int compile_hvp(const string& gcp_filename, const string& hvp_filename);
+
+    /* Adds the declaration and definition of the tangent of the variable defined by GCP_LINE to HVP.
+     * The tangents of the operands are looked up in tangent_names, and the new tangent is recorded there.
+     * If the variable is defined as another variable, its tangent is simply that variable's tangent.
+     *
+     * Returns the name of the variable holding the tangent.
+     * Returns an empty string if the tangent is zero (no operand depends on a weight), or if GCP_LINE is not a definition.
+     */
+    string define_tangent(const string& gcp_line, ostream& hvp);
+
+    /* Returns the name of the variable holding the tangent of the given operand.
+     * Returns an empty string if the operand is a constant, or if its tangent is zero.
+     */
+    string get_tangent_name(const string& operand);
+
+    /* Declares and defines the INTVAR_NUM-th intvar used to compute the tangent of VAR_NAME as the given EXPRESSION,
+     *  and increments INTVAR_NUM.
+     * If var_name were "foo" and intvar_num were 2, the intvar would be named "t:2/foo".
+     * Returns the name of the intvar.
+     */
+    string define_tangent_intvar(const string& var_name, int *intvar_num, const string& expression, ostream& hvp);
 
 
 };
@@ -146,6 +262,9 @@ public:
 
 /* ------------------------ Helper Functions ------------------- */
 
+/* The name of the combined objective of a Shape Program with several losses (see the Compiler class). */
+#define COMBINED_OBJECTIVE_NAME "total/objective"
+
 /* Returns a string that is the name of the partial derivative of var 1 with respect to var 2.
  * If var1 were "foo", and var2 were "bar", this method would return "d/foo/d/bar".
  */
@@ -160,6 +279,37 @@ string generate_partial_var_name(const string& var1, const string& var2);
  */
 string generate_intvar_name(const string& var_name, int intvar_num);
 
+/* Returns the name of the seed input for the given loss.
+ * If loss_name were "L", this method would return "s/L".
+ */
+string generate_seed_name(const string& loss_name);
+
+/* Returns the name of the objective of the given loss, when its partials are kept separately.
+ * If loss_name were "L", this method would return "objective/L".
+ */
+string generate_objective_name(const string& loss_name);
+
+/* Returns the name of the direction input for the given weight.
+ * If weight_name were "w", this method would return "v/w".
+ */
+string generate_direction_name(const string& weight_name);
+
+/* Returns the name of the tangent of the given variable.
+ * If var_name were "foo", this method would return "t/foo".
+ */
+string generate_tangent_name(const string& var_name);
+
+/* Returns the name of the Hessian-vector product output for the given weight.
+ * If weight_name were "w", this method would return "Hv/w".
+ */
+string generate_hvp_name(const string& weight_name);
+
+/* Returns the name of the partial of the loss LOSS_NAME with respect to its child CHILD_NAME, along the edge between them alone.
+ * If loss_name were "L", and child_name were "x", this method would return "d/L/d/x:edge".
+ * "d/L/d/x" is the partial along every path from x to L, which differs when x has other parents (say L = z * x, and z = x * y).
+ */
+string generate_loss_edge_partial_name(const string& loss_name, const string& child_name);
+
 
 
 
@@ -1,4 +1,6 @@
 #include <string>
+#include <string.h>
+#include <algorithm>
 
 #include "DataFlowGraph.h"
 
@@ -6,86 +8,117 @@
 using namespace std;
 
 
+/* The type stored for the ids below get_num_ids() that are not nodes or constants of this graph. */
+#define NO_NODE 0xff
+
+
 /* --------------- Constructor/Destructor ---------------- */
 
 DataFlowGraph::DataFlowGraph() {
-	nodes = new unordered_map<string, Node *>();
+	arena = new Arena();
+	types = new ChunkedArray<uint8_t>(arena);
+	operations = new ChunkedArray<uint8_t>(arena);
+	num_children = new ChunkedArray<uint8_t>(arena);
+	child_ones = new ChunkedArray<uint32_t>(arena);
+	child_twos = new ChunkedArray<uint32_t>(arena);
+	parent_offsets = NULL;
+	parent_ids = NULL;
+	parents_valid = false;
 	num_nodes = 0;
-	loss_node_added = false;
-	loss_node = NULL;
-	loss_var_name = "";
+	loss_nodes = new vector<uint32_t>();
 }
 
 
 DataFlowGraph::~DataFlowGraph() {
-	for (unordered_map<string, Node*>::iterator it = nodes->begin();
-		it != nodes->end(); ++it) {
-		delete it->second;
-	}
-
-	delete nodes;
+	delete types;
+	delete operations;
+	delete num_children;
+	delete child_ones;
+	delete child_twos;
+	delete loss_nodes;
+	delete arena;
 }
 
 
 /* ---------------- Nodes and Edges ----------- */
 
-int DataFlowGraph::add_node(Node *node) {
-	if (node == NULL) {
-		return -1;
+uint32_t DataFlowGraph::add_id(Symbol name) {
+	uint32_t id = name.get_id();
+
+	while (id >= types->get_size()) {
+		types->push_back(NO_NODE);
+		operations->push_back((uint8_t) OperationType::INVALID_OPERATION);
+		num_children->push_back(0);
+		child_ones->push_back(INVALID_NODE_ID);
+		child_twos->push_back(INVALID_NODE_ID);
+		parents_valid = false;
 	}
+	return id;
+}
 
-	if (node->is_constant()) return -1;
 
-	// If we are adding the loss node, make sure to set the loss node's parent to be itself.
-	if (node->get_type() == VariableType::LOSS) {
-		if (loss_node_added) {
-			return -1;
-		}
+bool DataFlowGraph::contains(uint32_t id) const {
+	return id < types->get_size() && (*types)[id] != NO_NODE;
+}
 
-		loss_node = node;
-		loss_var_name = node->get_name();
-		loss_node_added = true;
-		node->add_parent(node);
-	}
 
-	if (nodes->count(node->get_name()) > 0) {
-		return -1;
+int DataFlowGraph::add_node(Symbol name, VariableType type) {
+	if (!name.is_valid() || name.c_str()[0] == '\0' || type == VariableType::CONSTANT) return -1;
+	if (contains(name.get_id())) return -1;
+
+	uint32_t id = add_id(name);
+	(*types)[id] = (uint8_t) type;
+
+	// a loss node's parent is itself; build_parents takes care of this
+	if (type == VariableType::LOSS) {
+		loss_nodes->push_back(id);
 	}
 
-	nodes->insert(make_pair(node->get_name(), node));
 	num_nodes++;
 	return 0;
 }
 
 
-Node *DataFlowGraph::get_node(const string& name) const {
-	if (nodes->count(name) == 0) {
-		return NULL;
+uint32_t DataFlowGraph::get_node(Symbol name) const {
+	uint32_t id = name.get_id();
+	if (!contains(id) || is_constant(id)) {
+		return INVALID_NODE_ID;
 	}
-	return nodes->at(name);
+	return id;
 }
 
 
-bool DataFlowGraph::add_flow_edge(const string& child_name, const string& parent_name) {
-	Node *parent = get_node(parent_name);
-	if (parent == NULL) {
+bool DataFlowGraph::add_flow_edge(Symbol child_name, Symbol parent_name) {
+	uint32_t parent = get_node(parent_name);
+	if (parent == INVALID_NODE_ID) {
 		return false;
 	}
 
-	Node *child; 
-	if (is_constant(child_name)) {
-		child = new Node(string(child_name), true);
-	} else {
-		child = get_node(child_name);
+	// the child is either a node, a constant already in the graph, or a new constant
+	if (!child_name.is_valid()) return false;
+	uint32_t child = child_name.get_id();
+	if (!contains(child)) {
+		if (!::is_constant(child_name.str())) return false;
+		add_id(child_name);
+		(*types)[child] = (uint8_t) VariableType::CONSTANT;
+	}
+
+	VariableType parent_type = get_type(parent);
+	if (parent_type == VariableType::INPUT || parent_type == VariableType::WEIGHT || parent_type == VariableType::EXP_OUTPUT) {
+		return false;
 	}
-	
-	if (child == NULL) {
+	if (get_type(child) == VariableType::LOSS || (*num_children)[parent] == 2) {
 		return false;
 	}
 
-	bool success = child->add_parent(parent);
-	success = success && parent->set_child(child);
-	return success;	
+	if ((*num_children)[parent] == 0) {
+		(*child_ones)[parent] = child;
+	} else {
+		(*child_twos)[parent] = child;
+	}
+	(*num_children)[parent]++;
+	parents_valid = false;
+	return true;
 }
 
 
@@ -93,44 +126,188 @@ int DataFlowGraph::get_num_nodes() const {
 	return num_nodes;
 }
 
+uint32_t DataFlowGraph::get_num_ids() const {
+	return types->get_size();
+}
+
+size_t DataFlowGraph::get_bytes_allocated() const {
+	return arena->get_bytes_allocated();
+}
+
 
 
 /* ---------------- Loss Node ------------------- */
 
 string DataFlowGraph::get_loss_var_name() const {
-	return loss_var_name;
+	if (loss_nodes->size() != 1) return "";
+	return get_name(loss_nodes->front());
 }
 
-Node *DataFlowGraph::get_loss_node() const {
-	return loss_node;
+uint32_t DataFlowGraph::get_loss_node() const {
+	if (loss_nodes->size() != 1) return INVALID_NODE_ID;
+	return loss_nodes->front();
 }
 
+const vector<uint32_t>& DataFlowGraph::get_loss_nodes() const {
+	return *loss_nodes;
+}
 
 
-/* ---------------- Topological Sort ------------- */
 
-void DataFlowGraph::clear_all_markings() {
-	for (unordered_map<string, Node *>::iterator it = nodes->begin(); it != nodes->end(); ++it) {
-		it->second->clear_mark();
-	}
+/* ---------------- Node Accessors ------------------- */
+
+Symbol DataFlowGraph::get_symbol(uint32_t node) const {
+	return Symbol::from_id(node);
+}
+
+string DataFlowGraph::get_name(uint32_t node) const {
+	return Symbol::from_id(node).str();
+}
+
+VariableType DataFlowGraph::get_type(uint32_t node) const {
+	return (VariableType) (*types)[node];
+}
+
+bool DataFlowGraph::is_constant(uint32_t node) const {
+	return get_type(node) == VariableType::CONSTANT;
+}
+
+OperationType DataFlowGraph::get_operation(uint32_t node) const {
+	return (OperationType) (*operations)[node];
+}
+
+void DataFlowGraph::set_operation(uint32_t node, OperationType operation) {
+	if (is_constant(node)) return;
+	(*operations)[node] = (uint8_t) operation;
+}
+
+int DataFlowGraph::get_num_children(uint32_t node) const {
+	return (*num_children)[node];
+}
+
+uint32_t DataFlowGraph::get_child_one(uint32_t node) const {
+	return (*child_ones)[node];
 }
 
-void DataFlowGraph::top_sort(list<Node *> *sorted_nodes) {
-	clear_all_markings();
-	top_sort_visit(loss_node, sorted_nodes);
+uint32_t DataFlowGraph::get_child_two(uint32_t node) const {
+	return (*child_twos)[node];
 }
 
-void DataFlowGraph::top_sort_visit(Node *node, list<Node *> *sorted_nodes) {
-	if (node == NULL || node->is_constant() || node->is_temporary_marked() || node->is_permanent_marked()) {
-		return;
+bool DataFlowGraph::has_child(uint32_t node, uint32_t child) const {
+	return child != INVALID_NODE_ID && ((*child_ones)[node] == child || (*child_twos)[node] == child);
+}
+
+uint32_t DataFlowGraph::get_num_parents(uint32_t node) const {
+	build_parents();
+	return parent_offsets[node + 1] - parent_offsets[node];
+}
+
+bool DataFlowGraph::has_parent(uint32_t node) const {
+	return get_num_parents(node) > 0;
+}
+
+const uint32_t *DataFlowGraph::get_parents(uint32_t node) const {
+	build_parents();
+	return parent_ids + parent_offsets[node];
+}
+
+
+void DataFlowGraph::build_parents() const {
+	if (parents_valid) return;
+
+	// the previous arrays stay in the arena; graphs are normally built completely before parents are asked for
+	uint32_t num_ids = get_num_ids();
+	parent_offsets = arena->allocate_array<uint32_t>(num_ids + 1);
+	memset(parent_offsets, 0, (num_ids + 1) * sizeof(uint32_t));
+
+	// count the parents of each node, storing the count of node n at index n + 1
+	// a node with the same child twice (mul x x) is counted once
+	for (uint32_t node = 0; node < num_ids; node++) {
+		if (get_type(node) == VariableType::LOSS) parent_offsets[node + 1]++;
+
+		uint32_t child_one = (*child_ones)[node], child_two = (*child_twos)[node];
+		if (child_one != INVALID_NODE_ID && !is_constant(child_one)) parent_offsets[child_one + 1]++;
+		if (child_two != INVALID_NODE_ID && child_two != child_one && !is_constant(child_two)) parent_offsets[child_two + 1]++;
 	}
 
-	if (node->is_unmarked()) {
-		node->temporary_mark();
-		top_sort_visit(node->get_child_one(), sorted_nodes);
-		top_sort_visit(node->get_child_two(), sorted_nodes);
-		node->permanent_mark();
-		sorted_nodes->push_front(node);
+	for (uint32_t node = 0; node < num_ids; node++) {
+		parent_offsets[node + 1] += parent_offsets[node];
+	}
+
+	// fill in the parents, using NEXT as the insertion point of each node
+	// visiting parents in increasing order of id keeps each list sorted
+	parent_ids = arena->allocate_array<uint32_t>(parent_offsets[num_ids]);
+	vector<uint32_t> next(parent_offsets, parent_offsets + num_ids);
+	for (uint32_t node = 0; node < num_ids; node++) {
+		if (get_type(node) == VariableType::LOSS) parent_ids[next[node]++] = node;
+
+		uint32_t child_one = (*child_ones)[node], child_two = (*child_twos)[node];
+		if (child_one != INVALID_NODE_ID && !is_constant(child_one)) parent_ids[next[child_one]++] = node;
+		if (child_two != INVALID_NODE_ID && child_two != child_one && !is_constant(child_two)) parent_ids[next[child_two]++] = node;
 	}
+
+	parents_valid = true;
 }
 
+
+
+/* ---------------- Topological Sort ------------- */
+
+void DataFlowGraph::top_sort(vector<uint32_t> *sorted_ids) const {
+	sorted_ids->clear();
+
+	// 0 means unmarked, 1 means temporary mark, 2 means permanent mark
+	vector<uint8_t> marks(get_num_ids(), 0);
+	for (vector<uint32_t>::const_iterator it = loss_nodes->begin(); it != loss_nodes->end(); ++it) {
+		sort_from(*it, &marks, sorted_ids);
+	}
+
+	// nodes were finished children-first, so reversing puts every node before its children
+	reverse(sorted_ids->begin(), sorted_ids->end());
+}
+
+
+void DataFlowGraph::top_sort(uint32_t root, vector<uint32_t> *sorted_ids) const {
+	sorted_ids->clear();
+	if (!contains(root) || is_constant(root)) return;
+
+	vector<uint8_t> marks(get_num_ids(), 0);
+	sort_from(root, &marks, sorted_ids);
+	reverse(sorted_ids->begin(), sorted_ids->end());
+}
+
+
+void DataFlowGraph::sort_from(uint32_t root, vector<uint8_t> *marks, vector<uint32_t> *sorted_ids) const {
+	if ((*marks)[root] != 0) return;
+
+	// the stack holds the ids of the temporarily marked nodes whose children are not all finished
+	vector<uint32_t> stack;
+	(*marks)[root] = 1;
+	stack.push_back(root);
+
+	while (!stack.empty()) {
+		uint32_t node = stack.back();
+
+		// descend into the first unmarked child, if there is one
+		uint32_t children[2] = {(*child_ones)[node], (*child_twos)[node]};
+		uint32_t next = INVALID_NODE_ID;
+		for (int i = 0; i < 2; i++) {
+			uint32_t child = children[i];
+			if (child != INVALID_NODE_ID && !is_constant(child) && (*marks)[child] == 0) {
+				next = child;
+				break;
+			}
+		}
+
+		if (next != INVALID_NODE_ID) {
+			(*marks)[next] = 1;
+			stack.push_back(next);
+			continue;
+		}
+
+		// all the children are finished, so this node is too
+		(*marks)[node] = 2;
+		sorted_ids->push_back(node);
+		stack.pop_back();
+	}
+}
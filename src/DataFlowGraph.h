@@ -1,119 +1,220 @@
 #ifndef DATAFLOWGRAPH_H
 #define DATAFLOWGRAPH_H
 
-#include <unordered_map>
-#include <list>
+#include <string>
+#include <vector>
+#include <cstdint>
 
-#include "Node.h"
+#include "Arena.h"
+#include "Symbol.h"
 #include "utilities.h"
 
 
 using namespace std;
 
 
+/* The id of a node that is not in a Data Flow Graph. */
+#define INVALID_NODE_ID UINT32_MAX
+
+
 /* The Data Flow Graph is a graphical representation of how data flows through a computation.
- * The graph is represented as a mapping of node names to nodes, and is built during the parsing stage of the Compile Phase.
+ * It is built during the parsing stage of the Compile Phase.
  * Each node represents a variable (or a constant) in the computation.
  * The Data Flow Graph is important, because it can be topologically sorted.
  * A topological sort of the DFG gives an order in which to visit nodes when computing partial derivatives.
+ *
+ * Nodes are identified by uint32_t ids, and the graph is stored as a struct of arrays indexed by id:
+ *  - A node's id is the id of the Symbol of its name (see Symbol.h).
+ *    Symbols are shared by the whole program, so the arrays have an (empty) entry for every Symbol id below the largest node id.
+ *  - The type, operation, and (up to two) children of each node are stored in separate arrays.
+ *  - The parents of each node are stored in compressed sparse row (CSR) form:
+ *     the parents of node n are parent_ids[parent_offsets[n]] up to (not including) parent_ids[parent_offsets[n + 1]].
+ *    The parents are derived from the children, and rebuilt the first time they are asked for after an edge is added.
+ *
+ * Constants that appear as operands are nodes too (so a child is always an id), but they are not variables:
+ *  they are not counted by get_num_nodes, cannot be looked up by get_node, and have no parents.
+ * Each distinct constant is stored once, however many times it appears.
+ *
+ * All of this storage comes from one Arena, so a node takes tens of bytes instead of several heap allocations.
+ * The names themselves are stored once, in the global Symbol Table.
  */
- 
+
 class DataFlowGraph {
 
-	unordered_map<string, Node*>* nodes;
+	Arena *arena;
+
+	ChunkedArray<uint8_t> *types;
+	ChunkedArray<uint8_t> *operations;
+	ChunkedArray<uint8_t> *num_children;
+	ChunkedArray<uint32_t> *child_ones;
+	ChunkedArray<uint32_t> *child_twos;
+
+	/* The parents of each node, in CSR form (see above).
+	 * These are only valid while PARENTS_VALID is set; adding an edge clears it.
+	 */
+	mutable uint32_t *parent_offsets;
+	mutable uint32_t *parent_ids;
+	mutable bool parents_valid;
+
 	int num_nodes;
 
-	Node *loss_node;
-	string loss_var_name;
-	bool loss_node_added;
-	
+	/* The ids of the loss nodes, in the order they were added. */
+	vector<uint32_t> *loss_nodes;
+
+	/* Returns the id of the given node or constant, growing the arrays to hold it if needed.
+	 * The entry of a new id has no type until it is set (see NO_NODE).
+	 */
+	uint32_t add_id(Symbol name);
+
+	/* Returns true if the given id is a node or a constant in this graph. */
+	bool contains(uint32_t id) const;
+
+	/* Rebuilds PARENT_OFFSETS and PARENT_IDS from the children of every node, if they are out of date.
+	 * The parents of each node are listed in increasing order of id.
+	 */
+	void build_parents() const;
+
 
 public:
 
 	/* Constructor.
-	 * Initializes the map of nodes, and set num_nodes to 0.
+	 * Initializes an empty graph, and sets num_nodes to 0.
  	 */
 	DataFlowGraph();
 
 	/* Destructor.
-	 * Frees each of the nodes in this graph.
-	 * Frees the map of nodes itself.
+	 * Frees the arena holding all of this graph's storage.
 	 */
 	~DataFlowGraph();
 
 
 
-	/* Adds a node to the Data Flow Graph.
- 	 * Stores a mapping from node-name to node.
- 	 * If the given node is the loss node, makes a note of this.
+	/* Adds a node with the given NAME and TYPE to the Data Flow Graph. Its id is the id of NAME.
+ 	 * If the given node is a loss node, makes a note of this (a loss node's parent is itself).
+ 	 * A graph may have several loss nodes, each the root of one objective (see Compiler.h).
  	 * Returns 0 if the node was successfully added.
- 	 * Returns -1 if there is already a node by this name in the graph.
- 	 * Returns -1 if a loss node is being added for the second time.
- 	 * Returns -1 if a the given node is constant.
+ 	 * Returns -1 if the name is empty, or if there is already a node (or constant) by this name in the graph.
+ 	 * Returns -1 if TYPE is CONSTANT.
  	 * In all failure cases, the new node is not added.
  	 */
-	int add_node(Node *node);
+	int add_node(Symbol name, VariableType type);
 
-	/* Returns a pointer to the node corresponding to the given NAME.
- 	 * Returns NULL if there is no node by the name in the Data Flow Graph.
+	/* Returns the id of the node corresponding to the given NAME.
+ 	 * Returns INVALID_NODE_ID if there is no node by the name in the Data Flow Graph, or if NAME is a constant.
  	 */
-	Node *get_node(const string& name) const;
+	uint32_t get_node(Symbol name) const;
 
 	/* Binds a child node to its parent, by creating an edge from parent to child.
  	 * A child node feeds its output to the parent, so data "flows" from child to parent.
  	 * However, we direct the edge from parent to child.
  	 * This is because when evaluating partial derivatives, we must visit the parent before the child.
  	 * Thus, the "dependency graph edge" must go from parent to child.
+ 	 *
+ 	 * CHILD_NAME may be a constant, in which case the constant is added to the graph if needed.
+ 	 * The child becomes the parent's first child if it has none, and its second child otherwise.
  	 * Returns false if there is no node found for the given CHILD_NAME or PARENT_NAME.
  	 * Returns false if both of the parent's children have already been set.
+ 	 * Returns false if the parent is an INPUT, WEIGHT or EXP_OUTPUT node, or if the child is a loss node.
  	 * Returns true otherwise.
  	 */
-	bool add_flow_edge(const string& child_name, const string& parent_name);
-	
+	bool add_flow_edge(Symbol child_name, Symbol parent_name);
+
 
 	/* Returns the number of nodes in this Data Flow Graph.
  	 * Constant nodes are not included in this, so this number represents the number of variables in the computation.
  	 */
 	int get_num_nodes() const;
 
+	/* Returns one more than the largest id of a node or constant in this graph.
+	 * Every node id is less than this number, so it can be used to size arrays indexed by id.
+	 */
+	uint32_t get_num_ids() const;
+
 	/* Returns the name of the loss node.
-	 * This is an empty string if this DFG has not yet seen a loss node.
+	 * This is an empty string if this DFG has not yet seen a loss node, or if it has several.
 	 */
 	string get_loss_var_name() const;
 
-	/* Returns a pointer to the loss node.
-	 * Returns a NULL pointer if this DFG has not yet seen a loss node.
+	/* Returns the id of the loss node.
+	 * Returns INVALID_NODE_ID if this DFG has not yet seen a loss node, or if it has several.
 	 */
-	Node *get_loss_node() const;
+	uint32_t get_loss_node() const;
 
-	
+	/* Returns the ids of all the loss nodes, in the order they were added. */
+	const vector<uint32_t>& get_loss_nodes() const;
 
-	/* --------------------- Topological Sort Methods ------------------------- */
+	/* Returns the number of bytes of storage allocated for this graph, not counting the names. */
+	size_t get_bytes_allocated() const;
 
 
 
-	/* Sets all nodes in the Data Flow Graph to unmarked.
- 	 * Used in preparation for topological sort.
- 	 */
-	void clear_all_markings();
+	/* --------------------- Node Accessors ------------------------- */
 
-	/* Populates the given list with a sorted ordering of all the nodes in the graph.
-	 * This order is a topologically sorted order of all the Nodes that lead to the Loss node.
+	/* These methods take the id of a node (or constant) in this graph.
+	 * Passing any other id is an error, except where noted.
+	 */
+
+	Symbol get_symbol(uint32_t node) const;
+	string get_name(uint32_t node) const;
+	VariableType get_type(uint32_t node) const;
+	bool is_constant(uint32_t node) const;
+
+	OperationType get_operation(uint32_t node) const;
+	/* Constant nodes cannot have their operation set. */
+	void set_operation(uint32_t node, OperationType operation);
+
+	/* Returns the number of children (0, 1 or 2) of the node. */
+	int get_num_children(uint32_t node) const;
+
+	/* Return the id of the node's first/second child, or INVALID_NODE_ID if it doesn't have one. */
+	uint32_t get_child_one(uint32_t node) const;
+	uint32_t get_child_two(uint32_t node) const;
+
+	/* Returns true if CHILD (which may be INVALID_NODE_ID) is a child of the node. */
+	bool has_child(uint32_t node, uint32_t child) const;
+
+	/* Returns the number of parents of the node. */
+	uint32_t get_num_parents(uint32_t node) const;
+	bool has_parent(uint32_t node) const;
+
+	/* Returns a pointer to the ids of the node's parents, in increasing order.
+	 * There are get_num_parents(NODE) of them.
+	 * The pointer is invalidated when an edge is added to the graph.
+	 */
+	const uint32_t *get_parents(uint32_t node) const;
+
+
+
+	/* --------------------- Topological Sort Methods ------------------------- */
+
+	/* Populates the given vector with the ids of all the nodes that lead to a loss node, in topologically sorted order.
+	 * The loss nodes come first, and every node comes before its children.
 	 * This is a valid ordering to visit the nodes when computing partial derivatives.
-	 * This is the Topological Sorting Algorithm used:
-	 * 
-	 * 	top_sort(nodes):
-	 *		clear_all_markings();
-	 *		top_sort_visit(loss_node)
 	 *
-	 *	top_sort_visit(node):
-	 *		mark temporarily
-	 *		top_sort_visit(child_one); top_sort_visit(child_two);
-	 *		mark permanently
-	 *		add node to head of list
+	 * The sort is an iterative depth-first search with an explicit stack of node ids,
+	 *  so arbitrarily deep graphs (such as long reduce_vector chains) cannot overflow the call stack.
+	 * Nodes are temporarily marked when pushed, and permanently marked when all their children are finished.
+	 * The marks are kept in an array indexed by id, local to the sort.
+	 * Finished ids are appended to SORTED_IDS, which is reversed at the end:
+	 *
+	 *	top_sort(nodes):
+	 *		unmark all nodes
+	 *		for each unmarked loss_node:
+	 *			push loss_node
+	 *			while the stack is not empty:
+	 *				if the top node has an unmarked child, mark it temporarily and push it
+	 *				otherwise mark the top node permanently, pop it, and append it to the result
+	 *		reverse the result
 	 */
-	void top_sort(list<Node *> *sorted_nodes);
-	void top_sort_visit(Node *node, list<Node *> *sorted_nodes);
+	void top_sort(vector<uint32_t> *sorted_ids) const;
+
+	/* Populates the given vector with the ids of the nodes that lead to the node ROOT, sorted as above, with ROOT first. */
+	void top_sort(uint32_t root, vector<uint32_t> *sorted_ids) const;
+
+private:
+
+	/* Appends the nodes that lead to ROOT and are unmarked in MARKS to SORTED_IDS, children first, marking them. */
+	void sort_from(uint32_t root, vector<uint8_t> *marks, vector<uint32_t> *sorted_ids) const;
 };
 
 
@@ -0,0 +1,129 @@
+#include <cfloat>
+#include <cstring>
+#include <unordered_set>
+
+#include "DataSource.h"
+
+using namespace std;
+
+
+DataSource::~DataSource() {
+}
+
+
+
+/* ---------------- DataLayout --------------- */
+
+DataLayout::DataLayout() {
+	column_slots = new vector<uint32_t>();
+}
+
+
+DataLayout::~DataLayout() {
+	delete column_slots;
+}
+
+
+int DataLayout::build(const Program& gcp, const vector<string>& column_names) {
+
+	column_slots->clear();
+	unordered_set<string> seen;
+	for (size_t c = 0; c < column_names.size(); c++) {
+		if (!seen.insert(column_names[c]).second) return OTHER_ERROR;
+
+		// only inputs are data (expected outputs and weights are inputs of a GCP); a column of a weight clashes with it as it is bound
+		uint32_t slot = gcp.get_slot(Symbol::find(column_names[c]));
+		if (slot != INVALID_SLOT && gcp.get_slot_type(slot) != VariableType::INPUT && gcp.get_slot_type(slot) != VariableType::EXP_OUTPUT) {
+			slot = INVALID_SLOT;
+		}
+		column_slots->push_back(slot);
+	}
+	return 0;
+}
+
+
+size_t DataLayout::size() const {
+	return column_slots->size();
+}
+
+
+int DataLayout::bind_row(const DataBatch& batch, size_t row, vector<double> *values) const {
+	if (batch.columns.size() != column_slots->size() || row >= batch.num_rows) return OTHER_ERROR;
+
+	for (size_t c = 0; c < column_slots->size(); c++) {
+		uint32_t slot = (*column_slots)[c];
+		if (slot == INVALID_SLOT) continue;
+
+		double value = batch.columns[c][row];
+		if ((*values)[slot] != DBL_MAX) return VAR_DECLARED_TWICE;
+		if (value == DBL_MIN || value == DBL_MAX) return OTHER_ERROR;
+		(*values)[slot] = value;
+	}
+	return 0;
+}
+
+
+
+void shuffle_rows(vector<uint64_t> *order, mt19937_64 *rng) {
+	for (size_t i = order->size(); i > 1; i--) {
+		size_t j = (*rng)() % i;
+		swap((*order)[i - 1], (*order)[j]);
+	}
+}
+
+
+
+/* ---------------- Little-endian numbers --------------- */
+
+void encode_uint32(uint32_t value, char *bytes) {
+	for (int i = 0; i < 4; i++) bytes[i] = (char) (value >> (8 * i));
+}
+
+uint32_t decode_uint32(const char *bytes) {
+	uint32_t value = 0;
+	for (int i = 0; i < 4; i++) value |= (uint32_t) (unsigned char) bytes[i] << (8 * i);
+	return value;
+}
+
+void encode_uint64(uint64_t value, char *bytes) {
+	for (int i = 0; i < 8; i++) bytes[i] = (char) (value >> (8 * i));
+}
+
+uint64_t decode_uint64(const char *bytes) {
+	uint64_t value = 0;
+	for (int i = 0; i < 8; i++) value |= (uint64_t) (unsigned char) bytes[i] << (8 * i);
+	return value;
+}
+
+void encode_float(float value, char *bytes) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	encode_uint32(bits, bytes);
+}
+
+float decode_float(const char *bytes) {
+	uint32_t bits = decode_uint32(bytes);
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+void encode_double(double value, char *bytes) {
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	encode_uint64(bits, bytes);
+}
+
+double decode_double(const char *bytes) {
+	uint64_t bits = decode_uint64(bytes);
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+bool is_little_endian() {
+	uint16_t one = 1;
+	unsigned char first;
+	memcpy(&first, &one, 1);
+	return first == 1;
+}
@@ -0,0 +1,129 @@
+#ifndef DATA_SOURCE_H
+#define DATA_SOURCE_H
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdint>
+
+#include "Program.h"
+#include "utilities.h"
+
+using namespace std;
+
+
+/* This file defines how training streams its data, rather than holding all of it in memory as maps of names.
+ *
+ * A DataSource hands out the training data in batches, pass after pass. Every datum has the same fixed layout: one value for every column,
+ *  and every column names an input or an expected output of the GCP (x.0, x.1, y, ...).
+ * A batch is laid out column by column (structure of arrays): the values of one column, for every datum of the batch, are contiguous,
+ *  so binding a datum is one indexed load per column, and a batch can be filled, or pointed at, without knowing the GCP.
+ * A DataLayout gives every column its slot in the GCP, once, and then binds data by slot, as ParameterLayout does for the weights:
+ *
+ 	layout.build(gcp, source->get_column_names())
+ 	source->start_pass(batch_size, rng)
+ 	while source->next_batch(&batch) gives a batch with rows:
+ 		for every row:
+ 			values = weight_values
+ 			layout.bind_row(batch, row, &values)
+ 			run the GCP on values
+ *
+ * Names are only used once, to build the layout.
+ */
+
+
+/* A batch of NUM_ROWS data, one column at a time: COLUMNS[c][r] is the value of column c for datum r.
+ * The columns point into STORAGE, when the DataSource decodes the data into the batch, or into memory the DataSource owns.
+ * Swapping two batches keeps their columns valid, since they follow their storage, so batches are passed around by swapping, not copying.
+ */
+struct DataBatch {
+	size_t num_rows = 0;
+	vector<const double *> columns;
+	vector<double> storage;
+};
+
+
+/* A DataSource hands out the training data in batches (see the comment at the top of this file). */
+class DataSource {
+
+public:
+
+	virtual ~DataSource();
+
+	/* Returns the name of every column, in order. */
+	virtual const vector<string>& get_column_names() const = 0;
+
+	/* Returns the number of data. */
+	virtual int64_t get_num_records() const = 0;
+
+	/* Starts a pass over every datum, in batches of BATCH_SIZE data (the last batch of the pass may have fewer), which ends any pass before it.
+	 * If RNG is NULL, the data come in order. Otherwise they come in an order drawn from RNG, which need not be uniform,
+	 *  but is the same for the same state of RNG (see RecordFileSource).
+	 * Returns OTHER_ERROR if BATCH_SIZE is 0, and 0 otherwise.
+	 */
+	virtual int start_pass(size_t batch_size, mt19937_64 *rng) = 0;
+
+	/* Swaps the next batch of the pass into BATCH, whose rows are 0 once the pass is over.
+	 * Returns OTHER_ERROR if no pass was started, an error code if the data could not be read, and 0 otherwise.
+	 */
+	virtual int next_batch(DataBatch *batch) = 0;
+
+};
+
+
+/* A DataLayout gives every column of a DataSource the slot of its variable in a GCP, so data are bound by slot (see the top of this file). */
+class DataLayout {
+
+private:
+
+	/* The slot of every column, or INVALID_SLOT if the GCP has no input or expected output of that name. */
+	vector<uint32_t> *column_slots;
+
+
+public:
+
+	/* Constructor. Creates a layout with no columns. */
+	DataLayout();
+
+	/* Destructor. */
+	~DataLayout();
+
+	/* Lays out the columns COLUMN_NAMES for the loaded GCP. Columns that are not inputs of the GCP are ignored, as bind_values ignores them.
+	 * Returns OTHER_ERROR if a column is named twice, and 0 otherwise.
+	 */
+	int build(const Program& gcp, const vector<string>& column_names);
+
+	/* Returns the number of columns. */
+	size_t size() const;
+
+	/* Writes the values of datum ROW of BATCH into their slots of VALUES, as bind_values does.
+	 * Returns OTHER_ERROR if BATCH does not have a column for every column of the layout, or if a value is DBL_MIN or DBL_MAX,
+	 *  VAR_DECLARED_TWICE if a slot was already bound, and 0 otherwise.
+	 */
+	int bind_row(const DataBatch& batch, size_t row, vector<double> *values) const;
+
+};
+
+
+/* Shuffles ORDER with RNG, as shuffle_indices does (see GradientDescent.h), for the DataSources that shuffle what they read. */
+void shuffle_rows(vector<uint64_t> *order, mt19937_64 *rng);
+
+
+/* The binary files of training data (see RecordFile.h and ColumnarFile.h) hold every number little-endian, whatever the byte order
+ *  of the machine. These write and read one number at BYTES. The compiler turns them into plain stores and loads on little-endian machines.
+ */
+void encode_uint32(uint32_t value, char *bytes);
+uint32_t decode_uint32(const char *bytes);
+void encode_uint64(uint64_t value, char *bytes);
+uint64_t decode_uint64(const char *bytes);
+void encode_float(float value, char *bytes);
+float decode_float(const char *bytes);
+void encode_double(double value, char *bytes);
+double decode_double(const char *bytes);
+
+/* Returns true if the machine is little-endian, so the numbers of the binary files can be used where they are, without decoding them. */
+bool is_little_endian();
+
+
+
+#endif
@@ -0,0 +1,78 @@
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "DenseVector.h"
+
+using namespace std;
+
+
+void dense_axpy(double a, const double *x, double *y, size_t n) {
+	size_t i = 0;
+
+#ifdef __SSE2__
+	__m128d a2 = _mm_set1_pd(a);
+	for (; i + 2 <= n; i += 2) {
+		__m128d product = _mm_mul_pd(a2, _mm_loadu_pd(x + i));
+		_mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), product));
+	}
+#endif
+
+	for (; i < n; i++) y[i] += a * x[i];
+}
+
+
+void dense_axpby(double a, const double *x, double b, double *y, size_t n) {
+	size_t i = 0;
+
+#ifdef __SSE2__
+	__m128d a2 = _mm_set1_pd(a), b2 = _mm_set1_pd(b);
+	for (; i + 2 <= n; i += 2) {
+		__m128d product = _mm_mul_pd(a2, _mm_loadu_pd(x + i));
+		_mm_storeu_pd(y + i, _mm_add_pd(product, _mm_mul_pd(b2, _mm_loadu_pd(y + i))));
+	}
+#endif
+
+	for (; i < n; i++) y[i] = a * x[i] + b * y[i];
+}
+
+
+void dense_scale(double a, double *x, size_t n) {
+	size_t i = 0;
+
+#ifdef __SSE2__
+	__m128d a2 = _mm_set1_pd(a);
+	for (; i + 2 <= n; i += 2) {
+		_mm_storeu_pd(x + i, _mm_mul_pd(a2, _mm_loadu_pd(x + i)));
+	}
+#endif
+
+	for (; i < n; i++) x[i] *= a;
+}
+
+
+double dense_dot(const double *x, const double *y, size_t n) {
+	size_t i = 0;
+	double sum = 0;
+
+#ifdef __SSE2__
+	// the even and the odd products are summed apart, and the two sums added at the end
+	__m128d sums = _mm_setzero_pd();
+	for (; i + 2 <= n; i += 2) {
+		sums = _mm_add_pd(sums, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+	}
+	double lanes[2];
+	_mm_storeu_pd(lanes, sums);
+	sum = lanes[0] + lanes[1];
+#endif
+
+	for (; i < n; i++) sum += x[i] * y[i];
+	return sum;
+}
+
+
+double dense_norm(const double *x, size_t n) {
+	return sqrt(dense_dot(x, x, n));
+}
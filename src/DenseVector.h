@@ -0,0 +1,34 @@
+#ifndef DENSEVECTOR_H
+#define DENSEVECTOR_H
+
+#include <cstddef>
+
+using namespace std;
+
+
+/* This file defines the kernels of the dense vector math of the Weight Calculation Phase, in the style of BLAS level 1.
+ * The weights, the gradient and the state of every Optimizer are contiguous arrays of doubles indexed by weight
+ *  (see ParameterLayout.h), so every step of training is a handful of passes over arrays, rather than lookups by name.
+ * Every kernel works on N values, two at a time where SSE2 is available, and one at a time otherwise:
+ *  the results are the same either way, but for the order in which dense_dot adds its products.
+ */
+
+
+/* Y += A * X */
+void dense_axpy(double a, const double *x, double *y, size_t n);
+
+/* Y = A * X + B * Y */
+void dense_axpby(double a, const double *x, double b, double *y, size_t n);
+
+/* X *= A */
+void dense_scale(double a, double *x, size_t n);
+
+/* Returns the dot product of X and Y. */
+double dense_dot(const double *x, const double *y, size_t n);
+
+/* Returns the Pythagorean length of X. */
+double dense_norm(const double *x, size_t n);
+
+
+
+#endif
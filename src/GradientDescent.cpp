@@ -1,32 +1,885 @@
 #include <vector>
+#include <random>
+#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include "math.h"
 
 #include "GradientDescent.h"
-#include "Interpreter.h"
+#include "DenseVector.h"
+#include "Allreduce.h"
+#include "ParameterServer.h"
+#include "Checkpoint.h"
+#include "DataSource.h"
+#include "Program.h"
 #include "BindingsDictionary.h"
+#include "Compiler.h"
 #include "utilities.h"
 
 using namespace std;
 
 
+/* Binds one datum on top of WEIGHT_VALUES, in a copy of them in VALUES, and runs the GCP on it with a sparse run.
+ * Binding a variable twice is caught as it is bound. Returns the errors of find_sparse_partials.
+ */
+static int run_datum(const Program& gcp, const vector<double>& weight_values, const VariableVector& inputs,
+	const SparseVariableVector& sparse_inputs, const VariableVector& outputs, vector<double> *values) {
+
+	*values = weight_values;
+	int success = gcp.bind_values(inputs, values);
+	if (success == 0) success = gcp.bind_values(outputs, values);
+	if (success == 0) success = gcp.bind_sparse_values(sparse_inputs, values);
+	if (success == 0) success = gcp.check_inputs_bound(*values);
+	if (success == 0) success = gcp.run_sparse(values);
+	return success;
+}
+
+
 VariableVector calculate_weights(const string& gcp_filename, const vector<string>& weight_names,
 	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data) {
 
-	VariableVector weights = initial_weight_guess(weight_names);
-	VariableVector gradient = avg_gradient(gcp_filename, partial_names, weights, training_data);
-
-	int num_iterations = 0;
 	cout << "Calculating weights for GCP " << gcp_filename << "..." << endl;
-	while (!approx_zero(gradient, partial_names) && num_iterations < MAX_NUM_ITERATIONS) {
-		weights = increment_weight_vector(weights, scale_variable_vector(gradient, -1 * LEARNING_RATE));
-		gradient = avg_gradient(gcp_filename, partial_names, weights, training_data);
+
+	Program gcp;
+	if (gcp.load(gcp_filename) != 0) {
+		VariableVector empty;
+		return empty;
+	}
+
+	return calculate_weights(gcp, weight_names, partial_names, training_data);
+}
+
+
+VariableVector calculate_weights(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data) {
+	return calculate_weights(gcp, weight_names, partial_names, training_data, vector<SparseVariableVector>(training_data.size()));
+}
+
+VariableVector calculate_weights(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs) {
+	return calculate_weights(gcp, weight_names, partial_names, training_data, sparse_inputs, OptimizerOptions());
+}
+
+
+/* The average loss over the training data, as a function of the weights, for the Optimizers and for L-BFGS.
+ * Each evaluation is one pass of the GCP over the training data, which gives both the loss and the gradient.
+ * The loss is only read if there is an OBJECTIVE (L-BFGS needs it, and the Optimizers do not), and is 0 otherwise.
+ */
+class TrainingLoss : public LossFunction {
+
+	const Program& gcp;
+	const ParameterLayout& layout;
+	const vector<ObjectiveTerm> *objective;
+	const vector<pair<VariableVector, VariableVector> >& training_data;
+	const vector<SparseVariableVector>& sparse_inputs;
+
+public:
+
+	TrainingLoss(const Program& gcp, const ParameterLayout& layout, const vector<ObjectiveTerm> *objective,
+		const vector<pair<VariableVector, VariableVector> >& training_data, const vector<SparseVariableVector>& sparse_inputs)
+		: gcp(gcp), layout(layout), objective(objective), training_data(training_data), sparse_inputs(sparse_inputs) {
+	}
+
+	int evaluate(const vector<double>& weights, double *loss, vector<double> *gradient) {
+		return avg_dense_loss_and_gradient(gcp, layout, objective, weights, training_data, sparse_inputs,
+			NULL, training_data.size(), loss, gradient);
+	}
+
+};
+
+
+/* Writes the state of a run into STATE, to be checkpointed: the weights of LAYOUT, the NUM_STEPS steps taken, and the state of OPTIMIZER.
+ * Stochastic runs also give the EPOCH, the position of the NEXT_BATCH in it, the ORDER of the data in it, and the RNG that shuffles them;
+ *  full-batch runs give NULL for both.
+ */
+static void capture_state(const ParameterLayout& layout, const vector<double>& weights, int64_t num_steps, const Optimizer& optimizer,
+	int64_t epoch, size_t next_batch, const vector<size_t> *order, const mt19937_64 *rng, TrainingState *state) {
+
+	state->weight_names = layout.get_weight_names();
+	state->weights = weights;
+	state->num_steps = num_steps;
+	state->optimizer_steps = optimizer.get_num_steps();
+	state->optimizer_state.resize(optimizer.get_num_state_arrays());
+	for (size_t i = 0; i < optimizer.get_num_state_arrays(); i++) state->optimizer_state[i] = optimizer.get_state_array(i);
+
+	state->epoch = epoch;
+	state->next_batch = next_batch;
+	state->order.clear();
+	state->rng_state.clear();
+	if (order != NULL) state->order.assign(order->begin(), order->end());
+	if (rng != NULL) {
+		stringstream rng_state;
+		rng_state << *rng;
+		state->rng_state = rng_state.str();
+	}
+}
+
+
+/* Reads the checkpoint in the file of OPTIONS, if OPTIONS asks to resume from one, and puts the run back in its state, as capture_state wrote it.
+ * Stochastic runs give ORDER and RNG, whose state is restored too, along with the EPOCH and the position of the NEXT_BATCH in it.
+ * Stochastic runs on a DataSource give RNG alone: its state is the one the pass of the EPOCH started from, and NEXT_BATCH the number of batches read.
+ * If the file does not exist, there is nothing to resume, and the run starts over.
+ *
+ * Returns OTHER_ERROR if the file is not a checkpoint (see read_training_state), or not one of this run:
+ *  if it has other weights, the state of another Optimizer, or an order of another number of data (or an order at all, for a DataSource),
+ *  or, for a full-batch run (which gives neither), if it has any position in the data at all. Returns 0 otherwise.
+ */
+static int resume_state(const CheckpointOptions& options, const ParameterLayout& layout, vector<double> *weights, int64_t *num_steps,
+	Optimizer *optimizer, int64_t *epoch, size_t *next_batch, vector<size_t> *order, mt19937_64 *rng) {
+
+	if (!options.resume || options.filename == "") return 0;
+	TrainingState state;
+	int success = read_training_state(options.filename, &state);
+	if (success == INVALID_FILE_NAME) return 0;
+	if (success != 0) return OTHER_ERROR;
+
+	if (state.weight_names != layout.get_weight_names() || state.weights.size() != layout.size() || state.num_steps < 0) return OTHER_ERROR;
+	if (optimizer->restore_state(state.optimizer_steps, state.optimizer_state) != 0) return OTHER_ERROR;
+
+	if (order != NULL) {
+		// the order must be a permutation of the data, as shuffle_indices leaves it
+		vector<bool> seen(order->size(), false);
+		if (state.order.size() != order->size() || state.epoch < 0 || state.next_batch < 0 || state.next_batch > (int64_t) order->size()) return OTHER_ERROR;
+		for (size_t i = 0; i < state.order.size(); i++) {
+			if (state.order[i] >= seen.size() || seen[state.order[i]]) return OTHER_ERROR;
+			seen[state.order[i]] = true;
+		}
+		stringstream rng_state(state.rng_state);
+		rng_state >> *rng;
+		if (rng_state.fail()) return OTHER_ERROR;
+		order->assign(state.order.begin(), state.order.end());
+		*epoch = state.epoch;
+		*next_batch = state.next_batch;
+	}
+
+	// a run on a DataSource replays the pass from the state of RNG, so its checkpoints have no order
+	else if (rng != NULL) {
+		if (!state.order.empty() || state.epoch < 0 || state.next_batch < 0) return OTHER_ERROR;
+		stringstream rng_state(state.rng_state);
+		rng_state >> *rng;
+		if (rng_state.fail()) return OTHER_ERROR;
+		*epoch = state.epoch;
+		*next_batch = state.next_batch;
+	}
+
+	// a full-batch run only resumes full-batch checkpoints, which have no order, RNG or position
+	else if (!state.order.empty() || !state.rng_state.empty() || state.epoch != 0 || state.next_batch != 0) {
+		return OTHER_ERROR;
+	}
+
+	*weights = state.weights;
+	*num_steps = state.num_steps;
+	return 0;
+}
+
+
+/* Moves WEIGHTS to the minimum of LOSS_FUNCTION with L-BFGS, if OPTIONS names it (see minimize_lbfgs),
+ *  and otherwise with the Optimizer OPTIONS names, for at most OPTIONS.max_iterations steps,
+ *  or until the length of the gradient is within OPTIONS.gradient_precision.
+ * The Optimizer's steps are checkpointed as CHECKPOINT_OPTIONS asks (see Checkpoint.h), while the next steps are taken,
+ *  and resumed from the last checkpoint, if it asks to. The weights are those of LAYOUT. L-BFGS runs are never checkpointed.
+ * If NUM_EVALUATIONS is not NULL, the number of times the loss was evaluated is written into it.
+ *
+ * Returns OTHER_ERROR if the Optimizer could not be created, or if the checkpoint cannot be resumed (see resume_state),
+ *  INVALID_FILE_NAME if a checkpoint could not be written, the error of the loss function if it could not be evaluated, and 0 otherwise.
+ */
+static int minimize_loss(LossFunction *loss_function, const ParameterLayout& layout, const OptimizerOptions& options,
+	const CheckpointOptions& checkpoint_options, vector<double> *weights, int64_t *num_evaluations) {
+
+	if (options.type == OptimizerType::LBFGS) return minimize_lbfgs(loss_function, options, weights, num_evaluations);
+
+	if (num_evaluations != NULL) *num_evaluations = 0;
+	Optimizer *optimizer = create_optimizer(weights->size(), options);
+	if (optimizer == NULL) return OTHER_ERROR;
+
+	int64_t num_iterations = 0, epoch;
+	size_t next_batch;
+	int success = resume_state(checkpoint_options, layout, weights, &num_iterations, optimizer, &epoch, &next_batch, NULL, NULL);
+	CheckpointWriter *writer = checkpoint_options.filename == "" ? NULL : new CheckpointWriter(checkpoint_options.filename);
+	TrainingState state;
+
+	double loss;
+	vector<double> gradient;
+	if (success == 0) success = loss_function->evaluate(*weights, &loss, &gradient);
+	if (num_evaluations != NULL) *num_evaluations = 1;
+
+	while (success == 0 && dense_norm(gradient.data(), gradient.size()) > options.gradient_precision && num_iterations < options.max_iterations) {
+		success = optimizer->step(gradient, weights);
+		if (success != 0) break;
+		success = loss_function->evaluate(*weights, &loss, &gradient);
+		if (num_evaluations != NULL) (*num_evaluations)++;
 		num_iterations++;
-		if (gradient.size() == 0) break;
+
+		if (writer != NULL && checkpoint_options.interval != 0 && num_iterations % checkpoint_options.interval == 0) {
+			capture_state(layout, *weights, num_iterations, *optimizer, 0, 0, NULL, NULL, &state);
+			writer->submit(&state);
+		}
+	}
+
+	// the last checkpoint is of the weights the run ends with
+	if (writer != NULL) {
+		if (success == 0) {
+			capture_state(layout, *weights, num_iterations, *optimizer, 0, 0, NULL, NULL, &state);
+			writer->submit(&state);
+		}
+		int written = writer->finish();
+		if (success == 0) success = written;
+		delete writer;
+	}
+	delete optimizer;
+	return success;
+}
+
+
+VariableVector calculate_weights(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const OptimizerOptions& options) {
+	return calculate_weights(gcp, weight_names, partial_names, training_data, sparse_inputs, options, CheckpointOptions());
+}
+
+
+VariableVector calculate_weights(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const OptimizerOptions& options, const CheckpointOptions& checkpoint_options) {
+
+	VariableVector empty;
+	if (options.type == OptimizerType::LBFGS) {
+		if (checkpoint_options.filename != "") return empty;
+		return calculate_weights_lbfgs(gcp, weight_names, partial_names, training_data, sparse_inputs, options, NULL);
+	}
+
+	ParameterLayout layout;
+	if (layout.build(gcp, weight_names, partial_names) != 0) return empty;
+
+	VariableVector weights = initial_weight_guess(weight_names);
+	vector<double> weight_values;
+	layout.gather_weights(weights, &weight_values);
+
+	TrainingLoss loss(gcp, layout, NULL, training_data, sparse_inputs);
+	if (minimize_loss(&loss, layout, options, checkpoint_options, &weight_values, NULL) != 0) return empty;
+
+	layout.scatter_weights(weight_values, &weights);
+	return weights;
+}
+
+
+VariableVector calculate_weights_lbfgs(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const OptimizerOptions& options, int64_t *num_evaluations) {
+
+	VariableVector empty;
+	if (num_evaluations != NULL) *num_evaluations = 0;
+	ParameterLayout layout;
+	if (layout.build(gcp, weight_names, partial_names) != 0) return empty;
+	vector<ObjectiveTerm> objective;
+	if (find_objective_terms(gcp, partial_names, &objective) != 0) return empty;
+
+	VariableVector weights = initial_weight_guess(weight_names);
+	vector<double> weight_values;
+	layout.gather_weights(weights, &weight_values);
+
+	TrainingLoss loss(gcp, layout, &objective, training_data, sparse_inputs);
+	if (minimize_lbfgs(&loss, options, &weight_values, num_evaluations) != 0) return empty;
+
+	layout.scatter_weights(weight_values, &weights);
+	return weights;
+}
+
+
+/* The average loss over the training data, as a function of the weights, as one worker of data_parallel_gradient_descent sees it.
+ * The worker runs the GCP over its own shard of the training data only, and the sums of every shard are added up by an allreduce.
+ * Every value the allreduce sums is packed into one array, so there is one allreduce for every evaluation:
+ *
+ 	the partials, summed over the shard and divided by the number of data		one value for every weight
+ 	the loss, summed over the shard and divided by the number of data			one value
+ 	the error of every worker, in its own column						one value for every worker
+ *
+ * Every worker gets the same sums, and so the same errors, and they all take the same step, or all fail, together.
+ */
+class ShardedTrainingLoss : public LossFunction {
+
+	TrainingLoss shard_loss;
+	Communicator *communicator;
+	double shard_fraction;
+	vector<double> packed;
+
+public:
+
+	ShardedTrainingLoss(const Program& gcp, const ParameterLayout& layout, const vector<ObjectiveTerm> *objective,
+		const vector<pair<VariableVector, VariableVector> >& shard_data, const vector<SparseVariableVector>& shard_sparse_inputs,
+		size_t num_data, Communicator *communicator)
+		: shard_loss(gcp, layout, objective, shard_data, shard_sparse_inputs), communicator(communicator),
+		shard_fraction((double) shard_data.size() / num_data) {
+	}
+
+	int evaluate(const vector<double>& weights, double *loss, vector<double> *gradient) {
+		double shard_average = 0;
+		int success = shard_loss.evaluate(weights, &shard_average, gradient);
+
+		// a worker that failed still takes part in the allreduce, so that the others do not wait for it
+		size_t n = weights.size();
+		packed.assign(n + 1 + communicator->get_size(), 0);
+		if (success == 0) {
+			dense_axpy(shard_fraction, gradient->data(), packed.data(), n);
+			packed[n] = shard_fraction * shard_average;
+		}
+		packed[n + 1 + communicator->get_rank()] = success;
+
+		int error = communicator->allreduce_sum(packed.data(), packed.size());
+		if (error != 0) return error;
+
+		for (size_t r = 0; r < communicator->get_size(); r++) {
+			if (packed[n + 1 + r] != 0) return (int) packed[n + 1 + r];
+		}
+		gradient->assign(packed.begin(), packed.begin() + n);
+		*loss = packed[n];
+		return 0;
+	}
+
+};
+
+
+/* What every worker of data_parallel_gradient_descent runs: it copies its shard of the training data, minimizes the loss over all of them
+ *  (see ShardedTrainingLoss), and worker 0 hands back the weights, which are the same in every worker.
+ */
+class DataParallelWorker : public Worker {
+
+	const Program& gcp;
+	const ParameterLayout& layout;
+	const vector<ObjectiveTerm> *objective;
+	const vector<pair<VariableVector, VariableVector> >& training_data;
+	const vector<SparseVariableVector>& sparse_inputs;
+	const OptimizerOptions& options;
+	const vector<double>& initial_weights;
+
+public:
+
+	DataParallelWorker(const Program& gcp, const ParameterLayout& layout, const vector<ObjectiveTerm> *objective,
+		const vector<pair<VariableVector, VariableVector> >& training_data, const vector<SparseVariableVector>& sparse_inputs,
+		const OptimizerOptions& options, const vector<double>& initial_weights)
+		: gcp(gcp), layout(layout), objective(objective), training_data(training_data), sparse_inputs(sparse_inputs),
+		options(options), initial_weights(initial_weights) {
+	}
+
+	int run(Communicator *communicator) {
+		// the shards are contiguous, and differ in size by at most one datum
+		size_t first = communicator->get_rank() * training_data.size() / communicator->get_size();
+		size_t last = (communicator->get_rank() + 1) * training_data.size() / communicator->get_size();
+		vector<pair<VariableVector, VariableVector> > shard_data(training_data.begin() + first, training_data.begin() + last);
+		vector<SparseVariableVector> shard_sparse_inputs(sparse_inputs.begin() + first, sparse_inputs.begin() + last);
+
+		ShardedTrainingLoss loss(gcp, layout, objective, shard_data, shard_sparse_inputs, training_data.size(), communicator);
+		vector<double> weights = initial_weights;
+		int success = minimize_loss(&loss, layout, options, CheckpointOptions(), &weights, NULL);
+		if (success == 0 && communicator->get_rank() == 0) success = communicator->write_result(weights.data(), weights.size());
+		return success;
+	}
+
+};
+
+
+VariableVector data_parallel_gradient_descent(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const OptimizerOptions& options, size_t num_processes) {
+
+	VariableVector empty;
+	if (num_processes == 0 || training_data.empty() || sparse_inputs.size() != training_data.size()) return empty;
+	if (check_optimizer_options(options) != 0) return empty;
+
+	ParameterLayout layout;
+	if (layout.build(gcp, weight_names, partial_names) != 0) return empty;
+	vector<ObjectiveTerm> objective;
+	if (options.type == OptimizerType::LBFGS && find_objective_terms(gcp, partial_names, &objective) != 0) return empty;
+
+	VariableVector weights = initial_weight_guess(weight_names);
+	vector<double> weight_values;
+	layout.gather_weights(weights, &weight_values);
+
+	DataParallelWorker worker(gcp, layout, options.type == OptimizerType::LBFGS ? &objective : NULL,
+		training_data, sparse_inputs, options, weight_values);
+	size_t num_values = layout.size() + 1 + num_processes;
+	vector<double> result;
+	if (run_worker_processes(num_processes, num_values, &worker, &result) != 0) return empty;
+
+	result.resize(layout.size());
+	layout.scatter_weights(result, &weights);
+	return weights;
+}
+
+VariableVector stochastic_gradient_descent(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const SGDOptions& options, const OptimizerOptions& optimizer_options) {
+	return stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options, optimizer_options,
+		CheckpointOptions());
+}
+
+
+VariableVector stochastic_gradient_descent(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const SGDOptions& options, const OptimizerOptions& optimizer_options,
+	const CheckpointOptions& checkpoint_options) {
+
+	VariableVector empty;
+	if (options.num_threads > 1) {
+		if (checkpoint_options.filename != "") return empty;
+		return hogwild_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options, optimizer_options, NULL);
+	}
+
+	if (options.batch_size == 0 || sparse_inputs.size() != training_data.size()) return empty;
+
+	ParameterLayout layout;
+	if (layout.build(gcp, weight_names, partial_names) != 0) return empty;
+
+	Optimizer *optimizer = create_optimizer(layout.size(), optimizer_options);
+	if (optimizer == NULL) return empty;
+
+	VariableVector weights = initial_weight_guess(weight_names);
+	vector<double> weight_values, gradient;
+	layout.gather_weights(weights, &weight_values);
+
+	// the data are visited through a permutation of their indices, which is shuffled again before every epoch
+	vector<size_t> order(training_data.size());
+	for (size_t i = 0; i < order.size(); i++) order[i] = i;
+	mt19937_64 rng(options.seed);
+
+	// the run may resume in the middle of an epoch, whose order was shuffled before the checkpoint
+	int64_t num_steps = 0, epoch = 0;
+	size_t next_batch = 0;
+	int success = resume_state(checkpoint_options, layout, &weight_values, &num_steps, optimizer, &epoch, &next_batch, &order, &rng);
+	CheckpointWriter *writer = checkpoint_options.filename == "" ? NULL : new CheckpointWriter(checkpoint_options.filename);
+	TrainingState state;
+
+	for (; epoch < options.max_epochs && success == 0; epoch++, next_batch = 0) {
+		if (options.max_steps != 0 && num_steps >= options.max_steps) break;
+		if (next_batch == 0) shuffle_indices(&order, &rng);
+
+		while (next_batch < order.size() && success == 0) {
+			if (options.max_steps != 0 && num_steps >= options.max_steps) break;
+
+			size_t batch_size = min(options.batch_size, order.size() - next_batch);
+			success = avg_dense_loss_and_gradient(gcp, layout, NULL, weight_values, training_data, sparse_inputs,
+				order.data() + next_batch, batch_size, NULL, &gradient);
+			if (success != 0) break;
+			success = optimizer->step(gradient, &weight_values);
+			num_steps++;
+			next_batch += batch_size;
+
+			if (writer != NULL && checkpoint_options.interval != 0 && num_steps % checkpoint_options.interval == 0) {
+				capture_state(layout, weight_values, num_steps, *optimizer, epoch, next_batch, &order, &rng, &state);
+				writer->submit(&state);
+			}
+		}
+		if (options.max_steps != 0 && num_steps >= options.max_steps) break;
+	}
+
+	// the last checkpoint is where the run stops, so a run with more epochs or steps carries on from there
+	if (writer != NULL) {
+		if (success == 0) {
+			capture_state(layout, weight_values, num_steps, *optimizer, epoch, next_batch, &order, &rng, &state);
+			writer->submit(&state);
+		}
+		int written = writer->finish();
+		if (success == 0) success = written;
+		delete writer;
+	}
+	delete optimizer;
+	if (success != 0) return empty;
+	layout.scatter_weights(weight_values, &weights);
+	return weights;
+}
+
+/* Sets up WEIGHT_VALUES for runs of the GCP on streamed data: the WEIGHTS of LAYOUT, and the FIXED_INPUTS every datum shares, are bound once.
+ * Returns the errors of bind_weights and bind_values.
+ */
+static int bind_shared_values(const Program& gcp, const ParameterLayout& layout, const vector<double>& weights,
+	const VariableVector& fixed_inputs, vector<double> *weight_values) {
+
+	gcp.init_values(weight_values);
+	int success = layout.bind_weights(weights, weight_values);
+	if (success == 0) success = gcp.bind_values(fixed_inputs, weight_values);
+	return success;
+}
+
+
+/* Runs the GCP on every datum of BATCH, bound by DATA_LAYOUT on top of WEIGHT_VALUES, in a copy of them in VALUES,
+ *  and adds the partials into GRADIENT and, if there is an OBJECTIVE, the loss into SUM_OF_LOSSES, as avg_dense_loss_and_gradient does.
+ * Returns the errors of avg_dense_loss_and_gradient, and of bind_row.
+ */
+static int add_batch_partials(const Program& gcp, const ParameterLayout& layout, const DataLayout& data_layout,
+	const vector<ObjectiveTerm> *objective, const vector<double>& weight_values, const DataBatch& batch, vector<double> *values,
+	double *gradient, double *sum_of_losses) {
+
+	for (size_t row = 0; row < batch.num_rows; row++) {
+		*values = weight_values;
+		int success = data_layout.bind_row(batch, row, values);
+		if (success == 0) success = gcp.check_inputs_bound(*values);
+		if (success == 0) success = gcp.run_sparse(values);
+		if (success != 0) return success;
+
+		if (layout.has_other_outputs(*values)) return OTHER_ERROR;
+		layout.add_partials(*values, gradient);
+		for (size_t t = 0; objective != NULL && t < objective->size(); t++) {
+			const ObjectiveTerm& term = (*objective)[t];
+			*sum_of_losses += (*values)[term.loss_slot] * (term.seed_slot == INVALID_SLOT ? 1 : (*values)[term.seed_slot]);
+		}
+	}
+	return 0;
+}
+
+
+/* The average loss over training data streamed from a DataSource, as a function of the weights, as TrainingLoss is for data in memory.
+ * Each evaluation is one pass over the source, in order: the batches are summed into one gradient, as they come, and then averaged.
+ */
+class StreamingLoss : public LossFunction {
+
+	const Program& gcp;
+	const ParameterLayout& layout;
+	const DataLayout& data_layout;
+	const vector<ObjectiveTerm> *objective;
+	DataSource *source;
+	const VariableVector& fixed_inputs;
+	DataBatch batch;
+	vector<double> weight_values, values;
+
+public:
+
+	StreamingLoss(const Program& gcp, const ParameterLayout& layout, const DataLayout& data_layout, const vector<ObjectiveTerm> *objective,
+		DataSource *source, const VariableVector& fixed_inputs)
+		: gcp(gcp), layout(layout), data_layout(data_layout), objective(objective), source(source), fixed_inputs(fixed_inputs) {
+	}
+
+	int evaluate(const vector<double>& weights, double *loss, vector<double> *gradient) {
+		int success = bind_shared_values(gcp, layout, weights, fixed_inputs, &weight_values);
+		if (success == 0) success = source->start_pass(STREAMING_BATCH_SIZE, NULL);
+		if (success != 0) return success;
+
+		gradient->assign(layout.size(), 0);
+		double sum_of_losses = 0;
+		int64_t num_data = 0;
+		while ((success = source->next_batch(&batch)) == 0 && batch.num_rows > 0) {
+			success = add_batch_partials(gcp, layout, data_layout, objective, weight_values, batch, &values, gradient->data(), &sum_of_losses);
+			if (success != 0) return success;
+			num_data += batch.num_rows;
+		}
+		if (success != 0) return success;
+
+		if (num_data > 0) dense_scale(1.0 / num_data, gradient->data(), gradient->size());
+		*loss = num_data == 0 ? 0 : sum_of_losses / num_data;
+		return 0;
+	}
+
+};
+
+
+VariableVector calculate_weights(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, DataSource *source, const VariableVector& fixed_inputs,
+	const OptimizerOptions& options, const CheckpointOptions& checkpoint_options) {
+
+	VariableVector empty;
+	if (options.type == OptimizerType::LBFGS && checkpoint_options.filename != "") return empty;
+
+	ParameterLayout layout;
+	DataLayout data_layout;
+	if (layout.build(gcp, weight_names, partial_names) != 0) return empty;
+	if (data_layout.build(gcp, source->get_column_names()) != 0) return empty;
+
+	// only L-BFGS reads the loss
+	vector<ObjectiveTerm> objective;
+	if (options.type == OptimizerType::LBFGS && find_objective_terms(gcp, partial_names, &objective) != 0) return empty;
+
+	VariableVector weights = initial_weight_guess(weight_names);
+	vector<double> weight_values;
+	layout.gather_weights(weights, &weight_values);
+
+	StreamingLoss loss(gcp, layout, data_layout, options.type == OptimizerType::LBFGS ? &objective : NULL, source, fixed_inputs);
+	if (minimize_loss(&loss, layout, options, checkpoint_options, &weight_values, NULL) != 0) return empty;
+
+	layout.scatter_weights(weight_values, &weights);
+	return weights;
+}
+
+
+VariableVector stochastic_gradient_descent(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, DataSource *source, const VariableVector& fixed_inputs,
+	const SGDOptions& options, const OptimizerOptions& optimizer_options, const CheckpointOptions& checkpoint_options) {
+
+	VariableVector empty;
+	if (options.batch_size == 0 || options.num_threads > 1) return empty;
+
+	ParameterLayout layout;
+	DataLayout data_layout;
+	if (layout.build(gcp, weight_names, partial_names) != 0) return empty;
+	if (data_layout.build(gcp, source->get_column_names()) != 0) return empty;
+
+	Optimizer *optimizer = create_optimizer(layout.size(), optimizer_options);
+	if (optimizer == NULL) return empty;
+
+	VariableVector weights = initial_weight_guess(weight_names);
+	vector<double> weight_values, gradient, bound_weights, values;
+	layout.gather_weights(weights, &weight_values);
+	mt19937_64 rng(options.seed), pass_rng;
+	DataBatch batch;
+
+	// the run may resume in the middle of a pass, whose first NEXT_BATCH batches were read before the checkpoint
+	int64_t num_steps = 0, epoch = 0;
+	size_t next_batch = 0;
+	int success = resume_state(checkpoint_options, layout, &weight_values, &num_steps, optimizer, &epoch, &next_batch, NULL, &rng);
+	CheckpointWriter *writer = checkpoint_options.filename == "" ? NULL : new CheckpointWriter(checkpoint_options.filename);
+	TrainingState state;
+
+	// every epoch is a pass over the source, which shuffles the data as it reads them, from the state the generator has when it starts
+	// so a resumed pass starts from the state of the checkpoint, and reads again, without a step, the batches read before it
+	for (; epoch < options.max_epochs && success == 0; epoch++, next_batch = 0) {
+		if (options.max_steps != 0 && num_steps >= options.max_steps) break;
+		pass_rng = rng;
+		success = source->start_pass(options.batch_size, &rng);
+		for (size_t skipped = 0; skipped < next_batch && success == 0; skipped++) {
+			success = source->next_batch(&batch);
+			if (success == 0 && batch.num_rows == 0) success = OTHER_ERROR;
+		}
+
+		while (success == 0 && (options.max_steps == 0 || num_steps < options.max_steps)) {
+			success = source->next_batch(&batch);
+			if (success != 0 || batch.num_rows == 0) break;
+
+			success = bind_shared_values(gcp, layout, weight_values, fixed_inputs, &bound_weights);
+			if (success != 0) break;
+			gradient.assign(layout.size(), 0);
+			success = add_batch_partials(gcp, layout, data_layout, NULL, bound_weights, batch, &values, gradient.data(), NULL);
+			if (success != 0) break;
+			dense_scale(1.0 / batch.num_rows, gradient.data(), gradient.size());
+
+			success = optimizer->step(gradient, &weight_values);
+			num_steps++;
+			next_batch++;
+
+			if (writer != NULL && checkpoint_options.interval != 0 && num_steps % checkpoint_options.interval == 0) {
+				capture_state(layout, weight_values, num_steps, *optimizer, epoch, next_batch, NULL, &pass_rng, &state);
+				writer->submit(&state);
+			}
+		}
+		if (options.max_steps != 0 && num_steps >= options.max_steps) break;
 	}
 
+	// a run that stops between passes carries on with the next one, which starts from the generator as it is now
+	if (writer != NULL) {
+		if (success == 0) {
+			capture_state(layout, weight_values, num_steps, *optimizer, epoch, next_batch, NULL, next_batch == 0 ? &rng : &pass_rng, &state);
+			writer->submit(&state);
+		}
+		int written = writer->finish();
+		if (success == 0) success = written;
+		delete writer;
+	}
+	delete optimizer;
+	if (success != 0) return empty;
+	layout.scatter_weights(weight_values, &weights);
 	return weights;
 }
 
+
+/* What the threads of hogwild_gradient_descent share: what they train on, the weights,
+ *  the number of steps claimed and written so far, and the error of the first step that failed (or 0).
+ */
+struct HogwildShared {
+	const Program *gcp;
+	const ParameterLayout *layout;
+	const vector<pair<VariableVector, VariableVector> > *training_data;
+	const vector<SparseVariableVector> *sparse_inputs;
+	size_t batch_size;
+	double learning_rate;
+	int64_t num_steps;
+
+	atomic<double> *weights;
+	atomic<int64_t> num_claimed;
+	atomic<int64_t> num_written;
+	atomic<int> error;
+};
+
+
+/* Takes steps of hogwild_gradient_descent in thread THREAD_NUMBER, until every step has been claimed.
+ * Every thread samples its own batches, from a generator seeded by SEED and the number of the thread.
+ * Writes what happened in this thread into STATS.
+ */
+static void run_hogwild_thread(HogwildShared *shared, uint64_t seed, size_t thread_number, HogwildStats *stats) {
+
+	seed_seq sequence = {(uint32_t) seed, (uint32_t) (seed >> 32), (uint32_t) thread_number};
+	mt19937_64 rng(sequence);
+	size_t num_data = shared->training_data->size();
+	vector<double> weights(shared->layout->size()), gradient;
+	vector<size_t> batch(shared->batch_size);
+
+	// the atomics only order the accesses to each one of them, so they are all relaxed
+	while (shared->error.load(memory_order_relaxed) == 0 && shared->num_claimed.fetch_add(1, memory_order_relaxed) < shared->num_steps) {
+		for (size_t b = 0; b < batch.size(); b++) batch[b] = rng() % num_data;
+
+		int64_t read_at = shared->num_written.load(memory_order_relaxed);
+		for (size_t i = 0; i < weights.size(); i++) weights[i] = shared->weights[i].load(memory_order_relaxed);
+
+		int success = avg_dense_loss_and_gradient(*shared->gcp, *shared->layout, NULL, weights, *shared->training_data,
+			*shared->sparse_inputs, batch.data(), batch.size(), NULL, &gradient);
+		if (success != 0) {
+			int no_error = 0;
+			shared->error.compare_exchange_strong(no_error, success, memory_order_relaxed);
+			return;
+		}
+
+		// a failed compare-and-swap means another thread wrote the weight in between: it is retried with the value that thread wrote
+		for (size_t i = 0; i < gradient.size(); i++) {
+			if (gradient[i] == 0) continue;
+			double value = shared->weights[i].load(memory_order_relaxed);
+			while (!shared->weights[i].compare_exchange_strong(value, value - shared->learning_rate * gradient[i], memory_order_relaxed)) {
+				stats->num_conflicts++;
+			}
+		}
+
+		int64_t staleness = shared->num_written.fetch_add(1, memory_order_relaxed) - read_at;
+		stats->num_steps++;
+		stats->total_staleness += staleness;
+		stats->max_staleness = max(stats->max_staleness, staleness);
+	}
+}
+
+
+VariableVector hogwild_gradient_descent(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const SGDOptions& options, const OptimizerOptions& optimizer_options,
+	HogwildStats *stats) {
+
+	VariableVector empty;
+	if (stats != NULL) *stats = HogwildStats();
+	if (options.batch_size == 0 || options.num_threads == 0 || sparse_inputs.size() != training_data.size()) return empty;
+	if (optimizer_options.type != OptimizerType::GRADIENT_DESCENT || check_optimizer_options(optimizer_options) != 0) return empty;
+
+	ParameterLayout layout;
+	if (layout.build(gcp, weight_names, partial_names) != 0) return empty;
+
+	VariableVector weights = initial_weight_guess(weight_names);
+	vector<double> weight_values;
+	layout.gather_weights(weights, &weight_values);
+
+	HogwildShared shared;
+	shared.gcp = &gcp;
+	shared.layout = &layout;
+	shared.training_data = &training_data;
+	shared.sparse_inputs = &sparse_inputs;
+	shared.batch_size = options.batch_size;
+	shared.learning_rate = optimizer_options.learning_rate;
+	shared.weights = new atomic<double>[layout.size()];
+	for (size_t i = 0; i < layout.size(); i++) shared.weights[i].store(weight_values[i]);
+	shared.num_claimed.store(0);
+	shared.num_written.store(0);
+	shared.error.store(0);
+
+	// as many steps as stochastic_gradient_descent takes
+	int64_t steps_per_epoch = (training_data.size() + options.batch_size - 1) / options.batch_size;
+	shared.num_steps = options.max_epochs * steps_per_epoch;
+	if (options.max_steps != 0) shared.num_steps = min(shared.num_steps, options.max_steps);
+
+	vector<HogwildStats> thread_stats(options.num_threads);
+	vector<thread> threads;
+	for (size_t t = 0; t < options.num_threads; t++) {
+		threads.push_back(thread(run_hogwild_thread, &shared, options.seed, t, &thread_stats[t]));
+	}
+	for (size_t t = 0; t < options.num_threads; t++) {
+		threads[t].join();
+		if (stats == NULL) continue;
+		stats->num_steps += thread_stats[t].num_steps;
+		stats->total_staleness += thread_stats[t].total_staleness;
+		stats->max_staleness = max(stats->max_staleness, thread_stats[t].max_staleness);
+		stats->num_conflicts += thread_stats[t].num_conflicts;
+	}
+
+	for (size_t i = 0; i < layout.size(); i++) weight_values[i] = shared.weights[i].load();
+	delete[] shared.weights;
+	if (shared.error.load() != 0) return empty;
+
+	layout.scatter_weights(weight_values, &weights);
+	return weights;
+}
+
+/* What every worker of parameter_server_gradient_descent runs: passes over its shard of the training data,
+ *  pushing the gradient of every batch to the server, and training on whatever weights the server answers with.
+ */
+class StochasticShardWorker : public ParameterWorker {
+
+	const Program& gcp;
+	const ParameterLayout& layout;
+	const vector<pair<VariableVector, VariableVector> >& training_data;
+	const vector<SparseVariableVector>& sparse_inputs;
+	const SGDOptions& options;
+
+public:
+
+	StochasticShardWorker(const Program& gcp, const ParameterLayout& layout, const vector<pair<VariableVector, VariableVector> >& training_data,
+		const vector<SparseVariableVector>& sparse_inputs, const SGDOptions& options)
+		: gcp(gcp), layout(layout), training_data(training_data), sparse_inputs(sparse_inputs), options(options) {
+	}
+
+	int run(ParameterClient *client) {
+		// the shard is visited through its indices into the training data, which are never copied
+		size_t first = client->get_rank() * training_data.size() / client->get_size();
+		size_t last = (client->get_rank() + 1) * training_data.size() / client->get_size();
+		if (first == last) return 0;
+		vector<size_t> order;
+		for (size_t i = first; i < last; i++) order.push_back(i);
+		seed_seq sequence = {(uint32_t) options.seed, (uint32_t) (options.seed >> 32), (uint32_t) client->get_rank()};
+		mt19937_64 rng(sequence);
+
+		vector<double> weights, gradient;
+		int64_t version;
+		int success = client->pull(&weights, &version);
+
+		for (int64_t epoch = 0; epoch < options.max_epochs && success == 0 && !client->is_stopped(); epoch++) {
+			shuffle_indices(&order, &rng);
+
+			for (size_t b = 0; b < order.size() && success == 0 && !client->is_stopped(); b += options.batch_size) {
+				size_t batch_size = min(options.batch_size, order.size() - b);
+				success = avg_dense_loss_and_gradient(gcp, layout, NULL, weights, training_data, sparse_inputs,
+					order.data() + b, batch_size, NULL, &gradient);
+				if (success == 0) success = client->push(gradient, version, &weights, &version);
+			}
+		}
+		return success;
+	}
+
+};
+
+
+VariableVector parameter_server_gradient_descent(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const SGDOptions& options, const OptimizerOptions& optimizer_options,
+	size_t num_processes, ParameterServerStats *stats) {
+
+	VariableVector empty;
+	if (stats != NULL) *stats = ParameterServerStats();
+	if (options.batch_size == 0 || num_processes == 0 || sparse_inputs.size() != training_data.size()) return empty;
+
+	ParameterLayout layout;
+	if (layout.build(gcp, weight_names, partial_names) != 0) return empty;
+
+	VariableVector weights = initial_weight_guess(weight_names);
+	vector<double> initial_weights, weight_values;
+	layout.gather_weights(weights, &initial_weights);
+
+	StochasticShardWorker worker(gcp, layout, training_data, sparse_inputs, options);
+	if (run_parameter_server(num_processes, initial_weights, optimizer_options, options.max_steps, options.staleness_bound,
+		&worker, &weight_values, stats) != 0) return empty;
+
+	layout.scatter_weights(weight_values, &weights);
+	return weights;
+}
+
+void shuffle_indices(vector<size_t> *order, mt19937_64 *rng) {
+	// the modulo is biased by less than one part in 2^44 for any vector that fits in memory
+	for (size_t i = order->size(); i > 1; i--) {
+		size_t j = (*rng)() % i;
+		swap((*order)[i - 1], (*order)[j]);
+	}
+}
+
 VariableVector initial_weight_guess(const vector<string>& weight_names) {
 	return vector_of_zeros(weight_names);
 }
@@ -64,38 +917,30 @@ VariableVector increment_weight_vector(const VariableVector& weights, const Vari
 	return incremented;
 }
 
-string partial_name_to_weight_name(const string& partial_name) {
-	/*if (partial_name.compare("") == 0) {
-		return "";
-	}
+int increment_weight_vector(VariableVector *weights, const VariableVector& scaled_gradient) {
 
-	size_t len = partial_name.len();
+	for (VariableVector::const_iterator it = scaled_gradient.begin(); it != scaled_gradient.end(); ++it) {
+		VariableVector::iterator weight = weights->find(partial_name_to_weight_name(it->first));
+		if (weight == weights->end()) return OTHER_ERROR;
+		weight->second += it->second;
+	}
 
-	size_t prev_slash_index = 0;
-	size_t next_slash_index = 0;
+	return 0;
+}
 
-	next_slash_index = partial_name.find_first_of("/", 0);
-	if (next_slash_index != 1 || partial_name.substr(0, 1).compare("d") != 0) {
-		return "";
-	}
+string partial_name_to_weight_name(const string& partial_name) {
 
-	prev_slash_index = next_slash_index;
-	next_slash_index = partial_name.find_first_of("/", 2);
-	if (next_slash_index != 8 || partial_name.substr(2, 8).compare("lambda") != 0) {
+	// the name is d/<loss>/d/<weight>, where the loss may itself contain slashes (such as total/objective)
+	if (partial_name.compare(0, 2, "d/") != 0) {
 		return "";
 	}
 
-	prev_slash_index = next_slash_index;
-	next_slash_index = partial_name.find_first_of("/", 9);
-	if (next_slash_index != 10 || partial_name.substr(9, 10).compare("d") != 0) {
-		return "";
-	}*/
-	if (partial_name.length() < 12) {
+	size_t d_index = partial_name.rfind("/d/");
+	if (d_index == string::npos || d_index < 2 || d_index + 3 == partial_name.length()) {
 		return "";
 	}
 
-	string weight_name = partial_name.substr(11);
-	return weight_name;
+	return partial_name.substr(d_index + 3);
 }
 
 VariableVector scale_variable_vector(const VariableVector& vec, double scaling_factor) {
@@ -124,6 +969,14 @@ bool approx_zero(const VariableVector& vec, const vector<string>& partial_names)
 
 }
 
+double variable_vector_length(const VariableVector& vec) {
+	double square_length = 0;
+	for (VariableVector::const_iterator it = vec.begin(); it != vec.end(); ++it) {
+		square_length += it->second * it->second;
+	}
+	return sqrt(square_length);
+}
+
 double distance_between_variable_vectors(const VariableVector& vec1, const VariableVector& vec2) {
 	// Both vectors must have the same dimension
 	if (vec1.size() != vec2.size()) {
@@ -154,6 +1007,18 @@ double distance_between_variable_vectors(const VariableVector& vec1, const Varia
 
 
 VariableVector avg_gradient(const string& gcp_filename, const vector<string>& partial_names, const VariableVector& weights, const vector<pair<VariableVector, VariableVector> >& training_data) {
+
+	Program gcp;
+	if (gcp.load(gcp_filename) != 0) {
+		VariableVector empty;
+		return empty;
+	}
+
+	return avg_gradient(gcp, partial_names, weights, training_data);
+}
+
+
+VariableVector avg_gradient(const Program& gcp, const vector<string>& partial_names, const VariableVector& weights, const vector<pair<VariableVector, VariableVector> >& training_data) {
 	
 	VariableVector empty;
 	// check for trivial errors
@@ -162,30 +1027,151 @@ VariableVector avg_gradient(const string& gcp_filename, const vector<string>& pa
 	// initialize the sum_of_partials_vector
 	VariableVector sum_of_partials = vector_of_zeros(partial_names);
 
-	VariableVector *partials;
 	int find_partials_success = 0;
 
 
 	for (vector<pair<VariableVector, VariableVector> >::const_iterator datum = training_data.begin(); datum != training_data.end(); ++datum) {
 
-		partials = new VariableVector();
-
-		VariableVector inputs = datum->first;
-		VariableVector outputs = datum->second;
+		VariableVector partials;
 		
-		find_partials_success = find_partials(gcp_filename, partials, weights, inputs, outputs);
+		find_partials_success = find_partials(gcp, &partials, weights, datum->first, datum->second);
 		if (find_partials_success != 0) return empty;
 
-		sum_of_partials = add_variable_vectors(sum_of_partials, *partials);
+		sum_of_partials = add_variable_vectors(sum_of_partials, partials);
 		if (sum_of_partials.size() == 0) return empty;
-
-		delete partials;
 	}
 
 	return component_wise_div(sum_of_partials, training_data.size());
 }
 
 
+/* Averages the loss and the gradient over a batch, as avg_dense_loss_and_gradient does, for weights and partials given by name
+ *  (see avg_batch_gradient and avg_loss_and_gradient). The weights are laid out in the order of their partials.
+ */
+static int avg_batch_loss_and_gradient(const Program& gcp, const vector<string>& partial_names, const vector<ObjectiveTerm> *objective,
+	const VariableVector& weights, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const size_t *batch, size_t batch_size, double *loss, VariableVector *gradient) {
+
+	// check for trivial errors
+	if (partial_names.size() != weights.size()) return OTHER_ERROR;
+
+	vector<string> weight_names(partial_names.size());
+	for (size_t i = 0; i < partial_names.size(); i++) weight_names[i] = partial_name_to_weight_name(partial_names[i]);
+
+	ParameterLayout layout;
+	vector<double> weight_values, gradient_values;
+	if (layout.build(gcp, weight_names, partial_names) != 0) return OTHER_ERROR;
+	if (layout.gather_weights(weights, &weight_values) != 0) return OTHER_ERROR;
+
+	int success = avg_dense_loss_and_gradient(gcp, layout, objective, weight_values, training_data, sparse_inputs,
+		batch, batch_size, loss, &gradient_values);
+	if (success != 0) return success;
+
+	gradient->clear();
+	layout.scatter_gradient(gradient_values, gradient);
+	return 0;
+}
+
+
+int avg_dense_loss_and_gradient(const Program& gcp, const ParameterLayout& layout, const vector<ObjectiveTerm> *objective,
+	const vector<double>& weights, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const size_t *batch, size_t batch_size, double *loss, vector<double> *gradient) {
+
+	// check for trivial errors
+	// a NULL batch is the first BATCH_SIZE data, in order
+	if (weights.size() != layout.size() || sparse_inputs.size() != training_data.size()) return OTHER_ERROR;
+	if (batch == NULL && batch_size > training_data.size()) return OTHER_ERROR;
+	for (size_t i = 0; batch != NULL && i < batch_size; i++) {
+		if (batch[i] >= training_data.size()) return OTHER_ERROR;
+	}
+
+	// the weights are the same for every datum, so they are bound once
+	vector<double> weight_values, values;
+	gcp.init_values(&weight_values);
+	int success = layout.bind_weights(weights, &weight_values);
+	if (success != 0) return success;
+
+	gradient->assign(layout.size(), 0);
+	double sum_of_losses = 0;
+	for (size_t b = 0; b < batch_size; b++) {
+		size_t i = batch == NULL ? b : batch[b];
+		success = run_datum(gcp, weight_values, training_data[i].first, sparse_inputs[i], training_data[i].second, &values);
+		if (success != 0) return success;
+
+		// every output of the GCP must be a partial, as avg_gradient requires
+		if (layout.has_other_outputs(values)) return OTHER_ERROR;
+		layout.add_partials(values, gradient->data());
+
+		// the loss was computed by the same run as the partials
+		for (size_t t = 0; objective != NULL && t < objective->size(); t++) {
+			const ObjectiveTerm& term = (*objective)[t];
+			sum_of_losses += values[term.loss_slot] * (term.seed_slot == INVALID_SLOT ? 1 : values[term.seed_slot]);
+		}
+	}
+
+	if (batch_size > 0) dense_scale(1.0 / batch_size, gradient->data(), gradient->size());
+	if (loss != NULL) *loss = batch_size == 0 ? 0 : sum_of_losses / batch_size;
+	return 0;
+}
+
+
+int avg_sparse_gradient(const Program& gcp, const vector<string>& partial_names, const VariableVector& weights,
+	const vector<pair<VariableVector, VariableVector> >& training_data, const vector<SparseVariableVector>& sparse_inputs,
+	VariableVector *gradient) {
+	return avg_batch_gradient(gcp, partial_names, weights, training_data, sparse_inputs, NULL, training_data.size(), gradient);
+}
+
+
+int avg_batch_gradient(const Program& gcp, const vector<string>& partial_names, const VariableVector& weights,
+	const vector<pair<VariableVector, VariableVector> >& training_data, const vector<SparseVariableVector>& sparse_inputs,
+	const size_t *batch, size_t batch_size, VariableVector *gradient) {
+	return avg_batch_loss_and_gradient(gcp, partial_names, NULL, weights, training_data, sparse_inputs, batch, batch_size, NULL, gradient);
+}
+
+
+int avg_loss_and_gradient(const Program& gcp, const vector<string>& partial_names, const vector<ObjectiveTerm>& objective,
+	const VariableVector& weights, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, double *loss, VariableVector *gradient) {
+	return avg_batch_loss_and_gradient(gcp, partial_names, &objective, weights, training_data, sparse_inputs,
+		NULL, training_data.size(), loss, gradient);
+}
+
+
+int find_objective_terms(const Program& gcp, const vector<string>& partial_names, vector<ObjectiveTerm> *terms) {
+
+	terms->clear();
+	if (partial_names.empty()) return OTHER_ERROR;
+
+	// the partials are named d/<objective>/d/<weight>
+	string objective_name;
+	for (size_t i = 0; i < partial_names.size(); i++) {
+		string weight_name = partial_name_to_weight_name(partial_names[i]);
+		if (weight_name == "") return OTHER_ERROR;
+		string name = partial_names[i].substr(2, partial_names[i].length() - weight_name.length() - 5);
+		if (i > 0 && name != objective_name) return OTHER_ERROR;
+		objective_name = name;
+	}
+
+	if (objective_name != COMBINED_OBJECTIVE_NAME) {
+		ObjectiveTerm term = {INVALID_SLOT, gcp.get_slot(objective_name)};
+		if (term.loss_slot == INVALID_SLOT) return OTHER_ERROR;
+		terms->push_back(term);
+		return 0;
+	}
+
+	// the combined objective is not a variable: it is summed from the losses, which are found by their seeds
+	const vector<uint32_t>& input_slots = gcp.get_input_slots();
+	for (size_t i = 0; i < input_slots.size(); i++) {
+		string seed_name = gcp.get_slot_name(input_slots[i]).str();
+		if (seed_name.compare(0, 2, "s/") != 0) continue;
+		ObjectiveTerm term = {input_slots[i], gcp.get_slot(seed_name.substr(2))};
+		if (term.loss_slot == INVALID_SLOT) return OTHER_ERROR;
+		terms->push_back(term);
+	}
+	return terms->empty() ? OTHER_ERROR : 0;
+}
+
+
 VariableVector vector_of_zeros(const vector<string>& var_names) {
 	VariableVector zeros;
 	for (vector<string>::const_iterator name = var_names.begin(); name != var_names.end(); ++name) {
@@ -243,27 +1229,55 @@ VariableVector add_variable_vectors(const VariableVector& vec1, const VariableVe
 	return sum;
 }
 
+void add_to_variable_vector(VariableVector *sum, const VariableVector& vec) {
+	for (VariableVector::const_iterator it = vec.begin(); it != vec.end(); ++it) {
+		(*sum)[it->first] += it->second;
+	}
+}
+
 int find_partials(const string& gcp_filename, VariableVector *partials,
 				const VariableVector& weights, const VariableVector& inputs,
 				const VariableVector& outputs) {
 
-	// accumulate the inputs to the interpreter
+	Program gcp;
+	int load_success = gcp.load(gcp_filename);
+	if (load_success != 0) {
+		return load_success;
+	}
+
+	return find_partials(gcp, partials, weights, inputs, outputs);
+}
+
+
+int find_partials(const Program& gcp, VariableVector *partials,
+				const VariableVector& weights, const VariableVector& inputs,
+				const VariableVector& outputs) {
+
+	// accumulate the inputs to the GCP
 	// make sure there is no overlap between the names of the weights, inputs and output variables
 	VariableVector inputs_outputs = variable_vector_union(inputs, outputs);
 	if (inputs_outputs.size() == 0) {
 		return VAR_DECLARED_TWICE;
 	}
 
-	VariableVector inputs_to_interpreter = variable_vector_union(weights, inputs_outputs);
-	if (inputs_to_interpreter.size() == 0) {
+	VariableVector inputs_to_gcp = variable_vector_union(weights, inputs_outputs);
+	if (inputs_to_gcp.size() == 0) {
 		return VAR_DECLARED_TWICE;
 	}
 
-	Interpreter i;
-	int success = i.interpret(gcp_filename, inputs_to_interpreter, partials);
+	return gcp.execute(inputs_to_gcp, partials);
 
-	return success;
+}
+
+int find_sparse_partials(const Program& gcp, VariableVector *partials, const vector<double>& weight_values,
+				const VariableVector& inputs, const SparseVariableVector& sparse_inputs,
+				const VariableVector& outputs, vector<double> *values) {
+
+	int success = run_datum(gcp, weight_values, inputs, sparse_inputs, outputs, values);
+	if (success != 0) return success;
 
+	gcp.get_nonzero_outputs(*values, partials);
+	return 0;
 }
 
 const VariableVector variable_vector_union(const VariableVector& vec1, const VariableVector& vec2) {
@@ -4,10 +4,20 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <random>
+#include <cstdint>
 
 #include "utilities.h"
 #include "Interpreter.h"
+#include "Program.h"
 #include "BindingsDictionary.h"
+#include "Optimizer.h"
+#include "LBFGS.h"
+#include "ParameterLayout.h"
+#include "Allreduce.h"
+#include "ParameterServer.h"
+#include "Checkpoint.h"
+#include "DataSource.h"
 
 using namespace std;
 
@@ -23,17 +33,12 @@ using namespace std;
  */
 
 
-/* --------------------------------- Some Important Constants ---------------------------------- */
-
-
-/* The learning rate determines how much the weights are incremented after each iteration of the algorithm. */
-#define LEARNING_RATE 0.1
-/* This defines how many iterations to stop after. More iterations tends to result in more precision. */
-#define MAX_NUM_ITERATIONS 1000
-/* This variable determines how the maximum magnitude of the gradient vector after which the algorithm can terminate.
- * If the gradient never becomes this small, the algorithm will terminate after MAX_NUM_ITERATIONS.
+/* The learning rate, the number of iterations and the precision that Gradient Descent uses by default (LEARNING_RATE,
+ *  MAX_NUM_ITERATIONS and GRADIENT_PRECISION) are defined in Optimizer.h, along with the Optimizers that can replace plain gradient descent.
  */
-#define GRADIENT_PRECISION 0.0005
+
+/* The number of data in every batch that full-batch training reads from a DataSource (see the streamed version of calculate_weights). */
+#define STREAMING_BATCH_SIZE 256
 
 
 /* A VariableVector is an abstraction used to represent a vector of inputs, outputs or weights.
@@ -42,6 +47,48 @@ using namespace std;
 typedef unordered_map<string, double> VariableVector;
 
 
+/* One term of the objective that a GCP's partials are the partials of:
+ *  the value of the loss in LOSS_SLOT, times the value of the seed in SEED_SLOT (or times 1, if SEED_SLOT is INVALID_SLOT).
+ * A program with one loss has one term. A program with several losses has one term for each, weighted by its seed (see Compiler.h).
+ */
+struct ObjectiveTerm {
+	uint32_t seed_slot;
+	uint32_t loss_slot;
+};
+
+
+/* Options for Mini-Batch Stochastic Gradient Descent (see stochastic_gradient_descent). */
+struct SGDOptions {
+	/* The number of data whose partials are averaged for each step. */
+	size_t batch_size = 32;
+	/* Training stops after MAX_EPOCHS passes over the training data, or after MAX_STEPS steps (if it is not 0), whichever comes first. */
+	int64_t max_epochs = 100;
+	int64_t max_steps = 0;
+	/* The seed of the permutations that shuffle the training data before every epoch. The same seed always gives the same weights. */
+	uint64_t seed = 0;
+	/* If more than 1, training is asynchronous: this many threads take steps at once, without locks (see hogwild_gradient_descent).
+	 * Asynchronous weights depend on how the threads interleave, so the seed no longer fixes them.
+	 */
+	size_t num_threads = 1;
+	/* With a parameter server (see parameter_server_gradient_descent), the most gradients a worker may push
+	 *  beyond the slowest worker before it waits for it, or -1 for no bound.
+	 */
+	int64_t staleness_bound = -1;
+};
+
+
+/* What happened during asynchronous training (see hogwild_gradient_descent).
+ * The staleness of a step is the number of steps other threads wrote between the time it read the weights and the time it wrote them.
+ * A conflict is a write to a weight that failed, and was retried, because another thread wrote that weight at the same moment.
+ */
+struct HogwildStats {
+	int64_t num_steps = 0;
+	int64_t total_staleness = 0;
+	int64_t max_staleness = 0;
+	int64_t num_conflicts = 0;
+};
+
+
 /* --------------------------------- Main Functions --------------------------------------- */
 
 /* This method runs the Gradient Descent Algorithm.
@@ -68,6 +115,217 @@ typedef unordered_map<string, double> VariableVector;
 VariableVector calculate_weights(const string& gcp_filename, const vector<string>& weight_names,
 	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data);
 
+/* Runs the Gradient Descent Algorithm on a GCP that has already been loaded (see Program.h).
+ * The GCP is parsed once, when it is loaded, instead of once for every datum of every iteration.
+ * The version above loads the GCP from GCP_FILENAME and calls this one.
+ * This is the sparse version below, with no sparse inputs, so the weights and the gradient are dense arrays for the whole algorithm.
+ */
+VariableVector calculate_weights(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data);
+
+/* Runs the Gradient Descent Algorithm on training data with sparse inputs (see SparseVector.h).
+ * SPARSE_INPUTS has one entry for every datum of TRAINING_DATA: the input vectors that datum gives sparsely (possibly none).
+ *
+ * Gradients are kept sparse: a partial that is 0 for every datum (such as the partial of a weight whose input is always 0)
+ *  is left out of the gradient, and its weight is not incremented (see avg_sparse_gradient and increment_weight_vector).
+ * The algorithm stops once the length of the gradient is within GRADIENT_PRECISION, as approx_zero does.
+ * Returns an empty VariableVector if the GCP could not be executed on the training data.
+ */
+VariableVector calculate_weights(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs);
+
+/* Runs the Gradient Descent Algorithm on training data with sparse inputs, moving the weights with the Optimizer that OPTIONS names
+ *  (or minimizing the loss with L-BFGS, if OPTIONS names it: see calculate_weights_lbfgs),
+ *  and stopping after OPTIONS.max_iterations steps or once the length of the gradient is within OPTIONS.gradient_precision.
+ * The version above uses plain gradient descent with the default hyperparameters (see Optimizer.h).
+ *
+ * The weights and the gradient are kept in arrays laid out by a ParameterLayout (indexed by position in WEIGHT_NAMES) for the whole algorithm,
+ *  and are only turned into a VariableVector when the weights are returned (see avg_dense_loss_and_gradient).
+ * Returns an empty VariableVector if a hyperparameter is out of range (see check_optimizer_options),
+ *  if a partial in PARTIAL_NAMES is not the partial of a weight in WEIGHT_NAMES, or if the GCP could not be executed on the training data.
+ */
+VariableVector calculate_weights(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const OptimizerOptions& options);
+
+/* Runs the Gradient Descent Algorithm as the version above does, writing checkpoints as CHECKPOINT_OPTIONS asks (see Checkpoint.h):
+ *  the weights, the state of the Optimizer, and the number of steps taken, every CHECKPOINT_OPTIONS.interval steps, and once the run ends.
+ * Checkpoints are written by a thread of their own while the next steps are taken.
+ * If CHECKPOINT_OPTIONS.resume is true and its file holds a checkpoint, the run carries on from it, and takes the steps the run it was written by
+ *  would have taken next, so a run that is stopped and resumed learns the same weights as one that was not.
+ * OPTIONS.max_iterations counts the steps taken before the checkpoint too.
+ *
+ * Returns an empty VariableVector if the checkpoint cannot be resumed (it is not one, or not of these weights and this Optimizer),
+ *  if a checkpoint could not be written, if OPTIONS names L-BFGS (whose runs are not checkpointed), or for the reasons the version above does.
+ */
+VariableVector calculate_weights(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const OptimizerOptions& options, const CheckpointOptions& checkpoint_options);
+
+/* Minimizes the average loss over the training data with L-BFGS (see LBFGS.h), starting from the initial weight guess.
+ * Every point the line search tries is one pass over the training data, which gives both the loss and the gradient there
+ *  (see avg_loss_and_gradient), so the loss is never computed by a separate run of the GCP.
+ * If NUM_EVALUATIONS is not NULL, the number of passes over the training data is written into it.
+ *
+ * Returns an empty VariableVector if the objective of the GCP cannot be found (see find_objective_terms),
+ *  or for the reasons the sparse version of calculate_weights does.
+ */
+VariableVector calculate_weights_lbfgs(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const OptimizerOptions& options, int64_t *num_evaluations);
+
+
+/* Runs full-batch training, as the sparse version of calculate_weights does with OPTIONS, in NUM_PROCESSES worker processes at once.
+ * Every worker is forked from this process, so it holds a copy of the loaded GCP, and it copies its own contiguous shard of the training data.
+ * For every step, every worker runs the GCP over its shard, and the workers sum their partials (and losses) with an allreduce
+ *  through shared memory (see Allreduce.h); every worker then holds the gradient over all the training data, and takes the same step:
+ *
+ * data_parallel_gradient_descent(GCP, training_data, options), in every worker:
+	shard = training_data[rank * len(training_data) / num_processes, (rank + 1) * len(training_data) / num_processes)
+	weight_vec = initial_guess()
+	grad = allreduce_sum(sum_of_partials(GCP, weight_vec, shard)) / len(training_data)
+	while (!approx_zero(grad)):
+		optimizer.step(grad, weight_vec)
+		grad = allreduce_sum(sum_of_partials(GCP, weight_vec, shard)) / len(training_data)
+	if rank == 0: return weight_vec
+ *
+ * The weights are those of calculate_weights, up to the rounding of summing the shards apart.
+ * A worker that fails, or dies, stops the others, and this process carries on (see run_worker_processes).
+ *
+ * Returns an empty VariableVector if there are no processes or no training data, if a worker fails or dies,
+ *  or for the reasons the sparse version of calculate_weights does.
+ */
+VariableVector data_parallel_gradient_descent(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const OptimizerOptions& options, size_t num_processes);
+
+/* Runs Mini-Batch Stochastic Gradient Descent on a loaded GCP, with the training data of calculate_weights (sparse or not).
+ * Full-batch Gradient Descent makes one pass over the whole training data for every step;
+ *  this makes a step for every batch of OPTIONS.batch_size data, so a pass over the training data (an epoch) makes many steps:
+ *
+ * stochastic_gradient_descent(GCP, training_data, options):
+	weight_vec = initial_guess()
+	repeat options.max_epochs times:
+		order = seeded_permutation(len(training_data))
+		for every batch of options.batch_size data, in order:
+			grad = avg_batch_gradient(GCP, weight_vec, batch)
+			optimizer.step(grad, weight_vec)
+	return weight_vec
+ *
+ * Before every epoch the data are shuffled by permuting their indices (see shuffle_indices), never by copying them.
+ * The last batch of an epoch holds whatever data are left, so it may be smaller than the others.
+ * Gradients are sparse, as in the sparse version of calculate_weights, and each step is taken by the Optimizer
+ *  that OPTIMIZER_OPTIONS names (plain gradient descent by default), whose stopping conditions are not used.
+ *
+ * If OPTIONS.num_threads is more than 1, this is hogwild_gradient_descent instead.
+ *
+ * Returns an empty VariableVector if the GCP could not be executed on the training data,
+ *  if SPARSE_INPUTS does not have one entry for every datum, if the batch size is 0, or if the Optimizer could not be created.
+ */
+VariableVector stochastic_gradient_descent(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const SGDOptions& options,
+	const OptimizerOptions& optimizer_options = OptimizerOptions());
+
+/* Runs Mini-Batch Stochastic Gradient Descent as the version above does, writing checkpoints as CHECKPOINT_OPTIONS asks,
+ *  as the checkpointed version of calculate_weights does. A checkpoint also holds the epoch, the order the data are shuffled in for it,
+ *  the position of the next batch in that order, and the state of the generator that shuffles them,
+ *  so a resumed run takes the very batches, and steps, the run that was stopped would have taken.
+ * OPTIONS.max_epochs and OPTIONS.max_steps count the epochs and steps taken before the checkpoint too.
+ *
+ * Returns an empty VariableVector if the checkpoint cannot be resumed (it is not one, or not of this run), if a checkpoint could not be written,
+ *  if OPTIONS.num_threads is more than 1 (asynchronous runs are not checkpointed), or for the reasons the version above does.
+ */
+VariableVector stochastic_gradient_descent(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const SGDOptions& options, const OptimizerOptions& optimizer_options,
+	const CheckpointOptions& checkpoint_options);
+
+/* Runs the Gradient Descent Algorithm, as the checkpointed version of calculate_weights does, on training data streamed from SOURCE
+ *  (see DataSource.h), rather than held in memory: every evaluation of the loss is one pass over SOURCE, in order,
+ *  in batches of STREAMING_BATCH_SIZE data, which the GCP runs on while SOURCE reads the next ones.
+ * The data are bound by slot, on top of the weights and of FIXED_INPUTS, which are the same for every datum (such as the seeds of the losses).
+ * The loss and the partials are summed in the order of the data, so the weights are exactly those calculate_weights learns
+ *  from the same data in memory, with any Optimizer, L-BFGS included.
+ *
+ * Returns an empty VariableVector if SOURCE could not be read, if it names a column twice,
+ *  or for the reasons the checkpointed version of calculate_weights does.
+ */
+VariableVector calculate_weights(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, DataSource *source, const VariableVector& fixed_inputs,
+	const OptimizerOptions& options, const CheckpointOptions& checkpoint_options);
+
+/* Runs Mini-Batch Stochastic Gradient Descent, as the checkpointed version of stochastic_gradient_descent does, on training data streamed from SOURCE:
+ *  every epoch is one pass over SOURCE, in batches of OPTIONS.batch_size data, shuffled as SOURCE shuffles them,
+ *  from a generator seeded by OPTIONS.seed. Data are bound as in the streamed version of calculate_weights.
+ * A checkpoint holds the state the generator had when the pass of its epoch started, and the number of batches of that pass read so far,
+ *  rather than an order: a resumed run starts the pass again from that state, and reads those batches again without taking a step.
+ *
+ * Returns an empty VariableVector if SOURCE could not be read, if it names a column twice, if the checkpoint is beyond the end of its pass,
+ *  if OPTIONS.num_threads is more than 1 (streamed training is not asynchronous), or for the reasons stochastic_gradient_descent does.
+ */
+VariableVector stochastic_gradient_descent(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, DataSource *source, const VariableVector& fixed_inputs,
+	const SGDOptions& options, const OptimizerOptions& optimizer_options, const CheckpointOptions& checkpoint_options);
+
+/* Runs Hogwild, asynchronous Stochastic Gradient Descent: OPTIONS.num_threads threads take steps on one shared weight array, without locks.
+ * Each thread samples a batch of OPTIONS.batch_size data (uniformly, with replacement), reads the weights as they are,
+ *  runs the GCP over the batch with values of its own, and adds minus the learning rate times every non-zero partial to its weight,
+ *  with an atomic compare-and-swap, while the other threads do the same:
+ *
+ * hogwild_gradient_descent(GCP, training_data, options), in every thread:
+	while steps are left:
+		batch = sample(training_data, options.batch_size)
+		grad = avg_batch_gradient(GCP, read(weight_vec), batch)
+		for every w whose partial is not 0:
+			atomically weight_vec[w] -= learning_rate * grad[w]
+ *
+ * With sparse inputs, most steps touch few weights, and two threads seldom write the same one, so the steps rarely collide.
+ * The threads take as many steps between them as stochastic_gradient_descent takes with the same options
+ *  (one for every batch of every epoch, or OPTIONS.max_steps if that is fewer). Only plain gradient descent steps are taken:
+ *  the state of the other Optimizers is not shared between threads.
+ * If STATS is not NULL, the staleness of the steps and the number of conflicts are written into it.
+ *
+ * Returns an empty VariableVector if OPTIMIZER_OPTIONS does not name plain gradient descent (or is out of range),
+ *  if there are no threads, or for the reasons stochastic_gradient_descent does.
+ */
+VariableVector hogwild_gradient_descent(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const SGDOptions& options, const OptimizerOptions& optimizer_options,
+	HogwildStats *stats);
+
+/* Runs Mini-Batch Stochastic Gradient Descent asynchronously in NUM_PROCESSES worker processes, with a parameter server (see ParameterServer.h).
+ * This process is the server: it owns the weights, and applies every gradient a worker pushes to it with the Optimizer OPTIMIZER_OPTIONS names.
+ * Every worker is forked from this process, and makes OPTIONS.max_epochs passes over its own contiguous shard of the training data,
+ *  shuffled before every pass (from OPTIONS.seed and its number), taking a step for every batch of OPTIONS.batch_size data:
+ *
+ * parameter_server_gradient_descent(GCP, training_data, options), in every worker:
+	shard = training_data[rank * len(training_data) / num_processes, (rank + 1) * len(training_data) / num_processes)
+	weight_vec, version = pull()
+	repeat options.max_epochs times:
+		for every batch of options.batch_size data of seeded_permutation(shard):
+			grad = avg_batch_gradient(GCP, weight_vec, batch)
+			weight_vec, version = push(grad, version)
+ *
+ * The server applies at most OPTIONS.max_steps updates in all, if that is not 0, and then stops the workers.
+ * OPTIONS.staleness_bound keeps the workers from getting too far apart (see run_parameter_server).
+ * If STATS is not NULL, what happened on the server is written into it.
+ *
+ * Returns an empty VariableVector if there are no processes, if the Optimizer cannot be created (as for L-BFGS),
+ *  if a worker fails or dies, or for the reasons stochastic_gradient_descent does.
+ */
+VariableVector parameter_server_gradient_descent(const Program& gcp, const vector<string>& weight_names,
+	const vector<string>& partial_names, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const SGDOptions& options, const OptimizerOptions& optimizer_options,
+	size_t num_processes, ParameterServerStats *stats);
+
+/* Shuffles ORDER in place with a Fisher-Yates shuffle, drawing from RNG.
+ * The draws are taken straight from the 64-bit Mersenne Twister (whose sequence the C++ standard fixes),
+ *  so a seed gives the same permutation with every compiler and standard library.
+ */
+void shuffle_indices(vector<size_t> *order, mt19937_64 *rng);
+
 
 /* This method returns the values of the partial derivatives (the gradient) for a given set of weights,
  *	averaged over the entire set of Training Data.
@@ -88,10 +346,64 @@ VariableVector calculate_weights(const string& gcp_filename, const vector<string
  */
 VariableVector avg_gradient(const string& gcp_filename, const vector<string>& partial_names,
 	const VariableVector& weights, const vector<pair<VariableVector, VariableVector> >& training_data);
+VariableVector avg_gradient(const Program& gcp, const vector<string>& partial_names,
+	const VariableVector& weights, const vector<pair<VariableVector, VariableVector> >& training_data);
+
+/* Writes the sparse gradient for the given set of weights, averaged over the training data, into GRADIENT.
+ * This lays out the weights of PARTIAL_NAMES (see ParameterLayout.h) and calls avg_dense_loss_and_gradient,
+ *  for callers that deal in maps of names. The gradient only has the partials whose average is not 0.
+ *
+ * Returns OTHER_ERROR if there is not one entry of SPARSE_INPUTS for every datum, if the weights and partials differ in number,
+ *  if WEIGHTS has no value for the weight of some partial, or if the GCP has an output that is not one of PARTIAL_NAMES.
+ * Returns 0 on success, or the error code of the first datum that failed (see find_sparse_partials).
+ */
+int avg_sparse_gradient(const Program& gcp, const vector<string>& partial_names, const VariableVector& weights,
+	const vector<pair<VariableVector, VariableVector> >& training_data, const vector<SparseVariableVector>& sparse_inputs,
+	VariableVector *gradient);
+
+/* Writes the sparse gradient averaged over one batch of the training data into GRADIENT, as avg_sparse_gradient does for all of it.
+ * The batch is given by the indices of its BATCH_SIZE data in TRAINING_DATA (and SPARSE_INPUTS), starting at BATCH.
+ * Returns OTHER_ERROR if an index is out of range, and the errors of avg_sparse_gradient otherwise.
+ */
+int avg_batch_gradient(const Program& gcp, const vector<string>& partial_names, const VariableVector& weights,
+	const vector<pair<VariableVector, VariableVector> >& training_data, const vector<SparseVariableVector>& sparse_inputs,
+	const size_t *batch, size_t batch_size, VariableVector *gradient);
+
+/* Writes the loss averaged over the training data into LOSS, and the sparse gradient averaged over it into GRADIENT,
+ *  from the same run of the GCP for every datum: the loss is read from the slots of OBJECTIVE after each run (see find_objective_terms).
+ * Returns the errors of avg_sparse_gradient.
+ */
+int avg_loss_and_gradient(const Program& gcp, const vector<string>& partial_names, const vector<ObjectiveTerm>& objective,
+	const VariableVector& weights, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, double *loss, VariableVector *gradient);
+
+/* Writes the gradient averaged over the BATCH_SIZE data of the batch starting at BATCH (or over the first BATCH_SIZE data,
+ *  if BATCH is NULL) into GRADIENT, and, if OBJECTIVE is not NULL, the average loss into LOSS.
+ * WEIGHTS and GRADIENT have one value for every weight of LAYOUT, by index: this is what every training loop calls,
+ *  and no name is looked up for any datum.
+ * The weights are bound once, and every datum is run from a copy of them, with a sparse run (see find_sparse_partials),
+ *  whose partials are added into GRADIENT by slot (see ParameterLayout::add_partials).
+ *
+ * Returns OTHER_ERROR if there is not one entry of SPARSE_INPUTS for every datum, if WEIGHTS does not fit LAYOUT,
+ *  if an index of the batch is out of range, or if an output of the GCP that is not a partial is not 0 for some datum.
+ * Returns 0 on success, or the error code of the first datum that failed (see find_sparse_partials).
+ */
+int avg_dense_loss_and_gradient(const Program& gcp, const ParameterLayout& layout, const vector<ObjectiveTerm> *objective,
+	const vector<double>& weights, const vector<pair<VariableVector, VariableVector> >& training_data,
+	const vector<SparseVariableVector>& sparse_inputs, const size_t *batch, size_t batch_size, double *loss, vector<double> *gradient);
+
+/* Writes the terms of the objective whose partials are PARTIAL_NAMES (d/<objective>/d/<weight>) into TERMS.
+ * The objective is a loss variable of the GCP, or the combined objective of several losses (see Compiler.h),
+ *  which is the sum of every loss L whose seed s/L is an input of the GCP, times its seed.
+ * Returns OTHER_ERROR if there are no partials, if they are not all partials of the same objective,
+ *  or if the objective (or one of its losses) is not a variable of the GCP. Returns 0 otherwise.
+ */
+int find_objective_terms(const Program& gcp, const vector<string>& partial_names, vector<ObjectiveTerm> *terms);
 
 
 /* This method determines the values of the partial derivatives in the given GCP.
- * This method works by running the Interpreter, passing the given set of weights and the given inputs and expected outputs.
+ * This method works by executing the GCP (see Program.h), passing the given set of weights and the given inputs and expected outputs.
+ * Executing a loaded GCP gives the same partials as interpreting it, without re-reading it.
  * This method is called repeatedly by avg_gradient, once each for every pair in the Training Data set.
  *
  * find_partials works as follows: 
@@ -106,6 +418,21 @@ VariableVector avg_gradient(const string& gcp_filename, const vector<string>& pa
 int find_partials(const string& gcp_filename, VariableVector *partials,
 				const VariableVector& weights, const VariableVector& inputs,
 				const VariableVector& outputs); 
+int find_partials(const Program& gcp, VariableVector *partials,
+				const VariableVector& weights, const VariableVector& inputs,
+				const VariableVector& outputs);
+
+/* Determines the non-zero partial derivatives in the given GCP for one datum, with a sparse run (see Program.h).
+ * WEIGHT_VALUES holds the values of a run with only the weights bound (by init_values and bind_values).
+ * They are copied into VALUES, which can be reused for every datum, and the datum's INPUTS, SPARSE_INPUTS and OUTPUTS are bound on top,
+ *  so the weights are not looked up by name again, and no union of the weights and the datum is built.
+ *
+ * Returns VAR_DECLARED_TWICE if the datum gives a variable twice, or gives a weight.
+ * Returns 0 if the run succeeded, and an error code otherwise (see utilities.h).
+ */
+int find_sparse_partials(const Program& gcp, VariableVector *partials, const vector<double>& weight_values,
+				const VariableVector& inputs, const SparseVariableVector& sparse_inputs,
+				const VariableVector& outputs, vector<double> *values);
 
 
 
@@ -129,6 +456,12 @@ VariableVector vector_of_zeros(const vector<string>& var_names);
  */
 VariableVector add_variable_vectors(const VariableVector& vec1, const VariableVector& vec2);
 
+/* Adds every variable of VEC into SUM, in place: variables SUM does not have yet are added to it, with VEC's value.
+ * Unlike add_variable_vectors, the vectors may differ in their variables: a missing variable is 0, as in a sparse vector.
+ * Only the variables of VEC are touched, so adding a sparse vector costs as much as it has variables.
+ */
+void add_to_variable_vector(VariableVector *sum, const VariableVector& vec);
+
 /* Returns a vector.
  * Every variable in vec is in it.
  * The value for each variable is its value in vec divided by the given divisor.
@@ -148,8 +481,16 @@ VariableVector initial_weight_guess(const vector<string>& weight_names);
  */
 VariableVector increment_weight_vector(const VariableVector& weights, const VariableVector &scaled_gradient);
 
+/* Increments the given WEIGHTS in place by the scaled partials in SCALED_GRADIENT, which may be sparse.
+ * Only the weights whose partials are in SCALED_GRADIENT are touched: the others are left as they are, as if their partials were 0.
+ * Returns OTHER_ERROR if a partial's name cannot be parsed, or its weight is not in WEIGHTS (WEIGHTS may then be partly incremented).
+ * Returns 0 otherwise.
+ */
+int increment_weight_vector(VariableVector *weights, const VariableVector& scaled_gradient);
+
 /* Returns the name of the weight variable that corresponds to the given partial derivative variable.
  * For example, partial_name_to_weight_name("d/lambda/d/w1") would return "w1".
+ * The loss may have any name, and the weight's name is whatever follows the last "/d/".
  * If the partial_name cannot be properly parsed, an empty string is returned.
  */
 string partial_name_to_weight_name(const string& partial_name);
@@ -164,6 +505,11 @@ VariableVector scale_variable_vector(const VariableVector& vec, double scaling_f
  */
 bool approx_zero(const VariableVector& vec, const vector<string>& partial_names);
 
+/* Returns the Pythagorean distance between the given vec and the zero vector.
+ * Variables that are not in vec are 0, so this is also the length of a sparse vector.
+ */
+double variable_vector_length(const VariableVector& vec);
+
 /* Returns the Pythagorean distance between the given Variable Vectors.
  * Returns -1 if the vectors do not have identical sets of variables.
  */
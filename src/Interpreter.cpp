@@ -2,9 +2,11 @@
 #include <unordered_map>
 #include <fstream>
 #include <cfloat>
+#include <unistd.h>
 
 #include "utilities.h"
 #include "Interpreter.h"
+#include "OutputSink.h"
 
 #include <math.h>
 
@@ -14,15 +16,19 @@ using namespace std;
 /* ---------------- Constructor/Destructor --------------- */
 
 Interpreter::Interpreter() {
-	var_types = new unordered_map<string, VariableType> ();
+	var_types = new unordered_map<Symbol, VariableType> ();
+    vector_types = new unordered_map<Symbol, VariableType> ();
     bindings = new BindingsDictionary();
+    line_tokens = new vector<Token>();
 
 }
 
 
 Interpreter::~Interpreter() {
     delete var_types;
+    delete vector_types;
     delete bindings;
+    delete line_tokens;
 }
 
 
@@ -32,7 +38,8 @@ int Interpreter::interpret_program(const string& filename, const string& input_f
 
     // call parse_input_file which builds up the input map
     unordered_map<string, double> input_map;
-    int parse_input_file_success = parse_input_file(input_filename, &input_map);
+    SparseVariableVector sparse_input_map;
+    int parse_input_file_success = parse_input_file(input_filename, &input_map, &sparse_input_map);
     // if there was an error parsing the input file, exit
     if (parse_input_file_success != 0) {
         return parse_input_file_success;
@@ -40,30 +47,45 @@ int Interpreter::interpret_program(const string& filename, const string& input_f
     
     // once the input map has been built, initialize an empty map of outputs, and interpret the program
     unordered_map<string, double> *output_map = new unordered_map<string, double>();
-    int interpret_success = interpret(filename, input_map, output_map);
+    int interpret_success = interpret(filename, input_map, sparse_input_map, output_map);
     if (interpret_success != 0) {
+        delete output_map;
         return interpret_success;
     }
 
+    // print the outputs in one block, rather than flushing standard output after every output
+    cout.flush();
+    OutputSink out_sink;
+    out_sink.attach(STDOUT_FILENO);
+    ostream out(&out_sink);
     for (unordered_map<string, double>::iterator it = output_map->begin(); it != output_map->end(); ++it) {
-        cout << it->first << "\t" << it->second << endl;
+        out << it->first << "\t" << it->second << '\n';
     }
+    int write_success = out_sink.close();
 
-    return 0;
+    delete output_map;
+    return write_success;
 
 }
 
 int Interpreter::interpret(const string& filename, const unordered_map<string, double>& inputs, unordered_map<string, double> *outputs) {
+    SparseVariableVector no_sparse_inputs;
+    return interpret(filename, inputs, no_sparse_inputs, outputs);
+}
+
+
+int Interpreter::interpret(const string& filename, const unordered_map<string, double>& inputs,
+    const SparseVariableVector& sparse_inputs, unordered_map<string, double> *outputs) {
 
-	if (!is_valid_file_name(filename)) {
+	LineReader prog;
+	if (prog.open(filename) != 0) {
 		cerr << "\nCould not interpret the file " << filename << endl << endl;
 		return OTHER_ERROR;
 	}
 
-	ifstream prog(filename);
-
-	// buffer into which we read a line from the program.
-    string line;
+	// the line read from the program, which is not copied
+    const char *line;
+    size_t length;
 
     // indicates whether a line was successfully parsed
     int parse_success;
@@ -71,26 +93,22 @@ int Interpreter::interpret(const string& filename, const unordered_map<string, d
     // Iterate through all the lines of the program
     // Send the line to be parsed
     int line_num = 0;
-    while(!prog.eof())
+    while(prog.next_line(&line, &length))
     {
-        getline(prog, line);
         // parse this line of the program
-        parse_success = parse_line(line, inputs);
+        parse_success = parse_line(line, length, inputs, sparse_inputs);
         // if there was an error with this line of the program,
         // print the error message and exit
         if (parse_success != 0) {
             cerr << "\nERROR, Line " << line_num << ":" << endl;
-            cerr << line << endl;
+            cerr.write(line, length) << endl;
             cerr << get_error_message(parse_success) << endl << endl;
-            prog.close();
             return parse_success;
         }
 
         line_num++;
     }
 
-    prog.close();
-
 
     // accumulate outputs
     accumulate_outputs(outputs);
@@ -99,13 +117,19 @@ int Interpreter::interpret(const string& filename, const unordered_map<string, d
 
 
 int Interpreter::parse_input_file(const string& input_filename, unordered_map<string, double> *input_map) {
+    return parse_input_file(input_filename, input_map, NULL);
+}
+
 
-    if (!is_valid_file_name(input_filename)) {
+int Interpreter::parse_input_file(const string& input_filename, unordered_map<string, double> *input_map,
+    SparseVariableVector *sparse_input_map) {
+
+    LineReader input_file;
+    if (input_file.open(input_filename) != 0) {
         cerr << "\nCould not open the input file " << input_filename << endl << endl;
         return OTHER_ERROR;
     }
 
-    ifstream input_file(input_filename);
     string input_line;
     int parse_input_line_success = 0;
 
@@ -113,9 +137,26 @@ int Interpreter::parse_input_file(const string& input_filename, unordered_map<st
     int line_num = 0;
     string input_var_name;
     double input_var_value;
-    while (!input_file.eof()) {
+    SparseVector input_vec;
+    while (input_file.next_line(&input_line)) {
+
+        // a sparse line gives a whole vector, which is kept sparse
+        if (sparse_input_map != NULL && is_sparse_input_line(input_line)) {
+            parse_input_line_success = parse_sparse_input_line(input_line, &input_var_name, &input_vec);
+            if (parse_input_line_success == 0 && sparse_input_map->count(input_var_name) != 0) {
+                parse_input_line_success = VAR_DEFINED_TWICE;
+            }
+            if (parse_input_line_success != 0) {
+                cerr << "\nERROR WITH INPUTS, Line " << line_num << ":" << endl;
+                cerr << input_line << endl;
+                cerr << get_error_message(parse_input_line_success) << endl << endl;
+                return parse_input_line_success;
+            }
+            swap((*sparse_input_map)[input_var_name], input_vec);
+            line_num++;
+            continue;
+        }
 
-        getline(input_file, input_line);
         // parse this line of the input file
         parse_input_line_success = parse_input_line(input_line, &input_var_name, &input_var_value);
         // if there is an error with this line of the input file:
@@ -124,7 +165,6 @@ int Interpreter::parse_input_file(const string& input_filename, unordered_map<st
             cerr << "\nERROR WITH INPUTS, Line " << line_num << ":" << endl;
             cerr << input_line << endl;
             cerr << get_error_message(parse_input_line_success) << endl << endl;
-            input_file.close();
             return parse_input_line_success;
         }
 
@@ -140,7 +180,6 @@ int Interpreter::parse_input_file(const string& input_filename, unordered_map<st
             cerr << "\nERROR WITH INPUTS, Line " << line_num << ":" << endl;
             cerr << input_line << endl;
             cerr << get_error_message(VAR_DEFINED_TWICE) << endl << endl;
-            input_file.close();
             return VAR_DEFINED_TWICE;
         }
         input_map->insert(make_pair(input_var_name, input_var_value));
@@ -148,7 +187,6 @@ int Interpreter::parse_input_file(const string& input_filename, unordered_map<st
         line_num++;
     }
 
-    input_file.close();
     return 0;
 }
 
@@ -161,41 +199,82 @@ int Interpreter::parse_input_line(const string& input_line, string *input_var_na
         return 0;
     }
 
-    vector<string> *tokens = new vector<string>();
-    int num_tokens = tokenize_line(input_line, tokens, "\t");
+    vector<Token>& tokens = *line_tokens;
+    int num_tokens = lex_line(input_line, '\t', &tokens);
     if (num_tokens != 2) {
         if (num_tokens < 0) return num_tokens;
         return INVALID_LINE;
     }
 
-    // make sure the given value can actually be parsed as a float
-    if (!is_constant(tokens->at(1))) {
+    // make sure the given value can actually be parsed as a double
+    if (tokens[1].token_class != TokenClass::NUMBER) {
+        return INVALID_LINE;
+    }
+
+    *input_var_name = tokens[0].str();
+    *input_var_value = tokens[1].number;
+
+    return 0;
+}
+
+
+int Interpreter::parse_sparse_input_line(const string& input_line, string *input_vec_name, SparseVector *input_vec) {
+
+    vector<Token>& tokens = *line_tokens;
+    int num_tokens = lex_line(input_line, '\t', &tokens);
+    if (num_tokens != 2) {
+        if (num_tokens < 0) return num_tokens;
         return INVALID_LINE;
     }
 
-    *input_var_name = tokens->at(0);
-    *input_var_value = stod(tokens->at(1));
+    int success = parse_sparse_vector(tokens[1].start, tokens[1].length, input_vec);
+    if (success != 0) return success;
 
+    *input_vec_name = tokens[0].str();
+    return 0;
+}
+
+
+int Interpreter::get_operand_value(const Token& operand, double *value) const {
+
+    if (operand.token_class == TokenClass::NUMBER) {
+        *value = (float) operand.number;
+        return 0;
+    }
+
+    *value = bindings->get_value(operand.start, operand.length);
+    if (*value == DBL_MIN || *value == DBL_MAX) return VAR_REFERENCED_BEFORE_DEFINED;
     return 0;
 }
 
 
 int Interpreter::parse_line(const string& line, const unordered_map<string, double>& inputs) {
+    return parse_line(line.data(), line.length(), inputs);
+}
+
+
+int Interpreter::parse_line(const char *line, size_t length, const unordered_map<string, double>& inputs) {
+    static const SparseVariableVector no_sparse_inputs;
+    return parse_line(line, length, inputs, no_sparse_inputs);
+}
+
+
+int Interpreter::parse_line(const char *line, size_t length, const unordered_map<string, double>& inputs,
+    const SparseVariableVector& sparse_inputs) {
 	
-    if (line == "") return 0;
+    if (length == 0) return 0;
 
-    // tokenize the line
-    vector<string> *tokens = new vector<string>();
-    int num_tokens = tokenize_line(line, tokens, " ");
+    // lex the line
+    vector<Token>& tokens = *line_tokens;
+    int num_tokens = lex_line(line, length, ' ', &tokens);
     if (num_tokens < 3) return INVALID_LINE;
 
     // Grab the first token of the instruction (first token in the line).
     // Use this to determine what actions to take.
-    InstructionType inst_type = get_instruction_type(tokens->at(0));
+    InstructionType inst_type = tokens[0].instruction_type;
     if (inst_type == InstructionType::INVALID_INST) return INVALID_LINE;
 
 
-    string var_name;
     VariableType var_type;
     int success = 0;
 
@@ -207,29 +286,50 @@ int Interpreter::parse_line(const string& line, const unordered_map<string, doub
         if (num_tokens != 3) return INVALID_LINE;
 
     	// grab the variable type
-        var_type = get_variable_type(tokens->at(1));
+        var_type = tokens[1].variable_type;
         if (var_type == VariableType::INVALID_VAR_TYPE) return INVALID_LINE;
 
         // grab the variable name
-        var_name = tokens->at(2);
-        if (!is_valid_expanded_var_name(var_name)) return INVALID_VAR_NAME;
+        if (!is_valid_expanded_var_name(tokens[2])) return INVALID_VAR_NAME;
+        const char *var_name = tokens[2].start;
+        size_t var_name_length = tokens[2].length;
 
 
         // add name to Bindings Dictionary
-        success = bindings->add_variable(var_name);
+        success = bindings->add_variable(var_name, var_name_length);
         if (success == -1) {
             return VAR_DECLARED_TWICE;
         }
 
         // record the type of this variable
-        (*var_types)[var_name] = var_type;
+        // a vector component's name is not interned: its type is recorded once for its whole vector
+        size_t vec_name_length;
+        int64_t component_num;
+        bool is_component = BindingsDictionary::split_component(var_name, var_name_length, &vec_name_length, &component_num);
+        if (is_component) {
+            (*vector_types)[Symbol(var_name, vec_name_length)] = var_type;
+        } else {
+            (*var_types)[Symbol(var_name, var_name_length)] = var_type;
+        }
 
         // if input or weight, bind the name to its value
+        // a component may instead be given by its vector, sparsely, in which case unlisted components are 0
         if (var_type == VariableType::INPUT || var_type == VariableType::WEIGHT || var_type == VariableType::EXP_OUTPUT) {
-        	if (inputs.count(var_name) == 0) {
+            unordered_map<string, double>::const_iterator input = inputs.find(tokens[2].str());
+            SparseVariableVector::const_iterator sparse_input = sparse_inputs.end();
+            if (is_component && !sparse_inputs.empty()) sparse_input = sparse_inputs.find(string(var_name, vec_name_length));
+
+            double value;
+            if (input != inputs.end()) {
+                if (sparse_input != sparse_inputs.end()) return VAR_DEFINED_TWICE;
+                value = input->second;
+            } else if (sparse_input != sparse_inputs.end()) {
+                value = get_sparse_component(sparse_input->second, component_num);
+            } else {
                 return INPUT_VALUE_NOT_PROVIDED;
             }
-        	success = bindings->bind_value(var_name, inputs.at(var_name));
+
+        	success = bindings->bind_value(var_name, var_name_length, value);
         	if (success == -1) return OTHER_ERROR;
 
         }
@@ -248,10 +348,11 @@ int Interpreter::parse_line(const string& line, const unordered_map<string, doub
         if (num_tokens < 4) return INVALID_LINE;
 
     	// grab the variable name, make sure it exists, and hasn't already been defined
-        var_name = tokens->at(1);
-        if (!is_valid_expanded_var_name(var_name)) return INVALID_VAR_NAME;
-        if (!bindings->has_been_declared(var_name)) return VAR_DEFINED_BEFORE_DECLARED;
-        if (bindings->has_been_defined(var_name)) return VAR_DEFINED_TWICE;
+        if (!is_valid_expanded_var_name(tokens[1])) return INVALID_VAR_NAME;
+        const char *var_name = tokens[1].start;
+        size_t var_name_length = tokens[1].length;
+        if (!bindings->has_been_declared(var_name, var_name_length)) return VAR_DEFINED_BEFORE_DECLARED;
+        if (bindings->has_been_defined(var_name, var_name_length)) return VAR_DEFINED_TWICE;
 
 
         // The variable might be defined in one of three ways:
@@ -261,17 +362,16 @@ int Interpreter::parse_line(const string& line, const unordered_map<string, doub
 
 
         // If the variable is defined as a constant, bind this constant value to the name
-        if (is_constant(tokens->at(3))) {
+        if (tokens[3].token_class == TokenClass::NUMBER) {
             if (num_tokens != 4) return INVALID_LINE;
-        	double constant_value = stof(tokens->at(3), NULL);
-        	success = bindings->bind_value(var_name, constant_value);
+        	success = bindings->bind_value(var_name, var_name_length, (float) tokens[3].number);
         	return success;
         }
 
         
         // To see if the variable is defined as equivalent to another variable,
         // check whether the operation type is undefined
-        OperationType operation = get_operation_type(string(tokens->at(3)));
+        OperationType operation = tokens[3].operation_type;
 
         // If the variable isn't defined as a constant or as a function of two operands,
         // it must be defined as equivalent to another variable,
@@ -279,11 +379,10 @@ int Interpreter::parse_line(const string& line, const unordered_map<string, doub
         if (operation == OperationType::INVALID_OPERATION) {
         	if (num_tokens != 4) return INVALID_LINE;
 
-        	string equiv_var(tokens->at(3));
-        	if (!bindings->has_been_defined(equiv_var)) return VAR_REFERENCED_BEFORE_DEFINED;
-        
-        	double equiv_var_value = bindings->get_value(equiv_var);
-        	success = bindings->bind_value(var_name, equiv_var_value);
+        	double equiv_var_value;
+        	success = get_operand_value(tokens[3], &equiv_var_value);
+        	if (success != 0) return success;
+        	success = bindings->bind_value(var_name, var_name_length, equiv_var_value);
             return success;
         }
 
@@ -292,48 +391,31 @@ int Interpreter::parse_line(const string& line, const unordered_map<string, doub
         // grab the operator and two operands.
         // if either operand is a variable, grab its value from the Bindings Dictionary.
         // evaluate the expression, and bind the current variable to this value.
-        if (is_binary_primitive(tokens->at(3))) {
+        if (is_binary_primitive(operation)) {
            
             if (num_tokens != 6) return INVALID_LINE;
 
         	double operand1, operand2;
-
-        	if (is_constant(tokens->at(4))) {
-        		operand1 = stof(tokens->at(4), NULL);
-        	} else {
-        		if (!bindings->has_been_defined(tokens->at(4))) return VAR_REFERENCED_BEFORE_DEFINED;
-        		operand1 = bindings->get_value(string(tokens->at(4)));
-
-        	}
-
-        	if (is_constant(tokens->at(5))) {
-        		operand2 = stof(tokens->at(5), NULL);
-        	} else {
-        		if (!bindings->has_been_defined(tokens->at(5))) return VAR_REFERENCED_BEFORE_DEFINED;
-        		operand2 = bindings->get_value(string(tokens->at(5)));
-        	}
+        	success = get_operand_value(tokens[4], &operand1);
+        	if (success != 0) return success;
+        	success = get_operand_value(tokens[5], &operand2);
+        	if (success != 0) return success;
 
         	double new_var_value = apply_binary_operation(operation, operand1, operand2);
-        	success = bindings->bind_value(var_name, new_var_value);
+        	success = bindings->bind_value(var_name, var_name_length, new_var_value);
             return success;
         }
 
-        if (is_unary_primitive(tokens->at(3))) {
+        if (is_unary_primitive(operation)) {
 
             if (num_tokens != 5) return INVALID_LINE;
 
             double operand1;
-
-            if (is_constant(tokens->at(4))) {
-                operand1 = stof(tokens->at(4), NULL);
-            } else {
-                if (!bindings->has_been_defined(tokens->at(4))) return VAR_REFERENCED_BEFORE_DEFINED;
-                operand1 = bindings->get_value(tokens->at(4));
-
-            }
+            success = get_operand_value(tokens[4], &operand1);
+            if (success != 0) return success;
         	
         	double new_var_value = apply_unary_operation(operation, operand1);
-        	success = bindings->bind_value(var_name, new_var_value);
+        	success = bindings->bind_value(var_name, var_name_length, new_var_value);
             return success;
         
     	}
@@ -425,18 +507,31 @@ double apply_unary_operation(OperationType operation, double operand) {
 
 void Interpreter::accumulate_outputs(unordered_map<string, double> *outputs) {
 
-    for (unordered_map<string, double>::iterator it = bindings->bindings->begin(); it != bindings->bindings->end(); ++it) {
+    for (unordered_map<Symbol, double>::iterator it = bindings->bindings->begin(); it != bindings->bindings->end(); ++it) {
         
-        string var_name = it->first;
+        Symbol var_name = it->first;
         double value = it->second;
 
         if (var_types->count(var_name) != 0) {
             if ((*var_types)[var_name] == VariableType::OUTPUT) {
-                outputs->insert(make_pair(var_name, value));
+                outputs->insert(make_pair(var_name.str(), value));
             }
         }
 
     }
+
+    // the components of output vectors are named as they were declared, "<vector name>.<component number>"
+    for (unordered_map<Symbol, vector<double>*>::iterator it = bindings->vectors->begin(); it != bindings->vectors->end(); ++it) {
+
+        unordered_map<Symbol, VariableType>::iterator vec_type = vector_types->find(it->first);
+        if (vec_type == vector_types->end() || vec_type->second != VariableType::OUTPUT) continue;
+
+        const vector<double>& values = *it->second;
+        for (size_t i = 0; i < values.size(); i++) {
+            if (values[i] != DBL_MIN) outputs->insert(make_pair(it->first.str() + "." + to_string(i), values[i]));
+        }
+
+    }
     
 }
 
@@ -446,6 +541,11 @@ BindingsDictionary *Interpreter::get_bindings_dictionary() {
 }
 
 
-unordered_map<string, VariableType> *Interpreter::get_var_types() {
+unordered_map<Symbol, VariableType> *Interpreter::get_var_types() {
     return this->var_types;
 }
+
+
+unordered_map<Symbol, VariableType> *Interpreter::get_vector_types() {
+    return this->vector_types;
+}
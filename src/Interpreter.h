@@ -5,6 +5,10 @@
 #include <string>
 #include <unordered_map>
 #include "BindingsDictionary.h"
+#include "SparseVector.h"
+#include "Symbol.h"
+#include "Lexer.h"
+#include "LineReader.h"
 #include "utilities.h"
 
 using namespace std;
@@ -29,18 +33,29 @@ using namespace std;
 class Interpreter {
 
 	BindingsDictionary *bindings;
-	unordered_map<string, VariableType>* var_types;
+	unordered_map<Symbol, VariableType>* var_types;
+	/* Maps vector names to the types of their components, which are not recorded one by one (see BindingsDictionary.h). */
+	unordered_map<Symbol, VariableType>* vector_types;
+
+	/* The Tokens of the line being read, reused for every line. */
+	vector<Token> *line_tokens;
+
+	/* Writes the value of OPERAND, which is a constant or a defined variable, into VALUE.
+	 * Constants are read at float precision.
+	 * Returns VAR_REFERENCED_BEFORE_DEFINED if OPERAND is a variable that has not been defined, and 0 otherwise.
+	 */
+	int get_operand_value(const Token& operand, double *value) const;
 
 public:
 
 	/* Constructor.
-	 * Initializes var_types to be an empty unordered map.
+	 * Initializes var_types and vector_types to be empty unordered maps.
 	 * Initializes the Bindings Dictionary.
 	 */
 	Interpreter();
 
 	/* Destructor.
-	 * Deletes the var_types map, and the Bindings Dictionary.
+	 * Deletes the var_types and vector_types maps, and the Bindings Dictionary.
 	 */
 	~Interpreter();
 
@@ -60,7 +75,7 @@ public:
 	 * Takes in a "vector" of inputs in the form of an unordered map of {name, value} pairs.
 	 * Populates a "vector" of outputs with similar {name, value} pairs.
 	 *
-	 * Interpreting a program consists of reading it line by line and taking appropriate actions for each line.
+	 * Interpreting a program consists of reading it line by line (through a LineReader) and taking appropriate actions for each line.
 	 * For every variable declaration line, a dummy binding is added to the Bindings Dictionary.
 	 * For every variable definition line, the value of the variable is evaluated and bound to the variable's name.
 	 *
@@ -68,6 +83,14 @@ public:
 	 */
 	int interpret(const string& filename, const unordered_map<string, double>& inputs, unordered_map<string, double> *outputs);
 
+	/* Interprets the program as above, with some of its input vectors given sparsely, in SPARSE_INPUTS (see SparseVector.h).
+	 * An input component that is not in INPUTS takes its value from its vector in SPARSE_INPUTS, which is 0 if it is not listed.
+	 * Components listed beyond the end of a vector are ignored, as are inputs the program does not declare.
+	 * Returns VAR_DEFINED_TWICE if a component is given both in INPUTS and by its vector in SPARSE_INPUTS.
+	 */
+	int interpret(const string& filename, const unordered_map<string, double>& inputs,
+		const SparseVariableVector& sparse_inputs, unordered_map<string, double> *outputs);
+
 	/* Parses input name-value pairs from the given file INPUT_FILENAME.
 	 * Writes these name-value pairs into the given INPUT_MAP.
 	 * The input file is made of {<var_name>	<value> pairs}, with a tab separating the name and value.
@@ -86,6 +109,17 @@ public:
 	 */
 	int parse_input_file(const string& input_filename, unordered_map<string, double> *input_map);
 
+	/* Parses the input file as above, except that a line may also give a whole input vector sparsely:
+	 *
+	 	x		0:1 17:0.5 2041:-3
+	 *
+	 * The vectors given sparsely are written into SPARSE_INPUT_MAP, by calling parse_sparse_input_line (see SparseVector.h).
+	 * If SPARSE_INPUT_MAP is NULL, sparse lines are invalid, as they are for the version above.
+	 * Returns VAR_DEFINED_TWICE if the file gives the same vector sparsely twice.
+	 */
+	int parse_input_file(const string& input_filename, unordered_map<string, double> *input_map,
+		SparseVariableVector *sparse_input_map);
+
 	/* Takes in a line of an input file, and extracts the input variable's name and value.
 	 * The given pointers INPUT_VAR_NAME and INPUT_VAR_VALUE are written to accordingly.
 	 * Recall that an input file line looks like: "<var_name>	<value>".
@@ -98,6 +132,12 @@ public:
 	 */
 	int parse_input_line(const string& input_line, string *input_var_name, double *input_var_value);
 
+	/* Takes in a sparse line of an input file, "<vector name>	<component number>:<value> ...",
+	 *  and writes the vector's name into INPUT_VEC_NAME and its components into INPUT_VEC.
+	 * Returns INVALID_LINE if the line does not have 2 tokens, or its pairs cannot be parsed (see parse_sparse_vector).
+	 */
+	int parse_sparse_input_line(const string& input_line, string *input_vec_name, SparseVector *input_vec);
+
 	/* Takes in a line, and takes the appropriate action with regards to the Bindings Dictionary.
 	 *
 	 * If the line declares a variable, adds a dummy binding.
@@ -110,8 +150,11 @@ public:
 	 * This method returns 0 on success, and the appropriate error code on failure (see utilities.h).
 	 */
 	int parse_line(const string& line, const unordered_map<string, double>& inputs);
+	int parse_line(const char *line, size_t length, const unordered_map<string, double>& inputs);
+	int parse_line(const char *line, size_t length, const unordered_map<string, double>& inputs,
+		const SparseVariableVector& sparse_inputs);
 
-	/* Iterates through all the variables in the BindingsDictionary.
+	/* Iterates through all the variables in the BindingsDictionary, and all the components of its vectors.
 	 * If a variable is an OUTPUT variable,
 	 *	adds the name-value pair to the given map of outputs.
 	 *
@@ -123,7 +166,10 @@ public:
 	BindingsDictionary *get_bindings_dictionary();
 
 	/* Returns the VAR_TYPES map of this Interpreter. */
-	unordered_map<string, VariableType> *get_var_types();
+	unordered_map<Symbol, VariableType> *get_var_types();
+
+	/* Returns the VECTOR_TYPES map of this Interpreter. */
+	unordered_map<Symbol, VariableType> *get_vector_types();
 
 
 };
@@ -0,0 +1,251 @@
+#include <cmath>
+#include <algorithm>
+
+#include "LBFGS.h"
+#include "DenseVector.h"
+
+using namespace std;
+
+
+LossFunction::~LossFunction() {
+}
+
+
+/* A point tried by the line search: how far along the direction it is, the loss there,
+ *  and the slope of the loss along the direction (the gradient there, dotted with the direction).
+ * A point where the loss cannot be evaluated has an infinite loss, and no slope (NaN).
+ */
+struct LinePoint {
+	double step;
+	double loss;
+	double slope;
+};
+
+
+/* What a line search needs: the loss function, where it starts, the direction it searches along,
+ *  the loss and slope where it starts, and where the weights and gradient of the last point tried are written.
+ */
+struct LineSearch {
+	LossFunction *loss_function;
+	const vector<double> *weights;
+	const vector<double> *direction;
+	LinePoint start;
+	double c1;
+	double c2;
+	vector<double> *trial_weights;
+	vector<double> *trial_gradient;
+	int64_t num_evaluations;
+};
+
+
+/* Evaluates the loss STEP along the direction of SEARCH, leaving the weights and gradient there in SEARCH's trial arrays. */
+static LinePoint try_step(LineSearch *search, double step) {
+	const vector<double>& weights = *search->weights;
+	const vector<double>& direction = *search->direction;
+	vector<double>& trial = *search->trial_weights;
+	trial = weights;
+	dense_axpy(step, direction.data(), trial.data(), trial.size());
+
+	LinePoint point = {step, HUGE_VAL, NAN};
+	double loss;
+	search->num_evaluations++;
+	if (search->loss_function->evaluate(trial, &loss, search->trial_gradient) == 0 && isfinite(loss)) {
+		point.loss = loss;
+		point.slope = dense_dot(search->trial_gradient->data(), direction.data(), direction.size());
+	}
+	return point;
+}
+
+
+/* Returns true if POINT lowers the loss enough (the first Wolfe condition). */
+static bool decreases_enough(const LineSearch& search, const LinePoint& point) {
+	return point.loss <= search.start.loss + search.c1 * point.step * search.start.slope;
+}
+
+
+/* Returns true if the slope at POINT is flat enough (the second, strong, Wolfe condition). */
+static bool flattens_enough(const LineSearch& search, const LinePoint& point) {
+	return fabs(point.slope) <= -search.c2 * search.start.slope;
+}
+
+
+/* Returns the step between LO and HI at the minimum of the cubic that fits their losses and slopes,
+ *  or halfway between them if there is no such minimum well inside the interval.
+ */
+static double interpolate(const LinePoint& lo, const LinePoint& hi) {
+	double middle = (lo.step + hi.step) / 2;
+	if (!isfinite(lo.loss) || !isfinite(hi.loss) || !isfinite(lo.slope) || !isfinite(hi.slope)) return middle;
+
+	double d1 = lo.slope + hi.slope - 3 * (lo.loss - hi.loss) / (lo.step - hi.step);
+	double radicand = d1 * d1 - lo.slope * hi.slope;
+	if (radicand < 0) return middle;
+	double d2 = (hi.step > lo.step ? 1 : -1) * sqrt(radicand);
+	double denominator = hi.slope - lo.slope + 2 * d2;
+	if (denominator == 0) return middle;
+	double step = hi.step - (hi.step - lo.step) * (hi.slope + d2 - d1) / denominator;
+
+	// a step too close to either end makes little progress
+	double low = min(lo.step, hi.step), high = max(lo.step, hi.step), margin = 0.1 * (high - low);
+	if (!isfinite(step) || step < low + margin || step > high - margin) return middle;
+	return step;
+}
+
+
+/* Settles for LO, a point that lowers the loss enough but may not flatten it enough, if it is not the start.
+ * Returns true, with LO in the trial arrays and ACCEPTED, if it settles.
+ */
+static bool settle(LineSearch *search, const LinePoint& lo, LinePoint *accepted) {
+	if (lo.step == 0) return false;
+	*accepted = try_step(search, lo.step);
+	return isfinite(accepted->loss);
+}
+
+
+/* Narrows the interval between LO and HI, which holds a point that meets both Wolfe conditions, until one is found.
+ * LO is the end with the lowest loss that lowers it enough. Returns true, with the point in the trial arrays and ACCEPTED, if one is found.
+ */
+static bool zoom(LineSearch *search, LinePoint lo, LinePoint hi, LinePoint *accepted) {
+	for (int i = 0; i < MAX_LINE_SEARCH_STEPS; i++) {
+		LinePoint point = try_step(search, interpolate(lo, hi));
+
+		if (!decreases_enough(*search, point) || point.loss >= lo.loss) {
+			hi = point;
+		} else {
+			if (flattens_enough(*search, point)) {
+				*accepted = point;
+				return true;
+			}
+			if (point.slope * (hi.step - lo.step) >= 0) hi = lo;
+			lo = point;
+		}
+	}
+	return settle(search, lo, accepted);
+}
+
+
+/* Searches along the direction of SEARCH for a point that meets the strong Wolfe conditions, starting at INITIAL_STEP,
+ *  and doubling the step while the loss keeps falling steeply.
+ * Returns true, with the point in the trial arrays and ACCEPTED, if one is found.
+ */
+static bool line_search(LineSearch *search, double initial_step, LinePoint *accepted) {
+	LinePoint previous = search->start;
+	double step = initial_step;
+
+	for (int i = 0; i < MAX_LINE_SEARCH_STEPS; i++) {
+		LinePoint point = try_step(search, step);
+
+		if (!decreases_enough(*search, point) || (i > 0 && point.loss >= previous.loss)) {
+			return zoom(search, previous, point, accepted);
+		}
+		if (flattens_enough(*search, point)) {
+			*accepted = point;
+			return true;
+		}
+		if (point.slope >= 0) {
+			return zoom(search, point, previous, accepted);
+		}
+
+		previous = point;
+		step *= 2;
+	}
+	return settle(search, previous, accepted);
+}
+
+
+int minimize_lbfgs(LossFunction *loss_function, const OptimizerOptions& options, vector<double> *weights, int64_t *num_evaluations) {
+
+	if (num_evaluations != NULL) *num_evaluations = 0;
+	if (check_optimizer_options(options) != 0) return OTHER_ERROR;
+
+	size_t n = weights->size();
+	size_t m = (size_t) options.lbfgs_history;
+
+	double loss;
+	vector<double> gradient(n);
+	int success = loss_function->evaluate(*weights, &loss, &gradient);
+	if (num_evaluations != NULL) *num_evaluations = 1;
+	if (success != 0) return success;
+
+	// the last M steps (S) and changes in the gradient (Y), in a ring of M rows of N values, with RHO = 1 / (s . y) for each
+	vector<double> s_history(m * n), y_history(m * n), rho(m), alpha(m);
+	size_t num_pairs = 0, newest = 0;
+
+	vector<double> direction(n), trial_weights(n), trial_gradient(n);
+	LineSearch search;
+	search.loss_function = loss_function;
+	search.weights = weights;
+	search.direction = &direction;
+	search.c1 = options.wolfe_c1;
+	search.c2 = options.wolfe_c2;
+	search.trial_weights = &trial_weights;
+	search.trial_gradient = &trial_gradient;
+	search.num_evaluations = 1;
+
+	for (int64_t iteration = 0; iteration < options.max_iterations; iteration++) {
+		double gradient_length = dense_norm(gradient.data(), n);
+		if (gradient_length <= options.gradient_precision) break;
+
+		// the two-loop recursion: direction = -H * gradient, where H estimates the inverse of the curvature from the history
+		direction = gradient;
+		for (size_t k = 0; k < num_pairs; k++) {
+			size_t row = (newest + m - k) % m;
+			const double *s = &s_history[row * n], *y = &y_history[row * n];
+			alpha[row] = dense_dot(s, direction.data(), n) * rho[row];
+			dense_axpy(-alpha[row], y, direction.data(), n);
+		}
+		if (num_pairs > 0) {
+			// the newest step scales the estimate: gamma = (s . y) / (y . y)
+			const double *y = &y_history[newest * n];
+			dense_scale(1 / (rho[newest] * dense_dot(y, y, n)), direction.data(), n);
+		}
+		for (size_t k = num_pairs; k > 0; k--) {
+			size_t row = (newest + m - (k - 1)) % m;
+			const double *s = &s_history[row * n], *y = &y_history[row * n];
+			double b = dense_dot(y, direction.data(), n) * rho[row];
+			dense_axpy(alpha[row] - b, s, direction.data(), n);
+		}
+		dense_scale(-1, direction.data(), n);
+
+		// the history should always give a descent direction, but rounding can spoil it: start again from steepest descent
+		double slope = dense_dot(gradient.data(), direction.data(), n);
+		if (!(slope < 0)) {
+			num_pairs = 0;
+			direction = gradient;
+			dense_scale(-1, direction.data(), n);
+			slope = -gradient_length * gradient_length;
+		}
+
+		// without a history there is no idea of scale, so the first step is at most the length of a unit step
+		search.start.step = 0;
+		search.start.loss = loss;
+		search.start.slope = slope;
+		double initial_step = num_pairs == 0 ? min(1.0, 1 / gradient_length) : 1;
+		LinePoint accepted;
+		if (!line_search(&search, initial_step, &accepted)) {
+			if (num_pairs == 0) break;
+			num_pairs = 0;
+			continue;
+		}
+
+		// remember the step, if the loss curved upwards along it, in place of the oldest
+		// the step and the change in the gradient are worked out in place, in the (now stale) weights and gradient
+		dense_axpby(1, trial_weights.data(), -1, weights->data(), n);
+		dense_axpby(1, trial_gradient.data(), -1, gradient.data(), n);
+		double sy = dense_dot(weights->data(), gradient.data(), n);
+		if (sy > 0) {
+			size_t row = num_pairs == 0 ? 0 : (newest + 1) % m;
+			copy(weights->begin(), weights->end(), s_history.begin() + row * n);
+			copy(gradient.begin(), gradient.end(), y_history.begin() + row * n);
+			rho[row] = 1 / sy;
+			newest = row;
+			num_pairs = min(num_pairs + 1, m);
+		}
+
+		weights->swap(trial_weights);
+		gradient.swap(trial_gradient);
+		loss = accepted.loss;
+	}
+
+	if (num_evaluations != NULL) *num_evaluations = search.num_evaluations;
+	return 0;
+}
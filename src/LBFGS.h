@@ -0,0 +1,64 @@
+#ifndef LBFGS_H
+#define LBFGS_H
+
+#include <vector>
+#include <cstdint>
+
+#include "Optimizer.h"
+#include "utilities.h"
+
+using namespace std;
+
+
+/* This file defines L-BFGS, a quasi-Newton method for full-batch training.
+ * Gradient descent steps along the gradient, by a fixed learning rate, and so needs hundreds of steps where the loss is badly curved.
+ * L-BFGS estimates the curvature of the loss from the last m steps it took (the changes in the weights, and in the gradient),
+ *  and steps along the gradient corrected by that curvature: close to a Newton step, without ever forming a matrix.
+ * How far to go along each direction is found by a line search, so there is no learning rate:
+ *  every step must meet the strong Wolfe conditions (with 0 < c1 < c2 < 1, and d the direction):
+ *
+	loss(w + a * d) <= loss(w) + c1 * a * (gradient(w) . d)			(the loss decreases enough)
+	|gradient(w + a * d) . d| <= c2 * |gradient(w) . d|			(the slope flattens enough)
+ *
+ * The line search needs the loss and the gradient at every point it tries, and gets both from one evaluation (see LossFunction).
+ * The weights, the gradient and the history of steps are kept in dense arrays indexed by weight slot.
+ */
+
+
+/* The most points a line search tries before it gives up on a direction. */
+#define MAX_LINE_SEARCH_STEPS 20
+
+
+/* A LossFunction computes the loss, and its gradient, for a set of weights, in one evaluation.
+ * Training implements it by running the GCP over the training data (see calculate_weights).
+ */
+class LossFunction {
+
+public:
+
+	virtual ~LossFunction();
+
+	/* Writes the loss for WEIGHTS into LOSS, and the partial of the loss with respect to every weight into GRADIENT, by weight slot.
+	 * Returns 0 on success, and an error code if the loss cannot be computed for WEIGHTS.
+	 */
+	virtual int evaluate(const vector<double>& weights, double *loss, vector<double> *gradient) = 0;
+
+};
+
+
+/* Minimizes LOSS_FUNCTION with L-BFGS, starting from WEIGHTS, and writes the weights it finds into WEIGHTS.
+ * OPTIONS gives the history size (lbfgs_history), the Wolfe constants (wolfe_c1 and wolfe_c2),
+ *  and when to stop: after max_iterations steps, or once the length of the gradient is at most gradient_precision.
+ * It also stops when no point along the steepest descent direction lowers the loss enough,
+ *  which only happens once the loss is as low as rounding lets it get.
+ * If NUM_EVALUATIONS is not NULL, the number of times the loss was evaluated is written into it.
+ *
+ * Returns the error of the loss function if it cannot be evaluated at the starting weights,
+ *  OTHER_ERROR if the options are out of range (see check_optimizer_options), and 0 otherwise.
+ * Points the line search tries where the loss cannot be evaluated (such as the log of a negative number) are treated as too far.
+ */
+int minimize_lbfgs(LossFunction *loss_function, const OptimizerOptions& options, vector<double> *weights, int64_t *num_evaluations);
+
+
+
+#endif
@@ -0,0 +1,194 @@
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+
+#include "Lexer.h"
+
+using namespace std;
+
+
+/* ---------------- Tables -------------- */
+
+/* A keyword, and what it names. */
+struct Keyword {
+	const char *word;
+	InstructionType instruction_type;
+	VariableType variable_type;
+	OperationType operation_type;
+};
+
+#define NO_INST InstructionType::INVALID_INST
+#define NO_VAR VariableType::INVALID_VAR_TYPE
+#define NO_OPER OperationType::INVALID_OPERATION
+
+static const Keyword KEYWORDS[] = {
+	{"declare", InstructionType::DECLARE, NO_VAR, NO_OPER},
+	{"define", InstructionType::DEFINE, NO_VAR, NO_OPER},
+	{"declare_vector", InstructionType::DECLARE_VECTOR, NO_VAR, NO_OPER},
+	{"define_vector", InstructionType::DEFINE_VECTOR, NO_VAR, NO_OPER},
+	{"#macro", InstructionType::MACRO, NO_VAR, NO_OPER},
+	{"input", NO_INST, VariableType::INPUT, NO_OPER},
+	{"output", NO_INST, VariableType::OUTPUT, NO_OPER},
+	{"exp_output", NO_INST, VariableType::EXP_OUTPUT, NO_OPER},
+	{"weight", NO_INST, VariableType::WEIGHT, NO_OPER},
+	{"intvar", NO_INST, VariableType::INTVAR, NO_OPER},
+	{"loss", NO_INST, VariableType::LOSS, NO_OPER},
+	{"constant", NO_INST, VariableType::CONSTANT, NO_OPER},
+	{"add", NO_INST, NO_VAR, OperationType::ADD},
+	{"sub", NO_INST, NO_VAR, OperationType::SUB},
+	{"mul", NO_INST, NO_VAR, OperationType::MUL},
+	{"dot", NO_INST, NO_VAR, OperationType::DOT},
+	{"logistic", NO_INST, NO_VAR, OperationType::LOGISTIC},
+	{"exp", NO_INST, NO_VAR, OperationType::EXP},
+	{"pow", NO_INST, NO_VAR, OperationType::POW},
+	{"ln", NO_INST, NO_VAR, OperationType::LN},
+	{"reduce_vector", NO_INST, NO_VAR, OperationType::REDUCE_VECTOR},
+	{"scale_vector", NO_INST, NO_VAR, OperationType::SCALE_VECTOR},
+	{"increment_vector", NO_INST, NO_VAR, OperationType::INCREMENT_VECTOR},
+	{"component_wise_add", NO_INST, NO_VAR, OperationType::COMPONENT_WISE_ADD},
+	{"component_wise_mul", NO_INST, NO_VAR, OperationType::COMPONENT_WISE_MUL},
+	{"=", NO_INST, NO_VAR, NO_OPER}
+};
+
+static const size_t NUM_KEYWORDS = sizeof(KEYWORDS) / sizeof(KEYWORDS[0]);
+
+
+/* The lookup tables, indexed by the first character of a Token (as an unsigned char).
+ * CAN_START_NUMBER is true for the characters strtod accepts first: digits, signs, '.', whitespace, and the 'i' and 'n' of "inf" and "nan".
+ * FIRST_KEYWORD is the index in KEYWORDS of the first keyword starting with that character, plus one (0 if there is none).
+ */
+struct LexerTables {
+	bool can_start_number[256];
+	uint8_t first_keyword[256];
+
+	LexerTables() {
+		memset(can_start_number, 0, sizeof(can_start_number));
+		memset(first_keyword, 0, sizeof(first_keyword));
+
+		const char *number_starts = "0123456789+-. \t\n\v\f\riInN";
+		for (const char *c = number_starts; *c != '\0'; c++) can_start_number[(unsigned char) *c] = true;
+
+		for (size_t k = NUM_KEYWORDS; k > 0; k--) first_keyword[(unsigned char) KEYWORDS[k - 1].word[0]] = k;
+	}
+};
+
+/* The tables are built the first time they are used, so they are ready even during static initialization. */
+static const LexerTables& get_tables() {
+	static const LexerTables tables;
+	return tables;
+}
+
+
+/* Returns the keyword made of the LENGTH characters at START, or NULL if they are not a keyword. */
+static const Keyword *find_keyword(const char *start, size_t length) {
+	if (length == 0) return NULL;
+	uint8_t first = get_tables().first_keyword[(unsigned char) start[0]];
+	if (first == 0) return NULL;
+
+	for (size_t k = first - 1; k < NUM_KEYWORDS; k++) {
+		const char *word = KEYWORDS[k].word;
+		if (word[0] == start[0] && strncmp(word, start, length) == 0 && word[length] == '\0') return &KEYWORDS[k];
+	}
+	return NULL;
+}
+
+
+
+/* ---------------- Tokens -------------- */
+
+string Token::str() const {
+	return string(start, length);
+}
+
+
+bool Token::equals(const char *word) const {
+	return strncmp(word, start, length) == 0 && word[length] == '\0';
+}
+
+
+bool parse_number(const char *start, size_t length, double *value) {
+
+	if (length == 0 || !get_tables().can_start_number[(unsigned char) start[0]]) return false;
+
+	// strtod needs a terminated string, and must not read past the Token
+	char buffer[64];
+	string long_number;
+	const char *number = buffer;
+	if (length < sizeof(buffer)) {
+		memcpy(buffer, start, length);
+		buffer[length] = '\0';
+	} else {
+		long_number.assign(start, length);
+		number = long_number.c_str();
+	}
+
+	// stod refuses numbers that are out of range, and so does is_constant
+	char *end;
+	errno = 0;
+	double parsed = strtod(number, &end);
+	if (end != number + length || errno == ERANGE) return false;
+
+	*value = parsed;
+	return true;
+}
+
+
+void classify_token(const char *start, size_t length, Token *token) {
+	token->start = start;
+	token->length = length;
+	token->instruction_type = InstructionType::INVALID_INST;
+	token->variable_type = VariableType::INVALID_VAR_TYPE;
+	token->operation_type = OperationType::INVALID_OPERATION;
+	token->number = 0;
+
+	if (parse_number(start, length, &token->number)) {
+		token->token_class = TokenClass::NUMBER;
+		return;
+	}
+
+	const Keyword *keyword = find_keyword(start, length);
+	if (keyword != NULL) {
+		token->token_class = TokenClass::KEYWORD;
+		token->instruction_type = keyword->instruction_type;
+		token->variable_type = keyword->variable_type;
+		token->operation_type = keyword->operation_type;
+		return;
+	}
+
+	token->token_class = TokenClass::IDENTIFIER;
+}
+
+
+int lex_line(const string& line, char delimiter, vector<Token> *tokens) {
+	return lex_line(line.data(), line.length(), delimiter, tokens);
+}
+
+
+int lex_line(const char *line, size_t length, char delimiter, vector<Token> *tokens) {
+
+	if (tokens == NULL) return OTHER_ERROR;
+	tokens->clear();
+
+	const char *end = line + length;
+	const char *c = line;
+	while (c != end) {
+		if (*c == delimiter) {
+			c++;
+			continue;
+		}
+
+		const char *next_delimiter = (const char *) memchr(c, delimiter, end - c);
+		if (next_delimiter == NULL) next_delimiter = end;
+
+		tokens->push_back(Token());
+		classify_token(c, next_delimiter - c, &tokens->back());
+		c = next_delimiter;
+	}
+
+	return tokens->size();
+}
+
+
+bool is_valid_expanded_var_name(const Token& token) {
+	return token.token_class != TokenClass::KEYWORD;
+}
@@ -0,0 +1,91 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "utilities.h"
+
+using namespace std;
+
+
+/* The Lexer splits a line of a TenFlang program into Tokens, and classifies each Token as it goes.
+ * Every phase (Preprocessor, Compiler, Interpreter, and Program loading) reads its lines with the same Lexer.
+ *
+ * Lexing never copies the line: a Token is a pointer to its first character and a length,
+ *  so a Token is only valid while the line it was read from is alive and unchanged.
+ * Each Token is classified once, with tables:
+ *  - A keyword (an instruction type, variable type, operation, or "=") is looked up in a table of keywords,
+ *     and the Token records which instruction type, variable type and operation it names.
+ *  - A number is parsed once, without exceptions, and the Token records its value.
+ *     Numbers are exactly the strings is_constant accepts (see utilities.h).
+ *  - Anything else is an identifier (such as a variable name).
+ * Only a Token whose first character can start a number is ever parsed as one,
+ *  so variable names are classified with one table lookup and one keyword lookup.
+ */
+
+
+/* The class of a Token. */
+enum class TokenClass {
+	KEYWORD,
+	NUMBER,
+	IDENTIFIER
+};
+
+
+/* A Token is one delimited word of a line. */
+struct Token {
+	/* The first character of the Token, in the line it was read from, and its length. */
+	const char *start;
+	uint32_t length;
+
+	TokenClass token_class;
+
+	/* What a keyword names. A keyword names at most one of these, and the others are invalid.
+	 * All three are invalid for numbers, identifiers and "=".
+	 */
+	InstructionType instruction_type;
+	VariableType variable_type;
+	OperationType operation_type;
+
+	/* The value of a number, and 0 otherwise. */
+	double number;
+
+	/* Returns a copy of the Token's characters. */
+	string str() const;
+
+	/* Returns true if the Token's characters are exactly WORD. */
+	bool equals(const char *word) const;
+};
+
+
+/* Splits LINE into the Tokens between DELIMITERs, and classifies them (see the top of this file).
+ * Runs of delimiters, and delimiters at the start or end of the line, produce no Tokens.
+ * TOKENS is cleared first, so one vector can be reused for every line without allocating.
+ * Returns the number of Tokens, or OTHER_ERROR if TOKENS is NULL.
+ */
+int lex_line(const string& line, char delimiter, vector<Token> *tokens);
+int lex_line(const char *line, size_t length, char delimiter, vector<Token> *tokens);
+
+/* The Tokens point into LINE, so lexing a temporary string (such as one made from a string literal) would leave them dangling. */
+int lex_line(const string&& line, char delimiter, vector<Token> *tokens) = delete;
+
+/* Classifies the LENGTH characters at START as a keyword, number or identifier, and fills in TOKEN. */
+void classify_token(const char *start, size_t length, Token *token);
+
+/* Parses the LENGTH characters at START as a number, writing it into VALUE.
+ * Accepts the same numbers as is_constant (see utilities.h), including values stod would refuse as out of range,
+ *  which are not numbers either. Never throws.
+ * Returns true if all the characters make up one number, and false otherwise.
+ */
+bool parse_number(const char *start, size_t length, double *value);
+
+/* Returns true if the given Token is the name of a variable the Compiler/Interpreter can handle:
+ *  any Token that is not a keyword (see is_valid_expanded_var_name in utilities.h).
+ */
+bool is_valid_expanded_var_name(const Token& token);
+
+
+
+#endif
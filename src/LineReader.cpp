@@ -0,0 +1,203 @@
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "LineReader.h"
+
+using namespace std;
+
+
+/* The size of the blocks a file that is not mapped is read in. */
+#define DESCRIPTOR_BUFFER_SIZE (1 << 16)
+
+
+/* A DescriptorBuffer is a streambuf that reads an open file descriptor with read(2), a block at a time.
+ * It owns the descriptor, and closes it when it is destroyed.
+ */
+class DescriptorBuffer : public streambuf {
+
+	int fd;
+	char *buffer;
+
+public:
+
+	DescriptorBuffer(int fd) {
+		this->fd = fd;
+		buffer = new char[DESCRIPTOR_BUFFER_SIZE];
+		setg(buffer, buffer, buffer);
+	}
+
+	~DescriptorBuffer() {
+		::close(fd);
+		delete[] buffer;
+	}
+
+protected:
+
+	/* Reads the next block, once the last one is used up. A signal that interrupts the read does not end the stream. */
+	int_type underflow() {
+		if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+		ssize_t num_read;
+		do {
+			num_read = read(fd, buffer, DESCRIPTOR_BUFFER_SIZE);
+		} while (num_read < 0 && errno == EINTR);
+		if (num_read <= 0) return traits_type::eof();
+		setg(buffer, buffer, buffer + num_read);
+		return traits_type::to_int_type(*gptr());
+	}
+
+};
+
+
+
+/* ---------------- Constructor/Destructor --------------- */
+
+LineReader::LineReader() {
+	data = NULL;
+	size = 0;
+	position = 0;
+	mapped = false;
+	stream = NULL;
+	file = NULL;
+	file_buffer = NULL;
+	line = new string();
+	finished = true;
+}
+
+
+LineReader::LineReader(istream& in) {
+	data = NULL;
+	size = 0;
+	position = 0;
+	mapped = false;
+	stream = &in;
+	file = NULL;
+	file_buffer = NULL;
+	line = new string();
+	finished = false;
+}
+
+
+LineReader::~LineReader() {
+	close();
+	delete line;
+}
+
+
+
+/* ---------------- Opening -------------- */
+
+int LineReader::open(const string& filename) {
+
+	close();
+
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) return INVALID_FILE_NAME;
+
+	struct stat status;
+	if (fstat(fd, &status) != 0 || S_ISDIR(status.st_mode)) {
+		::close(fd);
+		return INVALID_FILE_NAME;
+	}
+
+	// a regular file is mapped whole; an empty one has nothing to map
+	if (S_ISREG(status.st_mode)) {
+		size = status.st_size;
+		if (size == 0) {
+			mapped = true;
+		} else {
+			void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapping != MAP_FAILED) {
+				madvise(mapping, size, MADV_SEQUENTIAL);
+				data = (const char *) mapping;
+				mapped = true;
+			}
+		}
+	}
+
+	// the mapping outlives the descriptor
+	if (mapped) {
+		::close(fd);
+	}
+
+	// pipes, devices, and files that could not be mapped are streamed from the descriptor they were opened with
+	else {
+		size = 0;
+		file_buffer = new DescriptorBuffer(fd);
+		file = new istream(file_buffer);
+		stream = file;
+	}
+
+	position = 0;
+	finished = false;
+	return 0;
+}
+
+
+void LineReader::close() {
+	if (data != NULL) munmap((void *) data, size);
+	data = NULL;
+	size = 0;
+	position = 0;
+	mapped = false;
+
+	// the stream goes first, as it reads through the buffer, which closes the descriptor
+	delete file;
+	delete file_buffer;
+	file = NULL;
+	file_buffer = NULL;
+	stream = NULL;
+	finished = true;
+}
+
+
+
+/* ---------------- Reading -------------- */
+
+bool LineReader::next_line(const char **start, size_t *length) {
+
+	if (finished) return false;
+
+	if (mapped) {
+		const char *line_start = data + position;
+		const char *newline = size == position ? NULL : (const char *) memchr(line_start, '\n', size - position);
+
+		// the text after the last newline is the last line
+		if (newline == NULL) {
+			*start = line_start;
+			*length = size - position;
+			position = size;
+			finished = true;
+		} else {
+			*start = line_start;
+			*length = newline - line_start;
+			position += *length + 1;
+		}
+		return true;
+	}
+
+	// getline stops at eof, or fails if there was nothing left to read (and then reads an empty line)
+	getline(*stream, *line);
+	if (stream->eof() || stream->fail()) finished = true;
+	*start = line->data();
+	*length = line->length();
+	return true;
+}
+
+
+bool LineReader::next_line(string *line_copy) {
+	const char *start;
+	size_t length;
+	if (!next_line(&start, &length)) return false;
+	if (start != line->data()) line_copy->assign(start, length);
+	else if (line_copy != line) *line_copy = *line;
+	return true;
+}
+
+
+bool LineReader::is_mapped() const {
+	return mapped;
+}
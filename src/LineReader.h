@@ -0,0 +1,91 @@
+#ifndef LINEREADER_H
+#define LINEREADER_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdint>
+
+#include "utilities.h"
+
+using namespace std;
+
+
+/* A LineReader reads a TenFlang program (or an input or training data file) one line at a time.
+ * Every phase reads its files through a LineReader.
+ *
+ * A regular file is mapped into memory whole, with a hint to the kernel that it will be read in order,
+ *  and each line is handed out as a pointer into the mapping and a length: lines are never copied.
+ * Anything that cannot be mapped (a pipe, /dev/stdin, or any other stream) is read with getline instead,
+ *  into one buffer that is reused for every line.
+ * A file the LineReader opens, but cannot map, is streamed from the descriptor it was opened with, and is never opened twice:
+ *  so the writer of a named pipe sees one reader, from the first line to the last.
+ *
+ * Either way, the lines are exactly those a loop of getline calls until eof would read:
+ *  the text is split at every '\n', and the text after the last '\n' is the last line, even if it is empty.
+ * So a file ending in a newline has an empty last line, and an empty file has one empty line.
+ */
+class LineReader {
+
+	/* The mapped file, its size, and the position of the next line in it. */
+	const char *data;
+	size_t size;
+	size_t position;
+	bool mapped;
+
+	/* The stream read when the input is not mapped, and, if the LineReader opened the file, the stream over its descriptor,
+	 *  and the buffer that stream reads the descriptor through (which closes it).
+	 */
+	istream *stream;
+	istream *file;
+	streambuf *file_buffer;
+
+	/* The last line read from the stream, or copied for next_line(string*). */
+	string *line;
+
+	/* True once the last line has been read. */
+	bool finished;
+
+
+public:
+
+	/* Constructor.
+	 * Creates a LineReader with nothing to read, until a file is opened.
+	 */
+	LineReader();
+
+	/* Constructor.
+	 * Creates a LineReader that reads the lines of IN, which must outlive it.
+	 */
+	LineReader(istream& in);
+
+	/* Destructor.
+	 * Unmaps or closes the file, if one was opened.
+	 */
+	~LineReader();
+
+	/* Opens the file with the given FILENAME, mapping it if it is a regular file.
+	 * Returns INVALID_FILE_NAME if the file cannot be opened (or is a directory), and 0 otherwise.
+	 */
+	int open(const string& filename);
+
+	/* Unmaps or closes the opened file. No more lines are read. */
+	void close();
+
+	/* Reads the next line (without its '\n') into START and LENGTH.
+	 * The line stays valid until the next call, or until the LineReader is closed.
+	 * Returns false, and reads nothing, if there are no more lines.
+	 */
+	bool next_line(const char **start, size_t *length);
+
+	/* Reads the next line into LINE. Returns false if there are no more lines. */
+	bool next_line(string *line);
+
+	/* Returns true if the file was mapped into memory. */
+	bool is_mapped() const;
+
+};
+
+
+
+#endif
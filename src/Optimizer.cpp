@@ -0,0 +1,275 @@
+#include <cmath>
+
+#include "Optimizer.h"
+#include "DenseVector.h"
+
+using namespace std;
+
+
+bool parse_optimizer_type(const string& name, OptimizerType *type) {
+	if (name == "gd") *type = OptimizerType::GRADIENT_DESCENT;
+	else if (name == "momentum") *type = OptimizerType::MOMENTUM;
+	else if (name == "nesterov") *type = OptimizerType::NESTEROV;
+	else if (name == "adagrad") *type = OptimizerType::ADAGRAD;
+	else if (name == "rmsprop") *type = OptimizerType::RMSPROP;
+	else if (name == "adam") *type = OptimizerType::ADAM;
+	else if (name == "lbfgs") *type = OptimizerType::LBFGS;
+	else return false;
+	return true;
+}
+
+
+/* Returns true if VALUE is in [0, 1). */
+static bool is_fraction(double value) {
+	return value >= 0 && value < 1;
+}
+
+
+int check_optimizer_options(const OptimizerOptions& options) {
+	if (!(options.learning_rate > 0) || !(options.epsilon > 0)) return OTHER_ERROR;
+	if (!is_fraction(options.momentum) || !is_fraction(options.decay)) return OTHER_ERROR;
+	if (!is_fraction(options.beta1) || !is_fraction(options.beta2)) return OTHER_ERROR;
+	if (options.max_iterations < 0 || !(options.gradient_precision >= 0)) return OTHER_ERROR;
+	if (options.lbfgs_history < 1 || !(options.wolfe_c1 > 0 && options.wolfe_c1 < options.wolfe_c2 && options.wolfe_c2 < 1)) return OTHER_ERROR;
+	return 0;
+}
+
+
+Optimizer *create_optimizer(size_t num_weights, const OptimizerOptions& options) {
+	if (check_optimizer_options(options) != 0) return NULL;
+
+	switch (options.type) {
+		case OptimizerType::GRADIENT_DESCENT: return new GradientDescentOptimizer(num_weights, options);
+		case OptimizerType::MOMENTUM: return new MomentumOptimizer(num_weights, options);
+		case OptimizerType::NESTEROV: return new NesterovOptimizer(num_weights, options);
+		case OptimizerType::ADAGRAD: return new AdagradOptimizer(num_weights, options);
+		case OptimizerType::RMSPROP: return new RMSPropOptimizer(num_weights, options);
+		case OptimizerType::ADAM: return new AdamOptimizer(num_weights, options);
+		case OptimizerType::LBFGS: return NULL;
+	}
+	return NULL;
+}
+
+
+
+/* ---------------- Optimizer --------------- */
+
+Optimizer::Optimizer(size_t num_weights, const OptimizerOptions& options) {
+	this->num_weights = num_weights;
+	this->options = options;
+	num_steps = 0;
+	state_arrays = new vector<vector<double> *>();
+}
+
+
+Optimizer::~Optimizer() {
+	delete state_arrays;
+}
+
+
+int Optimizer::step(const vector<double>& gradient, vector<double> *weights) {
+	if (gradient.size() != num_weights || weights->size() != num_weights) return OTHER_ERROR;
+	num_steps++;
+	update(gradient.data(), weights->data());
+	return 0;
+}
+
+
+void Optimizer::reset() {
+	num_steps = 0;
+}
+
+
+int64_t Optimizer::get_num_steps() const {
+	return num_steps;
+}
+
+
+const OptimizerOptions& Optimizer::get_options() const {
+	return options;
+}
+
+
+size_t Optimizer::get_num_state_arrays() const {
+	return state_arrays->size();
+}
+
+
+const vector<double>& Optimizer::get_state_array(size_t i) const {
+	return *(*state_arrays)[i];
+}
+
+
+int Optimizer::restore_state(int64_t num_steps, const vector<vector<double> >& state_arrays) {
+	if (num_steps < 0 || state_arrays.size() != this->state_arrays->size()) return OTHER_ERROR;
+	for (size_t i = 0; i < state_arrays.size(); i++) {
+		if (state_arrays[i].size() != num_weights) return OTHER_ERROR;
+	}
+
+	this->num_steps = num_steps;
+	for (size_t i = 0; i < state_arrays.size(); i++) *(*this->state_arrays)[i] = state_arrays[i];
+	return 0;
+}
+
+
+
+/* ---------------- Gradient Descent --------------- */
+
+GradientDescentOptimizer::GradientDescentOptimizer(size_t num_weights, const OptimizerOptions& options)
+	: Optimizer(num_weights, options) {
+}
+
+
+void GradientDescentOptimizer::update(const double *gradient, double *weights) {
+	dense_axpy(-options.learning_rate, gradient, weights, num_weights);
+}
+
+
+
+/* ---------------- Momentum --------------- */
+
+MomentumOptimizer::MomentumOptimizer(size_t num_weights, const OptimizerOptions& options)
+	: Optimizer(num_weights, options) {
+	velocity = new vector<double>(num_weights, 0);
+	state_arrays->push_back(velocity);
+}
+
+
+MomentumOptimizer::~MomentumOptimizer() {
+	delete velocity;
+}
+
+
+void MomentumOptimizer::reset() {
+	Optimizer::reset();
+	velocity->assign(num_weights, 0);
+}
+
+
+void MomentumOptimizer::update(const double *gradient, double *weights) {
+	double *v = velocity->data();
+	dense_axpby(-options.learning_rate, gradient, options.momentum, v, num_weights);
+	dense_axpy(1, v, weights, num_weights);
+}
+
+
+
+/* ---------------- Nesterov --------------- */
+
+NesterovOptimizer::NesterovOptimizer(size_t num_weights, const OptimizerOptions& options)
+	: MomentumOptimizer(num_weights, options) {
+}
+
+
+void NesterovOptimizer::update(const double *gradient, double *weights) {
+	double rate = options.learning_rate, momentum = options.momentum;
+	double *v = velocity->data();
+
+	// (1 + momentum) * velocity - momentum * previous is momentum^2 * previous - (1 + momentum) * learning_rate * gradient
+	dense_axpy(momentum * momentum, v, weights, num_weights);
+	dense_axpy(-(1 + momentum) * rate, gradient, weights, num_weights);
+	dense_axpby(-rate, gradient, momentum, v, num_weights);
+}
+
+
+
+/* ---------------- Adagrad --------------- */
+
+AdagradOptimizer::AdagradOptimizer(size_t num_weights, const OptimizerOptions& options)
+	: Optimizer(num_weights, options) {
+	sum_of_squares = new vector<double>(num_weights, 0);
+	state_arrays->push_back(sum_of_squares);
+}
+
+
+AdagradOptimizer::~AdagradOptimizer() {
+	delete sum_of_squares;
+}
+
+
+void AdagradOptimizer::reset() {
+	Optimizer::reset();
+	sum_of_squares->assign(num_weights, 0);
+}
+
+
+void AdagradOptimizer::update(const double *gradient, double *weights) {
+	double rate = options.learning_rate, epsilon = options.epsilon;
+	double *squares = sum_of_squares->data();
+	for (size_t i = 0; i < num_weights; i++) {
+		squares[i] += gradient[i] * gradient[i];
+		weights[i] -= rate * gradient[i] / (sqrt(squares[i]) + epsilon);
+	}
+}
+
+
+
+/* ---------------- RMSProp --------------- */
+
+RMSPropOptimizer::RMSPropOptimizer(size_t num_weights, const OptimizerOptions& options)
+	: Optimizer(num_weights, options) {
+	mean_square = new vector<double>(num_weights, 0);
+	state_arrays->push_back(mean_square);
+}
+
+
+RMSPropOptimizer::~RMSPropOptimizer() {
+	delete mean_square;
+}
+
+
+void RMSPropOptimizer::reset() {
+	Optimizer::reset();
+	mean_square->assign(num_weights, 0);
+}
+
+
+void RMSPropOptimizer::update(const double *gradient, double *weights) {
+	double rate = options.learning_rate, decay = options.decay, epsilon = options.epsilon;
+	double *squares = mean_square->data();
+	for (size_t i = 0; i < num_weights; i++) {
+		squares[i] = decay * squares[i] + (1 - decay) * gradient[i] * gradient[i];
+		weights[i] -= rate * gradient[i] / (sqrt(squares[i]) + epsilon);
+	}
+}
+
+
+
+/* ---------------- Adam --------------- */
+
+AdamOptimizer::AdamOptimizer(size_t num_weights, const OptimizerOptions& options)
+	: Optimizer(num_weights, options) {
+	mean = new vector<double>(num_weights, 0);
+	mean_square = new vector<double>(num_weights, 0);
+	state_arrays->push_back(mean);
+	state_arrays->push_back(mean_square);
+}
+
+
+AdamOptimizer::~AdamOptimizer() {
+	delete mean;
+	delete mean_square;
+}
+
+
+void AdamOptimizer::reset() {
+	Optimizer::reset();
+	mean->assign(num_weights, 0);
+	mean_square->assign(num_weights, 0);
+}
+
+
+void AdamOptimizer::update(const double *gradient, double *weights) {
+	double rate = options.learning_rate, beta1 = options.beta1, beta2 = options.beta2, epsilon = options.epsilon;
+
+	// the bias corrections are the same for every weight, so they are computed once per step
+	double correction1 = 1 - pow(beta1, (double) num_steps);
+	double correction2 = 1 - pow(beta2, (double) num_steps);
+
+	double *m = mean->data(), *s = mean_square->data();
+	for (size_t i = 0; i < num_weights; i++) {
+		m[i] = beta1 * m[i] + (1 - beta1) * gradient[i];
+		s[i] = beta2 * s[i] + (1 - beta2) * gradient[i] * gradient[i];
+		weights[i] -= rate * (m[i] / correction1) / (sqrt(s[i] / correction2) + epsilon);
+	}
+}
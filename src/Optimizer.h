@@ -0,0 +1,294 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "utilities.h"
+
+using namespace std;
+
+
+/* This file defines the Optimizers of the Weight Calculation Phase.
+ * Gradient Descent computes the gradient of the loss for the current weights, and then an Optimizer decides how to move the weights.
+ * Plain gradient descent moves them by the gradient scaled by minus the learning rate.
+ * The other Optimizers remember something of the gradients they have been given:
+ *  momentum keeps moving the weights in the direction they have been moving,
+ *  and the adaptive Optimizers (Adagrad, RMSProp, Adam) give each weight its own step size, from the size of its past partials.
+ * On badly scaled inputs, where one learning rate is too large for some weights and too small for others,
+ *  the adaptive Optimizers need far fewer gradients (and so far fewer executions of the GCP) to converge.
+ *
+ * Optimizers work on dense arrays: the weights and the gradient are given as arrays indexed by weight slot,
+ *  the index of each weight in the list of weight names, and their state is kept in arrays indexed the same way.
+ */
+
+
+/* --------------------------------- Default Hyperparameters ---------------------------------- */
+
+
+/* The learning rate determines how much the weights are incremented after each iteration of the algorithm. */
+#define LEARNING_RATE 0.1
+/* This defines how many iterations to stop after. More iterations tends to result in more precision. */
+#define MAX_NUM_ITERATIONS 1000
+/* This variable determines how the maximum magnitude of the gradient vector after which the algorithm can terminate.
+ * If the gradient never becomes this small, the algorithm will terminate after MAX_NUM_ITERATIONS.
+ */
+#define GRADIENT_PRECISION 0.0005
+
+
+/* The kinds of Optimizer (see the classes below).
+ * LBFGS is not an Optimizer that takes steps from gradients alone: it searches along each direction, for full-batch training only (see LBFGS.h).
+ */
+enum class OptimizerType { GRADIENT_DESCENT, MOMENTUM, NESTEROV, ADAGRAD, RMSPROP, ADAM, LBFGS };
+
+
+/* The hyperparameters of an Optimizer, and when Gradient Descent stops.
+ * Every Optimizer uses the learning rate and the stopping conditions; the others are only used by the Optimizers named beside them.
+ * The defaults are the usual ones for each Optimizer.
+ */
+struct OptimizerOptions {
+	OptimizerType type = OptimizerType::GRADIENT_DESCENT;
+	double learning_rate = LEARNING_RATE;
+	/* Momentum, Nesterov: the fraction of the previous step that is kept. */
+	double momentum = 0.9;
+	/* RMSProp: the fraction of the running average of squared partials that is kept at each step. */
+	double decay = 0.9;
+	/* Adam: the fractions of the running averages of the partials and of their squares that are kept at each step. */
+	double beta1 = 0.9;
+	double beta2 = 0.999;
+	/* Adagrad, RMSProp, Adam: added to the denominator of the step, so weights whose partials have always been 0 do not divide by 0. */
+	double epsilon = 1e-8;
+	/* L-BFGS: the number of past steps whose curvature is remembered (m),
+	 *  and the constants of the strong Wolfe conditions every step must meet (sufficient decrease, and curvature).
+	 */
+	int64_t lbfgs_history = 10;
+	double wolfe_c1 = 1e-4;
+	double wolfe_c2 = 0.9;
+	/* Full-batch Gradient Descent stops after MAX_ITERATIONS steps, or once the length of the gradient is at most GRADIENT_PRECISION.
+	 * Stochastic Gradient Descent stops after its epochs or steps instead (see SGDOptions in GradientDescent.h).
+	 */
+	int64_t max_iterations = MAX_NUM_ITERATIONS;
+	double gradient_precision = GRADIENT_PRECISION;
+};
+
+
+/* Sets TYPE to the Optimizer named NAME: "gd", "momentum", "nesterov", "adagrad", "rmsprop", "adam" or "lbfgs".
+ * Returns false if NAME names no Optimizer.
+ */
+bool parse_optimizer_type(const string& name, OptimizerType *type);
+
+/* Returns 0 if every hyperparameter of OPTIONS is in range, and OTHER_ERROR otherwise:
+ *  the learning rate and epsilon must be positive, momentum, decay and the betas must be in [0, 1),
+ *  the number of iterations must not be negative, and the precision must not be negative.
+ * The L-BFGS history must be at least 1, and the Wolfe constants must satisfy 0 < wolfe_c1 < wolfe_c2 < 1.
+ */
+int check_optimizer_options(const OptimizerOptions& options);
+
+
+/* An Optimizer moves the weights, given the gradient of the loss for them, one step at a time.
+ * It is created for a number of weights, and keeps whatever state it needs for each of them between steps.
+ */
+class Optimizer {
+
+protected:
+
+	/* The number of weights, the hyperparameters, and the number of steps taken so far. */
+	size_t num_weights;
+	OptimizerOptions options;
+	int64_t num_steps;
+
+	/* The arrays of state the Optimizer keeps for every weight (none for plain gradient descent), in a fixed order.
+	 * Every Optimizer adds its arrays when it is constructed, so they can be saved and restored (see restore_state).
+	 */
+	vector<vector<double> *> *state_arrays;
+
+	/* Moves WEIGHTS by one step, given GRADIENT. Both have one value for every weight slot.
+	 * NUM_STEPS has already been incremented, so it is 1 for the first step.
+	 */
+	virtual void update(const double *gradient, double *weights) = 0;
+
+
+public:
+
+	/* Constructor.
+	 * Creates an Optimizer for NUM_WEIGHTS weights, that has not taken any steps.
+	 */
+	Optimizer(size_t num_weights, const OptimizerOptions& options);
+
+	/* Destructor. */
+	virtual ~Optimizer();
+
+	/* Moves WEIGHTS by one step, given GRADIENT, the partials of the loss with respect to them.
+	 * Returns OTHER_ERROR if either does not have one value for every weight slot, and 0 otherwise.
+	 */
+	int step(const vector<double>& gradient, vector<double> *weights);
+
+	/* Forgets every step taken so far, so the Optimizer can train again from new weights. */
+	virtual void reset();
+
+	int64_t get_num_steps() const;
+	const OptimizerOptions& get_options() const;
+
+	/* Returns the number of arrays of state the Optimizer keeps, and the Ith of them, which has one value for every weight. */
+	size_t get_num_state_arrays() const;
+	const vector<double>& get_state_array(size_t i) const;
+
+	/* Puts the Optimizer back in the state it was in after NUM_STEPS steps, when its arrays of state were STATE_ARRAYS,
+	 *  so the next step is the one it would have taken then (see Checkpoint.h).
+	 * Returns OTHER_ERROR if STATE_ARRAYS does not have as many arrays as the Optimizer keeps, each with one value for every weight, and 0 otherwise.
+	 */
+	int restore_state(int64_t num_steps, const vector<vector<double> >& state_arrays);
+
+};
+
+
+/* Returns a new Optimizer of the type OPTIONS names, for NUM_WEIGHTS weights, which the caller must delete.
+ * Returns NULL if the hyperparameters of OPTIONS are out of range (see check_optimizer_options), or if OPTIONS names L-BFGS.
+ */
+Optimizer *create_optimizer(size_t num_weights, const OptimizerOptions& options);
+
+
+/* Plain gradient descent:
+ *
+	weights -= learning_rate * gradient
+ *
+ */
+class GradientDescentOptimizer : public Optimizer {
+
+protected:
+
+	void update(const double *gradient, double *weights);
+
+public:
+
+	GradientDescentOptimizer(size_t num_weights, const OptimizerOptions& options);
+
+};
+
+
+/* Gradient descent with momentum: each step adds the previous step, scaled by the momentum, to the step of the gradient.
+ *
+	velocity = momentum * velocity - learning_rate * gradient
+	weights += velocity
+ *
+ */
+class MomentumOptimizer : public Optimizer {
+
+protected:
+
+	/* The previous step of every weight. */
+	vector<double> *velocity;
+
+	void update(const double *gradient, double *weights);
+
+public:
+
+	MomentumOptimizer(size_t num_weights, const OptimizerOptions& options);
+	~MomentumOptimizer();
+
+	void reset();
+
+};
+
+
+/* Nesterov momentum: the gradient is taken where the momentum is about to move the weights, rather than where they are.
+ * The weights it keeps are those look-ahead weights, so every gradient is taken at the weights it is given,
+ *  like every other Optimizer, and a step is:
+ *
+	previous = velocity
+	velocity = momentum * velocity - learning_rate * gradient
+	weights += (1 + momentum) * velocity - momentum * previous
+ *
+ */
+class NesterovOptimizer : public MomentumOptimizer {
+
+protected:
+
+	void update(const double *gradient, double *weights);
+
+public:
+
+	NesterovOptimizer(size_t num_weights, const OptimizerOptions& options);
+
+};
+
+
+/* Adagrad: each weight's step is divided by the root of the sum of the squares of all its partials so far,
+ *  so weights with large or frequent partials take smaller steps.
+ *
+	sum_of_squares += gradient^2
+	weights -= learning_rate * gradient / (sqrt(sum_of_squares) + epsilon)
+ *
+ */
+class AdagradOptimizer : public Optimizer {
+
+protected:
+
+	vector<double> *sum_of_squares;
+
+	void update(const double *gradient, double *weights);
+
+public:
+
+	AdagradOptimizer(size_t num_weights, const OptimizerOptions& options);
+	~AdagradOptimizer();
+
+	void reset();
+
+};
+
+
+/* RMSProp: like Adagrad, but with a running average of the squared partials, so old partials are forgotten.
+ *
+	mean_square = decay * mean_square + (1 - decay) * gradient^2
+	weights -= learning_rate * gradient / (sqrt(mean_square) + epsilon)
+ *
+ */
+class RMSPropOptimizer : public Optimizer {
+
+protected:
+
+	vector<double> *mean_square;
+
+	void update(const double *gradient, double *weights);
+
+public:
+
+	RMSPropOptimizer(size_t num_weights, const OptimizerOptions& options);
+	~RMSPropOptimizer();
+
+	void reset();
+
+};
+
+
+/* Adam: running averages of both the partials and their squares, corrected for starting at 0.
+ *
+	mean = beta1 * mean + (1 - beta1) * gradient
+	mean_square = beta2 * mean_square + (1 - beta2) * gradient^2
+	weights -= learning_rate * (mean / (1 - beta1^t)) / (sqrt(mean_square / (1 - beta2^t)) + epsilon)
+ *
+ * where t is the number of steps taken.
+ */
+class AdamOptimizer : public Optimizer {
+
+protected:
+
+	vector<double> *mean;
+	vector<double> *mean_square;
+
+	void update(const double *gradient, double *weights);
+
+public:
+
+	AdamOptimizer(size_t num_weights, const OptimizerOptions& options);
+	~AdamOptimizer();
+
+	void reset();
+
+};
+
+
+
+#endif
@@ -0,0 +1,209 @@
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "OutputSink.h"
+
+using namespace std;
+
+
+/* ---------------- Constructor/Destructor --------------- */
+
+OutputSink::OutputSink(size_t buffer_size, bool background_writer) {
+	fd = -1;
+	owns_fd = false;
+	this->buffer_size = buffer_size == 0 ? 1 : buffer_size;
+	buffer = new vector<char>(this->buffer_size);
+	pending = new vector<char>(background_writer ? this->buffer_size : 0);
+	pending_length = 0;
+	this->background_writer = background_writer;
+	writer = NULL;
+	lock = new mutex();
+	wakeup = new condition_variable();
+	stopping = false;
+	failed = false;
+	num_writes = 0;
+	num_bytes_written = 0;
+	setp(buffer->data(), buffer->data() + this->buffer_size);
+}
+
+
+OutputSink::~OutputSink() {
+	close();
+	delete buffer;
+	delete pending;
+	delete lock;
+	delete wakeup;
+}
+
+
+
+/* ---------------- Opening and Closing -------------- */
+
+int OutputSink::open(const string& filename) {
+	close();
+	fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) return INVALID_FILE_NAME;
+	owns_fd = true;
+	start();
+	return 0;
+}
+
+
+int OutputSink::attach(int fd) {
+	close();
+	if (fd < 0) return INVALID_FILE_NAME;
+	this->fd = fd;
+	owns_fd = false;
+	start();
+	return 0;
+}
+
+
+void OutputSink::start() {
+	failed = false;
+	stopping = false;
+	num_writes = 0;
+	num_bytes_written = 0;
+	setp(buffer->data(), buffer->data() + buffer_size);
+	if (background_writer) writer = new thread(&OutputSink::run_writer, this);
+}
+
+
+int OutputSink::close() {
+	if (fd < 0) return 0;
+
+	sync();
+
+	if (writer != NULL) {
+		{
+			lock_guard<mutex> guard(*lock);
+			stopping = true;
+		}
+		wakeup->notify_all();
+		writer->join();
+		delete writer;
+		writer = NULL;
+	}
+
+	if (owns_fd && ::close(fd) != 0) failed = true;
+	fd = -1;
+	owns_fd = false;
+	return failed ? OTHER_ERROR : 0;
+}
+
+
+bool OutputSink::is_open() const {
+	return fd >= 0;
+}
+
+
+
+/* ---------------- Writing -------------- */
+
+void OutputSink::write_buffer(const char *data, size_t length) {
+	if (fd < 0) {
+		failed = true;
+		return;
+	}
+
+	// write may write less than it is given, or be interrupted before writing anything
+	while (length > 0) {
+		ssize_t written = ::write(fd, data, length);
+		num_writes++;
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			failed = true;
+			return;
+		}
+		data += written;
+		length -= written;
+		num_bytes_written += written;
+	}
+}
+
+
+void OutputSink::hand_off() {
+	size_t length = pptr() - pbase();
+	if (length == 0) return;
+
+	if (writer == NULL) {
+		write_buffer(pbase(), length);
+	} else {
+		// wait for the writer to finish the previous buffer, then swap the two buffers
+		unique_lock<mutex> guard(*lock);
+		while (pending_length != 0) wakeup->wait(guard);
+		std::swap(buffer, pending);
+		pending_length = length;
+		guard.unlock();
+		wakeup->notify_all();
+	}
+
+	setp(buffer->data(), buffer->data() + buffer_size);
+}
+
+
+void OutputSink::wait_for_writer() {
+	if (writer == NULL) return;
+	unique_lock<mutex> guard(*lock);
+	while (pending_length != 0) wakeup->wait(guard);
+}
+
+
+void OutputSink::run_writer() {
+	unique_lock<mutex> guard(*lock);
+	while (true) {
+		while (pending_length == 0 && !stopping) wakeup->wait(guard);
+		if (pending_length == 0) return;
+
+		// the emitters fill the other buffer while this one is written
+		size_t length = pending_length;
+		guard.unlock();
+		write_buffer(pending->data(), length);
+		guard.lock();
+
+		pending_length = 0;
+		wakeup->notify_all();
+	}
+}
+
+
+OutputSink::int_type OutputSink::overflow(int_type c) {
+	hand_off();
+	if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+	*pptr() = traits_type::to_char_type(c);
+	pbump(1);
+	return c;
+}
+
+
+streamsize OutputSink::xsputn(const char *s, streamsize n) {
+	streamsize copied = 0;
+	while (copied < n) {
+		if (pptr() == epptr()) hand_off();
+		size_t space = epptr() - pptr();
+		size_t length = (size_t) (n - copied) < space ? n - copied : space;
+		memcpy(pptr(), s + copied, length);
+		pbump(length);
+		copied += length;
+	}
+	return n;
+}
+
+
+int OutputSink::sync() {
+	hand_off();
+	wait_for_writer();
+	return failed ? -1 : 0;
+}
+
+
+uint64_t OutputSink::get_num_writes() const {
+	return num_writes;
+}
+
+
+uint64_t OutputSink::get_num_bytes_written() const {
+	return num_bytes_written;
+}
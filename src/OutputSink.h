@@ -0,0 +1,136 @@
+#ifndef OUTPUTSINK_H
+#define OUTPUTSINK_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+#include "utilities.h"
+
+using namespace std;
+
+
+/* The size of an OutputSink's buffer, unless another is given. */
+#define DEFAULT_OUTPUT_BUFFER_SIZE (1 << 20)
+
+
+/* An OutputSink is where the Preprocessor and Compiler write the programs they generate, when they write them to a file.
+ * It is a stream buffer, so the emitters keep writing to an ostream, built on the sink:
+ *
+ 	OutputSink sink;
+ 	sink.open("gcp.tf");
+ 	ostream gcp(&sink);
+ 	gcp << "define " << name << " = add " << operand1 << " " << operand2 << '\n';
+ 	sink.close();
+ *
+ * Every value written to the ostream is formatted straight into the sink's buffer, without building a string first.
+ * Nothing reaches the file until the buffer is full, or the sink is flushed or closed:
+ *  a whole buffer is written with one write system call, rather than one (or more) per line.
+ * So emitters end their lines with '\n', and not endl, which would flush the buffer after every line.
+ *
+ * With a background writer, the sink has two buffers. A full buffer is handed to a writer thread,
+ *  and the emitters keep filling the other one while the first is written, so writing to the file overlaps generating the program.
+ * The emitters only wait if the writer has not yet finished with the previous buffer.
+ *
+ * The sink counts the write system calls it makes, and the bytes they write, so the cost of writing a program can be measured.
+ */
+class OutputSink : public streambuf {
+
+	/* The file written to, and whether the sink opened it (and must close it). */
+	int fd;
+	bool owns_fd;
+
+	/* The buffer being filled, and its size. */
+	size_t buffer_size;
+	vector<char> *buffer;
+
+	/* With a background writer: the buffer handed to the writer thread, and how many of its bytes are still to be written (0 when the writer is idle). */
+	vector<char> *pending;
+	size_t pending_length;
+	bool background_writer;
+	thread *writer;
+	mutex *lock;
+	condition_variable *wakeup;
+	bool stopping;
+
+	/* True if a write failed since the file was opened. */
+	bool failed;
+
+	/* The write system calls made, and the bytes they wrote, since the file was opened. */
+	uint64_t num_writes;
+	uint64_t num_bytes_written;
+
+	/* Writes the LENGTH bytes at DATA to the file, with as many write calls as it takes. */
+	void write_buffer(const char *data, size_t length);
+
+	/* Writes the filled part of the buffer (or hands it to the writer thread), and starts filling an empty buffer. */
+	void hand_off();
+
+	/* Waits until the writer thread has written every buffer handed to it. */
+	void wait_for_writer();
+
+	/* The body of the writer thread: writes each buffer it is handed, until the sink is closed. */
+	void run_writer();
+
+	/* Resets the counts, and starts the writer thread if there is one, once a file is open. */
+	void start();
+
+
+protected:
+
+	/* Called when the buffer is full: writes it, and then buffers C. */
+	int_type overflow(int_type c);
+
+	/* Copies the N bytes at S into the buffer, writing the buffer each time it fills. */
+	streamsize xsputn(const char *s, streamsize n);
+
+	/* Writes everything buffered so far, and waits until it is written. Returns -1 if a write failed. */
+	int sync();
+
+
+public:
+
+	/* Constructor.
+	 * Creates a sink with a buffer of BUFFER_SIZE bytes (at least one), and a background writer thread if BACKGROUND_WRITER is true.
+	 * Nothing can be written until a file is opened or attached.
+	 */
+	OutputSink(size_t buffer_size = DEFAULT_OUTPUT_BUFFER_SIZE, bool background_writer = false);
+
+	/* Destructor.
+	 * Closes the sink, writing whatever is still buffered.
+	 */
+	~OutputSink();
+
+	/* Creates (or truncates) the file with the given FILENAME, and writes to it.
+	 * Returns INVALID_FILE_NAME if the file cannot be opened for writing, and 0 otherwise.
+	 */
+	int open(const string& filename);
+
+	/* Writes to the open file descriptor FD (such as STDOUT_FILENO), which the sink does not close.
+	 * Returns INVALID_FILE_NAME if FD is negative, and 0 otherwise.
+	 */
+	int attach(int fd);
+
+	/* Writes whatever is still buffered, stops the writer thread, and closes the file if the sink opened it.
+	 * Returns OTHER_ERROR if any write to the file failed, and 0 otherwise.
+	 */
+	int close();
+
+	/* Returns true if the sink has a file to write to. */
+	bool is_open() const;
+
+	/* Returns the number of write system calls, and the number of bytes written, since the file was opened.
+	 * With a background writer, these are only exact once the sink has been flushed or closed.
+	 */
+	uint64_t get_num_writes() const;
+	uint64_t get_num_bytes_written() const;
+
+};
+
+
+
+#endif
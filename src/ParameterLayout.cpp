@@ -0,0 +1,144 @@
+#include <cfloat>
+
+#include "ParameterLayout.h"
+#include "GradientDescent.h"
+
+using namespace std;
+
+
+/* ---------------- Constructor/Destructor --------------- */
+
+ParameterLayout::ParameterLayout() {
+	weight_names = new vector<string>();
+	partial_names = new vector<string>();
+	weight_slots = new vector<uint32_t>();
+	gradient_indices = new vector<uint32_t>();
+	gradient_slots = new vector<uint32_t>();
+	other_output_slots = new vector<uint32_t>();
+}
+
+
+ParameterLayout::~ParameterLayout() {
+	delete weight_names;
+	delete partial_names;
+	delete weight_slots;
+	delete gradient_indices;
+	delete gradient_slots;
+	delete other_output_slots;
+}
+
+
+
+/* ---------------- Building --------------- */
+
+int ParameterLayout::build(const Program& gcp, const vector<string>& weight_names, const vector<string>& partial_names) {
+
+	*this->weight_names = weight_names;
+	this->partial_names->assign(weight_names.size(), "");
+	weight_slots->clear();
+	gradient_indices->clear();
+	gradient_slots->clear();
+	other_output_slots->clear();
+
+	unordered_map<string, uint32_t> weight_indices;
+	for (size_t i = 0; i < weight_names.size(); i++) {
+		if (!weight_indices.insert(make_pair(weight_names[i], (uint32_t) i)).second) return OTHER_ERROR;
+
+		// only inputs can be bound, as bind_values binds them
+		uint32_t slot = gcp.get_slot(Symbol::find(weight_names[i]));
+		if (slot != INVALID_SLOT) {
+			VariableType type = gcp.get_slot_type(slot);
+			if (type != VariableType::INPUT && type != VariableType::WEIGHT && type != VariableType::EXP_OUTPUT) slot = INVALID_SLOT;
+		}
+		weight_slots->push_back(slot);
+	}
+
+	unordered_map<string, uint32_t> partial_indices;
+	for (size_t i = 0; i < partial_names.size(); i++) {
+		unordered_map<string, uint32_t>::const_iterator weight = weight_indices.find(partial_name_to_weight_name(partial_names[i]));
+		if (weight == weight_indices.end() || (*this->partial_names)[weight->second] != "") return OTHER_ERROR;
+		(*this->partial_names)[weight->second] = partial_names[i];
+		partial_indices[partial_names[i]] = weight->second;
+	}
+
+	const vector<uint32_t>& output_slots = gcp.get_output_slots();
+	for (size_t i = 0; i < output_slots.size(); i++) {
+		unordered_map<string, uint32_t>::const_iterator partial = partial_indices.find(gcp.get_slot_name(output_slots[i]).str());
+		if (partial == partial_indices.end()) {
+			other_output_slots->push_back(output_slots[i]);
+		} else {
+			gradient_indices->push_back(partial->second);
+			gradient_slots->push_back(output_slots[i]);
+		}
+	}
+
+	return 0;
+}
+
+
+
+/* ---------------- Moving Values --------------- */
+
+int ParameterLayout::bind_weights(const vector<double>& weights, vector<double> *values) const {
+	for (size_t i = 0; i < weight_slots->size(); i++) {
+		uint32_t slot = (*weight_slots)[i];
+		if (slot == INVALID_SLOT) continue;
+		if (weights[i] == DBL_MIN || weights[i] == DBL_MAX) return OTHER_ERROR;
+		(*values)[slot] = weights[i];
+	}
+	return 0;
+}
+
+
+void ParameterLayout::add_partials(const vector<double>& values, double *gradient) const {
+	const uint32_t *indices = gradient_indices->data(), *slots = gradient_slots->data();
+	for (size_t i = 0; i < gradient_slots->size(); i++) {
+		gradient[indices[i]] += values[slots[i]];
+	}
+}
+
+
+bool ParameterLayout::has_other_outputs(const vector<double>& values) const {
+	for (size_t i = 0; i < other_output_slots->size(); i++) {
+		if (values[(*other_output_slots)[i]] != 0) return true;
+	}
+	return false;
+}
+
+
+int ParameterLayout::gather_weights(const unordered_map<string, double>& named_weights, vector<double> *weights) const {
+	weights->resize(weight_names->size());
+	for (size_t i = 0; i < weight_names->size(); i++) {
+		unordered_map<string, double>::const_iterator weight = named_weights.find((*weight_names)[i]);
+		if (weight == named_weights.end()) return OTHER_ERROR;
+		(*weights)[i] = weight->second;
+	}
+	return 0;
+}
+
+
+void ParameterLayout::scatter_weights(const vector<double>& weights, unordered_map<string, double> *named_weights) const {
+	for (size_t i = 0; i < weight_names->size(); i++) {
+		(*named_weights)[(*weight_names)[i]] = weights[i];
+	}
+}
+
+
+void ParameterLayout::scatter_gradient(const vector<double>& gradient, unordered_map<string, double> *named_gradient) const {
+	for (size_t i = 0; i < partial_names->size(); i++) {
+		if (gradient[i] != 0 && (*partial_names)[i] != "") (*named_gradient)[(*partial_names)[i]] = gradient[i];
+	}
+}
+
+
+
+/* ---------------- Accessors --------------- */
+
+size_t ParameterLayout::size() const {
+	return weight_names->size();
+}
+
+
+const vector<string>& ParameterLayout::get_weight_names() const {
+	return *weight_names;
+}
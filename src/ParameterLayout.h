@@ -0,0 +1,91 @@
+#ifndef PARAMETERLAYOUT_H
+#define PARAMETERLAYOUT_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+#include "Program.h"
+#include "utilities.h"
+
+using namespace std;
+
+
+/* A ParameterLayout gives every weight of a GCP, and the partial of the loss with respect to it, one dense index:
+ *  the position of the weight in the list of weight names.
+ * It is built once, before training, and from then on the weights and the gradient are arrays of doubles indexed by weight,
+ *  which are moved straight between the values of a run of the GCP (see Program.h) and the Optimizers by slot:
+ *
+ 	layout.bind_weights(weights, &values)			values[weight slot of w] = weights[w]
+ 	run the GCP on values
+ 	layout.add_partials(values, gradient)			gradient[w] += values[partial slot of w]
+ *
+ * Names are only used at the boundary, to turn the arrays into maps of {name, value} pairs and back.
+ */
+class ParameterLayout {
+
+private:
+
+	/* The name of every weight, in order, and the name of its partial ("" if it has none). */
+	vector<string> *weight_names;
+	vector<string> *partial_names;
+
+	/* The slot of every weight in the GCP, or INVALID_SLOT if the GCP has no input of that name. */
+	vector<uint32_t> *weight_slots;
+
+	/* For every output of the GCP that is a partial: the index of its weight, and its slot. */
+	vector<uint32_t> *gradient_indices;
+	vector<uint32_t> *gradient_slots;
+
+	/* The slots of the outputs of the GCP that are not partials. */
+	vector<uint32_t> *other_output_slots;
+
+
+public:
+
+	/* Constructor. Creates a layout with no weights. */
+	ParameterLayout();
+
+	/* Destructor. */
+	~ParameterLayout();
+
+	/* Lays out the weights WEIGHT_NAMES, whose partials are PARTIAL_NAMES (d/<loss>/d/<weight>, in any order), for the loaded GCP.
+	 * A weight may have no partial, and then its partial is always 0. A partial that is not an output of the GCP is always 0 too.
+	 * Returns OTHER_ERROR if a weight is named twice, if a partial is not the partial of a weight in WEIGHT_NAMES,
+	 *  or if two partials are of the same weight. Returns 0 otherwise.
+	 */
+	int build(const Program& gcp, const vector<string>& weight_names, const vector<string>& partial_names);
+
+	/* Returns the number of weights. */
+	size_t size() const;
+
+	const vector<string>& get_weight_names() const;
+
+	/* Writes WEIGHTS, one value for every weight, into their slots of VALUES, which must have been set up by init_values.
+	 * Returns OTHER_ERROR if a weight's value is DBL_MIN or DBL_MAX, as bind_values does, and 0 otherwise.
+	 */
+	int bind_weights(const vector<double>& weights, vector<double> *values) const;
+
+	/* Adds the value of every partial in VALUES, the values of a run of the GCP, into GRADIENT, which has one value for every weight. */
+	void add_partials(const vector<double>& values, double *gradient) const;
+
+	/* Returns true if an output of the GCP that is not a partial is not 0 in VALUES. */
+	bool has_other_outputs(const vector<double>& values) const;
+
+	/* Writes the value every weight has in NAMED_WEIGHTS into WEIGHTS, by index.
+	 * Returns OTHER_ERROR if a weight has no value in NAMED_WEIGHTS, and 0 otherwise.
+	 */
+	int gather_weights(const unordered_map<string, double>& named_weights, vector<double> *weights) const;
+
+	/* Writes every weight in WEIGHTS into NAMED_WEIGHTS, by name. */
+	void scatter_weights(const vector<double>& weights, unordered_map<string, double> *named_weights) const;
+
+	/* Writes every partial in GRADIENT that is not 0 into NAMED_GRADIENT, by the name of the partial. */
+	void scatter_gradient(const vector<double>& gradient, unordered_map<string, double> *named_gradient) const;
+
+};
+
+
+
+#endif
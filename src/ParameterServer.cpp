@@ -0,0 +1,415 @@
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ParameterServer.h"
+
+using namespace std;
+
+
+/* The types of the messages (see ParameterServer.h). */
+enum MessageType : uint32_t { PULL = 1, PUSH_DENSE, PUSH_SPARSE, WEIGHTS, STOP, DONE, ERROR };
+
+
+/* The header of every message. */
+struct MessageHeader {
+	uint32_t type;
+	uint32_t count;
+	int64_t value;
+};
+
+
+/* Sends the N BYTES to SOCKET, however many writes that takes. A closed socket is an error, not a signal.
+ * Returns 0 on success, and OTHER_ERROR otherwise.
+ */
+static int send_all(int socket, const void *bytes, size_t n) {
+	const char *next = (const char *) bytes;
+	while (n > 0) {
+		ssize_t sent = send(socket, next, n, MSG_NOSIGNAL);
+		if (sent < 0 && errno == EINTR) continue;
+		if (sent <= 0) return OTHER_ERROR;
+		next += sent;
+		n -= sent;
+	}
+	return 0;
+}
+
+
+/* Receives N BYTES from SOCKET, however many reads that takes.
+ * Returns 0 on success, and OTHER_ERROR if the socket was closed first, or failed.
+ */
+static int receive_all(int socket, void *bytes, size_t n) {
+	char *next = (char *) bytes;
+	while (n > 0) {
+		ssize_t received = recv(socket, next, n, 0);
+		if (received < 0 && errno == EINTR) continue;
+		if (received <= 0) return OTHER_ERROR;
+		next += received;
+		n -= received;
+	}
+	return 0;
+}
+
+
+/* Sends a message with no payload. */
+static int send_header(int socket, uint32_t type, int64_t value) {
+	MessageHeader header = {type, 0, value};
+	return send_all(socket, &header, sizeof(header));
+}
+
+
+
+/* ---------------- Client --------------- */
+
+ParameterClient::ParameterClient(int socket, size_t rank, size_t size, size_t num_weights) {
+	this->socket = socket;
+	this->rank = rank;
+	this->size = size;
+	this->num_weights = num_weights;
+	stopped = false;
+	buffer = new vector<char>();
+}
+
+
+ParameterClient::~ParameterClient() {
+	close(socket);
+	delete buffer;
+}
+
+
+int ParameterClient::receive_weights(vector<double> *weights, int64_t *version) {
+	MessageHeader header;
+	if (receive_all(socket, &header, sizeof(header)) != 0) return OTHER_ERROR;
+	if (header.type == STOP) {
+		stopped = true;
+		return 0;
+	}
+	if (header.type != WEIGHTS || header.count != num_weights) return OTHER_ERROR;
+
+	weights->resize(num_weights);
+	*version = header.value;
+	return receive_all(socket, weights->data(), num_weights * sizeof(double));
+}
+
+
+int ParameterClient::pull(vector<double> *weights, int64_t *version) {
+	if (send_header(socket, PULL, 0) != 0) return OTHER_ERROR;
+	return receive_weights(weights, version);
+}
+
+
+int ParameterClient::push(const vector<double>& gradient, int64_t version, vector<double> *weights, int64_t *new_version) {
+	if (gradient.size() != num_weights) return OTHER_ERROR;
+
+	size_t num_nonzero = 0;
+	for (size_t i = 0; i < num_weights; i++) {
+		if (gradient[i] != 0) num_nonzero++;
+	}
+
+	// the message is built whole, so it goes out in one write
+	bool sparse = num_nonzero * (sizeof(uint32_t) + sizeof(double)) < num_weights * sizeof(double);
+	MessageHeader header = {sparse ? PUSH_SPARSE : PUSH_DENSE, (uint32_t) (sparse ? num_nonzero : num_weights), version};
+	buffer->resize(sizeof(header) + (sparse ? num_nonzero * sizeof(uint32_t) : 0) + header.count * sizeof(double));
+	memcpy(buffer->data(), &header, sizeof(header));
+
+	if (sparse) {
+		uint32_t *indices = (uint32_t *) (buffer->data() + sizeof(header));
+		double *values = (double *) (indices + num_nonzero);
+		for (size_t i = 0, j = 0; i < num_weights; i++) {
+			if (gradient[i] == 0) continue;
+			indices[j] = (uint32_t) i;
+			memcpy(values + j, &gradient[i], sizeof(double));
+			j++;
+		}
+	} else {
+		memcpy(buffer->data() + sizeof(header), gradient.data(), num_weights * sizeof(double));
+	}
+
+	if (send_all(socket, buffer->data(), buffer->size()) != 0) return OTHER_ERROR;
+	return receive_weights(weights, new_version);
+}
+
+
+int ParameterClient::finish(int error) {
+	return send_header(socket, error == 0 ? DONE : ERROR, error);
+}
+
+
+size_t ParameterClient::get_rank() const {
+	return rank;
+}
+
+size_t ParameterClient::get_size() const {
+	return size;
+}
+
+bool ParameterClient::is_stopped() const {
+	return stopped;
+}
+
+
+ParameterWorker::~ParameterWorker() {
+}
+
+
+
+/* ---------------- Server --------------- */
+
+/* What the server knows of one worker: how many gradients it has pushed, whether it is waiting for the weights, and whether it has finished. */
+struct WorkerState {
+	int64_t clock;
+	bool waiting;
+	bool done;
+};
+
+
+/* The state of the server while it runs. */
+struct ServerState {
+	vector<int> sockets;
+	vector<WorkerState> workers;
+	vector<double> *weights;
+	int64_t version;
+	int64_t max_updates;
+	int64_t staleness_bound;
+	Optimizer *optimizer;
+	double learning_rate;
+	bool plain_gradient_descent;
+	ParameterServerStats stats;
+
+	/* The gradient of a push, and the indices of its partials, if it is sparse. */
+	vector<double> gradient;
+	vector<uint32_t> indices;
+};
+
+
+/* Returns true once the server takes no more updates. */
+static bool is_stopped(const ServerState& server) {
+	return server.max_updates != 0 && server.version >= server.max_updates;
+}
+
+
+/* Answers worker W, which is waiting for the weights, if the staleness bound lets it go on.
+ * Returns 0 if it was answered or held back, and OTHER_ERROR if it could not be reached.
+ */
+static int answer_pull(ServerState *server, size_t w) {
+	WorkerState& worker = server->workers[w];
+
+	if (is_stopped(*server)) {
+		worker.waiting = false;
+		return send_header(server->sockets[w], STOP, 0);
+	}
+
+	if (server->staleness_bound >= 0) {
+		int64_t min_clock = worker.clock;
+		for (size_t v = 0; v < server->workers.size(); v++) {
+			if (!server->workers[v].done) min_clock = min(min_clock, server->workers[v].clock);
+		}
+		if (worker.clock - min_clock > server->staleness_bound) return 0;
+	}
+
+	worker.waiting = false;
+	MessageHeader header = {WEIGHTS, (uint32_t) server->weights->size(), server->version};
+	if (send_all(server->sockets[w], &header, sizeof(header)) != 0) return OTHER_ERROR;
+	return send_all(server->sockets[w], server->weights->data(), server->weights->size() * sizeof(double));
+}
+
+
+/* Reads the payload of a push described by HEADER from worker W, and applies it to the weights, unless the server has stopped.
+ * Returns OTHER_ERROR if the payload does not fit the weights or cannot be read, the error of the Optimizer if it fails, and 0 otherwise.
+ */
+static int apply_push(ServerState *server, size_t w, const MessageHeader& header) {
+	size_t num_weights = server->weights->size();
+	bool sparse = header.type == PUSH_SPARSE;
+	if (sparse ? header.count > num_weights : header.count != num_weights) return OTHER_ERROR;
+	if (header.value < 0 || header.value > server->version) return OTHER_ERROR;
+
+	int socket = server->sockets[w];
+	server->stats.num_bytes_received += header.count * (sizeof(double) + (sparse ? sizeof(uint32_t) : 0));
+	server->workers[w].clock++;
+
+	if (sparse) {
+		server->indices.resize(header.count);
+		if (receive_all(socket, server->indices.data(), header.count * sizeof(uint32_t)) != 0) return OTHER_ERROR;
+		for (size_t i = 0; i < header.count; i++) {
+			if (server->indices[i] >= num_weights || (i > 0 && server->indices[i] <= server->indices[i - 1])) return OTHER_ERROR;
+		}
+	}
+	// the gradient of a sparse push is read into the front of the buffer, and spread out below, if the Optimizer needs it dense
+	server->gradient.resize(num_weights);
+	if (receive_all(socket, server->gradient.data(), header.count * sizeof(double)) != 0) return OTHER_ERROR;
+	if (is_stopped(*server)) return 0;
+
+	int64_t staleness = server->version - header.value;
+	server->stats.num_updates++;
+	server->stats.total_staleness += staleness;
+	server->stats.max_staleness = max(server->stats.max_staleness, staleness);
+	server->version++;
+
+	if (!sparse) {
+		server->stats.num_dense_pushes++;
+		return server->optimizer->step(server->gradient, server->weights);
+	}
+
+	// plain gradient descent only moves the weights whose partials were pushed; the other Optimizers keep state for every weight
+	server->stats.num_sparse_pushes++;
+	double *weights = server->weights->data();
+	if (server->plain_gradient_descent) {
+		for (size_t i = 0; i < header.count; i++) weights[server->indices[i]] -= server->learning_rate * server->gradient[i];
+		return 0;
+	}
+	// the indices increase, so every partial moves to the right, and moving them from the last one on never overwrites one not yet moved
+	fill(server->gradient.begin() + header.count, server->gradient.end(), 0);
+	for (size_t i = header.count; i > 0; i--) {
+		double partial = server->gradient[i - 1];
+		server->gradient[i - 1] = 0;
+		server->gradient[server->indices[i - 1]] = partial;
+	}
+	return server->optimizer->step(server->gradient, server->weights);
+}
+
+
+/* Reads one message from worker W, and acts on it. Returns the error it carries, or the error of acting on it, and 0 otherwise. */
+static int serve_message(ServerState *server, size_t w) {
+	MessageHeader header;
+	if (receive_all(server->sockets[w], &header, sizeof(header)) != 0) return OTHER_ERROR;
+	server->stats.num_bytes_received += sizeof(header);
+
+	WorkerState& worker = server->workers[w];
+	switch (header.type) {
+		case PUSH_DENSE:
+		case PUSH_SPARSE: {
+			int success = apply_push(server, w, header);
+			if (success != 0) return success;
+			worker.waiting = true;
+			return 0;
+		}
+		case PULL:
+			worker.waiting = true;
+			return 0;
+		case DONE:
+			worker.done = true;
+			return 0;
+		case ERROR:
+			return header.value == 0 ? OTHER_ERROR : (int) header.value;
+		default:
+			return OTHER_ERROR;
+	}
+}
+
+
+/* Serves the workers until they have all finished. Returns the error of the first one that failed, and 0 if none did. */
+static int serve(ServerState *server) {
+	size_t num_workers = server->sockets.size();
+	vector<pollfd> polls;
+	vector<size_t> polled;
+
+	while (true) {
+		polls.clear();
+		polled.clear();
+		for (size_t w = 0; w < num_workers; w++) {
+			if (server->workers[w].done) continue;
+			pollfd p = {server->sockets[w], POLLIN, 0};
+			polls.push_back(p);
+			polled.push_back(w);
+		}
+		if (polls.empty()) return 0;
+
+		if (poll(polls.data(), polls.size(), -1) < 0) {
+			if (errno == EINTR) continue;
+			return OTHER_ERROR;
+		}
+
+		for (size_t p = 0; p < polls.size(); p++) {
+			if (polls[p].revents == 0) continue;
+			size_t w = polled[p];
+			int success = serve_message(server, w);
+			if (success != 0) return success;
+
+			// a pull held back now counts as delayed, and is answered below, once the slowest worker has caught up
+			if (server->workers[w].waiting) {
+				success = answer_pull(server, w);
+				if (success != 0) return success;
+				if (server->workers[w].waiting) server->stats.num_delayed_pulls++;
+			}
+		}
+
+		// the clocks have moved, or workers have finished, so held back pulls may go on
+		for (size_t w = 0; w < num_workers; w++) {
+			if (!server->workers[w].waiting || server->workers[w].done) continue;
+			int success = answer_pull(server, w);
+			if (success != 0) return success;
+		}
+	}
+}
+
+
+int run_parameter_server(size_t num_workers, const vector<double>& initial_weights, const OptimizerOptions& options, int64_t max_updates,
+	int64_t staleness_bound, ParameterWorker *worker, vector<double> *weights, ParameterServerStats *stats) {
+
+	if (stats != NULL) *stats = ParameterServerStats();
+	if (num_workers == 0) return OTHER_ERROR;
+	Optimizer *optimizer = create_optimizer(initial_weights.size(), options);
+	if (optimizer == NULL) return OTHER_ERROR;
+
+	*weights = initial_weights;
+	ServerState server;
+	server.weights = weights;
+	server.version = 0;
+	server.max_updates = max_updates;
+	server.staleness_bound = staleness_bound;
+	server.optimizer = optimizer;
+	server.learning_rate = options.learning_rate;
+	server.plain_gradient_descent = options.type == OptimizerType::GRADIENT_DESCENT;
+
+	int error = 0;
+	vector<pid_t> pids;
+	for (size_t r = 0; r < num_workers; r++) {
+		int ends[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, ends) != 0) {
+			error = OTHER_ERROR;
+			break;
+		}
+
+		pid_t pid = fork();
+		if (pid == 0) {
+			// the worker only keeps its own end: the server's ends must close with the server, so that a worker never waits on a dead one
+			close(ends[0]);
+			for (size_t s = 0; s < server.sockets.size(); s++) close(server.sockets[s]);
+			ParameterClient client(ends[1], r, num_workers, initial_weights.size());
+			int success = worker->run(&client);
+			client.finish(success);
+			_exit(success == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+
+		close(ends[1]);
+		if (pid < 0) {
+			close(ends[0]);
+			error = OTHER_ERROR;
+			break;
+		}
+		pids.push_back(pid);
+		server.sockets.push_back(ends[0]);
+		WorkerState state = {0, false, false};
+		server.workers.push_back(state);
+	}
+
+	if (error == 0) error = serve(&server);
+
+	// closing the sockets stops every worker still running, if the server failed
+	for (size_t w = 0; w < server.sockets.size(); w++) close(server.sockets[w]);
+	for (size_t w = 0; w < pids.size(); w++) {
+		int status = 0;
+		while (waitpid(pids[w], &status, 0) < 0 && errno == EINTR) {
+		}
+		if (error == 0 && (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)) error = OTHER_ERROR;
+	}
+
+	delete optimizer;
+	if (stats != NULL) *stats = server.stats;
+	return error;
+}
@@ -0,0 +1,140 @@
+#ifndef PARAMETER_SERVER_H
+#define PARAMETER_SERVER_H
+
+#include <vector>
+#include <cstdint>
+
+#include "Optimizer.h"
+#include "utilities.h"
+
+using namespace std;
+
+
+/* This file defines the parameter server of asynchronous multi-process training.
+ * One process, the server, owns the weights, and is the only one that moves them, with an Optimizer.
+ * Every other process, a worker, pulls the weights from the server, computes a gradient at them (over its own shard of the training data),
+ *  and pushes the gradient back, for the server to apply, while the other workers do the same.
+ *
+ * The server and every worker are connected by a Unix domain socket, over which they exchange messages.
+ * Every message is a header, then a payload of COUNT values:
+ *
+ 	type		uint32		PULL, PUSH_DENSE, PUSH_SPARSE, WEIGHTS, STOP, DONE or ERROR
+ 	count		uint32		the number of values of the payload
+ 	value		int64		the version of the weights, or an error code
+ *
+ 	PULL			worker to server		no payload: asks for the weights
+ 	PUSH_DENSE		worker to server		COUNT doubles: the partial of every weight, at weights of version VALUE
+ 	PUSH_SPARSE		worker to server		COUNT uint32 weight indices, in increasing order, then COUNT doubles: the partials that are not 0
+ 	WEIGHTS			server to worker		COUNT doubles: the weights, after VALUE updates
+ 	STOP			server to worker		no payload: the server takes no more updates
+ 	DONE			worker to server		no payload: the worker has finished
+ 	ERROR			worker to server		no payload: the worker has failed, with error VALUE
+ *
+ * Every push also asks for the weights, and is answered with them, so a step is one round trip: the push and the next pull are batched.
+ * A push is sparse whenever that takes fewer bytes than a dense one, which is the case for most steps on sparse data.
+ * The values are in the byte order of the machine, since the server and the workers always run on the same one.
+ */
+
+
+/* What happened on the server during parameter server training (see run_parameter_server).
+ * The staleness of an update is the number of updates the server applied between the version the gradient was computed at and itself.
+ * A delayed pull is one the server held back to bound staleness (see run_parameter_server).
+ */
+struct ParameterServerStats {
+	int64_t num_updates = 0;
+	int64_t total_staleness = 0;
+	int64_t max_staleness = 0;
+	int64_t num_sparse_pushes = 0;
+	int64_t num_dense_pushes = 0;
+	int64_t num_delayed_pulls = 0;
+	int64_t num_bytes_received = 0;
+};
+
+
+/* A ParameterClient connects one worker to the server. */
+class ParameterClient {
+
+private:
+
+	/* The socket to the server. */
+	int socket;
+
+	size_t rank;
+	size_t size;
+	size_t num_weights;
+
+	/* Set once the server has answered with STOP. */
+	bool stopped;
+
+	/* The bytes of the message being sent. */
+	vector<char> *buffer;
+
+	/* Reads the answer of the server to a pull or a push into WEIGHTS and VERSION, or notes that it stopped. */
+	int receive_weights(vector<double> *weights, int64_t *version);
+
+
+public:
+
+	/* Constructor. Creates the client of worker RANK, out of SIZE workers, connected to the server by SOCKET, for NUM_WEIGHTS weights. */
+	ParameterClient(int socket, size_t rank, size_t size, size_t num_weights);
+
+	/* Destructor. Closes the socket. */
+	~ParameterClient();
+
+	/* Returns the number of this worker, from 0 to the number of workers - 1. */
+	size_t get_rank() const;
+
+	/* Returns the number of workers. */
+	size_t get_size() const;
+
+	/* Returns true once the server has stopped taking updates: the worker should then finish. */
+	bool is_stopped() const;
+
+	/* Writes the current weights, and their version, into WEIGHTS and VERSION. The server may hold the answer back (see run_parameter_server).
+	 * Returns OTHER_ERROR if the server cannot be reached, and 0 otherwise (even if it stopped, in which case WEIGHTS are not written).
+	 */
+	int pull(vector<double> *weights, int64_t *version);
+
+	/* Pushes GRADIENT, computed at the weights of version VERSION, and then pulls the weights, as pull does, in one round trip.
+	 * The gradient is sent sparsely if that is shorter.
+	 * Returns OTHER_ERROR if GRADIENT does not have one partial for every weight, or if the server cannot be reached, and 0 otherwise.
+	 */
+	int push(const vector<double>& gradient, int64_t version, vector<double> *weights, int64_t *new_version);
+
+	/* Tells the server that the worker has finished, or that it failed with ERROR, if it is not 0. */
+	int finish(int error);
+
+};
+
+
+/* A ParameterWorker is what every worker process of run_parameter_server runs. Parameter server training implements it (see GradientDescent.h). */
+class ParameterWorker {
+
+public:
+
+	virtual ~ParameterWorker();
+
+	/* Does the work of one worker, which pulls and pushes through CLIENT. Returns 0 on success, and an error code otherwise. */
+	virtual int run(ParameterClient *client) = 0;
+
+};
+
+
+/* Runs a parameter server in this process, for WORKER, which runs in NUM_WORKERS forked worker processes, until every worker has finished.
+ * The server starts from INITIAL_WEIGHTS, and applies every gradient it is pushed with the Optimizer OPTIONS names, in the order they arrive.
+ * Once it has applied MAX_UPDATES updates (if that is not 0), the server drops every other push, and answers every pull with STOP.
+ *
+ * STALENESS_BOUND bounds how far apart the workers get, as Stale Synchronous Parallel does: if it is not negative,
+ *  a worker that has pushed more than STALENESS_BOUND more gradients than the slowest worker still running is not answered
+ *  until the slowest worker catches up. With 0, the workers move in lock step; the larger it is, the less the workers wait, and the staler their gradients.
+ * Writes the final weights into WEIGHTS, and, if STATS is not NULL, what happened on the server into it.
+ *
+ * Returns the error of the first worker that failed, OTHER_ERROR if a worker died, sent a message the server does not know,
+ *  or could not be forked, or if the Optimizer could not be created (as for L-BFGS), and 0 otherwise.
+ */
+int run_parameter_server(size_t num_workers, const vector<double>& initial_weights, const OptimizerOptions& options, int64_t max_updates,
+	int64_t staleness_bound, ParameterWorker *worker, vector<double> *weights, ParameterServerStats *stats);
+
+
+
+#endif
@@ -12,13 +12,16 @@ using namespace std;
 /* ---------------- Constructor --------------- */
 
 Preprocessor::Preprocessor() {
-    variables = new unordered_map<string, VariableType> ();
-    vectors = new unordered_map<string, VariableType> ();
-    vector_dimensions = new unordered_map<string, int> ();
-    defined_variables = new unordered_set<string> ();
+    variables = new unordered_map<Symbol, VariableType> ();
+    vectors = new unordered_map<Symbol, VariableType> ();
+    vector_dimensions = new unordered_map<Symbol, int64_t> ();
+    defined_variables = new unordered_set<Symbol> ();
+    defined_components = new unordered_map<Symbol, struct component_definitions*> ();
     macros = new unordered_map<string, struct macro*> ();
 
     macros_done = false;
+    tree_reductions = false;
+    background_writer = false;
 }
 
 
@@ -27,6 +30,12 @@ Preprocessor::~Preprocessor() {
     delete vectors;
     delete vector_dimensions;
     delete defined_variables;
+    for (unordered_map<Symbol, struct component_definitions*>::iterator it = defined_components->begin();
+        it != defined_components->end(); ++it) {
+
+        delete it->second;
+    }
+    delete defined_components;
     for (unordered_map<string, struct macro*>::iterator it = macros->begin();
         it != macros->end(); ++it) {
 
@@ -36,70 +45,99 @@ Preprocessor::~Preprocessor() {
 }
 
 
+void Preprocessor::set_tree_reductions(bool tree_reductions) {
+    this->tree_reductions = tree_reductions;
+}
+
+
+void Preprocessor::set_background_writer(bool background_writer) {
+    this->background_writer = background_writer;
+}
+
+
 /* ------------------------------- Main Methods ---------------------------- */
 
 int Preprocessor::expand_program(const string& prog_filename, const string& expanded_prog_filename) {
 
-    if (!is_valid_file_name(prog_filename)) {
+    LineReader prog;
+    if (prog.open(prog_filename) != 0) {
         cerr << "\nInvalid Program file name: " << prog_filename << endl << endl;
         return INVALID_FILE_NAME;
     }
 
-    ifstream prog(prog_filename);
-    ofstream exp_prog(expanded_prog_filename);
+    // write the Expanded Program in large blocks; a file that cannot be opened makes a stream that cannot be written
+    OutputSink exp_prog_sink(DEFAULT_OUTPUT_BUFFER_SIZE, background_writer);
+    ostream exp_prog(&exp_prog_sink);
+    if (exp_prog_sink.open(expanded_prog_filename) != 0) exp_prog.setstate(ios::badbit);
+
+    int expand_success = expand_program(prog, exp_prog);
+
+    prog.close();
+    int write_success = exp_prog_sink.close();
+    if (expand_success == 0) expand_success = write_success;
+
+    // if there was an error, clear the Expanded Program file
+    if (expand_success != 0) {
+        ofstream clear_exp_prog(expanded_prog_filename);
+        clear_exp_prog.close();
+    }
+
+    return expand_success;
+
+}
+
+
+int Preprocessor::expand_program(istream& prog, ostream& exp_prog) {
+    LineReader reader(prog);
+    return expand_program(reader, exp_prog);
+}
+
+
+int Preprocessor::expand_program(LineReader& prog, ostream& exp_prog) {
 
-    // buffer into which we read a line from the file
+    // buffer into which we read a line from the program, since expanding a line rewrites its tokens
     string prog_line;
 
     // indicates how many lines were generated from a given line in the Shape Program.
     // 1 if no expansion was necessary, 0 for an empty line, -1 if the Shape Program line was invalid.
-    int num_lines_expanded;
+    int64_t num_lines_expanded;
 
     // expand each line
     int line_num = 0;
-    while(!prog.eof()) {
+    while(prog.next_line(&prog_line)) {
 
-        getline(prog, prog_line);
         num_lines_expanded = expand_line(prog_line, exp_prog);
-        // if there is an error expanding this line:
-        // print the error message, clear the Expanded Program file, and exit
+        // if there is an error expanding this line, print the error message and exit
         if (num_lines_expanded < 0) {
             cerr << "\nERROR, Line " << line_num << ":" << endl;
             cerr << prog_line << endl;
-            cerr << get_error_message(num_lines_expanded) << endl << endl;
-            prog.close();
-            exp_prog.close();
-            ofstream clear_exp_prog(expanded_prog_filename);
-            clear_exp_prog.close();
-            return num_lines_expanded;
+            cerr << get_error_message((int) num_lines_expanded) << endl << endl;
+            return (int) num_lines_expanded;
         }
 
         line_num++;
 
     }
 
-    prog.close();
-    exp_prog.close();
-
     return 0;
 
 }
 
 
-int Preprocessor::expand_line(const string& prog_line, ofstream& exp_prog) {
+int64_t Preprocessor::expand_line(const string& prog_line, ostream& exp_prog) {
     
     // edge error cases
-    if (!exp_prog.is_open()) return OTHER_ERROR;
+    if (!is_writable(exp_prog)) return OTHER_ERROR;
     if (prog_line.compare("") == 0) return 0;
 
     // tokenize the line
-    vector<string> *tokens = new vector<string>();
-    int num_tokens = tokenize_line(prog_line, tokens, " ");
+    vector<string> tokens;
+    int num_tokens = tokenize_line(prog_line, &tokens, " ");
     if (num_tokens < 3) return INVALID_LINE;
 
     // grab the instruction type, and act accordingly
-    if (!is_valid_instruction(tokens->at(0))) return INVALID_LINE;
-    InstructionType inst_type = get_instruction_type(tokens->at(0));
+    if (!is_valid_instruction(tokens.at(0))) return INVALID_LINE;
+    InstructionType inst_type = get_instruction_type(tokens.at(0));
 
 
     // macro instructions need to be parsed and stored, but are not written to the expanded program
@@ -119,9 +157,9 @@ int Preprocessor::expand_line(const string& prog_line, ofstream& exp_prog) {
         // clear the variables and defined_variables maps
         // these maps are used temporarily during the parsing of a macro
         delete variables;
-        variables = new unordered_map<string, VariableType> ();
+        variables = new unordered_map<Symbol, VariableType> ();
         delete defined_variables;
-        defined_variables = new unordered_set<string> ();
+        defined_variables = new unordered_set<Symbol> ();
 
         // if the macro was erroneous, return an error code
         if (valid_macro_line < 0) return valid_macro_line;
@@ -143,12 +181,12 @@ int Preprocessor::expand_line(const string& prog_line, ofstream& exp_prog) {
         if (valid_declare_line < 0) return valid_declare_line;
 
         // copy the line directly. It needs no expanding
-        exp_prog << prog_line << endl;
+        exp_prog << prog_line << '\n';
 
         // record the type of this variable
         // if it's an input, weight or exp_output, mark it as defined
-        VariableType var_type = get_variable_type(tokens->at(1));
-        string var_name = tokens->at(2);
+        VariableType var_type = get_variable_type(tokens.at(1));
+        string var_name = tokens.at(2);
         variables->insert(make_pair(var_name, var_type));
         if (var_type == VariableType::INPUT || var_type == VariableType::WEIGHT || var_type == VariableType::EXP_OUTPUT)
             defined_variables->insert(var_name);
@@ -163,12 +201,11 @@ int Preprocessor::expand_line(const string& prog_line, ofstream& exp_prog) {
         if (valid_define_line < 0) return valid_define_line;
 
         // expand the line
-        int num_lines = expand_define_instruction(prog_line, exp_prog);
+        int64_t num_lines = expand_define_instruction(prog_line, exp_prog);
         if (num_lines < 0) return num_lines;
 
-        // mark this variable as defined
-        string var_name = tokens->at(1);
-        defined_variables->insert(var_name);
+        // mark this variable (or vector component) as defined
+        mark_defined(tokens.at(1));
         return num_lines;
 
     }
@@ -180,11 +217,11 @@ int Preprocessor::expand_line(const string& prog_line, ofstream& exp_prog) {
         if (valid_define_vector_line < 0) return valid_define_vector_line;
 
         // expand the line
-        int num_lines = expand_define_vector_instruction(prog_line, exp_prog);
+        int64_t num_lines = expand_define_vector_instruction(prog_line, exp_prog);
         if (num_lines < 0) return num_lines;
 
-        // mark this vector as defined
-        string var_name = tokens->at(1);
+        // mark this vector, and so all its components, as defined
+        string var_name = tokens.at(1);
         defined_variables->insert(var_name);
         return num_lines;
     }
@@ -197,14 +234,14 @@ int Preprocessor::expand_line(const string& prog_line, ofstream& exp_prog) {
 
         // write the expanded component declarations into expanded_shape_lines
         // grab the size of the vector from the return value of expand_declare_vector_instruction
-        int vector_size = expand_declare_vector_instruction(prog_line, exp_prog);
+        int64_t vector_size = expand_declare_vector_instruction(prog_line, exp_prog);
 
         // record the type and dimension of this vector
-        string vec_name = tokens->at(2);
-        VariableType vec_type = get_variable_type(tokens->at(1));
-        int vec_size = stoi(tokens->at(3));
+        // its components are not recorded one by one: they are recognized by their names (see find_vector_component)
+        string vec_name = tokens.at(2);
+        VariableType vec_type = get_variable_type(tokens.at(1));
         vectors->insert(make_pair(vec_name, vec_type));
-        vector_dimensions->insert(make_pair(vec_name, vec_size));
+        vector_dimensions->insert(make_pair(vec_name, vector_size));
 
         if (vec_type == VariableType::INPUT || vec_type == VariableType::WEIGHT || vec_type == VariableType::EXP_OUTPUT) {
             defined_variables->insert(vec_name);
@@ -223,77 +260,70 @@ int Preprocessor::expand_line(const string& prog_line, ofstream& exp_prog) {
 /* ------------------------- Main Expansion Methods ------------------------- */
 
 
-int Preprocessor::expand_declare_vector_instruction(const string& line, ofstream &exp_prog) {
+int64_t Preprocessor::expand_declare_vector_instruction(const string& line, ostream& exp_prog) {
 
     if (line.compare("") == 0) return 0;
 
     // tokenize the line
-    vector<string> *tokens = new vector<string>();
-    int num_tokens = tokenize_line(line, tokens, " ");
+    vector<string> tokens;
+    int num_tokens = tokenize_line(line, &tokens, " ");
     if (num_tokens != 4) return INVALID_LINE;
 
     // grab the vector name, type and size
-    string vec_type = tokens->at(1), vec_name = tokens->at(2);
-    int vec_size = stoi(tokens->at(3));
-    VariableType vec_var_type = get_variable_type(vec_type);
-    
+    string vec_type = tokens.at(1), vec_name = tokens.at(2);
+    int64_t vec_size;
+    if (!parse_int64(tokens.at(3).data(), tokens.at(3).length(), &vec_size)) return BAD_VECTOR_SIZE;
+
     // expand into declarations of components
-    // place all the components into the Variables map (marking them as declared)
-    // if this vector is input, weight or exp_output, mark all the components as defined
-    string component_name;
-    for (int i = 0; i < vec_size; i++) {
-        component_name = get_vector_component_name(vec_name, i);
-        exp_prog << "declare " << vec_type << " " << component_name << endl;
-        variables->insert(make_pair(component_name, vec_var_type));
-        if (vec_var_type == VariableType::INPUT || vec_var_type == VariableType::WEIGHT || vec_var_type == VariableType::EXP_OUTPUT) {
-            defined_variables->insert(component_name);
-        }
+    // the component names are written straight into the Expanded Program, and are never built as strings
+    for (int64_t i = 0; i < vec_size; i++) {
+        exp_prog << "declare " << vec_type << " " << vec_name << "." << i << '\n';
     }
 
     return vec_size;    
 }
 
 
-int Preprocessor::expand_define_instruction(const string& line, ofstream &exp_prog) {
+int64_t Preprocessor::expand_define_instruction(const string& line, ostream& exp_prog) {
 
     if (line.compare("") == 0) return 0;
 
     // tokenize the line
-    vector<string> *tokens = new vector<string>();
-    int num_tokens = tokenize_line(line, tokens, " ");
+    vector<string> tokens;
+    int num_tokens = tokenize_line(line, &tokens, " ");
     if (num_tokens < 4 || num_tokens > 6) return INVALID_LINE;
 
-    string var_name = tokens->at(1), operation = tokens->at(3);
+    string var_name = tokens.at(1), operation = tokens.at(3);
 
     if (is_dot_product(operation)) {
-        string operand1 = tokens->at(4);
-        string operand2 = tokens->at(5);
-        int dimension = vector_dimensions->at(operand1);
+        string operand1 = tokens.at(4);
+        string operand2 = tokens.at(5);
+        int64_t dimension = vector_dimensions->at(operand1);
         return expand_dot_product_instruction(var_name, operand1, operand2, dimension, exp_prog);
     }
 
     if (is_reduce_vector(operation)) {
-        string vec_operand = tokens->at(4);
-        string func_operand = tokens->at(5);
-        int dimension = vector_dimensions->at(vec_operand);
+        string vec_operand = tokens.at(4);
+        string func_operand = tokens.at(5);
+        int64_t dimension = vector_dimensions->at(vec_operand);
         return expand_reduce_vector_instruction(var_name, vec_operand, func_operand, dimension, exp_prog);
     }
 
     else if (is_valid_macro(operation)) {
         if (num_tokens == 5) {
-            string operand = tokens->at(4);
+            string operand = tokens.at(4);
             return expand_unary_macro(operation, operand, var_name, exp_prog);
         }
         if (num_tokens == 6) {
-            string operand1 = tokens->at(4);
-            string operand2 = tokens->at(5);
+            string operand1 = tokens.at(4);
+            string operand2 = tokens.at(5);
             return expand_binary_macro(operation, operand1, operand2, var_name, exp_prog);
         }
 
     }
 
     else if (is_constant(operation) || is_valid_var_name(operation) || is_valid_primitive(operation)) {
-        exp_prog << line << endl;
+        exp_prog << line << '\n';
         return 1;
     }
 
@@ -301,17 +331,17 @@ int Preprocessor::expand_define_instruction(const string& line, ofstream &exp_pr
 
 }
 
-int Preprocessor::expand_define_vector_instruction(const string& line, ofstream &exp_prog) {
+int64_t Preprocessor::expand_define_vector_instruction(const string& line, ostream& exp_prog) {
 
     if (line.compare("") == 0) return 0;
 
     // tokenize the line
-    vector<string> *tokens = new vector<string>();
-    int num_tokens = tokenize_line(line, tokens, " ");
+    vector<string> tokens;
+    int num_tokens = tokenize_line(line, &tokens, " ");
     if (num_tokens < 5 || num_tokens > 6) return INVALID_LINE;
 
-    string var_name = tokens->at(1), operation = tokens->at(3);
-    string operand1 = tokens->at(4);
+    string var_name = tokens.at(1), operation = tokens.at(3);
+    string operand1 = tokens.at(4);
     string operand2 = "";
 
     // determine whether the operation is a primitive or a macro
@@ -326,7 +356,7 @@ int Preprocessor::expand_define_vector_instruction(const string& line, ofstream
 
     if (num_tokens == 6) {
         unary_vector_operation = false;
-        operand2 = tokens->at(5);
+        operand2 = tokens.at(5);
 
         if (vector_dimensions->count(operand2) > 0) {
             binary_vector_operation = true;
@@ -336,43 +366,41 @@ int Preprocessor::expand_define_vector_instruction(const string& line, ofstream
     }
 
     // determine the dimensions we are working with
-    int dimension = vector_dimensions->at(operand1);
+    int64_t dimension = vector_dimensions->at(operand1);
 
     // expand into component instructions
-    for (int i = 0; i < dimension; i++) {
-
-        string operand1_component = get_vector_component_name(operand1, i);
-        string operand2_component = get_vector_component_name(operand2, i);
-        string result_component = get_vector_component_name(var_name, i);
+    // primitives write the component names straight into the Expanded Program; only macros need them as strings
+    // the components are not marked as defined one by one: expand_line marks the whole vector as defined
+    for (int64_t i = 0; i < dimension; i++) {
 
         if (unary_vector_operation) {
             if (operation_is_primitive) {
-                exp_prog << "define " << result_component << " = " << operation << " " << operand1_component << endl;
+                exp_prog << "define " << var_name << "." << i << " = " << operation << " " << operand1 << "." << i << '\n';
             } else if (operation_is_macro) {
-                expand_unary_macro(operation, operand1_component, result_component, exp_prog);
+                expand_unary_macro(operation, get_vector_component_name(operand1, i), get_vector_component_name(var_name, i), exp_prog);
             }
         }
 
+        // operand 2 only has components in a binary vector operation
         else if (vector_scalar_operation) {
             if (operation_is_primitive) {
-                exp_prog << "define " << result_component << " = " << operation << " " <<
-                operand1_component << " " << operand2 << endl;
+                exp_prog << "define " << var_name << "." << i << " = " << operation << " " <<
+                operand1 << "." << i << " " << operand2 << '\n';
             } else if (operation_is_macro) {
-                expand_binary_macro(operation, operand1_component, operand2, result_component, exp_prog);
+                expand_binary_macro(operation, get_vector_component_name(operand1, i), operand2, get_vector_component_name(var_name, i), exp_prog);
             }
         }
 
         else if (binary_vector_operation) {
             if (operation_is_primitive) {
-                exp_prog << "define " << result_component << " = " << operation << " " <<
-                operand1_component << " " << operand2_component << endl;
+                exp_prog << "define " << var_name << "." << i << " = " << operation << " " <<
+                operand1 << "." << i << " " << operand2 << "." << i << '\n';
             } else if (operation_is_macro) {
-                expand_binary_macro(operation, operand1_component, operand2_component, result_component, exp_prog);
+                expand_binary_macro(operation, get_vector_component_name(operand1, i), get_vector_component_name(operand2, i),
+                    get_vector_component_name(var_name, i), exp_prog);
             }
         }
 
-        // mark this component as defined
-        defined_variables->insert(result_component);
     }
 
     return dimension;
@@ -381,10 +409,10 @@ int Preprocessor::expand_define_vector_instruction(const string& line, ofstream
 
 
 
-int Preprocessor::expand_vector_operation(const OperationType& oper_type, const string& result, const string& operand1, const string& operand2,
-    ofstream& exp_prog) {
+int64_t Preprocessor::expand_vector_operation(const OperationType& oper_type, const string& result, const string& operand1, const string& operand2,
+    ostream& exp_prog) {
 
-    int dimension = vector_dimensions->at(operand1);
+    int64_t dimension = vector_dimensions->at(operand1);
 
     if (oper_type == OperationType::DOT)
         return expand_dot_product_instruction(result, operand1, operand2, dimension, exp_prog);
@@ -412,7 +440,7 @@ int Preprocessor::expand_vector_operation(const OperationType& oper_type, const
 
 
 int Preprocessor::expand_unary_macro(const string& macro_name, const string& operand, const string& result, 
-    ofstream& exp_prog) {
+    ostream& exp_prog) {
 
     struct macro *macro = macros->at(macro_name);
     vector<string> *macro_lines = macro->lines;
@@ -421,7 +449,7 @@ int Preprocessor::expand_unary_macro(const string& macro_name, const string& ope
     for (int i = 0; i < macro->num_lines; i++) {
         string dummy_line = macro_lines->at(i);
         string modified_line = substitute_dummy_names(dummy_line, macro->result, macro->operand1, "", result, operand, "", macro->num_references);
-        exp_prog << modified_line << endl;
+        exp_prog << modified_line << '\n';
     }
 
     macro->num_references++;
@@ -431,7 +459,7 @@ int Preprocessor::expand_unary_macro(const string& macro_name, const string& ope
 
 
 int Preprocessor::expand_binary_macro(const string& macro_name, const string& operand1, const string& operand2, const string& result, 
-    ofstream& exp_prog) {
+    ostream& exp_prog) {
 
     struct macro *macro = macros->at(macro_name);
     vector<string> *macro_lines = macro->lines;
@@ -439,7 +467,7 @@ int Preprocessor::expand_binary_macro(const string& macro_name, const string& op
     for (int i = 0; i < macro->num_lines; i++) {
         string dummy_line = macro_lines->at(i);
         string modified_line = substitute_dummy_names(dummy_line, macro->result, macro->operand1, macro->operand2, result, operand1, operand2, macro->num_references);
-        exp_prog << modified_line << endl;
+        exp_prog << modified_line << '\n';
     }
 
     macro->num_references++;
@@ -452,14 +480,14 @@ string Preprocessor::substitute_dummy_names(const string& dummy_line, string dum
     const string& result, const string& operand1, const string& operand2, int macro_num_references) {
 
     // tokenize the line
-    vector<string> *tokens = new vector<string>();
-    int num_tokens = tokenize_line(dummy_line, tokens, " ");
+    vector<string> tokens;
+    int num_tokens = tokenize_line(dummy_line, &tokens, " ");
     if (num_tokens < 3) return "";
 
     string modified_line = "";
 
     for (int i = 0; i < num_tokens; i++) {
-        string token = tokens->at(i);
+        string token = tokens.at(i);
 
         if (token.compare(dummy_result) == 0) {
             modified_line.append(result);
@@ -507,41 +535,48 @@ bool Preprocessor::is_unary_macro(const string& name) {
 
 
 
-int Preprocessor::expand_dot_product_instruction(const string& result, const string& vector1, const string& vector2, int dimension,
-    ofstream& exp_prog) {
+int64_t Preprocessor::expand_dot_product_instruction(const string& result, const string& vector1, const string& vector2, int64_t dimension,
+    ostream& exp_prog) {
 
     // declare and define intvars for all the component-wise multiplications
-    for (int i = 0; i < dimension; i++) {
-        exp_prog << "declare intvar " << result << "." << i << endl;
-        exp_prog << "define " << result << "." << i << " = mul " << vector1 << "." << i << " " << vector2 << "." << i << endl;
+    for (int64_t i = 0; i < dimension; i++) {
+        exp_prog << "declare intvar " << result << "." << i << '\n';
+        exp_prog << "define " << result << "." << i << " = mul " << vector1 << "." << i << " " << vector2 << "." << i << '\n';
     }
 
     // if the operand vectors' dimension is 1, the dot product is equal to the single component-wise product
     if (dimension == 1) {
-        exp_prog << "define " << result << " = " << result << ".0" << endl;
+        exp_prog << "define " << result << " = " << result << ".0" << '\n';
         return 3;
     }
 
+    // sum the component-wise products pairwise, into the same intvars the chain below would use
+    if (tree_reductions) {
+        expand_reduction_tree(result, dimension, result, dimension, "add", exp_prog);
+        exp_prog << "define " << result << " = " << result << "." << 2 * dimension - 2 << '\n';
+        return (4 * dimension - 1);
+    }
+
     // accumulate the sum of all the component-wise products
-    for (int j = 0; j < (dimension - 1); j++) {
-        exp_prog << "declare intvar " << result << "." << dimension + j << endl;
+    for (int64_t j = 0; j < (dimension - 1); j++) {
+        exp_prog << "declare intvar " << result << "." << dimension + j << '\n';
         if (j == 0) {
-            exp_prog << "define " << result << "." << dimension + j << " = add " << result << "." << 0 << " " << result << "." << 1 << endl;
+            exp_prog << "define " << result << "." << dimension + j << " = add " << result << "." << 0 << " " << result << "." << 1 << '\n';
         } else {
-            exp_prog << "define " << result << "." << dimension + j << " = add " << result << "." << dimension + j - 1 << " " << result << "." << j + 1 << endl;
+            exp_prog << "define " << result << "." << dimension + j << " = add " << result << "." << dimension + j - 1 << " " << result << "." << j + 1 << '\n';
         }
             
     }
 
     // define the value of the final dot product
-    exp_prog << "define " << result << " = " << result << "." << 2 * dimension - 2 << endl;
+    exp_prog << "define " << result << " = " << result << "." << 2 * dimension - 2 << '\n';
     return (4 * dimension - 1);
 
 }
 
 
-int Preprocessor::expand_reduce_vector_instruction(const string& result, const string& vec,
-    const string& func, int dimension, ofstream& exp_prog) {
+int64_t Preprocessor::expand_reduce_vector_instruction(const string& result, const string& vec,
+    const string& func, int64_t dimension, ostream& exp_prog) {
 
     // determine whether the operation is a primitive or a macro
     bool func_is_primitive = is_valid_primitive(func);
@@ -552,18 +587,25 @@ int Preprocessor::expand_reduce_vector_instruction(const string& result, const s
     // if the vector has one component, RESULT simply equals that component
     if (dimension == 1) {
         string component_zero = get_vector_component_name(vec, 0);
-        exp_prog << "define " << result << " = " << component_zero << endl;
+        exp_prog << "define " << result << " = " << component_zero << '\n';
         return 1;
     }
 
     // this counter will track the number of lines required to expand this vector reduction
-    int num_lines = 0;
+    int64_t num_lines = 0;
+
+    // associative primitives can combine the components pairwise, into the same intvars the chain below would use
+    if (tree_reductions && (func == "add" || func == "mul")) {
+        num_lines += expand_reduction_tree(vec, dimension, result, 0, func, exp_prog);
+        exp_prog << "define " << result << " = " << get_intermediate_name(result, dimension - 2) << '\n';
+        return num_lines + 1;
+    }
 
     // iterate from the 1st to the final component of the vector
     // declare an intvar NEW_ACCUMULATION
     // define this intvar as the sum of the i-th component and the running accumulation (PREV_ACCUMULATION)
     string ith_component, new_accumulation, prev_accumulation;
-    for (int i = 1; i < dimension; i++) {
+    for (int64_t i = 1; i < dimension; i++) {
 
         // grab the names for the ith component, new accumulation and prev accumulation
         // if this is the first iteration, the previous accumulation is just the zeroth component
@@ -576,13 +618,13 @@ int Preprocessor::expand_reduce_vector_instruction(const string& result, const s
         }
 
         // declare the intvar for NEW_ACCUMULATION
-        exp_prog << "declare intvar " << new_accumulation << endl;
+        exp_prog << "declare intvar " << new_accumulation << '\n';
         num_lines++;
 
         // define NEW_ACCUMULATION
         // if FUNC is a macro, this definition requires macro expansion
         if (func_is_primitive) {
-            exp_prog << "define " << new_accumulation << " = " << func << " " << prev_accumulation << " " << ith_component << endl;
+            exp_prog << "define " << new_accumulation << " = " << func << " " << prev_accumulation << " " << ith_component << '\n';
             num_lines++;
         }
         else if (func_is_macro) {
@@ -592,19 +634,72 @@ int Preprocessor::expand_reduce_vector_instruction(const string& result, const s
     }
 
     // define RESULT as the most recent accumulation intvar
-    exp_prog << "define " << result << " = " << new_accumulation << endl;
+    exp_prog << "define " << result << " = " << new_accumulation << '\n';
     num_lines++;
  
     return num_lines;
 }
 
 
-int Preprocessor::expand_component_wise_add_instruction(const string& result_vec, const string& vector1, const string& vector2, int dimension, 
-    ofstream& exp_prog) {
+/* Returns the number of the J-th node of a level of a reduction tree (see expand_reduction_tree).
+ * The first LEVEL_PAIRS nodes are the intermediates from LEVEL_START on, and a node after them is the one CARRIED up from the level below.
+ * A LEVEL_START of -1 stands for the bottom level, whose nodes are the terms themselves.
+ */
+static int64_t reduction_tree_node(int64_t j, int64_t num_terms, int64_t level_start, int64_t level_pairs, int64_t carried) {
+    if (level_start < 0) return j;
+    return j < level_pairs ? num_terms + level_start + j : carried;
+}
+
+
+/* Writes the name of the node NUMBER of a reduction tree (see expand_reduction_tree) into EXP_PROG. */
+static void write_reduction_tree_node(int64_t number, int64_t num_terms, const string& terms, const string& intermediates,
+    int64_t first_intermediate, ostream& exp_prog) {
+    if (number < num_terms) exp_prog << terms << "." << number;
+    else exp_prog << intermediates << "." << first_intermediate + (number - num_terms);
+}
+
+
+int64_t Preprocessor::expand_reduction_tree(const string& terms, int64_t num_terms, const string& intermediates, int64_t first_intermediate,
+    const string& func, ostream& exp_prog) {
+
+    // nodes are numbers: numbers below NUM_TERMS are terms, and number NUM_TERMS + j is the j-th intermediate
+    // node i of the next level is the sum of nodes 2i and 2i + 1 of this one, and the last node of an odd level is carried up,
+    //  so a level is its first intermediate, its number of pairs, and the node it carried, and no level is ever stored
+    // the intermediates are used in order, so the last one defined is the root of the tree
+    int64_t num_nodes = num_terms, level_start = -1, level_pairs = 0, carried = -1;
+    int64_t num_intermediates = 0;
+
+    while (num_nodes > 1) {
+        int64_t num_pairs = num_nodes / 2;
+        for (int64_t i = 0; i < num_pairs; i++) {
+            int64_t sum = first_intermediate + num_intermediates + i;
+            exp_prog << "declare intvar " << intermediates << "." << sum << '\n';
+            exp_prog << "define " << intermediates << "." << sum << " = " << func << " ";
+            write_reduction_tree_node(reduction_tree_node(2 * i, num_terms, level_start, level_pairs, carried), num_terms, terms,
+                intermediates, first_intermediate, exp_prog);
+            exp_prog << " ";
+            write_reduction_tree_node(reduction_tree_node(2 * i + 1, num_terms, level_start, level_pairs, carried), num_terms, terms,
+                intermediates, first_intermediate, exp_prog);
+            exp_prog << '\n';
+        }
+
+        if (num_nodes % 2 == 1) carried = reduction_tree_node(num_nodes - 1, num_terms, level_start, level_pairs, carried);
+        level_start = num_intermediates;
+        level_pairs = num_pairs;
+        num_intermediates += num_pairs;
+        num_nodes = num_pairs + num_nodes % 2;
+    }
+
+    return 2 * num_intermediates;
+}
+
+
+int64_t Preprocessor::expand_component_wise_add_instruction(const string& result_vec, const string& vector1, const string& vector2, int64_t dimension, 
+    ostream& exp_prog) {
 
     // define the components of the result vector as the component-wise sums of the operand vectors
-    for (int i = 0; i < dimension; i++) {
-        exp_prog << "define " << result_vec << "." << i << " = add " << vector1 << "." << i << " " << vector2 << "." << i << endl;
+    for (int64_t i = 0; i < dimension; i++) {
+        exp_prog << "define " << result_vec << "." << i << " = add " << vector1 << "." << i << " " << vector2 << "." << i << '\n';
     }
 
     return dimension;
@@ -612,12 +707,12 @@ int Preprocessor::expand_component_wise_add_instruction(const string& result_vec
 }
 
 
-int Preprocessor::expand_component_wise_mul_instruction(const string& result_vec, const string& vector1, const string& vector2, int dimension, 
-    ofstream& exp_prog) {
+int64_t Preprocessor::expand_component_wise_mul_instruction(const string& result_vec, const string& vector1, const string& vector2, int64_t dimension, 
+    ostream& exp_prog) {
 
     // define the components of the result vector as the component-wise products of the operand vectors
-    for (int i = 0; i < dimension; i++) {
-        exp_prog << "define " << result_vec << "." << i << " = mul " << vector1 << "." << i << " " << vector2 << "." << i << endl;
+    for (int64_t i = 0; i < dimension; i++) {
+        exp_prog << "define " << result_vec << "." << i << " = mul " << vector1 << "." << i << " " << vector2 << "." << i << '\n';
     }
 
     return dimension;
@@ -625,12 +720,12 @@ int Preprocessor::expand_component_wise_mul_instruction(const string& result_vec
 }
 
 
-int Preprocessor::expand_scale_vector_instruction(const string& result_vec, const string& vector1, const string& scaling_factor, int dimension, 
-    ofstream& exp_prog) {
+int64_t Preprocessor::expand_scale_vector_instruction(const string& result_vec, const string& vector1, const string& scaling_factor, int64_t dimension, 
+    ostream& exp_prog) {
 
     // define the components of the result vector as the products of the operand's components and the scaling factor
-    for (int i = 0; i < dimension; i++) {
-        exp_prog << "define " << result_vec << "." << i << " = mul " << vector1 << "." << i << " " << scaling_factor << endl;
+    for (int64_t i = 0; i < dimension; i++) {
+        exp_prog << "define " << result_vec << "." << i << " = mul " << vector1 << "." << i << " " << scaling_factor << '\n';
     }
 
     return dimension;
@@ -638,12 +733,12 @@ int Preprocessor::expand_scale_vector_instruction(const string& result_vec, cons
 }
 
 
-int Preprocessor::expand_increment_vector_instruction(const string& result_vec, const string& vector1, const string& incrementing_factor, int dimension,
-    ofstream& exp_prog) {
+int64_t Preprocessor::expand_increment_vector_instruction(const string& result_vec, const string& vector1, const string& incrementing_factor, int64_t dimension,
+    ostream& exp_prog) {
 
     // define the components of the result vector as the sums of the operand's components and the incrementing factor
-    for (int i = 0; i < dimension; i++) {
-        exp_prog << "define " << result_vec << "." << i << " = add " << vector1 << "." << i << " " << incrementing_factor << endl;
+    for (int64_t i = 0; i < dimension; i++) {
+        exp_prog << "define " << result_vec << "." << i << " = add " << vector1 << "." << i << " " << incrementing_factor << '\n';
     }
 
     return dimension;
@@ -662,12 +757,12 @@ int Preprocessor::parse_macro_line(const string& macro_line, struct macro *macro
     if (macro_line.compare("") == 0) return 0;
 
     // tokenize the large macro line into its sublines (separated by semi-colons)
-    vector<string> *sub_macro_lines = new vector<string>();
-    int num_sub_lines = tokenize_line(macro_line, sub_macro_lines, ";");
+    vector<string> sub_macro_lines;
+    int num_sub_lines = tokenize_line(macro_line, &sub_macro_lines, ";");
     if (num_sub_lines < 2) return INVALID_LINE;
     
     // make sure the first sub line is valid and parse it
-    int first_line_valid = parse_macro_first_line(sub_macro_lines->at(0), macro);
+    int first_line_valid = parse_macro_first_line(sub_macro_lines.at(0), macro);
     if (first_line_valid < 0) return first_line_valid;
 
     macro->lines = new vector<string>();
@@ -676,9 +771,9 @@ int Preprocessor::parse_macro_line(const string& macro_line, struct macro *macro
     // validate and parse subsequent sub lines.
     int subsequent_line_valid;
     for (int i = 1; i < num_sub_lines; i++) {
-        subsequent_line_valid = parse_macro_subsequent_line(sub_macro_lines->at(i), macro);
+        subsequent_line_valid = parse_macro_subsequent_line(sub_macro_lines.at(i), macro);
         if (subsequent_line_valid < 0) return subsequent_line_valid;
-        macro->lines->push_back(string(sub_macro_lines->at(i)));
+        macro->lines->push_back(string(sub_macro_lines.at(i)));
         macro->num_lines++;
     }
 
@@ -694,15 +789,15 @@ int Preprocessor::parse_macro_first_line(const string& first_line, struct macro
     if (first_line.compare("") == 0) return 0;
 
     // tokenize
-    vector<string> *tokens = new vector<string>();
-    int num_tokens = tokenize_line(first_line, tokens, " ");
+    vector<string> tokens;
+    int num_tokens = tokenize_line(first_line, &tokens, " ");
 
     // check for trivial errors
     if (num_tokens < 5 || num_tokens > 6) return INVALID_LINE;
 
     // grab the tokens in strings
-    string first_token = tokens->at(0), second_token = tokens->at(1), third_token = tokens->at(2);
-    string fourth_token = tokens->at(3), fifth_token = tokens->at(4);
+    string first_token = tokens.at(0), second_token = tokens.at(1), third_token = tokens.at(2);
+    string fourth_token = tokens.at(3), fifth_token = tokens.at(4);
     string sixth_token = "";
 
     // make sure the line format is correct
@@ -712,7 +807,7 @@ int Preprocessor::parse_macro_first_line(const string& first_line, struct macro
     if (!is_valid_macro_name(fourth_token)) return INVALID_MACRO_NAME;
     if (!is_valid_var_name(fifth_token) || second_token.compare(fifth_token) == 0) return INVALID_LINE;
     if (num_tokens == 6) {
-        sixth_token = tokens->at(5);
+        sixth_token = tokens.at(5);
         if (!is_valid_var_name(sixth_token) || second_token.compare(sixth_token) == 0) return INVALID_LINE;
     }
 
@@ -744,21 +839,21 @@ int Preprocessor::parse_macro_subsequent_line(const string& line, struct macro *
     if (line.compare("") == 0) return 0;
 
     // tokenize
-    vector<string> *tokens = new vector<string>();
-    int num_tokens = tokenize_line(line, tokens, " ");
+    vector<string> tokens;
+    int num_tokens = tokenize_line(line, &tokens, " ");
     if (num_tokens < 3 || num_tokens > 6) return INVALID_LINE;
 
     // temporarily declare or define this variable
     if (is_valid_declare_line(line) == 0) {
-        string var_name = tokens->at(2);
-        VariableType var_type = get_variable_type(tokens->at(1));
+        string var_name = tokens.at(2);
+        VariableType var_type = get_variable_type(tokens.at(1));
         if (var_type != VariableType::INTVAR) return BAD_VAR_TYPE;
         variables->insert(make_pair(var_name, var_type));
         return 0;
     }
 
     if (is_valid_define_line(line) == 0) {
-        string var_name = tokens->at(1);
+        string var_name = tokens.at(1);
         defined_variables->insert(var_name);
         return 0;
     }
@@ -776,14 +871,14 @@ int Preprocessor::is_valid_declare_line(const string& line) {
 
     if (line.compare("") == 0) return OTHER_ERROR;
 
-    vector<string> *tokens = new vector<string>();
-    int num_tokens = tokenize_line(line, tokens, " ");
+    vector<string> tokens;
+    int num_tokens = tokenize_line(line, &tokens, " ");
     if (num_tokens != 3) return INVALID_LINE;
 
-    if (tokens->at(0).compare("declare") != 0) return INVALID_LINE;
-    if (get_variable_type(tokens->at(1)) == VariableType::INVALID_VAR_TYPE) return BAD_VAR_TYPE;
-    if (!is_valid_var_name(tokens->at(2))) return INVALID_VAR_NAME;
-    if (variables->count(tokens->at(2)) != 0) return VAR_DECLARED_TWICE;
+    if (tokens.at(0).compare("declare") != 0) return INVALID_LINE;
+    if (get_variable_type(tokens.at(1)) == VariableType::INVALID_VAR_TYPE) return BAD_VAR_TYPE;
+    if (!is_valid_var_name(tokens.at(2))) return INVALID_VAR_NAME;
+    if (variables->count(tokens.at(2)) != 0) return VAR_DECLARED_TWICE;
 
     return 0;
 }
@@ -793,15 +888,16 @@ int Preprocessor::is_valid_declare_vector_line(const string& line) {
 
     if (line.compare("") == 0) return OTHER_ERROR;
 
-    vector<string> *tokens = new vector<string>();
-    int num_tokens = tokenize_line(line, tokens, " ");
+    vector<string> tokens;
+    int num_tokens = tokenize_line(line, &tokens, " ");
     if (num_tokens != 4) return INVALID_LINE;
 
-    if (tokens->at(0).compare("declare_vector") != 0) return INVALID_LINE;
-    if (get_variable_type(tokens->at(1)) == VariableType::INVALID_VAR_TYPE) return BAD_VAR_TYPE;
-    if (!is_valid_var_name(tokens->at(2))) return INVALID_VAR_NAME;
-    if (vectors->count(tokens->at(2)) != 0 || variables->count(tokens->at(2)) != 0) return VAR_DECLARED_TWICE;
-    if (!is_int(tokens->at(3)) || !is_valid_vector_size(stoi(tokens->at(3)))) return BAD_VECTOR_SIZE;
+    if (tokens.at(0).compare("declare_vector") != 0) return INVALID_LINE;
+    if (get_variable_type(tokens.at(1)) == VariableType::INVALID_VAR_TYPE) return BAD_VAR_TYPE;
+    if (!is_valid_var_name(tokens.at(2))) return INVALID_VAR_NAME;
+    if (vectors->count(tokens.at(2)) != 0 || variables->count(tokens.at(2)) != 0) return VAR_DECLARED_TWICE;
+    int64_t vec_size;
+    if (!parse_int64(tokens.at(3).data(), tokens.at(3).length(), &vec_size) || !is_valid_vector_size(vec_size)) return BAD_VECTOR_SIZE;
 
     return 0;
 
@@ -812,13 +908,13 @@ int Preprocessor::is_valid_define_line(const string& line) {
 
     if (line.compare("") == 0) return OTHER_ERROR;
 
-    vector<string> *tokens = new vector<string>();
-    int num_tokens = tokenize_line(line, tokens, " ");
+    vector<string> tokens;
+    int num_tokens = tokenize_line(line, &tokens, " ");
     if (num_tokens < 4 || num_tokens > 6) return INVALID_LINE;
 
-    string first_token = tokens->at(0);
-    string second_token = tokens->at(1);
-    string third_token = tokens->at(2);
+    string first_token = tokens.at(0);
+    string second_token = tokens.at(1);
+    string third_token = tokens.at(2);
 
     // every define instruction resembles "define <var_name> = ..."
     if (first_token.compare("define") != 0 || third_token.compare("=") != 0) {
@@ -833,24 +929,19 @@ int Preprocessor::is_valid_define_line(const string& line) {
 
 
     // input, weight and expected output variables cannot be defined
-    VariableType var_type;
-    if (variables->count(second_token) != 0) {
-        var_type = variables->at(second_token);
-    } 
-    else {
-        return VAR_DEFINED_BEFORE_DECLARED;
-    }
+    VariableType var_type = get_declared_type(second_token);
+    if (var_type == VariableType::INVALID_VAR_TYPE) return VAR_DEFINED_BEFORE_DECLARED;
     if (var_type == VariableType::INPUT || var_type == VariableType::WEIGHT || var_type == VariableType::EXP_OUTPUT)
         return CANNOT_DEFINE_I_W_EO;
 
-    string fourth_token = tokens->at(3);
+    string fourth_token = tokens.at(3);
 
 
     // a variable could be defined as a constant
     if (is_constant(fourth_token)) {
         // the variable being defined must have been declared, but cannot have been defined
-        if (variables->count(second_token) == 0) return VAR_DEFINED_BEFORE_DECLARED;
-        if (defined_variables->count(second_token) != 0) return VAR_DEFINED_TWICE;
+        if (!is_declared(second_token)) return VAR_DEFINED_BEFORE_DECLARED;
+        if (is_defined(second_token)) return VAR_DEFINED_TWICE;
         return (num_tokens == 4 ? 0 : INVALID_LINE);
     }
 
@@ -859,21 +950,21 @@ int Preprocessor::is_valid_define_line(const string& line) {
     if (is_valid_primitive(fourth_token) || is_valid_macro(fourth_token)) {
 
         // the variable being defined must have been declared, but cannot have been defined
-        if (variables->count(second_token) == 0) return VAR_DEFINED_BEFORE_DECLARED;
-        if (defined_variables->count(second_token) != 0) return VAR_DEFINED_TWICE;
+        if (!is_declared(second_token)) return VAR_DEFINED_BEFORE_DECLARED;
+        if (is_defined(second_token)) return VAR_DEFINED_TWICE;
         
         if (is_binary_primitive(fourth_token) || is_binary_macro(fourth_token)) {
             if (num_tokens != 6) return INVALID_LINE;
 
-            string fifth_token = tokens->at(4), sixth_token = tokens->at(5);
+            string fifth_token = tokens.at(4), sixth_token = tokens.at(5);
             bool first_operand_constant = is_constant(fifth_token);
             bool second_operand_constant = is_constant(sixth_token);
 
             if (!first_operand_constant)
-                if (defined_variables->count(fifth_token) == 0) return VAR_REFERENCED_BEFORE_DEFINED;
+                if (!is_defined(fifth_token)) return VAR_REFERENCED_BEFORE_DEFINED;
 
             if (!second_operand_constant)
-                if (defined_variables->count(sixth_token) == 0) return VAR_REFERENCED_BEFORE_DEFINED;
+                if (!is_defined(sixth_token)) return VAR_REFERENCED_BEFORE_DEFINED;
 
             return 0;
 
@@ -883,11 +974,11 @@ int Preprocessor::is_valid_define_line(const string& line) {
             
             if (num_tokens != 5) return INVALID_LINE;
 
-            string fifth_token = tokens->at(4);
+            string fifth_token = tokens.at(4);
             bool first_operand_constant = is_constant(fifth_token);
 
             if (!first_operand_constant)
-                if (defined_variables->count(fifth_token) == 0) return VAR_REFERENCED_BEFORE_DEFINED;
+                if (!is_defined(fifth_token)) return VAR_REFERENCED_BEFORE_DEFINED;
 
             return 0;
 
@@ -900,18 +991,18 @@ int Preprocessor::is_valid_define_line(const string& line) {
 
         // the variable being defined must have been declared, but cannot have been defined
         // the result variable must be a scalar, not a vector
-        if (variables->count(second_token) == 0) return VAR_DEFINED_BEFORE_DECLARED;
-        if (defined_variables->count(second_token) != 0) return VAR_DEFINED_TWICE;
+        if (!is_declared(second_token)) return VAR_DEFINED_BEFORE_DECLARED;
+        if (is_defined(second_token)) return VAR_DEFINED_TWICE;
         if (vectors->count(second_token) != 0) return INVALID_LINE;
 
         if (num_tokens != 6) return INVALID_LINE;
-        string fifth_token = tokens->at(4), sixth_token = tokens->at(5);
+        string fifth_token = tokens.at(4), sixth_token = tokens.at(5);
 
         // both the operand vectors must have been defined (or have all its components defined)
         if (vectors->count(fifth_token) == 0) return VAR_REFERENCED_BEFORE_DEFINED;
-        if (defined_variables->count(fifth_token) == 0 && !all_components_defined(fifth_token)) return VAR_REFERENCED_BEFORE_DEFINED;
+        if (!is_defined(fifth_token) && !all_components_defined(fifth_token)) return VAR_REFERENCED_BEFORE_DEFINED;
         if (vectors->count(sixth_token) == 0) return VAR_REFERENCED_BEFORE_DEFINED;
-        if (defined_variables->count(sixth_token) == 0 && !all_components_defined(sixth_token)) return VAR_REFERENCED_BEFORE_DEFINED;
+        if (!is_defined(sixth_token) && !all_components_defined(sixth_token)) return VAR_REFERENCED_BEFORE_DEFINED;
 
         // both the operand vectors must be of the same dimension
         if (vector_dimensions->at(fifth_token) != vector_dimensions->at(sixth_token)) return VECTORS_OF_DIFFERENT_DIMENSION;
@@ -921,7 +1012,7 @@ int Preprocessor::is_valid_define_line(const string& line) {
         // mark the vector as defined
         // This ensures that a vector defined component-wise is not marked as defined 
         //  until it is used as an operand for another vector
-        if (defined_variables->count(fifth_token) == 0 && all_components_defined(fifth_token)) {
+        if (!is_defined(fifth_token) && all_components_defined(fifth_token)) {
             defined_variables->insert(fifth_token);
         }
 
@@ -929,7 +1020,7 @@ int Preprocessor::is_valid_define_line(const string& line) {
         // mark the vector as defined
         // This ensures that a vector defined component-wise is not marked as defined 
         //  until it is used as an operand for another vector
-        if (defined_variables->count(sixth_token) == 0 && all_components_defined(sixth_token)) {
+        if (!is_defined(sixth_token) && all_components_defined(sixth_token)) {
             defined_variables->insert(sixth_token);
         }
 
@@ -941,17 +1032,17 @@ int Preprocessor::is_valid_define_line(const string& line) {
     if (is_reduce_vector(fourth_token)) {
 
         if (num_tokens != 6) return INVALID_LINE;
-        string fifth_token = tokens->at(4), sixth_token = tokens->at(5);
+        string fifth_token = tokens.at(4), sixth_token = tokens.at(5);
 
         // the variable being defined must have been declared, but cannot have been defined
         // the result variable must be a scalar, not a vector
-        if (variables->count(second_token) == 0) return VAR_DEFINED_BEFORE_DECLARED;
-        if (defined_variables->count(second_token) != 0) return VAR_DEFINED_TWICE;
+        if (!is_declared(second_token)) return VAR_DEFINED_BEFORE_DECLARED;
+        if (is_defined(second_token)) return VAR_DEFINED_TWICE;
         if (vectors->count(second_token) != 0) return INVALID_LINE;
 
         // the operand vector must have been defined (or have all its components defined)
         if (vectors->count(fifth_token) == 0) return VAR_REFERENCED_BEFORE_DEFINED;
-        if (defined_variables->count(fifth_token) == 0 && !all_components_defined(fifth_token)) return VAR_REFERENCED_BEFORE_DEFINED;
+        if (!is_defined(fifth_token) && !all_components_defined(fifth_token)) return VAR_REFERENCED_BEFORE_DEFINED;
 
         // the 6th token must be a valid binary primitive or a valid binary macro
         if (!is_binary_primitive(sixth_token) && !is_binary_macro(sixth_token)) return INVALID_LINE;
@@ -960,7 +1051,7 @@ int Preprocessor::is_valid_define_line(const string& line) {
         // mark the vector as defined
         // This ensures that a vector defined component-wise is not marked as defined 
         //  until it is used as an operand for another vector
-        if (defined_variables->count(fifth_token) == 0 && all_components_defined(fifth_token)) {
+        if (!is_defined(fifth_token) && all_components_defined(fifth_token)) {
             defined_variables->insert(fifth_token);
         }
 
@@ -974,11 +1065,11 @@ int Preprocessor::is_valid_define_line(const string& line) {
     if (is_valid_var_name(fourth_token)) {
 
         // the variable being defined must have been declared, but cannot have been defined
-        if (variables->count(second_token) == 0) return VAR_DEFINED_BEFORE_DECLARED;
-        if (defined_variables->count(second_token) != 0) return VAR_DEFINED_TWICE;
+        if (!is_declared(second_token)) return VAR_DEFINED_BEFORE_DECLARED;
+        if (is_defined(second_token)) return VAR_DEFINED_TWICE;
 
         if (num_tokens != 4) return INVALID_LINE;
-        if (defined_variables->count(fourth_token) == 0) return VAR_REFERENCED_BEFORE_DEFINED;
+        if (!is_defined(fourth_token)) return VAR_REFERENCED_BEFORE_DEFINED;
         return 0;
     }
 
@@ -992,13 +1083,13 @@ int Preprocessor::is_valid_define_vector_line(const string& line) {
 
     if (line.compare("") == 0) return OTHER_ERROR;
 
-    vector<string> *tokens = new vector<string>();
-    int num_tokens = tokenize_line(line, tokens, " ");
+    vector<string> tokens;
+    int num_tokens = tokenize_line(line, &tokens, " ");
     if (num_tokens < 5 || num_tokens > 6) return INVALID_LINE;
 
-    string first_token = tokens->at(0);
-    string second_token = tokens->at(1);
-    string third_token = tokens->at(2);
+    string first_token = tokens.at(0);
+    string second_token = tokens.at(1);
+    string third_token = tokens.at(2);
 
     // every define instruction resembles "define <vec_name> = ..."
     if (first_token.compare("define_vector") != 0 || third_token.compare("=") != 0) {
@@ -1025,11 +1116,11 @@ int Preprocessor::is_valid_define_vector_line(const string& line) {
 
     // vectors that have previously been defined cannot be redefined
     // none of the components can have been defined previously
-    if (defined_variables->count(second_token) != 0) return VAR_DEFINED_TWICE;
+    if (is_defined(second_token)) return VAR_DEFINED_TWICE;
     if (has_defined_components(second_token)) return VAR_DEFINED_TWICE;
 
 
-    string fourth_token = tokens->at(3);
+    string fourth_token = tokens.at(3);
 
     // a vector could be defined as a binary primitive/macro operation on:
     // two vectors ("define_vector z = add x y", where z, x and y are vectors)
@@ -1039,22 +1130,22 @@ int Preprocessor::is_valid_define_vector_line(const string& line) {
 
         if (num_tokens != 6) return INVALID_LINE;
 
-        string fifth_token = tokens->at(4);
-        string sixth_token = tokens->at(5);
+        string fifth_token = tokens.at(4);
+        string sixth_token = tokens.at(5);
 
         // the first operand must be a vector
         // it must be declared
         // the vector must have defined, or else all its components must have been defined
         // this operand vector must be of the same dimension as the result vector
         if (vectors->count(fifth_token) == 0) return VAR_REFERENCED_BEFORE_DEFINED;
-        if (defined_variables->count(fifth_token) == 0 && !all_components_defined(fifth_token)) return VAR_REFERENCED_BEFORE_DEFINED; 
+        if (!is_defined(fifth_token) && !all_components_defined(fifth_token)) return VAR_REFERENCED_BEFORE_DEFINED; 
         if (vector_dimensions->at(fifth_token) != vector_dimensions->at(second_token)) return VECTORS_OF_DIFFERENT_DIMENSION;
 
         // if the first operand is a vector with all its operands defined, but the vector itself isn't defined,
         // mark the vector as defined
         // This ensures that a vector defined component-wise is not marked as defined 
         //  until it is used as an operand for another vector
-        if (defined_variables->count(fifth_token) == 0 && all_components_defined(fifth_token)) {
+        if (!is_defined(fifth_token) && all_components_defined(fifth_token)) {
             defined_variables->insert(fifth_token);
         }
 
@@ -1065,14 +1156,14 @@ int Preprocessor::is_valid_define_vector_line(const string& line) {
         // it must have been defined, or else all its components must have been defined
         // it must be of the same dimension as the result and first operand vectors
         if (vectors->count(sixth_token) != 0) {
-            if (defined_variables->count(sixth_token) == 0 && !all_components_defined(sixth_token)) return VAR_REFERENCED_BEFORE_DEFINED;
+            if (!is_defined(sixth_token) && !all_components_defined(sixth_token)) return VAR_REFERENCED_BEFORE_DEFINED;
             if (vector_dimensions->at(fifth_token) != vector_dimensions->at(sixth_token)) return VECTORS_OF_DIFFERENT_DIMENSION;
 
             // if the second operand is a vector with all its operands defined, but the vector itself isn't defined,
             // mark the vector as defined
             // This ensures that a vector defined component-wise is not marked as defined 
             //  until it is used as an operand for another vector
-            if (defined_variables->count(sixth_token) == 0 && all_components_defined(sixth_token)) {
+            if (!is_defined(sixth_token) && all_components_defined(sixth_token)) {
                 defined_variables->insert(sixth_token);
             }
             return 0;
@@ -1086,8 +1177,8 @@ int Preprocessor::is_valid_define_vector_line(const string& line) {
         // if the second operand is not a vector or a constant,
         // make sure it is a variable, and has been defined
         else if (is_valid_var_name(sixth_token)) {
-            if (variables->count(sixth_token) == 0) return VAR_REFERENCED_BEFORE_DEFINED;
-            if (defined_variables->count(sixth_token) == 0) return VAR_REFERENCED_BEFORE_DEFINED;
+            if (!is_declared(sixth_token)) return VAR_REFERENCED_BEFORE_DEFINED;
+            if (!is_defined(sixth_token)) return VAR_REFERENCED_BEFORE_DEFINED;
             return 0;
         }
 
@@ -1103,10 +1194,10 @@ int Preprocessor::is_valid_define_vector_line(const string& line) {
     if (is_unary_primitive(fourth_token) || is_unary_macro(fourth_token)) {
 
         if (num_tokens != 5) return INVALID_LINE;
-        string fifth_token = tokens->at(4);
+        string fifth_token = tokens.at(4);
 
         // the first operand must be a defined vector and must be of the same dimension as the result vector
-        if (vectors->count(fifth_token) == 0 || defined_variables->count(fifth_token) == 0) return VAR_REFERENCED_BEFORE_DEFINED; 
+        if (vectors->count(fifth_token) == 0 || !is_defined(fifth_token)) return VAR_REFERENCED_BEFORE_DEFINED; 
         if (vector_dimensions->at(fifth_token) != vector_dimensions->at(second_token)) return VECTORS_OF_DIFFERENT_DIMENSION;
 
         return 0;
@@ -1123,70 +1214,110 @@ bool Preprocessor::is_valid_macro(const string& name) {
 }
 
 bool Preprocessor::is_vector_component(const string& name) {
-    if (name.size() < 3) return false;
+    Symbol vec;
+    int64_t component_num;
+    return find_vector_component(name, &vec, &component_num);
+}
+
 
-    // find the colon
-    size_t colon_pos = name.find_first_of(".");
-    if (colon_pos + 1 >= name.length()) return false;
+bool Preprocessor::find_vector_component(const string& name, Symbol *vec, int64_t *component_num) {
 
-    // grab the name of the vector, make sure there is a vector by this name
-    string vec_name = name.substr(0, colon_pos);
-    if (vectors->count(vec_name) == 0) return false;
+    // split the name at its dot, into the vector name and the component number
+    size_t vec_name_length;
+    int64_t num;
+    if (!split_vector_component(name.data(), name.length(), &vec_name_length, &num)) return false;
 
-    // grab the component number
-    // make sure it's a valid component number (is actually an int and is less than the vector's dimension)
-    string vec_size = name.substr(colon_pos + 1);
-    if (!is_int(vec_size)) return false;
+    // make sure there is a vector by this name (a name that was never interned cannot be a vector)
+    Symbol vec_symbol = Symbol::find(name.substr(0, vec_name_length));
+    if (!vec_symbol.is_valid() || vectors->count(vec_symbol) == 0) return false;
 
-    int dimension = stoi(vec_size);
-    if (vector_dimensions->at(vec_name) <= dimension) return false;
+    // make sure it's a valid component number (less than the vector's dimension)
+    if (vector_dimensions->at(vec_symbol) <= num) return false;
 
+    *vec = vec_symbol;
+    *component_num = num;
     return true;
 }
 
 
-bool Preprocessor::has_defined_components(const string& name) {
+bool Preprocessor::is_declared(const string& name) {
+    return is_vector_component(name) || variables->count(name) != 0;
+}
 
-    if (vectors->count(name) == 0) return false;
-    int dimension = vector_dimensions->at(name);
 
-    string component_name;
-    for (int i = 0; i < dimension; i++) {
-        component_name = name + "." + to_string(i);
-        if (defined_variables->count(component_name) > 0) return true;
+VariableType Preprocessor::get_declared_type(const string& name) {
+    Symbol vec;
+    int64_t component_num;
+    if (find_vector_component(name, &vec, &component_num)) return vectors->at(vec);
+
+    unordered_map<Symbol, VariableType>::const_iterator var = variables->find(name);
+    if (var == variables->end()) return VariableType::INVALID_VAR_TYPE;
+    return var->second;
+}
 
-    }
 
-    return false;
+bool Preprocessor::is_defined(const string& name) {
+    Symbol vec;
+    int64_t component_num;
+    if (!find_vector_component(name, &vec, &component_num)) return defined_variables->count(name) != 0;
 
+    // a component is defined along with its whole vector, or by itself
+    if (defined_variables->count(vec) != 0) return true;
+    unordered_map<Symbol, struct component_definitions*>::const_iterator components = defined_components->find(vec);
+    return components != defined_components->end() && components->second->defined[component_num];
 }
- 
 
-bool Preprocessor::all_components_defined(const string& name) {
 
-    if (vectors->count(name) == 0) return false;
-    int dimension = vector_dimensions->at(name);
+void Preprocessor::mark_defined(const string& name) {
+    Symbol vec;
+    int64_t component_num;
+    if (!find_vector_component(name, &vec, &component_num)) {
+        defined_variables->insert(name);
+        return;
+    }
 
-    string component_name;
-    for (int i = 0; i < dimension; i++) {
-        component_name = get_vector_component_name(name, i);
-        if (defined_variables->count(component_name) == 0) {
-            return false;
-        }
+    // the record of which components are defined is only created once one of them is
+    struct component_definitions *&components = (*defined_components)[vec];
+    if (components == NULL) {
+        components = new struct component_definitions();
+        components->defined.resize(vector_dimensions->at(vec), false);
+        components->num_defined = 0;
     }
 
-    return true; 
+    if (!components->defined[component_num]) {
+        components->defined[component_num] = true;
+        components->num_defined++;
+    }
 }
 
 
-string Preprocessor::get_vector_component_name(const string& vec_name, int component_num) {
-    return vec_name + "." + to_string(component_num);
-}
+bool Preprocessor::has_defined_components(const string& name) {
+
+    Symbol vec_symbol(name);
+    if (vectors->count(vec_symbol) == 0) return false;
+    if (defined_variables->count(vec_symbol) != 0) return true;
+
+    unordered_map<Symbol, struct component_definitions*>::const_iterator components = defined_components->find(vec_symbol);
+    return components != defined_components->end() && components->second->num_defined > 0;
 
-string Preprocessor::get_intermediate_name(const string& var_name, int intvar_num) {
-    return var_name + "." + to_string(intvar_num);
 }
+ 
 
+bool Preprocessor::all_components_defined(const string& name) {
 
+    Symbol vec_symbol(name);
+    if (vectors->count(vec_symbol) == 0) return false;
+    if (defined_variables->count(vec_symbol) != 0) return true;
 
+    unordered_map<Symbol, struct component_definitions*>::const_iterator components = defined_components->find(vec_symbol);
+    return components != defined_components->end() && components->second->num_defined == vector_dimensions->at(vec_symbol);
+}
 
+
+string Preprocessor::get_vector_component_name(const string& vec_name, int64_t component_num) {
+    return vec_name + "." + to_string(component_num);
+}
+
+string Preprocessor::get_intermediate_name(const string& var_name, int64_t intvar_num) {
+    return var_name + "." + to_string(intvar_num);
+}
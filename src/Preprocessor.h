@@ -1,6 +1,7 @@
 #ifndef PREPROCESSOR_H
 #define PREPROCESSOR_H
 
+#include <iostream>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -8,6 +9,9 @@
 #include "stdlib.h"
 
 #include "utilities.h"
+#include "Symbol.h"
+#include "LineReader.h"
+#include "OutputSink.h"
 
 using namespace std;
 
@@ -23,6 +27,14 @@ struct macro {
 	int num_references;
 };
 
+/* Records which components of a vector have been defined one at a time (by DEFINE instructions on the components themselves).
+ * It is only created for a vector once one of its components is defined this way.
+ */
+struct component_definitions {
+	vector<bool> defined;
+	int64_t num_defined;
+};
+
 
 
 /* The Preprocessor serves three main functions:
@@ -48,20 +60,36 @@ class Preprocessor {
 
 public:
     
+	/* These tables are keyed on interned names (see Symbol.h), and can be queried with strings.
+	 *
+	 * Vectors are tracked as units: a vector's components are never entered into these tables one by one,
+	 *  so declaring or defining a vector costs the same however many components it has.
+	 * A name like "x.3" is recognized as a component of the vector x (see find_vector_component),
+	 *  which has the vector's type, and is defined if the whole vector is defined, or if it was defined by itself (see defined_components).
+	 */
+
 	/* Maps variable names to their types. */
-	unordered_map<string, VariableType> *variables;
+	unordered_map<Symbol, VariableType> *variables;
 	/* Maps vector names to their types. */
-	unordered_map<string, VariableType> *vectors;
+	unordered_map<Symbol, VariableType> *vectors;
 	/* Maps vector names to their dimensions. */
-	unordered_map<string, int> *vector_dimensions;
+	unordered_map<Symbol, int64_t> *vector_dimensions;
 	/* A set of which variables have been defined. */
-	unordered_set<string> *defined_variables;
+	unordered_set<Symbol> *defined_variables;
+	/* Maps vector names to the components of the vector that have been defined one at a time. */
+	unordered_map<Symbol, struct component_definitions*> *defined_components;
 	/* Maps macro names to their definitions. */
 	unordered_map<string, struct macro*>* macros;
 
 	/* This boolean is used to ensure all the macro definitions occur at the top. */
 	bool macros_done;
 
+	/* If true, dot products and reductions by add or mul are expanded as balanced trees, not chains (see set_tree_reductions). */
+	bool tree_reductions;
+
+	/* If true, the Expanded Program file is written by a background thread (see set_background_writer). */
+	bool background_writer;
+
 
 
 	/* Constructor.
@@ -76,6 +104,25 @@ public:
     ~Preprocessor();
 
 
+    /* Chooses how dot products and vector reductions are expanded. By default they are expanded as chains:
+     *  each intermediate sum adds the next component to the previous sum, so the last sum is DIMENSION - 1 additions deep.
+     * With TREE_REDUCTIONS, they are expanded as balanced trees of pairwise sums, which are only about log2(DIMENSION) additions deep.
+     * The sums of a tree level do not depend on each other, so they can be run in parallel,
+     *  and the backward pass the Compiler builds from the tree is just as shallow.
+     * Pairwise summation also rounds less than a chain: its error grows with log2(DIMENSION), not DIMENSION.
+     *
+     * Only associative operations can be regrouped, so reductions by any other primitive, and by macros, are always chains.
+     * The tree has as many intermediate variables as the chain, with the same names, so only their definitions change.
+     */
+    void set_tree_reductions(bool tree_reductions);
+
+    /* Chooses whether the file version of expand_program writes the Expanded Program from a background thread.
+     * The Expanded Program file is always written through an OutputSink, in large blocks (see OutputSink.h).
+     * With BACKGROUND_WRITER, each full block is written by a writer thread while the next one is expanded. This is off by default.
+     */
+    void set_background_writer(bool background_writer);
+
+
     /* ------------------------------------- Main Methods -------------------------------------- */
 
 
@@ -137,6 +184,16 @@ public:
      */
     int expand_program(const string& shape_prog_filename, const string& expanded_shape_prog_filename);
 
+    /* Expands the program read from PROG, writing the Expanded Program to EXP_PROG (see above).
+     * The streams may be files or in-memory strings, so a program can be expanded without touching the disk.
+     * The file version above reads the Program through a memory mapping (see LineReader.h).
+     * On failure, the lines already written to EXP_PROG are left in it; the file version above clears its file.
+     *
+     * Returns 0 on success, and the appropriate error code otherwise (see utilities.h).
+     */
+    int expand_program(istream& prog, ostream& exp_prog);
+    int expand_program(LineReader& prog, ostream& exp_prog);
+
     /* Writes the appropriate expansion of PROG_LINE into EXP_PROG.
      * See the comment for the expand_program for details on what "expansion" entails.
      * If no expansion is needed, then the line is copied directly into EXP_PROG.
@@ -145,7 +202,7 @@ public:
      * This is 1 if no expansion was needed, and the appropriate error code (see utilities.h) if the given line was invalid.
      * Returns 0 if prog_line is an empty line.
      */
-    int expand_line(const string& prog_line, ofstream& exp_prog); 
+    int64_t expand_line(const string& prog_line, ostream& exp_prog); 
 
 
 
@@ -163,7 +220,7 @@ public:
      *
      * This method returns the dimension of the vector, which will always be a positive integer.
      */
-    int expand_declare_vector_instruction(const string& line, ofstream& exp_prog);
+    int64_t expand_declare_vector_instruction(const string& line, ostream& exp_prog);
 
     /* Expands a DEFINE instruction, copying the expanded lines into EXP_PROG.
      * DEFINE instructions need expanding if they involve vector operations or user-defined macros.
@@ -173,7 +230,7 @@ public:
      * If the instruction requires no expanding, nothing is done and 0 is returned.
      * Otherwise, this method returns the number of expanded lines.
      */
-    int expand_define_instruction(const string& line, ofstream& exp_prog);
+    int64_t expand_define_instruction(const string& line, ostream& exp_prog);
 
     /* Expands a DEFINE_VECTOR instruction, copying the expanded lines into EXP_PROG.
      * DEFINE_VECTOR instructions define a vector, as opposed to DEFINE instructions which define a scalar variable.
@@ -198,7 +255,7 @@ public:
      *
      * This method returns the number of expanded lines, which is equal to the dimension of the vectors involved.
      */
-    int expand_define_vector_instruction(const string& line, ofstream &exp_prog);
+    int64_t expand_define_vector_instruction(const string& line, ostream& exp_prog);
 
     /* This method expands a DEFINE instruction that defines a variable/vector as the result of a vector operation.
 	 * RESULT is the variable/vector being defined, and OPERAND1 and OPERAND2 are the operand vectors/constants/variables.
@@ -209,8 +266,8 @@ public:
 	 * The expanded lines are written into EXP_PROG.
 	 * Returns the number of expanded lines.
 	 */
-	int expand_vector_operation(const OperationType& oper_type, const string& result, const string& operand1, const string& operand2,
-    	ofstream& exp_prog);
+	int64_t expand_vector_operation(const OperationType& oper_type, const string& result, const string& operand1, const string& operand2,
+    	ostream& exp_prog);
 
 
 	/* ------------------------------------ Helper Macro Expansion Methods ----------------------------------- */
@@ -227,12 +284,12 @@ public:
      * Returns the number of expanded lines.
      */
     int expand_unary_macro(const string& macro_name, const string& operand, const string& result, 
-    	ofstream& exp_prog);
+    	ostream& exp_prog);
 
     /* Does the same thing as expand_unary_macro, but for a binary macro.
      */
 	int expand_binary_macro(const string& macro_name, const string& operand1, const string& operand2, const string& result, 
-    	ofstream& exp_prog);
+    	ostream& exp_prog);
 
 	/* Replaces all the dummy variable names in DUMMY_LINE with the appropriate argument names RESULT, OPERAND1, and OPERAND2.
 	 * For example, "substitute_dummy_names('define r = mul p q', r, p, q, z, x, y)" would return 'define z = mul x y'
@@ -271,11 +328,15 @@ public:
      * "define dot_prod.2 = mul a.2 b.2"
      * "define dot_prod = add dot_prod.1 dot_prod.2"
      *
+     * With tree reductions (see set_tree_reductions), the products are summed pairwise instead.
+     * For four-element vectors, the sums are "dot_prod.4 = add dot_prod.0 dot_prod.1", "dot_prod.5 = add dot_prod.2 dot_prod.3",
+     *  and "dot_prod.6 = add dot_prod.4 dot_prod.5".
+     *
      * The expanded lines are written into EXP_PROG.
      * Returns the number of expanded lines.
      */
-	int expand_dot_product_instruction(const string& result, const string& vector1, const string& vector2, int dimension,
-    	ofstream& exp_prog);
+	int64_t expand_dot_product_instruction(const string& result, const string& vector1, const string& vector2, int64_t dimension,
+    	ostream& exp_prog);
 
 
     /* Expands a DEFINE instruction that defines a variable RESULT as the reduction of the given vector VEC.
@@ -292,11 +353,25 @@ public:
      * "define z.1 = add z.0 u.2"
      * "define z = z.1"
      *
+     * With tree reductions (see set_tree_reductions), reductions by add or mul combine the components pairwise instead.
+     *
      * The expanded lines are written into EXP_PROG.
      * Returns the number of expanded_lines.
      */
-    int expand_reduce_vector_instruction(const string& result, const string& vec,
-    const string& func, int dimension, ofstream& exp_prog);
+    int64_t expand_reduce_vector_instruction(const string& result, const string& vec,
+    const string& func, int64_t dimension, ostream& exp_prog);
+
+    /* Combines the NUM_TERMS terms "TERMS.0", "TERMS.1", ... with the binary primitive FUNC as a balanced tree,
+     *  declaring and defining one intvar per sum: "INTERMEDIATES.FIRST_INTERMEDIATE", "INTERMEDIATES.FIRST_INTERMEDIATE+1", and so on.
+     * Each level of the tree combines neighbouring pairs of the previous level; an odd term out is carried up to the next level.
+     * There is one fewer intermediate than terms, and the last intermediate holds the whole reduction.
+     * Each node of a level is found from its position by index arithmetic, so no level is stored, and the tree takes the same memory whatever NUM_TERMS is.
+     *
+     * The expanded lines are written into EXP_PROG.
+     * Returns the number of expanded lines.
+     */
+    int64_t expand_reduction_tree(const string& terms, int64_t num_terms, const string& intermediates, int64_t first_intermediate,
+        const string& func, ostream& exp_prog);
 
 	/* Expands a DEFINE instruction that defines a vector RESULT_VEC as the result of component-wise addition between VECTOR1 and VECTOR2.
      * This operation gets broken up into several scalar additions.
@@ -308,8 +383,8 @@ public:
      * The expanded lines are written into EXP_PROG.
      * Returns the number of expanded lines.
      */
-	int expand_component_wise_add_instruction(const string& result_vec, const string& vector1, const string& vector2, int dimension, 
-    	ofstream& exp_prog);
+	int64_t expand_component_wise_add_instruction(const string& result_vec, const string& vector1, const string& vector2, int64_t dimension, 
+    	ostream& exp_prog);
 
 	/* Expands a DEFINE instruction that defines a vector RESULT_VEC as the result of component-wise multiplication between VECTOR1 and VECTOR2.
      * This operation gets broken up into several scalar multiplications.
@@ -321,8 +396,8 @@ public:
      * The expanded lines are written into EXP_PROG.
      * Returns the number of expanded lines.
      */
-	int expand_component_wise_mul_instruction(const string& result_vec, const string& vector1, const string& vector2, int dimension, 
-    	ofstream& exp_prog);
+	int64_t expand_component_wise_mul_instruction(const string& result_vec, const string& vector1, const string& vector2, int64_t dimension, 
+    	ostream& exp_prog);
 
 	/* Expands a DEFINE instruction that defines a vector RESULT_VEC as the result scaling VECTOR by the given SCALING_FACTOR.
 	 * The scaling factor could be a variable or a constant.
@@ -337,8 +412,8 @@ public:
      * The expanded lines are written into EXP_PROG.
      * Returns the number of expanded lines.
      */
-	int expand_scale_vector_instruction(const string& result_vec, const string& vector1, const string& scaling_factor, int dimension,
-		ofstream& exp_prog);
+	int64_t expand_scale_vector_instruction(const string& result_vec, const string& vector1, const string& scaling_factor, int64_t dimension,
+		ostream& exp_prog);
 
 	/* Expands a DEFINE instruction that defines a vector RESULT_VEC as the result incrementing each component in VECTOR by the given INCREMENTING_FACTOR.
 	 * The incrementing factor could be a variable or a constant.
@@ -353,8 +428,8 @@ public:
      * The expanded lines are written into EXP_PROG.
      * Returns the number of expanded lines.
      */
-	int expand_increment_vector_instruction(const string& result_vec, const string& vector1, const string& incrementing_factor, int dimension, 
-    	ofstream& exp_prog);
+	int64_t expand_increment_vector_instruction(const string& result_vec, const string& vector1, const string& incrementing_factor, int64_t dimension, 
+    	ostream& exp_prog);
 
 
 
@@ -488,7 +563,30 @@ public:
      */
     bool is_vector_component(const string& name);
 
+    /* If the given NAME is a component of a vector that has been previously declared (see is_vector_component),
+     *  sets VEC to the vector and COMPONENT_NUM to the component's number, and returns true. Returns false otherwise.
+     * The vector's name is looked up without interning NAME, so component names are never added to the Symbol Table.
+     */
+    bool find_vector_component(const string& name, Symbol *vec, int64_t *component_num);
+
+    /* Returns true if the given NAME is a declared variable, or a component of a declared vector, and false otherwise. */
+    bool is_declared(const string& name);
+
+    /* Returns the type of the given declared variable or vector component NAME (a component has the type of its vector).
+     * Returns INVALID_VAR_TYPE if NAME has not been declared.
+     */
+    VariableType get_declared_type(const string& name);
+
+    /* Returns true if the given variable or vector component NAME has been defined, and false otherwise.
+     * A component is defined if its whole vector is defined, or if the component itself was defined.
+     */
+    bool is_defined(const string& name);
+
+    /* Marks the given variable or vector component NAME as defined. */
+    void mark_defined(const string& name);
+
     /* Returns true if the vector by the given NAME has had any of its components defined.
+     * This, and all_components_defined, take constant time: they count the defined components instead of checking each one.
      * Recall that a vector can be defined using the DEFINE_VECTOR instruction, or its components can be individually defined.
      * The DEFINE_VECTOR instruction defines the vector and all of its components.
      *
@@ -510,12 +608,12 @@ public:
     /* Returns the name of the COMPONENT_NUMth component of the vector with the given VEC_NAME.
      * ex. get_vector_component_name("my_vec", 3) = "my_vec.3"
      */
-    string get_vector_component_name(const string& vec_name, int component_num);
+    string get_vector_component_name(const string& vec_name, int64_t component_num);
 
     /* Returns the name of the INTVAR_NUMth intermediate variable of the VAR_NAME.
      * ex. get_intermediate_name("my_var", 3) = "my_var.3"
      */
-    string get_intermediate_name(const string& var_name, int intvar_num);
+    string get_intermediate_name(const string& var_name, int64_t intvar_num);
 
 	
 };
@@ -0,0 +1,736 @@
+#include <iostream>
+#include <fstream>
+#include <cfloat>
+#include <cmath>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "Program.h"
+#include "Interpreter.h"
+#include "utilities.h"
+
+using namespace std;
+
+
+/* ---------------- Constructor/Destructor --------------- */
+
+Program::Program() {
+	instructions = new vector<Instruction>();
+	vector_instructions = new vector<VectorInstruction>();
+	vectorized = false;
+	slot_names = new vector<Symbol>();
+	slot_types = new vector<VariableType>();
+	initial_values = new vector<double>();
+	slots = new unordered_map<Symbol, uint32_t>();
+	max_slots = MAX_SLOTS;
+	input_slots = new vector<uint32_t>();
+	input_names = new vector<string>();
+	output_slots = new vector<uint32_t>();
+	output_names = new vector<string>();
+	defined = new vector<bool>();
+	line_tokens = new vector<Token>();
+	loss_slot = INVALID_SLOT;
+	input_vectors = new unordered_map<Symbol, InputVector>();
+	zero_sources = new vector<uint32_t>();
+}
+
+
+Program::~Program() {
+	delete instructions;
+	delete vector_instructions;
+	delete slot_names;
+	delete slot_types;
+	delete initial_values;
+	delete slots;
+	delete input_slots;
+	delete input_names;
+	delete output_slots;
+	delete output_names;
+	delete defined;
+	delete line_tokens;
+	delete input_vectors;
+	delete zero_sources;
+}
+
+
+/* ---------------- Loading -------------- */
+
+int Program::load(const string& filename) {
+
+	LineReader prog;
+	if (prog.open(filename) != 0) {
+		cerr << "\nCould not load the program " << filename << endl << endl;
+		return OTHER_ERROR;
+	}
+
+	return load(prog);
+}
+
+
+int Program::load(istream& prog) {
+	LineReader reader(prog);
+	return load(reader);
+}
+
+
+int Program::load(LineReader& prog) {
+
+	if (get_num_slots() != 0) return OTHER_ERROR;
+
+	// the line read from the program, which is not copied
+	const char *line;
+	size_t length;
+
+	// Iterate through all the lines of the program, and parse each one
+	int line_num = 0;
+	while (prog.next_line(&line, &length)) {
+
+		int parse_success = parse_line(line, length);
+		// if there was an error with this line of the program, print the error message and exit
+		if (parse_success != 0) {
+			cerr << "\nERROR, Line " << line_num << ":" << endl;
+			cerr.write(line, length) << endl;
+			cerr << get_error_message(parse_success) << endl << endl;
+			return parse_success;
+		}
+
+		line_num++;
+	}
+
+	vectorize();
+	return 0;
+}
+
+
+uint32_t Program::add_slot(Symbol name, VariableType type, double initial_value) {
+	if (slot_names->size() >= max_slots) return INVALID_SLOT;
+	uint32_t slot = slot_names->size();
+	slot_names->push_back(name);
+	slot_types->push_back(type);
+	initial_values->push_back(initial_value);
+	defined->push_back(type == VariableType::CONSTANT);
+	zero_sources->push_back(INVALID_SLOT);
+	(*slots)[name] = slot;
+	return slot;
+}
+
+
+void Program::set_max_slots(uint32_t max_slots) {
+	this->max_slots = max_slots;
+}
+
+
+uint32_t Program::get_operand_slot(const Token& operand) {
+	Symbol name(operand.start, operand.length);
+	unordered_map<Symbol, uint32_t>::const_iterator it = slots->find(name);
+	if (it != slots->end()) return it->second;
+
+	// constants are read the same way the Interpreter reads them, at float precision
+	if (operand.token_class == TokenClass::NUMBER) {
+		return add_slot(name, VariableType::CONSTANT, (float) operand.number);
+	}
+
+	return INVALID_SLOT;
+}
+
+
+int Program::parse_line(const string& line) {
+	return parse_line(line.data(), line.length());
+}
+
+
+int Program::parse_line(const char *line, size_t length) {
+
+	if (length == 0) return 0;
+
+	// lex the line
+	vector<Token>& tokens = *line_tokens;
+	int num_tokens = lex_line(line, length, ' ', &tokens);
+	if (num_tokens < 3) return INVALID_LINE;
+
+	InstructionType inst_type = tokens[0].instruction_type;
+	if (inst_type == InstructionType::INVALID_INST) return INVALID_LINE;
+
+	// If the line is a declaration of a variable, give the variable a slot.
+	// Inputs, weights and expected outputs are defined by the values given to each run.
+	if (inst_type == InstructionType::DECLARE) {
+
+		if (num_tokens != 3) return INVALID_LINE;
+
+		VariableType var_type = tokens[1].variable_type;
+		if (var_type == VariableType::INVALID_VAR_TYPE) return INVALID_LINE;
+
+		if (!is_valid_expanded_var_name(tokens[2])) return INVALID_VAR_NAME;
+		Symbol var_name(tokens[2].start, tokens[2].length);
+		if (get_slot(var_name) != INVALID_SLOT) return VAR_DECLARED_TWICE;
+
+		uint32_t slot = add_slot(var_name, var_type, DBL_MAX);
+		if (slot == INVALID_SLOT) return TOO_MANY_VARIABLES;
+
+		if (var_type == VariableType::INPUT || var_type == VariableType::WEIGHT || var_type == VariableType::EXP_OUTPUT) {
+			(*defined)[slot] = true;
+			(*zero_sources)[slot] = slot;
+			input_slots->push_back(slot);
+			input_names->push_back(var_name.str());
+			add_input_component(tokens[2], slot);
+		}
+		else if (var_type == VariableType::OUTPUT) {
+			output_slots->push_back(slot);
+			output_names->push_back(var_name.str());
+		}
+		else if (var_type == VariableType::LOSS) {
+			loss_slot = slot;
+		}
+
+		return 0;
+	}
+
+	// If the line is the definition of a variable, add the Instruction that computes it.
+	// The variable must have been declared, but not defined, and its operands must have been defined.
+	else if (inst_type == InstructionType::DEFINE) {
+
+		if (num_tokens < 4) return INVALID_LINE;
+
+		if (!is_valid_expanded_var_name(tokens[1])) return INVALID_VAR_NAME;
+
+		uint32_t result = get_slot(Symbol(tokens[1].start, tokens[1].length));
+		if (result == INVALID_SLOT || (*slot_types)[result] == VariableType::CONSTANT) return VAR_DEFINED_BEFORE_DECLARED;
+		if ((*defined)[result]) return VAR_DEFINED_TWICE;
+
+		Instruction instruction;
+		instruction.result = result;
+		instruction.operand2 = INVALID_SLOT;
+
+		// A variable is defined in one of three ways:
+		// 1. As a constant, or as equivalent to another variable (both are copies)
+		// 2. As a binary operation of two variables/constants
+		// 3. As a unary operation of a variable/constant
+		OperationType operation = tokens[3].operation_type;
+		int operand1_token = 4;
+
+		if (operation == OperationType::INVALID_OPERATION) {
+			if (num_tokens != 4) return INVALID_LINE;
+			operand1_token = 3;
+			instruction.operand1 = get_operand_slot(tokens[3]);
+		}
+		else if (is_binary_primitive(operation)) {
+			if (num_tokens != 6) return INVALID_LINE;
+			instruction.operand1 = get_operand_slot(tokens[4]);
+			instruction.operand2 = get_operand_slot(tokens[5]);
+			// a constant only has no slot if there was none left for it
+			if (instruction.operand2 == INVALID_SLOT && tokens[5].token_class == TokenClass::NUMBER) return TOO_MANY_VARIABLES;
+			if (instruction.operand2 == INVALID_SLOT || !(*defined)[instruction.operand2]) return VAR_REFERENCED_BEFORE_DEFINED;
+		}
+		else if (is_unary_primitive(operation)) {
+			if (num_tokens != 5) return INVALID_LINE;
+			instruction.operand1 = get_operand_slot(tokens[4]);
+		}
+		else return INVALID_LINE;
+
+		if (instruction.operand1 == INVALID_SLOT && tokens[operand1_token].token_class == TokenClass::NUMBER) return TOO_MANY_VARIABLES;
+		if (instruction.operand1 == INVALID_SLOT || !(*defined)[instruction.operand1]) return VAR_REFERENCED_BEFORE_DEFINED;
+
+		instruction.operation = operation;
+		instructions->push_back(instruction);
+		(*defined)[result] = true;
+		(*zero_sources)[result] = get_zero_source(instruction);
+		vectorized = false;
+		return 0;
+	}
+
+	return INVALID_LINE;
+}
+
+
+
+void Program::add_input_component(const Token& name, uint32_t slot) {
+	size_t vec_name_length;
+	int64_t component_num;
+	if (!split_vector_component(name.start, name.length, &vec_name_length, &component_num)) return;
+
+	// a new entry has no components; the vector stays contiguous while each component follows the one before it
+	InputVector& vec = (*input_vectors)[Symbol(name.start, vec_name_length)];
+	if (vec.dimension == 0 && component_num == 0) {
+		vec.first_slot = slot;
+		vec.contiguous = true;
+	} else if (!vec.contiguous || component_num != vec.dimension || slot != vec.first_slot + vec.dimension) {
+		vec.contiguous = false;
+	}
+	vec.dimension++;
+}
+
+
+uint32_t Program::get_zero_source(const Instruction& instruction) const {
+	uint32_t source1 = (*zero_sources)[instruction.operand1];
+	uint32_t source2 = instruction.operand2 == INVALID_SLOT ? INVALID_SLOT : (*zero_sources)[instruction.operand2];
+
+	switch (instruction.operation) {
+		case OperationType::INVALID_OPERATION:
+			return source1;
+		case OperationType::MUL:
+			return source1 != INVALID_SLOT ? source1 : source2;
+		case OperationType::ADD:
+		case OperationType::SUB:
+			return source1 == source2 ? source1 : INVALID_SLOT;
+		case OperationType::POW:
+			if ((*slot_types)[instruction.operand2] == VariableType::CONSTANT && (*initial_values)[instruction.operand2] > 0) return source1;
+			return INVALID_SLOT;
+		default:
+			return INVALID_SLOT;
+	}
+}
+
+
+
+/* ---------------- Vectorizing -------------- */
+
+/* Marks an entry of an index table with no Instruction. */
+#define NO_INSTRUCTION UINT32_MAX
+
+
+/* Returns the stride that takes lane 0's OPERAND to lane 1's NEXT_OPERAND, or 2 if there is none (see VectorInstruction). */
+static uint8_t get_stride(uint32_t operand, uint32_t next_operand) {
+	if (next_operand == operand) return 0;
+	if (operand != INVALID_SLOT && next_operand == operand + 1) return 1;
+	return 2;
+}
+
+
+uint32_t Program::vectorize() {
+
+	uint32_t num_slots = get_num_slots();
+	uint32_t num_instructions = get_num_instructions();
+
+	// the Instruction that defines each slot, and the first Instruction that uses it
+	// every slot is defined once, and used only after it is defined
+	vector<uint32_t> defining_instruction(num_slots, NO_INSTRUCTION), first_use(num_slots, NO_INSTRUCTION);
+	for (uint32_t i = 0; i < num_instructions; i++) {
+		const Instruction& inst = (*instructions)[i];
+		defining_instruction[inst.result] = i;
+		if (first_use[inst.operand1] == NO_INSTRUCTION) first_use[inst.operand1] = i;
+		if (inst.operand2 != INVALID_SLOT && first_use[inst.operand2] == NO_INSTRUCTION) first_use[inst.operand2] = i;
+	}
+
+	// the Vector Instruction run in place of each packed Instruction's group, at the group's last Instruction
+	vector<bool> packed(num_instructions, false);
+	vector<uint32_t> group_at(num_instructions, NO_INSTRUCTION);
+	vector<VectorInstruction> groups;
+	uint32_t num_packed = 0;
+
+	for (uint32_t slot = 0; slot < num_slots; slot++) {
+		uint32_t first = defining_instruction[slot];
+		if (first == NO_INSTRUCTION || packed[first]) continue;
+		const Instruction& lane_zero = (*instructions)[first];
+
+		VectorInstruction group = {lane_zero.operation, slot, lane_zero.operand1, lane_zero.operand2, 1, 0, 0};
+		uint32_t last = first;
+		uint32_t next_use = first_use[slot];
+
+		// grow the group while the next slot is defined by an isomorphic Instruction that can run with the others
+		while (slot + group.width < num_slots) {
+			uint32_t i = defining_instruction[slot + group.width];
+			if (i == NO_INSTRUCTION || packed[i]) break;
+			const Instruction& lane = (*instructions)[i];
+			if (lane.operation != lane_zero.operation) break;
+
+			// the second lane fixes the strides, and every other lane must follow them
+			if (group.width == 1) {
+				group.stride1 = get_stride(lane_zero.operand1, lane.operand1);
+				group.stride2 = get_stride(lane_zero.operand2, lane.operand2);
+				if (group.stride1 > 1 || group.stride2 > 1) break;
+			}
+			if (lane.operand1 != lane_zero.operand1 + group.width * group.stride1) break;
+			if (lane_zero.operand2 == INVALID_SLOT ? lane.operand2 != INVALID_SLOT :
+				lane.operand2 != lane_zero.operand2 + group.width * group.stride2) break;
+
+			// the group runs at its last Instruction, so no result may be used before then
+			// this also keeps a lane from using the result of another lane
+			uint32_t new_last = max(last, i);
+			uint32_t new_next_use = min(next_use, first_use[slot + group.width]);
+			if (new_next_use != NO_INSTRUCTION && new_next_use <= new_last) break;
+
+			last = new_last;
+			next_use = new_next_use;
+			group.width++;
+		}
+
+		if (group.width < 2) continue;
+		for (uint32_t lane = 0; lane < group.width; lane++) packed[defining_instruction[slot + lane]] = true;
+		group_at[last] = groups.size();
+		groups.push_back(group);
+		num_packed += group.width;
+	}
+
+	// the plan runs every Instruction in order, except packed Instructions, which run as their group
+	vector_instructions->clear();
+	for (uint32_t i = 0; i < num_instructions; i++) {
+		const Instruction& inst = (*instructions)[i];
+		if (!packed[i]) {
+			VectorInstruction scalar = {inst.operation, inst.result, inst.operand1, inst.operand2, 1, 0, 0};
+			vector_instructions->push_back(scalar);
+		} else if (group_at[i] != NO_INSTRUCTION) {
+			vector_instructions->push_back(groups[group_at[i]]);
+		}
+	}
+
+	vectorized = true;
+	return num_packed;
+}
+
+
+
+/* ---------------- Execution -------------- */
+
+void Program::init_values(vector<double> *values) const {
+	values->assign(initial_values->begin(), initial_values->end());
+}
+
+
+int Program::bind_inputs(const unordered_map<string, double>& inputs, vector<double> *values) const {
+	for (size_t i = 0; i < input_slots->size(); i++) {
+		unordered_map<string, double>::const_iterator it = inputs.find((*input_names)[i]);
+		if (it == inputs.end()) return INPUT_VALUE_NOT_PROVIDED;
+		if (it->second == DBL_MIN || it->second == DBL_MAX) return OTHER_ERROR;
+		(*values)[(*input_slots)[i]] = it->second;
+	}
+	return 0;
+}
+
+
+/* Runs the binary operation of INST, which is ADD, SUB or MUL, on every lane, two lanes at a time where SSE2 is available.
+ * The operands of an Instruction are never DBL_MIN or DBL_MAX (see run), so this computes what apply_binary_operation does,
+ *  except for the checks of the results.
+ */
+static void run_arithmetic_kernel(const VectorInstruction& inst, double *vals) {
+	const double *operand1 = vals + inst.operand1;
+	const double *operand2 = vals + inst.operand2;
+	double *result = vals + inst.result;
+	uint32_t lane = 0;
+
+#ifdef __SSE2__
+	for (; lane + 2 <= inst.width; lane += 2) {
+		__m128d a = inst.stride1 == 0 ? _mm_set1_pd(*operand1) : _mm_loadu_pd(operand1 + lane);
+		__m128d b = inst.stride2 == 0 ? _mm_set1_pd(*operand2) : _mm_loadu_pd(operand2 + lane);
+		__m128d c;
+		if (inst.operation == OperationType::ADD) c = _mm_add_pd(a, b);
+		else if (inst.operation == OperationType::SUB) c = _mm_sub_pd(a, b);
+		else c = _mm_mul_pd(a, b);
+		_mm_storeu_pd(result + lane, c);
+	}
+#endif
+
+	for (; lane < inst.width; lane++) {
+		double a = operand1[lane * inst.stride1], b = operand2[lane * inst.stride2];
+		if (inst.operation == OperationType::ADD) result[lane] = a + b;
+		else if (inst.operation == OperationType::SUB) result[lane] = a - b;
+		else result[lane] = a * b;
+	}
+}
+
+
+/* Runs a Vector Instruction of width 2 or more on VALS.
+ * Returns INVALID_LINE if a lane's result is one apply_binary_operation or apply_unary_operation would refuse, and 0 otherwise.
+ */
+static int run_vector_instruction(const VectorInstruction& inst, double *vals) {
+	double *result = vals + inst.result;
+
+	if (inst.operation == OperationType::ADD || inst.operation == OperationType::SUB || inst.operation == OperationType::MUL) {
+		run_arithmetic_kernel(inst, vals);
+
+		// apply_binary_operation turns NaN sums and products (but not differences) into DBL_MIN
+		bool nan_fails = inst.operation != OperationType::SUB;
+		for (uint32_t lane = 0; lane < inst.width; lane++) {
+			if (result[lane] == DBL_MIN || result[lane] == DBL_MAX || (nan_fails && std::isnan(result[lane]))) return INVALID_LINE;
+		}
+		return 0;
+	}
+
+	for (uint32_t lane = 0; lane < inst.width; lane++) {
+		double operand1 = vals[inst.operand1 + lane * inst.stride1];
+		double value;
+		if (inst.operation == OperationType::INVALID_OPERATION) {
+			value = operand1;
+		} else if (inst.operand2 != INVALID_SLOT) {
+			value = apply_binary_operation(inst.operation, operand1, vals[inst.operand2 + lane * inst.stride2]);
+		} else {
+			value = apply_unary_operation(inst.operation, operand1);
+		}
+
+		if (value == DBL_MIN || value == DBL_MAX) return INVALID_LINE;
+		result[lane] = value;
+	}
+	return 0;
+}
+
+
+int Program::run(vector<double> *values) const {
+	if (vectorized) return run_vectorized(values);
+
+	double *vals = values->data();
+	const Instruction *inst = instructions->data();
+	const Instruction *end = inst + instructions->size();
+
+	for (; inst != end; ++inst) {
+		double value;
+		if (inst->operation == OperationType::INVALID_OPERATION) {
+			value = vals[inst->operand1];
+		} else if (inst->operand2 != INVALID_SLOT) {
+			value = apply_binary_operation(inst->operation, vals[inst->operand1], vals[inst->operand2]);
+		} else {
+			value = apply_unary_operation(inst->operation, vals[inst->operand1]);
+		}
+
+		// the Interpreter refuses to bind these values, so the run fails here too
+		if (value == DBL_MIN || value == DBL_MAX) return INVALID_LINE;
+		vals[inst->result] = value;
+	}
+
+	return 0;
+}
+
+
+int Program::run_vectorized(vector<double> *values) const {
+	double *vals = values->data();
+	const VectorInstruction *inst = vector_instructions->data();
+	const VectorInstruction *end = inst + vector_instructions->size();
+
+	for (; inst != end; ++inst) {
+		if (inst->width != 1) {
+			int success = run_vector_instruction(*inst, vals);
+			if (success != 0) return success;
+			continue;
+		}
+
+		double value;
+		if (inst->operation == OperationType::INVALID_OPERATION) {
+			value = vals[inst->operand1];
+		} else if (inst->operand2 != INVALID_SLOT) {
+			value = apply_binary_operation(inst->operation, vals[inst->operand1], vals[inst->operand2]);
+		} else {
+			value = apply_unary_operation(inst->operation, vals[inst->operand1]);
+		}
+
+		if (value == DBL_MIN || value == DBL_MAX) return INVALID_LINE;
+		vals[inst->result] = value;
+	}
+
+	return 0;
+}
+
+
+int Program::execute(const unordered_map<string, double>& inputs, unordered_map<string, double> *outputs) const {
+	vector<double> values;
+	init_values(&values);
+
+	int success = bind_inputs(inputs, &values);
+	if (success == 0) success = run(&values);
+	if (success != 0) {
+		cerr << "\nERROR: " << get_error_message(success) << endl << endl;
+		return success;
+	}
+
+	for (size_t i = 0; i < output_slots->size(); i++) {
+		outputs->insert(make_pair((*output_names)[i], values[(*output_slots)[i]]));
+	}
+	return 0;
+}
+
+
+
+/* ---------------- Sparse Execution -------------- */
+
+int Program::bind_values(const unordered_map<string, double>& named_values, vector<double> *values) const {
+	for (unordered_map<string, double>::const_iterator it = named_values.begin(); it != named_values.end(); ++it) {
+		uint32_t slot = get_slot(Symbol::find(it->first));
+		if (slot == INVALID_SLOT) continue;
+		VariableType type = (*slot_types)[slot];
+		if (type != VariableType::INPUT && type != VariableType::WEIGHT && type != VariableType::EXP_OUTPUT) continue;
+
+		if ((*values)[slot] != DBL_MAX) return VAR_DECLARED_TWICE;
+		if (it->second == DBL_MIN || it->second == DBL_MAX) return OTHER_ERROR;
+		(*values)[slot] = it->second;
+	}
+	return 0;
+}
+
+
+int Program::bind_sparse_values(const SparseVariableVector& sparse_values, vector<double> *values) const {
+	for (SparseVariableVector::const_iterator it = sparse_values.begin(); it != sparse_values.end(); ++it) {
+		const InputVector *vec = get_input_vector(Symbol::find(it->first));
+		if (vec == NULL) continue;
+		if (!vec->contiguous) return OTHER_ERROR;
+
+		// every component is bound, so the unlisted ones are set to 0 in one pass
+		double *components = values->data() + vec->first_slot;
+		for (uint32_t i = 0; i < vec->dimension; i++) {
+			if (components[i] != DBL_MAX) return VAR_DECLARED_TWICE;
+			components[i] = 0;
+		}
+
+		// a component beyond the end of the vector means the data was not made for this program
+		const SparseVector& sparse = it->second;
+		for (size_t i = 0; i < sparse.indices.size(); i++) {
+			if (sparse.indices[i] >= vec->dimension) return VECTORS_OF_DIFFERENT_DIMENSION;
+			if (sparse.values[i] == DBL_MIN || sparse.values[i] == DBL_MAX) return OTHER_ERROR;
+			components[sparse.indices[i]] = sparse.values[i];
+		}
+	}
+	return 0;
+}
+
+
+int Program::check_inputs_bound(const vector<double>& values) const {
+	for (size_t i = 0; i < input_slots->size(); i++) {
+		if (values[(*input_slots)[i]] == DBL_MAX) return INPUT_VALUE_NOT_PROVIDED;
+	}
+	return 0;
+}
+
+
+/* Computes the value of lane LANE of INST on VALS, as run does, and writes it to its result.
+ * Returns INVALID_LINE if the value is one run refuses, and 0 otherwise.
+ */
+static int run_lane(const VectorInstruction& inst, uint32_t lane, double *vals) {
+	double operand1 = vals[inst.operand1 + lane * inst.stride1];
+	double value;
+	if (inst.operation == OperationType::INVALID_OPERATION) {
+		value = operand1;
+	} else if (inst.operand2 != INVALID_SLOT) {
+		value = apply_binary_operation(inst.operation, operand1, vals[inst.operand2 + lane * inst.stride2]);
+	} else {
+		value = apply_unary_operation(inst.operation, operand1);
+	}
+
+	if (value == DBL_MIN || value == DBL_MAX) return INVALID_LINE;
+	vals[inst.result + lane] = value;
+	return 0;
+}
+
+
+int Program::run_sparse(vector<double> *values) const {
+	double *vals = values->data();
+	const uint32_t *sources = zero_sources->data();
+
+	if (!vectorized) {
+		for (size_t i = 0; i < instructions->size(); i++) {
+			const Instruction& inst = (*instructions)[i];
+			uint32_t source = sources[inst.result];
+			if (source != INVALID_SLOT && vals[source] == 0) {
+				vals[inst.result] = 0;
+				continue;
+			}
+			VectorInstruction scalar = {inst.operation, inst.result, inst.operand1, inst.operand2, 1, 0, 0};
+			int success = run_lane(scalar, 0, vals);
+			if (success != 0) return success;
+		}
+		return 0;
+	}
+
+	for (size_t i = 0; i < vector_instructions->size(); i++) {
+		const VectorInstruction& inst = (*vector_instructions)[i];
+
+		// the lanes of a group are isomorphic, so if the first lane has no zero source, the group runs whole
+		if (inst.width != 1 && sources[inst.result] == INVALID_SLOT) {
+			int success = run_vector_instruction(inst, vals);
+			if (success != 0) return success;
+			continue;
+		}
+
+		for (uint32_t lane = 0; lane < inst.width; lane++) {
+			uint32_t source = sources[inst.result + lane];
+			if (source != INVALID_SLOT && vals[source] == 0) {
+				vals[inst.result + lane] = 0;
+				continue;
+			}
+			int success = run_lane(inst, lane, vals);
+			if (success != 0) return success;
+		}
+	}
+
+	return 0;
+}
+
+
+void Program::get_nonzero_outputs(const vector<double>& values, unordered_map<string, double> *outputs) const {
+	for (size_t i = 0; i < output_slots->size(); i++) {
+		double value = values[(*output_slots)[i]];
+		if (value != 0) outputs->insert(make_pair((*output_names)[i], value));
+	}
+}
+
+
+int Program::execute(const unordered_map<string, double>& inputs, const SparseVariableVector& sparse_inputs,
+	unordered_map<string, double> *outputs) const {
+
+	vector<double> values;
+	init_values(&values);
+
+	int success = bind_values(inputs, &values);
+	if (success == 0) success = bind_sparse_values(sparse_inputs, &values);
+	if (success == 0) success = check_inputs_bound(values);
+	if (success == 0) success = run_sparse(&values);
+	if (success != 0) {
+		cerr << "\nERROR: " << get_error_message(success) << endl << endl;
+		return success;
+	}
+
+	get_nonzero_outputs(values, outputs);
+	return 0;
+}
+
+
+
+/* ---------------- Accessors -------------- */
+
+uint32_t Program::get_num_slots() const {
+	return slot_names->size();
+}
+
+uint32_t Program::get_num_instructions() const {
+	return instructions->size();
+}
+
+const vector<Instruction>& Program::get_instructions() const {
+	return *instructions;
+}
+
+const vector<VectorInstruction>& Program::get_vector_instructions() const {
+	return *vector_instructions;
+}
+
+uint32_t Program::get_slot(Symbol name) const {
+	unordered_map<Symbol, uint32_t>::const_iterator it = slots->find(name);
+	if (it == slots->end()) return INVALID_SLOT;
+	return it->second;
+}
+
+Symbol Program::get_slot_name(uint32_t slot) const {
+	return (*slot_names)[slot];
+}
+
+VariableType Program::get_slot_type(uint32_t slot) const {
+	return (*slot_types)[slot];
+}
+
+const vector<uint32_t>& Program::get_input_slots() const {
+	return *input_slots;
+}
+
+const vector<uint32_t>& Program::get_output_slots() const {
+	return *output_slots;
+}
+
+uint32_t Program::get_loss_slot() const {
+	return loss_slot;
+}
+
+uint32_t Program::get_zero_source(uint32_t slot) const {
+	return (*zero_sources)[slot];
+}
+
+const InputVector *Program::get_input_vector(Symbol name) const {
+	unordered_map<Symbol, InputVector>::const_iterator it = input_vectors->find(name);
+	if (it == input_vectors->end()) return NULL;
+	return &it->second;
+}
@@ -0,0 +1,338 @@
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+#include "Symbol.h"
+#include "Lexer.h"
+#include "LineReader.h"
+#include "SparseVector.h"
+#include "utilities.h"
+
+using namespace std;
+
+
+/* The slot of a name that is not in a Program. */
+#define INVALID_SLOT UINT32_MAX
+
+/* The most slots a Program can have. Slots are uint32_t below INVALID_SLOT, so a program too large for them is refused as it is loaded,
+ *  rather than having its slots wrap around. Vectors of up to MAX_VECTOR_SIZE components are only limited by this:
+ *  a GCP needs a slot for every component of every vector, and for each of their partials.
+ */
+#define MAX_SLOTS UINT32_MAX
+
+
+/* An Instruction defines one variable of a Program, from one or two operands.
+ * The result and operands are slots (see Program).
+ */
+struct Instruction {
+	/* A primitive operation, or INVALID_OPERATION to copy OPERAND1 into RESULT.
+	 * Variables defined as constants or as other variables are copies.
+	 */
+	OperationType operation;
+	uint32_t result;
+	uint32_t operand1;
+	/* Only used by binary operations. */
+	uint32_t operand2;
+};
+
+
+/* A Vector Instruction applies one operation to WIDTH lanes (see Program::vectorize).
+ * Lane i defines slot RESULT + i, from slots OPERAND1 + i * STRIDE1 and OPERAND2 + i * STRIDE2.
+ * The stride of an operand is 1 if each lane has its own slot, and 0 if every lane shares one slot (a scalar or a constant).
+ * A single Instruction is run as a Vector Instruction of width 1.
+ */
+struct VectorInstruction {
+	OperationType operation;
+	uint32_t result;
+	uint32_t operand1;
+	uint32_t operand2;
+	uint32_t width;
+	uint8_t stride1;
+	uint8_t stride2;
+};
+
+
+/* An Input Vector is a vector whose components are input variables (inputs, weights or expected outputs) of a Program.
+ * Its components are declared one after another (see Program::vectorize), so component i has slot FIRST_SLOT + i,
+ *  and the whole vector can be bound from a SparseVector at once.
+ * If its components were not declared in order, in consecutive slots, it is not CONTIGUOUS, and cannot be bound that way.
+ */
+struct InputVector {
+	uint32_t first_slot;
+	/* The number of components declared. */
+	uint32_t dimension;
+	bool contiguous;
+};
+
+
+/* A Program is a loaded, ready-to-run TenFlang program (usually a GCP).
+ * The program is parsed and checked once, by load.
+ * After that it can be executed any number of times, on different inputs, without reading or parsing any text.
+ * This is what the Weight Calculation Phase runs for every datum of every iteration.
+ *
+ * Every variable and every distinct constant of the program is given a slot: a dense index into an array of values.
+ * Each define line becomes one Instruction over slots, so executing the program is a single pass over an array of Instructions.
+ * The values of a run are kept by the caller, not the Program, so a Program is never modified after it is loaded:
+ *  one Program can be shared by any number of runs.
+ *
+ * Executing a Program gives the same results (and the same errors) as interpreting it with the Interpreter.
+ * Like the Interpreter, a Program can only deal with primitive operations; it must be preprocessed first.
+ */
+class Program {
+
+	vector<Instruction> *instructions;
+
+	/* The Instructions in the order they are run, with groups of isomorphic Instructions packed into Vector Instructions.
+	 * Only valid while VECTORIZED is set; adding an Instruction clears it, and run falls back to INSTRUCTIONS.
+	 */
+	vector<VectorInstruction> *vector_instructions;
+	bool vectorized;
+
+	/* The name, type and starting value of every slot, indexed by slot.
+	 * A constant's slot is named by its text, has type CONSTANT, and starts with its value.
+	 * Every other slot starts with DBL_MAX, meaning "not yet defined" (as in the BindingsDictionary).
+	 */
+	vector<Symbol> *slot_names;
+	vector<VariableType> *slot_types;
+	vector<double> *initial_values;
+
+	/* Maps the names of variables and constants to their slots. */
+	unordered_map<Symbol, uint32_t> *slots;
+
+	/* The most slots the program may have (see set_max_slots). */
+	uint32_t max_slots;
+
+	/* The slots of the variables whose values are given to the program (inputs, weights and expected outputs),
+	 *  and their names, in the order they were declared.
+	 */
+	vector<uint32_t> *input_slots;
+	vector<string> *input_names;
+
+	/* The slots of the output variables, and their names, in the order they were declared. */
+	vector<uint32_t> *output_slots;
+	vector<string> *output_names;
+
+	uint32_t loss_slot;
+
+	/* Maps the names of Input Vectors to where their components are. */
+	unordered_map<Symbol, InputVector> *input_vectors;
+
+	/* The zero source of every slot, indexed by slot: an input slot whose value being exactly 0 makes this slot's value 0,
+	 *  whatever the other operands are, or INVALID_SLOT if there is none (see run_sparse).
+	 * An input slot is its own zero source. A copy has the zero source of what it copies,
+	 *  a product has the zero source of either of its factors, a sum or difference has the zero source its two operands share,
+	 *  and a power has the zero source of its base if its exponent is a positive constant.
+	 */
+	vector<uint32_t> *zero_sources;
+
+	/* Which slots have been defined by the lines loaded so far. Only used while loading. */
+	vector<bool> *defined;
+
+	/* The Tokens of the line being loaded, reused for every line. Only used while loading. */
+	vector<Token> *line_tokens;
+
+	/* Returns the slot of the given operand, which is either a declared variable or a constant.
+	 * Constants are given a slot the first time they are seen.
+	 * Returns INVALID_SLOT if the operand is a variable that has not been declared, or a new constant there is no slot left for.
+	 */
+	uint32_t get_operand_slot(const Token& operand);
+
+	/* Adds a slot with the given name, type and starting value, and returns it.
+	 * Returns INVALID_SLOT, and adds nothing, if the program already has MAX_SLOTS slots.
+	 */
+	uint32_t add_slot(Symbol name, VariableType type, double initial_value);
+
+	/* Runs the Vector Instructions in order, on VALUES (see run). */
+	int run_vectorized(vector<double> *values) const;
+
+	/* Returns the zero source of the result of INSTRUCTION, from the zero sources of its operands (see ZERO_SOURCES). */
+	uint32_t get_zero_source(const Instruction& instruction) const;
+
+	/* Records that the input variable NAME has slot SLOT, in its Input Vector if it is a component. */
+	void add_input_component(const Token& name, uint32_t slot);
+
+
+public:
+
+	/* Constructor.
+	 * Initializes an empty program.
+	 */
+	Program();
+
+	/* Destructor.
+	 * Deletes the instructions, and the slot tables.
+	 */
+	~Program();
+
+	/* Loads the program stored in the file with the given FILENAME (see below), reading it through a memory mapping.
+	 * Returns 0 on success, or an error code on failure (see utilities.h).
+	 */
+	int load(const string& filename);
+
+	/* Loads the program read from PROG, by calling parse_line on every line, and then vectorizes it.
+	 * Loading checks everything the Interpreter checks that does not depend on the inputs:
+	 *  that every variable is declared once, defined once, declared before it is defined,
+	 *  and defined before it is used.
+	 *
+	 * Returns 0 on success, or an error code on failure (see utilities.h).
+	 * A Program can only be loaded once.
+	 */
+	int load(istream& prog);
+	int load(LineReader& prog);
+
+	/* Takes in a line of the program, and adds its slots and Instruction.
+	 * Declarations add a slot for the variable. Definitions add an Instruction.
+	 *
+	 * Returns TOO_MANY_VARIABLES if the line needs a slot beyond the program's limit (see set_max_slots),
+	 *  0 on success, and the appropriate error code on any other failure (see utilities.h).
+	 */
+	int parse_line(const string& line);
+	int parse_line(const char *line, size_t length);
+
+	/* Limits the program to MAX_SLOTS slots, so loading a program that needs more fails with TOO_MANY_VARIABLES.
+	 * The limit is MAX_SLOTS by default. It must be set before the program is loaded.
+	 */
+	void set_max_slots(uint32_t max_slots);
+
+	/* Packs groups of isomorphic Instructions into Vector Instructions (superword-level parallelism), so run can use SIMD kernels.
+	 *
+	 * The Preprocessor expands every vector operation into one line per component, defining x.0, x.1, ... in turn.
+	 * Components are declared one after another, so their slots are consecutive,
+	 *  and the lines defining them apply the same operation to consecutive slots (or to the same scalar or constant).
+	 * Starting from each slot in turn, a group grows while the Instruction defining the next slot is isomorphic to the first:
+	 *  it has the same operation, and each of its operands is the next slot of a vector, or the same slot as before.
+	 * The group is run where its last Instruction was, which is only allowed if:
+	 *  - No member uses the result of another member.
+	 *  - No other Instruction between a member and the last member uses the member's result.
+	 * Groups of one Instruction are run as they are. The results of a run are exactly the same as without vectorizing.
+	 *
+	 * Returns the number of Instructions that were packed into Vector Instructions of width 2 or more.
+	 */
+	uint32_t vectorize();
+
+
+
+	/* --------------------------- Execution ------------------------- */
+
+	/* Sets VALUES to the starting values of every slot: constants hold their values, and variables are undefined.
+	 * VALUES can be reused across runs; it is only resized the first time.
+	 */
+	void init_values(vector<double> *values) const;
+
+	/* Writes the value of every input variable (inputs, weights and expected outputs) from INPUTS into VALUES.
+	 * Returns INPUT_VALUE_NOT_PROVIDED if an input variable has no value in INPUTS.
+	 * Returns OTHER_ERROR if an input's value is DBL_MIN or DBL_MAX, which the Interpreter cannot bind either.
+	 * Returns 0 otherwise.
+	 */
+	int bind_inputs(const unordered_map<string, double>& inputs, vector<double> *values) const;
+
+	/* Runs every Instruction in order, on VALUES, which must have been set up by init_values and bind_inputs.
+	 * If the program has been vectorized, the Vector Instructions are run instead, with SIMD kernels where the operation allows.
+	 * Returns INVALID_LINE if an operation has no valid result (such as the log of a negative number),
+	 *  just as the Interpreter fails to bind such a value.
+	 * Returns 0 otherwise.
+	 */
+	int run(vector<double> *values) const;
+
+	/* Runs the program on the given INPUTS, and writes the values of the output variables into OUTPUTS.
+	 * This is init_values, bind_inputs and run in one call, for callers that deal in maps of names.
+	 *
+	 * Returns 0 on success, and the appropriate error code on failure (see utilities.h).
+	 */
+	int execute(const unordered_map<string, double>& inputs, unordered_map<string, double> *outputs) const;
+
+
+
+	/* ----------------------- Sparse Execution ---------------------- */
+
+	/* With sparse inputs (see SparseVector.h), most input components are 0, and so are most of the values computed from them:
+	 *  every product of a component, and every copy of one (such as the partial of a product with respect to a weight).
+	 * A sparse run binds the zero components of a vector with one pass over its slots, instead of a lookup by name for each,
+	 *  skips every Instruction whose zero source is 0 (see ZERO_SOURCES), and only reports the outputs that are not 0.
+	 *
+	 * The values are bound in pieces, so values shared by many runs (such as the weights) can be bound once, and copied:
+	 *
+	 	program.init_values(&weight_values);
+	 	program.bind_values(weights, &weight_values);
+	 	for every datum:
+	 		values = weight_values;
+	 		program.bind_values(datum_inputs, &values);
+	 		program.bind_sparse_values(datum_sparse_inputs, &values);
+	 		program.check_inputs_bound(values);
+	 		program.run_sparse(&values);
+	 		program.get_nonzero_outputs(values, &outputs);
+	 */
+
+	/* Writes the value of every input variable named in NAMED_VALUES into VALUES. Other names are ignored, as bind_inputs ignores them.
+	 * Returns VAR_DECLARED_TWICE if a variable was already bound (by an earlier call).
+	 * Returns OTHER_ERROR if a value is DBL_MIN or DBL_MAX, as bind_inputs does.
+	 * Returns 0 otherwise.
+	 */
+	int bind_values(const unordered_map<string, double>& named_values, vector<double> *values) const;
+
+	/* Writes every component of every Input Vector named in SPARSE_VALUES into VALUES: its value if it is listed, and 0 otherwise.
+	 * Names that are not Input Vectors are ignored.
+	 * Returns VAR_DECLARED_TWICE if a component was already bound, VECTORS_OF_DIFFERENT_DIMENSION if a component is listed
+	 *  beyond the end of its vector, and OTHER_ERROR if the vector is not contiguous, or a value is DBL_MIN or DBL_MAX.
+	 * Returns 0 otherwise.
+	 */
+	int bind_sparse_values(const SparseVariableVector& sparse_values, vector<double> *values) const;
+
+	/* Returns INPUT_VALUE_NOT_PROVIDED if an input variable has not been bound in VALUES, and 0 otherwise. */
+	int check_inputs_bound(const vector<double>& values) const;
+
+	/* Runs the program as run does, except that an Instruction whose zero source is exactly 0 is not computed: its result is set to 0.
+	 * Results are those of run, but for two things a skipped Instruction never does:
+	 *  fail (0 times an infinite value is NaN, which run refuses) or give -0 instead of 0.
+	 * Vector Instructions whose lanes have zero sources are run lane by lane, skipping the lanes that are 0.
+	 */
+	int run_sparse(vector<double> *values) const;
+
+	/* Writes the value of every output variable that is not exactly 0 into OUTPUTS. */
+	void get_nonzero_outputs(const vector<double>& values, unordered_map<string, double> *outputs) const;
+
+	/* Runs the program on INPUTS and the vectors in SPARSE_INPUTS, with a sparse run,
+	 *  and writes the values of the output variables that are not 0 into OUTPUTS.
+	 * Returns 0 on success, and the appropriate error code on failure (see utilities.h).
+	 */
+	int execute(const unordered_map<string, double>& inputs, const SparseVariableVector& sparse_inputs,
+		unordered_map<string, double> *outputs) const;
+
+
+
+	/* --------------------------- Accessors ------------------------- */
+
+	uint32_t get_num_slots() const;
+	uint32_t get_num_instructions() const;
+	const vector<Instruction>& get_instructions() const;
+
+	/* Returns the Vector Instructions, in the order they are run. Empty until the program is vectorized. */
+	const vector<VectorInstruction>& get_vector_instructions() const;
+
+	/* Returns the slot of the variable or constant with the given NAME, or INVALID_SLOT if it is not in the program. */
+	uint32_t get_slot(Symbol name) const;
+	Symbol get_slot_name(uint32_t slot) const;
+	VariableType get_slot_type(uint32_t slot) const;
+
+	const vector<uint32_t>& get_input_slots() const;
+	const vector<uint32_t>& get_output_slots() const;
+
+	/* Returns the slot of the loss variable, or INVALID_SLOT if the program has none. */
+	uint32_t get_loss_slot() const;
+
+	/* Returns the zero source of SLOT (see ZERO_SOURCES). */
+	uint32_t get_zero_source(uint32_t slot) const;
+
+	/* Returns the Input Vector with the given NAME, or NULL if there is none. */
+	const InputVector *get_input_vector(Symbol name) const;
+
+};
+
+
+
+#endif
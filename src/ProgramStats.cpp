@@ -0,0 +1,168 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include "ProgramStats.h"
+#include "Preprocessor.h"
+#include "Compiler.h"
+#include "Scheduler.h"
+
+using namespace std;
+
+
+/* Returns the name under which the count of Instructions in OPERATION_COUNTS[INDEX] is reported. */
+static string get_operation_count_name(int index) {
+	if (index == static_cast<int>(OperationType::INVALID_OPERATION)) return "copy";
+	return get_operation_name(static_cast<OperationType>(index));
+}
+
+
+/* Returns true if the count in OPERATION_COUNTS[INDEX] is reported.
+ * A GCP is expanded, so only primitive operations and copies can have counts.
+ */
+static bool is_reported_operation_count(int index) {
+	return index <= static_cast<int>(OperationType::LN) || index == static_cast<int>(OperationType::INVALID_OPERATION);
+}
+
+
+/* Returns true if the operation calls into the math library, rather than being a single arithmetic instruction. */
+static bool is_transcendental(OperationType operation) {
+	return operation == OperationType::LOGISTIC || operation == OperationType::EXP ||
+		operation == OperationType::POW || operation == OperationType::LN;
+}
+
+
+
+/* ---------------- Computing Stats -------------- */
+
+int compute_program_stats(const string& prog_filename, ProgramStats *stats) {
+
+	LineReader prog;
+	if (prog.open(prog_filename) != 0) {
+		cerr << "\nInvalid Program file name: " << prog_filename << endl << endl;
+		return INVALID_FILE_NAME;
+	}
+
+	int stats_success = compute_program_stats(prog, stats);
+	prog.close();
+	return stats_success;
+}
+
+
+int compute_program_stats(istream& prog, ProgramStats *stats) {
+	LineReader reader(prog);
+	return compute_program_stats(reader, stats);
+}
+
+
+int compute_program_stats(LineReader& prog, ProgramStats *stats) {
+
+	Preprocessor p;
+	stringstream exp_prog;
+	int success = p.expand_program(prog, exp_prog);
+	if (success != 0) return success;
+
+	Compiler c;
+	stringstream gcp_text;
+	success = c.compile(exp_prog, gcp_text);
+	if (success != 0) return success;
+
+	Program gcp;
+	success = gcp.load(gcp_text);
+	if (success != 0) return success;
+
+	compute_program_stats(gcp, *c.get_dfg(), stats);
+	return 0;
+}
+
+
+void compute_program_stats(const Program& gcp, const DataFlowGraph& dfg, ProgramStats *stats) {
+
+	stats->num_inputs = 0;
+	stats->num_weights = 0;
+	stats->num_exp_outputs = 0;
+	for (uint32_t node = 0; node < dfg.get_num_ids(); node++) {
+		VariableType type = dfg.get_type(node);
+		if (type == VariableType::INPUT) stats->num_inputs++;
+		else if (type == VariableType::WEIGHT) stats->num_weights++;
+		else if (type == VariableType::EXP_OUTPUT) stats->num_exp_outputs++;
+	}
+	stats->num_outputs = gcp.get_output_slots().size();
+
+	const vector<Instruction>& instructions = gcp.get_instructions();
+	stats->num_slots = gcp.get_num_slots();
+	stats->num_instructions = instructions.size();
+
+	// the depth of a value is the length of the longest chain of Instructions that computes it
+	// inputs and constants have depth 0, and Instructions are in order, so operands are always computed first
+	vector<uint32_t> depths(gcp.get_num_slots(), 0);
+	fill(stats->operation_counts, stats->operation_counts + NUM_OPERATION_COUNTS, 0);
+	stats->num_transcendentals = 0;
+	stats->critical_path_length = 0;
+
+	for (uint32_t i = 0; i < instructions.size(); i++) {
+		const Instruction& inst = instructions[i];
+		stats->operation_counts[static_cast<int>(inst.operation)]++;
+		if (is_transcendental(inst.operation)) stats->num_transcendentals++;
+
+		uint32_t depth = depths[inst.operand1];
+		if (inst.operand2 != INVALID_SLOT) depth = max(depth, depths[inst.operand2]);
+		depths[inst.result] = depth + 1;
+		stats->critical_path_length = max(stats->critical_path_length, depth + 1);
+	}
+
+	stats->parallelism = stats->critical_path_length == 0 ? 0 : (double) stats->num_instructions / stats->critical_path_length;
+
+	vector<uint32_t> order(instructions.size());
+	for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+	stats->peak_live_values = peak_live_values(gcp, order, NULL);
+	stats->scheduled_peak_live_values = min(stats->peak_live_values, peak_live_values(gcp, schedule_instructions(gcp), NULL));
+
+	stats->bytes_per_example = (uint64_t) (stats->num_inputs + stats->num_exp_outputs + stats->num_slots) * sizeof(double);
+}
+
+
+
+/* ---------------- Reporting Stats -------------- */
+
+void print_program_stats(const ProgramStats& stats, ostream& out) {
+	out << "Inputs:\t" << stats.num_inputs << endl;
+	out << "Weights:\t" << stats.num_weights << endl;
+	out << "Expected outputs:\t" << stats.num_exp_outputs << endl;
+	out << "GCP outputs:\t" << stats.num_outputs << endl;
+	out << "GCP values:\t" << stats.num_slots << endl;
+	out << "Instructions:\t" << stats.num_instructions << endl;
+	for (int i = 0; i < NUM_OPERATION_COUNTS; i++) {
+		if (stats.operation_counts[i] != 0) out << "  " << get_operation_count_name(i) << ":\t" << stats.operation_counts[i] << endl;
+	}
+	out << "Transcendentals:\t" << stats.num_transcendentals << endl;
+	out << "Critical path:\t" << stats.critical_path_length << endl;
+	out << "Parallelism (work / span):\t" << stats.parallelism << endl;
+	out << "Peak live values:\t" << stats.peak_live_values << " (" << stats.scheduled_peak_live_values << " once scheduled)" << endl;
+	out << "Bytes per example:\t" << stats.bytes_per_example << endl;
+}
+
+
+void write_program_stats_json(const ProgramStats& stats, ostream& out) {
+	out << "{" << endl;
+	out << "  \"inputs\": " << stats.num_inputs << "," << endl;
+	out << "  \"weights\": " << stats.num_weights << "," << endl;
+	out << "  \"exp_outputs\": " << stats.num_exp_outputs << "," << endl;
+	out << "  \"outputs\": " << stats.num_outputs << "," << endl;
+	out << "  \"slots\": " << stats.num_slots << "," << endl;
+	out << "  \"instructions\": " << stats.num_instructions << "," << endl;
+	out << "  \"operation_counts\": {";
+	for (int i = 0; i < NUM_OPERATION_COUNTS; i++) {
+		if (!is_reported_operation_count(i)) continue;
+		out << (i == 0 ? "" : ", ") << "\"" << get_operation_count_name(i) << "\": " << stats.operation_counts[i];
+	}
+	out << "}," << endl;
+	out << "  \"transcendentals\": " << stats.num_transcendentals << "," << endl;
+	out << "  \"critical_path_length\": " << stats.critical_path_length << "," << endl;
+	out << "  \"parallelism\": " << stats.parallelism << "," << endl;
+	out << "  \"peak_live_values\": " << stats.peak_live_values << "," << endl;
+	out << "  \"scheduled_peak_live_values\": " << stats.scheduled_peak_live_values << "," << endl;
+	out << "  \"bytes_per_example\": " << stats.bytes_per_example << endl;
+	out << "}" << endl;
+}
@@ -0,0 +1,83 @@
+#ifndef PROGRAM_STATS_H
+#define PROGRAM_STATS_H
+
+#include <iostream>
+#include <string>
+#include <cstdint>
+
+#include "DataFlowGraph.h"
+#include "Program.h"
+#include "utilities.h"
+
+using namespace std;
+
+
+/* Program Stats are a static cost model of a Shape Program: what one training example costs, without running it.
+ *
+ * The stats are read off the Data Flow Graph of the Expanded Shape Program, and the GCP that the Compiler generates from it,
+ *  which is the program run for every example of every iteration of training.
+ * Every Instruction of the GCP is assumed to cost the same, except that transcendentals (logistic, exp, pow and ln) are also counted on their own.
+ *
+ * The work of the GCP is its number of Instructions, and its span is the length of its critical path:
+ *  the longest chain of Instructions, each of which uses the result of the one before.
+ * Work / span is the average number of Instructions that could run at once, given enough processors.
+ */
+
+
+/* The number of entries in ProgramStats::operation_counts. The last entry counts copies (see Instruction). */
+#define NUM_OPERATION_COUNTS (static_cast<int>(OperationType::INVALID_OPERATION) + 1)
+
+
+struct ProgramStats {
+	/* The number of each type of variable in the Shape Program. */
+	uint32_t num_inputs;
+	uint32_t num_weights;
+	uint32_t num_exp_outputs;
+	/* The number of outputs of the GCP (the partials of the weights). */
+	uint32_t num_outputs;
+
+	/* The number of values (variables and constants) and Instructions of the GCP. */
+	uint32_t num_slots;
+	uint32_t num_instructions;
+
+	/* The number of Instructions of each OperationType, indexed by the OperationType. */
+	uint32_t operation_counts[NUM_OPERATION_COUNTS];
+	uint32_t num_transcendentals;
+
+	/* The number of Instructions on the longest chain of dependent Instructions, and num_instructions / critical_path_length. */
+	uint32_t critical_path_length;
+	double parallelism;
+
+	/* The largest number of values live at once, in the order the Compiler writes the GCP, and once scheduled (see Scheduler.h). */
+	uint32_t peak_live_values;
+	uint32_t scheduled_peak_live_values;
+
+	/* The bytes of memory one example needs: its inputs and expected outputs, and one double for every slot of the GCP. */
+	uint64_t bytes_per_example;
+};
+
+
+/* Computes the stats of the Shape Program stored in the file PROG_FILENAME (see below). */
+int compute_program_stats(const string& prog_filename, ProgramStats *stats);
+
+/* Preprocesses and compiles the Shape Program read from PROG in memory, and writes its stats into STATS.
+ * Returns 0 on success, and the appropriate error code otherwise (see utilities.h).
+ */
+int compute_program_stats(istream& prog, ProgramStats *stats);
+int compute_program_stats(LineReader& prog, ProgramStats *stats);
+
+/* Writes the stats of the loaded GCP, compiled from the Data Flow Graph DFG, into STATS. */
+void compute_program_stats(const Program& gcp, const DataFlowGraph& dfg, ProgramStats *stats);
+
+/* Writes a human-readable summary of STATS to OUT. */
+void print_program_stats(const ProgramStats& stats, ostream& out);
+
+/* Writes STATS to OUT as a JSON object, for tools that size machines and batches.
+ * Every field of ProgramStats is a key of the object, without the "num_" prefix.
+ * operation_counts is an object mapping the name of every primitive operation (and "copy") to its count.
+ */
+void write_program_stats_json(const ProgramStats& stats, ostream& out);
+
+
+
+#endif
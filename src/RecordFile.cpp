@@ -0,0 +1,356 @@
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "RecordFile.h"
+
+using namespace std;
+
+
+/* The first 8 bytes of every record file: the magic number, and the version of the format. */
+static const char RECORD_MAGIC[8] = {'T', 'F', 'R', 'E', 'C', '0', '0', '1'};
+
+
+/* ---------------- Writing --------------- */
+
+RecordWriter::RecordWriter() {
+	file = NULL;
+	num_columns = 0;
+	num_records = 0;
+	count_offset = 0;
+	buffer = new vector<char>();
+	failed = false;
+}
+
+
+RecordWriter::~RecordWriter() {
+	if (file != NULL) close();
+	delete buffer;
+}
+
+
+int RecordWriter::open(const string& filename, const vector<string>& column_names) {
+
+	if (file != NULL) close();
+	if (column_names.empty()) return OTHER_ERROR;
+	file = fopen(filename.c_str(), "wb");
+	if (file == NULL) return INVALID_FILE_NAME;
+
+	num_columns = column_names.size();
+	num_records = 0;
+	failed = false;
+
+	char number[8];
+	fwrite(RECORD_MAGIC, 1, sizeof(RECORD_MAGIC), file);
+	encode_uint64(num_columns, number);
+	fwrite(number, 1, sizeof(number), file);
+	for (size_t c = 0; c < num_columns; c++) {
+		encode_uint64(column_names[c].size(), number);
+		fwrite(number, 1, sizeof(number), file);
+		fwrite(column_names[c].data(), 1, column_names[c].size(), file);
+	}
+
+	// the number of records is written once they are all known (see close)
+	count_offset = ftell(file);
+	encode_uint64(0, number);
+	fwrite(number, 1, sizeof(number), file);
+	buffer->resize(num_columns * sizeof(double));
+	return 0;
+}
+
+
+void RecordWriter::write_record(const double *values) {
+	if (file == NULL) return;
+	for (size_t c = 0; c < num_columns; c++) encode_double(values[c], buffer->data() + c * sizeof(double));
+	if (fwrite(buffer->data(), 1, buffer->size(), file) != buffer->size()) failed = true;
+	num_records++;
+}
+
+
+int RecordWriter::close() {
+	if (file == NULL) return OTHER_ERROR;
+
+	// the number of records comes right before them
+	char number[8];
+	encode_uint64(num_records, number);
+	if (fseek(file, count_offset, SEEK_SET) != 0 || fwrite(number, 1, sizeof(number), file) != sizeof(number) || ferror(file)) {
+		failed = true;
+	}
+	if (fclose(file) != 0) failed = true;
+	file = NULL;
+	return failed ? INVALID_FILE_NAME : 0;
+}
+
+
+int write_record_file(const string& filename, const vector<string>& column_names,
+	const vector<pair<unordered_map<string, double>, unordered_map<string, double> > >& training_data) {
+
+	RecordWriter writer;
+	int success = writer.open(filename, column_names);
+	if (success != 0) return success;
+
+	vector<double> record(column_names.size());
+	for (size_t i = 0; i < training_data.size(); i++) {
+		for (size_t c = 0; c < column_names.size(); c++) {
+			unordered_map<string, double>::const_iterator it = training_data[i].first.find(column_names[c]);
+			if (it == training_data[i].first.end()) {
+				it = training_data[i].second.find(column_names[c]);
+				if (it == training_data[i].second.end()) {
+					writer.close();
+					remove(filename.c_str());
+					return INPUT_VALUE_NOT_PROVIDED;
+				}
+			}
+			record[c] = it->second;
+		}
+		writer.write_record(record.data());
+	}
+	return writer.close();
+}
+
+
+
+/* ---------------- Reading --------------- */
+
+/* Reads N bytes at OFFSET of the file FD into BYTES. Returns false if there were fewer, or if the read failed. */
+static bool read_fully(int fd, char *bytes, size_t n, int64_t offset) {
+	while (n > 0) {
+		ssize_t num_read = pread(fd, bytes, n, offset);
+		if (num_read < 0 && errno == EINTR) continue;
+		if (num_read <= 0) return false;
+		bytes += num_read;
+		offset += num_read;
+		n -= num_read;
+	}
+	return true;
+}
+
+
+RecordFileSource::RecordFileSource(size_t chunk_bytes) {
+	fd = -1;
+	column_names = new vector<string>();
+	num_records = 0;
+	data_offset = 0;
+	chunk_records = 1;
+	this->chunk_bytes = chunk_bytes;
+	queue = new vector<DataBatch>(RECORD_PREFETCH_DEPTH);
+	head = 0;
+	count = 0;
+	started = false;
+	finished = false;
+	cancelled = false;
+	error = 0;
+	lock = new mutex();
+	wakeup = new condition_variable();
+	prefetcher = NULL;
+}
+
+
+RecordFileSource::~RecordFileSource() {
+	close();
+	delete column_names;
+	delete queue;
+	delete lock;
+	delete wakeup;
+}
+
+
+int RecordFileSource::open(const string& filename) {
+
+	close();
+	fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) return INVALID_FILE_NAME;
+	struct stat status;
+	if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode)) {
+		close();
+		return INVALID_FILE_NAME;
+	}
+	int64_t file_size = status.st_size;
+
+	// every count is checked against what the rest of the file could hold
+	char header[16];
+	bool valid = read_fully(fd, header, sizeof(header), 0) && memcmp(header, RECORD_MAGIC, sizeof(RECORD_MAGIC)) == 0;
+	uint64_t num_columns = valid ? decode_uint64(header + 8) : 0;
+	valid = valid && num_columns > 0 && num_columns <= (uint64_t) file_size / 8;
+	int64_t offset = sizeof(header);
+	for (uint64_t c = 0; valid && c < num_columns; c++) {
+		char number[8];
+		valid = read_fully(fd, number, sizeof(number), offset);
+		uint64_t length = decode_uint64(number);
+		valid = valid && length <= (uint64_t) file_size;
+		if (!valid) break;
+		string name(length, ' ');
+		valid = read_fully(fd, &name[0], length, offset + 8);
+		column_names->push_back(name);
+		offset += 8 + length;
+	}
+
+	char number[8];
+	valid = valid && read_fully(fd, number, sizeof(number), offset);
+	uint64_t records = valid ? decode_uint64(number) : 0;
+	data_offset = offset + sizeof(number);
+	size_t record_bytes = num_columns * sizeof(double);
+	valid = valid && records <= (uint64_t) file_size / record_bytes && data_offset + (int64_t) (records * record_bytes) == file_size;
+	if (!valid) {
+		close();
+		return OTHER_ERROR;
+	}
+
+	num_records = records;
+	chunk_records = max(chunk_bytes / record_bytes, (size_t) 1);
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+	return 0;
+}
+
+
+void RecordFileSource::close() {
+	stop_pass();
+	started = false;
+	if (fd >= 0) ::close(fd);
+	fd = -1;
+	column_names->clear();
+	num_records = 0;
+}
+
+
+const vector<string>& RecordFileSource::get_column_names() const {
+	return *column_names;
+}
+
+
+int64_t RecordFileSource::get_num_records() const {
+	return num_records;
+}
+
+
+
+/* ---------------- Passes --------------- */
+
+int RecordFileSource::start_pass(size_t batch_size, mt19937_64 *rng) {
+	if (batch_size == 0 || fd < 0) return OTHER_ERROR;
+
+	stop_pass();
+	uint64_t seed = rng == NULL ? 0 : (*rng)();
+	started = true;
+	prefetcher = new thread(&RecordFileSource::prefetch, this, batch_size, seed, rng != NULL);
+	return 0;
+}
+
+
+int RecordFileSource::next_batch(DataBatch *batch) {
+	if (!started) return OTHER_ERROR;
+
+	unique_lock<mutex> guard(*lock);
+	while (count == 0 && !finished) wakeup->wait(guard);
+	if (count == 0) {
+		batch->num_rows = 0;
+		return error;
+	}
+
+	// the batch given back in exchange is filled again by the thread
+	swap(*batch, (*queue)[head]);
+	head = (head + 1) % queue->size();
+	count--;
+	wakeup->notify_all();
+	return 0;
+}
+
+
+void RecordFileSource::prefetch(size_t batch_size, uint64_t seed, bool shuffle) {
+
+	size_t num_columns = column_names->size();
+	size_t record_bytes = num_columns * sizeof(double);
+	mt19937_64 rng(seed);
+
+	vector<uint64_t> chunks((num_records + chunk_records - 1) / chunk_records);
+	for (size_t k = 0; k < chunks.size(); k++) chunks[k] = k;
+	if (shuffle) shuffle_rows(&chunks, &rng);
+
+	vector<char> chunk;
+	vector<uint64_t> rows;
+	DataBatch batch;
+	for (size_t k = 0; k < chunks.size(); k++) {
+		int64_t first = (int64_t) chunks[k] * chunk_records;
+		size_t n = min((int64_t) chunk_records, num_records - first);
+		chunk.resize(n * record_bytes);
+		if (!read_fully(fd, chunk.data(), chunk.size(), data_offset + first * record_bytes)) {
+			finish_pass(OTHER_ERROR);
+			return;
+		}
+
+		rows.resize(n);
+		for (size_t r = 0; r < n; r++) rows[r] = r;
+		if (shuffle) shuffle_rows(&rows, &rng);
+
+		// every record is decoded straight into its row of every column of the batch
+		for (size_t r = 0; r < n; r++) {
+			if (batch.num_rows == 0) {
+				batch.storage.resize(num_columns * batch_size);
+				batch.columns.resize(num_columns);
+				for (size_t c = 0; c < num_columns; c++) batch.columns[c] = batch.storage.data() + c * batch_size;
+			}
+
+			const char *record = chunk.data() + rows[r] * record_bytes;
+			double *row = batch.storage.data() + batch.num_rows;
+			for (size_t c = 0; c < num_columns; c++) row[c * batch_size] = decode_double(record + c * sizeof(double));
+
+			batch.num_rows++;
+			if (batch.num_rows == batch_size && !hand_over(&batch)) return;
+		}
+	}
+
+	if (batch.num_rows > 0 && !hand_over(&batch)) return;
+	finish_pass(0);
+}
+
+
+bool RecordFileSource::hand_over(DataBatch *batch) {
+	unique_lock<mutex> guard(*lock);
+	while (count == queue->size() && !cancelled) wakeup->wait(guard);
+	if (cancelled) return false;
+
+	swap(*batch, (*queue)[(head + count) % queue->size()]);
+	count++;
+	batch->num_rows = 0;
+	wakeup->notify_all();
+	return true;
+}
+
+
+void RecordFileSource::finish_pass(int error) {
+	unique_lock<mutex> guard(*lock);
+	finished = true;
+	this->error = error;
+	wakeup->notify_all();
+}
+
+
+void RecordFileSource::stop_pass() {
+	if (prefetcher != NULL) {
+		{
+			unique_lock<mutex> guard(*lock);
+			cancelled = true;
+			wakeup->notify_all();
+		}
+		prefetcher->join();
+		delete prefetcher;
+		prefetcher = NULL;
+	}
+	head = 0;
+	count = 0;
+	finished = false;
+	cancelled = false;
+	error = 0;
+}
+
+
+bool is_record_file(const string& filename) {
+	FILE *file = fopen(filename.c_str(), "rb");
+	if (file == NULL) return false;
+	char magic[sizeof(RECORD_MAGIC)];
+	bool is_record = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, RECORD_MAGIC, sizeof(magic)) == 0;
+	fclose(file);
+	return is_record;
+}
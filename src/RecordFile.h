@@ -0,0 +1,174 @@
+#ifndef RECORD_FILE_H
+#define RECORD_FILE_H
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdio>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+
+#include "DataSource.h"
+#include "utilities.h"
+
+using namespace std;
+
+
+/* This file defines record files, which hold training data in binary, one fixed-layout record after another, to be streamed (see DataSource.h).
+ *
+ * A record file is a header, then the records:
+ *
+ 	the magic number "TFREC", and the version of the format		8 bytes
+ 	the number of columns											uint64
+ 	the name of every column: its length, and its characters		uint64, then the characters
+ 	the number of records											uint64
+ 	the records: one float64 for every column, in order				the number of records * the number of columns * 8 bytes
+ *
+ * Every number is little-endian. A record stands for one datum, and every column names an input or an expected output.
+ * Records are read a chunk of consecutive records at a time, so a file far larger than memory is read sequentially, at the speed of the disk.
+ */
+
+
+/* The number of bytes of records a RecordFileSource reads at a time, by default. */
+const size_t RECORD_CHUNK_BYTES = 1 << 22;
+
+/* The number of decoded batches a RecordFileSource keeps ready ahead of training. */
+const size_t RECORD_PREFETCH_DEPTH = 4;
+
+
+/* A RecordWriter writes a record file one record at a time, so the data never need to be in memory all at once. */
+class RecordWriter {
+
+private:
+
+	FILE *file;
+	size_t num_columns;
+	int64_t num_records;
+
+	/* Where the number of records is, in the header. */
+	long count_offset;
+
+	/* The bytes of the record being written. */
+	vector<char> *buffer;
+
+	/* Set once a write has failed. */
+	bool failed;
+
+
+public:
+
+	/* Constructor. Creates a writer with no file. */
+	RecordWriter();
+
+	/* Destructor. Closes the file, if it is still open (see close). */
+	~RecordWriter();
+
+	/* Creates the record file FILENAME, whose columns are COLUMN_NAMES, and writes its header.
+	 * Returns INVALID_FILE_NAME if the file cannot be created, OTHER_ERROR if there are no columns, and 0 otherwise.
+	 */
+	int open(const string& filename, const vector<string>& column_names);
+
+	/* Appends the record VALUES, which holds one value for every column, in order. */
+	void write_record(const double *values);
+
+	/* Writes the number of records into the header, and closes the file.
+	 * Returns INVALID_FILE_NAME if a write failed, OTHER_ERROR if no file is open, and 0 otherwise.
+	 */
+	int close();
+
+};
+
+
+/* Writes TRAINING_DATA into the record file FILENAME, whose columns are COLUMN_NAMES: every column takes its value from
+ *  the inputs or the expected outputs of the datum.
+ * Returns INPUT_VALUE_NOT_PROVIDED if a datum has no value for a column, the errors of RecordWriter otherwise, and 0 on success.
+ */
+int write_record_file(const string& filename, const vector<string>& column_names,
+	const vector<pair<unordered_map<string, double>, unordered_map<string, double> > >& training_data);
+
+
+/* A RecordFileSource streams the records of a record file, as a DataSource.
+ * Each pass is read by a thread of its own, which reads the records a chunk at a time, decodes them into batches, column by column,
+ *  and keeps up to RECORD_PREFETCH_DEPTH batches ready, so training computes on one batch while the next ones are read.
+ * Batches are swapped in and out of the queue, so once a pass has started, no memory is allocated, and no batch is copied.
+ *
+ * A shuffled pass reads the chunks in a random order, and the records of each chunk in a random order:
+ *  a datum can only move within its chunk, and next to the chunks around it, but the memory it takes is only one chunk,
+ *  however large the file is.
+ */
+class RecordFileSource : public DataSource {
+
+private:
+
+	/* The file, and its layout. */
+	int fd;
+	vector<string> *column_names;
+	int64_t num_records;
+	int64_t data_offset;
+	size_t chunk_records;
+	size_t chunk_bytes;
+
+	/* The batches of the pass that are ready: COUNT of them, from HEAD on, in a ring. */
+	vector<DataBatch> *queue;
+	size_t head;
+	size_t count;
+
+	/* Whether a pass was started, whether its thread has read it all, and whether it was told to stop.
+	 * ERROR is the error the thread stopped with, or 0.
+	 */
+	bool started;
+	bool finished;
+	bool cancelled;
+	int error;
+
+	mutex *lock;
+	condition_variable *wakeup;
+	thread *prefetcher;
+
+	/* Reads a whole pass, in batches of BATCH_SIZE records, shuffled with SEED if SHUFFLE is true. Runs on the thread of the pass. */
+	void prefetch(size_t batch_size, uint64_t seed, bool shuffle);
+
+	/* Swaps BATCH into the queue, once it has room, and clears the batch it gets back. Returns false if the pass was told to stop. */
+	bool hand_over(DataBatch *batch);
+
+	/* Ends the pass, with ERROR. */
+	void finish_pass(int error);
+
+	/* Stops the thread of the pass, if there is one, and empties the queue. */
+	void stop_pass();
+
+
+public:
+
+	/* Constructor. Creates a source with no file, which reads CHUNK_BYTES bytes of records at a time (at least one record). */
+	RecordFileSource(size_t chunk_bytes = RECORD_CHUNK_BYTES);
+
+	/* Destructor. Stops the pass, and closes the file. */
+	~RecordFileSource();
+
+	/* Opens the record file FILENAME, and reads its header.
+	 * Returns INVALID_FILE_NAME if the file cannot be opened, OTHER_ERROR if it is not a record file,
+	 *  or if its size is not that of its records, and 0 otherwise.
+	 */
+	int open(const string& filename);
+
+	/* Closes the file. */
+	void close();
+
+	const vector<string>& get_column_names() const;
+	int64_t get_num_records() const;
+	int start_pass(size_t batch_size, mt19937_64 *rng);
+	int next_batch(DataBatch *batch);
+
+};
+
+
+/* Returns true if the file FILENAME begins as a record file does. */
+bool is_record_file(const string& filename);
+
+
+
+#endif
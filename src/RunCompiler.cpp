@@ -3,6 +3,8 @@
 
 #include "Compiler.h"
 #include "Preprocessor.h"
+#include "Scheduler.h"
+#include "ProgramStats.h"
 
 using namespace std;
 
@@ -15,6 +17,19 @@ void compiler_exit_with_usage() {
     cerr << "If your program has not yet been pre-processed, use the '-pp' flag and specify the name of the file to which you want the Expanded Program written." << endl;
     cerr << "Example: " << endl;
     cerr << "# ./compiler my_shape_program.tf my_gcp.tf -pp temp_expanded_shape_program.tf" << endl << endl;
+    cerr << "To build a Hessian-vector product program from a GCP, use the '-hvp' flag." << endl;
+    cerr << "Example: " << endl;
+    cerr << "# ./compiler my_gcp.tf my_hvp.tf -hvp" << endl << endl;
+    cerr << "To reorder the lines of a GCP (or any expanded program) so values are used soon after they are defined, use the '-schedule' flag." << endl;
+    cerr << "Example: " << endl;
+    cerr << "# ./compiler my_gcp.tf my_scheduled_gcp.tf -schedule" << endl << endl;
+    cerr << "If your program has several losses, use the '-per_objective' flag to also compute the partials of each loss on its own." << endl;
+    cerr << "Example: " << endl;
+    cerr << "# ./compiler my_expanded_shape_program.tf my_gcp.tf -per_objective" << endl << endl;
+    cerr << "To estimate what one training example of a Shape Program costs, without compiling it to a file, use the '-stats' flag." << endl;
+    cerr << "Add the '-json' flag to print the stats as JSON." << endl;
+    cerr << "Example: " << endl;
+    cerr << "# ./compiler my_shape_program.tf -stats -json" << endl << endl;
     exit(EXIT_FAILURE);
 }
  
@@ -23,10 +38,57 @@ void compiler_exit_with_usage() {
  * The second argument is the name of the file to which the GCP is written.
  * If the Shape Program needs to be pre-processed, the third argument must be "-pp",
  *  and the fourth argument is the name of the file to which the Expanded Shape Program is written.
+ * If the third argument is "-hvp", the first argument is a GCP, and the second is the file
+ *  to which its Hessian-vector product program is written.
+ * If the third argument is "-schedule", the first argument is an expanded program (usually a GCP), and the second is the file
+ *  to which the scheduled program is written (see Scheduler.h). A report of the values live before and after is printed.
+ * If the third argument is "-per_objective", the first argument is an expanded program with several losses,
+ *  and the GCP also gets the partials of each loss (see Compiler.h).
+ * If the second argument is "-stats", the stats of the Shape Program are printed instead (see ProgramStats.h),
+ *  as JSON if the third argument is "-json".
  */
 int main(int argc, char *argv[]) {
 
-    if (argc != 3 && argc != 5) {
+    if (argc != 3 && argc != 4 && argc != 5) {
+        compiler_exit_with_usage();
+    }
+
+    // print the stats of a Shape Program, without writing its GCP
+    if (string(argv[2]) == "-stats") {
+        if (argc == 4 && string(argv[3]) != "-json") {
+            compiler_exit_with_usage();
+        }
+        if (argc == 5) {
+            compiler_exit_with_usage();
+        }
+        ProgramStats stats;
+        int stats_success = compute_program_stats(string(argv[1]), &stats);
+        if (stats_success == 0) {
+            if (argc == 4) write_program_stats_json(stats, cout);
+            else print_program_stats(stats, cout);
+        }
+        return stats_success;
+    }
+
+    // build a Hessian-vector product program from an existing GCP, compile with per-objective partials, or schedule an existing program
+    if (argc == 4) {
+        if (string(argv[3]) == "-hvp") {
+            Compiler c;
+            return c.compile_hvp(string(argv[1]), string(argv[2]));
+        }
+        if (string(argv[3]) == "-per_objective") {
+            Compiler c;
+            c.set_per_objective_partials(true);
+            return c.compile(string(argv[1]), string(argv[2]));
+        }
+        if (string(argv[3]) == "-schedule") {
+            ScheduleReport report;
+            int schedule_success = schedule_program(string(argv[1]), string(argv[2]), &report);
+            if (schedule_success == 0) {
+                print_schedule_report(report, cout);
+            }
+            return schedule_success;
+        }
         compiler_exit_with_usage();
     }
 
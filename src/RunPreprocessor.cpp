@@ -10,6 +10,9 @@ void preprocessor_exit_with_usage() {
 	cerr << "\nMust provide the name of a TenFlang file, and the name of the file to which the Expanded Program will be written." << endl;
 	cerr << "Example: " << endl;
 	cerr << "# ./preprocessor my_program.tf my_expanded_program.tf" << endl << endl;
+	cerr << "To expand dot products and reductions as balanced trees of pairwise sums, use the '-tree' flag." << endl;
+	cerr << "Example: " << endl;
+	cerr << "# ./preprocessor my_program.tf my_expanded_program.tf -tree" << endl << endl;
 	exit(EXIT_FAILURE);
 }
 
@@ -17,15 +20,20 @@ void preprocessor_exit_with_usage() {
 /* Runs the Preprocessor.
  * The first argument is the name of the file from which the user-given Program is read.
  * The second argument is the name of the file to which the Expanded Program is written.
+ * If the third argument is "-tree", dot products and reductions are expanded as balanced trees (see Preprocessor::set_tree_reductions).
  */
 
 int main(int argc, char *argv[]) {
 
-	if (argc != 3) {
+	if (argc != 3 && argc != 4) {
+		preprocessor_exit_with_usage();
+	}
+	if (argc == 4 && string(argv[3]) != "-tree") {
 		preprocessor_exit_with_usage();
 	}
 
 	Preprocessor p;
+	p.set_tree_reductions(argc == 4);
 	string prog(argv[1]), exp_prog(argv[2]);
 	int preprocess_success = p.expand_program(prog, exp_prog);
 	return preprocess_success;
@@ -0,0 +1,243 @@
+#include <iostream>
+#include <stdlib.h>
+#include <algorithm>
+
+#include "Trainer.h"
+
+using namespace std;
+
+
+void tenflow_exit_with_usage() {
+    cerr << "\nMust provide a command: 'train' or 'convert'." << endl;
+    cerr << "To train a TenFlang program, provide the name of the program, and the name of the file from which the training data is read." << endl;
+    cerr << "Example: " << endl;
+    cerr << "# ./tenflow train my_program.tf training_data.txt" << endl << endl;
+    cerr << "Training data may also be a binary record file, or a columnar file, which is streamed in batches rather than read into memory." << endl << endl;
+    cerr << "The Expanded Program and the GCP are kept in memory. To also write them to files for debugging, use the '-pp' and '-gcp' flags." << endl;
+    cerr << "Example: " << endl;
+    cerr << "# ./tenflow train my_program.tf training_data.txt -pp my_expanded_program.tf -gcp my_gcp.tf" << endl << endl;
+    cerr << "If the program has several losses, their weighted sum is minimized. Each loss has weight 1, unless the '-seed' flag gives another." << endl;
+    cerr << "Example: " << endl;
+    cerr << "# ./tenflow train my_program.tf training_data.txt -seed my_loss=0.5" << endl << endl;
+    cerr << "To train by mini-batch stochastic gradient descent, give the batch size with the '-batch' flag." << endl;
+    cerr << "The '-epochs' and '-steps' flags limit the passes over the data and the weight updates (0 steps for no limit)," << endl;
+    cerr << "  and '-shuffle_seed' seeds the shuffling of the data before every epoch." << endl;
+    cerr << "Example: " << endl;
+    cerr << "# ./tenflow train my_program.tf training_data.txt -batch 32 -epochs 10 -shuffle_seed 7" << endl << endl;
+    cerr << "The '-threads' flag trains stochastically and asynchronously, with that many threads updating the weights without locks." << endl;
+    cerr << "The staleness of the updates, and how often they collided, are reported on the error stream." << endl;
+    cerr << "Example: " << endl;
+    cerr << "# ./tenflow train my_program.tf training_data.txt -threads 4 -batch 1 -epochs 10" << endl << endl;
+    cerr << "The '-processes' flag splits training between that many worker processes, which sum their gradients every step," << endl;
+    cerr << "  or, with '-batch', push them to a parameter server, which applies them as they come, and reports on the error stream." << endl;
+    cerr << "The '-staleness' flag bounds how many more gradients a worker may push than the slowest one (0 for lock step)." << endl;
+    cerr << "Example: " << endl;
+    cerr << "# ./tenflow train my_program.tf training_data.txt -processes 4 -optimizer lbfgs" << endl;
+    cerr << "# ./tenflow train my_program.tf training_data.txt -processes 4 -batch 8 -epochs 10 -staleness 2" << endl << endl;
+    cerr << "The '-optimizer' flag chooses how the weights are moved: gd (the default), momentum, nesterov, adagrad, rmsprop, adam or lbfgs." << endl;
+    cerr << "Its hyperparameters are set by the '-rate', '-momentum', '-decay', '-beta1', '-beta2' and '-epsilon' flags," << endl;
+    cerr << "  and those of L-BFGS (which only trains on the full batch) by the '-history', '-wolfe_c1' and '-wolfe_c2' flags," << endl;
+    cerr << "  and full-batch training stops after '-iterations' steps, or once the gradient is within '-precision'." << endl;
+    cerr << "Example: " << endl;
+    cerr << "# ./tenflow train my_program.tf training_data.txt -optimizer adam -rate 0.01 -iterations 5000" << endl << endl;
+    cerr << "The '-checkpoint' flag writes the state of training to a file every '-checkpoint_interval' steps (100 by default), and when it ends." << endl;
+    cerr << "The '-resume' flag does the same, but first resumes training from the checkpoint in the file, if there is one." << endl;
+    cerr << "Example: " << endl;
+    cerr << "# ./tenflow train my_program.tf training_data.txt -batch 32 -epochs 10 -resume my_checkpoint.ckpt" << endl << endl;
+    cerr << "To convert training data into a columnar file, provide the name of the program, the name of the training data file" << endl;
+    cerr << "  (or of a CSV file, ending in '.csv', whose first line names the columns), and the name of the columnar file to write." << endl;
+    cerr << "The '-type' flag stores the columns as float64 (the default) or float32, and '-chunk_rows' also stores the min, max and sum" << endl;
+    cerr << "  of every chunk of that many rows of every column." << endl;
+    cerr << "Example: " << endl;
+    cerr << "# ./tenflow convert my_program.tf training_data.csv training_data.col -type float32 -chunk_rows 4096" << endl << endl;
+    exit(EXIT_FAILURE);
+}
+
+
+/* Returns the non-negative integer VALUE of a flag, and exits with the usage message if it is not one. */
+int64_t parse_count_flag(const char *value) {
+    char *end;
+    long long count = strtoll(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || count < 0) tenflow_exit_with_usage();
+    return count;
+}
+
+
+/* Returns the numeric VALUE of a flag, and exits with the usage message if it is not a number. */
+double parse_real_flag(const char *value) {
+    if (!is_constant(value)) tenflow_exit_with_usage();
+    return stod(value);
+}
+
+
+/* Converts training data into a columnar file (see ColumnarFile.h), for the "convert" command of main, with the arguments of main.
+ * The second argument is the name of the file from which the Shape Program is read, which the columns must be the data of.
+ * The third argument is the name of the file from which the training data is read (see Trainer.h), or the CSV data, if it ends in ".csv".
+ * The fourth argument is the name of the columnar file to write.
+ * The optional flags "-type <float64|float32>" and "-chunk_rows <n>" choose how the columns are stored (see ColumnarOptions).
+ */
+int convert(int argc, char *argv[]) {
+
+    if (argc < 5 || argc % 2 != 1) {
+        tenflow_exit_with_usage();
+    }
+
+    string prog(argv[2]);
+    string data(argv[3]);
+    string columnar(argv[4]);
+
+    ColumnarOptions options;
+    for (int i = 5; i < argc; i += 2) {
+        string flag(argv[i]);
+        string value(argv[i + 1]);
+        if (flag == "-type" && value == "float64") {
+            options.type = ColumnType::FLOAT64;
+        } else if (flag == "-type" && value == "float32") {
+            options.type = ColumnType::FLOAT32;
+        } else if (flag == "-chunk_rows") {
+            options.chunk_rows = parse_count_flag(argv[i + 1]);
+        } else {
+            tenflow_exit_with_usage();
+        }
+    }
+
+    Trainer t;
+    int success = t.build(prog, TrainOptions());
+    if (success != 0) return success;
+
+    bool is_csv = data.size() >= 4 && data.compare(data.size() - 4, 4, ".csv") == 0;
+    if (is_csv) return t.convert_csv_data(data, columnar, options);
+    return t.convert_training_data(data, columnar, options);
+}
+
+
+/* Runs TenFlow.
+ * The first argument is the command, "train", or "convert" (see convert).
+ * The second argument is the name of the file from which the Shape Program is read.
+ * The third argument is the name of the file from which the training data is read (see Trainer.h),
+ *  or streamed, if it is a record file (see RecordFile.h) or a columnar file (see ColumnarFile.h).
+ * The optional flags "-pp <file>" and "-gcp <file>" write the Expanded Shape Program and the GCP to files.
+ * The optional flag "-seed <loss>=<value>", which may be repeated, sets the weight of a loss in the objective (see Compiler.h).
+ * The optional flag "-batch <size>" trains by mini-batch stochastic gradient descent, which the flags
+ *  "-epochs <n>", "-steps <n>" and "-shuffle_seed <n>" configure (see SGDOptions in GradientDescent.h).
+ * The optional flag "-threads <n>" trains stochastically with n threads, asynchronously if n is more than 1 (see hogwild_gradient_descent).
+ * The optional flag "-processes <n>" splits training between n worker processes (see data_parallel_gradient_descent),
+ *  which train stochastically through a parameter server with "-batch" (see parameter_server_gradient_descent),
+ *  whose staleness the flag "-staleness <n>" bounds.
+ * The optional flag "-optimizer <name>" chooses the Optimizer, whose hyperparameters are set by the flags
+ *  "-rate", "-momentum", "-decay", "-beta1", "-beta2", "-epsilon", "-history", "-wolfe_c1", "-wolfe_c2", "-iterations" and "-precision"
+ *  (see OptimizerOptions in Optimizer.h).
+ * The optional flags "-checkpoint <file>" and "-checkpoint_interval <n>" write checkpoints of training to the file,
+ *  and "-resume <file>" also resumes training from it (see Checkpoint.h).
+ * The learned weights are printed in the {<var_name>	<value>} format of Interpreter input files.
+ */
+int main(int argc, char *argv[]) {
+
+    if (argc > 1 && string(argv[1]) == "convert") {
+        return convert(argc, argv);
+    }
+
+    if (argc < 4 || argc % 2 != 0 || string(argv[1]) != "train") {
+        tenflow_exit_with_usage();
+    }
+
+    string prog(argv[2]);
+    string data(argv[3]);
+
+    TrainOptions options;
+    for (int i = 4; i < argc; i += 2) {
+        string flag(argv[i]);
+        if (flag == "-pp") {
+            options.expanded_prog_filename = string(argv[i + 1]);
+        } else if (flag == "-gcp") {
+            options.gcp_filename = string(argv[i + 1]);
+        } else if (flag == "-seed") {
+            string seed(argv[i + 1]);
+            size_t equals = seed.find('=');
+            if (equals == string::npos || !is_constant(seed.substr(equals + 1))) {
+                tenflow_exit_with_usage();
+            }
+            options.loss_seeds[seed.substr(0, equals)] = stod(seed.substr(equals + 1));
+        } else if (flag == "-batch") {
+            options.stochastic = true;
+            options.sgd.batch_size = parse_count_flag(argv[i + 1]);
+            if (options.sgd.batch_size == 0) tenflow_exit_with_usage();
+        } else if (flag == "-epochs") {
+            options.sgd.max_epochs = parse_count_flag(argv[i + 1]);
+        } else if (flag == "-steps") {
+            options.sgd.max_steps = parse_count_flag(argv[i + 1]);
+        } else if (flag == "-shuffle_seed") {
+            options.sgd.seed = parse_count_flag(argv[i + 1]);
+        } else if (flag == "-threads") {
+            options.stochastic = true;
+            options.sgd.num_threads = parse_count_flag(argv[i + 1]);
+            if (options.sgd.num_threads == 0) tenflow_exit_with_usage();
+        } else if (flag == "-processes") {
+            options.num_processes = parse_count_flag(argv[i + 1]);
+            if (options.num_processes == 0) tenflow_exit_with_usage();
+        } else if (flag == "-staleness") {
+            options.sgd.staleness_bound = parse_count_flag(argv[i + 1]);
+        } else if (flag == "-checkpoint") {
+            options.checkpoint.filename = string(argv[i + 1]);
+        } else if (flag == "-checkpoint_interval") {
+            options.checkpoint.interval = parse_count_flag(argv[i + 1]);
+        } else if (flag == "-resume") {
+            options.checkpoint.filename = string(argv[i + 1]);
+            options.checkpoint.resume = true;
+        } else if (flag == "-optimizer") {
+            if (!parse_optimizer_type(argv[i + 1], &options.optimizer.type)) tenflow_exit_with_usage();
+        } else if (flag == "-rate") {
+            options.optimizer.learning_rate = parse_real_flag(argv[i + 1]);
+        } else if (flag == "-momentum") {
+            options.optimizer.momentum = parse_real_flag(argv[i + 1]);
+        } else if (flag == "-decay") {
+            options.optimizer.decay = parse_real_flag(argv[i + 1]);
+        } else if (flag == "-beta1") {
+            options.optimizer.beta1 = parse_real_flag(argv[i + 1]);
+        } else if (flag == "-beta2") {
+            options.optimizer.beta2 = parse_real_flag(argv[i + 1]);
+        } else if (flag == "-epsilon") {
+            options.optimizer.epsilon = parse_real_flag(argv[i + 1]);
+        } else if (flag == "-history") {
+            options.optimizer.lbfgs_history = parse_count_flag(argv[i + 1]);
+        } else if (flag == "-wolfe_c1") {
+            options.optimizer.wolfe_c1 = parse_real_flag(argv[i + 1]);
+        } else if (flag == "-wolfe_c2") {
+            options.optimizer.wolfe_c2 = parse_real_flag(argv[i + 1]);
+        } else if (flag == "-iterations") {
+            options.optimizer.max_iterations = parse_count_flag(argv[i + 1]);
+        } else if (flag == "-precision") {
+            options.optimizer.gradient_precision = parse_real_flag(argv[i + 1]);
+        } else {
+            tenflow_exit_with_usage();
+        }
+    }
+
+    VariableVector weights;
+    HogwildStats stats;
+    ParameterServerStats server_stats;
+    int train_success = train(prog, data, options, &weights, &stats, &server_stats);
+    if (train_success != 0) {
+        return train_success;
+    }
+
+    if (options.sgd.num_threads > 1) {
+        cerr << "Asynchronous steps: " << stats.num_steps << ", mean staleness: " << (double) stats.total_staleness / max(stats.num_steps, (int64_t) 1);
+        cerr << ", max staleness: " << stats.max_staleness << ", conflicts: " << stats.num_conflicts << endl;
+    }
+
+    if (options.stochastic && options.num_processes > 1) {
+        cerr << "Server updates: " << server_stats.num_updates;
+        cerr << ", mean staleness: " << (double) server_stats.total_staleness / max(server_stats.num_updates, (int64_t) 1);
+        cerr << ", max staleness: " << server_stats.max_staleness << ", delayed pulls: " << server_stats.num_delayed_pulls;
+        cerr << ", sparse pushes: " << server_stats.num_sparse_pushes << ", dense pushes: " << server_stats.num_dense_pushes;
+        cerr << ", bytes received: " << server_stats.num_bytes_received << endl;
+    }
+
+    for (VariableVector::iterator it = weights.begin(); it != weights.end(); ++it) {
+        cout << it->first << "\t" << it->second << endl;
+    }
+
+    return 0;
+
+}
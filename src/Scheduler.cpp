@@ -0,0 +1,316 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include "Scheduler.h"
+
+using namespace std;
+
+
+/* Marks an entry of an index table with no line or no defining Instruction. */
+#define NONE UINT32_MAX
+
+
+/* Returns true if the value in SLOT is given to the program before it runs (inputs, weights and expected outputs). */
+static bool is_input_slot(const Program& prog, uint32_t slot) {
+	VariableType type = prog.get_slot_type(slot);
+	return type == VariableType::INPUT || type == VariableType::WEIGHT || type == VariableType::EXP_OUTPUT;
+}
+
+
+/* Fills DEFINING_INSTRUCTION with the index of the Instruction that defines each slot, or NONE. */
+static void find_defining_instructions(const Program& prog, vector<uint32_t> *defining_instruction) {
+	const vector<Instruction>& instructions = prog.get_instructions();
+	defining_instruction->assign(prog.get_num_slots(), NONE);
+	for (uint32_t i = 0; i < instructions.size(); i++) {
+		(*defining_instruction)[instructions[i].result] = i;
+	}
+}
+
+
+/* ---------------- Scheduling -------------- */
+
+/* Orders pairs by their first element only, so a stable sort keeps pairs with equal first elements in order. */
+static bool compare_first(const pair<uint32_t, uint32_t>& a, const pair<uint32_t, uint32_t>& b) {
+	return a.first < b.first;
+}
+
+
+vector<uint32_t> schedule_instructions(const Program& prog) {
+
+	const vector<Instruction>& instructions = prog.get_instructions();
+	uint32_t num_instructions = instructions.size();
+
+	vector<uint32_t> defining_instruction;
+	find_defining_instructions(prog, &defining_instruction);
+
+	// the units scheduled: the lanes of every Vector Instruction if the program is vectorized, and every Instruction otherwise
+	// unit u is made of the Instructions members[member_start[u]] to members[member_start[u + 1] - 1], which are emitted together
+	const vector<VectorInstruction>& plan = prog.get_vector_instructions();
+	vector<uint32_t> members, member_start;
+	members.reserve(num_instructions);
+	if (plan.empty()) {
+		for (uint32_t i = 0; i < num_instructions; i++) {
+			member_start.push_back(i);
+			members.push_back(i);
+		}
+	} else {
+		for (uint32_t v = 0; v < plan.size(); v++) {
+			member_start.push_back(members.size());
+			for (uint32_t lane = 0; lane < plan[v].width; lane++) members.push_back(defining_instruction[plan[v].result + lane]);
+		}
+	}
+	member_start.push_back(members.size());
+	uint32_t num_units = member_start.size() - 1;
+
+	vector<uint32_t> unit_of(num_instructions);
+	for (uint32_t u = 0; u < num_units; u++) {
+		for (uint32_t m = member_start[u]; m < member_start[u + 1]; m++) unit_of[members[m]] = u;
+	}
+
+	// the units defining each unit's operands (not inputs and constants), in the order they are visited,
+	// from deps[dep_start[u]] to deps[dep_start[u + 1] - 1]
+	vector<uint32_t> deps, dep_start;
+	// the number of units using each unit's results
+	vector<uint32_t> num_users(num_units, 0);
+	// the Sethi-Ullman label of each unit
+	vector<uint32_t> labels(num_units);
+	// the last unit that listed each unit as an operand's definition
+	vector<uint32_t> listed_by(num_units, NONE);
+
+	// units are labelled in the order they run (the order of the program, or of its plan), so every operand is labelled first
+	for (uint32_t u = 0; u < num_units; u++) {
+		vector<pair<uint32_t, uint32_t> > unit_deps;
+		vector<uint32_t> operand_labels;
+
+		for (uint32_t m = member_start[u]; m < member_start[u + 1]; m++) {
+			const Instruction& inst = instructions[members[m]];
+			uint32_t operands[2] = {inst.operand1, inst.operand2};
+
+			for (int k = 0; k < 2; k++) {
+				if (operands[k] == INVALID_SLOT) continue;
+				uint32_t dep = defining_instruction[operands[k]];
+				if (dep != NONE) {
+					dep = unit_of[dep];
+					operand_labels.push_back(labels[dep]);
+					if (listed_by[dep] == u) continue;
+					listed_by[dep] = u;
+					num_users[dep]++;
+					// the operand with the larger label is visited first, and on a tie, the one used first
+					unit_deps.push_back(make_pair(UINT32_MAX - labels[dep], dep));
+				} else if (prog.get_slot_type(operands[k]) != VariableType::CONSTANT) {
+					operand_labels.push_back(1);
+				}
+			}
+		}
+
+		// evaluating the operand that needs more values first means only one of its values is held while the others are evaluated,
+		// so with the labels in decreasing order, the k-th operand needs its label plus the k values held before it
+		sort(operand_labels.rbegin(), operand_labels.rend());
+		labels[u] = 1;
+		for (uint32_t k = 0; k < operand_labels.size(); k++) labels[u] = max(labels[u], operand_labels[k] + k);
+
+		stable_sort(unit_deps.begin(), unit_deps.end(), compare_first);
+		dep_start.push_back(deps.size());
+		for (uint32_t d = 0; d < unit_deps.size(); d++) deps.push_back(unit_deps[d].second);
+	}
+	dep_start.push_back(deps.size());
+
+	// depth-first search from every root, emitting each unit after its operands
+	// 0 means not yet visited, 1 means its operands are being visited, 2 means emitted
+	vector<uint8_t> states(num_units, 0);
+	vector<uint32_t> stack;
+	vector<uint32_t> order;
+	order.reserve(num_instructions);
+
+	for (uint32_t root = 0; root < num_units; root++) {
+		if (num_users[root] != 0 || states[root] != 0) continue;
+		stack.push_back(root);
+
+		while (!stack.empty()) {
+			uint32_t u = stack.back();
+
+			if (states[u] == 2) {
+				stack.pop_back();
+			}
+
+			else if (states[u] == 1) {
+				stack.pop_back();
+				for (uint32_t m = member_start[u]; m < member_start[u + 1]; m++) order.push_back(members[m]);
+				states[u] = 2;
+			}
+
+			else {
+				states[u] = 1;
+				// the first operand to visit is pushed last
+				for (uint32_t d = dep_start[u + 1]; d > dep_start[u]; d--) {
+					if (states[deps[d - 1]] == 0) stack.push_back(deps[d - 1]);
+				}
+			}
+		}
+	}
+
+	return order;
+}
+
+
+uint32_t peak_live_values(const Program& prog, const vector<uint32_t>& order, uint64_t *total_live_range) {
+
+	const vector<Instruction>& instructions = prog.get_instructions();
+	uint32_t num_slots = prog.get_num_slots();
+	uint32_t num_steps = order.size();
+
+	// the step at which each value is defined, and the step at which it is last used
+	// inputs are defined before the first step
+	vector<uint32_t> defined_at(num_slots, NONE), last_used_at(num_slots, 0);
+	for (uint32_t slot = 0; slot < num_slots; slot++) {
+		if (is_input_slot(prog, slot)) defined_at[slot] = 0;
+	}
+
+	for (uint32_t step = 0; step < num_steps; step++) {
+		const Instruction& inst = instructions[order[step]];
+		last_used_at[inst.operand1] = step;
+		if (inst.operand2 != INVALID_SLOT) last_used_at[inst.operand2] = step;
+		defined_at[inst.result] = step;
+		last_used_at[inst.result] = step;
+	}
+
+	// count the values live at every step: +1 where a value's range starts, -1 just after it ends
+	vector<int64_t> changes(num_steps + 2, 0);
+	uint64_t total = 0;
+	for (uint32_t slot = 0; slot < num_slots; slot++) {
+		if (defined_at[slot] == NONE) continue;
+
+		// outputs are live until the end of the program
+		uint32_t end = prog.get_slot_type(slot) == VariableType::OUTPUT ? num_steps : last_used_at[slot];
+		changes[defined_at[slot]]++;
+		changes[end + 1]--;
+		total += end - defined_at[slot];
+	}
+
+	uint32_t peak = 0;
+	int64_t live = 0;
+	for (uint32_t step = 0; step <= num_steps; step++) {
+		live += changes[step];
+		if (live > peak) peak = live;
+	}
+
+	if (total_live_range != NULL) *total_live_range = total;
+	return peak;
+}
+
+
+
+/* ---------------- Programs -------------- */
+
+int schedule_program(const string& prog_filename, const string& scheduled_filename, ScheduleReport *report) {
+
+	// the whole program is read before anything is written, so the two files may be the same
+	stringstream scheduled;
+	LineReader prog;
+	if (prog.open(prog_filename) != 0) {
+		cerr << "\nInvalid program file name: " << prog_filename << endl << endl;
+		return INVALID_FILE_NAME;
+	}
+	int schedule_success = schedule_program(prog, scheduled, report);
+	prog.close();
+	if (schedule_success != 0) return schedule_success;
+
+	ofstream scheduled_file(scheduled_filename);
+	scheduled_file << scheduled.rdbuf();
+	scheduled_file.close();
+	return 0;
+}
+
+
+int schedule_program(istream& prog_text, ostream& scheduled, ScheduleReport *report) {
+	LineReader reader(prog_text);
+	return schedule_program(reader, scheduled, report);
+}
+
+
+int schedule_program(LineReader& reader, ostream& scheduled, ScheduleReport *report) {
+
+	if (!is_writable(scheduled)) return OTHER_ERROR;
+
+	// load the program, remembering which lines are declarations, and which line defines each Instruction
+	Program prog;
+	vector<string> lines;
+	vector<bool> is_declaration;
+	vector<uint32_t> defining_line;
+
+	const char *line;
+	size_t length;
+	int line_num = 0;
+	while (reader.next_line(&line, &length)) {
+
+		uint32_t num_slots = prog.get_num_slots(), num_instructions = prog.get_num_instructions();
+		int parse_success = prog.parse_line(line, length);
+		if (parse_success != 0) {
+			cerr << "\nERROR, Line " << line_num << ":" << endl;
+			cerr << string(line, length) << endl;
+			cerr << get_error_message(parse_success) << endl << endl;
+			return parse_success;
+		}
+
+		// a definition adds an Instruction (and maybe constant slots), and a declaration adds just the slot it declares
+		if (prog.get_num_instructions() != num_instructions) {
+			defining_line.push_back(lines.size());
+			lines.push_back(string(line, length));
+			is_declaration.push_back(false);
+		} else if (prog.get_num_slots() != num_slots) {
+			lines.push_back(string(line, length));
+			is_declaration.push_back(true);
+		}
+
+		line_num++;
+	}
+
+	// the lanes of every Vector Instruction are scheduled together, so the scheduled program packs them just as well when it is loaded
+	prog.vectorize();
+
+	// schedule the Instructions, and keep the original order if the schedule is no better
+	vector<uint32_t> original_order(prog.get_num_instructions());
+	for (uint32_t i = 0; i < original_order.size(); i++) original_order[i] = i;
+	vector<uint32_t> order = schedule_instructions(prog);
+
+	ScheduleReport r;
+	r.num_instructions = prog.get_num_instructions();
+	r.peak_live_before = peak_live_values(prog, original_order, &r.total_live_range_before);
+	r.peak_live_after = peak_live_values(prog, order, &r.total_live_range_after);
+	r.reordered = r.peak_live_after < r.peak_live_before ||
+		(r.peak_live_after == r.peak_live_before && r.total_live_range_after <= r.total_live_range_before);
+	if (!r.reordered) {
+		order = original_order;
+		r.peak_live_after = r.peak_live_before;
+		r.total_live_range_after = r.total_live_range_before;
+	}
+	if (report != NULL) *report = r;
+
+	// a program whose order is kept is written as it was read
+	if (order == original_order) {
+		for (uint32_t line_num = 0; line_num < lines.size(); line_num++) scheduled << lines[line_num] << "\n";
+		return 0;
+	}
+
+	// every declaration comes first, in its original order, so every slot keeps its number, and the components of a vector
+	// keep consecutive slots for Program::vectorize; only the definitions are reordered
+	for (uint32_t line_num = 0; line_num < lines.size(); line_num++) {
+		if (is_declaration[line_num]) scheduled << lines[line_num] << "\n";
+	}
+
+	for (uint32_t step = 0; step < order.size(); step++) {
+		scheduled << lines[defining_line[order[step]]] << "\n";
+	}
+
+	return 0;
+}
+
+
+void print_schedule_report(const ScheduleReport& report, ostream& out) {
+	out << "Instructions:\t" << report.num_instructions << endl;
+	out << "Peak live values:\t" << report.peak_live_before << " before, " << report.peak_live_after << " after" << endl;
+	out << "Total live range:\t" << report.total_live_range_before << " before, " << report.total_live_range_after << " after" << endl;
+	if (!report.reordered) out << "The schedule was no better, so the original order was kept." << endl;
+}
@@ -0,0 +1,87 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Program.h"
+#include "utilities.h"
+
+using namespace std;
+
+
+/* The Scheduler reorders the lines of a preprocessed TenFlang program (usually a GCP) so that values are used soon after they are defined.
+ *
+ * The Compiler writes the forward lines of a GCP in source order, and then the backward lines in topological order.
+ * A value is often defined thousands of lines before its last use, so many values are live at once,
+ *  and the Interpreter (or a loaded Program) touches memory far apart from one line to the next.
+ * Scheduling cuts the number of values that are live at once, without changing what the program computes.
+ *
+ * The schedule is a Sethi-Ullman style depth-first ordering of the program's dependency graph:
+ *  - Every definition depends on the definitions of its operands. Inputs and constants are defined before the program runs.
+ *  - Each definition is given a label: the number of values needed to evaluate it, as if its operands formed a tree.
+ *  - The definitions no other definition uses (such as the outputs) are the roots. They are visited in program order.
+ *  - Visiting a definition first visits its operands' unvisited definitions, the one with the larger label first,
+ *     and then emits the definition itself.
+ * The depth-first search uses an explicit stack, so arbitrarily deep programs cannot overflow the call stack.
+ *
+ * Every declaration comes first, in its original order, and only the definitions are reordered.
+ * So a loaded program gives every declared variable the same slot, scheduled or not, and the components of a vector stay in consecutive slots.
+ * Constants are given slots as the definitions that use them are loaded, after every declared variable, so their slots may change.
+ * The program is vectorized (see Program::vectorize) before it is scheduled, and the lanes of each Vector Instruction are scheduled as one unit,
+ *  emitted one after another, with the operands of all of them visited first. So the scheduled program packs into the same Vector Instructions.
+ * If the new order would have more values live at once than the original order (or as many, for longer in total),
+ *  the original order is kept, and the program is written as it was read (without its empty lines).
+ */
+
+
+/* Describes how a schedule changed a program.
+ * A value is live from its definition (or from the start of the program, for inputs) until its last use.
+ * Outputs are live until the end of the program, and constants are not counted.
+ */
+struct ScheduleReport {
+	uint32_t num_instructions;
+	/* The largest number of values live at once, in the original order and in the scheduled order. */
+	uint32_t peak_live_before;
+	uint32_t peak_live_after;
+	/* The sum over all values of the number of instructions each is live for. */
+	uint64_t total_live_range_before;
+	uint64_t total_live_range_after;
+	/* False if the original order was kept. */
+	bool reordered;
+};
+
+
+/* Schedules the program stored in the file PROG_FILENAME, writing the scheduled program to SCHEDULED_FILENAME (see below).
+ * The two may be the same file.
+ */
+int schedule_program(const string& prog_filename, const string& scheduled_filename, ScheduleReport *report);
+
+/* Schedules the program read from PROG, and writes the scheduled program to SCHEDULED.
+ * The program is checked as it is loaded (see Program::load), and fills in REPORT if it is not NULL.
+ * Empty lines are dropped.
+ *
+ * Returns 0 on success, and the appropriate error code otherwise (see utilities.h).
+ */
+int schedule_program(istream& prog, ostream& scheduled, ScheduleReport *report);
+int schedule_program(LineReader& prog, ostream& scheduled, ScheduleReport *report);
+
+/* Returns the order in which to run the Instructions of the loaded program PROG (see the top of this file).
+ * Each entry is the index of an Instruction in PROG.get_instructions().
+ * If PROG is vectorized, the lanes of each of its Vector Instructions come one after another, in order.
+ */
+vector<uint32_t> schedule_instructions(const Program& prog);
+
+/* Returns the largest number of values live at once when the Instructions of PROG run in the given ORDER.
+ * Writes the sum of the live ranges of all values into TOTAL_LIVE_RANGE, if it is not NULL.
+ */
+uint32_t peak_live_values(const Program& prog, const vector<uint32_t>& order, uint64_t *total_live_range);
+
+/* Writes a human-readable summary of REPORT to OUT. */
+void print_schedule_report(const ScheduleReport& report, ostream& out);
+
+
+
+#endif
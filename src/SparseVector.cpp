@@ -0,0 +1,59 @@
+#include <cstring>
+#include <algorithm>
+
+#include "SparseVector.h"
+#include "Lexer.h"
+
+using namespace std;
+
+
+bool is_sparse_input_line(const char *line, size_t length) {
+	return memchr(line, ':', length) != NULL;
+}
+
+
+bool is_sparse_input_line(const string& line) {
+	return is_sparse_input_line(line.data(), line.length());
+}
+
+
+int parse_sparse_vector(const char *start, size_t length, SparseVector *vec) {
+
+	vec->indices.clear();
+	vec->values.clear();
+
+	const char *end = start + length;
+	const char *pair = start;
+	while (pair < end) {
+
+		// skip the spaces before the pair
+		if (*pair == ' ') {
+			pair++;
+			continue;
+		}
+
+		const char *pair_end = (const char *) memchr(pair, ' ', end - pair);
+		if (pair_end == NULL) pair_end = end;
+		const char *colon = (const char *) memchr(pair, ':', pair_end - pair);
+		if (colon == NULL) return INVALID_LINE;
+
+		int64_t index;
+		double value;
+		if (!parse_int64(pair, colon - pair, &index) || index < 0 || index >= MAX_VECTOR_SIZE) return INVALID_LINE;
+		if (!parse_number(colon + 1, pair_end - colon - 1, &value)) return INVALID_LINE;
+		if (!vec->indices.empty() && index <= vec->indices.back()) return INVALID_LINE;
+
+		vec->indices.push_back(index);
+		vec->values.push_back(value);
+		pair = pair_end;
+	}
+
+	return 0;
+}
+
+
+double get_sparse_component(const SparseVector& vec, int64_t index) {
+	vector<int64_t>::const_iterator it = lower_bound(vec.indices.begin(), vec.indices.end(), index);
+	if (it == vec.indices.end() || *it != index) return 0;
+	return vec.values[it - vec.indices.begin()];
+}
@@ -0,0 +1,58 @@
+#ifndef SPARSEVECTOR_H
+#define SPARSEVECTOR_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+#include "utilities.h"
+
+using namespace std;
+
+
+/* A SparseVector gives the value of every component of a vector by listing only its non-zero components.
+ * Bag-of-words and one-hot inputs are almost all zeros, so listing every component of them,
+ *  as input files and training data otherwise must ("x.0	0", "x.1	0", ...), costs far more than the values it carries.
+ *
+ * INDICES are the component numbers of the listed components, in increasing order, and VALUES are their values.
+ * Every component that is not listed is 0. The SparseVector does not know the dimension of its vector:
+ *  whoever binds it (the Interpreter, or a Program) does.
+ */
+struct SparseVector {
+	vector<int64_t> indices;
+	vector<double> values;
+};
+
+
+/* Maps the names of vectors to their SparseVectors: the sparse counterpart of a map of {name, value} pairs. */
+typedef unordered_map<string, SparseVector> SparseVariableVector;
+
+
+/* Returns true if LINE, a line of an input file or of training data, gives a whole vector sparsely:
+ *
+ 	x	0:1 17:0.5 2041:-3
+ *
+ * That is, the name of the vector, a tab, and {<component number>:<value>} pairs separated by spaces.
+ * Only sparse lines have a ':', since numbers and variable names never do.
+ */
+bool is_sparse_input_line(const char *line, size_t length);
+bool is_sparse_input_line(const string& line);
+
+/* Parses the {<component number>:<value>} pairs of a sparse line (everything after the tab) at START into VEC.
+ * VEC is cleared first. The pairs are separated by one or more spaces, and there may be none.
+ *
+ * Returns INVALID_LINE if a pair is malformed, a component number is negative or not below MAX_VECTOR_SIZE,
+ *  or the component numbers are not in strictly increasing order.
+ * Returns 0 otherwise.
+ */
+int parse_sparse_vector(const char *start, size_t length, SparseVector *vec);
+
+/* Returns the value of component INDEX of VEC, which is 0 if it is not listed.
+ * Finds it by binary search, so reading a handful of components never scans the whole vector.
+ */
+double get_sparse_component(const SparseVector& vec, int64_t index);
+
+
+
+#endif
@@ -0,0 +1,160 @@
+#include <string.h>
+#include <unordered_map>
+#include <vector>
+
+#include "Symbol.h"
+
+using namespace std;
+
+
+/* The global Symbol Table and its Arena are created on first use, and live until the program exits. */
+SymbolTable *get_global_symbol_table() {
+	static Arena *arena = new Arena();
+	static SymbolTable *table = new SymbolTable(arena);
+	return table;
+}
+
+
+/* ---------------- Constructors --------------- */
+
+Symbol::Symbol() {
+	id = INVALID_SYMBOL_ID;
+}
+
+Symbol::Symbol(const string& name) {
+	id = get_global_symbol_table()->intern(name);
+}
+
+Symbol::Symbol(const char *name) {
+	id = get_global_symbol_table()->intern(name, strlen(name));
+}
+
+Symbol::Symbol(const char *name, size_t length) {
+	id = get_global_symbol_table()->intern(name, length);
+}
+
+Symbol Symbol::from_id(uint32_t id) {
+	Symbol symbol;
+	symbol.id = id;
+	return symbol;
+}
+
+Symbol Symbol::find(const string& name) {
+	return from_id(get_global_symbol_table()->find(name));
+}
+
+
+/* ---------------- Accessors --------------- */
+
+uint32_t Symbol::get_id() const {
+	return id;
+}
+
+bool Symbol::is_valid() const {
+	return id != INVALID_SYMBOL_ID;
+}
+
+const char *Symbol::c_str() const {
+	if (!is_valid()) return "";
+	return get_global_symbol_table()->get_name(id);
+}
+
+string Symbol::str() const {
+	return string(c_str());
+}
+
+bool Symbol::operator==(const Symbol& other) const {
+	return id == other.id;
+}
+
+bool Symbol::operator!=(const Symbol& other) const {
+	return id != other.id;
+}
+
+ostream& operator<<(ostream& out, const Symbol& symbol) {
+	return out << symbol.c_str();
+}
+
+
+/* ---------------- Derived Names --------------- */
+
+/* Each cache maps the ids of a derived name's arguments, packed into 64 bits, to the id of the derived name. */
+static unordered_map<uint64_t, uint32_t> partial_var_cache, intvar_cache, vector_component_cache;
+
+/* The buffer derived names are written into on a cache miss. Its capacity is reused. */
+static vector<char> scratch;
+
+
+/* Returns the packed key of the two given 32-bit values. */
+static uint64_t cache_key(uint32_t first, uint32_t second) {
+	return ((uint64_t) first << 32) | second;
+}
+
+/* Appends the LENGTH characters starting at CHARS to the scratch buffer. */
+static void append_to_scratch(const char *chars, size_t length) {
+	scratch.insert(scratch.end(), chars, chars + length);
+}
+
+/* Appends the decimal digits of NUM (non-negative) to the scratch buffer. */
+static void append_int_to_scratch(int num) {
+	char digits[16];
+	int num_digits = 0;
+	do {
+		digits[num_digits++] = '0' + num % 10;
+		num /= 10;
+	} while (num > 0);
+	while (num_digits > 0) scratch.push_back(digits[--num_digits]);
+}
+
+/* Returns the Symbol of the name in the scratch buffer, and records it in CACHE under KEY. */
+static Symbol intern_scratch(unordered_map<uint64_t, uint32_t>& cache, uint64_t key) {
+	Symbol symbol(scratch.data(), scratch.size());
+	cache.insert(make_pair(key, symbol.get_id()));
+	return symbol;
+}
+
+
+Symbol generate_partial_var_symbol(Symbol var1, Symbol var2) {
+	if (!var1.is_valid() || !var2.is_valid() || var1.c_str()[0] == '\0' || var2.c_str()[0] == '\0') return Symbol();
+
+	uint64_t key = cache_key(var1.get_id(), var2.get_id());
+	unordered_map<uint64_t, uint32_t>::const_iterator cached = partial_var_cache.find(key);
+	if (cached != partial_var_cache.end()) return Symbol::from_id(cached->second);
+
+	scratch.clear();
+	append_to_scratch("d/", 2);
+	append_to_scratch(var1.c_str(), strlen(var1.c_str()));
+	append_to_scratch("/d/", 3);
+	append_to_scratch(var2.c_str(), strlen(var2.c_str()));
+	return intern_scratch(partial_var_cache, key);
+}
+
+
+Symbol generate_intvar_symbol(Symbol var_name, int intvar_num) {
+	if (!var_name.is_valid() || var_name.c_str()[0] == '\0' || intvar_num < 0) return Symbol();
+
+	uint64_t key = cache_key(var_name.get_id(), intvar_num);
+	unordered_map<uint64_t, uint32_t>::const_iterator cached = intvar_cache.find(key);
+	if (cached != intvar_cache.end()) return Symbol::from_id(cached->second);
+
+	scratch.clear();
+	append_to_scratch(var_name.c_str(), strlen(var_name.c_str()));
+	scratch.push_back(':');
+	append_int_to_scratch(intvar_num);
+	return intern_scratch(intvar_cache, key);
+}
+
+
+Symbol generate_vector_component_symbol(Symbol vec_name, int component_num) {
+	if (!vec_name.is_valid() || vec_name.c_str()[0] == '\0' || component_num < 0) return Symbol();
+
+	uint64_t key = cache_key(vec_name.get_id(), component_num);
+	unordered_map<uint64_t, uint32_t>::const_iterator cached = vector_component_cache.find(key);
+	if (cached != vector_component_cache.end()) return Symbol::from_id(cached->second);
+
+	scratch.clear();
+	append_to_scratch(vec_name.c_str(), strlen(vec_name.c_str()));
+	scratch.push_back('.');
+	append_int_to_scratch(component_num);
+	return intern_scratch(vector_component_cache, key);
+}
@@ -0,0 +1,105 @@
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <string>
+#include <ostream>
+#include <functional>
+#include <cstdint>
+
+#include "SymbolTable.h"
+
+using namespace std;
+
+
+/* A Symbol is an interned variable name.
+ * Every phase (Preprocessor, Compiler, Interpreter) keys its tables on Symbols instead of strings.
+ * All Symbols are interned in one global Symbol Table, so a Symbol is just the uint32_t id of its name:
+ *  it is copied, compared and hashed as an integer, and its name is stored exactly once, in the global table's Arena.
+ *
+ * A Symbol can be built implicitly from a string, so tables keyed on Symbols can still be used with string names.
+ * Names are never removed from the global table.
+ * The global table is not thread-safe; Symbols must be interned from one thread at a time.
+ */
+class Symbol {
+
+	uint32_t id;
+
+public:
+
+	/* Constructor.
+	 * Creates an invalid Symbol, which has no name.
+	 */
+	Symbol();
+
+	/* Constructor.
+	 * Creates the Symbol for the given NAME, interning it if needed.
+	 */
+	Symbol(const string& name);
+	Symbol(const char *name);
+	Symbol(const char *name, size_t length);
+
+	/* Returns the Symbol with the given id (which must have been handed out by the global table). */
+	static Symbol from_id(uint32_t id);
+
+	/* Returns the Symbol for NAME if it has been interned, or an invalid Symbol otherwise.
+	 * Unlike the constructors, this never interns NAME.
+	 */
+	static Symbol find(const string& name);
+
+	uint32_t get_id() const;
+	bool is_valid() const;
+
+	/* Return the name of this Symbol. An invalid Symbol's name is empty.
+	 * The pointer returned by c_str stays valid for the life of the program.
+	 */
+	const char *c_str() const;
+	string str() const;
+
+	bool operator==(const Symbol& other) const;
+	bool operator!=(const Symbol& other) const;
+
+};
+
+
+/* Writes the name of SYMBOL to OUT. */
+ostream& operator<<(ostream& out, const Symbol& symbol);
+
+/* Returns the global Symbol Table, in which every Symbol is interned. */
+SymbolTable *get_global_symbol_table();
+
+
+/* ------------------------ Derived Names ------------------- */
+
+/* These functions build the Symbols of names derived from other names.
+ * Each result is cached on the ids of its arguments, so asking for the same name again
+ *  is a single integer hash lookup, and allocates nothing.
+ * On a cache miss the name is written into a reused scratch buffer and interned.
+ * They return an invalid Symbol if any argument is invalid or has an empty name.
+ */
+
+/* Returns the Symbol "d/VAR1/d/VAR2" (see generate_partial_var_name). */
+Symbol generate_partial_var_symbol(Symbol var1, Symbol var2);
+
+/* Returns the Symbol "VAR_NAME:INTVAR_NUM" (see generate_intvar_name).
+ * Returns an invalid Symbol if INTVAR_NUM is negative.
+ */
+Symbol generate_intvar_symbol(Symbol var_name, int intvar_num);
+
+/* Returns the Symbol "VEC_NAME.COMPONENT_NUM" (see Preprocessor::get_vector_component_name).
+ * Returns an invalid Symbol if COMPONENT_NUM is negative.
+ */
+Symbol generate_vector_component_symbol(Symbol vec_name, int component_num);
+
+
+/* Symbols are hashed by id, so tables keyed on Symbols never hash strings. */
+namespace std {
+	template <>
+	struct hash<Symbol> {
+		size_t operator()(const Symbol& symbol) const {
+			return symbol.get_id();
+		}
+	};
+}
+
+
+#endif
@@ -0,0 +1,107 @@
+#include <string.h>
+
+#include "SymbolTable.h"
+
+using namespace std;
+
+
+/* ---------------- Constructor/Destructor --------------- */
+
+SymbolTable::SymbolTable(Arena *arena) {
+	this->arena = arena;
+	names = new ChunkedArray<const char *>(arena);
+	num_slots = INITIAL_NUM_SLOTS;
+	slots = arena->allocate_array<uint32_t>(num_slots);
+	memset(slots, 0xff, num_slots * sizeof(uint32_t));
+}
+
+
+SymbolTable::~SymbolTable() {
+	delete names;
+}
+
+
+/* ---------------- Interning -------------- */
+
+uint32_t SymbolTable::find_slot(const char *name, size_t length, uint32_t hash) const {
+	uint32_t mask = num_slots - 1;
+	for (uint32_t slot = hash & mask; ; slot = (slot + 1) & mask) {
+		uint32_t id = slots[slot];
+		if (id == INVALID_SYMBOL_ID) return slot;
+
+		const char *candidate = (*names)[id];
+		// strncmp stops at the end of a shorter candidate, so it never reads past it
+		if (strncmp(candidate, name, length) == 0 && candidate[length] == '\0') return slot;
+	}
+}
+
+
+void SymbolTable::grow() {
+	uint32_t new_num_slots = num_slots * 2;
+	uint32_t *new_slots = arena->allocate_array<uint32_t>(new_num_slots);
+	memset(new_slots, 0xff, new_num_slots * sizeof(uint32_t));
+
+	// the old slots stay in the arena; they total less than the new slots
+	uint32_t mask = new_num_slots - 1;
+	for (uint32_t id = 0; id < names->get_size(); id++) {
+		const char *name = (*names)[id];
+		uint32_t slot = hash_name(name, strlen(name)) & mask;
+		while (new_slots[slot] != INVALID_SYMBOL_ID) slot = (slot + 1) & mask;
+		new_slots[slot] = id;
+	}
+
+	slots = new_slots;
+	num_slots = new_num_slots;
+}
+
+
+uint32_t SymbolTable::intern(const char *name, size_t length) {
+	uint32_t slot = find_slot(name, length, hash_name(name, length));
+	if (slots[slot] != INVALID_SYMBOL_ID) return slots[slot];
+	if (names->get_size() == INVALID_SYMBOL_ID) return INVALID_SYMBOL_ID;
+
+	char *copy = arena->allocate_array<char>(length + 1);
+	memcpy(copy, name, length);
+	copy[length] = '\0';
+
+	uint32_t id = names->get_size();
+	names->push_back(copy);
+	slots[slot] = id;
+
+	if (2 * names->get_size() > num_slots) grow();
+	return id;
+}
+
+uint32_t SymbolTable::intern(const string& name) {
+	return intern(name.data(), name.size());
+}
+
+
+uint32_t SymbolTable::find(const char *name, size_t length) const {
+	return slots[find_slot(name, length, hash_name(name, length))];
+}
+
+uint32_t SymbolTable::find(const string& name) const {
+	return find(name.data(), name.size());
+}
+
+
+const char *SymbolTable::get_name(uint32_t id) const {
+	return (*names)[id];
+}
+
+uint32_t SymbolTable::get_num_symbols() const {
+	return names->get_size();
+}
+
+
+/* -------------- Helper Functions ---------------- */
+
+uint32_t hash_name(const char *name, size_t length) {
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; i++) {
+		hash ^= (unsigned char) name[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
@@ -0,0 +1,80 @@
+#ifndef SYMBOLTABLE_H
+#define SYMBOLTABLE_H
+
+#include <string>
+#include <cstdint>
+
+#include "Arena.h"
+
+using namespace std;
+
+
+/* The id of a name that has not been interned. */
+#define INVALID_SYMBOL_ID UINT32_MAX
+
+/* The number of slots a Symbol Table starts with. Must be a power of 2. */
+#define INITIAL_NUM_SLOTS 64
+
+
+/* A Symbol Table interns names: each distinct name is stored exactly once, and is given a uint32_t id.
+ * Ids are dense; the first name interned gets id 0, the next new name gets id 1, and so on.
+ * Once interned, two names can be compared by comparing their ids.
+ *
+ * The characters of the names (null-terminated) and the hash table are allocated from an Arena.
+ * The hash table uses open addressing with linear probing, and is kept at most half full.
+ * Each slot holds the id of a name, or INVALID_SYMBOL_ID if it is empty.
+ */
+class SymbolTable {
+
+	Arena *arena;
+
+	/* The characters of each interned name, indexed by id. */
+	ChunkedArray<const char *> *names;
+
+	uint32_t *slots;
+	uint32_t num_slots;
+
+	/* Returns the index of the slot that holds the given NAME, or of the empty slot where it belongs. */
+	uint32_t find_slot(const char *name, size_t length, uint32_t hash) const;
+
+	/* Doubles the number of slots, and re-inserts every name. */
+	void grow();
+
+public:
+
+	/* Constructor.
+	 * Creates an empty table, whose storage is allocated from ARENA.
+	 */
+	SymbolTable(Arena *arena);
+
+	/* Destructor.
+	 * The names and slots belong to the Arena, and are freed along with it.
+	 */
+	~SymbolTable();
+
+	/* Returns the id of the given NAME, interning it first if it has not been seen before.
+	 * Returns INVALID_SYMBOL_ID if NAME is new, but every id below INVALID_SYMBOL_ID has been given out.
+	 */
+	uint32_t intern(const char *name, size_t length);
+	uint32_t intern(const string& name);
+
+	/* Returns the id of the given NAME, or INVALID_SYMBOL_ID if it has not been interned. */
+	uint32_t find(const char *name, size_t length) const;
+	uint32_t find(const string& name) const;
+
+	/* Returns the (null-terminated) name with the given ID.
+	 * ID must be less than the number of symbols.
+	 */
+	const char *get_name(uint32_t id) const;
+
+	/* Returns the number of names interned so far. */
+	uint32_t get_num_symbols() const;
+
+};
+
+
+/* Returns the FNV-1a hash of the LENGTH characters starting at NAME. */
+uint32_t hash_name(const char *name, size_t length);
+
+
+#endif
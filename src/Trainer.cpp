@@ -0,0 +1,683 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+#include <unordered_set>
+
+#include "Trainer.h"
+#include "Preprocessor.h"
+#include "Compiler.h"
+#include "Interpreter.h"
+#include "Scheduler.h"
+#include "Lexer.h"
+
+using namespace std;
+
+
+/* ---------------- Constructor/Destructor --------------- */
+
+Trainer::Trainer() {
+	gcp = new Program();
+	weight_names = new vector<string>();
+	partial_names = new vector<string>();
+	data_types = new unordered_map<Symbol, VariableType>();
+	data_names = new vector<string>();
+	data_vector_dimensions = new unordered_map<Symbol, int64_t>();
+	seeds = new VariableVector();
+	stochastic = false;
+	sgd_options = new SGDOptions();
+	num_processes = 1;
+	hogwild_stats = new HogwildStats();
+	server_stats = new ParameterServerStats();
+	optimizer_options = new OptimizerOptions();
+	checkpoint_options = new CheckpointOptions();
+	built = false;
+}
+
+
+Trainer::~Trainer() {
+	delete gcp;
+	delete weight_names;
+	delete partial_names;
+	delete data_types;
+	delete data_names;
+	delete data_vector_dimensions;
+	delete seeds;
+	delete sgd_options;
+	delete hogwild_stats;
+	delete server_stats;
+	delete optimizer_options;
+	delete checkpoint_options;
+}
+
+
+/* Writes CONTENTS to the file with the given FILENAME, if FILENAME is not empty. */
+static void write_debug_file(const string& filename, const string& contents) {
+	if (filename == "") return;
+	ofstream file(filename);
+	file << contents;
+	file.close();
+}
+
+
+/* ---------------- Building -------------- */
+
+int Trainer::build(const string& prog_filename, const TrainOptions& options) {
+
+	LineReader prog;
+	if (prog.open(prog_filename) != 0) {
+		cerr << "\nInvalid Program file name: " << prog_filename << endl << endl;
+		return INVALID_FILE_NAME;
+	}
+
+	int build_success = build(prog, options);
+	prog.close();
+	return build_success;
+}
+
+
+int Trainer::build(istream& prog, const TrainOptions& options) {
+	LineReader reader(prog);
+	return build(reader, options);
+}
+
+
+int Trainer::build(LineReader& prog, const TrainOptions& options) {
+
+	if (built) return OTHER_ERROR;
+	built = true;
+
+	if (check_optimizer_options(options.optimizer) != 0) {
+		cerr << "\nAn optimizer hyperparameter is out of range." << endl << endl;
+		return OTHER_ERROR;
+	}
+	if (options.stochastic && options.optimizer.type == OptimizerType::LBFGS) {
+		cerr << "\nL-BFGS only trains on the full batch, and cannot be stochastic." << endl << endl;
+		return OTHER_ERROR;
+	}
+	if (options.stochastic && options.sgd.num_threads > 1 && options.optimizer.type != OptimizerType::GRADIENT_DESCENT) {
+		cerr << "\nAsynchronous training only takes plain gradient descent steps." << endl << endl;
+		return OTHER_ERROR;
+	}
+	if (options.num_processes == 0 || (options.stochastic && options.sgd.num_threads > 1 && options.num_processes > 1)) {
+		cerr << "\nStochastic training runs in several threads or in several processes, but not both." << endl << endl;
+		return OTHER_ERROR;
+	}
+	if (options.checkpoint.filename != "" && (options.num_processes > 1 || (options.stochastic && options.sgd.num_threads > 1)
+		|| (!options.stochastic && options.optimizer.type == OptimizerType::LBFGS))) {
+		cerr << "\nOnly single-process training is checkpointed, with any optimizer but L-BFGS." << endl << endl;
+		return OTHER_ERROR;
+	}
+
+	// expand the Shape Program in memory
+	Preprocessor p;
+	p.set_tree_reductions(options.tree_reductions);
+	stringstream exp_prog;
+	int success = p.expand_program(prog, exp_prog);
+	if (success != 0) return success;
+	write_debug_file(options.expanded_prog_filename, exp_prog.str());
+
+	// compile the Expanded Shape Program in memory
+	Compiler c;
+	stringstream gcp_text;
+	success = c.compile(exp_prog, gcp_text);
+	if (success != 0) return success;
+
+	// schedule the GCP, so values are used soon after they are defined
+	if (options.schedule) {
+		stringstream scheduled_gcp_text;
+		success = schedule_program(gcp_text, scheduled_gcp_text, NULL);
+		if (success != 0) return success;
+		gcp_text.str(scheduled_gcp_text.str());
+		gcp_text.clear();
+	}
+	write_debug_file(options.gcp_filename, gcp_text.str());
+
+	// load the GCP, so it is only parsed once
+	success = gcp->load(gcp_text);
+	if (success != 0) return success;
+
+	// the Data Flow Graph knows the type of every variable in the Shape Program
+	// record the weights and the variables that the training data must provide
+	DataFlowGraph *dfg = c.get_dfg();
+	string loss_name = c.get_objective_name();
+	if (loss_name == "") {
+		cerr << "\nThe program has no loss variable to minimize." << endl << endl;
+		return OTHER_ERROR;
+	}
+
+	stochastic = options.stochastic;
+	*sgd_options = options.sgd;
+	num_processes = options.num_processes;
+	*optimizer_options = options.optimizer;
+	*checkpoint_options = options.checkpoint;
+
+	// a program with several losses minimizes their weighted sum, and each weight is a GCP input
+	const vector<uint32_t>& loss_nodes = dfg->get_loss_nodes();
+	for (VariableVector::const_iterator it = options.loss_seeds.begin(); it != options.loss_seeds.end(); ++it) {
+		uint32_t node = dfg->get_node(it->first);
+		if (loss_nodes.size() < 2 || node == INVALID_NODE_ID || dfg->get_type(node) != VariableType::LOSS) {
+			cerr << "\nA seed was given for " << it->first << ", which is not one of several losses." << endl << endl;
+			return OTHER_ERROR;
+		}
+	}
+	if (loss_nodes.size() > 1) {
+		for (vector<uint32_t>::const_iterator it = loss_nodes.begin(); it != loss_nodes.end(); ++it) {
+			string name = dfg->get_name(*it);
+			VariableVector::const_iterator seed = options.loss_seeds.find(name);
+			seeds->insert(make_pair(generate_seed_name(name), seed == options.loss_seeds.end() ? 1 : seed->second));
+		}
+	}
+
+	for (uint32_t node = 0; node < dfg->get_num_ids(); node++) {
+		VariableType type = dfg->get_type(node);
+
+		if (type == VariableType::INPUT || type == VariableType::EXP_OUTPUT) {
+			Symbol name = dfg->get_symbol(node);
+			data_types->insert(make_pair(name, type));
+
+			// training data may give the vectors of these components sparsely
+			size_t vec_name_length;
+			int64_t component_num;
+			if (split_vector_component(name.c_str(), strlen(name.c_str()), &vec_name_length, &component_num)) {
+				int64_t& dimension = (*data_vector_dimensions)[Symbol(name.c_str(), vec_name_length)];
+				dimension = max(dimension, component_num + 1);
+			}
+		}
+
+		else if (type == VariableType::WEIGHT) {
+			string weight_name = dfg->get_name(node);
+			string partial_name = generate_partial_var_name(loss_name, weight_name);
+
+			// the GCP only outputs the partials of the weights that the loss depends on
+			uint32_t partial_slot = gcp->get_slot(partial_name);
+			if (partial_slot == INVALID_SLOT || gcp->get_slot_type(partial_slot) != VariableType::OUTPUT) {
+				cerr << "\nThe loss does not depend on the weight " << weight_name << endl << endl;
+				return OTHER_ERROR;
+			}
+
+			weight_names->push_back(weight_name);
+			partial_names->push_back(partial_name);
+		}
+	}
+
+	if (weight_names->empty()) {
+		cerr << "\nThe program has no weights to train." << endl << endl;
+		return OTHER_ERROR;
+	}
+
+	// the graph numbers its nodes by name, but the GCP gives slots in the order variables are declared
+	for (uint32_t slot = 0; slot < gcp->get_num_slots(); slot++) {
+		if (data_types->count(gcp->get_slot_name(slot)) != 0) data_names->push_back(gcp->get_slot_name(slot).c_str());
+	}
+
+	return 0;
+}
+
+
+
+/* ---------------- Training Data -------------- */
+
+int Trainer::parse_training_data(const string& data_filename, vector<pair<VariableVector, VariableVector> > *training_data) const {
+	return parse_training_data(data_filename, training_data, NULL);
+}
+
+
+int Trainer::parse_training_data(const string& data_filename, vector<pair<VariableVector, VariableVector> > *training_data,
+	vector<SparseVariableVector> *sparse_data) const {
+
+	LineReader data;
+	if (data.open(data_filename) != 0) {
+		cerr << "\nCould not open the training data file " << data_filename << endl << endl;
+		return INVALID_FILE_NAME;
+	}
+
+	return parse_training_data(data, training_data, sparse_data);
+}
+
+
+int Trainer::parse_training_data(istream& data, vector<pair<VariableVector, VariableVector> > *training_data) const {
+	return parse_training_data(data, training_data, NULL);
+}
+
+
+int Trainer::parse_training_data(istream& data, vector<pair<VariableVector, VariableVector> > *training_data,
+	vector<SparseVariableVector> *sparse_data) const {
+	LineReader reader(data);
+	return parse_training_data(reader, training_data, sparse_data);
+}
+
+
+int Trainer::parse_training_data(LineReader& data, vector<pair<VariableVector, VariableVector> > *training_data) const {
+	return parse_training_data(data, training_data, NULL);
+}
+
+
+int Trainer::add_datum(VariableVector *inputs, VariableVector *exp_outputs, SparseVariableVector *sparse_vectors, int64_t num_sparse_components,
+	vector<pair<VariableVector, VariableVector> > *training_data, vector<SparseVariableVector> *sparse_data) const {
+
+	if ((int64_t) (inputs->size() + exp_outputs->size()) + num_sparse_components != (int64_t) data_types->size()) {
+		return INPUT_VALUE_NOT_PROVIDED;
+	}
+
+	inputs->insert(seeds->begin(), seeds->end());
+	training_data->push_back(make_pair(*inputs, *exp_outputs));
+	if (sparse_data != NULL) sparse_data->push_back(*sparse_vectors);
+	inputs->clear();
+	exp_outputs->clear();
+	sparse_vectors->clear();
+	return 0;
+}
+
+
+int Trainer::parse_training_data(LineReader& data, vector<pair<VariableVector, VariableVector> > *training_data,
+	vector<SparseVariableVector> *sparse_data) const {
+	int line_num = 0;
+	return parse_training_data(data, training_data, sparse_data, SIZE_MAX, &line_num);
+}
+
+
+int Trainer::parse_training_data(LineReader& data, vector<pair<VariableVector, VariableVector> > *training_data,
+	vector<SparseVariableVector> *sparse_data, size_t max_data, int *line_num) const {
+
+	if (!built) return OTHER_ERROR;
+
+	// Interpreter input files and training data share a line format
+	Interpreter i;
+
+	string line;
+	string var_name;
+	double var_value;
+	SparseVector sparse_vector;
+	VariableVector inputs, exp_outputs;
+	SparseVariableVector sparse_vectors;
+	size_t first_datum = training_data->size();
+	int parse_success = 0;
+
+	// the vectors of the current datum with components given one by one, and the number of components its sparse vectors stand for
+	unordered_set<Symbol> dense_vectors;
+	int64_t num_sparse_components = 0;
+
+	while (data.next_line(&line)) {
+
+		bool is_sparse = sparse_data != NULL && is_sparse_input_line(line);
+		if (is_sparse) parse_success = i.parse_sparse_input_line(line, &var_name, &sparse_vector);
+		else parse_success = i.parse_input_line(line, &var_name, &var_value);
+
+		// an empty line ends the current datum, if there is one
+		if (parse_success == 0 && var_name == "") {
+			if (!inputs.empty() || !exp_outputs.empty() || !sparse_vectors.empty()) {
+				parse_success = add_datum(&inputs, &exp_outputs, &sparse_vectors, num_sparse_components, training_data, sparse_data);
+				dense_vectors.clear();
+				num_sparse_components = 0;
+			}
+		}
+
+		// a sparse vector stands for every one of its components
+		else if (parse_success == 0 && is_sparse) {
+			Symbol vec_name = Symbol::find(var_name);
+			unordered_map<Symbol, int64_t>::const_iterator dimension = data_vector_dimensions->find(vec_name);
+			if (dimension == data_vector_dimensions->end() ||
+				(!sparse_vector.indices.empty() && sparse_vector.indices.back() >= dimension->second)) {
+				parse_success = INVALID_VAR_NAME;
+			} else if (dense_vectors.count(vec_name) != 0 || sparse_vectors.count(var_name) != 0) {
+				parse_success = VAR_DEFINED_TWICE;
+			} else {
+				swap(sparse_vectors[var_name], sparse_vector);
+				num_sparse_components += dimension->second;
+			}
+		}
+
+		else if (parse_success == 0) {
+			unordered_map<Symbol, VariableType>::const_iterator type = data_types->find(Symbol::find(var_name));
+			if (type == data_types->end()) {
+				parse_success = INVALID_VAR_NAME;
+			} else {
+				VariableVector *datum_part = type->second == VariableType::INPUT ? &inputs : &exp_outputs;
+				if (!datum_part->insert(make_pair(var_name, var_value)).second) parse_success = VAR_DEFINED_TWICE;
+			}
+
+			// with sparse data, a component must not also be given by its vector
+			size_t vec_name_length;
+			int64_t component_num;
+			if (parse_success == 0 && sparse_data != NULL &&
+				split_vector_component(var_name.data(), var_name.length(), &vec_name_length, &component_num)) {
+				string vec_name = var_name.substr(0, vec_name_length);
+				if (sparse_vectors.count(vec_name) != 0) parse_success = VAR_DEFINED_TWICE;
+				dense_vectors.insert(Symbol::find(vec_name));
+			}
+		}
+
+		// if there is an error with this line, print the error message and exit
+		if (parse_success != 0) {
+			cerr << "\nERROR WITH TRAINING DATA, Line " << *line_num << ":" << endl;
+			cerr << line << endl;
+			cerr << get_error_message(parse_success) << endl << endl;
+			return parse_success;
+		}
+
+		(*line_num)++;
+		if (training_data->size() - first_datum >= max_data) break;
+	}
+
+	// the last datum need not be followed by an empty line
+	if (!inputs.empty() || !exp_outputs.empty() || !sparse_vectors.empty()) {
+		parse_success = add_datum(&inputs, &exp_outputs, &sparse_vectors, num_sparse_components, training_data, sparse_data);
+		if (parse_success != 0) {
+			cerr << "\nERROR WITH TRAINING DATA, Line " << *line_num << ":" << endl;
+			cerr << get_error_message(parse_success) << endl << endl;
+			return parse_success;
+		}
+	}
+
+	return 0;
+}
+
+
+
+/* ---------------- Conversion -------------- */
+
+int Trainer::convert_training_data(const string& data_filename, const string& columnar_filename, const ColumnarOptions& options) const {
+
+	LineReader data;
+	if (data.open(data_filename) != 0) {
+		cerr << "\nCould not open the training data file " << data_filename << endl << endl;
+		return INVALID_FILE_NAME;
+	}
+	return convert_training_data(data, columnar_filename, options);
+}
+
+
+int Trainer::convert_training_data(istream& data, const string& columnar_filename, const ColumnarOptions& options) const {
+	LineReader reader(data);
+	return convert_training_data(reader, columnar_filename, options);
+}
+
+
+int Trainer::convert_training_data(LineReader& data, const string& columnar_filename, const ColumnarOptions& options) const {
+
+	if (!built) return OTHER_ERROR;
+
+	// every column is an input or an expected output, and every component of a vector knows its column
+	vector<VariableType> column_kinds;
+	unordered_map<string, vector<int64_t> > vector_columns;
+	for (size_t c = 0; c < data_names->size(); c++) {
+		const string& name = (*data_names)[c];
+		column_kinds.push_back(data_types->at(Symbol::find(name)));
+
+		size_t vec_name_length;
+		int64_t component_num;
+		if (split_vector_component(name.data(), name.length(), &vec_name_length, &component_num)) {
+			string vec_name = name.substr(0, vec_name_length);
+			vector<int64_t>& columns = vector_columns[vec_name];
+			columns.resize(data_vector_dimensions->at(Symbol::find(vec_name)), -1);
+			columns[component_num] = c;
+		}
+	}
+
+	ColumnarWriter writer;
+	int success = writer.open(columnar_filename, *data_names, column_kinds, options);
+	if (success != 0) return success;
+
+	// the data are parsed, and written, a batch at a time
+	const size_t batch_data = 4096;
+	vector<pair<VariableVector, VariableVector> > training_data;
+	vector<SparseVariableVector> sparse_data;
+	vector<double> row(data_names->size());
+	int line_num = 0;
+
+	do {
+		training_data.clear();
+		sparse_data.clear();
+		success = parse_training_data(data, &training_data, &sparse_data, batch_data, &line_num);
+		if (success != 0) {
+			writer.close();
+			remove(columnar_filename.c_str());
+			return success;
+		}
+
+		for (size_t i = 0; i < training_data.size(); i++) {
+			for (size_t c = 0; c < data_names->size(); c++) {
+				const VariableVector& inputs = training_data[i].first;
+				const VariableVector& exp_outputs = training_data[i].second;
+				VariableVector::const_iterator it = inputs.find((*data_names)[c]);
+				if (it != inputs.end()) {
+					row[c] = it->second;
+				} else {
+					it = exp_outputs.find((*data_names)[c]);
+					if (it != exp_outputs.end()) row[c] = it->second;
+				}
+			}
+
+			// a sparse vector gives all of its components, which are zero unless it lists them
+			for (SparseVariableVector::const_iterator it = sparse_data[i].begin(); it != sparse_data[i].end(); ++it) {
+				const vector<int64_t>& columns = vector_columns[it->first];
+				for (size_t k = 0; k < columns.size(); k++) {
+					if (columns[k] >= 0) row[columns[k]] = 0;
+				}
+				for (size_t k = 0; k < it->second.indices.size(); k++) {
+					if (columns[it->second.indices[k]] >= 0) row[columns[it->second.indices[k]]] = it->second.values[k];
+				}
+			}
+			writer.write_row(row.data());
+		}
+	} while (training_data.size() == batch_data);
+
+	return writer.close();
+}
+
+
+int Trainer::convert_csv_data(const string& csv_filename, const string& columnar_filename, const ColumnarOptions& options) const {
+
+	LineReader csv;
+	if (csv.open(csv_filename) != 0) {
+		cerr << "\nCould not open the training data file " << csv_filename << endl << endl;
+		return INVALID_FILE_NAME;
+	}
+	return convert_csv_data(csv, columnar_filename, options);
+}
+
+
+int Trainer::convert_csv_data(istream& csv, const string& columnar_filename, const ColumnarOptions& options) const {
+	LineReader reader(csv);
+	return convert_csv_data(reader, columnar_filename, options);
+}
+
+
+/* Splits the LENGTH characters at LINE, a line of CSV data, at every comma, into FIELDS, without the spaces around each field. */
+static void split_csv_line(const char *line, size_t length, vector<pair<const char *, size_t> > *fields) {
+	fields->clear();
+	size_t start = 0;
+	for (size_t i = 0; i <= length; i++) {
+		if (i < length && line[i] != ',') continue;
+		size_t first = start, last = i;
+		while (first < last && isspace((unsigned char) line[first])) first++;
+		while (last > first && isspace((unsigned char) line[last - 1])) last--;
+		fields->push_back(make_pair(line + first, last - first));
+		start = i + 1;
+	}
+}
+
+
+int Trainer::convert_csv_data(LineReader& csv, const string& columnar_filename, const ColumnarOptions& options) const {
+
+	if (!built) return OTHER_ERROR;
+
+	// the first line names the columns
+	const char *line;
+	size_t length;
+	vector<pair<const char *, size_t> > fields;
+	if (csv.next_line(&line, &length)) split_csv_line(line, length, &fields);
+
+	vector<string> column_names;
+	vector<VariableType> column_kinds;
+	unordered_set<string> seen;
+	int success = 0;
+	for (size_t c = 0; c < fields.size() && success == 0; c++) {
+		string name(fields[c].first, fields[c].second);
+		unordered_map<Symbol, VariableType>::const_iterator type = data_types->find(Symbol::find(name));
+		if (type == data_types->end()) success = INVALID_VAR_NAME;
+		else if (!seen.insert(name).second) success = VAR_DEFINED_TWICE;
+		column_names.push_back(name);
+		column_kinds.push_back(type == data_types->end() ? VariableType::INPUT : type->second);
+	}
+	if (success == 0 && column_names.size() != data_types->size()) success = INPUT_VALUE_NOT_PROVIDED;
+	if (success != 0) {
+		cerr << "\nERROR WITH CSV TRAINING DATA, Line 0:" << endl;
+		cerr << get_error_message(success) << endl << endl;
+		return success;
+	}
+
+	ColumnarWriter writer;
+	success = writer.open(columnar_filename, column_names, column_kinds, options);
+	if (success != 0) return success;
+
+	vector<double> row(column_names.size());
+	int line_num = 1;
+	while (csv.next_line(&line, &length)) {
+		split_csv_line(line, length, &fields);
+
+		// an empty line is no datum
+		if (fields.size() == 1 && fields[0].second == 0) {
+			line_num++;
+			continue;
+		}
+
+		bool valid = fields.size() == row.size();
+		for (size_t c = 0; valid && c < fields.size(); c++) valid = parse_number(fields[c].first, fields[c].second, &row[c]);
+		if (!valid) {
+			cerr << "\nERROR WITH CSV TRAINING DATA, Line " << line_num << ":" << endl;
+			cerr << string(line, length) << endl;
+			cerr << get_error_message(INVALID_LINE) << endl << endl;
+			writer.close();
+			remove(columnar_filename.c_str());
+			return INVALID_LINE;
+		}
+
+		writer.write_row(row.data());
+		line_num++;
+	}
+
+	return writer.close();
+}
+
+
+
+/* ---------------- Training -------------- */
+
+int Trainer::train(const vector<pair<VariableVector, VariableVector> >& training_data, VariableVector *weights) const {
+
+	// every datum is dense
+	return train(training_data, vector<SparseVariableVector>(training_data.size()), weights);
+}
+
+
+int Trainer::train(const vector<pair<VariableVector, VariableVector> >& training_data, const vector<SparseVariableVector>& sparse_data,
+	VariableVector *weights) const {
+
+	if (!built || training_data.empty()) return OTHER_ERROR;
+
+	if (stochastic && sgd_options->num_threads > 1) {
+		*weights = hogwild_gradient_descent(*gcp, *weight_names, *partial_names, training_data, sparse_data, *sgd_options, *optimizer_options,
+			hogwild_stats);
+	} else if (stochastic && num_processes > 1) {
+		*weights = parameter_server_gradient_descent(*gcp, *weight_names, *partial_names, training_data, sparse_data, *sgd_options,
+			*optimizer_options, num_processes, server_stats);
+	} else if (stochastic) {
+		*weights = stochastic_gradient_descent(*gcp, *weight_names, *partial_names, training_data, sparse_data, *sgd_options, *optimizer_options,
+			*checkpoint_options);
+	} else if (num_processes > 1) {
+		*weights = data_parallel_gradient_descent(*gcp, *weight_names, *partial_names, training_data, sparse_data, *optimizer_options,
+			num_processes);
+	} else {
+		*weights = calculate_weights(*gcp, *weight_names, *partial_names, training_data, sparse_data, *optimizer_options, *checkpoint_options);
+	}
+
+	// they all return an empty vector if the GCP could not be executed
+	if (weights->size() != weight_names->size()) return OTHER_ERROR;
+	return 0;
+}
+
+
+int Trainer::train(DataSource *source, VariableVector *weights) const {
+
+	if (!built) return OTHER_ERROR;
+	const vector<string>& column_names = source->get_column_names();
+	for (size_t c = 0; c < column_names.size(); c++) {
+		if (data_types->count(Symbol::find(column_names[c])) == 0) return INVALID_VAR_NAME;
+	}
+
+	if (num_processes > 1 || (stochastic && sgd_options->num_threads > 1)) {
+		cerr << "\nStreamed training runs in one thread of one process." << endl << endl;
+		return OTHER_ERROR;
+	}
+	if (stochastic) {
+		*weights = stochastic_gradient_descent(*gcp, *weight_names, *partial_names, source, *seeds, *sgd_options, *optimizer_options,
+			*checkpoint_options);
+	} else {
+		*weights = calculate_weights(*gcp, *weight_names, *partial_names, source, *seeds, *optimizer_options, *checkpoint_options);
+	}
+
+	if (weights->size() != weight_names->size()) return OTHER_ERROR;
+	return 0;
+}
+
+
+const Program *Trainer::get_gcp() const {
+	return gcp;
+}
+
+const vector<string>& Trainer::get_weight_names() const {
+	return *weight_names;
+}
+
+const vector<string>& Trainer::get_partial_names() const {
+	return *partial_names;
+}
+
+const HogwildStats& Trainer::get_hogwild_stats() const {
+	return *hogwild_stats;
+}
+
+const ParameterServerStats& Trainer::get_server_stats() const {
+	return *server_stats;
+}
+
+
+
+/* ---------------- Pipeline -------------- */
+
+int train(const string& prog_filename, const string& data_filename, const TrainOptions& options, VariableVector *weights,
+	HogwildStats *hogwild_stats, ParameterServerStats *server_stats) {
+
+	Trainer t;
+	int success = t.build(prog_filename, options);
+	if (success != 0) return success;
+
+	// record files are streamed, and never read whole
+	if (is_record_file(data_filename)) {
+		RecordFileSource source;
+		success = source.open(data_filename);
+		if (success == 0) success = t.train(&source, weights);
+		return success;
+	}
+
+	// and so are columnar files, through a mapping
+	if (is_columnar_file(data_filename)) {
+		ColumnarSource source;
+		success = source.open(data_filename);
+		if (success == 0) success = t.train(&source, weights);
+		return success;
+	}
+
+	vector<pair<VariableVector, VariableVector> > training_data;
+	vector<SparseVariableVector> sparse_data;
+	success = t.parse_training_data(data_filename, &training_data, &sparse_data);
+	if (success != 0) return success;
+
+	success = t.train(training_data, sparse_data, weights);
+	if (hogwild_stats != NULL) *hogwild_stats = t.get_hogwild_stats();
+	if (server_stats != NULL) *server_stats = t.get_server_stats();
+	return success;
+}
@@ -0,0 +1,293 @@
+#ifndef TRAINER_H
+#define TRAINER_H
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "GradientDescent.h"
+#include "RecordFile.h"
+#include "ColumnarFile.h"
+#include "Program.h"
+#include "LineReader.h"
+#include "Symbol.h"
+#include "utilities.h"
+
+using namespace std;
+
+
+/* Options for training. */
+struct TrainOptions {
+	/* If not empty, the Expanded Shape Program is also written to this file, for debugging. */
+	string expanded_prog_filename;
+	/* If not empty, the GCP (as it is loaded, after scheduling) is also written to this file, for debugging. */
+	string gcp_filename;
+	/* If true, dot products and reductions are expanded as balanced trees (see Preprocessor::set_tree_reductions). */
+	bool tree_reductions = false;
+	/* If true, the lines of the GCP are scheduled before it is loaded (see Scheduler.h). */
+	bool schedule = true;
+	/* If the Shape Program has several losses, the weight (seed) of each loss in the objective, by loss name.
+	 * Losses that are not named here have weight 1 (see Compiler.h).
+	 */
+	VariableVector loss_seeds;
+	/* If true, the weights are learned by mini-batch stochastic gradient descent, as SGD configures it (see stochastic_gradient_descent),
+	 *  rather than by full-batch gradient descent. With more than one thread, it is asynchronous (see hogwild_gradient_descent).
+	 */
+	bool stochastic = false;
+	SGDOptions sgd;
+	/* If more than 1, training runs in this many worker processes, which split the training data between them.
+	 * Full-batch workers sum their gradients every step (see data_parallel_gradient_descent),
+	 *  and stochastic workers push them to a parameter server, asynchronously (see parameter_server_gradient_descent).
+	 */
+	size_t num_processes = 1;
+	/* The Optimizer that moves the weights, its hyperparameters, and when full-batch gradient descent stops (see Optimizer.h). */
+	OptimizerOptions optimizer;
+	/* Where training writes its checkpoints, and whether it resumes from one (see Checkpoint.h).
+	 * Only single-process training is checkpointed, with any Optimizer but L-BFGS.
+	 */
+	CheckpointOptions checkpoint;
+};
+
+
+/* The Trainer runs every phase of TenFlow in one process: it learns the weights of a Shape Program from a file of training data.
+ *
+ * Without the Trainer, training takes three programs and two intermediate files:
+ *  the preprocessor writes the Expanded Shape Program, the compiler writes the GCP,
+ *  and the Weight Calculation Phase re-reads the GCP for every datum of every iteration.
+ * The Trainer instead passes the Expanded Shape Program and the GCP between phases in memory,
+ *  schedules the GCP, and loads it once, as a Program that is executed for every datum.
+ * The intermediate programs are only written to files if asked for (see TrainOptions).
+ *
+ * Training data files hold one datum after another, separated by empty lines.
+ * Each datum is a block of {<var_name>	<value>} lines, in the same format as Interpreter input files,
+ *  giving the value of every input and expected output of the Shape Program:
+ *
+ 	x.0		3
+ 	x.1		-0.2
+ 	y		1
+
+ 	x.0		2.5
+ 	x.1		0.1
+ 	y		0
+ *
+ * A datum may also give a whole input or expected output vector sparsely, on one line, when asked for sparse data (see SparseVector.h):
+ *
+ 	x		1:0.1
+ 	y		0
+ *
+ */
+class Trainer {
+
+	/* The loaded GCP of the Shape Program being trained. */
+	Program *gcp;
+
+	/* The names of the weights of the Shape Program, and the names of the partial derivatives of the loss with respect to them.
+	 * The ith partial is the partial of the ith weight.
+	 */
+	vector<string> *weight_names;
+	vector<string> *partial_names;
+
+	/* Maps the names of the inputs and expected outputs of the Shape Program to their types. */
+	unordered_map<Symbol, VariableType> *data_types;
+
+	/* The names of the inputs and expected outputs of the Shape Program, in the order they are declared. */
+	vector<string> *data_names;
+
+	/* Maps the names of the input and expected output vectors of the Shape Program to their dimensions. */
+	unordered_map<Symbol, int64_t> *data_vector_dimensions;
+
+	/* The seeds of the losses of a Shape Program with several losses, which are inputs of the GCP for every datum. */
+	VariableVector *seeds;
+
+	/* Whether training is stochastic, and how (see TrainOptions). */
+	bool stochastic;
+	SGDOptions *sgd_options;
+
+	/* The number of worker processes of full-batch training (see TrainOptions). */
+	size_t num_processes;
+
+	/* What happened during the last asynchronous training, if any, with threads or with a parameter server. */
+	HogwildStats *hogwild_stats;
+	ParameterServerStats *server_stats;
+
+	/* The Optimizer that training uses (see TrainOptions). */
+	OptimizerOptions *optimizer_options;
+
+	/* The checkpoints of training (see TrainOptions). */
+	CheckpointOptions *checkpoint_options;
+
+	/* Returns true once a Shape Program has been built. */
+	bool built;
+
+	/* Appends the datum made of INPUTS, EXP_OUTPUTS and SPARSE_VECTORS to the training data (and SPARSE_DATA, if it is not NULL),
+	 *  and clears them for the next datum. NUM_SPARSE_COMPONENTS is the number of components the sparse vectors stand for.
+	 * Returns INPUT_VALUE_NOT_PROVIDED if the datum does not give every input and expected output, and 0 otherwise.
+	 */
+	int add_datum(VariableVector *inputs, VariableVector *exp_outputs, SparseVariableVector *sparse_vectors, int64_t num_sparse_components,
+		vector<pair<VariableVector, VariableVector> > *training_data, vector<SparseVariableVector> *sparse_data) const;
+
+	/* Parses the training data read from DATA, as the public parse_training_data does, but stops once MAX_DATA data have been appended,
+	 *  just after the empty line that ends the last of them, so the next call carries on with the next datum.
+	 * LINE_NUM is the number of lines read before this call (for error messages), and is advanced past the lines it reads.
+	 */
+	int parse_training_data(LineReader& data, vector<pair<VariableVector, VariableVector> > *training_data,
+		vector<SparseVariableVector> *sparse_data, size_t max_data, int *line_num) const;
+
+
+public:
+
+	/* Constructor.
+	 * Initializes an empty GCP, and empty tables of names.
+	 */
+	Trainer();
+
+	/* Destructor.
+	 * Deletes the GCP and the tables of names.
+	 */
+	~Trainer();
+
+	/* Builds the Shape Program stored in the file with the given PROG_FILENAME (see below).
+	 * Returns 0 on success, and the appropriate error code otherwise (see utilities.h).
+	 */
+	int build(const string& prog_filename, const TrainOptions& options);
+
+	/* Preprocesses and compiles the Shape Program read from PROG, and loads its GCP.
+	 * The Expanded Shape Program and the GCP are kept in memory,
+	 *  and only written to files if OPTIONS names them.
+	 * Records the names of the weights, their partials, and the inputs and expected outputs of the program.
+	 *
+	 * Every weight must have a partial that is an output of the GCP.
+	 * If the program has several losses, their weighted sum is trained, and OPTIONS gives the weights (see TrainOptions).
+	 * Returns OTHER_ERROR if the program has no loss variable, no weights, or a weight the loss does not depend on.
+	 * Returns OTHER_ERROR if OPTIONS gives the seed of a variable that is not a loss, or an Optimizer hyperparameter that is out of range,
+	 *  or asks for stochastic training with L-BFGS, or for asynchronous training with any Optimizer but plain gradient descent,
+	 *  or for checkpoints of L-BFGS, or of training in several threads or processes.
+	 * Returns 0 on success, and the appropriate error code otherwise (see utilities.h).
+	 * A Trainer can only build one Shape Program.
+	 */
+	int build(istream& prog, const TrainOptions& options);
+	int build(LineReader& prog, const TrainOptions& options);
+
+	/* Parses the training data stored in the file with the given DATA_FILENAME (see below). */
+	int parse_training_data(const string& data_filename, vector<pair<VariableVector, VariableVector> > *training_data) const;
+
+	/* Parses the training data read from DATA (see the comment at the top of this class),
+	 *  appending one {input VariableVector, expected output VariableVector} pair to TRAINING_DATA for every datum.
+	 * A Shape Program must have been built first, so the inputs and expected outputs are known.
+	 * The seeds of the losses, if the program has several, are added to the inputs of every datum.
+	 *
+	 * Returns INVALID_VAR_NAME if a name is not an input or expected output of the Shape Program.
+	 * Returns VAR_DEFINED_TWICE if a datum gives the same variable twice.
+	 * Returns INPUT_VALUE_NOT_PROVIDED if a datum is missing an input or expected output.
+	 * Returns 0 on success, or another error code on failure (see utilities.h).
+	 */
+	int parse_training_data(istream& data, vector<pair<VariableVector, VariableVector> > *training_data) const;
+	int parse_training_data(LineReader& data, vector<pair<VariableVector, VariableVector> > *training_data) const;
+
+	/* Parses training data as above, where a datum may also give whole vectors sparsely (see the comment at the top of this class).
+	 * Appends one SparseVariableVector to SPARSE_DATA for every datum, holding the vectors it gives sparsely (possibly none).
+	 * A sparse vector stands for all of its components: a datum must give each of its inputs and expected outputs once,
+	 *  either by itself or as a component of a sparse vector.
+	 *
+	 * Returns INVALID_VAR_NAME if a sparse vector is not an input or expected output vector, or lists a component beyond its end.
+	 * Returns VAR_DEFINED_TWICE if a datum gives a component both by itself and in its sparse vector, or a sparse vector twice.
+	 * Returns the other error codes of the version above in the same cases.
+	 */
+	int parse_training_data(const string& data_filename, vector<pair<VariableVector, VariableVector> > *training_data,
+		vector<SparseVariableVector> *sparse_data) const;
+	int parse_training_data(istream& data, vector<pair<VariableVector, VariableVector> > *training_data,
+		vector<SparseVariableVector> *sparse_data) const;
+	int parse_training_data(LineReader& data, vector<pair<VariableVector, VariableVector> > *training_data,
+		vector<SparseVariableVector> *sparse_data) const;
+
+	/* Converts the training data stored in the file DATA_FILENAME, or read from DATA (see the comment at the top of this class),
+	 *  into the columnar file COLUMNAR_FILENAME, stored as OPTIONS says (see ColumnarFile.h).
+	 * The file has one column for every input and expected output of the Shape Program, in the order they are declared,
+	 *  and vectors given sparsely are written out whole. The seeds of the losses are not data, and have no columns.
+	 * The data are parsed and written a batch of data at a time, so they never need to be in memory all at once (see ColumnarWriter).
+	 * Returns the error codes of parse_training_data (with sparse data), or of ColumnarWriter, and 0 on success.
+	 */
+	int convert_training_data(const string& data_filename, const string& columnar_filename, const ColumnarOptions& options) const;
+	int convert_training_data(istream& data, const string& columnar_filename, const ColumnarOptions& options) const;
+	int convert_training_data(LineReader& data, const string& columnar_filename, const ColumnarOptions& options) const;
+
+	/* Converts the CSV training data stored in the file CSV_FILENAME, or read from CSV, into the columnar file COLUMNAR_FILENAME, as above.
+	 * The first line of the CSV data names the columns, which must be every input and expected output of the Shape Program, once, in any order,
+	 *  and every other line is a datum, giving the value of every column, in that order. Spaces around a field are ignored, and so are empty lines:
+	 *
+	 	x.0,x.1,y
+	 	3,-0.2,1
+	 	2.5,0.1,0
+	 *
+	 * The columns of the file are those of the CSV data, in the same order.
+	 * Returns INVALID_VAR_NAME if a column is not an input or expected output of the Shape Program, VAR_DEFINED_TWICE if it is named twice,
+	 *  INPUT_VALUE_NOT_PROVIDED if an input or expected output has no column, and INVALID_LINE if a datum is not one number for every column.
+	 * Returns the error codes of ColumnarWriter otherwise, and 0 on success.
+	 */
+	int convert_csv_data(const string& csv_filename, const string& columnar_filename, const ColumnarOptions& options) const;
+	int convert_csv_data(istream& csv, const string& columnar_filename, const ColumnarOptions& options) const;
+	int convert_csv_data(LineReader& csv, const string& columnar_filename, const ColumnarOptions& options) const;
+
+	/* Runs the Gradient Descent Algorithm (see calculate_weights) on the built Shape Program's GCP,
+	 *  or mini-batch stochastic gradient descent if the Trainer was built with the stochastic option (see stochastic_gradient_descent),
+	 *  with the Optimizer it was built with. With more than one thread, the staleness and conflicts of the steps are kept (see get_hogwild_stats).
+	 * With more than one process, training is split between worker processes (see data_parallel_gradient_descent),
+	 *  which take stochastic steps through a parameter server (see parameter_server_gradient_descent, and get_server_stats).
+	 * Single-process training writes checkpoints, and resumes from them, as the Trainer was built to (see TrainOptions).
+	 * Writes the learned weights into WEIGHTS.
+	 * Returns 0 on success, and OTHER_ERROR if the GCP could not be executed on the training data,
+	 *  or if a checkpoint could not be resumed or written.
+	 */
+	int train(const vector<pair<VariableVector, VariableVector> >& training_data, VariableVector *weights) const;
+
+	/* Runs the Gradient Descent Algorithm on training data with sparse inputs, with sparse gradients (see calculate_weights).
+	 * SPARSE_DATA has one entry for every datum, as parse_training_data writes it.
+	 */
+	int train(const vector<pair<VariableVector, VariableVector> >& training_data, const vector<SparseVariableVector>& sparse_data,
+		VariableVector *weights) const;
+
+	/* Runs the Gradient Descent Algorithm, or mini-batch stochastic gradient descent, as above, on training data streamed from SOURCE,
+	 *  a pass at a time, so the data need not fit in memory (see the streamed versions of calculate_weights and stochastic_gradient_descent).
+	 * Every column of SOURCE must be an input or an expected output of the Shape Program. The seeds of the losses are bound once, for every datum.
+	 * Training writes checkpoints, and resumes from them, as the Trainer was built to, stochastic training included.
+	 *
+	 * Returns INVALID_VAR_NAME if a column is not an input or an expected output.
+	 * Returns OTHER_ERROR if the Trainer was built for training in several threads or processes, which is not streamed,
+	 *  if the GCP could not be executed on the training data, or if a checkpoint could not be resumed or written.
+	 * Returns 0 on success.
+	 */
+	int train(DataSource *source, VariableVector *weights) const;
+
+	/* Returns the loaded GCP. */
+	const Program *get_gcp() const;
+
+	const vector<string>& get_weight_names() const;
+	const vector<string>& get_partial_names() const;
+
+	/* Returns what happened during the last asynchronous training (all zeros if there was none). */
+	const HogwildStats& get_hogwild_stats() const;
+
+	/* Returns what happened on the parameter server during the last stochastic training in several processes (all zeros if there was none). */
+	const ParameterServerStats& get_server_stats() const;
+
+};
+
+
+/* Learns the weights of the Shape Program stored in the file PROG_FILENAME,
+ *  from the training data stored in the file DATA_FILENAME, writing them into WEIGHTS.
+ * This is the whole pipeline in one call: build, parse_training_data and train (see the Trainer class).
+ * The training data may give vectors sparsely, and then training runs sparsely.
+ * If DATA_FILENAME is a record file (see RecordFile.h), or a columnar file (see ColumnarFile.h),
+ *  the training data are streamed from it instead of being read into memory.
+ * If HOGWILD_STATS (or SERVER_STATS) is not NULL, what happened during asynchronous training is written into it
+ *  (see get_hogwild_stats and get_server_stats).
+ *
+ * Returns 0 on success, and the appropriate error code otherwise (see utilities.h).
+ */
+int train(const string& prog_filename, const string& data_filename, const TrainOptions& options, VariableVector *weights,
+	HogwildStats *hogwild_stats = NULL, ParameterServerStats *server_stats = NULL);
+
+
+
+#endif
@@ -1,6 +1,11 @@
 #include "utilities.h"
+#include "Lexer.h"
 #include <fstream>
 #include <iostream>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
 
 
 using namespace std;
@@ -9,94 +14,24 @@ using namespace std;
 
 /* -------------- Enum Classes ---------------- */
 
+/* The Lexer's table of keywords (see Lexer.h) also answers these, so words are never compared one keyword at a time. */
+
 InstructionType get_instruction_type(const string &inst_type) {
-    if (inst_type.compare("declare") == 0) {
-        return InstructionType::DECLARE;
-    }
-    if (inst_type.compare("define") == 0) {
-        return InstructionType::DEFINE;
-    } 
-    if (inst_type.compare("declare_vector") == 0) {
-        return InstructionType::DECLARE_VECTOR;
-    }
-    if (inst_type.compare("define_vector") == 0) {
-        return InstructionType::DEFINE_VECTOR;
-    }
-    if (inst_type.compare("#macro") == 0) {
-        return InstructionType::MACRO;
-    }
-    
-    return InstructionType::INVALID_INST;
+    Token token;
+    classify_token(inst_type.data(), inst_type.length(), &token);
+    return token.instruction_type;
 }
 
 VariableType get_variable_type(const string &var_type) {
-    if (var_type.compare("input") == 0) {
-        return VariableType::INPUT;
-    }
-    if (var_type.compare("output") == 0) {
-        return VariableType::OUTPUT;
-    }
-    if (var_type.compare("exp_output") == 0) {
-        return VariableType::EXP_OUTPUT;
-    }
-    if (var_type.compare("weight") == 0) {
-        return VariableType::WEIGHT;
-    }
-    if (var_type.compare("intvar") == 0) {
-        return VariableType::INTVAR;
-    }
-    if (var_type.compare("loss") == 0) {
-        return VariableType::LOSS;
-    }
-    if (var_type.compare("constant") == 0) {
-        return VariableType::CONSTANT;
-    }
-   
-    return VariableType::INVALID_VAR_TYPE; 
+    Token token;
+    classify_token(var_type.data(), var_type.length(), &token);
+    return token.variable_type;
 }
 
 OperationType get_operation_type(const string &oper) {
-    if (oper.compare("add") == 0) {
-        return OperationType::ADD;
-    }
-    if (oper.compare("sub") == 0) {
-        return OperationType::SUB;
-    }
-    if (oper.compare("mul") == 0) {
-        return OperationType::MUL;
-    }
-    if (oper.compare("dot") == 0) {
-        return OperationType::DOT;
-    }
-    if (oper.compare("logistic") == 0) {
-        return OperationType::LOGISTIC;
-    } 
-    if (oper.compare("exp") == 0) {
-        return OperationType::EXP;
-    }
-    if (oper.compare("pow") == 0) {
-        return OperationType::POW;
-    }
-    if (oper.compare("ln") == 0) {
-        return OperationType::LN;
-    }
-    if (oper.compare("reduce_vector") == 0) {
-        return OperationType::REDUCE_VECTOR;
-    }
-    if (oper.compare("scale_vector") == 0) {
-        return OperationType::SCALE_VECTOR;
-    }
-    if (oper.compare("increment_vector") == 0) {
-        return OperationType::INCREMENT_VECTOR;
-    } 
-    if (oper.compare("component_wise_add") == 0) {
-        return OperationType::COMPONENT_WISE_ADD;
-    }
-    if (oper.compare("component_wise_mul") == 0) {
-        return OperationType::COMPONENT_WISE_MUL;
-    }
-
-    return OperationType::INVALID_OPERATION;
+    Token token;
+    classify_token(oper.data(), oper.length(), &token);
+    return token.operation_type;
 }
 
 
@@ -146,37 +81,50 @@ string get_operation_name(const OperationType oper) {
 /* ------------------ Helper Methods ---------------- */
 
 bool is_constant(const string& name) {
-    size_t size;
-    double d;
+    double value;
+    return parse_number(name.data(), name.length(), &value);
+}
 
-    try {
-        d = stod(name, &size);
-    } catch(const exception& e) {
-        return false;
-    }
+bool is_int(const string& name) {
+    // stoi throws on the same strings this rejects, but exceptions are slow, and most names are not numbers
+    const char *start = name.c_str();
+    char *end;
+    errno = 0;
+    long value = strtol(start, &end, 10);
+    return end != start && end == start + name.length() && errno != ERANGE && value >= INT_MIN && value <= INT_MAX;
+}
 
-    if (size == name.length()) {
-        return true;
-    }
 
-    return false;
+bool parse_int64(const char *start, size_t length, int64_t *value) {
+    // strtoll needs a terminated string, and the longest int64_t has 20 characters
+    char digits[24];
+    if (length == 0 || length >= sizeof(digits)) return false;
+    memcpy(digits, start, length);
+    digits[length] = '\0';
+
+    char *end;
+    errno = 0;
+    long long parsed = strtoll(digits, &end, 10);
+    if (end != digits + length || errno == ERANGE) return false;
+    *value = parsed;
+    return true;
 }
 
-bool is_int(const string& name) {
-    size_t size;
-    int i;
 
-    try {
-        i = stoi(name, &size);
-    } catch(const exception& e) {
-        return false;
-    }
+bool split_vector_component(const char *name, size_t length, size_t *vec_name_length, int64_t *component_num) {
+    const char *dot = (const char *) memchr(name, '.', length);
+    if (dot == NULL || dot == name) return false;
 
-    if (size == name.length()) {
-        return true;
+    // the component number is only digits, so a sign, spaces, or a macro suffix ("z.0_p:3") make this an ordinary name
+    size_t start = dot - name + 1;
+    if (start == length) return false;
+    for (size_t i = start; i < length; i++) {
+        if (name[i] < '0' || name[i] > '9') return false;
     }
 
-    return false;
+    if (!parse_int64(name + start, length - start, component_num)) return false;
+    *vec_name_length = start - 1;
+    return true;
 }
 
 
@@ -191,6 +139,13 @@ bool is_valid_file_name(const string& filename) {
 }
 
 
+bool is_writable(ostream& out) {
+    ofstream *file = dynamic_cast<ofstream*>(&out);
+    if (file != NULL && !file->is_open()) return false;
+    return out.good();
+}
+
+
 bool is_valid_var_name(const string& name) {
     if (name.compare("") == 0) return false;
     if (name.find_first_of("1234567890") != string::npos) return false;
@@ -226,12 +181,18 @@ bool is_valid_vector_operation(const string& name) {
 }
 
 bool is_binary_primitive(const string& name) {
-    OperationType oper_type = get_operation_type(name);
+    return is_binary_primitive(get_operation_type(name));
+}
+
+bool is_binary_primitive(OperationType oper_type) {
     return oper_type == OperationType::ADD || oper_type == OperationType::SUB || oper_type == OperationType::MUL || oper_type == OperationType::POW;
 }
 
 bool is_unary_primitive(const string& name) {
-    OperationType oper_type = get_operation_type(name);
+    return is_unary_primitive(get_operation_type(name));
+}
+
+bool is_unary_primitive(OperationType oper_type) {
     return oper_type == OperationType::LOGISTIC || oper_type == OperationType::EXP || oper_type == OperationType::LN;
 }
 
@@ -255,7 +216,7 @@ bool is_reduce_vector(const string& name) {
     return oper_type == OperationType::REDUCE_VECTOR;
 }
 
-bool is_valid_vector_size(int size) {
+bool is_valid_vector_size(int64_t size) {
     return size > 0 && size <= MAX_VECTOR_SIZE;
 }
 
@@ -266,11 +227,9 @@ bool is_valid_macro_name(const string& name) {
 
 
 bool is_keyword(const string& word) {
-    if (get_instruction_type(word) != InstructionType::INVALID_INST) return true;
-    if (get_variable_type(word) != VariableType::INVALID_VAR_TYPE) return true;
-    if (get_operation_type(word) != OperationType::INVALID_OPERATION) return true;
-    if (word.compare("=") == 0) return true;
-    return false;
+    Token token;
+    classify_token(word.data(), word.length(), &token);
+    return token.token_class == TokenClass::KEYWORD;
 }
 
 
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <vector>
+#include <ostream>
+#include <cstdint>
 
 using namespace std;
 
@@ -14,8 +16,15 @@ using namespace std;
 
 /* ----------------------- Constants ----------------------------- */
 
-/* The maximum size for a vector. */
-#define MAX_VECTOR_SIZE 1000
+/* The maximum size for a vector (2^31 components).
+ * Vector sizes, and component numbers, are 64-bit integers (int64_t) everywhere, so they can reach it without overflowing.
+ * The Preprocessor and the Interpreter accept vectors this large. The Compiler and a loaded Program number variables with uint32_t,
+ *  so they refuse programs with too many variables with TOO_MANY_VARIABLES (see MAX_COMPILED_VARIABLES and MAX_SLOTS).
+ * The Compiler differentiates a vector component by component, not as a unit, so a program that is to be trained
+ *  is limited by MAX_COMPILED_VARIABLES rather than by this: its vectors may have about 2^30 components between them, and fewer
+ *  the more intermediates their operations expand to.
+ */
+#define MAX_VECTOR_SIZE (INT64_C(1) << 31)
 
 /* Types of Errors in the Preprocessor, Compiler or Interpreter. */
 #define INVALID_LINE -1
@@ -33,10 +42,11 @@ using namespace std;
 #define BAD_VECTOR_SIZE -13
 #define INVALID_MACRO_NAME -14
 #define MACROS_NOT_AT_TOP -15
+#define TOO_MANY_VARIABLES -16
 
-#define NUM_ERROR_TYPES 15
+#define NUM_ERROR_TYPES 16
 
-const static string error_messages[15] = {
+const static string error_messages[16] = {
     "Invalid Line.",
     "Invalid Variable Name.",
     "Variable Defined Before Declared.",
@@ -51,7 +61,8 @@ const static string error_messages[15] = {
     "Vectors of Different Dimension.",
     "Invalid Vector Size.",
     "Invalid Macro Name.",
-    "Macros Must All Be Defined At The Top Of The Program."
+    "Macros Must All Be Defined At The Top Of The Program.",
+    "Too Many Variables And Constants."
 };
 
 
@@ -123,8 +134,8 @@ string get_operation_name(const OperationType oper);
 
 /* ------------------------- Assorted Helper Methods ------------------- */
 
-/* Returns true if the given string can be parsed as a double.
- * The try-catch block is because the stof method throws an exception if the string cannot be parsed as a double.
+/* Returns true if the given string can be parsed as a double: if stod would parse all of it, without throwing.
+ * The string is parsed without exceptions (see parse_number in Lexer.h), since most strings checked are variable names.
  */
 bool is_constant(const string& name);
 
@@ -133,10 +144,29 @@ bool is_constant(const string& name);
  */
 bool is_int(const string& name);
 
+/* Parses the LENGTH characters at START as a 64-bit integer into VALUE, without exceptions.
+ * Returns true if all of them make up an integer that fits in an int64_t, and false otherwise (leaving VALUE unchanged).
+ */
+bool parse_int64(const char *start, size_t length, int64_t *value);
+
+/* Splits NAME (LENGTH characters long) into a vector name and a component number, if it resembles "<vector name>.<component number>".
+ * The vector name must be non-empty, and the component number must be a non-negative integer made only of digits.
+ * On success, sets VEC_NAME_LENGTH to the length of the vector name (the component number starts one character later)
+ *  and COMPONENT_NUM to the component number, and returns true. Returns false otherwise.
+ *
+ * ex. "my_vec.12" splits into "my_vec" and 12, but "my_vec", "my_vec.", ".12" and "z.0_p:3" do not split.
+ */
+bool split_vector_component(const char *name, size_t length, size_t *vec_name_length, int64_t *component_num);
+
 /* Returns false if there is no file with the given filename, and true otherwise.
  */
 bool is_valid_file_name(const string& filename);
 
+/* Returns true if lines can be written to the given stream.
+ * A file stream must be open, and any other stream (such as a stringstream) must be in a good state.
+ */
+bool is_writable(ostream& out);
+
 /* Returns true if the given name is a valid user-defined variable name, and false otherwise.
  * Empty strings are invalid names.
  * Strings with numerals are invalid names.
@@ -163,11 +193,13 @@ bool is_valid_primitive(const string& name);
 /* Returns true if the given name is a valid vector operation, and false otherwise. */
 bool is_valid_vector_operation(const string& name);
 
-/* Returns true if the given name is a binary primitive, and false otherwise. */
+/* Returns true if the given name (or operation) is a binary primitive, and false otherwise. */
 bool is_binary_primitive(const string& name);
+bool is_binary_primitive(OperationType oper_type);
 
-/* Returns true if the given name is a unary primitive, and false otherwise. */
+/* Returns true if the given name (or operation) is a unary primitive, and false otherwise. */
 bool is_unary_primitive(const string& name);
+bool is_unary_primitive(OperationType oper_type);
 
 /* Returns true if the given name is a binary vector operation, and false otherwise. */
 bool is_binary_vector_operation(const string& name);
@@ -185,7 +217,7 @@ bool is_reduce_vector(const string& name);
 /* Returns true if the given size is a positive integer less than or equal to MAX_VECTOR_SIZE.
  * Returns false otherwise.
  */
-bool is_valid_vector_size(int size);
+bool is_valid_vector_size(int64_t size);
 
 /* Returns true if the given name is a valid macro name, and false otherwise.
  * Macro names can be anything other than the names of primitive/vector operations.
@@ -206,6 +238,7 @@ string get_error_message(int error_code);
 
 /* Populates the tokens vector with the tokens of LINE.
  * Tokens are delimited by any character in the given DELIMITERS string.
+ * Each token is copied into a string; lex_line (see Lexer.h) reads a line without copying, and classifies its tokens.
  *
  * Returns the number of tokens, or an error code on failure (see utilities.h).
  */
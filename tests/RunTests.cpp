@@ -1,23 +1,57 @@
 #include <stdio.h>
 #include <iostream>
 
-#include "TestNode.h"
+#include "TestLexer.h"
+#include "TestLineReader.h"
+#include "TestOutputSink.h"
+#include "TestSymbolTable.h"
 #include "TestDataFlowGraph.h"
 #include "TestBindingsDictionary.h"
 #include "TestPreprocessor.h"
 #include "TestCompiler.h"
 #include "TestInterpreter.h"
+#include "TestProgram.h"
+#include "TestScheduler.h"
+#include "TestProgramStats.h"
+#include "TestDenseVector.h"
+#include "TestParameterLayout.h"
+#include "TestAllreduce.h"
+#include "TestParameterServer.h"
+#include "TestCheckpoint.h"
+#include "TestDataSource.h"
+#include "TestRecordFile.h"
+#include "TestColumnarFile.h"
+#include "TestOptimizer.h"
+#include "TestLBFGS.h"
 #include "TestGradientDescent.h"
+#include "TestTrainer.h"
 
 using namespace std;
 
 int main(int argc, char *argv[]) {
-	run_node_tests();
+	run_lex_tests();
+	run_lr_tests();
+	run_sink_tests();
+	run_st_tests();
 	run_dfg_tests();
 	run_bd_tests();
 	run_pp_tests();
 	run_comp_tests();
 	run_interp_tests();
+	run_prog_tests();
+	run_sched_tests();
+	run_stats_tests();
+	run_dense_tests();
+	run_layout_tests();
+	run_allreduce_tests();
+	run_ps_tests();
+	run_checkpoint_tests();
+	run_data_source_tests();
+	run_record_file_tests();
+	run_columnar_file_tests();
+	run_opt_tests();
+	run_lbfgs_tests();
 	run_gd_tests();
+	run_train_tests();
 	return 0;
 }
\ No newline at end of file
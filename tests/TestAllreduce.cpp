@@ -0,0 +1,129 @@
+#include <iostream>
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "TestAllreduce.h"
+#include "../src/Allreduce.h"
+#include "TestUtilities.h"
+
+using namespace std;
+
+
+/* Sums, NUM_ROUNDS times, values that every worker fills in from its rank, and fails if a sum is wrong.
+ * Worker 0 hands back the sums of the last round.
+ */
+class SumWorker : public Worker {
+
+	size_t num_values;
+	int num_rounds;
+
+public:
+
+	SumWorker(size_t num_values, int num_rounds) : num_values(num_values), num_rounds(num_rounds) {
+	}
+
+	int run(Communicator *communicator) {
+		vector<double> values(num_values);
+		size_t size = communicator->get_size();
+		for (int round = 0; round < num_rounds; round++) {
+			for (size_t i = 0; i < num_values; i++) values[i] = 1000 * communicator->get_rank() + i + round;
+
+			int error = communicator->allreduce_sum(values.data(), num_values);
+			if (error != 0) return error;
+			for (size_t i = 0; i < num_values; i++) {
+				if (values[i] != 1000 * (size * (size - 1) / 2) + size * (i + round)) return OTHER_ERROR;
+			}
+		}
+		if (communicator->get_rank() == 0) return communicator->write_result(values.data(), num_values);
+		return 0;
+	}
+
+};
+
+
+/* Sums values until the group is aborted, except for worker 1, which fails with BAD_VAR_TYPE after a few sums,
+ *  or kills itself, if KILL is true.
+ */
+class FailingWorker : public Worker {
+
+	bool kill;
+
+public:
+
+	FailingWorker(bool kill) : kill(kill) {
+	}
+
+	int run(Communicator *communicator) {
+		double value = 1;
+		for (int round = 0; ; round++) {
+			if (communicator->get_rank() == 1 && round == 3) {
+				if (kill) raise(SIGKILL);
+				return BAD_VAR_TYPE;
+			}
+			int error = communicator->allreduce_sum(&value, 1);
+			if (error != 0) return error;
+		}
+	}
+
+};
+
+
+
+void test_allreduce_sum() {
+
+	// 7 values do not split evenly between 3 workers, so the shares of the sums differ in size
+	SumWorker worker(7, 5);
+	vector<double> result;
+	assert_equal_int(run_worker_processes(3, 7, &worker, &result), 0, "test_allreduce_sum");
+	assert_equal_int(result.size(), 7, "test_allreduce_sum");
+	assert_equal_double(result[0], 3000 + 12, "test_allreduce_sum");
+	assert_equal_double(result[6], 3000 + 30, "test_allreduce_sum");
+
+	// a single worker sums with no one, and more workers than values leaves some with no share
+	SumWorker single(4, 2);
+	assert_equal_int(run_worker_processes(1, 4, &single, &result), 0, "test_allreduce_sum");
+	assert_equal_double(result[3], 4, "test_allreduce_sum");
+	SumWorker crowded(2, 3);
+	assert_equal_int(run_worker_processes(4, 2, &crowded, &result), 0, "test_allreduce_sum");
+	assert_equal_double(result[1], 6000 + 4 * 3, "test_allreduce_sum");
+
+	assert_equal_int(run_worker_processes(0, 2, &crowded, &result), OTHER_ERROR, "test_allreduce_sum");
+
+	// another child of this process, which finishes while the workers run, is left for this process to wait for
+	pid_t other = fork();
+	if (other == 0) _exit(7);
+	assert_equal_int(run_worker_processes(3, 7, &worker, &result), 0, "test_allreduce_sum");
+	int status = 0;
+	assert_equal_int(waitpid(other, &status, 0), other, "test_allreduce_sum");
+	assert_true(WIFEXITED(status) && WEXITSTATUS(status) == 7, "The other child's exit status is kept", "test_allreduce_sum");
+
+	pass("test_allreduce_sum");
+}
+
+
+void test_allreduce_failure() {
+
+	// the error of the worker that failed stops the others, instead of leaving them waiting for it
+	FailingWorker failing(false);
+	vector<double> result;
+	assert_equal_int(run_worker_processes(3, 1, &failing, &result), BAD_VAR_TYPE, "test_allreduce_failure");
+
+	// a worker that dies cannot say so: the parent stops the others once it sees it die
+	FailingWorker killed(true);
+	assert_equal_int(run_worker_processes(3, 1, &killed, &result), OTHER_ERROR, "test_allreduce_failure");
+
+	pass("test_allreduce_failure");
+}
+
+
+
+void run_allreduce_tests() {
+
+	cout << "\nTesting the Allreduce... " << endl << endl;
+
+	test_allreduce_sum();
+	test_allreduce_failure();
+
+	cout << "\nAll Allreduce Tests Passed." << endl << endl;
+}
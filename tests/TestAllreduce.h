@@ -0,0 +1,17 @@
+#ifndef TEST_ALLREDUCE_H
+#define TEST_ALLREDUCE_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for the allreduce of data-parallel training. */
+
+void test_allreduce_sum();
+void test_allreduce_failure();
+
+void run_allreduce_tests();
+
+
+#endif
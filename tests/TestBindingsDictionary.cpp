@@ -122,6 +122,48 @@ void test_bd_has_been_defined() {
 	pass("test_bd_has_been_defined");
 }
 
+void test_bd_vector_components() {
+
+	BindingsDictionary b;
+
+	// declare the components of vector V, and a scalar variable also named V
+	assert_equal_int(b.add_variable("v.0"), 0, "test_bd_vector_components");
+	assert_equal_int(b.add_variable("v.1"), 0, "test_bd_vector_components");
+	assert_equal_int(b.add_variable("v.2"), 0, "test_bd_vector_components");
+	assert_equal_int(b.add_variable("v"), 0, "test_bd_vector_components");
+	assert_equal_int(b.add_variable("v.1"), -1, "test_bd_vector_components");
+
+	// the components are stored in one buffer, and only the scalar is in the bindings map
+	assert_equal_int(b.bindings->size(), 1, "test_bd_vector_components");
+	assert_equal_int(b.vectors->size(), 1, "test_bd_vector_components");
+	assert_equal_int(b.vectors->at("v")->size(), 3, "test_bd_vector_components");
+
+	// components are bound and read like any other variable
+	assert_true(b.has_been_declared("v.2"), "V.2 is declared", "test_bd_vector_components");
+	assert_false(b.has_been_declared("v.3"), "V.3 is not declared", "test_bd_vector_components");
+	assert_false(b.has_been_defined("v.2"), "V.2 is not defined", "test_bd_vector_components");
+	assert_equal_int(b.bind_value("v.2", 7.5), 0, "test_bd_vector_components");
+	assert_equal_int(b.bind_value("v.2", 8.5), -1, "test_bd_vector_components");
+	assert_equal_int(b.bind_value("v.3", 8.5), -1, "test_bd_vector_components");
+	assert_equal_double(b.get_value("v.2"), 7.5, "test_bd_vector_components");
+	assert_equal_double((*b.vectors->at("v"))[2], 7.5, "test_bd_vector_components");
+	assert_true(b.get_value("v") == DBL_MAX, "The scalar V is still undefined", "test_bd_vector_components");
+
+	// names can be given without building a string or interning them
+	const char *line = "define unseen.0 = 1";
+	assert_equal_int(b.add_variable(line + 7, 8), 0, "test_bd_vector_components");
+	assert_equal_int(b.bind_value(line + 7, 8, -1.25), 0, "test_bd_vector_components");
+	assert_equal_double(b.get_value(line + 7, 8), -1.25, "test_bd_vector_components");
+	assert_false(Symbol::find("unseen.0").is_valid(), "Component names are not interned", "test_bd_vector_components");
+
+	// names that are not components are bound one by one
+	assert_equal_int(b.add_variable("v.1_p:0"), 0, "test_bd_vector_components");
+	assert_equal_int(b.bindings->size(), 2, "test_bd_vector_components");
+	assert_equal_int(b.vectors->size(), 2, "test_bd_vector_components");
+
+	pass("test_bd_vector_components");
+}
+
 
 void run_bd_tests() {
 
@@ -134,6 +176,7 @@ void run_bd_tests() {
 	test_bd_get_value();
 	test_bd_has_been_declared();
 	test_bd_has_been_defined();
+	test_bd_vector_components();
 
 	cout << "\nAll BindingsDictionary Tests Passed." << endl << endl;
 
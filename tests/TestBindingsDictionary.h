@@ -15,6 +15,7 @@ void test_bd_bind_value();
 void test_bd_get_value();
 void test_bd_has_been_declared();
 void test_bd_has_been_defined();
+void test_bd_vector_components();
 
 void run_bd_tests();
 
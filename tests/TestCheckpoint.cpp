@@ -0,0 +1,123 @@
+#include <iostream>
+#include <cstdio>
+
+#include "TestCheckpoint.h"
+#include "../src/Checkpoint.h"
+#include "TestUtilities.h"
+
+using namespace std;
+
+
+/* Returns a state with every field filled in from SEED. */
+static TrainingState make_state(int seed) {
+	TrainingState state;
+	state.weight_names.push_back("w");
+	state.weight_names.push_back("b" + to_string(seed));
+	state.weights.push_back(seed + 0.5);
+	state.weights.push_back(-seed * 0.25);
+	state.num_steps = 10 * seed;
+	state.optimizer_steps = 10 * seed - 1;
+	state.optimizer_state.push_back(vector<double>(2, seed * 0.125));
+	state.optimizer_state.push_back(vector<double>(2, 3.0));
+	state.epoch = seed;
+	state.next_batch = 4;
+	for (int i = 0; i < 6; i++) state.order.push_back((i * 5 + seed) % 6);
+	state.rng_state = "123 456 " + to_string(seed);
+	return state;
+}
+
+static bool states_equal(const TrainingState& a, const TrainingState& b) {
+	return a.weight_names == b.weight_names && a.weights == b.weights && a.num_steps == b.num_steps
+		&& a.optimizer_steps == b.optimizer_steps && a.optimizer_state == b.optimizer_state
+		&& a.epoch == b.epoch && a.next_batch == b.next_batch && a.order == b.order && a.rng_state == b.rng_state;
+}
+
+static bool file_exists(const string& filename) {
+	FILE *file = fopen(filename.c_str(), "rb");
+	if (file == NULL) return false;
+	fclose(file);
+	return true;
+}
+
+
+void test_checkpoint_file() {
+	remove("scratch.ckpt");
+	TrainingState state = make_state(3);
+	TrainingState read;
+
+	assert_equal_int(read_training_state("scratch.ckpt", &read), INVALID_FILE_NAME, "test_checkpoint_file");
+	assert_equal_int(write_training_state("scratch.ckpt", state), 0, "test_checkpoint_file");
+	assert_true(!file_exists("scratch.ckpt.tmp"), "no temporary file is left behind", "test_checkpoint_file");
+	assert_equal_int(read_training_state("scratch.ckpt", &read), 0, "test_checkpoint_file");
+	assert_true(states_equal(state, read), "the state read is the state written", "test_checkpoint_file");
+
+	// a second checkpoint replaces the first
+	TrainingState other = make_state(5);
+	assert_equal_int(write_training_state("scratch.ckpt", other), 0, "test_checkpoint_file");
+	assert_equal_int(read_training_state("scratch.ckpt", &read), 0, "test_checkpoint_file");
+	assert_true(states_equal(other, read), "the second state replaces the first", "test_checkpoint_file");
+
+	// a checkpoint cut short, one with more after it, and one that is not a checkpoint, are all rejected
+	FILE *file = fopen("scratch.ckpt", "rb");
+	vector<char> bytes(4096);
+	bytes.resize(fread(bytes.data(), 1, bytes.size(), file));
+	fclose(file);
+
+	file = fopen("scratch.ckpt", "wb");
+	fwrite(bytes.data(), 1, bytes.size() - 3, file);
+	fclose(file);
+	assert_equal_int(read_training_state("scratch.ckpt", &read), OTHER_ERROR, "test_checkpoint_file");
+
+	file = fopen("scratch.ckpt", "wb");
+	fwrite(bytes.data(), 1, bytes.size(), file);
+	fputc(0, file);
+	fclose(file);
+	assert_equal_int(read_training_state("scratch.ckpt", &read), OTHER_ERROR, "test_checkpoint_file");
+
+	file = fopen("scratch.ckpt", "wb");
+	fputs("weights w = 1.5;\n", file);
+	fclose(file);
+	assert_equal_int(read_training_state("scratch.ckpt", &read), OTHER_ERROR, "test_checkpoint_file");
+
+	assert_equal_int(write_training_state("no_such_directory/scratch.ckpt", state), INVALID_FILE_NAME, "test_checkpoint_file");
+
+	remove("scratch.ckpt");
+	pass("test_checkpoint_file");
+}
+
+
+void test_checkpoint_writer() {
+	remove("scratch.ckpt");
+	TrainingState read;
+
+	// the last state submitted is the one on disk once the writer finishes
+	CheckpointWriter *writer = new CheckpointWriter("scratch.ckpt");
+	for (int seed = 1; seed <= 20; seed++) {
+		TrainingState state = make_state(seed);
+		writer->submit(&state);
+	}
+	assert_equal_int(writer->finish(), 0, "test_checkpoint_writer");
+	assert_equal_int(writer->finish(), 0, "test_checkpoint_writer");
+	delete writer;
+	assert_equal_int(read_training_state("scratch.ckpt", &read), 0, "test_checkpoint_writer");
+	assert_true(states_equal(make_state(20), read), "the last state submitted is written", "test_checkpoint_writer");
+
+	// a checkpoint that cannot be written is reported by finish
+	CheckpointWriter failing("no_such_directory/scratch.ckpt");
+	TrainingState state = make_state(1);
+	failing.submit(&state);
+	assert_equal_int(failing.finish(), INVALID_FILE_NAME, "test_checkpoint_writer");
+
+	remove("scratch.ckpt");
+	pass("test_checkpoint_writer");
+}
+
+
+void run_checkpoint_tests() {
+	cout << "\nTesting the Checkpoints... " << endl << endl;
+
+	test_checkpoint_file();
+	test_checkpoint_writer();
+
+	cout << "\nAll Checkpoint Tests Passed." << endl << endl;
+}
@@ -0,0 +1,17 @@
+#ifndef TEST_CHECKPOINT_H
+#define TEST_CHECKPOINT_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for the checkpoints of training. */
+
+void test_checkpoint_file();
+void test_checkpoint_writer();
+
+void run_checkpoint_tests();
+
+
+#endif
@@ -0,0 +1,202 @@
+#include <iostream>
+#include <cstdio>
+#include <algorithm>
+#include <unistd.h>
+
+#include "TestColumnarFile.h"
+#include "../src/ColumnarFile.h"
+#include "TestUtilities.h"
+#include "TestDataSource.h"
+
+using namespace std;
+
+
+/* Writes NUM_ROWS rows of the input "x" and the expected output "y" into scratch.col, as OPTIONS says: row i holds i, and -i / 2. */
+static int write_scratch_columns(int64_t num_rows, const ColumnarOptions& options) {
+	ColumnarWriter writer;
+	vector<string> column_names = {"x", "y"};
+	vector<VariableType> column_kinds = {VariableType::INPUT, VariableType::EXP_OUTPUT};
+	int success = writer.open("scratch.col", column_names, column_kinds, options);
+	if (success != 0) return success;
+	for (int64_t i = 0; i < num_rows; i++) {
+		double row[] = {(double) i, -i / 2.0};
+		writer.write_row(row);
+	}
+	return writer.close();
+}
+
+
+void test_columnar_file_write() {
+	remove("scratch.col");
+
+	// the columns are read back, with their kinds and types, and the statistics of every chunk
+	ColumnarOptions options;
+	options.chunk_rows = 4;
+	assert_equal_int(write_scratch_columns(10, options), 0, "test_columnar_file_write");
+	assert_true(is_columnar_file("scratch.col"), "a columnar file is recognized", "test_columnar_file_write");
+	assert_true(!is_columnar_file("tests/test_files/inputs/small_net_training_data.txt"), "a text file is not a columnar file",
+		"test_columnar_file_write");
+
+	ColumnarSource source;
+	assert_equal_int(source.open("scratch.col"), 0, "test_columnar_file_write");
+	assert_equal_int(source.get_num_records(), 10, "test_columnar_file_write");
+	assert_true(source.get_column_names() == vector<string>({"x", "y"}), "the columns are read back", "test_columnar_file_write");
+	assert_true(source.get_column_kind(0) == VariableType::INPUT, "the kind of a column is read back", "test_columnar_file_write");
+	assert_true(source.get_column_kind(1) == VariableType::EXP_OUTPUT, "the kind of a column is read back", "test_columnar_file_write");
+	assert_true(source.get_column_type(0) == ColumnType::FLOAT64, "the type of a column is read back", "test_columnar_file_write");
+	assert_equal_int(source.get_chunk_rows(), 4, "test_columnar_file_write");
+
+	ColumnStatistics statistics;
+	assert_true(source.get_statistics(0, 1, &statistics), "a chunk has statistics", "test_columnar_file_write");
+	assert_equal_double(statistics.min, 4, "test_columnar_file_write");
+	assert_equal_double(statistics.max, 7, "test_columnar_file_write");
+	assert_equal_double(statistics.sum, 22, "test_columnar_file_write");
+	assert_true(source.get_statistics(1, 2, &statistics), "the last chunk has statistics", "test_columnar_file_write");
+	assert_equal_double(statistics.min, -4.5, "test_columnar_file_write");
+	assert_equal_double(statistics.max, -4, "test_columnar_file_write");
+	assert_equal_double(statistics.sum, -8.5, "test_columnar_file_write");
+	assert_true(!source.get_statistics(0, 3, &statistics), "there is no chunk past the last", "test_columnar_file_write");
+	assert_true(!source.get_statistics(2, 0, &statistics), "there is no column past the last", "test_columnar_file_write");
+
+	vector<double> xs;
+	assert_true(read_pass(&source, 3, NULL, &xs), "the rows are read back", "test_columnar_file_write");
+	assert_true(xs == vector<double>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), "the rows are read back in order", "test_columnar_file_write");
+	source.close();
+
+	// the rows are laid out a block at a time, so a chunk's statistics may span two blocks, and the rows wait in no file of their own
+	options.chunk_rows = 100000;
+	assert_equal_int(write_scratch_columns(600000, options), 0, "test_columnar_file_write");
+	assert_true(access("scratch.col.tmp", F_OK) != 0, "the rows are not left beside the file", "test_columnar_file_write");
+	assert_equal_int(source.open("scratch.col"), 0, "test_columnar_file_write");
+	assert_equal_int(source.get_num_records(), 600000, "test_columnar_file_write");
+	assert_true(source.get_statistics(0, 5, &statistics), "a chunk has statistics", "test_columnar_file_write");
+	assert_equal_double(statistics.min, 500000, "test_columnar_file_write");
+	assert_equal_double(statistics.max, 599999, "test_columnar_file_write");
+	assert_equal_double(statistics.sum, 54999950000.0, "test_columnar_file_write");
+	assert_true(read_pass(&source, 4096, NULL, &xs), "the rows are read back", "test_columnar_file_write");
+	assert_equal_int(xs.size(), 600000, "test_columnar_file_write");
+	assert_equal_double(xs[524288], 524288, "test_columnar_file_write");
+	assert_equal_double(xs[599999], 599999, "test_columnar_file_write");
+	source.close();
+
+	// float32 columns are widened as they are read, and their statistics are of their stored values
+	options.type = ColumnType::FLOAT32;
+	options.chunk_rows = 0;
+	ColumnarWriter writer;
+	vector<string> column_names = {"x"};
+	vector<VariableType> column_kinds = {VariableType::INPUT};
+	assert_equal_int(writer.open("scratch.col", column_names, column_kinds, options), 0, "test_columnar_file_write");
+	double row[] = {0.1};
+	writer.write_row(row);
+	assert_equal_int(writer.close(), 0, "test_columnar_file_write");
+	assert_equal_int(source.open("scratch.col"), 0, "test_columnar_file_write");
+	assert_true(source.get_column_type(0) == ColumnType::FLOAT32, "the type of a column is read back", "test_columnar_file_write");
+	assert_true(!source.get_statistics(0, 0, &statistics), "a file may have no statistics", "test_columnar_file_write");
+	DataBatch batch;
+	assert_equal_int(source.start_pass(4, NULL), 0, "test_columnar_file_write");
+	assert_equal_int(source.next_batch(&batch), 0, "test_columnar_file_write");
+	assert_equal_int(batch.num_rows, 1, "test_columnar_file_write");
+	assert_true(batch.columns[0][0] == (double) 0.1f, "a float32 value is widened", "test_columnar_file_write");
+	source.close();
+
+	// a writer needs one kind for every column, each an input or an expected output, and a file it can create
+	vector<VariableType> weight_kind = {VariableType::WEIGHT};
+	assert_equal_int(writer.open("scratch.col", column_names, weight_kind, options), OTHER_ERROR, "test_columnar_file_write");
+	assert_equal_int(writer.open("scratch.col", column_names, vector<VariableType>(), options), OTHER_ERROR, "test_columnar_file_write");
+	assert_equal_int(writer.open("scratch.col", vector<string>(), vector<VariableType>(), options), OTHER_ERROR, "test_columnar_file_write");
+	assert_equal_int(writer.open("no_such_directory/scratch.col", column_names, column_kinds, options), INVALID_FILE_NAME,
+		"test_columnar_file_write");
+	assert_equal_int(writer.close(), OTHER_ERROR, "test_columnar_file_write");
+
+	// files that are not whole columnar files are not opened
+	assert_equal_int(source.open("no_such_file.col"), INVALID_FILE_NAME, "test_columnar_file_write");
+	assert_equal_int(source.open("tests/test_files/inputs/small_net_training_data.txt"), OTHER_ERROR, "test_columnar_file_write");
+	options.type = ColumnType::FLOAT64;
+	options.chunk_rows = 2;
+	write_scratch_columns(100, options);
+	FILE *file = fopen("scratch.col", "r+b");
+	fseek(file, 0, SEEK_END);
+	long file_size = ftell(file);
+	fclose(file);
+	assert_equal_int(truncate("scratch.col", file_size - 1), 0, "test_columnar_file_write");
+	assert_equal_int(source.open("scratch.col"), OTHER_ERROR, "test_columnar_file_write");
+	assert_equal_int(source.start_pass(2, NULL), OTHER_ERROR, "test_columnar_file_write");
+	assert_equal_int(truncate("scratch.col", 20), 0, "test_columnar_file_write");
+	assert_equal_int(source.open("scratch.col"), OTHER_ERROR, "test_columnar_file_write");
+
+	remove("scratch.col");
+	pass("test_columnar_file_write");
+}
+
+
+void test_columnar_file_passes() {
+	remove("scratch.col");
+	ColumnarOptions options;
+	write_scratch_columns(1000, options);
+
+	ColumnarSource source;
+	assert_equal_int(source.open("scratch.col"), 0, "test_columnar_file_passes");
+	DataBatch batch;
+	assert_equal_int(source.next_batch(&batch), OTHER_ERROR, "test_columnar_file_passes");
+	assert_equal_int(source.start_pass(0, NULL), OTHER_ERROR, "test_columnar_file_passes");
+
+	// a pass in order gives every row once, in order, in full batches but the last
+	vector<double> xs;
+	assert_true(read_pass(&source, 64, NULL, &xs), "a pass in order is read", "test_columnar_file_passes");
+	assert_equal_int(xs.size(), 1000, "test_columnar_file_passes");
+	for (int i = 0; i < 1000; i++) assert_equal_double(xs[i], i, "test_columnar_file_passes");
+
+	// on a little-endian machine, the batches of a pass in order point into the mapping, and their storage is not used
+	assert_equal_int(source.start_pass(64, NULL), 0, "test_columnar_file_passes");
+	assert_equal_int(source.next_batch(&batch), 0, "test_columnar_file_passes");
+	assert_equal_int(source.next_batch(&batch), 0, "test_columnar_file_passes");
+	bool in_storage = batch.columns[0] >= batch.storage.data() && batch.columns[0] < batch.storage.data() + batch.storage.size();
+	assert_true(in_storage != is_little_endian(), "a float64 column is only copied on a big-endian machine", "test_columnar_file_passes");
+	assert_equal_double(batch.columns[0][0], 64, "test_columnar_file_passes");
+	if (is_little_endian()) {
+		assert_true(batch.columns[1] - batch.columns[0] >= 1000, "the columns are those of the file", "test_columnar_file_passes");
+	}
+
+	// a shuffled pass gives every row once, in another order, which the generator fixes
+	mt19937_64 rng(5);
+	vector<double> shuffled, again, next;
+	assert_true(read_pass(&source, 64, &rng, &shuffled), "a shuffled pass is read", "test_columnar_file_passes");
+	assert_true(read_pass(&source, 64, &rng, &next), "a shuffled pass is read", "test_columnar_file_passes");
+	rng.seed(5);
+	assert_true(read_pass(&source, 64, &rng, &again), "a shuffled pass is read", "test_columnar_file_passes");
+	assert_true(shuffled == again, "the same generator gives the same order", "test_columnar_file_passes");
+	assert_true(shuffled != xs && shuffled != next, "every shuffled pass has an order of its own", "test_columnar_file_passes");
+
+	// rows move across the whole file, not only within chunks
+	assert_true(shuffled[0] >= 64 || shuffled[1] >= 64 || shuffled[2] >= 64, "a shuffled pass mixes the whole file", "test_columnar_file_passes");
+	sort(shuffled.begin(), shuffled.end());
+	assert_true(shuffled == xs, "a shuffled pass gives every row once", "test_columnar_file_passes");
+
+	// a pass can be left before its end, and another started, and batches of one row work too
+	assert_equal_int(source.start_pass(3, &rng), 0, "test_columnar_file_passes");
+	assert_equal_int(source.next_batch(&batch), 0, "test_columnar_file_passes");
+	assert_true(read_pass(&source, 1, NULL, &xs), "a pass after an unfinished one is read", "test_columnar_file_passes");
+	assert_equal_int(xs.size(), 1000, "test_columnar_file_passes");
+	assert_equal_double(xs[999], 999, "test_columnar_file_passes");
+	source.close();
+
+	// an empty file has passes with no batches
+	write_scratch_columns(0, options);
+	assert_equal_int(source.open("scratch.col"), 0, "test_columnar_file_passes");
+	assert_true(read_pass(&source, 4, &rng, &xs), "an empty pass is read", "test_columnar_file_passes");
+	assert_equal_int(xs.size(), 0, "test_columnar_file_passes");
+	source.close();
+
+	remove("scratch.col");
+	pass("test_columnar_file_passes");
+}
+
+
+void run_columnar_file_tests() {
+	cout << "\nTesting the Columnar Files... " << endl << endl;
+
+	test_columnar_file_write();
+	test_columnar_file_passes();
+
+	cout << "\nAll Columnar File Tests Passed." << endl << endl;
+}
@@ -0,0 +1,17 @@
+#ifndef TEST_COLUMNAR_FILE_H
+#define TEST_COLUMNAR_FILE_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for columnar files, and for reading them through a mapping. */
+
+void test_columnar_file_write();
+void test_columnar_file_passes();
+
+void run_columnar_file_tests();
+
+
+#endif
@@ -1,8 +1,12 @@
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <math.h>
 
 #include "TestCompiler.h"
 #include "../src/Compiler.h"
+#include "../src/Interpreter.h"
+#include "../src/Program.h"
 #include "TestUtilities.h"
 
 using namespace std;
@@ -50,7 +54,7 @@ void test_comp_parse_line() {
 	// make sure an input node named X was successfully added to the DFG
 	assert_equal_int(c.parse_line("declare input x"), 0, "test_pp_comp_parse_line");
 	assert_equal_int(c.get_dfg()->get_num_nodes(), 1, "test_pp_comp_parse_line");
-	assert_true(c.get_dfg()->get_node("x")->get_type() == VariableType::INPUT, "New node X should be an INPUT node", "test_comp_parse_line");
+	assert_true(c.get_dfg()->get_type(c.get_dfg()->get_node("x")) == VariableType::INPUT, "New node X should be an INPUT node", "test_comp_parse_line");
 
 	// some basic error checking for declare lines
 	assert_equal_int(c.parse_line("define x 3"), INVALID_LINE, "test_comp_parse_line");
@@ -63,12 +67,12 @@ void test_comp_parse_line() {
 	assert_equal_int(c.parse_line("define z = -2.3"), 0, "test_pp_comp_parse_line");
 
 	assert_equal_int(c.get_dfg()->get_num_nodes(), 2, "test_pp_comp_parse_line");
-	assert_true(c.get_dfg()->get_node("z")->get_type() == VariableType::INTVAR, "New node Z should be an INTVAR node", "test_comp_parse_line");
-	assert_true(c.get_dfg()->get_node("z")->get_operation() == OperationType::ADD, "New node Z should have an ADD operation", "test_comp_parse_line");
-	assert_true(c.get_dfg()->get_node("z")->get_child_one()->is_constant(), "Z's children should be constant", "test_comp_parse_line");
-	assert_true(c.get_dfg()->get_node("z")->get_child_two()->is_constant(), "Z's children should be constant", "test_comp_parse_line");
-	assert_equal_string(c.get_dfg()->get_node("z")->get_child_one_name(), "-2.3", "test_comp_parse_line");
-	assert_equal_string(c.get_dfg()->get_node("z")->get_child_two_name(), "0", "test_comp_parse_line");
+	assert_true(c.get_dfg()->get_type(c.get_dfg()->get_node("z")) == VariableType::INTVAR, "New node Z should be an INTVAR node", "test_comp_parse_line");
+	assert_true(c.get_dfg()->get_operation(c.get_dfg()->get_node("z")) == OperationType::ADD, "New node Z should have an ADD operation", "test_comp_parse_line");
+	assert_true(c.get_dfg()->is_constant(c.get_dfg()->get_child_one(c.get_dfg()->get_node("z"))), "Z's children should be constant", "test_comp_parse_line");
+	assert_true(c.get_dfg()->is_constant(c.get_dfg()->get_child_two(c.get_dfg()->get_node("z"))), "Z's children should be constant", "test_comp_parse_line");
+	assert_equal_string(c.get_dfg()->get_name(c.get_dfg()->get_child_one(c.get_dfg()->get_node("z"))), "-2.3", "test_comp_parse_line");
+	assert_equal_string(c.get_dfg()->get_name(c.get_dfg()->get_child_two(c.get_dfg()->get_node("z"))), "0", "test_comp_parse_line");
 
 	// successful declaration of output P
 	assert_equal_int(c.parse_line("declare output p"), 0, "test_pp_comp_parse_line");
@@ -80,11 +84,11 @@ void test_comp_parse_line() {
 	assert_equal_int(c.parse_line("define p = z"), 0, "test_pp_comp_parse_line");
 
 	assert_equal_int(c.get_dfg()->get_num_nodes(), 3, "test_pp_comp_parse_line");
-	assert_true(c.get_dfg()->get_node("p")->get_type() == VariableType::OUTPUT, "New node P should be an OUTPUT node", "test_comp_parse_line");
-	assert_true(c.get_dfg()->get_node("p")->get_operation() == OperationType::ADD, "New node P should have an ADD operation", "test_comp_parse_line");
-	assert_true(c.get_dfg()->get_node("p")->get_child_one() == c.get_dfg()->get_node("z"), "P's first child should be Z", "test_comp_parse_line");
-	assert_true(c.get_dfg()->get_node("p")->get_child_two()->is_constant(), "P's second child should be constant (0)", "test_comp_parse_line");
-	assert_equal_string(c.get_dfg()->get_node("p")->get_child_two_name(), "0", "test_comp_parse_line");
+	assert_true(c.get_dfg()->get_type(c.get_dfg()->get_node("p")) == VariableType::OUTPUT, "New node P should be an OUTPUT node", "test_comp_parse_line");
+	assert_true(c.get_dfg()->get_operation(c.get_dfg()->get_node("p")) == OperationType::ADD, "New node P should have an ADD operation", "test_comp_parse_line");
+	assert_true(c.get_dfg()->get_child_one(c.get_dfg()->get_node("p")) == c.get_dfg()->get_node("z"), "P's first child should be Z", "test_comp_parse_line");
+	assert_true(c.get_dfg()->is_constant(c.get_dfg()->get_child_two(c.get_dfg()->get_node("p"))), "P's second child should be constant (0)", "test_comp_parse_line");
+	assert_equal_string(c.get_dfg()->get_name(c.get_dfg()->get_child_two(c.get_dfg()->get_node("p"))), "0", "test_comp_parse_line");
 
 
 	// successful declaration of intvar Q
@@ -97,10 +101,10 @@ void test_comp_parse_line() {
 	assert_equal_int(c.parse_line("define q = exp p"), 0, "test_pp_comp_parse_line");
 
 	assert_equal_int(c.get_dfg()->get_num_nodes(), 4, "test_pp_comp_parse_line");
-	assert_true(c.get_dfg()->get_node("q")->get_type() == VariableType::INTVAR, "New node Q should be an INTVAR node", "test_comp_parse_line");
-	assert_true(c.get_dfg()->get_node("q")->get_operation() == OperationType::EXP, "New node Q should have an EXP operation", "test_comp_parse_line");
-	assert_true(c.get_dfg()->get_node("q")->get_child_one() == c.get_dfg()->get_node("p"), "Q's first child should be P", "test_comp_parse_line");
-	assert_equal_int(c.get_dfg()->get_node("q")->get_num_children(), 1, "test_comp_parse_line");
+	assert_true(c.get_dfg()->get_type(c.get_dfg()->get_node("q")) == VariableType::INTVAR, "New node Q should be an INTVAR node", "test_comp_parse_line");
+	assert_true(c.get_dfg()->get_operation(c.get_dfg()->get_node("q")) == OperationType::EXP, "New node Q should have an EXP operation", "test_comp_parse_line");
+	assert_true(c.get_dfg()->get_child_one(c.get_dfg()->get_node("q")) == c.get_dfg()->get_node("p"), "Q's first child should be P", "test_comp_parse_line");
+	assert_equal_int(c.get_dfg()->get_num_children(c.get_dfg()->get_node("q")), 1, "test_comp_parse_line");
 
 
 	// successful declaration of loss L
@@ -113,11 +117,11 @@ void test_comp_parse_line() {
 	assert_equal_int(c.parse_line("define l = mul 3.9 q"), 0, "test_pp_comp_parse_line");
 
 	assert_equal_int(c.get_dfg()->get_num_nodes(), 5, "test_pp_comp_parse_line");
-	assert_true(c.get_dfg()->get_node("l")->get_type() == VariableType::LOSS, "New node L should be an LOSS node", "test_comp_parse_line");
-	assert_true(c.get_dfg()->get_node("l")->get_operation() == OperationType::MUL, "New node L should have a MUL operation", "test_comp_parse_line");
-	assert_true(c.get_dfg()->get_node("l")->get_child_one()->is_constant(), "L's first child should be constant (3.9)", "test_comp_parse_line");
-	assert_equal_string(c.get_dfg()->get_node("l")->get_child_one_name(), "3.9", "test_comp_parse_line");
-	assert_true(c.get_dfg()->get_node("l")->get_child_two() == c.get_dfg()->get_node("q"), "L's second child should be Q", "test_comp_parse_line");
+	assert_true(c.get_dfg()->get_type(c.get_dfg()->get_node("l")) == VariableType::LOSS, "New node L should be an LOSS node", "test_comp_parse_line");
+	assert_true(c.get_dfg()->get_operation(c.get_dfg()->get_node("l")) == OperationType::MUL, "New node L should have a MUL operation", "test_comp_parse_line");
+	assert_true(c.get_dfg()->is_constant(c.get_dfg()->get_child_one(c.get_dfg()->get_node("l"))), "L's first child should be constant (3.9)", "test_comp_parse_line");
+	assert_equal_string(c.get_dfg()->get_name(c.get_dfg()->get_child_one(c.get_dfg()->get_node("l"))), "3.9", "test_comp_parse_line");
+	assert_true(c.get_dfg()->get_child_two(c.get_dfg()->get_node("l")) == c.get_dfg()->get_node("q"), "L's second child should be Q", "test_comp_parse_line");
 
 	pass("test_comp_parse_line");
 
@@ -131,6 +135,8 @@ void test_comp_duplicate_line_for_gcp() {
 	// simple errors
 	assert_equal_int(c.duplicate_line_for_gcp("declare input x", write_scratch_file), OTHER_ERROR, "test_comp_duplicate_line_for_gcp");
 	write_scratch_file.open("scratch.tf");
+	// emitters end lines with '\n' and never flush, so flush after every write to read the file while it is open
+	write_scratch_file << unitbuf;
 	assert_equal_int(c.duplicate_line_for_gcp("", write_scratch_file), 0, "test_comp_duplicate_line_for_gcp");
 	assert_equal_int(c.duplicate_line_for_gcp("define x", write_scratch_file), INVALID_LINE, "test_comp_duplicate_line_for_gcp");
 	assert_equal_int(c.duplicate_line_for_gcp("declaration output o", write_scratch_file), INVALID_LINE, "test_comp_duplicate_line_for_gcp");
@@ -191,31 +197,36 @@ void test_comp_generate_intvar_name() {
 void test_comp_declare_partial_lambda() {
 
 	Compiler c;
+	DataFlowGraph *dfg = c.get_dfg();
 
 	ofstream write_scratch_file;
 
 
-	Node *loss = new Node("lambda", false);
-	loss->set_type(VariableType::LOSS);
-	loss->add_parent(loss);
+	dfg->add_node("lambda", VariableType::LOSS);
+	dfg->add_node("w", VariableType::WEIGHT);
+	dfg->add_node("m", VariableType::INPUT);
+	dfg->add_node("u", VariableType::INVALID_VAR_TYPE);
+	dfg->add_node("parent", VariableType::INTVAR);
+	dfg->add_node("orphan", VariableType::INPUT);
+	uint32_t loss = dfg->get_node("lambda"), w = dfg->get_node("w"), m = dfg->get_node("m");
+	uint32_t u = dfg->get_node("u"), orphan = dfg->get_node("orphan");
 
-	Node *w = new Node("w", false);	// will later be set as weight
-	Node *m = new Node("m", false);
-	m->set_type(VariableType::INPUT);
-	// manually "cheat" by giving W and M parents
-	Node *parent = new Node("parent", false);
-	m->add_parent(parent);
-	w->add_parent(parent);
+	// W, M and U get a parent; ORPHAN does not
+	dfg->add_flow_edge("w", "parent");
+	dfg->add_flow_edge("m", "parent");
+	dfg->add_node("parent_two", VariableType::INTVAR);
+	dfg->add_flow_edge("u", "parent_two");
 
 
 
 	// trivial errors
 	assert_equal_string(c.declare_partial_lambda(w, loss, write_scratch_file), "", "test_comp_declare_partial_lambda");
 	write_scratch_file.open("scratch.tf");
-	assert_equal_string(c.declare_partial_lambda(NULL, loss, write_scratch_file), "", "test_comp_declare_partial_lambda");
-	assert_equal_string(c.declare_partial_lambda(w, loss, write_scratch_file), "", "test_comp_declare_partial_lambda");
-	w->set_type(VariableType::WEIGHT);
-	assert_equal_string(c.declare_partial_lambda(w, NULL, write_scratch_file), "", "test_comp_declare_partial_lambda");
+	write_scratch_file << unitbuf;
+	assert_equal_string(c.declare_partial_lambda(INVALID_NODE_ID, loss, write_scratch_file), "", "test_comp_declare_partial_lambda");
+	assert_equal_string(c.declare_partial_lambda(u, loss, write_scratch_file), "", "test_comp_declare_partial_lambda");
+	assert_equal_string(c.declare_partial_lambda(w, INVALID_NODE_ID, write_scratch_file), "", "test_comp_declare_partial_lambda");
+	assert_equal_string(c.declare_partial_lambda(orphan, loss, write_scratch_file), "", "test_comp_declare_partial_lambda");
 
 	// make sure weight partials become outputs, and others become intvars
 	assert_equal_string(c.declare_partial_lambda(w, loss, write_scratch_file), "d/lambda/d/w", "test_comp_declare_partial_lambda");
@@ -227,7 +238,6 @@ void test_comp_declare_partial_lambda() {
 
 
 	write_scratch_file.close();
-	delete w; delete loss; delete m; delete parent;
 	pass("test_comp_declare_partial_lambda");
 
 }
@@ -235,39 +245,40 @@ void test_comp_declare_partial_lambda() {
 void test_comp_define_partial_lambda() {
 
 	Compiler c;
+	DataFlowGraph *dfg = c.get_dfg();
 
 	ofstream write_scratch_file;
-	Node *node = new Node("node", false), *parent = new Node("parent", false);
-	node->set_type(VariableType::INPUT); parent->set_type(VariableType::INTVAR);
-	
-	node->add_parent(parent);
-	parent->set_child(node);
-	parent->set_operation(OperationType::EXP);
+	dfg->add_node("node", VariableType::INPUT);
+	dfg->add_node("parent", VariableType::INTVAR);
+	dfg->add_node("lambda", VariableType::LOSS);
+	uint32_t node = dfg->get_node("node"), parent = dfg->get_node("parent"), lambda = dfg->get_node("lambda");
 
-	
-	Node *lambda = new Node("lambda", false);
-	lambda->set_type(VariableType::LOSS);
-	lambda->set_child(parent);
-	parent->add_parent(lambda);
-	lambda->set_operation(OperationType::EXP);
+	dfg->add_flow_edge("node", "parent");
+	dfg->set_operation(parent, OperationType::EXP);
+	dfg->add_flow_edge("parent", "lambda");
+	dfg->set_operation(lambda, OperationType::EXP);
 
 	// trivial errors
-	c.define_partial_lambda(NULL, "lambda", write_scratch_file, "d/lambda/d/w");
+	c.define_partial_lambda(INVALID_NODE_ID, "lambda", write_scratch_file, "d/lambda/d/w");
 	c.define_partial_lambda(node, "", write_scratch_file, "d/lambda/d/w");
 	c.define_partial_lambda(node, "lambda", write_scratch_file, "d/lambda/d/w");
 	write_scratch_file.open("scratch.tf");
+	write_scratch_file << unitbuf;
 	c.define_partial_lambda(node, "lambda", write_scratch_file, "");
 
+	// no parent of NODE has been visited yet
+	c.define_partial_lambda(node, "lambda", write_scratch_file, "d/lambda/d/node");
+
 	// make sure partial(loss, loss) = 1 and partial(loss, parent) = exp parent
 	c.define_partial_lambda(lambda, "lambda", write_scratch_file, "d/lambda/d/lambda");
 	c.define_child_one_partial(lambda, write_scratch_file, "d/lambda/d/parent");
-	c.get_visited_nodes()->insert(lambda);
-	c.get_visited_node_names()->insert("lambda");
+	c.mark_visited(lambda);
+	assert_true(c.is_visited(lambda), "LAMBDA has been visited", "test_comp_define_partial_lambda");
+	assert_false(c.is_visited(parent), "PARENT has not been visited", "test_comp_define_partial_lambda");
 
 	// make sure partial(parent, node) = exp node
 	c.define_child_one_partial(parent, write_scratch_file, "d/parent/d/node");
-	c.get_visited_nodes()->insert(parent);
-	c.get_visited_node_names()->insert("parent");
+	c.mark_visited(parent);
 	// make sure partial(loss, node) = partial(loss, parent) * partial(parent, node)
 	c.define_partial_lambda(node, "lambda", write_scratch_file, "d/lambda/d/node");
 
@@ -279,7 +290,6 @@ void test_comp_define_partial_lambda() {
 
 
 	write_scratch_file.close();
-	delete node; delete parent; delete lambda;
 	pass("test_comp_define_partial_lambda");
 
 }
@@ -287,13 +297,9 @@ void test_comp_define_partial_lambda() {
 void test_comp_declare_child_partials() {
 
 	Compiler comp;
+	DataFlowGraph *dfg = comp.get_dfg();
 	ofstream write_scratch_file;
 
-	// trivial errors
-	assert_equal_string(comp.declare_child_one_partial(NULL, write_scratch_file), "", "test_comp_declare_child_partials");
-	assert_equal_string(comp.declare_child_two_partial(new Node("x", false), write_scratch_file), "", "test_comp_declare_child_partials");
-	write_scratch_file.open("scratch.tf");
-
 	// We build a node "tree" that contains all combinations of 1 or 2 constant or variable children:
 
 	/* 
@@ -312,35 +318,32 @@ void test_comp_declare_child_partials() {
 
 	*/
 
-	
-	Node *a = new Node("a", false);
-	a->set_child(new Node("1", true)); a->set_child(new Node("2", true));
-
-	Node *b = new Node("b", false);
-	b->set_child(new Node("3", true));
-
-	Node *c = new Node("c", false);
-	c->set_child(a); c->set_child(b);
-
-	Node *d = new Node("d", false);
-	d->set_child(c); d->set_child(new Node("4", true));
+	string names[6] = {"f", "e", "d", "c", "b", "a"};
+	for (int n = 0; n < 6; n++) dfg->add_node(names[n], VariableType::INTVAR);
+	dfg->add_node("x", VariableType::INTVAR);
 
-	Node *e = new Node("e", false);
-	e->set_child(new Node("5", true)); e->set_child(d);
+	dfg->add_flow_edge("1", "a"); dfg->add_flow_edge("2", "a");
+	dfg->add_flow_edge("3", "b");
+	dfg->add_flow_edge("a", "c"); dfg->add_flow_edge("b", "c");
+	dfg->add_flow_edge("c", "d"); dfg->add_flow_edge("4", "d");
+	dfg->add_flow_edge("5", "e"); dfg->add_flow_edge("d", "e");
+	dfg->add_flow_edge("e", "f");
 
-	Node *f = new Node("f", false);
-	f->set_child(e);
+	// trivial errors
+	assert_equal_string(comp.declare_child_one_partial(INVALID_NODE_ID, write_scratch_file), "", "test_comp_declare_child_partials");
+	assert_equal_string(comp.declare_child_two_partial(dfg->get_node("x"), write_scratch_file), "", "test_comp_declare_child_partials");
+	write_scratch_file.open("scratch.tf");
+	write_scratch_file << unitbuf;
 
-	Node *nodes[6] = {f, e, d, c, b, a};
 	string child_one_partials[6] = {"d/f/d/e", "", "d/d/d/c", "d/c/d/a", "", ""};
 	string child_two_partials[6] = {"", "d/e/d/d", "", "d/c/d/b", "", ""};
 
 	for (int p = 0; p < 6; p++) {
-		assert_equal_string(comp.declare_child_one_partial(nodes[p], write_scratch_file), child_one_partials[p], "test_comp_declare_child_partials");
+		assert_equal_string(comp.declare_child_one_partial(dfg->get_node(names[p]), write_scratch_file), child_one_partials[p], "test_comp_declare_child_partials");
 	}
 
 	for (int q = 0; q < 6; q++) {
-		assert_equal_string(comp.declare_child_two_partial(nodes[q], write_scratch_file), child_two_partials[q], "test_comp_declare_child_partials");
+		assert_equal_string(comp.declare_child_two_partial(dfg->get_node(names[q]), write_scratch_file), child_two_partials[q], "test_comp_declare_child_partials");
 	}
 
 	string child_one_declarations[3] = {"declare intvar d/f/d/e", "declare intvar d/d/d/c", "declare intvar d/c/d/a"};
@@ -350,7 +353,6 @@ void test_comp_declare_child_partials() {
 	assert_equal_file_lines("scratch.tf", child_two_declarations, 3, 2, "test_comp_declare_child_partials");
 
 	write_scratch_file.close();
-	delete a; delete b; delete c; delete d; delete e; delete f;
 	pass("test_comp_declare_child_partials");
 
 }
@@ -358,15 +360,9 @@ void test_comp_declare_child_partials() {
 void test_comp_define_child_partials() {
 
 	Compiler comp;
+	DataFlowGraph *dfg = comp.get_dfg();
 	ofstream write_scratch_file;
 
-	// trivial errors
-	comp.define_child_one_partial(NULL, write_scratch_file, "d/x/d/y");
-	comp.define_child_two_partial(new Node("x", false), write_scratch_file, "d/x/d/y");
-	write_scratch_file.open("scratch.tf");
-	comp.define_child_one_partial(new Node("x", false), write_scratch_file, "");
-
-
 	// We build a node "tree" that contains all combinations of 1 or 2 constant or variable children:
 
 	/* 
@@ -388,42 +384,43 @@ void test_comp_define_child_partials() {
 
 	*/
 
+	string all_names[12] = {"a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "x"};
+	for (int n = 0; n < 12; n++) dfg->add_node(all_names[n], VariableType::INTVAR);
+
+	dfg->add_flow_edge("a", "d"); dfg->add_flow_edge("b", "d");
+	dfg->add_flow_edge("c", "e");
+	dfg->add_flow_edge("d", "f"); dfg->add_flow_edge("e", "f");
+	dfg->add_flow_edge("f", "h"); dfg->add_flow_edge("g", "h");
+	dfg->add_flow_edge("h", "i");
+	dfg->add_flow_edge("i", "j");
+	dfg->add_flow_edge("j", "k"); dfg->add_flow_edge("j", "k");
+
+	dfg->set_operation(dfg->get_node("d"), OperationType::SUB);
+	dfg->set_operation(dfg->get_node("e"), OperationType::EXP);
+	dfg->set_operation(dfg->get_node("f"), OperationType::MUL);
+	dfg->set_operation(dfg->get_node("h"), OperationType::POW);
+	dfg->set_operation(dfg->get_node("i"), OperationType::LN);
+	dfg->set_operation(dfg->get_node("j"), OperationType::LOGISTIC);
+	dfg->set_operation(dfg->get_node("k"), OperationType::MUL);
 
-	Node *a = new Node("a", false), *b = new Node("b", false), *c = new Node("c", false);
-	Node *d = new Node("d", false), *e = new Node("e", false);
-	Node *f = new Node("f", false), *g = new Node("g", false);
-	Node *h = new Node("h", false);
-	Node *i = new Node("i", false);
-	Node *j = new Node("j", false);
-	Node *k = new Node("k", false);
-
-
-	d->set_child(a); d->set_child(b);
-	e->set_child(c);
-	f->set_child(d); f->set_child(e);
-	h->set_child(f); h->set_child(g);
-	i->set_child(h);
-	j->set_child(i);
-	k->set_child(j); k->set_child(j);
-
-	d->set_operation(OperationType::SUB);
-	e->set_operation(OperationType::EXP);
-	f->set_operation(OperationType::MUL);
-	h->set_operation(OperationType::POW);
-	i->set_operation(OperationType::LN);
-	j->set_operation(OperationType::LOGISTIC);
-	k->set_operation(OperationType::MUL);
-
-	Node *nodes[7] = {d, e, f, h, i, j, k};
+	// trivial errors
+	comp.define_child_one_partial(INVALID_NODE_ID, write_scratch_file, "d/x/d/y");
+	comp.define_child_two_partial(dfg->get_node("x"), write_scratch_file, "d/x/d/y");
+	write_scratch_file.open("scratch.tf");
+	write_scratch_file << unitbuf;
+	comp.define_child_one_partial(dfg->get_node("x"), write_scratch_file, "");
+	comp.define_child_two_partial(dfg->get_node("x"), write_scratch_file, "d/x/d/y");
+
+	string names[7] = {"d", "e", "f", "h", "i", "j", "k"};
 	string child_one_partials[7] = {"d/d/d/a", "d/e/d/c", "d/f/d/d", "d/h/d/f", "d/i/d/h", "d/j/d/i", "d/k/d/j"};
 	string child_two_partials[7] = {"d/d/d/b", "", "d/f/d/e", "d/h/d/g", "", "", "d/k/d/j"};
 
 	for (int p = 0; p < 7; p++) {
-		comp.define_child_one_partial(nodes[p], write_scratch_file, child_one_partials[p]);
+		comp.define_child_one_partial(dfg->get_node(names[p]), write_scratch_file, child_one_partials[p]);
 	}
 
 	for (int q = 0; q < 7; q++) {
-		comp.define_child_two_partial(nodes[q], write_scratch_file, child_two_partials[q]);
+		comp.define_child_two_partial(dfg->get_node(names[q]), write_scratch_file, child_two_partials[q]);
 	}
 
 	string child_one_definitions[19] = {
@@ -463,11 +460,159 @@ void test_comp_define_child_partials() {
 	assert_equal_file_lines("scratch.tf", child_two_definitions, 19, 8, "test_comp_define_child_partials");
 
 	write_scratch_file.close();
-	delete a; delete b; delete c; delete d; delete e; delete f; delete g; delete h; delete i; delete j; delete k;
 	pass("test_comp_define_child_partials");
 
 }
 
+void test_comp_compile_hvp() {
+
+	Compiler c;
+
+	// trivial errors
+	assert_equal_int(c.compile_hvp("tests/test_files/inputs/non_existent_gcp.tf", "scratch.tf"), OTHER_ERROR, "test_comp_compile_hvp");
+
+	// build the HVP program of the small net GCP
+	assert_equal_int(c.compile_hvp("tests/test_files/inputs/small_net_gcp.tf", "tests/test_files/outputs/small_net_hvp.tf"), 0, "test_comp_compile_hvp");
+
+	// the weights are f, g and h. Pick a direction v and a point w.
+	string weights[3] = {"f", "g", "h"};
+	double w[3] = {0.35, 0.24, 0.08};
+	double v[3] = {0.5, -1.0, 2.0};
+	unordered_map<string, double> inputs = {{"a", 1}, {"b", 2}, {"c", 3}, {"m", 0.6}, {"n", 0.55}, {"p", 0.57}};
+
+	// interpret the HVP program at w along v
+	unordered_map<string, double> hvp_inputs(inputs);
+	for (int i = 0; i < 3; i++) {
+		hvp_inputs[weights[i]] = w[i];
+		hvp_inputs[generate_direction_name(weights[i])] = v[i];
+	}
+	unordered_map<string, double> hvp_outputs;
+	Interpreter hvp_interpreter;
+	assert_equal_int(hvp_interpreter.interpret("tests/test_files/outputs/small_net_hvp.tf", hvp_inputs, &hvp_outputs), 0, "test_comp_compile_hvp");
+	assert_equal_int(hvp_outputs.size(), 3, "test_comp_compile_hvp");
+
+	// compare Hv against a central difference of the gradient: (grad(w + eps * v) - grad(w - eps * v)) / (2 * eps)
+	double eps = 0.0001;
+	unordered_map<string, double> gradients[2];
+	for (int s = 0; s < 2; s++) {
+		unordered_map<string, double> gcp_inputs(inputs);
+		for (int i = 0; i < 3; i++) gcp_inputs[weights[i]] = w[i] + (s == 0 ? eps : -eps) * v[i];
+		Interpreter gcp_interpreter;
+		assert_equal_int(gcp_interpreter.interpret("tests/test_files/inputs/small_net_gcp.tf", gcp_inputs, &gradients[s]), 0, "test_comp_compile_hvp");
+	}
+
+	for (int i = 0; i < 3; i++) {
+		string partial_name = generate_partial_var_name("LAMBDA", weights[i]);
+		double finite_difference = (gradients[0].at(partial_name) - gradients[1].at(partial_name)) / (2 * eps);
+		assert_approximately_equal_double(hvp_outputs.at(generate_hvp_name(weights[i])), finite_difference, 0.001, "test_comp_compile_hvp");
+	}
+
+	pass("test_comp_compile_hvp");
+
+}
+
+
+void test_comp_sum_over_parents() {
+
+	// w is used twice, so L = exp(x * w * w) reaches it along two paths
+	Compiler c;
+	stringstream shape_prog("declare input x\ndeclare weight w\ndeclare intvar z\ndefine z = mul x w\n"
+		"declare intvar u\ndefine u = mul z w\ndeclare loss L\ndefine L = exp u\n");
+	stringstream gcp_text;
+	assert_equal_int(c.compile(shape_prog, gcp_text), 0, "test_comp_sum_over_parents");
+
+	// partial(L, w) = partial(L, z) * partial(z, w) + partial(L, u) * partial(u, w)
+	string gcp = gcp_text.str();
+	assert_true(gcp.find("define d/L/d/w:0 = mul d/L/d/z d/z/d/w\n") != string::npos, "The first path is a term", "test_comp_sum_over_parents");
+	assert_true(gcp.find("define d/L/d/w:1 = mul d/L/d/u d/u/d/w\n") != string::npos, "The second path is a term", "test_comp_sum_over_parents");
+	assert_true(gcp.find("define d/L/d/w = add d/L/d/w:0 d/L/d/w:1\n") != string::npos, "The partial is the sum of the terms", "test_comp_sum_over_parents");
+
+	Program p;
+	unordered_map<string, double> outputs;
+	assert_equal_int(p.load(gcp_text), 0, "test_comp_sum_over_parents");
+	assert_equal_int(p.execute({{"x", 3}, {"w", 0.2}}, &outputs), 0, "test_comp_sum_over_parents");
+	assert_approximately_equal_double(outputs.at("d/L/d/w"), exp(3 * 0.2 * 0.2) * 2 * 3 * 0.2, 0.00001, "test_comp_sum_over_parents");
+
+	// here w is also a child of the loss, L = x * w * w, so partial(L, w) sums the edge from L with the path through z
+	Compiler direct;
+	stringstream direct_shape_prog("declare input x\ndeclare weight w\ndeclare intvar z\ndefine z = mul x w\ndeclare loss L\ndefine L = mul z w\n");
+	stringstream direct_gcp_text;
+	assert_equal_int(direct.compile(direct_shape_prog, direct_gcp_text), 0, "test_comp_sum_over_parents");
+	gcp = direct_gcp_text.str();
+	assert_true(gcp.find("declare output d/L/d/w\n") != string::npos, "The partial of a child of the loss is an output", "test_comp_sum_over_parents");
+	assert_true(gcp.find("define d/L/d/w:edge = z\n") != string::npos, "The edge from the loss has its own name", "test_comp_sum_over_parents");
+	assert_true(gcp.find("define d/L/d/w:1 = mul d/L/d/L d/L/d/w:edge\n") != string::npos, "The edge from the loss is a term", "test_comp_sum_over_parents");
+
+	Program direct_prog;
+	unordered_map<string, double> direct_outputs;
+	assert_equal_int(direct_prog.load(direct_gcp_text), 0, "test_comp_sum_over_parents");
+	assert_equal_int(direct_prog.execute({{"x", 3}, {"w", 0.2}}, &direct_outputs), 0, "test_comp_sum_over_parents");
+	assert_equal_int(direct_outputs.size(), 1, "test_comp_sum_over_parents");
+	assert_approximately_equal_double(direct_outputs.at("d/L/d/w"), 2 * 3 * 0.2, 0.00001, "test_comp_sum_over_parents");
+
+	pass("test_comp_sum_over_parents");
+
+}
+
+
+void test_comp_multiple_losses() {
+
+	// A = (x * w * v - y)^2 depends on both weights, and B = x * w^3 + x * w only on w
+	string shape_prog =
+		"declare input x\ndeclare weight w\ndeclare weight v\ndeclare exp_output y\n"
+		"declare intvar z\ndefine z = mul x w\ndeclare intvar u\ndefine u = mul z v\n"
+		"declare intvar e\ndefine e = sub u y\ndeclare loss A\ndefine A = pow e 2\n"
+		"declare intvar r\ndefine r = mul w w\ndeclare intvar q\ndefine q = mul z r\n"
+		"declare loss B\ndefine B = add q z\n";
+	unordered_map<string, double> inputs = {{"x", 1.5}, {"w", 0.7}, {"v", -0.4}, {"y", 0.3}, {"s/A", 2}, {"s/B", 0.5}};
+	double dA_dw = 0.864, dA_dv = -1.512, dB_dw = 3.705;
+
+	// one sweep gives the partials of 2 * A + 0.5 * B
+	Compiler c;
+	stringstream shape_text(shape_prog), gcp_text;
+	assert_equal_int(c.compile(shape_text, gcp_text), 0, "test_comp_multiple_losses");
+	assert_equal_string(c.get_objective_name(), COMBINED_OBJECTIVE_NAME, "test_comp_multiple_losses");
+	assert_equal_int(c.get_dfg()->get_loss_nodes().size(), 2, "test_comp_multiple_losses");
+	assert_true(gcp_text.str().find("declare input s/A\ndeclare input s/B\n") != string::npos, "The seeds are inputs", "test_comp_multiple_losses");
+	assert_true(gcp_text.str().find("define d/total/objective/d/B = s/B\n") != string::npos, "A loss is seeded", "test_comp_multiple_losses");
+
+	Program p;
+	unordered_map<string, double> outputs;
+	assert_equal_int(p.load(gcp_text), 0, "test_comp_multiple_losses");
+	assert_equal_int(p.execute(inputs, &outputs), 0, "test_comp_multiple_losses");
+	assert_equal_int(outputs.size(), 2, "test_comp_multiple_losses");
+	assert_approximately_equal_double(outputs.at("d/total/objective/d/w"), 2 * dA_dw + 0.5 * dB_dw, 0.00001, "test_comp_multiple_losses");
+	assert_approximately_equal_double(outputs.at("d/total/objective/d/v"), 2 * dA_dv, 0.00001, "test_comp_multiple_losses");
+
+	// the seeds are inputs, and must be given
+	inputs.erase("s/B");
+	assert_equal_int(p.execute(inputs, &outputs), INPUT_VALUE_NOT_PROVIDED, "test_comp_multiple_losses");
+	inputs["s/B"] = 0.5;
+
+	// per-objective partials come from one more sweep per loss
+	Compiler per_objective;
+	per_objective.set_per_objective_partials(true);
+	stringstream per_objective_shape_text(shape_prog), per_objective_gcp_text;
+	assert_equal_int(per_objective.compile(per_objective_shape_text, per_objective_gcp_text), 0, "test_comp_multiple_losses");
+
+	Program per_objective_prog;
+	assert_equal_int(per_objective_prog.load(per_objective_gcp_text), 0, "test_comp_multiple_losses");
+	assert_equal_int(per_objective_prog.execute(inputs, &outputs), 0, "test_comp_multiple_losses");
+	assert_equal_int(outputs.size(), 5, "test_comp_multiple_losses");
+	assert_approximately_equal_double(outputs.at("d/objective/A/d/w"), dA_dw, 0.00001, "test_comp_multiple_losses");
+	assert_approximately_equal_double(outputs.at("d/objective/A/d/v"), dA_dv, 0.00001, "test_comp_multiple_losses");
+	assert_approximately_equal_double(outputs.at("d/objective/B/d/w"), dB_dw, 0.00001, "test_comp_multiple_losses");
+	assert_approximately_equal_double(outputs.at("d/total/objective/d/w"), 2 * dA_dw + 0.5 * dB_dw, 0.00001, "test_comp_multiple_losses");
+
+	// a loss cannot be an operand
+	Compiler loss_operand;
+	stringstream loss_operand_text("declare input x\ndeclare loss A\ndefine A = exp x\ndeclare loss B\ndefine B = exp A\n"), loss_operand_gcp;
+	assert_equal_int(loss_operand.compile(loss_operand_text, loss_operand_gcp), INVALID_LINE, "test_comp_multiple_losses");
+
+	pass("test_comp_multiple_losses");
+
+}
+
 
 void run_comp_tests() {
 
@@ -482,6 +627,9 @@ void run_comp_tests() {
 	test_comp_define_partial_lambda();
 	test_comp_declare_child_partials();
 	test_comp_define_child_partials();
+	test_comp_compile_hvp();
+	test_comp_sum_over_parents();
+	test_comp_multiple_losses();
 
 	cout << "\nAll Compiler Tests Passed." << endl << endl;
 }
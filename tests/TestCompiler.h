@@ -17,6 +17,9 @@ void test_comp_declare_partial_lambda();
 void test_comp_define_partial_lambda();
 void test_comp_declare_child_partials();
 void test_comp_define_child_partials();
+void test_comp_compile_hvp();
+void test_comp_sum_over_parents();
+void test_comp_multiple_losses();
 
 
 void run_comp_tests();
@@ -12,8 +12,9 @@ void test_dfg_constructor() {
 	// test constructor initializes members correctly
 	DataFlowGraph d;
 	assert_equal_int(d.get_num_nodes(), 0, "test_dfg_constructor");
-	assert_true(d.get_node("n") == NULL, "There are no nodes in this DFG yet", "test_dfg_constructor");
-	assert_true(d.get_loss_node() == NULL, "There is no loss node in this DFG", "test_dfg_constructor");
+	assert_equal_int(d.get_num_ids(), 0, "test_dfg_constructor");
+	assert_true(d.get_node("n") == INVALID_NODE_ID, "There are no nodes in this DFG yet", "test_dfg_constructor");
+	assert_true(d.get_loss_node() == INVALID_NODE_ID, "There is no loss node in this DFG", "test_dfg_constructor");
 	assert_equal_string(d.get_loss_var_name(), "", "test_dfg_constructor");
 
 	pass("test_dfg_constructor");
@@ -22,18 +23,16 @@ void test_dfg_constructor() {
 
 void test_dfg_destructor() {
 
-	// test destructor only deletes nodes in its map of nodes
-	// also test that Node destructor does not delete its child nodes unless they are constants
+	// test destructor frees a graph with nodes, constants and edges
 	DataFlowGraph *d = new DataFlowGraph();
-	d->add_node(new Node("a", false));
-	d->add_node(new Node("b", false));
-	d->add_node(new Node("c", false));
+	d->add_node("a", VariableType::INTVAR);
+	d->add_node("b", VariableType::INTVAR);
+	d->add_node("c", VariableType::INPUT);
+	d->add_flow_edge("b", "a");
+	d->add_flow_edge("3.5", "b");
+	assert_true(d->has_parent(d->get_node("b")), "B has a parent", "test_dfg_destructor");
 
-	Node *n = new Node("n", false);
-	d->get_node("a")->set_child(n);
-	n->add_parent(d->get_node("a"));
-
-	delete d; delete n;
+	delete d;
 
 	pass("test_dfg_destructor");
 }
@@ -42,60 +41,77 @@ void test_dfg_add_node() {
 
 	DataFlowGraph *d = new DataFlowGraph();
 
-	// can't add null node
-	assert_true(d->add_node(NULL) == -1, "Cannot add a NULL node", "test_dfg_add_node");
-	
+	// can't add a node without a name
+	assert_true(d->add_node("", VariableType::INTVAR) == -1, "Cannot add a node without a name", "test_dfg_add_node");
+
 	// basic add
-	Node *n = new Node("n", false);
-	n->set_type(VariableType::INTVAR);
-	assert_true(d->add_node(n) == 0, "Add node should have succeeded", "test_dfg_add_node");
+	// a node's id is the id of its name's Symbol
+	assert_true(d->add_node("n", VariableType::INTVAR) == 0, "Add node should have succeeded", "test_dfg_add_node");
+	uint32_t n = Symbol("n").get_id();
 	assert_equal_int(d->get_num_nodes(), 1, "test_dfg_add_node");
-	assert_true(d->get_node("n") == n, "Node N should've been retrieved", "test_dfg_add_node");
+	assert_equal_int(d->get_node("n"), n, "test_dfg_add_node");
+	assert_true(d->get_symbol(n) == Symbol("n"), "N's symbol should be n", "test_dfg_add_node");
+	assert_true(d->get_type(n) == VariableType::INTVAR, "N should be an intvar", "test_dfg_add_node");
+	assert_equal_string(d->get_name(n), "n", "test_dfg_add_node");
 
 	// can't add same node twice
-	Node *x = new Node("n", false);
-	assert_true(d->add_node(x) == -1, "Can't add node with the same name", "test_dfg_add_node");
+	assert_true(d->add_node("n", VariableType::INPUT) == -1, "Can't add node with the same name", "test_dfg_add_node");
+	assert_true(d->get_type(n) == VariableType::INTVAR, "N should still be an intvar", "test_dfg_add_node");
 
 	// add loss node
-	Node *loss = new Node("loss", false);
-	loss->set_type(VariableType::LOSS);
-	assert_equal_int(d->add_node(loss), 0, "test_dfg_add_node");
+	assert_equal_int(d->add_node("loss", VariableType::LOSS), 0, "test_dfg_add_node");
+	uint32_t loss = d->get_node("loss");
 	assert_equal_string(d->get_loss_var_name(), "loss", "test_dfg_add_node");
-	assert_true(d->get_loss_node() == loss, "Loss node should be LOSS", "test_dfg_add_node");
-	assert_equal_int(loss->get_parents()->count(loss), 1, "test_dfg_add_node");
-	assert_equal_int(loss->get_parent_names()->count("loss"), 1, "test_dfg_add_node");
-
-	// add another loss node
-	Node *loss_two = new Node("loss_two", false);
-	loss_two->set_type(VariableType::LOSS);
-	assert_true(d->add_node(loss_two) == -1, "Cannot have two loss nodes", "test_dfg_add_node");
+	assert_equal_int(d->get_loss_node(), loss, "test_dfg_add_node");
+	assert_equal_int(d->get_num_parents(loss), 1, "test_dfg_add_node");
+	assert_equal_int(d->get_parents(loss)[0], loss, "test_dfg_add_node");
+
+	// add another loss node; with two, there is no single loss node
+	assert_equal_int(d->add_node("loss_two", VariableType::LOSS), 0, "test_dfg_add_node");
+	uint32_t loss_two = d->get_node("loss_two");
+	assert_equal_int(d->get_loss_nodes().size(), 2, "test_dfg_add_node");
+	assert_equal_int(d->get_loss_nodes()[1], loss_two, "test_dfg_add_node");
+	assert_true(d->get_loss_node() == INVALID_NODE_ID, "There are two loss nodes", "test_dfg_add_node");
+	assert_equal_string(d->get_loss_var_name(), "", "test_dfg_add_node");
+	assert_equal_int(d->get_parents(loss_two)[0], loss_two, "test_dfg_add_node");
+	assert_true(d->add_node("loss_two", VariableType::LOSS) == -1, "Cannot add the same loss node twice", "test_dfg_add_node");
 
 	// cannot add constant node
-	Node *c = new Node("0.23", true);
-	assert_true(d->add_node(c) == -1, "Cannot add constant node to DFG", "test_dfg_add_node");
+	assert_true(d->add_node("0.23", VariableType::CONSTANT) == -1, "Cannot add constant node to DFG", "test_dfg_add_node");
+	assert_equal_int(d->get_num_nodes(), 3, "test_dfg_add_node");
 
-	delete d; delete c; delete loss_two; delete x;
+	delete d;
 	pass("test_dfg_add_node");
 
 }
 
 void test_dfg_get_node() {
 
-	// test get_node returns null if not found
+	// test get_node returns an invalid id if not found
 	DataFlowGraph d;
-	Node *n = new Node("n", false);
-	assert_true(d.get_node("n") == NULL, "No node with the name N", "test_dfg_get_node");
+	assert_true(d.get_node("n") == INVALID_NODE_ID, "No node with the name N", "test_dfg_get_node");
 
 	// test basic add_node, get_node
-	d.add_node(n);
-	assert_true(d.get_node("n") == n, "Node N was retrieved", "test_dfg_get_node");
-
-	// add another node with the same name
-	Node *x = new Node("n", false);
-	d.add_node(x);
-	assert_true(d.get_node("n") == n, "Node N was retrieved", "test_dfg_get_node");
+	d.add_node("n", VariableType::INTVAR);
+	uint32_t n = d.get_node("n");
+	assert_equal_int(n, Symbol("n").get_id(), "test_dfg_get_node");
+	assert_true(d.get_num_ids() > n, "N's id is below the number of ids", "test_dfg_get_node");
+
+	// rejected nodes are not added
+	d.add_node("n", VariableType::INTVAR);
+	assert_equal_int(d.get_node("n"), n, "test_dfg_get_node");
+	assert_equal_int(d.get_num_nodes(), 1, "test_dfg_get_node");
+
+	// names with a Symbol but no node are not found
+	assert_true(d.get_node(Symbol("not_a_node")) == INVALID_NODE_ID, "No node named not_a_node", "test_dfg_get_node");
+
+	// constants have ids, but cannot be looked up
+	d.add_flow_edge("7", "n");
+	d.add_flow_edge("7", "n");
+	assert_true(d.get_node("7") == INVALID_NODE_ID, "Constants are not nodes", "test_dfg_get_node");
+	assert_true(d.is_constant(d.get_child_one(n)), "N's child is constant", "test_dfg_get_node");
+	assert_equal_int(d.get_child_two(n), d.get_child_one(n), "test_dfg_get_node");
 
-	delete x;
 	pass("test_dfg_get_node");
 
 }
@@ -103,38 +119,95 @@ void test_dfg_get_node() {
 void test_dfg_add_flow_edge() {
 
 	DataFlowGraph *d = new DataFlowGraph();
-	Node *parent = new Node("parent", false);
-	Node *child = new Node("child", false);
 
 	// parent not in DFG
 	assert_false(d->add_flow_edge("child", "parent"), "Parent not found in DFG", "test_dfg_add_flow_edge");
 
 	// parent in DFG but child not
-	d->add_node(parent);
+	d->add_node("parent", VariableType::INTVAR);
 	assert_false(d->add_flow_edge("child", "parent"), "Child not found in DFG", "test_dfg_add_flow_edge");
 
 	// check child's parent and parent's child got correctly set
-	d->add_node(child);
+	d->add_node("child", VariableType::INTVAR);
+	uint32_t parent = d->get_node("parent"), child = d->get_node("child");
 	assert_true(d->add_flow_edge("child", "parent"), "Add flow edge should've succeeded", "test_dfg_add_flow_edge");
-	assert_equal_int(child->get_parents()->count(parent), 1, "test_dfg_add_flow_edge");
-	assert_equal_int(child->get_parent_names()->count("parent"), 1, "test_dfg_add_flow_edge");
-	assert_true(parent->get_child_one() == child, "Parent's first child should be CHILD", "test_dfg_add_flow_edge");
+	assert_equal_int(d->get_num_parents(child), 1, "test_dfg_add_flow_edge");
+	assert_equal_int(d->get_parents(child)[0], parent, "test_dfg_add_flow_edge");
+	assert_equal_int(d->get_child_one(parent), child, "test_dfg_add_flow_edge");
+	assert_true(d->has_child(parent, child), "Parent has CHILD as a child", "test_dfg_add_flow_edge");
+	assert_false(d->has_parent(parent), "Parent has no parent", "test_dfg_add_flow_edge");
 
 	// add constant child
 	assert_true(d->add_flow_edge("7", "child"), "Adding flow edge from constant to node should work", "test_dfg_add_flow_edge");
-	assert_true(child->get_child_one_name() == "7", "CHILD's first child should be 7", "test_dfg_add_flow_edge");
-	
+	assert_equal_string(d->get_name(d->get_child_one(child)), "7", "test_dfg_add_flow_edge");
+	assert_equal_int(d->get_num_parents(d->get_child_one(child)), 0, "test_dfg_add_flow_edge");
+
+	// the same constant is stored once
+	assert_true(d->add_flow_edge("7", "child"), "Adding the same constant twice should work", "test_dfg_add_flow_edge");
+	assert_equal_int(d->get_child_one(child), d->get_child_two(child), "test_dfg_add_flow_edge");
+	assert_equal_int(d->get_num_children(child), 2, "test_dfg_add_flow_edge");
+
+	// cannot have three children
+	assert_false(d->add_flow_edge("child", "parent") && d->add_flow_edge("child", "parent"), "Cannot have three children", "test_dfg_add_flow_edge");
+	assert_equal_int(d->get_num_children(parent), 2, "test_dfg_add_flow_edge");
+
+	// a node with the same child twice is listed as its parent once
+	assert_equal_int(d->get_num_parents(child), 1, "test_dfg_add_flow_edge");
+
+	// input, weight and exp_output nodes cannot have children
+	d->add_node("x", VariableType::INPUT);
+	d->add_node("w", VariableType::WEIGHT);
+	d->add_node("y", VariableType::EXP_OUTPUT);
+	assert_false(d->add_flow_edge("child", "x"), "Input nodes cannot have children", "test_dfg_add_flow_edge");
+	assert_false(d->add_flow_edge("child", "w"), "Weight nodes cannot have children", "test_dfg_add_flow_edge");
+	assert_false(d->add_flow_edge("child", "y"), "Exp_output nodes cannot have children", "test_dfg_add_flow_edge");
+
+	// the loss node cannot be a child
+	d->add_node("loss", VariableType::LOSS);
+	d->add_node("z", VariableType::INTVAR);
+	assert_false(d->add_flow_edge("loss", "z"), "Cannot set a loss node as a child", "test_dfg_add_flow_edge");
+
+	// parents are listed in increasing order of id
+	assert_true(d->add_flow_edge("x", "loss") && d->add_flow_edge("x", "z"), "X can have two parents", "test_dfg_add_flow_edge");
+	assert_equal_int(d->get_num_parents(d->get_node("x")), 2, "test_dfg_add_flow_edge");
+	const uint32_t *x_parents = d->get_parents(d->get_node("x"));
+	uint32_t loss = d->get_loss_node(), z = d->get_node("z");
+	assert_equal_int(x_parents[0], loss < z ? loss : z, "test_dfg_add_flow_edge");
+	assert_equal_int(x_parents[1], loss < z ? z : loss, "test_dfg_add_flow_edge");
+
 	delete d;
 	pass("test_dfg_add_flow_edge");
 
 }
 
+void test_dfg_operation() {
+
+	DataFlowGraph d;
+	d.add_node("a", VariableType::INTVAR);
+	uint32_t a = d.get_node("a");
+	assert_true(d.get_operation(a) == OperationType::INVALID_OPERATION, "A's initial operation type should be Invalid", "test_dfg_operation");
+
+	d.set_operation(a, OperationType::ADD);
+	assert_true(d.get_operation(a) == OperationType::ADD, "A's operation type should be ADD", "test_dfg_operation");
+	d.set_operation(a, OperationType::LOGISTIC);
+	assert_true(d.get_operation(a) == OperationType::LOGISTIC, "A's operation type should be LOGISTIC", "test_dfg_operation");
+
+	// constants cannot have their operation set
+	d.add_flow_edge("-7.3", "a");
+	uint32_t c = d.get_child_one(a);
+	d.set_operation(c, OperationType::ADD);
+	assert_true(d.get_type(c) == VariableType::CONSTANT, "-7.3 should be a constant", "test_dfg_operation");
+	assert_true(d.get_operation(c) == OperationType::INVALID_OPERATION, "Constant nodes can't have their operation set", "test_dfg_operation");
+
+	pass("test_dfg_operation");
+
+}
+
 void test_dfg_get_num_nodes() {
 
 	// test constant nodes are not added to DFG
 	DataFlowGraph d;
-	Node *a = new Node("a", false), *b = new Node("132", true), *c = new Node("c", false);
-	d.add_node(a); d.add_node(b); d.add_node(c);
+	d.add_node("a", VariableType::INTVAR); d.add_node("132", VariableType::CONSTANT); d.add_node("c", VariableType::INTVAR);
 	d.add_flow_edge("c", "a");
 	d.add_flow_edge("17", "a");
 	assert_equal_int(d.get_num_nodes(), 2, "test_dfg_get_num_nodes");
@@ -148,18 +221,14 @@ void test_dfg_get_loss_node() {
 
 	// test get_loss_node when there is no loss node
 	DataFlowGraph d;
-	Node *a = new Node("a", false);
-	a->set_type(VariableType::INTVAR);
-	d.add_node(a);
-	assert_true(d.get_loss_node() == NULL, "Loss node not seen", "test_dfg_get_loss_node");
+	d.add_node("a", VariableType::INTVAR);
+	assert_true(d.get_loss_node() == INVALID_NODE_ID, "Loss node not seen", "test_dfg_get_loss_node");
 	assert_equal_string(d.get_loss_var_name(), "", "test_dfg_get_loss_node");
 
 	// test get_loss_node when there is a loss node
-	Node *loss = new Node("loss", false);
-	loss->set_type(VariableType::LOSS);
-	d.add_node(loss);
+	d.add_node("loss", VariableType::LOSS);
 	d.add_flow_edge("a", "d");
-	assert_true(d.get_loss_node() == loss, "Loss node is LOSS", "test_dfg_get_loss_node");
+	assert_true(d.get_loss_node() == d.get_node("loss"), "Loss node is LOSS", "test_dfg_get_loss_node");
 	assert_equal_string(d.get_loss_var_name(), "loss", "test_dfg_get_loss_node");
 
 
@@ -167,32 +236,6 @@ void test_dfg_get_loss_node() {
 
 }
 
-void test_dfg_clear_all_markings() {
-
-	// set arbitrary markings for 6 nodes in DFG
-	// clear all, test they are all cleared
-	DataFlowGraph *dfg = new DataFlowGraph();
-	Node *a = new Node("a", false); dfg->add_node(a);
-	Node *b = new Node("b", false); dfg->add_node(b);
-	Node *c = new Node("c", false); dfg->add_node(c);
-	Node *d = new Node("d", false); dfg->add_node(d);
-	Node *e = new Node("e", false); dfg->add_node(e);
-	Node *f = new Node("f", false); dfg->add_node(f);
-	a->temporary_mark(); b->permanent_mark(); e->temporary_mark(); b->clear_mark();
-	dfg->clear_all_markings();
-	assert_true(a->is_unmarked(), "A must be unmarked", "test_dfg_clear_all_markings");
-	assert_true(b->is_unmarked(), "B must be unmarked", "test_dfg_clear_all_markings");
-	assert_true(c->is_unmarked(), "C must be unmarked", "test_dfg_clear_all_markings");
-	assert_true(d->is_unmarked(), "D must be unmarked", "test_dfg_clear_all_markings");
-	assert_true(e->is_unmarked(), "E must be unmarked", "test_dfg_clear_all_markings");
-	assert_true(f->is_unmarked(), "F must be unmarked", "test_dfg_clear_all_markings");
-
-	delete dfg;
-
-	pass("test_dfg_clear_all_markings");
-
-}
-
 void test_dfg_top_sort() {
 	/* Create a DFG that looks like this:
 
@@ -205,32 +248,44 @@ void test_dfg_top_sort() {
 	*/
 
 	DataFlowGraph d;
-	Node *a = new Node("a", false);
-	a->set_type(VariableType::LOSS);
-	Node *b = new Node("b", false);
-	d.add_node(a);
-	d.add_node(b);
+	d.add_node("a", VariableType::LOSS);
+	d.add_node("b", VariableType::INTVAR);
 	d.add_flow_edge("b", "a");
 	d.add_flow_edge("7", "a");
-	Node *c = new Node("c", false);
-	d.add_node(c);
+	d.add_node("c", VariableType::INTVAR);
 	d.add_flow_edge("c", "b");
 
-	list<Node *> *sorted_nodes = new list<Node *>();
-	d.top_sort(sorted_nodes);
-
-	// test all nodes are permanent marked after sort
-	assert_true(a->is_permanent_marked(), "A must be permanent marked", "test_dfg_top_sort");
-	assert_true(b->is_permanent_marked(), "A must be permanent marked", "test_dfg_top_sort");
-	assert_true(c->is_permanent_marked(), "A must be permanent marked", "test_dfg_top_sort");
+	vector<uint32_t> sorted_ids;
+	d.top_sort(&sorted_ids);
 
 	// test the order is A, B, C
-	int i = 0;
-	for (list<Node *>::iterator it = sorted_nodes->begin(); it != sorted_nodes->end(); ++it) {
-		if (i == 0) assert_equal_string((*it)->get_name(), "a", "test_dfg_top_sort");
-		if (i == 1) assert_equal_string((*it)->get_name(), "b", "test_dfg_top_sort");
-		if (i == 2) assert_equal_string((*it)->get_name(), "c", "test_dfg_top_sort");
-		i++;
+	assert_equal_int(sorted_ids.size(), 3, "test_dfg_top_sort");
+	assert_equal_string(d.get_name(sorted_ids[0]), "a", "test_dfg_top_sort");
+	assert_equal_string(d.get_name(sorted_ids[1]), "b", "test_dfg_top_sort");
+	assert_equal_string(d.get_name(sorted_ids[2]), "c", "test_dfg_top_sort");
+
+	// build a reduce_vector-like chain 100000 nodes deep:
+	// loss = acc.N, acc.i = add acc.(i-1) x.i, acc.0 = x.0
+	// a recursive sort would overflow the stack on a chain this deep
+	DataFlowGraph chain;
+	int depth = 100000;
+	for (int i = 0; i < depth; i++) {
+		chain.add_node("x." + to_string(i), VariableType::INPUT);
+		chain.add_node("acc." + to_string(i), i == depth - 1 ? VariableType::LOSS : VariableType::INTVAR);
+		chain.set_operation(chain.get_node("acc." + to_string(i)), OperationType::ADD);
+		chain.add_flow_edge(i == 0 ? "0" : "acc." + to_string(i - 1), "acc." + to_string(i));
+		chain.add_flow_edge("x." + to_string(i), "acc." + to_string(i));
+	}
+	chain.top_sort(&sorted_ids);
+	assert_equal_int(sorted_ids.size(), 2 * depth, "test_dfg_top_sort");
+	assert_equal_string(chain.get_name(sorted_ids[0]), "acc." + to_string(depth - 1), "test_dfg_top_sort");
+
+	// every node must come before its children
+	vector<int> position(chain.get_num_ids());
+	for (size_t i = 0; i < sorted_ids.size(); i++) position[sorted_ids[i]] = i;
+	for (size_t i = 0; i < sorted_ids.size(); i++) {
+		uint32_t child = chain.get_child_two(sorted_ids[i]);
+		if (child != INVALID_NODE_ID) assert_true(position[child] > (int) i, "Children come after their parents", "test_dfg_top_sort");
 	}
 
 	pass("test_dfg_top_sort");
@@ -246,10 +301,10 @@ void run_dfg_tests() {
 	test_dfg_add_node();
 	test_dfg_get_node();
 	test_dfg_add_flow_edge();
+	test_dfg_operation();
 	test_dfg_get_num_nodes();
 	test_dfg_get_loss_node();
-	test_dfg_clear_all_markings();
 	test_dfg_top_sort();
 
 	cout << "\nAll DataFlowGraph Tests Passed." << endl << endl;
-}
\ No newline at end of file
+}
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <cfloat>
+
+#include "TestDataSource.h"
+#include "../src/DataSource.h"
+#include "TestUtilities.h"
+
+using namespace std;
+
+
+bool read_pass(DataSource *source, size_t batch_size, mt19937_64 *rng, vector<double> *xs) {
+	xs->clear();
+	DataBatch batch;
+	if (source->start_pass(batch_size, rng) != 0) return false;
+	bool short_batch = false;
+	while (source->next_batch(&batch) == 0 && batch.num_rows > 0) {
+		if (short_batch || batch.num_rows > batch_size || batch.columns.size() != 2) return false;
+		short_batch = batch.num_rows < batch_size;
+		for (size_t r = 0; r < batch.num_rows; r++) {
+			if (batch.columns[1][r] != -batch.columns[0][r] / 2) return false;
+			xs->push_back(batch.columns[0][r]);
+		}
+	}
+	return true;
+}
+
+
+void test_data_layout() {
+
+	// the small net of test_gd_calculate_weights: inputs a, b and c, expected outputs m, n and p, and weights f, g and h
+	Program gcp;
+	assert_equal_int(gcp.load("tests/test_files/inputs/small_net_gcp.tf"), 0, "test_data_layout");
+
+	// a batch of two data, one column at a time; the column "q" is not in the GCP, and is ignored
+	vector<string> column_names = {"a", "b", "c", "m", "n", "p", "q"};
+	double a[] = {1, 1.5}, b[] = {2, 2.5}, c[] = {3, 3.5}, m[] = {0.5, 0.25}, n[] = {0.6, 0.75}, p[] = {0.7, 0.125}, q[] = {9, 9};
+	DataBatch batch;
+	batch.num_rows = 2;
+	batch.columns = {a, b, c, m, n, p, q};
+
+	DataLayout layout;
+	assert_equal_int(layout.build(gcp, column_names), 0, "test_data_layout");
+	assert_equal_int(layout.size(), 7, "test_data_layout");
+
+	// a bound row is the datum, in the slots of its variables
+	vector<double> values;
+	gcp.init_values(&values);
+	assert_equal_int(layout.bind_row(batch, 1, &values), 0, "test_data_layout");
+	assert_equal_double(values[gcp.get_slot(Symbol::find("a"))], 1.5, "test_data_layout");
+	assert_equal_double(values[gcp.get_slot(Symbol::find("p"))], 0.125, "test_data_layout");
+	assert_equal_int(gcp.check_inputs_bound(values), INPUT_VALUE_NOT_PROVIDED, "test_data_layout");
+
+	// binding a row twice, a row beyond the batch, a batch of other columns, or a value the GCP cannot take, fails
+	assert_equal_int(layout.bind_row(batch, 0, &values), VAR_DECLARED_TWICE, "test_data_layout");
+	gcp.init_values(&values);
+	assert_equal_int(layout.bind_row(batch, 2, &values), OTHER_ERROR, "test_data_layout");
+	DataBatch narrow = batch;
+	narrow.columns.pop_back();
+	assert_equal_int(layout.bind_row(narrow, 0, &values), OTHER_ERROR, "test_data_layout");
+	m[0] = DBL_MAX;
+	assert_equal_int(layout.bind_row(batch, 0, &values), OTHER_ERROR, "test_data_layout");
+
+	// weights are bound before the data, so a column of a weight clashes with it; and a column may only be named once
+	vector<string> weight_columns = {"a", "f"};
+	assert_equal_int(layout.build(gcp, weight_columns), 0, "test_data_layout");
+	double f[] = {0.4};
+	DataBatch weight_batch;
+	weight_batch.num_rows = 1;
+	weight_batch.columns = {a, f};
+	gcp.init_values(&values);
+	values[gcp.get_slot(Symbol::find("f"))] = 0.1;
+	assert_equal_int(layout.bind_row(weight_batch, 0, &values), VAR_DECLARED_TWICE, "test_data_layout");
+	vector<string> twice = {"a", "b", "a"};
+	assert_equal_int(layout.build(gcp, twice), OTHER_ERROR, "test_data_layout");
+
+	pass("test_data_layout");
+}
+
+
+void run_data_source_tests() {
+	cout << "\nTesting the Data Sources... " << endl << endl;
+
+	test_data_layout();
+
+	cout << "\nAll Data Source Tests Passed." << endl << endl;
+}
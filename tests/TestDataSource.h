@@ -0,0 +1,26 @@
+#ifndef TEST_DATA_SOURCE_H
+#define TEST_DATA_SOURCE_H
+
+#include "stdlib.h"
+#include <vector>
+#include <random>
+
+#include "../src/DataSource.h"
+
+using namespace std;
+
+
+/* Tests for the layout of streamed training data. */
+
+void test_data_layout();
+
+void run_data_source_tests();
+
+
+/* Reads a whole pass of SOURCE, whose columns are "x" and "y", in batches of BATCH_SIZE, appending the column "x" of every datum to XS.
+ * Returns false if a batch is larger than BATCH_SIZE, if only the last batch is smaller, or if a datum's "y" is not -x / 2.
+ */
+bool read_pass(DataSource *source, size_t batch_size, mt19937_64 *rng, vector<double> *xs);
+
+
+#endif
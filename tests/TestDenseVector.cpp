@@ -0,0 +1,65 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+
+#include "TestDenseVector.h"
+#include "../src/DenseVector.h"
+#include "TestUtilities.h"
+
+using namespace std;
+
+
+
+void test_dense_axpy() {
+
+	// five values, so both the pairs and the last value on its own are covered
+	vector<double> x = {1, 2, 3, 4, 5};
+	vector<double> y = {10, 20, 30, 40, 50};
+
+	dense_axpy(2, x.data(), y.data(), 5);
+	for (int i = 0; i < 5; i++) assert_equal_double(y[i], 10 * (i + 1) + 2 * (i + 1), "test_dense_axpy");
+
+	dense_axpby(-1, x.data(), 0.5, y.data(), 5);
+	for (int i = 0; i < 5; i++) assert_equal_double(y[i], 6 * (i + 1) - (i + 1), "test_dense_axpy");
+
+	dense_scale(-2, y.data(), 5);
+	for (int i = 0; i < 5; i++) assert_equal_double(y[i], -10 * (i + 1), "test_dense_axpy");
+
+	// only the first N values are touched
+	dense_axpy(1, x.data(), y.data(), 3);
+	assert_equal_double(y[2], -27, "test_dense_axpy");
+	assert_equal_double(y[3], -40, "test_dense_axpy");
+	dense_scale(0, y.data(), 0);
+	assert_equal_double(y[0], -9, "test_dense_axpy");
+
+	pass("test_dense_axpy");
+}
+
+
+void test_dense_dot() {
+
+	vector<double> x = {1, 2, 3, 4, 5};
+	vector<double> y = {5, 4, 3, 2, 1};
+	assert_equal_double(dense_dot(x.data(), y.data(), 5), 35, "test_dense_dot");
+	assert_equal_double(dense_dot(x.data(), y.data(), 4), 30, "test_dense_dot");
+	assert_equal_double(dense_dot(x.data(), y.data(), 1), 5, "test_dense_dot");
+	assert_equal_double(dense_dot(x.data(), y.data(), 0), 0, "test_dense_dot");
+
+	vector<double> v = {3, 4};
+	assert_equal_double(dense_norm(v.data(), 2), 5, "test_dense_dot");
+	assert_equal_double(dense_norm(v.data(), 0), 0, "test_dense_dot");
+
+	pass("test_dense_dot");
+}
+
+
+
+void run_dense_tests() {
+
+	cout << "\nTesting Dense Vectors... " << endl << endl;
+
+	test_dense_axpy();
+	test_dense_dot();
+
+	cout << "\nAll Dense Vector Tests Passed." << endl << endl;
+}
@@ -0,0 +1,17 @@
+#ifndef TEST_DENSE_VECTOR_H
+#define TEST_DENSE_VECTOR_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for the dense vector kernels. */
+
+void test_dense_axpy();
+void test_dense_dot();
+
+void run_dense_tests();
+
+
+#endif
@@ -1,10 +1,14 @@
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <cfloat>
+#include <algorithm>
+#include <random>
 #include <time.h>
 
 #include "TestGradientDescent.h"
 #include "../src/GradientDescent.h"
+#include "../src/RecordFile.h"
 #include "TestUtilities.h"
 
 using namespace std;
@@ -318,12 +322,726 @@ void test_gd_increment_weight_vector() {
 
 }
 
+void test_gd_sparse_gradient() {
+
+	// sparse vectors are added and incremented in place, touching only their own variables
+	VariableVector sum = {{"d/L/d/a", 1}};
+	add_to_variable_vector(&sum, {{"d/L/d/a", 2}, {"d/L/d/c", -1}});
+	assert_equal_int(sum.size(), 2, "test_gd_sparse_gradient");
+	assert_equal_double(sum.at("d/L/d/a"), 3, "test_gd_sparse_gradient");
+	assert_equal_double(sum.at("d/L/d/c"), -1, "test_gd_sparse_gradient");
+	assert_equal_double(variable_vector_length({{"a", 3}, {"b", -4}}), 5, "test_gd_sparse_gradient");
+	assert_equal_double(variable_vector_length({}), 0, "test_gd_sparse_gradient");
+
+	VariableVector weights = {{"a", 3}, {"b", 4}, {"c", 5}};
+	assert_equal_int(increment_weight_vector(&weights, sum), 0, "test_gd_sparse_gradient");
+	assert_equal_double(weights.at("a"), 6, "test_gd_sparse_gradient");
+	assert_equal_double(weights.at("b"), 4, "test_gd_sparse_gradient");
+	assert_equal_double(weights.at("c"), 4, "test_gd_sparse_gradient");
+	assert_equal_int(increment_weight_vector(&weights, {{"d/L/d/z", 1}}), OTHER_ERROR, "test_gd_sparse_gradient");
+
+	// a linear model over a vector of 8 inputs, whose data only have a few non-zero inputs
+	Program gcp;
+	stringstream prog(
+		"declare input x.0\ndeclare input x.1\ndeclare input x.2\ndeclare input x.3\n"
+		"declare input x.4\ndeclare input x.5\ndeclare input x.6\ndeclare input x.7\n"
+		"declare weight w.0\ndeclare weight w.1\ndeclare weight w.2\ndeclare weight w.3\n"
+		"declare weight w.4\ndeclare weight w.5\ndeclare weight w.6\ndeclare weight w.7\n"
+		"declare exp_output y\ndeclare intvar z\ndeclare intvar e\n"
+		"define z = 0\n"
+	);
+	stringstream rest;
+	for (int i = 0; i < 8; i++) {
+		rest << "declare intvar p." << i << "\ndefine p." << i << " = mul x." << i << " w." << i << "\n";
+		rest << "declare intvar z" << i << "\ndefine z" << i << " = add " << (i == 0 ? "z" : "z" + to_string(i - 1)) << " p." << i << "\n";
+	}
+	rest << "define e = sub z7 y\n";
+	for (int i = 0; i < 8; i++) {
+		rest << "declare output d/L/d/w." << i << "\ndefine d/L/d/w." << i << " = mul e x." << i << "\n";
+	}
+	string text = prog.str() + rest.str();
+	stringstream full(text);
+	assert_equal_int(gcp.load(full), 0, "test_gd_sparse_gradient");
+
+	vector<string> partial_names;
+	for (int i = 0; i < 8; i++) partial_names.push_back("d/L/d/w." + to_string(i));
+	weights.clear();
+	for (int i = 0; i < 8; i++) weights["w." + to_string(i)] = 0.1 * i;
+
+	// the same data, given densely and sparsely
+	vector<pair<VariableVector, VariableVector> > dense_data, sparse_data;
+	vector<SparseVariableVector> sparse_inputs, no_sparse_inputs;
+	SparseVector x0 = {{1, 4}, {2, -1}}, x1 = {{2}, {3}};
+	for (const SparseVector& x : {x0, x1}) {
+		VariableVector dense;
+		for (int i = 0; i < 8; i++) dense["x." + to_string(i)] = get_sparse_component(x, i);
+		dense_data.push_back(make_pair(dense, VariableVector({{"y", 1}})));
+		sparse_data.push_back(make_pair(VariableVector(), VariableVector({{"y", 1}})));
+		sparse_inputs.push_back({{"x", x}});
+		no_sparse_inputs.push_back({});
+	}
+
+	// the sparse gradient only has the partials of the inputs that are not always 0, with the values of the dense gradient
+	VariableVector dense_gradient = avg_gradient(gcp, partial_names, weights, dense_data);
+	VariableVector sparse_gradient;
+	assert_equal_int(avg_sparse_gradient(gcp, partial_names, weights, sparse_data, sparse_inputs, &sparse_gradient), 0, "test_gd_sparse_gradient");
+	assert_equal_int(sparse_gradient.size(), 3, "test_gd_sparse_gradient");
+	for (VariableVector::iterator it = dense_gradient.begin(); it != dense_gradient.end(); ++it) {
+		double sparse_value = sparse_gradient.count(it->first) == 0 ? 0 : sparse_gradient.at(it->first);
+		assert_equal_double(sparse_value, it->second, "test_gd_sparse_gradient");
+	}
+
+	// dense data also runs sparsely, and a datum must not give a variable twice
+	VariableVector gradient;
+	assert_equal_int(avg_sparse_gradient(gcp, partial_names, weights, dense_data, no_sparse_inputs, &gradient), 0, "test_gd_sparse_gradient");
+	assert_equal_int(gradient.size(), 3, "test_gd_sparse_gradient");
+	assert_equal_int(avg_sparse_gradient(gcp, partial_names, weights, dense_data, sparse_inputs, &gradient), VAR_DECLARED_TWICE, "test_gd_sparse_gradient");
+	assert_equal_int(avg_sparse_gradient(gcp, partial_names, weights, dense_data, {}, &gradient), OTHER_ERROR, "test_gd_sparse_gradient");
+
+	// training sparsely learns the same weights, and never touches the weights whose inputs are always 0
+	VariableVector sparse_weights = calculate_weights(gcp, vector<string>(), partial_names, sparse_data, sparse_inputs);
+	assert_equal_int(sparse_weights.size(), 0, "test_gd_sparse_gradient");
+
+	vector<string> weight_names;
+	for (int i = 0; i < 8; i++) weight_names.push_back("w." + to_string(i));
+	VariableVector dense_weights = calculate_weights(gcp, weight_names, partial_names, dense_data);
+	sparse_weights = calculate_weights(gcp, weight_names, partial_names, sparse_data, sparse_inputs);
+	assert_equal_int(sparse_weights.size(), 8, "test_gd_sparse_gradient");
+	for (int i = 0; i < 8; i++) {
+		string w = "w." + to_string(i);
+		assert_approximately_equal_double(sparse_weights.at(w), dense_weights.at(w), 1e-3, "test_gd_sparse_gradient");
+	}
+	assert_equal_double(sparse_weights.at("w.0"), 0, "test_gd_sparse_gradient");
+	assert_equal_double(sparse_weights.at("w.7"), 0, "test_gd_sparse_gradient");
+
+	pass("test_gd_sparse_gradient");
+
+}
+
+void test_gd_shuffle_indices() {
+
+	vector<size_t> order(100);
+	for (size_t i = 0; i < order.size(); i++) order[i] = i;
+
+	// a shuffle is a permutation, and the same seed always gives the same one
+	mt19937_64 rng(7), same_rng(7), other_rng(8);
+	vector<size_t> shuffled = order, same = order, other = order;
+	shuffle_indices(&shuffled, &rng);
+	shuffle_indices(&same, &same_rng);
+	shuffle_indices(&other, &other_rng);
+	assert_true(shuffled == same, "the same seed gave different permutations", "test_gd_shuffle_indices");
+	assert_false(shuffled == other, "different seeds gave the same permutation", "test_gd_shuffle_indices");
+	assert_false(shuffled == order, "the indices were not shuffled", "test_gd_shuffle_indices");
+	vector<size_t> sorted = shuffled;
+	sort(sorted.begin(), sorted.end());
+	assert_true(sorted == order, "the shuffle is not a permutation", "test_gd_shuffle_indices");
+
+	// the next epoch is shuffled differently
+	vector<size_t> next = shuffled;
+	shuffle_indices(&next, &rng);
+	assert_false(next == shuffled, "two epochs were shuffled the same way", "test_gd_shuffle_indices");
+
+	// nothing to shuffle
+	vector<size_t> empty, single = {0};
+	shuffle_indices(&empty, &rng);
+	shuffle_indices(&single, &rng);
+	assert_equal_int(empty.size(), 0, "test_gd_shuffle_indices");
+	assert_equal_int(single[0], 0, "test_gd_shuffle_indices");
+
+	pass("test_gd_shuffle_indices");
+}
+
+
+void test_gd_stochastic_gradient_descent() {
+
+	// the small net of test_gd_calculate_weights, with exact expected outputs
+	Program gcp;
+	assert_equal_int(gcp.load("tests/test_files/inputs/small_net_gcp.tf"), 0, "test_gd_stochastic_gradient_descent");
+	vector<string> weight_names = {"f", "g", "h"};
+	vector<string> partial_names = {"d/LAMBDA/d/f", "d/LAMBDA/d/g", "d/LAMBDA/d/h"};
+
+	vector<pair<VariableVector, VariableVector> > training_data;
+	for (int i = 0; i < 10; i++) {
+		double a = 1 + 0.1 * i;
+		VariableVector td_input = {{"a", a}, {"b", 2}, {"c", 3}};
+		VariableVector td_output = {{"m", logistic(a * .4)}, {"n", logistic(2 * .2)}, {"p", logistic(3 * .1)}};
+		training_data.push_back(make_pair(td_input, td_output));
+	}
+	vector<SparseVariableVector> sparse_inputs(training_data.size());
+
+	// the gradient of a batch is the average gradient of its data, in any order
+	VariableVector weights = {{"f", 0.1}, {"g", 0.1}, {"h", 0.1}};
+	vector<pair<VariableVector, VariableVector> > two_data = {training_data[3], training_data[8]};
+	VariableVector expected = avg_gradient(gcp, partial_names, weights, two_data);
+	VariableVector gradient;
+	size_t batch[] = {8, 3};
+	assert_equal_int(avg_batch_gradient(gcp, partial_names, weights, training_data, sparse_inputs, batch, 2, &gradient), 0, "test_gd_stochastic_gradient_descent");
+	for (size_t i = 0; i < partial_names.size(); i++) {
+		assert_approximately_equal_double(gradient.at(partial_names[i]), expected.at(partial_names[i]), 1e-12, "test_gd_stochastic_gradient_descent");
+	}
+	size_t bad_batch[] = {3, 10};
+	assert_equal_int(avg_batch_gradient(gcp, partial_names, weights, training_data, sparse_inputs, bad_batch, 2, &gradient), OTHER_ERROR, "test_gd_stochastic_gradient_descent");
+
+	// batches of 4 (so the last batch of every epoch has 2 data) learn the weights
+	SGDOptions options;
+	options.batch_size = 4;
+	options.max_epochs = 400;
+	options.seed = 3;
+	VariableVector learned = stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options);
+	assert_equal_int(learned.size(), 3, "test_gd_stochastic_gradient_descent");
+	assert_approximately_equal_double(learned.at("f"), 0.4, 0.03, "test_gd_stochastic_gradient_descent");
+	assert_approximately_equal_double(learned.at("g"), 0.2, 0.03, "test_gd_stochastic_gradient_descent");
+	assert_approximately_equal_double(learned.at("h"), 0.1, 0.03, "test_gd_stochastic_gradient_descent");
+
+	// the same seed learns the same weights
+	VariableVector again = stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options);
+	for (size_t i = 0; i < weight_names.size(); i++) {
+		assert_equal_double(again.at(weight_names[i]), learned.at(weight_names[i]), "test_gd_stochastic_gradient_descent");
+	}
+
+	// a step limit stops training early: one step of a full batch is one step of gradient descent
+	options.batch_size = training_data.size();
+	options.max_steps = 1;
+	VariableVector one_step = stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options);
+	VariableVector full = avg_gradient(gcp, partial_names, initial_weight_guess(weight_names), training_data);
+	for (size_t i = 0; i < weight_names.size(); i++) {
+		double step = initial_weight_guess(weight_names).at(weight_names[i]) - LEARNING_RATE * full.at(partial_names[i]);
+		assert_approximately_equal_double(one_step.at(weight_names[i]), step, 1e-12, "test_gd_stochastic_gradient_descent");
+	}
+
+	// a batch size of 0, or data without their sparse inputs, learn nothing
+	options.batch_size = 0;
+	assert_equal_int(stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options).size(), 0, "test_gd_stochastic_gradient_descent");
+	options.batch_size = 4;
+	assert_equal_int(stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, {}, options).size(), 0, "test_gd_stochastic_gradient_descent");
+
+	pass("test_gd_stochastic_gradient_descent");
+}
+
+
+void test_gd_optimizers() {
+
+	// the small net of test_gd_calculate_weights, with exact expected outputs
+	Program gcp;
+	assert_equal_int(gcp.load("tests/test_files/inputs/small_net_gcp.tf"), 0, "test_gd_optimizers");
+	vector<string> weight_names = {"f", "g", "h"};
+	vector<string> partial_names = {"d/LAMBDA/d/f", "d/LAMBDA/d/g", "d/LAMBDA/d/h"};
+	vector<pair<VariableVector, VariableVector> > training_data;
+	for (int i = 0; i < 10; i++) {
+		double a = 1 + 0.1 * i;
+		VariableVector td_input = {{"a", a}, {"b", 2}, {"c", 3}};
+		VariableVector td_output = {{"m", logistic(a * .4)}, {"n", logistic(2 * .2)}, {"p", logistic(3 * .1)}};
+		training_data.push_back(make_pair(td_input, td_output));
+	}
+	vector<SparseVariableVector> sparse_inputs(training_data.size());
+
+	// every Optimizer learns the weights
+	OptimizerOptions options;
+	options.max_iterations = 5000;
+	options.gradient_precision = 1e-5;
+	for (OptimizerType t : {OptimizerType::GRADIENT_DESCENT, OptimizerType::MOMENTUM, OptimizerType::NESTEROV,
+		OptimizerType::ADAGRAD, OptimizerType::RMSPROP, OptimizerType::ADAM}) {
+		options.type = t;
+		options.learning_rate = t == OptimizerType::RMSPROP ? 0.001 : (t == OptimizerType::ADAM ? 0.01 : 0.1);
+		VariableVector weights = calculate_weights(gcp, weight_names, partial_names, training_data, sparse_inputs, options);
+		assert_equal_int(weights.size(), 3, "test_gd_optimizers");
+		assert_approximately_equal_double(weights.at("f"), 0.4, 0.03, "test_gd_optimizers");
+		assert_approximately_equal_double(weights.at("g"), 0.2, 0.03, "test_gd_optimizers");
+		assert_approximately_equal_double(weights.at("h"), 0.1, 0.03, "test_gd_optimizers");
+	}
+
+	// so does stochastic gradient descent with an Optimizer
+	SGDOptions sgd;
+	sgd.batch_size = 5;
+	sgd.max_epochs = 300;
+	options.type = OptimizerType::ADAM;
+	options.learning_rate = 0.01;
+	VariableVector weights = stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, sgd, options);
+	assert_approximately_equal_double(weights.at("f"), 0.4, 0.03, "test_gd_optimizers");
+	assert_approximately_equal_double(weights.at("g"), 0.2, 0.03, "test_gd_optimizers");
+	assert_approximately_equal_double(weights.at("h"), 0.1, 0.03, "test_gd_optimizers");
+
+	// no iterations leave the initial guess, and hyperparameters out of range learn nothing
+	options.max_iterations = 0;
+	weights = calculate_weights(gcp, weight_names, partial_names, training_data, sparse_inputs, options);
+	assert_equal_double(weights.at("f"), 0, "test_gd_optimizers");
+	options.beta1 = 1;
+	assert_equal_int(calculate_weights(gcp, weight_names, partial_names, training_data, sparse_inputs, options).size(), 0, "test_gd_optimizers");
+	assert_equal_int(stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, sgd, options).size(), 0, "test_gd_optimizers");
+
+	// every partial must be the partial of a weight
+	options = OptimizerOptions();
+	vector<string> other_partials = {"d/LAMBDA/d/f", "d/LAMBDA/d/g", "d/LAMBDA/d/q"};
+	assert_equal_int(calculate_weights(gcp, weight_names, other_partials, training_data, sparse_inputs, options).size(), 0, "test_gd_optimizers");
+
+	pass("test_gd_optimizers");
+}
+
+
+void test_gd_lbfgs() {
+
+	// the small net of test_gd_calculate_weights, with exact expected outputs
+	Program gcp;
+	assert_equal_int(gcp.load("tests/test_files/inputs/small_net_gcp.tf"), 0, "test_gd_lbfgs");
+	vector<string> weight_names = {"f", "g", "h"};
+	vector<string> partial_names = {"d/LAMBDA/d/f", "d/LAMBDA/d/g", "d/LAMBDA/d/h"};
+	vector<pair<VariableVector, VariableVector> > training_data;
+	for (int i = 0; i < 10; i++) {
+		double a = 1 + 0.1 * i;
+		VariableVector td_input = {{"a", a}, {"b", 2}, {"c", 3}};
+		VariableVector td_output = {{"m", logistic(a * .4)}, {"n", logistic(2 * .2)}, {"p", logistic(3 * .1)}};
+		training_data.push_back(make_pair(td_input, td_output));
+	}
+	vector<SparseVariableVector> sparse_inputs(training_data.size());
+
+	// the objective is the loss LAMBDA, which is read from the same runs as the gradient
+	vector<ObjectiveTerm> objective;
+	assert_equal_int(find_objective_terms(gcp, partial_names, &objective), 0, "test_gd_lbfgs");
+	assert_equal_int(objective.size(), 1, "test_gd_lbfgs");
+	assert_true(objective[0].loss_slot == gcp.get_slot("LAMBDA"), "the objective is not LAMBDA", "test_gd_lbfgs");
+	assert_true(objective[0].seed_slot == INVALID_SLOT, "a single loss has no seed", "test_gd_lbfgs");
+
+	// with every weight 0, every output is logistic(0) = 0.5, and LAMBDA is the mean of the three squared errors
+	double expected_loss = 0;
+	for (size_t i = 0; i < training_data.size(); i++) {
+		const VariableVector& outputs = training_data[i].second;
+		expected_loss += (pow(0.5 - outputs.at("m"), 2) + pow(0.5 - outputs.at("n"), 2) + pow(0.5 - outputs.at("p"), 2)) / 3;
+	}
+	expected_loss /= training_data.size();
+	VariableVector weights = initial_weight_guess(weight_names), gradient, sparse_gradient;
+	double loss;
+	assert_equal_int(avg_loss_and_gradient(gcp, partial_names, objective, weights, training_data, sparse_inputs, &loss, &gradient), 0, "test_gd_lbfgs");
+	assert_approximately_equal_double(loss, expected_loss, 1e-12, "test_gd_lbfgs");
+	assert_equal_int(avg_sparse_gradient(gcp, partial_names, weights, training_data, sparse_inputs, &sparse_gradient), 0, "test_gd_lbfgs");
+	for (size_t i = 0; i < partial_names.size(); i++) {
+		assert_equal_double(gradient.at(partial_names[i]), sparse_gradient.at(partial_names[i]), "test_gd_lbfgs");
+	}
+
+	// L-BFGS learns the weights in far fewer passes over the data than gradient descent takes
+	OptimizerOptions options;
+	options.type = OptimizerType::LBFGS;
+	options.gradient_precision = 1e-7;
+	int64_t num_evaluations;
+	weights = calculate_weights_lbfgs(gcp, weight_names, partial_names, training_data, sparse_inputs, options, &num_evaluations);
+	assert_equal_int(weights.size(), 3, "test_gd_lbfgs");
+	assert_approximately_equal_double(weights.at("f"), 0.4, 1e-3, "test_gd_lbfgs");
+	assert_approximately_equal_double(weights.at("g"), 0.2, 1e-3, "test_gd_lbfgs");
+	assert_approximately_equal_double(weights.at("h"), 0.1, 1e-3, "test_gd_lbfgs");
+	assert_true(num_evaluations < 100, "L-BFGS took too many passes over the data", "test_gd_lbfgs");
+
+	// calculate_weights runs L-BFGS when the options name it
+	VariableVector same = calculate_weights(gcp, weight_names, partial_names, training_data, sparse_inputs, options);
+	assert_equal_double(same.at("f"), weights.at("f"), "test_gd_lbfgs");
+
+	// the partials must all be partials of one objective of the GCP, and L-BFGS is never stochastic
+	vector<string> mixed_partials = {"d/LAMBDA/d/f", "d/other/d/g", "d/LAMBDA/d/h"};
+	assert_equal_int(find_objective_terms(gcp, mixed_partials, &objective), OTHER_ERROR, "test_gd_lbfgs");
+	vector<string> missing_objective = {"d/nothing/d/f", "d/nothing/d/g", "d/nothing/d/h"};
+	assert_equal_int(find_objective_terms(gcp, missing_objective, &objective), OTHER_ERROR, "test_gd_lbfgs");
+	assert_equal_int(calculate_weights_lbfgs(gcp, weight_names, missing_objective, training_data, sparse_inputs, options, NULL).size(), 0, "test_gd_lbfgs");
+	SGDOptions sgd;
+	assert_equal_int(stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, sgd, options).size(), 0, "test_gd_lbfgs");
+
+	pass("test_gd_lbfgs");
+}
+
+
+void test_gd_hogwild() {
+
+	// the data of test_gd_stochastic_gradient_descent
+	Program gcp;
+	assert_equal_int(gcp.load("tests/test_files/inputs/small_net_gcp.tf"), 0, "test_gd_hogwild");
+	vector<string> weight_names = {"f", "g", "h"};
+	vector<string> partial_names = {"d/LAMBDA/d/f", "d/LAMBDA/d/g", "d/LAMBDA/d/h"};
+
+	vector<pair<VariableVector, VariableVector> > training_data;
+	for (int i = 0; i < 10; i++) {
+		double a = 1 + 0.1 * i;
+		VariableVector td_input = {{"a", a}, {"b", 2}, {"c", 3}};
+		VariableVector td_output = {{"m", logistic(a * .4)}, {"n", logistic(2 * .2)}, {"p", logistic(3 * .1)}};
+		training_data.push_back(make_pair(td_input, td_output));
+	}
+	vector<SparseVariableVector> sparse_inputs(training_data.size());
+
+	// four threads learn the weights, taking as many steps between them as one thread would
+	SGDOptions options;
+	options.batch_size = 4;
+	options.max_epochs = 400;
+	options.num_threads = 4;
+	HogwildStats stats;
+	VariableVector learned = hogwild_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options, OptimizerOptions(), &stats);
+	assert_equal_int(learned.size(), 3, "test_gd_hogwild");
+	assert_approximately_equal_double(learned.at("f"), 0.4, 0.03, "test_gd_hogwild");
+	assert_approximately_equal_double(learned.at("g"), 0.2, 0.03, "test_gd_hogwild");
+	assert_approximately_equal_double(learned.at("h"), 0.1, 0.03, "test_gd_hogwild");
+	assert_equal_int(stats.num_steps, 400 * 3, "test_gd_hogwild");
+	assert_true(stats.total_staleness >= 0 && stats.max_staleness <= stats.num_steps, "the staleness is out of range", "test_gd_hogwild");
+	assert_true(stats.num_conflicts >= 0, "the conflicts are out of range", "test_gd_hogwild");
+
+	// stochastic gradient descent with several threads is asynchronous
+	learned = stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options);
+	assert_approximately_equal_double(learned.at("f"), 0.4, 0.03, "test_gd_hogwild");
+
+	// one thread is never stale, and never collides
+	options.num_threads = 1;
+	options.max_steps = 50;
+	learned = hogwild_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options, OptimizerOptions(), &stats);
+	assert_equal_int(learned.size(), 3, "test_gd_hogwild");
+	assert_equal_int(stats.num_steps, 50, "test_gd_hogwild");
+	assert_equal_int(stats.total_staleness, 0, "test_gd_hogwild");
+	assert_equal_int(stats.num_conflicts, 0, "test_gd_hogwild");
+
+	// only plain gradient descent steps are taken, by at least one thread, on data the GCP can run
+	OptimizerOptions adam;
+	adam.type = OptimizerType::ADAM;
+	assert_equal_int(hogwild_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options, adam, NULL).size(), 0, "test_gd_hogwild");
+	options.num_threads = 0;
+	assert_equal_int(hogwild_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options, OptimizerOptions(), NULL).size(), 0, "test_gd_hogwild");
+	options.num_threads = 2;
+	training_data[5].first.erase("a");
+	assert_equal_int(hogwild_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options, OptimizerOptions(), NULL).size(), 0, "test_gd_hogwild");
+
+	pass("test_gd_hogwild");
+}
+
+
+void test_gd_data_parallel() {
+
+	// the data of test_gd_lbfgs, which do not split evenly between 3 processes
+	Program gcp;
+	assert_equal_int(gcp.load("tests/test_files/inputs/small_net_gcp.tf"), 0, "test_gd_data_parallel");
+	vector<string> weight_names = {"f", "g", "h"};
+	vector<string> partial_names = {"d/LAMBDA/d/f", "d/LAMBDA/d/g", "d/LAMBDA/d/h"};
+	vector<pair<VariableVector, VariableVector> > training_data;
+	for (int i = 0; i < 10; i++) {
+		double a = 1 + 0.1 * i;
+		VariableVector td_input = {{"a", a}, {"b", 2}, {"c", 3}};
+		VariableVector td_output = {{"m", logistic(a * .4)}, {"n", logistic(2 * .2)}, {"p", logistic(3 * .1)}};
+		training_data.push_back(make_pair(td_input, td_output));
+	}
+	vector<SparseVariableVector> sparse_inputs(training_data.size());
+
+	// the workers take the steps one process takes, up to the rounding of the sums of their shards
+	OptimizerOptions options;
+	options.type = OptimizerType::MOMENTUM;
+	options.max_iterations = 300;
+	VariableVector expected = calculate_weights(gcp, weight_names, partial_names, training_data, sparse_inputs, options);
+	VariableVector learned = data_parallel_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options, 3);
+	assert_equal_int(learned.size(), 3, "test_gd_data_parallel");
+	for (size_t i = 0; i < weight_names.size(); i++) {
+		assert_approximately_equal_double(learned.at(weight_names[i]), expected.at(weight_names[i]), 1e-9, "test_gd_data_parallel");
+	}
+
+	// L-BFGS reads the loss from the allreduce too
+	options.type = OptimizerType::LBFGS;
+	learned = data_parallel_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options, 3);
+	assert_equal_int(learned.size(), 3, "test_gd_data_parallel");
+	assert_approximately_equal_double(learned.at("f"), 0.4, 1e-4, "test_gd_data_parallel");
+	assert_approximately_equal_double(learned.at("g"), 0.2, 1e-4, "test_gd_data_parallel");
+	assert_approximately_equal_double(learned.at("h"), 0.1, 1e-4, "test_gd_data_parallel");
+
+	// more processes than data leaves some with empty shards
+	options.type = OptimizerType::GRADIENT_DESCENT;
+	options.max_iterations = 50;
+	expected = calculate_weights(gcp, weight_names, partial_names, training_data, sparse_inputs, options);
+	learned = data_parallel_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options, 12);
+	assert_approximately_equal_double(learned.at("f"), expected.at("f"), 1e-9, "test_gd_data_parallel");
+
+	// a datum the GCP cannot run fails every worker, without hanging the others
+	assert_equal_int(data_parallel_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options, 0).size(), 0, "test_gd_data_parallel");
+	training_data[7].first.erase("a");
+	assert_equal_int(data_parallel_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, options, 3).size(), 0, "test_gd_data_parallel");
+
+	pass("test_gd_data_parallel");
+}
+
+void test_gd_parameter_server() {
+
+	// the data of test_gd_stochastic_gradient_descent
+	Program gcp;
+	assert_equal_int(gcp.load("tests/test_files/inputs/small_net_gcp.tf"), 0, "test_gd_parameter_server");
+	vector<string> weight_names = {"f", "g", "h"};
+	vector<string> partial_names = {"d/LAMBDA/d/f", "d/LAMBDA/d/g", "d/LAMBDA/d/h"};
+	vector<pair<VariableVector, VariableVector> > training_data;
+	for (int i = 0; i < 10; i++) {
+		double a = 1 + 0.1 * i;
+		VariableVector td_input = {{"a", a}, {"b", 2}, {"c", 3}};
+		VariableVector td_output = {{"m", logistic(a * .4)}, {"n", logistic(2 * .2)}, {"p", logistic(3 * .1)}};
+		training_data.push_back(make_pair(td_input, td_output));
+	}
+	vector<SparseVariableVector> sparse_inputs(training_data.size());
+
+	// three workers each pass over their shard, in batches of 2, and the server applies every one of their gradients
+	SGDOptions options;
+	options.batch_size = 2;
+	options.max_epochs = 200;
+	ParameterServerStats stats;
+	VariableVector learned = parameter_server_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs,
+		options, OptimizerOptions(), 3, &stats);
+	assert_equal_int(learned.size(), 3, "test_gd_parameter_server");
+	assert_approximately_equal_double(learned.at("f"), 0.4, 0.03, "test_gd_parameter_server");
+	assert_approximately_equal_double(learned.at("g"), 0.2, 0.03, "test_gd_parameter_server");
+	assert_approximately_equal_double(learned.at("h"), 0.1, 0.03, "test_gd_parameter_server");
+	// the shards have 3, 3 and 4 data, so 2, 2 and 2 batches
+	assert_equal_int(stats.num_updates, 200 * 6, "test_gd_parameter_server");
+
+	// with a bound on staleness, and a limit on the updates
+	options.staleness_bound = 1;
+	options.max_steps = 100;
+	learned = parameter_server_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs,
+		options, OptimizerOptions(), 3, &stats);
+	assert_equal_int(learned.size(), 3, "test_gd_parameter_server");
+	assert_equal_int(stats.num_updates, 100, "test_gd_parameter_server");
+
+	// the server takes no L-BFGS steps, and fails with a worker whose shard the GCP cannot run
+	OptimizerOptions lbfgs;
+	lbfgs.type = OptimizerType::LBFGS;
+	assert_equal_int(parameter_server_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs,
+		options, lbfgs, 3, NULL).size(), 0, "test_gd_parameter_server");
+	training_data[8].first.erase("a");
+	assert_equal_int(parameter_server_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs,
+		options, OptimizerOptions(), 3, NULL).size(), 0, "test_gd_parameter_server");
+
+	pass("test_gd_parameter_server");
+}
+
+
+/* Returns true if A and B hold exactly the same weights. */
+static bool same_weights(const VariableVector& a, const VariableVector& b) {
+	if (a.size() != b.size()) return false;
+	for (auto it = a.begin(); it != a.end(); it++) {
+		if (b.count(it->first) == 0 || b.at(it->first) != it->second) return false;
+	}
+	return true;
+}
+
+
+void test_gd_checkpoint() {
+
+	// the small net of test_gd_calculate_weights, with exact expected outputs
+	Program gcp;
+	assert_equal_int(gcp.load("tests/test_files/inputs/small_net_gcp.tf"), 0, "test_gd_checkpoint");
+	vector<string> weight_names = {"f", "g", "h"};
+	vector<string> partial_names = {"d/LAMBDA/d/f", "d/LAMBDA/d/g", "d/LAMBDA/d/h"};
+	vector<pair<VariableVector, VariableVector> > training_data;
+	for (int i = 0; i < 10; i++) {
+		double a = 1 + 0.1 * i;
+		VariableVector td_input = {{"a", a}, {"b", 2}, {"c", 3}};
+		VariableVector td_output = {{"m", logistic(a * .4)}, {"n", logistic(2 * .2)}, {"p", logistic(3 * .1)}};
+		training_data.push_back(make_pair(td_input, td_output));
+	}
+	vector<SparseVariableVector> sparse_inputs(training_data.size());
+	remove("scratch.ckpt");
+
+	// a full-batch run stopped after 15 steps, and resumed, learns exactly the weights of a run that was not stopped
+	OptimizerOptions options;
+	options.type = OptimizerType::ADAM;
+	options.learning_rate = 0.01;
+	options.gradient_precision = 0;
+	options.max_iterations = 40;
+	VariableVector expected = calculate_weights(gcp, weight_names, partial_names, training_data, sparse_inputs, options);
+	assert_equal_int(expected.size(), 3, "test_gd_checkpoint");
+
+	CheckpointOptions checkpoint;
+	checkpoint.filename = "scratch.ckpt";
+	checkpoint.interval = 4;
+	options.max_iterations = 15;
+	VariableVector stopped = calculate_weights(gcp, weight_names, partial_names, training_data, sparse_inputs, options, checkpoint);
+	assert_equal_int(stopped.size(), 3, "test_gd_checkpoint");
+	assert_true(!same_weights(stopped, expected), "the stopped run has not learned the weights yet", "test_gd_checkpoint");
+	TrainingState state;
+	assert_equal_int(read_training_state("scratch.ckpt", &state), 0, "test_gd_checkpoint");
+	assert_equal_int(state.num_steps, 15, "test_gd_checkpoint");
+
+	checkpoint.resume = true;
+	options.max_iterations = 40;
+	VariableVector resumed = calculate_weights(gcp, weight_names, partial_names, training_data, sparse_inputs, options, checkpoint);
+	assert_true(same_weights(resumed, expected), "the resumed full-batch run learns the same weights", "test_gd_checkpoint");
+
+	// a checkpoint of one Optimizer is not resumed by another, nor one of other weights
+	options.type = OptimizerType::MOMENTUM;
+	assert_equal_int(calculate_weights(gcp, weight_names, partial_names, training_data, sparse_inputs, options, checkpoint).size(), 0, "test_gd_checkpoint");
+	options.type = OptimizerType::ADAM;
+	vector<string> other_weights = {"g", "f", "h"};
+	vector<string> other_partials = {"d/LAMBDA/d/g", "d/LAMBDA/d/f", "d/LAMBDA/d/h"};
+	assert_equal_int(calculate_weights(gcp, other_weights, other_partials, training_data, sparse_inputs, options, checkpoint).size(), 0, "test_gd_checkpoint");
+
+	// stochastic runs stopped in the middle of an epoch, and at its end, and resumed, learn exactly the weights of a run that was not stopped
+	SGDOptions sgd;
+	sgd.batch_size = 3;
+	sgd.max_epochs = 5;
+	sgd.seed = 7;
+	options.type = OptimizerType::MOMENTUM;
+	options.learning_rate = 0.1;
+	expected = stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, sgd, options);
+	assert_equal_int(expected.size(), 3, "test_gd_checkpoint");
+
+	// a full-batch checkpoint is not resumed by a stochastic run
+	assert_equal_int(stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, sgd, options, checkpoint).size(), 0, "test_gd_checkpoint");
+
+	for (int64_t steps : {7, 8}) {
+		remove("scratch.ckpt");
+		sgd.max_steps = steps;
+		stopped = stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, sgd, options, checkpoint);
+		assert_equal_int(stopped.size(), 3, "test_gd_checkpoint");
+		assert_equal_int(read_training_state("scratch.ckpt", &state), 0, "test_gd_checkpoint");
+		assert_equal_int(state.num_steps, steps, "test_gd_checkpoint");
+
+		sgd.max_steps = 0;
+		resumed = stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, sgd, options, checkpoint);
+		assert_true(same_weights(resumed, expected), "the resumed stochastic run learns the same weights", "test_gd_checkpoint");
+	}
+
+	// nor is a stochastic checkpoint resumed by a full-batch run
+	assert_equal_int(calculate_weights(gcp, weight_names, partial_names, training_data, sparse_inputs, options, checkpoint).size(), 0, "test_gd_checkpoint");
+
+	// with no checkpoint to resume from, a run starts over; L-BFGS and asynchronous runs are not checkpointed
+	remove("scratch.ckpt");
+	resumed = stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, sgd, options, checkpoint);
+	assert_true(same_weights(resumed, expected), "a run with no checkpoint starts over", "test_gd_checkpoint");
+	sgd.num_threads = 2;
+	assert_equal_int(stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, sgd, options, checkpoint).size(), 0, "test_gd_checkpoint");
+	options.type = OptimizerType::LBFGS;
+	assert_equal_int(calculate_weights(gcp, weight_names, partial_names, training_data, sparse_inputs, options, checkpoint).size(), 0, "test_gd_checkpoint");
+
+	remove("scratch.ckpt");
+	pass("test_gd_checkpoint");
+}
+
+
+void test_gd_streaming() {
+
+	// the small net of test_gd_calculate_weights, with exact expected outputs, streamed from a record file, in chunks of 3 data
+	Program gcp;
+	assert_equal_int(gcp.load("tests/test_files/inputs/small_net_gcp.tf"), 0, "test_gd_streaming");
+	vector<string> weight_names = {"f", "g", "h"};
+	vector<string> partial_names = {"d/LAMBDA/d/f", "d/LAMBDA/d/g", "d/LAMBDA/d/h"};
+	vector<pair<VariableVector, VariableVector> > training_data;
+	for (int i = 0; i < 10; i++) {
+		double a = 1 + 0.1 * i;
+		VariableVector td_input = {{"a", a}, {"b", 2}, {"c", 3}};
+		VariableVector td_output = {{"m", logistic(a * .4)}, {"n", logistic(2 * .2)}, {"p", logistic(3 * .1)}};
+		training_data.push_back(make_pair(td_input, td_output));
+	}
+	vector<SparseVariableVector> sparse_inputs(training_data.size());
+	vector<string> column_names = {"m", "a", "b", "c", "n", "p"};
+	assert_equal_int(write_record_file("scratch.rec", column_names, training_data), 0, "test_gd_streaming");
+	RecordFileSource source(3 * column_names.size() * sizeof(double));
+	assert_equal_int(source.open("scratch.rec"), 0, "test_gd_streaming");
+	VariableVector no_inputs;
+
+	// full-batch training on the stream learns exactly the weights it learns in memory, with an Optimizer and with L-BFGS
+	OptimizerOptions options;
+	options.type = OptimizerType::ADAM;
+	options.learning_rate = 0.01;
+	options.gradient_precision = 0;
+	options.max_iterations = 40;
+	for (OptimizerType t : {OptimizerType::ADAM, OptimizerType::LBFGS}) {
+		options.type = t;
+		VariableVector expected = calculate_weights(gcp, weight_names, partial_names, training_data, sparse_inputs, options, CheckpointOptions());
+		VariableVector streamed = calculate_weights(gcp, weight_names, partial_names, &source, no_inputs, options, CheckpointOptions());
+		assert_equal_int(streamed.size(), 3, "test_gd_streaming");
+		for (size_t i = 0; i < weight_names.size(); i++) {
+			assert_true(streamed.at(weight_names[i]) == expected.at(weight_names[i]), "streamed weights are exactly those learned in memory", "test_gd_streaming");
+		}
+	}
+
+	// stochastic training on the stream learns the weights, and the same seed learns the same weights
+	SGDOptions sgd;
+	sgd.batch_size = 4;
+	sgd.max_epochs = 400;
+	sgd.seed = 3;
+	VariableVector learned = stochastic_gradient_descent(gcp, weight_names, partial_names, &source, no_inputs, sgd, OptimizerOptions(), CheckpointOptions());
+	assert_equal_int(learned.size(), 3, "test_gd_streaming");
+	assert_approximately_equal_double(learned.at("f"), 0.4, 0.03, "test_gd_streaming");
+	assert_approximately_equal_double(learned.at("g"), 0.2, 0.03, "test_gd_streaming");
+	assert_approximately_equal_double(learned.at("h"), 0.1, 0.03, "test_gd_streaming");
+	VariableVector again = stochastic_gradient_descent(gcp, weight_names, partial_names, &source, no_inputs, sgd, OptimizerOptions(), CheckpointOptions());
+	for (size_t i = 0; i < weight_names.size(); i++) {
+		assert_equal_double(again.at(weight_names[i]), learned.at(weight_names[i]), "test_gd_streaming");
+	}
+
+	// a streamed run stopped in the middle of a pass, and at its end, and resumed, learns exactly the weights of a run that was not stopped
+	SGDOptions short_sgd;
+	short_sgd.batch_size = 4;
+	short_sgd.max_epochs = 5;
+	short_sgd.seed = 7;
+	OptimizerOptions momentum;
+	momentum.type = OptimizerType::MOMENTUM;
+	momentum.learning_rate = 0.1;
+	VariableVector uninterrupted = stochastic_gradient_descent(gcp, weight_names, partial_names, &source, no_inputs, short_sgd, momentum,
+		CheckpointOptions());
+	assert_equal_int(uninterrupted.size(), 3, "test_gd_streaming");
+	CheckpointOptions checkpoint;
+	checkpoint.filename = "scratch.ckpt";
+	checkpoint.interval = 2;
+	checkpoint.resume = true;
+	for (int64_t steps : {7, 9}) {
+		remove("scratch.ckpt");
+		short_sgd.max_steps = steps;
+		VariableVector stopped = stochastic_gradient_descent(gcp, weight_names, partial_names, &source, no_inputs, short_sgd, momentum, checkpoint);
+		assert_equal_int(stopped.size(), 3, "test_gd_streaming");
+		TrainingState state;
+		assert_equal_int(read_training_state("scratch.ckpt", &state), 0, "test_gd_streaming");
+		assert_equal_int(state.num_steps, steps, "test_gd_streaming");
+		assert_equal_int(state.next_batch, steps == 7 ? 1 : 3, "test_gd_streaming");
+		assert_true(state.order.empty(), "a streamed checkpoint has no order", "test_gd_streaming");
+
+		short_sgd.max_steps = 0;
+		VariableVector resumed = stochastic_gradient_descent(gcp, weight_names, partial_names, &source, no_inputs, short_sgd, momentum, checkpoint);
+		assert_true(same_weights(resumed, uninterrupted), "the resumed streamed run learns the same weights", "test_gd_streaming");
+	}
+
+	// a streamed checkpoint is not resumed in memory, nor by a full-batch run, nor from beyond the end of its pass
+	assert_equal_int(stochastic_gradient_descent(gcp, weight_names, partial_names, training_data, sparse_inputs, short_sgd, momentum, checkpoint).size(), 0,
+		"test_gd_streaming");
+	assert_equal_int(calculate_weights(gcp, weight_names, partial_names, &source, no_inputs, momentum, checkpoint).size(), 0, "test_gd_streaming");
+	TrainingState beyond;
+	assert_equal_int(read_training_state("scratch.ckpt", &beyond), 0, "test_gd_streaming");
+	beyond.epoch = 0;
+	beyond.next_batch = 4;
+	assert_equal_int(write_training_state("scratch.ckpt", beyond), 0, "test_gd_streaming");
+	assert_equal_int(stochastic_gradient_descent(gcp, weight_names, partial_names, &source, no_inputs, short_sgd, momentum, checkpoint).size(), 0,
+		"test_gd_streaming");
+	remove("scratch.ckpt");
+
+	// one step of a full batch in order is one step of gradient descent
+	sgd.batch_size = training_data.size();
+	sgd.max_steps = 1;
+	VariableVector one_step = stochastic_gradient_descent(gcp, weight_names, partial_names, &source, no_inputs, sgd, OptimizerOptions(), CheckpointOptions());
+	options = OptimizerOptions();
+	options.max_iterations = 1;
+	VariableVector expected = calculate_weights(gcp, weight_names, partial_names, training_data, sparse_inputs, options);
+	for (size_t i = 0; i < weight_names.size(); i++) {
+		assert_equal_double(one_step.at(weight_names[i]), expected.at(weight_names[i]), "test_gd_streaming");
+	}
+
+	// a datum that misses an input cannot be run, and streamed training is not asynchronous
+	source.close();
+	vector<string> missing_column = {"m", "a", "b", "n", "p"};
+	assert_equal_int(write_record_file("scratch.rec", missing_column, training_data), 0, "test_gd_streaming");
+	assert_equal_int(source.open("scratch.rec"), 0, "test_gd_streaming");
+	assert_equal_int(calculate_weights(gcp, weight_names, partial_names, &source, no_inputs, options, CheckpointOptions()).size(), 0, "test_gd_streaming");
+	VariableVector c_input = {{"c", 3}};
+	assert_equal_int(calculate_weights(gcp, weight_names, partial_names, &source, c_input, options, CheckpointOptions()).size(), 3, "test_gd_streaming");
+	sgd.num_threads = 2;
+	assert_equal_int(stochastic_gradient_descent(gcp, weight_names, partial_names, &source, c_input, sgd, OptimizerOptions(), CheckpointOptions()).size(), 0, "test_gd_streaming");
+	source.close();
+
+	remove("scratch.rec");
+	pass("test_gd_streaming");
+}
+
+
 void test_gd_partial_name_to_weight_name() {
 	
 	assert_equal_string(partial_name_to_weight_name(""), "", "test_gd_partial_name_to_weight_name");
 	assert_equal_string(partial_name_to_weight_name("foo"), "", "test_gd_partial_name_to_weight_name");
 	assert_equal_string(partial_name_to_weight_name("d/lambda/da"), "", "test_gd_partial_name_to_weight_name");
 	assert_equal_string(partial_name_to_weight_name("d/lambda/d/a"), "a", "test_gd_partial_name_to_weight_name");
+	assert_equal_string(partial_name_to_weight_name("d/L/d/w.1"), "w.1", "test_gd_partial_name_to_weight_name");
+	assert_equal_string(partial_name_to_weight_name("d/total/objective/d/w"), "w", "test_gd_partial_name_to_weight_name");
+	assert_equal_string(partial_name_to_weight_name("d/lambda/d/"), "", "test_gd_partial_name_to_weight_name");
 
 	pass("test_gd_partial_name_to_weight_name");
 }
@@ -404,6 +1122,16 @@ void run_gd_tests() {
 	test_gd_add_variable_vectors();
 	test_gd_component_wise_div();
 	test_gd_increment_weight_vector();
+	test_gd_sparse_gradient();
+	test_gd_shuffle_indices();
+	test_gd_stochastic_gradient_descent();
+	test_gd_optimizers();
+	test_gd_lbfgs();
+	test_gd_hogwild();
+	test_gd_data_parallel();
+	test_gd_parameter_server();
+	test_gd_checkpoint();
+	test_gd_streaming();
 	test_gd_partial_name_to_weight_name();
 	test_gd_scale_variable_vector();
 	test_gd_approx_zero();
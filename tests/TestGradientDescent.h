@@ -16,6 +16,16 @@ void test_gd_vector_of_zeros();
 void test_gd_add_variable_vectors();
 void test_gd_component_wise_div();
 void test_gd_increment_weight_vector();
+void test_gd_sparse_gradient();
+void test_gd_shuffle_indices();
+void test_gd_stochastic_gradient_descent();
+void test_gd_optimizers();
+void test_gd_lbfgs();
+void test_gd_hogwild();
+void test_gd_data_parallel();
+void test_gd_parameter_server();
+void test_gd_checkpoint();
+void test_gd_streaming();
 void test_gd_partial_name_to_weight_name();
 void test_gd_scale_variable_vector();
 void test_gd_approx_zero();
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <math.h>
 #include <fstream>
 #include <cfloat>
 
@@ -116,7 +117,7 @@ void test_interp_accumulate_outputs() {
 	// give them some values
 	// make B and C output values
 	BindingsDictionary *bd = i.get_bindings_dictionary();
-	unordered_map<string, VariableType> *var_types = i.get_var_types();
+	unordered_map<Symbol, VariableType> *var_types = i.get_var_types();
 	bd->add_variable("a"); bd->add_variable("b"); bd->add_variable("c");
 	bd->bind_value("a", 3); bd->bind_value("b", -0.2); bd->bind_value("c", 92.1);
 	var_types->insert(make_pair("a", VariableType::INPUT));
@@ -337,6 +338,68 @@ void test_interp_apply_unary_operation() {
 }
 
 
+void test_interp_sparse_inputs() {
+
+	Interpreter i;
+	string vec_name;
+	SparseVector vec;
+
+	// sparse lines list {<component number>:<value>} pairs, in increasing order
+	assert_true(is_sparse_input_line("x\t0:1 3:2"), "x should be a sparse line", "test_interp_sparse_inputs");
+	assert_false(is_sparse_input_line("x\t0.5"), "x should not be a sparse line", "test_interp_sparse_inputs");
+	assert_equal_int(i.parse_sparse_input_line("x\t0:1  3:-2.5 ", &vec_name, &vec), 0, "test_interp_sparse_inputs");
+	assert_equal_string(vec_name, "x", "test_interp_sparse_inputs");
+	assert_equal_int(vec.indices.size(), 2, "test_interp_sparse_inputs");
+	assert_equal_double(get_sparse_component(vec, 3), -2.5, "test_interp_sparse_inputs");
+	assert_equal_double(get_sparse_component(vec, 2), 0, "test_interp_sparse_inputs");
+	assert_equal_int(i.parse_sparse_input_line("x\t3:1 0:2", &vec_name, &vec), INVALID_LINE, "test_interp_sparse_inputs");
+	assert_equal_int(i.parse_sparse_input_line("x\t1:1 1:2", &vec_name, &vec), INVALID_LINE, "test_interp_sparse_inputs");
+	assert_equal_int(i.parse_sparse_input_line("x\t-1:1", &vec_name, &vec), INVALID_LINE, "test_interp_sparse_inputs");
+	assert_equal_int(i.parse_sparse_input_line("x\t1:one", &vec_name, &vec), INVALID_LINE, "test_interp_sparse_inputs");
+	assert_equal_int(i.parse_sparse_input_line("x\t1:1 2", &vec_name, &vec), INVALID_LINE, "test_interp_sparse_inputs");
+	assert_equal_int(i.parse_sparse_input_line("x\t1:1\t2:2", &vec_name, &vec), INVALID_LINE, "test_interp_sparse_inputs");
+
+	// an input file may give some vectors sparsely, and the dense parser refuses them
+	ofstream input_file("scratch.tf");
+	input_file << "a\t0:1 1:2 2:1\nb.0\t1\nb.1\t2\nb.2\t-1\nc\t0:2 1:4 2:6\nd\t0:1 1:3 2:5\ne\t0:1 1:2 2:3\nf\t0:2 1:3 2:4\n";
+	input_file.close();
+	unordered_map<string, double> inputs;
+	SparseVariableVector sparse_inputs;
+	assert_equal_int(i.parse_input_file("scratch.tf", &inputs), INVALID_LINE, "test_interp_sparse_inputs");
+	inputs.clear();
+	assert_equal_int(i.parse_input_file("scratch.tf", &inputs, &sparse_inputs), 0, "test_interp_sparse_inputs");
+	assert_equal_int(inputs.size(), 3, "test_interp_sparse_inputs");
+	assert_equal_int(sparse_inputs.size(), 5, "test_interp_sparse_inputs");
+
+	// interpreting with sparse inputs gives the outputs of the same inputs given densely (see test_interp_constructor_interpret_destructor)
+	unordered_map<string, double> outputs;
+	assert_equal_int(i.interpret("tests/test_files/inputs/expanded_shape_simple.tf", inputs, sparse_inputs, &outputs), 0, "test_interp_sparse_inputs");
+	assert_equal_int(outputs.size(), 23, "test_interp_sparse_inputs");
+	assert_equal_double(outputs.at("foo"), 4, "test_interp_sparse_inputs");
+	assert_equal_double(outputs.at("C.2"), 44, "test_interp_sparse_inputs");
+
+	// unlisted components are 0, and a component can't be given twice
+	Interpreter zeros;
+	sparse_inputs["a"] = {{1}, {3}};
+	outputs.clear();
+	assert_equal_int(zeros.interpret("tests/test_files/inputs/expanded_shape_simple.tf", inputs, sparse_inputs, &outputs), 0, "test_interp_sparse_inputs");
+	assert_equal_double(outputs.at("foo"), 6, "test_interp_sparse_inputs");
+	assert_equal_double(outputs.at("A.0"), 3, "test_interp_sparse_inputs");
+
+	Interpreter twice;
+	inputs["a.0"] = 1;
+	assert_equal_int(twice.interpret("tests/test_files/inputs/expanded_shape_simple.tf", inputs, sparse_inputs, &outputs), VAR_DEFINED_TWICE, "test_interp_sparse_inputs");
+
+	input_file.open("scratch.tf");
+	input_file << "a\t0:1\na\t1:1\n";
+	input_file.close();
+	assert_equal_int(i.parse_input_file("scratch.tf", &inputs, &sparse_inputs), VAR_DEFINED_TWICE, "test_interp_sparse_inputs");
+
+	pass("test_interp_sparse_inputs");
+
+}
+
+
 void run_interp_tests() {
 
 	cout << "\nTesting Interpreter Class... " << endl << endl;
@@ -348,6 +411,7 @@ void run_interp_tests() {
 	test_interp_parse_line();
 	test_interp_apply_binary_operation();
 	test_interp_apply_unary_operation();
+	test_interp_sparse_inputs();
 
 	cout << "\nAll Interpreter Tests Passed." << endl << endl;
 }
@@ -14,6 +14,7 @@ void test_interp_parse_input_line();
 void test_interp_parse_line();
 void test_interp_apply_binary_operation();
 void test_interp_apply_unary_operation();
+void test_interp_sparse_inputs();
 void test_interp_accumulate_outputs();
 
 void run_interp_tests();
@@ -0,0 +1,143 @@
+#include <iostream>
+#include <cmath>
+
+#include "TestLBFGS.h"
+#include "../src/LBFGS.h"
+#include "TestUtilities.h"
+
+using namespace std;
+
+
+/* The badly scaled quadratic loss 0.5 * (100 * w0^2 + 0.01 * w1^2 + (w2 - 3)^2). */
+class QuadraticLoss : public LossFunction {
+
+public:
+
+	int evaluate(const vector<double>& w, double *loss, vector<double> *gradient) {
+		*loss = 0.5 * (100 * w[0] * w[0] + 0.01 * w[1] * w[1] + (w[2] - 3) * (w[2] - 3));
+		(*gradient)[0] = 100 * w[0];
+		(*gradient)[1] = 0.01 * w[1];
+		(*gradient)[2] = w[2] - 3;
+		return 0;
+	}
+
+};
+
+
+/* The Rosenbrock function (1 - w0)^2 + 100 * (w1 - w0^2)^2, whose minimum, at (1, 1), is at the end of a long curved valley. */
+class RosenbrockLoss : public LossFunction {
+
+public:
+
+	int evaluate(const vector<double>& w, double *loss, vector<double> *gradient) {
+		double a = 1 - w[0], b = w[1] - w[0] * w[0];
+		*loss = a * a + 100 * b * b;
+		(*gradient)[0] = -2 * a - 400 * w[0] * b;
+		(*gradient)[1] = 200 * b;
+		return 0;
+	}
+
+};
+
+
+/* The loss w0 - log(w0), whose minimum is at 1, and which cannot be evaluated where w0 is not positive. */
+class LogBarrierLoss : public LossFunction {
+
+public:
+
+	int evaluate(const vector<double>& w, double *loss, vector<double> *gradient) {
+		if (w[0] <= 0) return INVALID_LINE;
+		*loss = w[0] - log(w[0]);
+		(*gradient)[0] = 1 - 1 / w[0];
+		return 0;
+	}
+
+};
+
+
+
+void test_lbfgs_quadratic() {
+
+	// gradient descent would need thousands of steps for the shallow weight; L-BFGS learns the curvature in a few
+	QuadraticLoss loss;
+	OptimizerOptions options;
+	options.gradient_precision = 1e-8;
+	vector<double> weights = {1, 1, 0};
+	int64_t num_evaluations;
+	assert_equal_int(minimize_lbfgs(&loss, options, &weights, &num_evaluations), 0, "test_lbfgs_quadratic");
+	assert_approximately_equal_double(weights[0], 0, 1e-8, "test_lbfgs_quadratic");
+	assert_approximately_equal_double(weights[1], 0, 1e-5, "test_lbfgs_quadratic");
+	assert_approximately_equal_double(weights[2], 3, 1e-7, "test_lbfgs_quadratic");
+	assert_true(num_evaluations <= 40, "L-BFGS took too many evaluations", "test_lbfgs_quadratic");
+
+	// a history of one step is enough, though slower
+	options.lbfgs_history = 1;
+	weights = {1, 1, 0};
+	assert_equal_int(minimize_lbfgs(&loss, options, &weights, NULL), 0, "test_lbfgs_quadratic");
+	assert_approximately_equal_double(weights[2], 3, 1e-6, "test_lbfgs_quadratic");
+
+	// no iterations leave the weights where they were, after evaluating them once
+	options.max_iterations = 0;
+	weights = {1, 1, 0};
+	assert_equal_int(minimize_lbfgs(&loss, options, &weights, &num_evaluations), 0, "test_lbfgs_quadratic");
+	assert_equal_double(weights[0], 1, "test_lbfgs_quadratic");
+	assert_equal_int(num_evaluations, 1, "test_lbfgs_quadratic");
+
+	pass("test_lbfgs_quadratic");
+}
+
+
+void test_lbfgs_rosenbrock() {
+
+	RosenbrockLoss loss;
+	OptimizerOptions options;
+	options.gradient_precision = 1e-6;
+	options.max_iterations = 200;
+	vector<double> weights = {-1.2, 1};
+	int64_t num_evaluations;
+	assert_equal_int(minimize_lbfgs(&loss, options, &weights, &num_evaluations), 0, "test_lbfgs_rosenbrock");
+	assert_approximately_equal_double(weights[0], 1, 1e-5, "test_lbfgs_rosenbrock");
+	assert_approximately_equal_double(weights[1], 1, 1e-5, "test_lbfgs_rosenbrock");
+	assert_true(num_evaluations <= 100, "L-BFGS took too many evaluations", "test_lbfgs_rosenbrock");
+
+	pass("test_lbfgs_rosenbrock");
+}
+
+
+void test_lbfgs_errors() {
+
+	// points where the loss cannot be evaluated are too far, and the search backs off from them
+	LogBarrierLoss loss;
+	OptimizerOptions options;
+	options.gradient_precision = 1e-9;
+	vector<double> weights = {0.01};
+	assert_equal_int(minimize_lbfgs(&loss, options, &weights, NULL), 0, "test_lbfgs_errors");
+	assert_approximately_equal_double(weights[0], 1, 1e-6, "test_lbfgs_errors");
+
+	// but the loss must be defined where the search starts
+	weights = {-1};
+	assert_equal_int(minimize_lbfgs(&loss, options, &weights, NULL), INVALID_LINE, "test_lbfgs_errors");
+
+	// options out of range
+	options.wolfe_c2 = options.wolfe_c1 / 2;
+	weights = {0.5};
+	assert_equal_int(minimize_lbfgs(&loss, options, &weights, NULL), OTHER_ERROR, "test_lbfgs_errors");
+	options = OptimizerOptions();
+	options.lbfgs_history = 0;
+	assert_equal_int(minimize_lbfgs(&loss, options, &weights, NULL), OTHER_ERROR, "test_lbfgs_errors");
+
+	pass("test_lbfgs_errors");
+}
+
+
+
+void run_lbfgs_tests() {
+
+	cout << "\nTesting L-BFGS... " << endl << endl;
+
+	test_lbfgs_quadratic();
+	test_lbfgs_rosenbrock();
+	test_lbfgs_errors();
+
+	cout << "\nAll L-BFGS Tests Passed." << endl << endl;
+}
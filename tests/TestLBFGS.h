@@ -0,0 +1,18 @@
+#ifndef TEST_LBFGS_H
+#define TEST_LBFGS_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for L-BFGS. */
+
+void test_lbfgs_quadratic();
+void test_lbfgs_rosenbrock();
+void test_lbfgs_errors();
+
+void run_lbfgs_tests();
+
+
+#endif
@@ -0,0 +1,137 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "TestLexer.h"
+#include "../src/Lexer.h"
+#include "TestUtilities.h"
+
+using namespace std;
+
+
+
+void test_lex_line() {
+
+	vector<Token> tokens;
+	string line = "define z.0 = mul x.0 0.5";
+	assert_equal_int(lex_line(line, ' ', &tokens), 6, "test_lex_line");
+
+	// tokens point into the line, without copying it
+	assert_true(tokens[0].start == line.data(), "The first token should start the line", "test_lex_line");
+	assert_equal_int(tokens[1].length, 3, "test_lex_line");
+	assert_equal_string(tokens[4].str(), "x.0", "test_lex_line");
+	assert_true(tokens[3].equals("mul"), "The fourth token should be mul", "test_lex_line");
+	assert_false(tokens[3].equals("mu"), "A prefix of a token is not the token", "test_lex_line");
+
+	// runs of delimiters, and delimiters at either end, make no tokens
+	// every line is a named string, which outlives the tokens pointing into it
+	string spaced = "  declare   input x  ", empty = "", blank = "    ";
+	assert_equal_int(lex_line(spaced, ' ', &tokens), 3, "test_lex_line");
+	assert_equal_string(tokens[2].str(), "x", "test_lex_line");
+	assert_equal_int(lex_line(empty, ' ', &tokens), 0, "test_lex_line");
+	assert_equal_int(lex_line(blank, ' ', &tokens), 0, "test_lex_line");
+
+	// a one-character line is one token
+	string one_character = "x";
+	assert_equal_int(lex_line(one_character, ' ', &tokens), 1, "test_lex_line");
+
+	// the delimiter can be any character, and other whitespace is part of a token
+	string tabbed = "x.0\t-2.5";
+	assert_equal_int(lex_line(tabbed, '\t', &tokens), 2, "test_lex_line");
+	assert_equal_double(tokens[1].number, -2.5, "test_lex_line");
+	assert_equal_int(lex_line(tabbed, ' ', &tokens), 1, "test_lex_line");
+
+	assert_equal_int(lex_line(one_character, ' ', NULL), OTHER_ERROR, "test_lex_line");
+
+	pass("test_lex_line");
+}
+
+
+void test_lex_classify_token() {
+
+	vector<Token> tokens;
+	string line = "declare_vector weight w = component_wise_mul exp 3 inputs #macro";
+	assert_equal_int(lex_line(line, ' ', &tokens), 9, "test_lex_classify_token");
+
+	assert_true(tokens[0].token_class == TokenClass::KEYWORD, "declare_vector is a keyword", "test_lex_classify_token");
+	assert_true(tokens[0].instruction_type == InstructionType::DECLARE_VECTOR, "declare_vector is an instruction", "test_lex_classify_token");
+	assert_true(tokens[0].variable_type == VariableType::INVALID_VAR_TYPE, "declare_vector is not a variable type", "test_lex_classify_token");
+
+	assert_true(tokens[1].variable_type == VariableType::WEIGHT, "weight is a variable type", "test_lex_classify_token");
+	assert_true(tokens[2].token_class == TokenClass::IDENTIFIER, "w is an identifier", "test_lex_classify_token");
+	assert_true(is_valid_expanded_var_name(tokens[2]), "w is a variable name", "test_lex_classify_token");
+
+	assert_true(tokens[3].token_class == TokenClass::KEYWORD, "= is a keyword", "test_lex_classify_token");
+	assert_true(tokens[3].operation_type == OperationType::INVALID_OPERATION, "= is not an operation", "test_lex_classify_token");
+	assert_false(is_valid_expanded_var_name(tokens[3]), "= is not a variable name", "test_lex_classify_token");
+
+	assert_true(tokens[4].operation_type == OperationType::COMPONENT_WISE_MUL, "component_wise_mul is an operation", "test_lex_classify_token");
+	assert_true(tokens[5].operation_type == OperationType::EXP, "exp is an operation", "test_lex_classify_token");
+	assert_true(tokens[6].token_class == TokenClass::NUMBER, "3 is a number", "test_lex_classify_token");
+	assert_equal_double(tokens[6].number, 3, "test_lex_classify_token");
+
+	// a keyword's prefix or extension is an identifier
+	assert_true(tokens[7].token_class == TokenClass::IDENTIFIER, "inputs is an identifier", "test_lex_classify_token");
+	assert_true(tokens[8].instruction_type == InstructionType::MACRO, "#macro is an instruction", "test_lex_classify_token");
+
+	// the string classifiers use the same tables
+	assert_true(get_operation_type("ln") == OperationType::LN, "ln is an operation", "test_lex_classify_token");
+	assert_true(get_operation_type("lnx") == OperationType::INVALID_OPERATION, "lnx is not an operation", "test_lex_classify_token");
+	assert_true(get_variable_type("exp_output") == VariableType::EXP_OUTPUT, "exp_output is a variable type", "test_lex_classify_token");
+	assert_true(get_instruction_type("") == InstructionType::INVALID_INST, "The empty string is not an instruction", "test_lex_classify_token");
+	assert_true(is_keyword("="), "= is a keyword", "test_lex_classify_token");
+	assert_false(is_keyword("x.0"), "x.0 is not a keyword", "test_lex_classify_token");
+
+	pass("test_lex_classify_token");
+}
+
+
+void test_lex_parse_number() {
+
+	double value = 0;
+	string numbers[7] = {"0", "-1", "2.5", "+.5", "1e-3", "inf", "-nan"};
+	for (int i = 0; i < 7; i++) {
+		assert_true(parse_number(numbers[i].data(), numbers[i].length(), &value), "Should be a number: " + numbers[i], "test_lex_parse_number");
+		assert_true(is_constant(numbers[i]), "Should be a constant: " + numbers[i], "test_lex_parse_number");
+	}
+	assert_true(parse_number("2.5e2", 5, &value), "2.5e2 is a number", "test_lex_parse_number");
+	assert_equal_double(value, 250, "test_lex_parse_number");
+
+	// only the given characters are parsed, even if the number goes on
+	assert_true(parse_number("125", 2, &value), "12 is a number", "test_lex_parse_number");
+	assert_equal_double(value, 12, "test_lex_parse_number");
+
+	// stod refuses these, so they are not numbers
+	string non_numbers[8] = {"", "x", "x.0", "3x", "1.5.2", "-", "1e999", "input"};
+	for (int i = 0; i < 8; i++) {
+		assert_false(parse_number(non_numbers[i].data(), non_numbers[i].length(), &value), "Should not be a number: " + non_numbers[i], "test_lex_parse_number");
+		assert_false(is_constant(non_numbers[i]), "Should not be a constant: " + non_numbers[i], "test_lex_parse_number");
+	}
+
+	// very long numbers are parsed too
+	string long_number = "0." + string(100, '1');
+	assert_true(parse_number(long_number.data(), long_number.length(), &value), "A long number is a number", "test_lex_parse_number");
+
+	// ints
+	assert_true(is_int("42"), "42 is an int", "test_lex_parse_number");
+	assert_true(is_int("-7"), "-7 is an int", "test_lex_parse_number");
+	assert_false(is_int("4.2"), "4.2 is not an int", "test_lex_parse_number");
+	assert_false(is_int("x"), "x is not an int", "test_lex_parse_number");
+	assert_false(is_int(""), "The empty string is not an int", "test_lex_parse_number");
+	assert_false(is_int("99999999999"), "99999999999 does not fit in an int", "test_lex_parse_number");
+
+	pass("test_lex_parse_number");
+}
+
+
+
+void run_lex_tests() {
+
+	cout << "\nTesting Lexer... " << endl << endl;
+
+	test_lex_line();
+	test_lex_classify_token();
+	test_lex_parse_number();
+
+	cout << "\nAll Lexer Tests Passed." << endl << endl;
+}
@@ -0,0 +1,18 @@
+#ifndef TEST_LEXER_H
+#define TEST_LEXER_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for the Lexer. */
+
+void test_lex_line();
+void test_lex_classify_token();
+void test_lex_parse_number();
+
+void run_lex_tests();
+
+
+#endif
@@ -0,0 +1,162 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "TestLineReader.h"
+#include "../src/LineReader.h"
+#include "TestUtilities.h"
+
+using namespace std;
+
+
+/* Writes CONTENTS to the scratch file, and returns every line a LineReader reads from it. */
+static vector<string> read_scratch_lines(const string& contents, bool *mapped) {
+	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << contents;
+	write_scratch_file.close();
+
+	vector<string> lines;
+	LineReader reader;
+	if (reader.open("scratch.tf") != 0) return lines;
+	*mapped = reader.is_mapped();
+
+	string line;
+	while (reader.next_line(&line)) lines.push_back(line);
+	return lines;
+}
+
+
+/* Returns every line a loop of getline calls until eof reads from CONTENTS, as every phase used to read. */
+static vector<string> getline_lines(const string& contents) {
+	istringstream in(contents);
+	vector<string> lines;
+	string line;
+	while (!in.eof()) {
+		getline(in, line);
+		lines.push_back(line);
+	}
+	return lines;
+}
+
+
+
+void test_lr_mapped_file() {
+
+	const char *contents[] = {"declare input x\ndefine y = add x x\n", "declare input x\ndefine y = add x x", "", "\n", "x\n\n\ny"};
+	for (size_t c = 0; c < 5; c++) {
+		bool mapped = false;
+		vector<string> lines = read_scratch_lines(contents[c], &mapped);
+		vector<string> expected = getline_lines(contents[c]);
+
+		// regular files are mapped, and split into the same lines getline reads
+		assert_true(mapped, "A regular file should be mapped", "test_lr_mapped_file");
+		assert_equal_int(lines.size(), expected.size(), "test_lr_mapped_file");
+		for (size_t l = 0; l < lines.size(); l++) assert_equal_string(lines[l], expected[l], "test_lr_mapped_file");
+	}
+
+	// lines point into the mapping, and are not copied
+	bool mapped;
+	read_scratch_lines("abc\ndef", &mapped);
+	LineReader reader;
+	assert_equal_int(reader.open("scratch.tf"), 0, "test_lr_mapped_file");
+	const char *first, *second;
+	size_t first_length, second_length;
+	assert_true(reader.next_line(&first, &first_length), "There should be a first line", "test_lr_mapped_file");
+	assert_true(reader.next_line(&second, &second_length), "There should be a second line", "test_lr_mapped_file");
+	assert_true(second == first + 4, "Lines should be read from the mapping", "test_lr_mapped_file");
+	assert_equal_string(string(second, second_length), "def", "test_lr_mapped_file");
+	assert_false(reader.next_line(&first, &first_length), "There should be no third line", "test_lr_mapped_file");
+
+	// a closed reader has nothing left to read
+	reader.close();
+	assert_false(reader.next_line(&first, &first_length), "A closed reader reads nothing", "test_lr_mapped_file");
+
+	pass("test_lr_mapped_file");
+}
+
+
+void test_lr_stream() {
+
+	const char *contents[] = {"declare input x\ndefine y = add x x\n", "declare input x", ""};
+	for (size_t c = 0; c < 3; c++) {
+		istringstream in(contents[c]);
+		LineReader reader(in);
+		assert_false(reader.is_mapped(), "A stream is not mapped", "test_lr_stream");
+
+		vector<string> lines;
+		string line;
+		while (reader.next_line(&line)) lines.push_back(line);
+
+		vector<string> expected = getline_lines(contents[c]);
+		assert_equal_int(lines.size(), expected.size(), "test_lr_stream");
+		for (size_t l = 0; l < lines.size(); l++) assert_equal_string(lines[l], expected[l], "test_lr_stream");
+	}
+
+	// files that cannot be mapped, like devices and pipes, are streamed
+	LineReader reader;
+	assert_equal_int(reader.open("/dev/null"), 0, "test_lr_stream");
+	assert_false(reader.is_mapped(), "A device should not be mapped", "test_lr_stream");
+	string line = "x";
+	assert_true(reader.next_line(&line), "An empty device has one empty line", "test_lr_stream");
+	assert_equal_string(line, "", "test_lr_stream");
+	assert_false(reader.next_line(&line), "An empty device has only one line", "test_lr_stream");
+
+	// a named pipe is read from the descriptor it was opened with, so a writer that finishes at once loses nothing
+	const char *piped = "declare input x\ndefine y = add x x\n";
+	remove("scratch.fifo");
+	assert_equal_int(mkfifo("scratch.fifo", 0600), 0, "test_lr_stream");
+	pid_t writer = fork();
+	if (writer == 0) {
+		int fd = open("scratch.fifo", O_WRONLY);
+		ssize_t written = fd < 0 ? -1 : write(fd, piped, strlen(piped));
+		_exit(written == (ssize_t) strlen(piped) ? 0 : 1);
+	}
+	assert_equal_int(reader.open("scratch.fifo"), 0, "test_lr_stream");
+	assert_false(reader.is_mapped(), "A named pipe should not be mapped", "test_lr_stream");
+	vector<string> piped_lines;
+	while (reader.next_line(&line)) piped_lines.push_back(line);
+	reader.close();
+	int status;
+	assert_equal_int(waitpid(writer, &status, 0), writer, "test_lr_stream");
+	assert_true(WIFEXITED(status) && WEXITSTATUS(status) == 0, "The writer should write the whole program", "test_lr_stream");
+	vector<string> expected = getline_lines(piped);
+	assert_equal_int(piped_lines.size(), expected.size(), "test_lr_stream");
+	for (size_t l = 0; l < piped_lines.size(); l++) assert_equal_string(piped_lines[l], expected[l], "test_lr_stream");
+	remove("scratch.fifo");
+
+	pass("test_lr_stream");
+}
+
+
+void test_lr_invalid_file() {
+
+	LineReader reader;
+	assert_equal_int(reader.open("tests/test_files/no_such_file.tf"), INVALID_FILE_NAME, "test_lr_invalid_file");
+	assert_equal_int(reader.open("tests/test_files"), INVALID_FILE_NAME, "test_lr_invalid_file");
+	assert_equal_int(reader.open(""), INVALID_FILE_NAME, "test_lr_invalid_file");
+
+	string line;
+	assert_false(reader.next_line(&line), "A reader that failed to open reads nothing", "test_lr_invalid_file");
+
+	pass("test_lr_invalid_file");
+}
+
+
+
+void run_lr_tests() {
+
+	cout << "\nTesting LineReader... " << endl << endl;
+
+	test_lr_mapped_file();
+	test_lr_stream();
+	test_lr_invalid_file();
+
+	cout << "\nAll LineReader Tests Passed." << endl << endl;
+}
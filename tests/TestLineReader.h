@@ -0,0 +1,18 @@
+#ifndef TEST_LINE_READER_H
+#define TEST_LINE_READER_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for the LineReader. */
+
+void test_lr_mapped_file();
+void test_lr_stream();
+void test_lr_invalid_file();
+
+void run_lr_tests();
+
+
+#endif
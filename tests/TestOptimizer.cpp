@@ -0,0 +1,245 @@
+#include <iostream>
+#include <cmath>
+
+#include "TestOptimizer.h"
+#include "../src/Optimizer.h"
+#include "TestUtilities.h"
+
+using namespace std;
+
+
+/* Runs OPTIMIZER on the badly scaled quadratic loss 0.5 * (100 * w0^2 + 0.01 * w1^2), starting from w0 = w1 = 1,
+ *  for NUM_STEPS steps, and returns the loss it reaches.
+ */
+static double minimize_badly_scaled(Optimizer *optimizer, int num_steps) {
+	vector<double> weights = {1, 1}, gradient(2);
+	for (int i = 0; i < num_steps; i++) {
+		gradient[0] = 100 * weights[0];
+		gradient[1] = 0.01 * weights[1];
+		optimizer->step(gradient, &weights);
+	}
+	return 0.5 * (100 * weights[0] * weights[0] + 0.01 * weights[1] * weights[1]);
+}
+
+
+
+void test_opt_options() {
+
+	OptimizerType type;
+	assert_true(parse_optimizer_type("adam", &type) && type == OptimizerType::ADAM, "adam was not parsed", "test_opt_options");
+	assert_true(parse_optimizer_type("nesterov", &type) && type == OptimizerType::NESTEROV, "nesterov was not parsed", "test_opt_options");
+	assert_true(parse_optimizer_type("gd", &type) && type == OptimizerType::GRADIENT_DESCENT, "gd was not parsed", "test_opt_options");
+	assert_false(parse_optimizer_type("Adam", &type), "Adam is not an optimizer", "test_opt_options");
+
+	// the defaults are in range, and every type of Optimizer can be created
+	OptimizerOptions options;
+	assert_equal_int(check_optimizer_options(options), 0, "test_opt_options");
+	for (OptimizerType t : {OptimizerType::GRADIENT_DESCENT, OptimizerType::MOMENTUM, OptimizerType::NESTEROV,
+		OptimizerType::ADAGRAD, OptimizerType::RMSPROP, OptimizerType::ADAM}) {
+		options.type = t;
+		Optimizer *optimizer = create_optimizer(3, options);
+		assert_true(optimizer != NULL, "an optimizer was not created", "test_opt_options");
+		assert_equal_int(optimizer->get_num_steps(), 0, "test_opt_options");
+		delete optimizer;
+	}
+
+	// hyperparameters out of range
+	OptimizerOptions bad;
+	bad.learning_rate = 0;
+	assert_equal_int(check_optimizer_options(bad), OTHER_ERROR, "test_opt_options");
+	assert_true(create_optimizer(3, bad) == NULL, "an optimizer was created with a learning rate of 0", "test_opt_options");
+	bad = OptimizerOptions();
+	bad.momentum = 1;
+	assert_equal_int(check_optimizer_options(bad), OTHER_ERROR, "test_opt_options");
+	bad = OptimizerOptions();
+	bad.beta2 = -0.5;
+	assert_equal_int(check_optimizer_options(bad), OTHER_ERROR, "test_opt_options");
+	bad = OptimizerOptions();
+	bad.epsilon = 0;
+	assert_equal_int(check_optimizer_options(bad), OTHER_ERROR, "test_opt_options");
+	bad = OptimizerOptions();
+	bad.max_iterations = -1;
+	assert_equal_int(check_optimizer_options(bad), OTHER_ERROR, "test_opt_options");
+
+	pass("test_opt_options");
+}
+
+
+void test_opt_gradient_descent() {
+
+	OptimizerOptions options;
+	options.learning_rate = 0.5;
+	Optimizer *optimizer = create_optimizer(2, options);
+
+	vector<double> weights = {1, -2};
+	assert_equal_int(optimizer->step({2, 4}, &weights), 0, "test_opt_gradient_descent");
+	assert_equal_double(weights[0], 0, "test_opt_gradient_descent");
+	assert_equal_double(weights[1], -4, "test_opt_gradient_descent");
+	assert_equal_int(optimizer->get_num_steps(), 1, "test_opt_gradient_descent");
+
+	// the gradient and the weights must have a value for every weight
+	assert_equal_int(optimizer->step({2}, &weights), OTHER_ERROR, "test_opt_gradient_descent");
+	vector<double> too_many = {1, 2, 3};
+	assert_equal_int(optimizer->step({2, 4}, &too_many), OTHER_ERROR, "test_opt_gradient_descent");
+	assert_equal_int(optimizer->get_num_steps(), 1, "test_opt_gradient_descent");
+
+	delete optimizer;
+	pass("test_opt_gradient_descent");
+}
+
+
+void test_opt_momentum() {
+
+	OptimizerOptions options;
+	options.type = OptimizerType::MOMENTUM;
+	options.learning_rate = 0.1;
+	options.momentum = 0.5;
+	Optimizer *momentum = create_optimizer(1, options);
+
+	// velocity = -0.1, then 0.5 * -0.1 - 0.1 = -0.15
+	vector<double> weights = {1};
+	momentum->step({1}, &weights);
+	assert_approximately_equal_double(weights[0], 0.9, 1e-12, "test_opt_momentum");
+	momentum->step({1}, &weights);
+	assert_approximately_equal_double(weights[0], 0.75, 1e-12, "test_opt_momentum");
+
+	// a zero gradient keeps moving the weights, until the momentum is forgotten
+	momentum->step({0}, &weights);
+	assert_approximately_equal_double(weights[0], 0.675, 1e-12, "test_opt_momentum");
+	momentum->reset();
+	assert_equal_int(momentum->get_num_steps(), 0, "test_opt_momentum");
+	momentum->step({0}, &weights);
+	assert_approximately_equal_double(weights[0], 0.675, 1e-12, "test_opt_momentum");
+	delete momentum;
+
+	// Nesterov: velocity = -0.1, weights += 1.5 * -0.1; then velocity = -0.15, weights += 1.5 * -0.15 - 0.5 * -0.1
+	options.type = OptimizerType::NESTEROV;
+	Optimizer *nesterov = create_optimizer(1, options);
+	weights = {1};
+	nesterov->step({1}, &weights);
+	assert_approximately_equal_double(weights[0], 0.85, 1e-12, "test_opt_momentum");
+	nesterov->step({1}, &weights);
+	assert_approximately_equal_double(weights[0], 0.675, 1e-12, "test_opt_momentum");
+	delete nesterov;
+
+	pass("test_opt_momentum");
+}
+
+
+void test_opt_adaptive() {
+
+	OptimizerOptions options;
+	options.learning_rate = 0.1;
+	options.epsilon = 1e-8;
+
+	// Adagrad divides every step by the root of the sum of squared partials, so each weight's first step is the learning rate
+	options.type = OptimizerType::ADAGRAD;
+	Optimizer *adagrad = create_optimizer(2, options);
+	vector<double> weights = {0, 0};
+	adagrad->step({100, 0.001}, &weights);
+	assert_approximately_equal_double(weights[0], -0.1, 1e-6, "test_opt_adaptive");
+	assert_approximately_equal_double(weights[1], -0.1, 1e-4, "test_opt_adaptive");
+	adagrad->step({100, 0}, &weights);
+	assert_approximately_equal_double(weights[0], -0.1 - 0.1 / sqrt(2), 1e-6, "test_opt_adaptive");
+	assert_approximately_equal_double(weights[1], -0.1, 1e-4, "test_opt_adaptive");
+	delete adagrad;
+
+	// RMSProp: mean_square = 0.1 * 4 = 0.4 after the first step
+	options.type = OptimizerType::RMSPROP;
+	options.decay = 0.9;
+	Optimizer *rmsprop = create_optimizer(1, options);
+	weights = {0};
+	rmsprop->step({2}, &weights);
+	assert_approximately_equal_double(weights[0], -0.1 * 2 / sqrt(0.4), 1e-6, "test_opt_adaptive");
+	delete rmsprop;
+
+	// Adam's bias correction makes its first step the learning rate, whatever the size of the partial
+	options.type = OptimizerType::ADAM;
+	Optimizer *adam = create_optimizer(2, options);
+	weights = {0, 0};
+	adam->step({1000, -0.01}, &weights);
+	assert_approximately_equal_double(weights[0], -0.1, 1e-6, "test_opt_adaptive");
+	assert_approximately_equal_double(weights[1], 0.1, 1e-4, "test_opt_adaptive");
+
+	// mean = 0.09 * 1000 + 0.1 * 1000 / (1 - 0.81), mean_square = 1000^2 (after correction), so the second step is the learning rate again
+	adam->step({1000, -0.01}, &weights);
+	assert_approximately_equal_double(weights[0], -0.2, 1e-6, "test_opt_adaptive");
+	assert_equal_int(adam->get_num_steps(), 2, "test_opt_adaptive");
+	delete adam;
+
+	pass("test_opt_adaptive");
+}
+
+
+void test_opt_badly_scaled() {
+
+	// the learning rate of gradient descent is limited by the steep weight, so the shallow weight barely moves
+	OptimizerOptions options;
+	options.learning_rate = 0.01;
+	Optimizer *gd = create_optimizer(2, options);
+	double gd_loss = minimize_badly_scaled(gd, 500);
+	delete gd;
+
+	// Adagrad and Adam scale each weight's steps by its own partials, so both weights converge
+	for (OptimizerType t : {OptimizerType::ADAGRAD, OptimizerType::ADAM}) {
+		options.type = t;
+		options.learning_rate = t == OptimizerType::ADAGRAD ? 0.5 : 0.05;
+		Optimizer *adaptive = create_optimizer(2, options);
+		double loss = minimize_badly_scaled(adaptive, 500);
+		assert_true(loss < gd_loss / 100, "an adaptive optimizer did not beat gradient descent", "test_opt_badly_scaled");
+		delete adaptive;
+	}
+
+	pass("test_opt_badly_scaled");
+}
+
+
+
+void test_opt_restore_state() {
+
+	// an Optimizer restored from the state of another, after 200 steps, takes the same next 300 steps
+	OptimizerOptions options;
+	options.learning_rate = 0.05;
+	for (OptimizerType t : {OptimizerType::GRADIENT_DESCENT, OptimizerType::NESTEROV, OptimizerType::RMSPROP, OptimizerType::ADAM}) {
+		options.type = t;
+		Optimizer *original = create_optimizer(2, options);
+		minimize_badly_scaled(original, 200);
+
+		Optimizer *restored = create_optimizer(2, options);
+		vector<vector<double> > state_arrays;
+		for (size_t i = 0; i < original->get_num_state_arrays(); i++) state_arrays.push_back(original->get_state_array(i));
+		assert_equal_int(restored->restore_state(original->get_num_steps(), state_arrays), 0, "test_opt_restore_state");
+		assert_equal_int(restored->get_num_steps(), 200, "test_opt_restore_state");
+		assert_equal_double(minimize_badly_scaled(restored, 300), minimize_badly_scaled(original, 300), "test_opt_restore_state");
+
+		// the state must fit the Optimizer
+		state_arrays.push_back(vector<double>(2, 0));
+		assert_equal_int(restored->restore_state(0, state_arrays), OTHER_ERROR, "test_opt_restore_state");
+		delete original;
+		delete restored;
+	}
+
+	options.type = OptimizerType::ADAM;
+	Optimizer *adam = create_optimizer(3, options);
+	assert_equal_int(adam->get_num_state_arrays(), 2, "test_opt_restore_state");
+	assert_equal_int(adam->restore_state(5, {vector<double>(3, 0), vector<double>(2, 0)}), OTHER_ERROR, "test_opt_restore_state");
+	delete adam;
+
+	pass("test_opt_restore_state");
+}
+
+
+
+void run_opt_tests() {
+
+	cout << "\nTesting Optimizers... " << endl << endl;
+
+	test_opt_options();
+	test_opt_gradient_descent();
+	test_opt_momentum();
+	test_opt_adaptive();
+	test_opt_badly_scaled();
+	test_opt_restore_state();
+
+	cout << "\nAll Optimizer Tests Passed." << endl << endl;
+}
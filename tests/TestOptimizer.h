@@ -0,0 +1,21 @@
+#ifndef TEST_OPTIMIZER_H
+#define TEST_OPTIMIZER_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for the Optimizers. */
+
+void test_opt_options();
+void test_opt_gradient_descent();
+void test_opt_momentum();
+void test_opt_adaptive();
+void test_opt_badly_scaled();
+void test_opt_restore_state();
+
+void run_opt_tests();
+
+
+#endif
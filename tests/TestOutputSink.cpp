@@ -0,0 +1,132 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "TestOutputSink.h"
+#include "../src/OutputSink.h"
+#include "../src/Preprocessor.h"
+#include "TestUtilities.h"
+
+using namespace std;
+
+
+/* Returns the contents of the file with the given FILENAME. */
+static string read_file(const string& filename) {
+	ifstream file(filename);
+	stringstream contents;
+	contents << file.rdbuf();
+	return contents.str();
+}
+
+
+/* Writes NUM_LINES numbered definitions to OUT, as an emitter would, and returns what was written. */
+static string write_lines(ostream& out, int num_lines) {
+	stringstream expected;
+	for (int i = 0; i < num_lines; i++) {
+		out << "define z." << i << " = mul x." << i << " " << 0.5 * i << '\n';
+		expected << "define z." << i << " = mul x." << i << " " << 0.5 * i << '\n';
+	}
+	return expected.str();
+}
+
+
+
+void test_sink_write() {
+
+	// a 64 byte buffer is written whenever it fills, and once more when the sink is closed
+	OutputSink sink(64);
+	assert_false(sink.is_open(), "A new sink has no file", "test_sink_write");
+	assert_equal_int(sink.open("scratch.tf"), 0, "test_sink_write");
+	assert_true(sink.is_open(), "The sink should have a file", "test_sink_write");
+
+	ostream out(&sink);
+	string expected = write_lines(out, 100);
+	assert_equal_int(sink.close(), 0, "test_sink_write");
+	assert_equal_string(read_file("scratch.tf"), expected, "test_sink_write");
+	assert_equal_int(sink.get_num_bytes_written(), expected.length(), "test_sink_write");
+	assert_equal_int(sink.get_num_writes(), (expected.length() + 63) / 64, "test_sink_write");
+
+	// nothing is written until the buffer fills, unless the stream is flushed
+	OutputSink large_sink;
+	large_sink.open("scratch.tf");
+	ostream large_out(&large_sink);
+	large_out << "declare input x" << '\n';
+	assert_equal_int(large_sink.get_num_writes(), 0, "test_sink_write");
+	assert_equal_string(read_file("scratch.tf"), "", "test_sink_write");
+	large_out.flush();
+	assert_equal_int(large_sink.get_num_writes(), 1, "test_sink_write");
+	assert_equal_string(read_file("scratch.tf"), "declare input x\n", "test_sink_write");
+
+	// writes larger than the buffer are split across as many buffers as they fill
+	string long_line(1000, 'x');
+	OutputSink small_sink(7);
+	small_sink.open("scratch.tf");
+	ostream small_out(&small_sink);
+	small_out << long_line;
+	small_sink.close();
+	assert_equal_string(read_file("scratch.tf"), long_line, "test_sink_write");
+	assert_equal_int(small_sink.get_num_writes(), (1000 + 6) / 7, "test_sink_write");
+
+	pass("test_sink_write");
+}
+
+
+void test_sink_background_writer() {
+
+	// the writer thread writes every buffer, in order
+	OutputSink sink(100, true);
+	assert_equal_int(sink.open("scratch.tf"), 0, "test_sink_background_writer");
+	ostream out(&sink);
+	string expected = write_lines(out, 5000);
+	assert_equal_int(sink.close(), 0, "test_sink_background_writer");
+	assert_equal_string(read_file("scratch.tf"), expected, "test_sink_background_writer");
+	assert_equal_int(sink.get_num_bytes_written(), expected.length(), "test_sink_background_writer");
+
+	// a sink can be reopened, and restarts its writer
+	assert_equal_int(sink.open("scratch.tf"), 0, "test_sink_background_writer");
+	out << "declare input x" << '\n';
+	out.flush();
+	assert_equal_string(read_file("scratch.tf"), "declare input x\n", "test_sink_background_writer");
+	assert_equal_int(sink.close(), 0, "test_sink_background_writer");
+
+	// the Preprocessor writes the same Expanded Program with and without a background writer
+	Preprocessor p;
+	assert_equal_int(p.expand_program("tests/test_files/inputs/shape_simple.tf", "scratch.tf"), 0, "test_sink_background_writer");
+	string expanded = read_file("scratch.tf");
+	Preprocessor background_p;
+	background_p.set_background_writer(true);
+	assert_equal_int(background_p.expand_program("tests/test_files/inputs/shape_simple.tf", "scratch.tf"), 0, "test_sink_background_writer");
+	assert_equal_string(read_file("scratch.tf"), expanded, "test_sink_background_writer");
+
+	pass("test_sink_background_writer");
+}
+
+
+void test_sink_invalid_file() {
+
+	OutputSink sink;
+	assert_equal_int(sink.open("tests/test_files"), INVALID_FILE_NAME, "test_sink_invalid_file");
+	assert_equal_int(sink.open("tests/no_such_directory/scratch.tf"), INVALID_FILE_NAME, "test_sink_invalid_file");
+	assert_false(sink.is_open(), "The sink should have no file", "test_sink_invalid_file");
+	assert_equal_int(sink.attach(-1), INVALID_FILE_NAME, "test_sink_invalid_file");
+
+	// a program cannot be expanded into a file that cannot be written
+	Preprocessor p;
+	assert_equal_int(p.expand_program("tests/test_files/inputs/shape_simple.tf", "tests/no_such_directory/scratch.tf"), OTHER_ERROR, "test_sink_invalid_file");
+
+	pass("test_sink_invalid_file");
+}
+
+
+
+void run_sink_tests() {
+
+	cout << "\nTesting OutputSink... " << endl << endl;
+
+	test_sink_write();
+	test_sink_background_writer();
+	test_sink_invalid_file();
+
+	cout << "\nAll OutputSink Tests Passed." << endl << endl;
+}
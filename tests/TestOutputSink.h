@@ -0,0 +1,18 @@
+#ifndef TEST_OUTPUT_SINK_H
+#define TEST_OUTPUT_SINK_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for the OutputSink. */
+
+void test_sink_write();
+void test_sink_background_writer();
+void test_sink_invalid_file();
+
+void run_sink_tests();
+
+
+#endif
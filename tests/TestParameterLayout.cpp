@@ -0,0 +1,114 @@
+#include <iostream>
+#include <sstream>
+
+#include "TestParameterLayout.h"
+#include "../src/ParameterLayout.h"
+#include "../src/GradientDescent.h"
+#include "TestUtilities.h"
+
+using namespace std;
+
+
+
+void test_layout_build() {
+
+	Program gcp;
+	assert_equal_int(gcp.load("tests/test_files/inputs/small_net_gcp.tf"), 0, "test_layout_build");
+
+	// the partials may come in any order: each gets the index of its weight
+	ParameterLayout layout;
+	vector<string> weight_names = {"f", "g", "h"};
+	assert_equal_int(layout.build(gcp, weight_names, {"d/LAMBDA/d/h", "d/LAMBDA/d/f", "d/LAMBDA/d/g"}), 0, "test_layout_build");
+	assert_equal_int(layout.size(), 3, "test_layout_build");
+	assert_equal_string(layout.get_weight_names()[1], "g", "test_layout_build");
+
+	vector<double> gradient = {0.5, 0, -2};
+	VariableVector named_gradient;
+	layout.scatter_gradient(gradient, &named_gradient);
+	assert_equal_int(named_gradient.size(), 2, "test_layout_build");
+	assert_equal_double(named_gradient.at("d/LAMBDA/d/f"), 0.5, "test_layout_build");
+	assert_equal_double(named_gradient.at("d/LAMBDA/d/h"), -2, "test_layout_build");
+
+	// a weight may have no partial, but every partial needs a weight of its own
+	assert_equal_int(layout.build(gcp, weight_names, {"d/LAMBDA/d/f"}), 0, "test_layout_build");
+	assert_equal_int(layout.build(gcp, weight_names, {"d/LAMBDA/d/f", "d/LAMBDA/d/x"}), OTHER_ERROR, "test_layout_build");
+	assert_equal_int(layout.build(gcp, weight_names, {"d/LAMBDA/d/f", "d/L/d/f"}), OTHER_ERROR, "test_layout_build");
+	assert_equal_int(layout.build(gcp, weight_names, {"f"}), OTHER_ERROR, "test_layout_build");
+	assert_equal_int(layout.build(gcp, {"f", "g", "f"}, {}), OTHER_ERROR, "test_layout_build");
+
+	pass("test_layout_build");
+}
+
+
+void test_layout_values() {
+
+	Program gcp;
+	assert_equal_int(gcp.load("tests/test_files/inputs/small_net_gcp.tf"), 0, "test_layout_values");
+	vector<string> weight_names = {"f", "g", "h"};
+	vector<string> partial_names = {"d/LAMBDA/d/f", "d/LAMBDA/d/g", "d/LAMBDA/d/h"};
+	ParameterLayout layout;
+	assert_equal_int(layout.build(gcp, weight_names, partial_names), 0, "test_layout_values");
+
+	VariableVector named_weights = {{"f", 0.3}, {"g", -0.1}, {"h", 0.2}};
+	vector<double> weights;
+	assert_equal_int(layout.gather_weights(named_weights, &weights), 0, "test_layout_values");
+	assert_equal_double(weights[2], 0.2, "test_layout_values");
+	assert_equal_int(layout.gather_weights({{"f", 0.3}}, &weights), OTHER_ERROR, "test_layout_values");
+	layout.gather_weights(named_weights, &weights);
+
+	// binding by slot and gathering the partials by slot give the partials of a run by name
+	VariableVector inputs = {{"a", 1}, {"b", 2}, {"c", 3}};
+	VariableVector outputs = {{"m", 0.6}, {"n", 0.5}, {"p", 0.55}};
+	vector<double> weight_values, values;
+	gcp.init_values(&weight_values);
+	assert_equal_int(layout.bind_weights(weights, &weight_values), 0, "test_layout_values");
+	VariableVector partials;
+	assert_equal_int(find_sparse_partials(gcp, &partials, weight_values, inputs, SparseVariableVector(), outputs, &values), 0, "test_layout_values");
+
+	vector<double> gradient(3, 1);
+	layout.add_partials(values, gradient.data());
+	assert_false(layout.has_other_outputs(values), "every output is a partial", "test_layout_values");
+	for (size_t i = 0; i < partial_names.size(); i++) {
+		assert_equal_double(gradient[i], 1 + partials.at(partial_names[i]), "test_layout_values");
+	}
+
+	VariableVector scattered;
+	layout.scatter_weights(weights, &scattered);
+	assert_equal_int(scattered.size(), 3, "test_layout_values");
+	assert_equal_double(scattered.at("g"), -0.1, "test_layout_values");
+
+	// an output that is not a partial is found, by slot
+	stringstream program;
+	program << "declare input x\ndeclare input w\ndeclare output d/L/d/w\ndeclare output y\n";
+	program << "define d/L/d/w = mul x w\ndefine y = mul x 2\n";
+	Program other;
+	assert_equal_int(other.load(program), 0, "test_layout_values");
+	assert_equal_int(layout.build(other, {"w"}, {"d/L/d/w"}), 0, "test_layout_values");
+	other.init_values(&values);
+	assert_equal_int(layout.bind_weights({3}, &values), 0, "test_layout_values");
+	assert_equal_int(other.bind_values({{"x", 0}}, &values), 0, "test_layout_values");
+	assert_equal_int(other.run(&values), 0, "test_layout_values");
+	assert_false(layout.has_other_outputs(values), "y is 0", "test_layout_values");
+	other.init_values(&values);
+	layout.bind_weights({3}, &values);
+	other.bind_values({{"x", 2}}, &values);
+	assert_equal_int(other.run(&values), 0, "test_layout_values");
+	assert_true(layout.has_other_outputs(values), "y is not 0", "test_layout_values");
+	gradient.assign(1, 0);
+	layout.add_partials(values, gradient.data());
+	assert_equal_double(gradient[0], 6, "test_layout_values");
+
+	pass("test_layout_values");
+}
+
+
+
+void run_layout_tests() {
+
+	cout << "\nTesting Parameter Layouts... " << endl << endl;
+
+	test_layout_build();
+	test_layout_values();
+
+	cout << "\nAll Parameter Layout Tests Passed." << endl << endl;
+}
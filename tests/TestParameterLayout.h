@@ -0,0 +1,17 @@
+#ifndef TEST_PARAMETER_LAYOUT_H
+#define TEST_PARAMETER_LAYOUT_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for the ParameterLayout. */
+
+void test_layout_build();
+void test_layout_values();
+
+void run_layout_tests();
+
+
+#endif
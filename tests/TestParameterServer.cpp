@@ -0,0 +1,165 @@
+#include <iostream>
+#include <algorithm>
+#include <csignal>
+#include <cstdint>
+
+#include "TestParameterServer.h"
+#include "../src/ParameterServer.h"
+#include "TestUtilities.h"
+
+using namespace std;
+
+
+/* Minimizes the sum of (w - TARGET)^2 / 2 over the weights of WEIGHT_INDICES (or of every weight, if it is empty),
+ *  pushing NUM_STEPS gradients, or until the server stops.
+ * If STALENESS_BOUND is 0, fails if the server ever answers before every other worker has caught up.
+ * Worker FAILING_RANK fails with BAD_VAR_TYPE after 2 pushes, or kills itself, if KILL is true.
+ */
+class QuadraticWorker : public ParameterWorker {
+
+public:
+
+	double target = 1;
+	vector<size_t> weight_indices;
+	int64_t num_steps = 30;
+	int64_t staleness_bound = -1;
+	size_t failing_rank = SIZE_MAX;
+	bool kill = false;
+
+	int run(ParameterClient *client) {
+		vector<double> weights, gradient;
+		int64_t version;
+		int success = client->pull(&weights, &version);
+
+		for (int64_t step = 0; step < num_steps && success == 0 && !client->is_stopped(); step++) {
+			if (client->get_rank() == failing_rank && step == 2) {
+				if (kill) raise(SIGKILL);
+				return BAD_VAR_TYPE;
+			}
+
+			gradient.assign(weights.size(), 0);
+			for (size_t i = 0; i < weights.size(); i++) {
+				if (weight_indices.empty() || find(weight_indices.begin(), weight_indices.end(), i) != weight_indices.end()) {
+					gradient[i] = weights[i] - target;
+				}
+			}
+			success = client->push(gradient, version, &weights, &version);
+
+			// in lock step, every worker has pushed as many gradients as this one before it gets the weights
+			if (success == 0 && !client->is_stopped() && staleness_bound == 0 && version < (step + 1) * (int64_t) client->get_size()) {
+				return OTHER_ERROR;
+			}
+		}
+		return success;
+	}
+
+};
+
+
+
+void test_ps_updates() {
+
+	// three workers move every weight to the target, with dense pushes
+	QuadraticWorker worker;
+	OptimizerOptions options;
+	options.learning_rate = 0.3;
+	vector<double> weights;
+	ParameterServerStats stats;
+	assert_equal_int(run_parameter_server(3, vector<double>(4, 0), options, 0, -1, &worker, &weights, &stats), 0, "test_ps_updates");
+	assert_equal_int(weights.size(), 4, "test_ps_updates");
+	assert_approximately_equal_double(weights[0], 1, 1e-6, "test_ps_updates");
+	assert_approximately_equal_double(weights[3], 1, 1e-6, "test_ps_updates");
+	assert_equal_int(stats.num_updates, 90, "test_ps_updates");
+	assert_equal_int(stats.num_dense_pushes, 90, "test_ps_updates");
+	assert_true(stats.max_staleness <= stats.num_updates, "the staleness is out of range", "test_ps_updates");
+
+	// gradients with few partials are pushed sparsely, and only move their weights
+	worker.weight_indices = {2, 7};
+	assert_equal_int(run_parameter_server(3, vector<double>(10, 0), options, 0, -1, &worker, &weights, &stats), 0, "test_ps_updates");
+	assert_equal_int(stats.num_sparse_pushes, 90, "test_ps_updates");
+	assert_approximately_equal_double(weights[7], 1, 1e-6, "test_ps_updates");
+	assert_equal_double(weights[6], 0, "test_ps_updates");
+
+	// the other Optimizers take sparse pushes as dense gradients: one worker takes the steps the Optimizer takes by itself
+	options.type = OptimizerType::MOMENTUM;
+	options.learning_rate = 0.1;
+	worker.num_steps = 5;
+	assert_equal_int(run_parameter_server(1, vector<double>(10, 0), options, 0, -1, &worker, &weights, &stats), 0, "test_ps_updates");
+	Optimizer *momentum = create_optimizer(10, options);
+	vector<double> expected(10, 0), gradient(10, 0);
+	for (int step = 0; step < 5; step++) {
+		gradient[2] = expected[2] - 1;
+		gradient[7] = expected[7] - 1;
+		momentum->step(gradient, &expected);
+	}
+	delete momentum;
+	assert_equal_double(weights[2], expected[2], "test_ps_updates");
+	assert_equal_double(weights[7], expected[7], "test_ps_updates");
+	assert_equal_double(weights[0], 0, "test_ps_updates");
+
+	// the server takes at most as many updates as it is given
+	worker.num_steps = 100;
+	assert_equal_int(run_parameter_server(3, vector<double>(10, 0), options, 12, -1, &worker, &weights, &stats), 0, "test_ps_updates");
+	assert_equal_int(stats.num_updates, 12, "test_ps_updates");
+
+	pass("test_ps_updates");
+}
+
+
+void test_ps_staleness_bound() {
+
+	// in lock step, no worker gets ahead (the worker checks the versions it is answered with)
+	QuadraticWorker worker;
+	worker.staleness_bound = 0;
+	OptimizerOptions options;
+	options.learning_rate = 0.3;
+	vector<double> weights;
+	ParameterServerStats stats;
+	assert_equal_int(run_parameter_server(3, vector<double>(4, 0), options, 0, 0, &worker, &weights, &stats), 0, "test_ps_staleness_bound");
+	assert_equal_int(stats.num_updates, 90, "test_ps_staleness_bound");
+	assert_true(stats.max_staleness <= 3 - 1, "a gradient is staler than lock step allows", "test_ps_staleness_bound");
+	assert_approximately_equal_double(weights[1], 1, 1e-6, "test_ps_staleness_bound");
+
+	// a worker that finishes no longer holds the others back
+	worker.num_steps = 1;
+	assert_equal_int(run_parameter_server(2, vector<double>(4, 0), options, 0, 0, &worker, &weights, &stats), 0, "test_ps_staleness_bound");
+	assert_equal_int(stats.num_updates, 2, "test_ps_staleness_bound");
+
+	pass("test_ps_staleness_bound");
+}
+
+
+void test_ps_failure() {
+
+	// the error of a worker stops the server, and the server's sockets closing stops the other workers
+	QuadraticWorker worker;
+	worker.failing_rank = 1;
+	OptimizerOptions options;
+	vector<double> weights;
+	assert_equal_int(run_parameter_server(3, vector<double>(4, 0), options, 0, 0, &worker, &weights, NULL), BAD_VAR_TYPE, "test_ps_failure");
+
+	// a worker that dies closes its socket
+	worker.kill = true;
+	assert_equal_int(run_parameter_server(3, vector<double>(4, 0), options, 0, 0, &worker, &weights, NULL), OTHER_ERROR, "test_ps_failure");
+
+	// the server needs workers, and an Optimizer that takes one step at a time
+	worker.failing_rank = SIZE_MAX;
+	assert_equal_int(run_parameter_server(0, vector<double>(4, 0), options, 0, 0, &worker, &weights, NULL), OTHER_ERROR, "test_ps_failure");
+	options.type = OptimizerType::LBFGS;
+	assert_equal_int(run_parameter_server(2, vector<double>(4, 0), options, 0, 0, &worker, &weights, NULL), OTHER_ERROR, "test_ps_failure");
+
+	pass("test_ps_failure");
+}
+
+
+
+void run_ps_tests() {
+
+	cout << "\nTesting the Parameter Server... " << endl << endl;
+
+	test_ps_updates();
+	test_ps_staleness_bound();
+	test_ps_failure();
+
+	cout << "\nAll Parameter Server Tests Passed." << endl << endl;
+}
@@ -0,0 +1,18 @@
+#ifndef TEST_PARAMETER_SERVER_H
+#define TEST_PARAMETER_SERVER_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for the parameter server of asynchronous multi-process training. */
+
+void test_ps_updates();
+void test_ps_staleness_bound();
+void test_ps_failure();
+
+void run_ps_tests();
+
+
+#endif
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 #include "TestPreprocessor.h"
 #include "../src/Preprocessor.h"
@@ -40,6 +41,8 @@ void test_pp_expand_line() {
 	// passing ofstream that isn't open
 	assert_equal_int(p.expand_line("declare input x", write_scratch_file), OTHER_ERROR, "test_pp_expand_line");
 	write_scratch_file.open("scratch.tf");
+	// emitters end lines with '\n' and never flush, so flush after every write to read the file while it is open
+	write_scratch_file << unitbuf;
 	// empty line
 	assert_equal_int(p.expand_line("", write_scratch_file), 0, "test_pp_expand_line");
 
@@ -106,6 +109,7 @@ void test_pp_expand_declare_vector() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 	assert_equal_int(p.expand_declare_vector_instruction("declare_vector input x 3", write_scratch_file), 3,
 		"test_pp_expand_declare_vector");
 	assert_equal_int(p.expand_declare_vector_instruction("declare_vector output o 5", write_scratch_file), 5,
@@ -136,6 +140,7 @@ void test_pp_expand_define() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// declare variables
 	assert_equal_int(p.expand_line("declare input x", write_scratch_file), 1, "test_pp_expand_define");
@@ -163,6 +168,7 @@ void test_pp_expand_define_vector() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// define two macros which will be used later in this test
 	p.expand_line("#macro c = my_binary_macro a b; declare intvar p; define p = pow a b; define c = ln p", write_scratch_file);
@@ -257,6 +263,7 @@ void test_pp_expand_vector_operation() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// declare vectors
 	assert_equal_int(p.expand_line("declare_vector input x 3", write_scratch_file), 3, "test_pp_expand_vector_operation");
@@ -328,6 +335,7 @@ void test_pp_expand_unary_macro() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// manually create a macro struct
 	// parsing of a #macro line will be tested in another function
@@ -365,6 +373,7 @@ void test_pp_expand_binary_macro() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// manually create a macro struct
 	// parsing of a #macro line will be tested in another function
@@ -478,6 +487,7 @@ void test_pp_expand_dot_product() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// declare vectors
 	assert_equal_int(p.expand_line("declare_vector input x 3", write_scratch_file), 3, "test_pp_expand_dot_product");
@@ -522,6 +532,7 @@ void test_pp_expand_vector_add() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// declare vectors
 	assert_equal_int(p.expand_line("declare_vector input x 3", write_scratch_file), 3, "test_pp_expand_vector_add");
@@ -554,6 +565,7 @@ void test_pp_expand_vector_mul() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// declare vectors
 	assert_equal_int(p.expand_line("declare_vector input x 3", write_scratch_file), 3, "test_pp_expand_vector_mul");
@@ -586,6 +598,7 @@ void test_pp_expand_vector_scale() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// declare vectors
 	// declare vectors
@@ -623,6 +636,7 @@ void test_pp_expand_vector_increment() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// declare vectors
 	assert_equal_int(p.expand_line("declare_vector input x 3", write_scratch_file), 3, "test_pp_expand_vector_increment");
@@ -808,6 +822,7 @@ void test_pp_is_valid_declare_line() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// simple errors
 	assert_equal_int(p.is_valid_declare_line(""), OTHER_ERROR, "test_pp_is_valid_declare_line");
@@ -834,6 +849,7 @@ void test_pp_is_valid_define_line() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// define two macros which will be used later in this test
 	p.expand_line("#macro c = my_binary_macro a b; declare intvar p; define p = pow a b; define c = ln p", write_scratch_file);
@@ -963,6 +979,7 @@ void test_pp_is_valid_define_vector_line() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// define two macros which will be used later in this test
 	p.expand_line("#macro c = my_binary_macro a b; declare intvar p; define p = pow a b; define c = ln p", write_scratch_file);
@@ -1049,6 +1066,7 @@ void test_pp_is_valid_declare_vector_line() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// simple errors
 	assert_equal_int(p.is_valid_declare_vector_line(""), OTHER_ERROR, "test_pp_is_valid_declare_vector_line");
@@ -1078,6 +1096,7 @@ void test_vector_component_functions() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// declare vector x
 	assert_equal_int(p.expand_line("declare_vector intvar x 3", write_scratch_file), 3, "test_vector_component_functions");
@@ -1112,38 +1131,45 @@ void test_define_vector_components() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// declare an intvar and input vector
-	// make sure all the components of both vectors are in the variables map
-	// make sure the components of the input vector are in the defined_variables set
+	// make sure all the components of both vectors are declared, without being entered into the variables map one by one
+	// make sure the components of the input vector are defined, along with the input vector itself
 	assert_equal_int(p.expand_line("declare_vector input x 3", write_scratch_file), 3, "test_define_vector_components");
 	assert_equal_int(p.expand_line("declare_vector intvar z 3", write_scratch_file), 3, "test_define_vector_components");
 
-	assert_equal_int(p.variables->size(), 6, "test_define_vector_components");
+	assert_equal_int(p.variables->size(), 0, "test_define_vector_components");
 	assert_equal_int(p.vectors->size(), 2, "test_define_vector_components");
 	assert_equal_int(p.vectors->count("x"), 1, "test_define_vector_components");
 	assert_equal_int(p.vectors->count("z"), 1, "test_define_vector_components");
 
-	assert_equal_int(p.variables->count("x.0"), 1, "test_define_vector_components");
-	assert_equal_int(p.variables->count("x.1"), 1, "test_define_vector_components");
-	assert_equal_int(p.variables->count("x.2"), 1, "test_define_vector_components");
-	assert_equal_int(p.variables->count("z.0"), 1, "test_define_vector_components");
-	assert_equal_int(p.variables->count("z.1"), 1, "test_define_vector_components");
-	assert_equal_int(p.variables->count("z.2"), 1, "test_define_vector_components");
-	
-	assert_equal_int(p.defined_variables->size(), 4, "test_define_vector_components");
+	assert_true(p.is_declared("x.0"), "X.0 is declared", "test_define_vector_components");
+	assert_true(p.is_declared("x.1"), "X.1 is declared", "test_define_vector_components");
+	assert_true(p.is_declared("x.2"), "X.2 is declared", "test_define_vector_components");
+	assert_true(p.is_declared("z.0"), "Z.0 is declared", "test_define_vector_components");
+	assert_true(p.is_declared("z.1"), "Z.1 is declared", "test_define_vector_components");
+	assert_true(p.is_declared("z.2"), "Z.2 is declared", "test_define_vector_components");
+	assert_false(p.is_declared("z.3"), "Z.3 is not declared", "test_define_vector_components");
+	assert_true(p.get_declared_type("x.1") == VariableType::INPUT, "X.1 is an Input variable", "test_define_vector_components");
+	assert_true(p.get_declared_type("z.1") == VariableType::INTVAR, "Z.1 is an Intvar variable", "test_define_vector_components");
+
+	assert_equal_int(p.defined_variables->size(), 1, "test_define_vector_components");
 	assert_equal_int(p.defined_variables->count("x"), 1, "test_define_vector_components");
-	assert_equal_int(p.defined_variables->count("x.0"), 1, "test_define_vector_components");
-	assert_equal_int(p.defined_variables->count("x.1"), 1, "test_define_vector_components");
-	assert_equal_int(p.defined_variables->count("x.2"), 1, "test_define_vector_components");
+	assert_true(p.is_defined("x.0"), "X.0 is defined", "test_define_vector_components");
+	assert_true(p.is_defined("x.1"), "X.1 is defined", "test_define_vector_components");
+	assert_true(p.is_defined("x.2"), "X.2 is defined", "test_define_vector_components");
+	assert_false(p.is_defined("z.0"), "Z.0 is not defined", "test_define_vector_components");
 
 	// try to define a component of input vector X. This should fail.
 	assert_equal_int(p.expand_line("define x.1 = 3", write_scratch_file), CANNOT_DEFINE_I_W_EO, "test_define_vector_components");
 
 	// define Z.0. This should succeed.
-	// Z.0 should now be in the defined_variables set
+	// Z.0 should now be defined, and Z should have one component defined
 	assert_equal_int(p.expand_line("define z.0 = 10", write_scratch_file), 1, "test_define_vector_components");
-	assert_equal_int(p.defined_variables->count("z.0"), 1, "test_define_vector_components");
+	assert_true(p.is_defined("z.0"), "Z.0 is defined", "test_define_vector_components");
+	assert_false(p.is_defined("z.1"), "Z.1 is not defined", "test_define_vector_components");
+	assert_equal_int(p.defined_components->at("z")->num_defined, 1, "test_define_vector_components");
 
 	// try to redefine Z.0. This should fail.
 	assert_equal_int(p.expand_line("define z.0 = 0", write_scratch_file), VAR_DEFINED_TWICE, "test_define_vector_components");
@@ -1159,20 +1185,21 @@ void test_define_vector_components() {
 	assert_equal_int(p.expand_line("define_vector z = exp x", write_scratch_file), VAR_DEFINED_TWICE, "test_define_vector_components");
 
 	// define Z.1 and Z.2
-	// these should succeed.  Make sure Z.1 and Z.2 are now both in the defined_variables set
+	// these should succeed.  Make sure Z.1 and Z.2 are now both defined
 	assert_equal_int(p.expand_line("define z.1 = 20", write_scratch_file), 1, "test_define_vector_components");
 	assert_equal_int(p.expand_line("define z.2 = 30", write_scratch_file), 1, "test_define_vector_components");
-	assert_equal_int(p.defined_variables->count("z.1"), 1, "test_define_vector_components");
-	assert_equal_int(p.defined_variables->count("z.2"), 1, "test_define_vector_components");
+	assert_true(p.is_defined("z.1"), "Z.1 is defined", "test_define_vector_components");
+	assert_true(p.is_defined("z.2"), "Z.2 is defined", "test_define_vector_components");
+	assert_true(p.all_components_defined("z"), "All of Z's components are defined", "test_define_vector_components");
 
 	// define P as a function of Z
 	// this should succeed
 	assert_equal_int(p.expand_line("define_vector p = add z z", write_scratch_file), 3, "test_define_vector_components");
-	// P and its components should now all be in the defined_variables set
+	// P should now be in the defined_variables set, and its components should all be defined
 	assert_equal_int(p.defined_variables->count("p"), 1, "test_define_vector_components");
-	assert_equal_int(p.defined_variables->count("p.0"), 1, "test_define_vector_components");
-	assert_equal_int(p.defined_variables->count("p.1"), 1, "test_define_vector_components");
-	assert_equal_int(p.defined_variables->count("p.2"), 1, "test_define_vector_components");
+	assert_true(p.is_defined("p.0"), "P.0 is defined", "test_define_vector_components");
+	assert_true(p.is_defined("p.1"), "P.1 is defined", "test_define_vector_components");
+	assert_true(p.is_defined("p.2"), "P.2 is defined", "test_define_vector_components");
 	// Z itself should now be in the defined_variables set
 	//	(During P's definition, we should realize all of Z's components are defined, and thus mark Z as defined)
 	assert_equal_int(p.defined_variables->count("z"), 1, "test_define_vector_components");
@@ -1184,10 +1211,45 @@ void test_define_vector_components() {
 
 }
 
+void test_large_vector_components() {
+
+	Preprocessor p;
+	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
+
+	// vectors can have up to 2^31 components
+	assert_equal_int(p.is_valid_declare_vector_line("declare_vector intvar big 2147483648"), 0, "test_large_vector_components");
+	assert_equal_int(p.is_valid_declare_vector_line("declare_vector intvar big 2147483649"), BAD_VECTOR_SIZE, "test_large_vector_components");
+	assert_equal_int(p.is_valid_declare_vector_line("declare_vector intvar big 99999999999999999999"), BAD_VECTOR_SIZE, "test_large_vector_components");
+
+	// record a declared vector of MAX_VECTOR_SIZE components, without writing out its declarations
+	p.vectors->insert(make_pair(Symbol("big"), VariableType::INTVAR));
+	p.vector_dimensions->insert(make_pair(Symbol("big"), MAX_VECTOR_SIZE));
+
+	// its components are recognized by their names, without being interned
+	assert_true(p.is_vector_component("big.2147483647"), "BIG.2147483647 is a component", "test_large_vector_components");
+	assert_false(p.is_vector_component("big.2147483648"), "BIG.2147483648 is past the end of BIG", "test_large_vector_components");
+	assert_false(p.is_vector_component("big.-1"), "BIG.-1 is not a component", "test_large_vector_components");
+	assert_true(p.is_declared("big.2147483647"), "BIG.2147483647 is declared", "test_large_vector_components");
+	assert_false(Symbol::find("big.2147483647").is_valid(), "Component names are not interned", "test_large_vector_components");
+
+	// define its last component by itself
+	assert_equal_int(p.expand_line("define big.2147483647 = 4", write_scratch_file), 1, "test_large_vector_components");
+	assert_true(p.is_defined("big.2147483647"), "BIG.2147483647 is defined", "test_large_vector_components");
+	assert_false(p.is_defined("big.0"), "BIG.0 is not defined", "test_large_vector_components");
+	assert_true(p.has_defined_components("big"), "BIG has a defined component", "test_large_vector_components");
+	assert_false(p.all_components_defined("big"), "BIG has undefined components", "test_large_vector_components");
+	assert_equal_int(p.expand_line("define big.2147483647 = 5", write_scratch_file), VAR_DEFINED_TWICE, "test_large_vector_components");
+
+	write_scratch_file.close();
+	pass("test_large_vector_components");
+}
+
 void test_is_valid_reduce_vector_line() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// define a binary macro
 	assert_equal_int(p.expand_line("#macro c = my_binary_macro a b; declare intvar p; define p = mul b a; define c = logistic p;", write_scratch_file), 0, "test_pp_expand_line");
@@ -1227,6 +1289,7 @@ void test_reduce_vector() {
 
 	Preprocessor p;
 	ofstream write_scratch_file("scratch.tf");
+	write_scratch_file << unitbuf;
 
 	// define a binary macro
 	assert_equal_int(p.expand_line("#macro c = my_binary_macro a b; declare intvar p; define p = mul b a; define c = logistic p;", write_scratch_file), 0, "test_pp_expand_line");
@@ -1275,6 +1338,56 @@ void test_reduce_vector() {
 }
 
 
+void test_pp_tree_reductions() {
+
+	Preprocessor p;
+	p.set_tree_reductions(true);
+	assert_true(p.tree_reductions, "Tree reductions should be on", "test_pp_tree_reductions");
+
+	// five products are summed pairwise, and the odd one out is added last
+	stringstream dot_lines;
+	assert_equal_int(p.expand_dot_product_instruction("z", "x", "w", 5, dot_lines), 19, "test_pp_tree_reductions");
+	string z_expansion[19] = {
+		"declare intvar z.0", "define z.0 = mul x.0 w.0", "declare intvar z.1", "define z.1 = mul x.1 w.1",
+		"declare intvar z.2", "define z.2 = mul x.2 w.2", "declare intvar z.3", "define z.3 = mul x.3 w.3",
+		"declare intvar z.4", "define z.4 = mul x.4 w.4",
+		"declare intvar z.5", "define z.5 = add z.0 z.1", "declare intvar z.6", "define z.6 = add z.2 z.3",
+		"declare intvar z.7", "define z.7 = add z.5 z.6", "declare intvar z.8", "define z.8 = add z.7 z.4",
+		"define z = z.8"
+	};
+	string line;
+	for (int i = 0; i < 19; i++) {
+		getline(dot_lines, line);
+		assert_equal_string(line, z_expansion[i], "test_pp_tree_reductions");
+	}
+
+	// reductions by add and mul are trees too
+	stringstream reduce_lines;
+	assert_equal_int(p.expand_line("declare_vector input x 4", reduce_lines), 4, "test_pp_tree_reductions");
+	assert_equal_int(p.expand_line("declare intvar a", reduce_lines), 1, "test_pp_tree_reductions");
+	assert_equal_int(p.expand_line("define a = reduce_vector x mul", reduce_lines), 7, "test_pp_tree_reductions");
+	string a_reduction_lines[7] = {"declare intvar a.0", "define a.0 = mul x.0 x.1", "declare intvar a.1", "define a.1 = mul x.2 x.3",
+		"declare intvar a.2", "define a.2 = mul a.0 a.1", "define a = a.2"};
+	for (int i = 0; i < 5; i++) getline(reduce_lines, line);
+	for (int i = 0; i < 7; i++) {
+		getline(reduce_lines, line);
+		assert_equal_string(line, a_reduction_lines[i], "test_pp_tree_reductions");
+	}
+
+	// sub is not associative, so its reduction stays a chain
+	stringstream chain_lines;
+	assert_equal_int(p.expand_reduce_vector_instruction("b", "x", "sub", 3, chain_lines), 5, "test_pp_tree_reductions");
+	string b_reduction_lines[5] = {"declare intvar b.0", "define b.0 = sub x.0 x.1",
+		"declare intvar b.1", "define b.1 = sub b.0 x.2", "define b = b.1"};
+	for (int i = 0; i < 5; i++) {
+		getline(chain_lines, line);
+		assert_equal_string(line, b_reduction_lines[i], "test_pp_tree_reductions");
+	}
+
+	pass("test_pp_tree_reductions");
+}
+
+
 void run_pp_tests() {
 
 	cout << "\nTesting Preprocessor Class... " << endl << endl;
@@ -1303,8 +1416,10 @@ void run_pp_tests() {
 	test_pp_is_valid_declare_vector_line();
 	test_vector_component_functions();
 	test_define_vector_components();
+	test_large_vector_components();
 	test_is_valid_reduce_vector_line();
 	test_reduce_vector();
+	test_pp_tree_reductions();
 
 	cout << "\nAll Preprocessor Tests Passed." << endl << endl;
 
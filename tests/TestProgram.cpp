@@ -0,0 +1,419 @@
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <cfloat>
+
+#include "TestProgram.h"
+#include "../src/Program.h"
+#include "../src/Interpreter.h"
+#include "TestUtilities.h"
+
+using namespace std;
+
+
+
+void test_prog_load_execute() {
+
+	// load a program once, and execute it twice with different inputs
+	Program prog;
+	assert_equal_int(prog.load("tests/test_files/inputs/expanded_shape_simple.tf"), 0, "test_prog_load_execute");
+
+	unordered_map<string, double> inputs;
+	inputs["a.0"] = 1; inputs["a.1"] = 2; inputs["a.2"] = 1;
+	inputs["b.0"] = 1; inputs["b.1"] = 2; inputs["b.2"] = -1;
+	inputs["c.0"] = 2; inputs["c.1"] = 4; inputs["c.2"] = 6;
+	inputs["d.0"] = 1; inputs["d.1"] = 3; inputs["d.2"] =  5;
+	inputs["e.0"] = 1; inputs["e.1"] = 2; inputs["e.2"] = 3;
+	inputs["f.0"] = 2; inputs["f.1"] = 3; inputs["f.2"] = 4;
+
+	unordered_map<string, double> outputs;
+	assert_equal_int(prog.execute(inputs, &outputs), 0, "test_prog_load_execute");
+	assert_equal_int(outputs.size(), 23, "test_prog_load_execute");
+	assert_equal_double(outputs.at("foo"), 4, "test_prog_load_execute");
+	assert_equal_double(outputs.at("bar"), 54.59815, "test_prog_load_execute");
+	assert_equal_double(outputs.at("C.2"), 44, "test_prog_load_execute");
+
+	// foo = dot(a, b)
+	inputs["a.0"] = 3;
+	outputs.clear();
+	assert_equal_int(prog.execute(inputs, &outputs), 0, "test_prog_load_execute");
+	assert_equal_double(outputs.at("foo"), 6, "test_prog_load_execute");
+
+	// a program can only be loaded once
+	stringstream again("declare input x");
+	assert_equal_int(prog.load(again), OTHER_ERROR, "test_prog_load_execute");
+
+	// files that don't exist
+	Program missing;
+	assert_equal_int(missing.load("tests/test_files/inputs/not_a_file.tf"), OTHER_ERROR, "test_prog_load_execute");
+
+	pass("test_prog_load_execute");
+
+}
+
+
+void test_prog_parse_line() {
+
+	Program prog;
+
+	// simple errors
+	assert_equal_int(prog.parse_line(""), 0, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("declare x"), INVALID_LINE, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("declare in x"), INVALID_LINE, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("declare input x y"), INVALID_LINE, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("declare input define"), INVALID_VAR_NAME, "test_prog_parse_line");
+
+	// declarations
+	assert_equal_int(prog.parse_line("declare input x"), 0, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("declare weight w"), 0, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("declare intvar y"), 0, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("declare output z"), 0, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("declare intvar x"), VAR_DECLARED_TWICE, "test_prog_parse_line");
+
+	// definitions
+	assert_equal_int(prog.parse_line("define q = 3"), VAR_DEFINED_BEFORE_DECLARED, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("define x = 3"), VAR_DEFINED_TWICE, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("define z = add y 1"), VAR_REFERENCED_BEFORE_DEFINED, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("define z = y"), VAR_REFERENCED_BEFORE_DEFINED, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("define y = add x"), INVALID_LINE, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("define y = exp x w"), INVALID_LINE, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("define y = 3 4"), INVALID_LINE, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("define y = mul x w"), 0, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("define y = mul x w"), VAR_DEFINED_TWICE, "test_prog_parse_line");
+	assert_equal_int(prog.parse_line("define z = exp y"), 0, "test_prog_parse_line");
+
+	assert_equal_int(prog.get_num_instructions(), 2, "test_prog_parse_line");
+
+	pass("test_prog_parse_line");
+
+}
+
+
+void test_prog_slots() {
+
+	Program prog;
+	stringstream text(
+		"declare input x\n"
+		"declare weight w\n"
+		"declare output y\n"
+		"declare loss L\n"
+		"define y = add x 2\n"
+		"define L = mul y 2\n"
+		"declare output c\n"
+		"define c = 2.5\n"
+	);
+	assert_equal_int(prog.load(text), 0, "test_prog_slots");
+
+	// one slot per variable, and one per distinct constant
+	assert_equal_int(prog.get_num_slots(), 7, "test_prog_slots");
+	assert_equal_int(prog.get_num_instructions(), 3, "test_prog_slots");
+	assert_true(prog.get_slot("x") == 0, "X has the first slot", "test_prog_slots");
+	assert_true(prog.get_slot("not_in_program") == INVALID_SLOT, "NOT_IN_PROGRAM has no slot", "test_prog_slots");
+	assert_true(prog.get_slot_type(prog.get_slot("2")) == VariableType::CONSTANT, "2 is a constant", "test_prog_slots");
+	assert_equal_string(prog.get_slot_name(prog.get_slot("w")).str(), "w", "test_prog_slots");
+	assert_true(prog.get_loss_slot() == prog.get_slot("L"), "L is the loss", "test_prog_slots");
+
+	// inputs and outputs, in the order they were declared
+	assert_equal_int(prog.get_input_slots().size(), 2, "test_prog_slots");
+	assert_true(prog.get_input_slots()[1] == prog.get_slot("w"), "W is the second input", "test_prog_slots");
+	assert_equal_int(prog.get_output_slots().size(), 2, "test_prog_slots");
+	assert_true(prog.get_output_slots()[1] == prog.get_slot("c"), "C is the second output", "test_prog_slots");
+
+	// run the program on an array of values
+	vector<double> values;
+	prog.init_values(&values);
+	assert_equal_int(values.size(), 7, "test_prog_slots");
+	assert_equal_double(values[prog.get_slot("2")], 2, "test_prog_slots");
+	assert_true(values[prog.get_slot("y")] == DBL_MAX, "Y is not yet defined", "test_prog_slots");
+
+	unordered_map<string, double> inputs = {{"x", 1}, {"w", 0}};
+	assert_equal_int(prog.bind_inputs(inputs, &values), 0, "test_prog_slots");
+	assert_equal_int(prog.run(&values), 0, "test_prog_slots");
+	assert_equal_double(values[prog.get_slot("y")], 3, "test_prog_slots");
+	assert_equal_double(values[prog.get_slot("L")], 6, "test_prog_slots");
+	assert_equal_double(values[prog.get_slot("c")], 2.5, "test_prog_slots");
+
+	pass("test_prog_slots");
+
+}
+
+
+void test_prog_max_slots() {
+
+	// a program that needs more slots than it may have is refused, whether the last slot is for a variable or a constant
+	string declarations = "declare input x\ndeclare weight w\ndeclare output y\n";
+	Program too_many_variables, too_many_constants, enough;
+	stringstream variables_text(declarations + "declare output z\n");
+	too_many_variables.set_max_slots(3);
+	assert_equal_int(too_many_variables.load(variables_text), TOO_MANY_VARIABLES, "test_prog_max_slots");
+
+	stringstream constants_text(declarations + "define y = add x 2\n");
+	too_many_constants.set_max_slots(3);
+	assert_equal_int(too_many_constants.load(constants_text), TOO_MANY_VARIABLES, "test_prog_max_slots");
+
+	stringstream enough_text(declarations + "define y = add x 2\n");
+	enough.set_max_slots(4);
+	assert_equal_int(enough.load(enough_text), 0, "test_prog_max_slots");
+	assert_equal_int(enough.get_num_slots(), 4, "test_prog_max_slots");
+
+	pass("test_prog_max_slots");
+
+}
+
+
+void test_prog_execute_errors() {
+
+	Program prog;
+	stringstream text(
+		"declare input x\n"
+		"declare output y\n"
+		"define y = ln x\n"
+	);
+	assert_equal_int(prog.load(text), 0, "test_prog_execute_errors");
+
+	unordered_map<string, double> outputs;
+	unordered_map<string, double> no_inputs;
+	assert_equal_int(prog.execute(no_inputs, &outputs), INPUT_VALUE_NOT_PROVIDED, "test_prog_execute_errors");
+
+	unordered_map<string, double> bad_input = {{"x", DBL_MAX}};
+	assert_equal_int(prog.execute(bad_input, &outputs), OTHER_ERROR, "test_prog_execute_errors");
+
+	// the log of a negative number has no value
+	unordered_map<string, double> negative = {{"x", -1}};
+	assert_equal_int(prog.execute(negative, &outputs), INVALID_LINE, "test_prog_execute_errors");
+
+	unordered_map<string, double> positive = {{"x", 1}};
+	assert_equal_int(prog.execute(positive, &outputs), 0, "test_prog_execute_errors");
+	assert_equal_double(outputs.at("y"), 0, "test_prog_execute_errors");
+
+	pass("test_prog_execute_errors");
+
+}
+
+
+void test_prog_matches_interpreter() {
+
+	// a loaded GCP gives exactly the same partials as the Interpreter
+	unordered_map<string, double> inputs = {
+		{"a", 1}, {"b", 2}, {"c", 3},
+		{"f", 0.35}, {"g", 0.24}, {"h", 0.08},
+		{"m", 0.6}, {"n", 0.55}, {"p", 0.57}
+	};
+
+	Interpreter i;
+	unordered_map<string, double> interpreted;
+	assert_equal_int(i.interpret("tests/test_files/inputs/small_net_gcp.tf", inputs, &interpreted), 0, "test_prog_matches_interpreter");
+
+	Program prog;
+	unordered_map<string, double> executed;
+	assert_equal_int(prog.load("tests/test_files/inputs/small_net_gcp.tf"), 0, "test_prog_matches_interpreter");
+	assert_equal_int(prog.execute(inputs, &executed), 0, "test_prog_matches_interpreter");
+
+	assert_equal_int(executed.size(), interpreted.size(), "test_prog_matches_interpreter");
+	for (unordered_map<string, double>::iterator it = interpreted.begin(); it != interpreted.end(); ++it) {
+		assert_true(executed.count(it->first) == 1 && executed.at(it->first) == it->second,
+			"Every output should match the Interpreter's exactly", "test_prog_matches_interpreter");
+	}
+
+	pass("test_prog_matches_interpreter");
+
+}
+
+
+void test_prog_vectorize() {
+
+	// component-wise lines over consecutive components are packed into one Vector Instruction each
+	stringstream text(
+		"declare input x.0\ndeclare input x.1\ndeclare input x.2\ndeclare input x.3\ndeclare input x.4\n"
+		"declare input y.0\ndeclare input y.1\ndeclare input y.2\ndeclare input y.3\ndeclare input y.4\n"
+		"declare input s\n"
+		"declare output z.0\ndeclare output z.1\ndeclare output z.2\ndeclare output z.3\ndeclare output z.4\n"
+		"declare output w.0\ndeclare output w.1\ndeclare output w.2\ndeclare output w.3\ndeclare output w.4\n"
+		"define z.0 = mul x.0 y.0\ndefine z.1 = mul x.1 y.1\ndefine z.2 = mul x.2 y.2\ndefine z.3 = mul x.3 y.3\ndefine z.4 = mul x.4 y.4\n"
+		"define w.0 = sub z.0 s\ndefine w.1 = sub z.1 s\ndefine w.2 = sub z.2 s\ndefine w.3 = sub z.3 s\ndefine w.4 = sub z.4 s\n"
+	);
+	Program prog;
+	assert_equal_int(prog.load(text), 0, "test_prog_vectorize");
+
+	const vector<VectorInstruction>& vector_instructions = prog.get_vector_instructions();
+	assert_equal_int(vector_instructions.size(), 2, "test_prog_vectorize");
+	assert_equal_int(vector_instructions[0].width, 5, "test_prog_vectorize");
+	assert_equal_int(vector_instructions[0].result, prog.get_slot(string("z.0")), "test_prog_vectorize");
+	assert_equal_int(vector_instructions[0].stride1, 1, "test_prog_vectorize");
+	assert_equal_int(vector_instructions[0].stride2, 1, "test_prog_vectorize");
+	assert_equal_int(vector_instructions[1].width, 5, "test_prog_vectorize");
+	assert_equal_int(vector_instructions[1].stride1, 1, "test_prog_vectorize");
+	assert_equal_int(vector_instructions[1].stride2, 0, "test_prog_vectorize");
+
+	unordered_map<string, double> inputs = {
+		{"x.0", 1}, {"x.1", 2}, {"x.2", 3}, {"x.3", 4}, {"x.4", 5},
+		{"y.0", 0.5}, {"y.1", -1}, {"y.2", 2}, {"y.3", 0}, {"y.4", 3}, {"s", 1}
+	};
+	unordered_map<string, double> outputs;
+	assert_equal_int(prog.execute(inputs, &outputs), 0, "test_prog_vectorize");
+	assert_equal_double(outputs.at("z.4"), 15, "test_prog_vectorize");
+	assert_equal_double(outputs.at("w.0"), -0.5, "test_prog_vectorize");
+	assert_equal_double(outputs.at("w.1"), -3, "test_prog_vectorize");
+	assert_equal_double(outputs.at("w.4"), 14, "test_prog_vectorize");
+
+	// a lane whose result is used before the last lane runs cannot be packed, and neither can a chain of additions
+	stringstream chains(
+		"declare input x.0\ndeclare input x.1\ndeclare input x.2\ndeclare input y.0\ndeclare input y.1\n"
+		"declare intvar a.0\ndeclare intvar a.1\ndeclare output e\n"
+		"declare intvar r:0\ndeclare intvar r:1\ndeclare output r\n"
+		"define a.0 = add x.0 y.0\ndefine e = exp a.0\ndefine a.1 = add x.1 y.1\n"
+		"define r:0 = add x.0 x.1\ndefine r:1 = add r:0 x.2\ndefine r = r:1\n"
+	);
+	Program unpacked;
+	assert_equal_int(unpacked.load(chains), 0, "test_prog_vectorize");
+	assert_equal_int(unpacked.vectorize(), 0, "test_prog_vectorize");
+	assert_equal_int(unpacked.get_vector_instructions().size(), unpacked.get_num_instructions(), "test_prog_vectorize");
+
+	// a vectorized program gives exactly the same outputs as the Interpreter, and as the same program run line by line
+	inputs = {
+		{"a.0", 1}, {"a.1", 2}, {"a.2", 1}, {"b.0", 1}, {"b.1", 2}, {"b.2", -1},
+		{"c.0", 2}, {"c.1", 4}, {"c.2", 6}, {"d.0", 1}, {"d.1", 3}, {"d.2", 5},
+		{"e.0", 1}, {"e.1", 2}, {"e.2", 3}, {"f.0", 2}, {"f.1", 3}, {"f.2", 4}
+	};
+	Interpreter i;
+	unordered_map<string, double> interpreted, vectorized, scalar;
+	assert_equal_int(i.interpret("tests/test_files/inputs/expanded_shape_simple.tf", inputs, &interpreted), 0, "test_prog_vectorize");
+
+	Program simple;
+	assert_equal_int(simple.load("tests/test_files/inputs/expanded_shape_simple.tf"), 0, "test_prog_vectorize");
+	assert_true(simple.get_vector_instructions().size() < simple.get_num_instructions(),
+		"Component-wise lines should be packed", "test_prog_vectorize");
+	assert_equal_int(simple.execute(inputs, &vectorized), 0, "test_prog_vectorize");
+
+	// parse_line does not vectorize
+	Program simple_scalar;
+	ifstream file("tests/test_files/inputs/expanded_shape_simple.tf");
+	string line;
+	while (getline(file, line)) assert_equal_int(simple_scalar.parse_line(line), 0, "test_prog_vectorize");
+	file.close();
+	assert_equal_int(simple_scalar.get_vector_instructions().size(), 0, "test_prog_vectorize");
+	assert_equal_int(simple_scalar.execute(inputs, &scalar), 0, "test_prog_vectorize");
+
+	assert_equal_int(vectorized.size(), interpreted.size(), "test_prog_vectorize");
+	for (unordered_map<string, double>::iterator it = interpreted.begin(); it != interpreted.end(); ++it) {
+		assert_true(vectorized.at(it->first) == it->second && scalar.at(it->first) == it->second,
+			"Every output should match the Interpreter's exactly", "test_prog_vectorize");
+	}
+
+	pass("test_prog_vectorize");
+
+}
+
+
+
+void test_prog_sparse_execution() {
+
+	// products and copies of the components of x are 0 wherever x is, and the sum of the products is not
+	string text =
+		"declare input x.0\ndeclare input x.1\ndeclare input x.2\ndeclare input x.3\n"
+		"declare weight w.0\ndeclare weight w.1\ndeclare weight w.2\ndeclare weight w.3\n"
+		"declare intvar p.0\ndeclare intvar p.1\ndeclare intvar p.2\ndeclare intvar p.3\n"
+		"define p.0 = mul x.0 w.0\ndefine p.1 = mul x.1 w.1\ndefine p.2 = mul x.2 w.2\ndefine p.3 = mul x.3 w.3\n"
+		"declare intvar s\ndeclare intvar t\ndeclare output u\n"
+		"define s = add p.0 p.1\ndefine t = add p.2 p.3\ndefine u = add s t\n"
+		"declare output g.0\ndeclare output g.1\ndeclare output g.2\ndeclare output g.3\n"
+		"define g.0 = x.0\ndefine g.1 = x.1\ndefine g.2 = x.2\ndefine g.3 = x.3\n"
+		"declare output q\ndefine q = pow x.3 2\n";
+
+	Program prog;
+	stringstream prog_text(text);
+	assert_equal_int(prog.load(prog_text), 0, "test_prog_sparse_execution");
+	assert_equal_int(prog.get_vector_instructions()[0].width, 4, "test_prog_sparse_execution");
+
+	// x and w are Input Vectors, and the zero sources follow products, copies and powers, but not sums
+	const InputVector *x = prog.get_input_vector(Symbol("x"));
+	assert_true(x != NULL && x->contiguous, "x should be a contiguous Input Vector", "test_prog_sparse_execution");
+	assert_equal_int(x->first_slot, prog.get_slot(Symbol("x.0")), "test_prog_sparse_execution");
+	assert_equal_int(x->dimension, 4, "test_prog_sparse_execution");
+	assert_true(prog.get_input_vector(Symbol("p")) == NULL, "p should not be an Input Vector", "test_prog_sparse_execution");
+	assert_equal_int(prog.get_zero_source(prog.get_slot(Symbol("p.2"))), prog.get_slot(Symbol("x.2")), "test_prog_sparse_execution");
+	assert_equal_int(prog.get_zero_source(prog.get_slot(Symbol("g.1"))), prog.get_slot(Symbol("x.1")), "test_prog_sparse_execution");
+	assert_equal_int(prog.get_zero_source(prog.get_slot(Symbol("q"))), prog.get_slot(Symbol("x.3")), "test_prog_sparse_execution");
+	assert_equal_int(prog.get_zero_source(prog.get_slot(Symbol("s"))), INVALID_SLOT, "test_prog_sparse_execution");
+
+	// a sparse run gives the outputs of a dense run that are not 0
+	unordered_map<string, double> weights = {{"w.0", 1}, {"w.1", 2}, {"w.2", 3}, {"w.3", 4}};
+	SparseVariableVector sparse_inputs;
+	sparse_inputs["x"] = {{1, 3}, {0.5, -2}};
+	unordered_map<string, double> dense_inputs = weights;
+	dense_inputs["x.0"] = 0; dense_inputs["x.1"] = 0.5; dense_inputs["x.2"] = 0; dense_inputs["x.3"] = -2;
+
+	unordered_map<string, double> dense_outputs, sparse_outputs;
+	assert_equal_int(prog.execute(dense_inputs, &dense_outputs), 0, "test_prog_sparse_execution");
+	assert_equal_int(prog.execute(weights, sparse_inputs, &sparse_outputs), 0, "test_prog_sparse_execution");
+	assert_equal_int(sparse_outputs.size(), 4, "test_prog_sparse_execution");
+	for (unordered_map<string, double>::iterator it = dense_outputs.begin(); it != dense_outputs.end(); ++it) {
+		double sparse_value = sparse_outputs.count(it->first) == 0 ? 0 : sparse_outputs.at(it->first);
+		assert_equal_double(sparse_value, it->second, "test_prog_sparse_execution");
+	}
+	assert_equal_double(sparse_outputs.at("u"), -7, "test_prog_sparse_execution");
+
+	// the same run without vectorizing, from values bound in pieces
+	Program scalar;
+	stringstream scalar_text(text);
+	LineReader reader(scalar_text);
+	string line;
+	while (reader.next_line(&line)) assert_equal_int(scalar.parse_line(line), 0, "test_prog_sparse_execution");
+	vector<double> weight_values, values;
+	scalar.init_values(&weight_values);
+	assert_equal_int(scalar.bind_values(weights, &weight_values), 0, "test_prog_sparse_execution");
+	values = weight_values;
+	assert_equal_int(scalar.check_inputs_bound(values), INPUT_VALUE_NOT_PROVIDED, "test_prog_sparse_execution");
+	assert_equal_int(scalar.bind_sparse_values(sparse_inputs, &values), 0, "test_prog_sparse_execution");
+	assert_equal_int(scalar.check_inputs_bound(values), 0, "test_prog_sparse_execution");
+	assert_equal_int(scalar.run_sparse(&values), 0, "test_prog_sparse_execution");
+	assert_equal_double(values[scalar.get_slot(Symbol("u"))], -7, "test_prog_sparse_execution");
+	assert_equal_double(values[scalar.get_slot(Symbol("p.2"))], 0, "test_prog_sparse_execution");
+
+	// a component beyond the end of its vector is an error, rather than being dropped
+	SparseVariableVector too_long;
+	too_long["x"] = {{1, 3, 9}, {0.5, -2, 7}};
+	values = weight_values;
+	assert_equal_int(scalar.bind_sparse_values(too_long, &values), VECTORS_OF_DIFFERENT_DIMENSION, "test_prog_sparse_execution");
+	unordered_map<string, double> too_long_outputs;
+	assert_equal_int(prog.execute(weights, too_long, &too_long_outputs), VECTORS_OF_DIFFERENT_DIMENSION, "test_prog_sparse_execution");
+	values = weight_values;
+	assert_equal_int(scalar.bind_sparse_values(sparse_inputs, &values), 0, "test_prog_sparse_execution");
+
+	// a variable is bound once, whether by name or by its vector
+	assert_equal_int(scalar.bind_values(weights, &values), VAR_DECLARED_TWICE, "test_prog_sparse_execution");
+	assert_equal_int(scalar.bind_sparse_values(sparse_inputs, &values), VAR_DECLARED_TWICE, "test_prog_sparse_execution");
+	unordered_map<string, double> outputs;
+	assert_equal_int(prog.execute(dense_inputs, sparse_inputs, &outputs), VAR_DECLARED_TWICE, "test_prog_sparse_execution");
+	assert_equal_int(prog.execute({{"w.0", 1}}, sparse_inputs, &outputs), INPUT_VALUE_NOT_PROVIDED, "test_prog_sparse_execution");
+
+	// vectors whose components are not in consecutive slots cannot be bound sparsely
+	Program scattered;
+	stringstream scattered_text("declare input v.0\ndeclare input y\ndeclare input v.1\ndeclare output o\ndefine o = mul v.0 v.1\n");
+	assert_equal_int(scattered.load(scattered_text), 0, "test_prog_sparse_execution");
+	assert_false(scattered.get_input_vector(Symbol("v"))->contiguous, "v should not be contiguous", "test_prog_sparse_execution");
+	SparseVariableVector v;
+	v["v"] = {{0}, {1}};
+	assert_equal_int(scattered.execute({{"y", 1}}, v, &outputs), OTHER_ERROR, "test_prog_sparse_execution");
+
+	pass("test_prog_sparse_execution");
+
+}
+
+
+
+void run_prog_tests() {
+
+	cout << "\nTesting Program Class... " << endl << endl;
+
+	test_prog_load_execute();
+	test_prog_parse_line();
+	test_prog_slots();
+	test_prog_max_slots();
+	test_prog_execute_errors();
+	test_prog_matches_interpreter();
+	test_prog_vectorize();
+	test_prog_sparse_execution();
+
+	cout << "\nAll Program Tests Passed." << endl << endl;
+}
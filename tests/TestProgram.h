@@ -0,0 +1,23 @@
+#ifndef TEST_PROGRAM_H
+#define TEST_PROGRAM_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for the Program class. */
+
+void test_prog_load_execute();
+void test_prog_parse_line();
+void test_prog_slots();
+void test_prog_max_slots();
+void test_prog_execute_errors();
+void test_prog_matches_interpreter();
+void test_prog_vectorize();
+void test_prog_sparse_execution();
+
+void run_prog_tests();
+
+
+#endif
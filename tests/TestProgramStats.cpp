@@ -0,0 +1,131 @@
+#include <iostream>
+#include <sstream>
+
+#include "TestProgramStats.h"
+#include "../src/ProgramStats.h"
+#include "TestUtilities.h"
+
+using namespace std;
+
+
+/* The squared error of a one-weight linear model.
+ * Its GCP has 16 Instructions:
+ *  mul z, sub e, pow L, and the partials, whose longest chain is e, d/L/d/e:edge:1, d/L/d/e:edge, d/L/d/e, d/L/d/z, d/L/d/w.
+ */
+static const string linear_model =
+	"declare input x\n"
+	"declare weight w\n"
+	"declare exp_output y\n"
+	"declare intvar z\n"
+	"define z = mul x w\n"
+	"declare intvar e\n"
+	"define e = sub z y\n"
+	"declare loss L\n"
+	"define L = pow e 2\n";
+
+
+
+void test_stats_compute() {
+
+	stringstream prog(linear_model);
+	ProgramStats stats;
+	assert_equal_int(compute_program_stats(prog, &stats), 0, "test_stats_compute");
+
+	assert_equal_int(stats.num_inputs, 1, "test_stats_compute");
+	assert_equal_int(stats.num_weights, 1, "test_stats_compute");
+	assert_equal_int(stats.num_exp_outputs, 1, "test_stats_compute");
+	assert_equal_int(stats.num_outputs, 1, "test_stats_compute");
+
+	// 19 variables, and the constants 2, 1 and -1
+	assert_equal_int(stats.num_slots, 22, "test_stats_compute");
+	assert_equal_int(stats.num_instructions, 16, "test_stats_compute");
+	assert_equal_int(stats.operation_counts[static_cast<int>(OperationType::MUL)], 7, "test_stats_compute");
+	assert_equal_int(stats.operation_counts[static_cast<int>(OperationType::SUB)], 2, "test_stats_compute");
+	assert_equal_int(stats.operation_counts[static_cast<int>(OperationType::POW)], 2, "test_stats_compute");
+	assert_equal_int(stats.operation_counts[static_cast<int>(OperationType::ADD)], 0, "test_stats_compute");
+	assert_equal_int(stats.operation_counts[static_cast<int>(OperationType::INVALID_OPERATION)], 5, "test_stats_compute");
+	assert_equal_int(stats.num_transcendentals, 2, "test_stats_compute");
+
+	assert_equal_int(stats.critical_path_length, 7, "test_stats_compute");
+	assert_equal_double(stats.parallelism, 16.0 / 7, "test_stats_compute");
+	assert_true(stats.scheduled_peak_live_values <= stats.peak_live_values, "Scheduling never adds live values", "test_stats_compute");
+	assert_equal_int(stats.bytes_per_example, (2 + 22) * sizeof(double), "test_stats_compute");
+
+	pass("test_stats_compute");
+
+}
+
+
+void test_stats_small_net() {
+
+	// the small net has 3 logistics, 3 exps (in their partials) and 13 pows
+	ProgramStats stats;
+	assert_equal_int(compute_program_stats("tests/test_files/inputs/small_net_shape.tf", &stats), 0, "test_stats_small_net");
+
+	assert_equal_int(stats.num_inputs, 3, "test_stats_small_net");
+	assert_equal_int(stats.num_weights, 3, "test_stats_small_net");
+	assert_equal_int(stats.num_exp_outputs, 3, "test_stats_small_net");
+	assert_equal_int(stats.num_outputs, 3, "test_stats_small_net");
+	assert_equal_int(stats.num_instructions, 92, "test_stats_small_net");
+	assert_equal_int(stats.num_transcendentals, 19, "test_stats_small_net");
+
+	uint32_t total = 0;
+	for (int i = 0; i < NUM_OPERATION_COUNTS; i++) total += stats.operation_counts[i];
+	assert_equal_int(total, stats.num_instructions, "test_stats_small_net");
+	assert_equal_double(stats.parallelism, (double) stats.num_instructions / stats.critical_path_length, "test_stats_small_net");
+	assert_equal_int(stats.peak_live_values, 18, "test_stats_small_net");
+	// the lanes of its Vector Instructions are scheduled together, which leaves the peak where it was
+	assert_equal_int(stats.scheduled_peak_live_values, 18, "test_stats_small_net");
+
+	pass("test_stats_small_net");
+
+}
+
+
+void test_stats_json() {
+
+	stringstream prog(linear_model);
+	ProgramStats stats;
+	assert_equal_int(compute_program_stats(prog, &stats), 0, "test_stats_json");
+
+	stringstream json;
+	write_program_stats_json(stats, json);
+	string text = json.str();
+	assert_equal_string(text.substr(0, 1), "{", "test_stats_json");
+	assert_true(text.find("\"instructions\": 16,") != string::npos, "The JSON has the number of instructions", "test_stats_json");
+	assert_true(text.find("\"mul\": 7,") != string::npos, "The JSON has the operation counts", "test_stats_json");
+	assert_true(text.find("\"copy\": 5}") != string::npos, "The JSON counts copies last", "test_stats_json");
+	assert_true(text.find("\"critical_path_length\": 7,") != string::npos, "The JSON has the critical path", "test_stats_json");
+	assert_true(text.find("\"parallelism\": 2.28571,") != string::npos, "The JSON has the parallelism", "test_stats_json");
+	assert_true(text.find("\"bytes_per_example\": 192\n}") != string::npos, "The JSON ends with the bytes per example", "test_stats_json");
+
+	pass("test_stats_json");
+
+}
+
+
+void test_stats_errors() {
+
+	ProgramStats stats;
+	assert_equal_int(compute_program_stats("tests/test_files/inputs/not_a_file.tf", &stats), INVALID_FILE_NAME, "test_stats_errors");
+
+	stringstream undeclared("declare input x\ndefine y = exp x\n");
+	assert_equal_int(compute_program_stats(undeclared, &stats), VAR_DEFINED_BEFORE_DECLARED, "test_stats_errors");
+
+	pass("test_stats_errors");
+
+}
+
+
+
+void run_stats_tests() {
+
+	cout << "\nTesting Program Stats... " << endl << endl;
+
+	test_stats_compute();
+	test_stats_small_net();
+	test_stats_json();
+	test_stats_errors();
+
+	cout << "\nAll Program Stats Tests Passed." << endl << endl;
+}
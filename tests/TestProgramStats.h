@@ -0,0 +1,19 @@
+#ifndef TEST_PROGRAM_STATS_H
+#define TEST_PROGRAM_STATS_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for Program Stats. */
+
+void test_stats_compute();
+void test_stats_small_net();
+void test_stats_json();
+void test_stats_errors();
+
+void run_stats_tests();
+
+
+#endif
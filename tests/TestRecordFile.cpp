@@ -0,0 +1,129 @@
+#include <iostream>
+#include <cstdio>
+#include <algorithm>
+
+#include "TestRecordFile.h"
+#include "../src/RecordFile.h"
+#include "TestUtilities.h"
+#include "TestDataSource.h"
+
+using namespace std;
+
+
+/* Writes NUM_RECORDS records of columns "x" and "y" into scratch.rec: record i holds i, and -i / 2. */
+static void write_scratch_records(int64_t num_records) {
+	RecordWriter writer;
+	vector<string> column_names = {"x", "y"};
+	writer.open("scratch.rec", column_names);
+	for (int64_t i = 0; i < num_records; i++) {
+		double record[] = {(double) i, -i / 2.0};
+		writer.write_record(record);
+	}
+	writer.close();
+}
+
+
+void test_record_file_write() {
+	remove("scratch.rec");
+
+	// training data are written as records of their columns, whether inputs or expected outputs
+	vector<pair<unordered_map<string, double>, unordered_map<string, double> > > training_data;
+	for (int i = 0; i < 3; i++) {
+		unordered_map<string, double> inputs = {{"x", (double) i}, {"z", 7}};
+		unordered_map<string, double> outputs = {{"y", -i / 2.0}};
+		training_data.push_back(make_pair(inputs, outputs));
+	}
+	vector<string> column_names = {"x", "y"};
+	assert_equal_int(write_record_file("scratch.rec", column_names, training_data), 0, "test_record_file_write");
+	assert_true(is_record_file("scratch.rec"), "a record file is recognized", "test_record_file_write");
+	assert_true(!is_record_file("tests/test_files/inputs/small_net_training_data.txt"), "a text file is not a record file", "test_record_file_write");
+
+	RecordFileSource source;
+	assert_equal_int(source.open("scratch.rec"), 0, "test_record_file_write");
+	assert_equal_int(source.get_num_records(), 3, "test_record_file_write");
+	assert_true(source.get_column_names() == column_names, "the columns are read back", "test_record_file_write");
+	vector<double> xs;
+	assert_true(read_pass(&source, 2, NULL, &xs), "the records are read back", "test_record_file_write");
+	assert_true(xs == vector<double>({0, 1, 2}), "the records are read back in order", "test_record_file_write");
+	source.close();
+
+	// a datum must give every column
+	vector<string> missing = {"x", "w"};
+	assert_equal_int(write_record_file("scratch.rec", missing, training_data), INPUT_VALUE_NOT_PROVIDED, "test_record_file_write");
+	vector<string> none;
+	assert_equal_int(write_record_file("scratch.rec", none, training_data), OTHER_ERROR, "test_record_file_write");
+	assert_equal_int(write_record_file("no_such_directory/scratch.rec", column_names, training_data), INVALID_FILE_NAME, "test_record_file_write");
+
+	// files that are not whole record files are not opened
+	assert_equal_int(source.open("no_such_file.rec"), INVALID_FILE_NAME, "test_record_file_write");
+	assert_equal_int(source.open("tests/test_files/inputs/small_net_training_data.txt"), OTHER_ERROR, "test_record_file_write");
+	write_scratch_records(5);
+	FILE *file = fopen("scratch.rec", "ab");
+	fputc(0, file);
+	fclose(file);
+	assert_equal_int(source.open("scratch.rec"), OTHER_ERROR, "test_record_file_write");
+	assert_equal_int(source.start_pass(2, NULL), OTHER_ERROR, "test_record_file_write");
+
+	remove("scratch.rec");
+	pass("test_record_file_write");
+}
+
+
+void test_record_file_passes() {
+	remove("scratch.rec");
+	write_scratch_records(1000);
+
+	// chunks of 7 records, so batches span chunks
+	RecordFileSource source(7 * 2 * sizeof(double));
+	assert_equal_int(source.open("scratch.rec"), 0, "test_record_file_passes");
+	DataBatch batch;
+	assert_equal_int(source.next_batch(&batch), OTHER_ERROR, "test_record_file_passes");
+	assert_equal_int(source.start_pass(0, NULL), OTHER_ERROR, "test_record_file_passes");
+
+	// a pass in order gives every record once, in order, in full batches but the last
+	vector<double> xs;
+	assert_true(read_pass(&source, 64, NULL, &xs), "a pass in order is read", "test_record_file_passes");
+	assert_equal_int(xs.size(), 1000, "test_record_file_passes");
+	for (int i = 0; i < 1000; i++) assert_equal_double(xs[i], i, "test_record_file_passes");
+
+	// a shuffled pass gives every record once, in another order, which the generator fixes
+	mt19937_64 rng(5);
+	vector<double> shuffled, again, next;
+	assert_true(read_pass(&source, 64, &rng, &shuffled), "a shuffled pass is read", "test_record_file_passes");
+	assert_true(read_pass(&source, 64, &rng, &next), "a shuffled pass is read", "test_record_file_passes");
+	rng.seed(5);
+	assert_true(read_pass(&source, 64, &rng, &again), "a shuffled pass is read", "test_record_file_passes");
+	assert_true(shuffled == again, "the same generator gives the same order", "test_record_file_passes");
+	assert_true(shuffled != xs && shuffled != next, "every shuffled pass has an order of its own", "test_record_file_passes");
+	sort(shuffled.begin(), shuffled.end());
+	assert_true(shuffled == xs, "a shuffled pass gives every record once", "test_record_file_passes");
+
+	// a pass can be left before its end, and another started, and batches of one record work too
+	assert_equal_int(source.start_pass(3, NULL), 0, "test_record_file_passes");
+	assert_equal_int(source.next_batch(&batch), 0, "test_record_file_passes");
+	assert_true(read_pass(&source, 1, NULL, &xs), "a pass after an unfinished one is read", "test_record_file_passes");
+	assert_equal_int(xs.size(), 1000, "test_record_file_passes");
+	assert_equal_double(xs[999], 999, "test_record_file_passes");
+	assert_equal_int(source.start_pass(3, NULL), 0, "test_record_file_passes");
+	source.close();
+
+	// an empty file has passes with no batches
+	write_scratch_records(0);
+	assert_equal_int(source.open("scratch.rec"), 0, "test_record_file_passes");
+	assert_true(read_pass(&source, 4, &rng, &xs), "an empty pass is read", "test_record_file_passes");
+	assert_equal_int(xs.size(), 0, "test_record_file_passes");
+	source.close();
+
+	remove("scratch.rec");
+	pass("test_record_file_passes");
+}
+
+
+void run_record_file_tests() {
+	cout << "\nTesting the Record Files... " << endl << endl;
+
+	test_record_file_write();
+	test_record_file_passes();
+
+	cout << "\nAll Record File Tests Passed." << endl << endl;
+}
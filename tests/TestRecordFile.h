@@ -0,0 +1,17 @@
+#ifndef TEST_RECORD_FILE_H
+#define TEST_RECORD_FILE_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for record files, and for streaming them. */
+
+void test_record_file_write();
+void test_record_file_passes();
+
+void run_record_file_tests();
+
+
+#endif
@@ -0,0 +1,234 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include "TestScheduler.h"
+#include "../src/Scheduler.h"
+#include "../src/Program.h"
+#include "TestUtilities.h"
+
+using namespace std;
+
+
+/* Four independent chains, defined breadth-first, and summed at the end.
+ * They are declared one chain at a time, so the values of one step are not in consecutive slots, and nothing is vectorized.
+ */
+static const string four_chains =
+	"declare input x\n"
+	"declare output y\n"
+	"declare intvar a1\ndeclare intvar a2\ndeclare intvar b1\ndeclare intvar b2\n"
+	"declare intvar c1\ndeclare intvar c2\ndeclare intvar d1\ndeclare intvar d2\n"
+	"declare intvar s1\ndeclare intvar s2\n"
+	"\n"
+	"define a1 = exp x\ndefine b1 = exp x\ndefine c1 = exp x\ndefine d1 = exp x\n"
+	"define a2 = mul a1 2\ndefine b2 = mul b1 2\ndefine c2 = mul c1 2\ndefine d2 = mul d1 2\n"
+	"define s1 = add a2 b2\ndefine s2 = add c2 d2\n"
+	"define y = add s1 s2\n";
+
+
+
+void test_sched_peak_live_values() {
+
+	Program prog;
+	stringstream text(four_chains);
+	assert_equal_int(prog.load(text), 0, "test_sched_peak_live_values");
+
+	// in the original order, all four chains are live at once
+	vector<uint32_t> original_order;
+	for (uint32_t i = 0; i < prog.get_num_instructions(); i++) original_order.push_back(i);
+	uint64_t total_live_range;
+	assert_equal_int(peak_live_values(prog, original_order, &total_live_range), 5, "test_sched_peak_live_values");
+	assert_equal_int(total_live_range, 35, "test_sched_peak_live_values");
+
+	// the schedule finishes one chain before starting the next
+	vector<uint32_t> order = schedule_instructions(prog);
+	assert_equal_int(order.size(), 11, "test_sched_peak_live_values");
+	uint32_t expected_order[11] = {0, 4, 1, 5, 8, 2, 6, 3, 7, 9, 10};
+	for (int i = 0; i < 11; i++) {
+		assert_equal_int(order[i], expected_order[i], "test_sched_peak_live_values");
+	}
+	assert_equal_int(peak_live_values(prog, order, &total_live_range), 4, "test_sched_peak_live_values");
+	assert_equal_int(total_live_range, 27, "test_sched_peak_live_values");
+
+	pass("test_sched_peak_live_values");
+
+}
+
+
+void test_sched_schedule_program() {
+
+	stringstream text(four_chains), scheduled;
+	ScheduleReport report;
+	assert_equal_int(schedule_program(text, scheduled, &report), 0, "test_sched_schedule_program");
+
+	assert_equal_int(report.num_instructions, 11, "test_sched_schedule_program");
+	assert_equal_int(report.peak_live_before, 5, "test_sched_schedule_program");
+	assert_equal_int(report.peak_live_after, 4, "test_sched_schedule_program");
+	assert_true(report.reordered, "The schedule is better", "test_sched_schedule_program");
+
+	// every declaration comes first, in its original order, and then the definitions, one chain at a time
+	string expected_lines[15] = {
+		"declare input x", "declare output y",
+		"declare intvar a1", "declare intvar a2", "declare intvar b1", "declare intvar b2",
+		"declare intvar c1", "declare intvar c2", "declare intvar d1", "declare intvar d2",
+		"declare intvar s1", "declare intvar s2",
+		"define a1 = exp x", "define a2 = mul a1 2", "define b1 = exp x"
+	};
+	string line;
+	for (int i = 0; i < 15; i++) {
+		getline(scheduled, line);
+		assert_equal_string(line, expected_lines[i], "test_sched_schedule_program");
+	}
+
+	// the scheduled program computes the same outputs
+	Program original, reordered;
+	stringstream original_text(four_chains), reordered_text(scheduled.str());
+	assert_equal_int(original.load(original_text), 0, "test_sched_schedule_program");
+	assert_equal_int(reordered.load(reordered_text), 0, "test_sched_schedule_program");
+	unordered_map<string, double> inputs = {{"x", 0.5}}, original_outputs, reordered_outputs;
+	assert_equal_int(original.execute(inputs, &original_outputs), 0, "test_sched_schedule_program");
+	assert_equal_int(reordered.execute(inputs, &reordered_outputs), 0, "test_sched_schedule_program");
+	assert_equal_double(reordered_outputs.at("y"), original_outputs.at("y"), "test_sched_schedule_program");
+
+	// and gives every variable the slot it had
+	const char *names[] = {"x", "y", "a1", "b1", "c1", "d1", "a2", "b2", "c2", "d2", "s1", "s2"};
+	for (int i = 0; i < 12; i++) {
+		assert_equal_int(reordered.get_slot(Symbol::find(names[i])), original.get_slot(Symbol::find(names[i])), "test_sched_schedule_program");
+	}
+
+	// errors in the program are caught
+	stringstream bad_text("declare input x\ndefine y = exp x\n"), bad_scheduled;
+	assert_equal_int(schedule_program(bad_text, bad_scheduled, NULL), VAR_DEFINED_BEFORE_DECLARED, "test_sched_schedule_program");
+	assert_equal_int(schedule_program("tests/test_files/inputs/not_a_file.tf", "scratch.tf", NULL), INVALID_FILE_NAME, "test_sched_schedule_program");
+
+	pass("test_sched_schedule_program");
+
+}
+
+
+void test_sched_keeps_better_order() {
+
+	// a program that is already in the best order is left alone
+	string chain = "declare input x\ndeclare intvar a\ndefine a = exp x\ndeclare output y\ndefine y = exp a\n";
+	stringstream text(chain), scheduled;
+	ScheduleReport report;
+	assert_equal_int(schedule_program(text, scheduled, &report), 0, "test_sched_keeps_better_order");
+	assert_equal_int(report.peak_live_before, report.peak_live_after, "test_sched_keeps_better_order");
+	assert_true(report.total_live_range_after <= report.total_live_range_before, "The schedule is no worse", "test_sched_keeps_better_order");
+	assert_equal_string(scheduled.str(), chain, "test_sched_keeps_better_order");
+
+	pass("test_sched_keeps_better_order");
+
+}
+
+
+void test_sched_keeps_vector_instructions() {
+
+	// eight chains over the components of vectors, defined breadth-first, and summed at the end
+	int dimension = 8;
+	stringstream text, scheduled;
+	for (int i = 0; i < dimension; i++) text << "declare input x." << i << endl;
+	for (int i = 0; i < dimension; i++) text << "declare intvar a." << i << endl;
+	for (int i = 0; i < dimension; i++) text << "declare intvar b." << i << endl;
+	for (int i = 1; i < dimension; i++) text << "declare intvar s" << i << endl;
+	text << "declare output y" << endl;
+	for (int i = 0; i < dimension; i++) text << "define a." << i << " = exp x." << i << endl;
+	for (int i = 0; i < dimension; i++) text << "define b." << i << " = mul a." << i << " 2" << endl;
+	text << "define s1 = add b.0 b.1" << endl;
+	for (int i = 2; i < dimension; i++) text << "define s" << i << " = add s" << (i - 1) << " b." << i << endl;
+	text << "define y = exp s" << (dimension - 1) << endl;
+
+	string original_text = text.str();
+	ScheduleReport report;
+	assert_equal_int(schedule_program(text, scheduled, &report), 0, "test_sched_keeps_vector_instructions");
+
+	// the lanes of each Vector Instruction are scheduled together, so the scheduled program packs just as well
+	Program original, reordered;
+	stringstream original_stream(original_text), reordered_stream(scheduled.str());
+	assert_equal_int(original.load(original_stream), 0, "test_sched_keeps_vector_instructions");
+	assert_equal_int(reordered.load(reordered_stream), 0, "test_sched_keeps_vector_instructions");
+	assert_equal_int(original.get_vector_instructions().size(), 2 + dimension, "test_sched_keeps_vector_instructions");
+	assert_equal_int(reordered.get_vector_instructions().size(), original.get_vector_instructions().size(), "test_sched_keeps_vector_instructions");
+
+	unordered_map<string, double> inputs, original_outputs, reordered_outputs;
+	for (int i = 0; i < dimension; i++) inputs["x." + to_string(i)] = 0.1 * i;
+	assert_equal_int(original.execute(inputs, &original_outputs), 0, "test_sched_keeps_vector_instructions");
+	assert_equal_int(reordered.execute(inputs, &reordered_outputs), 0, "test_sched_keeps_vector_instructions");
+	assert_equal_double(reordered_outputs.at("y"), original_outputs.at("y"), "test_sched_keeps_vector_instructions");
+
+	pass("test_sched_keeps_vector_instructions");
+
+}
+
+
+void test_sched_gcp() {
+
+	// schedule a GCP in place, and check that it computes the same partials
+	ifstream gcp("tests/test_files/inputs/small_net_gcp.tf");
+	ofstream scratch("scratch.tf");
+	scratch << gcp.rdbuf();
+	gcp.close();
+	scratch.close();
+
+	ScheduleReport report;
+	assert_equal_int(schedule_program("scratch.tf", "scratch.tf", &report), 0, "test_sched_gcp");
+	assert_true(report.peak_live_after <= report.peak_live_before, "Scheduling never adds live values", "test_sched_gcp");
+	assert_true(report.total_live_range_after < report.total_live_range_before, "Scheduling shortens live ranges", "test_sched_gcp");
+
+	unordered_map<string, double> inputs = {
+		{"a", 1}, {"b", 2}, {"c", 3},
+		{"f", 0.35}, {"g", 0.24}, {"h", 0.08},
+		{"m", 0.6}, {"n", 0.55}, {"p", 0.57}
+	};
+	Program original, scheduled;
+	unordered_map<string, double> original_partials, scheduled_partials;
+	assert_equal_int(original.load("tests/test_files/inputs/small_net_gcp.tf"), 0, "test_sched_gcp");
+	assert_equal_int(scheduled.load("scratch.tf"), 0, "test_sched_gcp");
+	assert_equal_int(scheduled.get_num_instructions(), original.get_num_instructions(), "test_sched_gcp");
+	assert_equal_int(original.execute(inputs, &original_partials), 0, "test_sched_gcp");
+	assert_equal_int(scheduled.execute(inputs, &scheduled_partials), 0, "test_sched_gcp");
+	assert_equal_int(scheduled_partials.size(), 3, "test_sched_gcp");
+	for (unordered_map<string, double>::iterator it = original_partials.begin(); it != original_partials.end(); ++it) {
+		assert_equal_double(scheduled_partials.at(it->first), it->second, "test_sched_gcp");
+	}
+
+	pass("test_sched_gcp");
+
+}
+
+
+void test_sched_deep_program() {
+
+	// a long chain of definitions cannot overflow the call stack
+	int depth = 100000;
+	stringstream text, scheduled;
+	text << "declare input v0" << endl;
+	for (int i = 1; i <= depth; i++) {
+		text << "declare intvar v" << i << endl;
+		text << "define v" << i << " = add v" << (i - 1) << " 1" << endl;
+	}
+
+	ScheduleReport report;
+	assert_equal_int(schedule_program(text, scheduled, &report), 0, "test_sched_deep_program");
+	assert_equal_int(report.num_instructions, depth, "test_sched_deep_program");
+	assert_equal_int(report.peak_live_after, 2, "test_sched_deep_program");
+
+	pass("test_sched_deep_program");
+
+}
+
+
+
+void run_sched_tests() {
+
+	cout << "\nTesting Scheduler... " << endl << endl;
+
+	test_sched_peak_live_values();
+	test_sched_schedule_program();
+	test_sched_keeps_better_order();
+	test_sched_keeps_vector_instructions();
+	test_sched_gcp();
+	test_sched_deep_program();
+
+	cout << "\nAll Scheduler Tests Passed." << endl << endl;
+}
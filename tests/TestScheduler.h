@@ -0,0 +1,21 @@
+#ifndef TEST_SCHEDULER_H
+#define TEST_SCHEDULER_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for the Scheduler. */
+
+void test_sched_peak_live_values();
+void test_sched_schedule_program();
+void test_sched_keeps_better_order();
+void test_sched_keeps_vector_instructions();
+void test_sched_gcp();
+void test_sched_deep_program();
+
+void run_sched_tests();
+
+
+#endif
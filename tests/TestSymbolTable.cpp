@@ -0,0 +1,199 @@
+#include <iostream>
+#include <string.h>
+#include <unordered_map>
+
+#include "TestSymbolTable.h"
+#include "TestUtilities.h"
+#include "../src/SymbolTable.h"
+#include "../src/Symbol.h"
+
+using namespace std;
+
+
+void test_arena_allocate() {
+
+	Arena arena;
+	assert_equal_int(arena.get_bytes_allocated(), 0, "test_arena_allocate");
+	assert_equal_int(arena.get_bytes_reserved(), 0, "test_arena_allocate");
+
+	// allocations are aligned, and come from the same block
+	char *c = arena.allocate_array<char>(3);
+	double *d = arena.allocate_array<double>(2);
+	assert_true(reinterpret_cast<uintptr_t>(d) % alignof(double) == 0, "Doubles should be aligned", "test_arena_allocate");
+	assert_true((char *) d > c && (char *) d < c + 16, "Small allocations should be consecutive", "test_arena_allocate");
+	assert_equal_int(arena.get_bytes_allocated(), 3 + 2 * sizeof(double), "test_arena_allocate");
+	assert_equal_int(arena.get_bytes_reserved(), ARENA_BLOCK_SIZE, "test_arena_allocate");
+
+	// large allocations get their own block
+	char *big = arena.allocate_array<char>(ARENA_BLOCK_SIZE);
+	memset(big, 1, ARENA_BLOCK_SIZE);
+	assert_equal_int(arena.get_bytes_reserved(), 2 * ARENA_BLOCK_SIZE, "test_arena_allocate");
+
+	pass("test_arena_allocate");
+
+}
+
+void test_arena_chunked_array() {
+
+	Arena arena;
+	ChunkedArray<uint32_t> a(&arena);
+	assert_equal_int(a.get_size(), 0, "test_arena_chunked_array");
+
+	// fill several chunks
+	int n = 3 * CHUNK_SIZE + 5;
+	for (int i = 0; i < n; i++) a.push_back(i * 7);
+	assert_equal_int(a.get_size(), n, "test_arena_chunked_array");
+
+	// elements never move when the array grows
+	uint32_t *first = &a[0];
+	a.push_back(17);
+	assert_true(first == &a[0], "Elements should not move", "test_arena_chunked_array");
+	for (int i = 0; i < n; i++) assert_equal_int(a[i], i * 7, "test_arena_chunked_array");
+	assert_equal_int(a[n], 17, "test_arena_chunked_array");
+
+	pass("test_arena_chunked_array");
+
+}
+
+void test_st_intern() {
+
+	Arena arena;
+	SymbolTable st(&arena);
+	assert_equal_int(st.get_num_symbols(), 0, "test_st_intern");
+
+	// ids are dense, in order of first appearance
+	assert_equal_int(st.intern("foo"), 0, "test_st_intern");
+	assert_equal_int(st.intern("bar"), 1, "test_st_intern");
+	assert_equal_int(st.intern("foo"), 0, "test_st_intern");
+	assert_equal_int(st.intern(string("d/lambda/d/foo")), 2, "test_st_intern");
+	assert_equal_int(st.get_num_symbols(), 3, "test_st_intern");
+
+	// names are copied, so the caller's buffer can be reused
+	char buffer[8] = "foobar";
+	assert_equal_int(st.intern(buffer, 3), 0, "test_st_intern");
+	assert_equal_int(st.intern(buffer + 3, 3), 1, "test_st_intern");
+	assert_equal_int(st.intern(buffer, 6), 3, "test_st_intern");
+	buffer[0] = 'g';
+	assert_equal_string(st.get_name(3), "foobar", "test_st_intern");
+	assert_equal_string(st.get_name(2), "d/lambda/d/foo", "test_st_intern");
+
+	pass("test_st_intern");
+
+}
+
+void test_st_find() {
+
+	Arena arena;
+	SymbolTable st(&arena);
+	assert_true(st.find("foo") == INVALID_SYMBOL_ID, "FOO has not been interned", "test_st_find");
+	st.intern("foo");
+	st.intern("");
+	assert_equal_int(st.find("foo"), 0, "test_st_find");
+	assert_equal_int(st.find(""), 1, "test_st_find");
+
+	// prefixes and extensions of interned names are different names
+	assert_true(st.find("fo") == INVALID_SYMBOL_ID, "FO has not been interned", "test_st_find");
+	assert_true(st.find("fooo") == INVALID_SYMBOL_ID, "FOOO has not been interned", "test_st_find");
+
+	// find does not intern
+	assert_equal_int(st.get_num_symbols(), 2, "test_st_find");
+
+	pass("test_st_find");
+
+}
+
+void test_st_grow() {
+
+	// intern enough names to grow the table many times
+	Arena arena;
+	SymbolTable st(&arena);
+	int n = 100000;
+	for (int i = 0; i < n; i++) {
+		assert_equal_int(st.intern("x." + to_string(i)), i, "test_st_grow");
+	}
+	for (int i = 0; i < n; i++) {
+		assert_equal_int(st.find("x." + to_string(i)), i, "test_st_grow");
+	}
+	assert_equal_string(st.get_name(n - 1), "x." + to_string(n - 1), "test_st_grow");
+	assert_equal_int(st.get_num_symbols(), n, "test_st_grow");
+
+	pass("test_st_grow");
+
+}
+
+
+void test_symbol() {
+
+	// invalid symbols have no name
+	Symbol invalid;
+	assert_false(invalid.is_valid(), "Default symbols are invalid", "test_symbol");
+	assert_equal_string(invalid.str(), "", "test_symbol");
+
+	// symbols with the same name are equal, whichever way they were built
+	Symbol foo("sym_foo"), foo_again(string("sym_foo")), foo_prefix("sym_foo_bar", 7);
+	assert_true(foo.is_valid(), "FOO should be valid", "test_symbol");
+	assert_true(foo == foo_again && foo == foo_prefix, "Symbols of the same name are equal", "test_symbol");
+	assert_true(foo != Symbol("sym_bar"), "Symbols of different names are different", "test_symbol");
+	assert_equal_string(foo.str(), "sym_foo", "test_symbol");
+	assert_true(Symbol::from_id(foo.get_id()) == foo, "FROM_ID should give back FOO", "test_symbol");
+	assert_true(get_global_symbol_table()->find("sym_foo") == foo.get_id(), "FOO is in the global table", "test_symbol");
+
+	// find never interns
+	assert_false(Symbol::find("sym_never_interned").is_valid(), "SYM_NEVER_INTERNED was never interned", "test_symbol");
+	assert_true(Symbol::find("sym_foo") == foo, "FIND should find FOO", "test_symbol");
+
+	// symbols can key hash tables, and be looked up by string
+	unordered_map<Symbol, int> table;
+	table["sym_foo"] = 3;
+	assert_equal_int(table.count(foo), 1, "test_symbol");
+	assert_equal_int(table.at(string("sym_foo")), 3, "test_symbol");
+
+	pass("test_symbol");
+
+}
+
+void test_symbol_derived_names() {
+
+	Symbol loss("sym_lambda"), w("sym_w"), vec("sym_vec");
+
+	assert_equal_string(generate_partial_var_symbol(loss, w).str(), "d/sym_lambda/d/sym_w", "test_symbol_derived_names");
+	assert_equal_string(generate_intvar_symbol(w, 17).str(), "sym_w:17", "test_symbol_derived_names");
+	assert_equal_string(generate_intvar_symbol(w, 0).str(), "sym_w:0", "test_symbol_derived_names");
+	assert_equal_string(generate_vector_component_symbol(vec, 120).str(), "sym_vec.120", "test_symbol_derived_names");
+
+	// derived names are interned like any other name
+	assert_true(generate_partial_var_symbol(loss, w) == Symbol("d/sym_lambda/d/sym_w"), "Partial names are interned", "test_symbol_derived_names");
+
+	// asking again hits the cache, and interns nothing new
+	uint32_t num_symbols = get_global_symbol_table()->get_num_symbols();
+	for (int i = 0; i < 100; i++) {
+		generate_partial_var_symbol(loss, w);
+		generate_intvar_symbol(w, 17);
+		generate_vector_component_symbol(vec, 120);
+	}
+	assert_equal_int(get_global_symbol_table()->get_num_symbols(), num_symbols, "test_symbol_derived_names");
+
+	// invalid arguments give invalid symbols
+	assert_false(generate_partial_var_symbol(Symbol(), w).is_valid(), "Invalid arguments give an invalid symbol", "test_symbol_derived_names");
+	assert_false(generate_partial_var_symbol(loss, Symbol("")).is_valid(), "Empty names give an invalid symbol", "test_symbol_derived_names");
+	assert_false(generate_intvar_symbol(w, -1).is_valid(), "Negative numbers give an invalid symbol", "test_symbol_derived_names");
+	assert_false(generate_vector_component_symbol(vec, -1).is_valid(), "Negative numbers give an invalid symbol", "test_symbol_derived_names");
+
+	pass("test_symbol_derived_names");
+
+}
+
+
+void run_st_tests() {
+	cout << "\nTesting SymbolTable Class... " << endl << endl;
+
+	test_arena_allocate();
+	test_arena_chunked_array();
+	test_st_intern();
+	test_st_find();
+	test_st_grow();
+	test_symbol();
+	test_symbol_derived_names();
+
+	cout << "\nAll SymbolTable Tests Passed." << endl << endl;
+}
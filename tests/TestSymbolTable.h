@@ -0,0 +1,22 @@
+#ifndef TEST_SYMBOLTABLE_H
+#define TEST_SYMBOLTABLE_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for the Arena, ChunkedArray, SymbolTable and Symbol classes. */
+
+void test_arena_allocate();
+void test_arena_chunked_array();
+void test_st_intern();
+void test_st_find();
+void test_st_grow();
+void test_symbol();
+void test_symbol_derived_names();
+
+void run_st_tests();
+
+
+#endif
@@ -0,0 +1,607 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include "TestTrainer.h"
+#include "../src/Trainer.h"
+#include "TestUtilities.h"
+
+using namespace std;
+
+
+
+void test_train_build() {
+
+	Trainer t;
+	TrainOptions options;
+	options.gcp_filename = "scratch.tf";
+	options.schedule = false;
+	assert_equal_int(t.build("tests/test_files/inputs/small_net_shape.tf", options), 0, "test_train_build");
+
+	// the weights of the shape program, and the partials of the loss with respect to them
+	vector<string> weight_names = t.get_weight_names();
+	vector<string> partial_names = t.get_partial_names();
+	assert_equal_int(weight_names.size(), 3, "test_train_build");
+	assert_equal_int(partial_names.size(), 3, "test_train_build");
+	for (size_t i = 0; i < weight_names.size(); i++) {
+		assert_equal_string(partial_names[i], "d/LAMBDA/d/" + weight_names[i], "test_train_build");
+	}
+
+	// the GCP is loaded, and was also written out because it was asked for
+	assert_equal_int(t.get_gcp()->get_output_slots().size(), 3, "test_train_build");
+	assert_identical_files("scratch.tf", "tests/test_files/outputs/small_net_gcp.tf", "test_train_build");
+
+	// a Trainer only builds one program
+	assert_equal_int(t.build("tests/test_files/inputs/small_net_shape.tf", options), OTHER_ERROR, "test_train_build");
+
+	pass("test_train_build");
+
+}
+
+
+void test_train_build_errors() {
+
+	TrainOptions options;
+
+	Trainer missing_file;
+	assert_equal_int(missing_file.build("tests/test_files/inputs/not_a_file.tf", options), INVALID_FILE_NAME, "test_train_build_errors");
+
+	// errors from the Preprocessor and the Compiler are passed on
+	Trainer bad_line;
+	stringstream bad_prog("declare input x\ndeclare input x\n");
+	assert_equal_int(bad_line.build(bad_prog, options), VAR_DECLARED_TWICE, "test_train_build_errors");
+
+	// a program must have a loss to minimize
+	Trainer no_loss;
+	stringstream no_loss_prog("declare input x\ndeclare weight w\ndeclare output y\ndefine y = mul x w\n");
+	assert_equal_int(no_loss.build(no_loss_prog, options), OTHER_ERROR, "test_train_build_errors");
+
+	// every weight must affect the loss
+	Trainer unused_weight;
+	stringstream unused_weight_prog(
+		"declare input x\ndeclare weight w\ndeclare weight v\ndeclare intvar y\ndeclare loss L\n"
+		"define y = mul x w\ndefine L = mul y y\n"
+	);
+	assert_equal_int(unused_weight.build(unused_weight_prog, options), OTHER_ERROR, "test_train_build_errors");
+
+	// but a weight the loss uses directly, and through another variable, does
+	Trainer direct_weight;
+	stringstream direct_weight_prog("declare input x\ndeclare weight w\ndeclare intvar z\ndefine z = mul x w\ndeclare loss L\ndefine L = mul z w\n");
+	assert_equal_int(direct_weight.build(direct_weight_prog, options), 0, "test_train_build_errors");
+
+	pass("test_train_build_errors");
+
+}
+
+
+void test_train_parse_training_data() {
+
+	Trainer t;
+	TrainOptions options;
+	vector<pair<VariableVector, VariableVector> > training_data;
+
+	// training data can't be parsed before there is a program
+	stringstream early("a\t1\n");
+	assert_equal_int(t.parse_training_data(early, &training_data), OTHER_ERROR, "test_train_parse_training_data");
+
+	assert_equal_int(t.build("tests/test_files/inputs/small_net_shape.tf", options), 0, "test_train_parse_training_data");
+
+	// two data, the second not followed by an empty line
+	stringstream data("a\t1\nb\t2\nc\t3\nm\t0.5\nn\t0.6\np\t0.7\n\n\nc\t1\nb\t1\na\t1\nm\t0\nn\t0\np\t0");
+	assert_equal_int(t.parse_training_data(data, &training_data), 0, "test_train_parse_training_data");
+	assert_equal_int(training_data.size(), 2, "test_train_parse_training_data");
+	assert_equal_int(training_data[0].first.size(), 3, "test_train_parse_training_data");
+	assert_equal_double(training_data[0].first.at("b"), 2, "test_train_parse_training_data");
+	assert_equal_int(training_data[0].second.size(), 3, "test_train_parse_training_data");
+	assert_equal_double(training_data[0].second.at("p"), 0.7, "test_train_parse_training_data");
+
+	// weights and unknown names are not training data
+	stringstream weight("a\t1\nf\t2\n");
+	assert_equal_int(t.parse_training_data(weight, &training_data), INVALID_VAR_NAME, "test_train_parse_training_data");
+	stringstream unknown("a\t1\nnot_a_variable\t2\n");
+	assert_equal_int(t.parse_training_data(unknown, &training_data), INVALID_VAR_NAME, "test_train_parse_training_data");
+
+	// a datum gives every input and expected output once
+	stringstream twice("a\t1\na\t2\n");
+	assert_equal_int(t.parse_training_data(twice, &training_data), VAR_DEFINED_TWICE, "test_train_parse_training_data");
+	stringstream incomplete("a\t1\nb\t2\nc\t3\nm\t0.5\nn\t0.6\n\na\t1\n");
+	assert_equal_int(t.parse_training_data(incomplete, &training_data), INPUT_VALUE_NOT_PROVIDED, "test_train_parse_training_data");
+	stringstream incomplete_last("a\t1\n");
+	assert_equal_int(t.parse_training_data(incomplete_last, &training_data), INPUT_VALUE_NOT_PROVIDED, "test_train_parse_training_data");
+	stringstream bad_value("a\tone\n");
+	assert_equal_int(t.parse_training_data(bad_value, &training_data), INVALID_LINE, "test_train_parse_training_data");
+
+	pass("test_train_parse_training_data");
+
+}
+
+
+void test_train_pipeline() {
+
+	// learn the weights of the small net (see test_gd_calculate_weights) straight from its Shape Program
+	// the training data was generated with the weights f = 0.4, g = 0.2, h = 0.1
+	TrainOptions options;
+	VariableVector weights;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "tests/test_files/inputs/small_net_training_data.txt", options, &weights),
+		0, "test_train_pipeline");
+
+	assert_equal_int(weights.size(), 3, "test_train_pipeline");
+	assert_approximately_equal_double(weights.at("f"), 0.4, 0.03, "test_train_pipeline");
+	assert_approximately_equal_double(weights.at("g"), 0.2, 0.03, "test_train_pipeline");
+	assert_approximately_equal_double(weights.at("h"), 0.1, 0.03, "test_train_pipeline");
+
+	// missing training data
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "tests/test_files/inputs/not_a_file.txt", options, &weights),
+		INVALID_FILE_NAME, "test_train_pipeline");
+
+	// mini-batch stochastic gradient descent learns the same weights
+	options.stochastic = true;
+	options.sgd.batch_size = 3;
+	options.sgd.max_epochs = 400;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "tests/test_files/inputs/small_net_training_data.txt", options, &weights),
+		0, "test_train_pipeline");
+	assert_approximately_equal_double(weights.at("f"), 0.4, 0.03, "test_train_pipeline");
+	assert_approximately_equal_double(weights.at("g"), 0.2, 0.03, "test_train_pipeline");
+	assert_approximately_equal_double(weights.at("h"), 0.1, 0.03, "test_train_pipeline");
+
+	// and so do asynchronous threads, whose steps are counted
+	options.sgd.num_threads = 3;
+	HogwildStats stats;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "tests/test_files/inputs/small_net_training_data.txt", options, &weights,
+		&stats), 0, "test_train_pipeline");
+	assert_approximately_equal_double(weights.at("f"), 0.4, 0.03, "test_train_pipeline");
+	assert_approximately_equal_double(weights.at("h"), 0.1, 0.03, "test_train_pipeline");
+	assert_true(stats.num_steps > 0, "no asynchronous steps were counted", "test_train_pipeline");
+	options.optimizer.type = OptimizerType::MOMENTUM;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "tests/test_files/inputs/small_net_training_data.txt", options, &weights),
+		OTHER_ERROR, "test_train_pipeline");
+	options.sgd.num_threads = 1;
+
+	// stochastic training can be split between processes, through a parameter server, but not between threads as well
+	options.num_processes = 2;
+	options.optimizer.type = OptimizerType::GRADIENT_DESCENT;
+	ParameterServerStats server_stats;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "tests/test_files/inputs/small_net_training_data.txt", options, &weights,
+		NULL, &server_stats), 0, "test_train_pipeline");
+	assert_approximately_equal_double(weights.at("f"), 0.4, 0.03, "test_train_pipeline");
+	assert_approximately_equal_double(weights.at("h"), 0.1, 0.03, "test_train_pipeline");
+	assert_true(server_stats.num_updates > 0, "no server updates were counted", "test_train_pipeline");
+	options.sgd.num_threads = 2;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "tests/test_files/inputs/small_net_training_data.txt", options, &weights),
+		OTHER_ERROR, "test_train_pipeline");
+	options.sgd.num_threads = 1;
+
+	// and so can full-batch training
+	options.stochastic = false;
+	options.optimizer.type = OptimizerType::LBFGS;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "tests/test_files/inputs/small_net_training_data.txt", options, &weights),
+		0, "test_train_pipeline");
+	assert_approximately_equal_double(weights.at("f"), 0.4, 0.03, "test_train_pipeline");
+	assert_approximately_equal_double(weights.at("g"), 0.2, 0.03, "test_train_pipeline");
+	assert_approximately_equal_double(weights.at("h"), 0.1, 0.03, "test_train_pipeline");
+	options.num_processes = 1;
+
+	// and so does an adaptive Optimizer, but not one whose hyperparameters are out of range
+	options.stochastic = false;
+	options.optimizer.type = OptimizerType::ADAM;
+	options.optimizer.learning_rate = 0.01;
+	options.optimizer.max_iterations = 3000;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "tests/test_files/inputs/small_net_training_data.txt", options, &weights),
+		0, "test_train_pipeline");
+	assert_approximately_equal_double(weights.at("f"), 0.4, 0.03, "test_train_pipeline");
+	assert_approximately_equal_double(weights.at("g"), 0.2, 0.03, "test_train_pipeline");
+	assert_approximately_equal_double(weights.at("h"), 0.1, 0.03, "test_train_pipeline");
+	options.optimizer.learning_rate = -1;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "tests/test_files/inputs/small_net_training_data.txt", options, &weights),
+		OTHER_ERROR, "test_train_pipeline");
+
+	// training that is checkpointed, and resumed, learns the same weights, but not with L-BFGS, or in several processes
+	options.optimizer.learning_rate = 0.01;
+	VariableVector expected;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "tests/test_files/inputs/small_net_training_data.txt", options, &expected),
+		0, "test_train_pipeline");
+	remove("scratch.ckpt");
+	options.checkpoint.filename = "scratch.ckpt";
+	options.checkpoint.resume = true;
+	options.optimizer.max_iterations = 1000;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "tests/test_files/inputs/small_net_training_data.txt", options, &weights),
+		0, "test_train_pipeline");
+	options.optimizer.max_iterations = 3000;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "tests/test_files/inputs/small_net_training_data.txt", options, &weights),
+		0, "test_train_pipeline");
+	assert_equal_double(weights.at("f"), expected.at("f"), "test_train_pipeline");
+	assert_equal_double(weights.at("h"), expected.at("h"), "test_train_pipeline");
+	options.num_processes = 2;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "tests/test_files/inputs/small_net_training_data.txt", options, &weights),
+		OTHER_ERROR, "test_train_pipeline");
+	options.num_processes = 1;
+	options.optimizer.type = OptimizerType::LBFGS;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "tests/test_files/inputs/small_net_training_data.txt", options, &weights),
+		OTHER_ERROR, "test_train_pipeline");
+	remove("scratch.ckpt");
+
+	pass("test_train_pipeline");
+
+}
+
+
+
+void test_train_multiple_losses() {
+
+	// a least squares fit of y = w * x, with the penalty B = w^2 on the weight
+	string prog = "declare input x\ndeclare weight w\ndeclare exp_output y\n"
+		"declare intvar z\ndefine z = mul x w\ndeclare intvar e\ndefine e = sub z y\n"
+		"declare loss A\ndefine A = pow e 2\ndeclare loss B\ndefine B = pow w 2\n";
+	string data = "x\t1\ny\t2\n\nx\t2\ny\t4\n\nx\t0.5\ny\t1\n";
+
+	// without the penalty, y = 2x fits exactly
+	Trainer unpenalized;
+	TrainOptions options;
+	options.loss_seeds["B"] = 0;
+	stringstream prog_text(prog), data_text(data);
+	assert_equal_int(unpenalized.build(prog_text, options), 0, "test_train_multiple_losses");
+	assert_equal_string(unpenalized.get_partial_names()[0], "d/total/objective/d/w", "test_train_multiple_losses");
+
+	vector<pair<VariableVector, VariableVector> > training_data;
+	assert_equal_int(unpenalized.parse_training_data(data_text, &training_data), 0, "test_train_multiple_losses");
+	assert_equal_int(training_data.size(), 3, "test_train_multiple_losses");
+	assert_equal_double(training_data[0].first.at("s/A"), 1, "test_train_multiple_losses");
+	assert_equal_double(training_data[0].first.at("s/B"), 0, "test_train_multiple_losses");
+
+	VariableVector weights;
+	assert_equal_int(unpenalized.train(training_data, &weights), 0, "test_train_multiple_losses");
+	assert_approximately_equal_double(weights.at("w"), 2, 0.01, "test_train_multiple_losses");
+
+	// with the penalty, the average gradient 2 * avg(x^2) * w - 2 * avg(x * y) + 2 * w is 0 at w = 3.5 / 2.75
+	Trainer penalized;
+	stringstream penalized_prog_text(prog), penalized_data_text(data);
+	training_data.clear();
+	assert_equal_int(penalized.build(penalized_prog_text, TrainOptions()), 0, "test_train_multiple_losses");
+	assert_equal_int(penalized.parse_training_data(penalized_data_text, &training_data), 0, "test_train_multiple_losses");
+	assert_equal_int(penalized.train(training_data, &weights), 0, "test_train_multiple_losses");
+	assert_approximately_equal_double(weights.at("w"), 3.5 / 2.75, 0.01, "test_train_multiple_losses");
+
+	// L-BFGS minimizes the combined objective, summed from the seeded losses, to the same weight
+	Trainer lbfgs;
+	TrainOptions lbfgs_options;
+	lbfgs_options.optimizer.type = OptimizerType::LBFGS;
+	lbfgs_options.optimizer.gradient_precision = 1e-9;
+	stringstream lbfgs_prog_text(prog);
+	assert_equal_int(lbfgs.build(lbfgs_prog_text, lbfgs_options), 0, "test_train_multiple_losses");
+	assert_equal_int(lbfgs.train(training_data, &weights), 0, "test_train_multiple_losses");
+	assert_approximately_equal_double(weights.at("w"), 3.5 / 2.75, 1e-8, "test_train_multiple_losses");
+
+	vector<ObjectiveTerm> objective;
+	assert_equal_int(find_objective_terms(*lbfgs.get_gcp(), lbfgs.get_partial_names(), &objective), 0, "test_train_multiple_losses");
+	assert_equal_int(objective.size(), 2, "test_train_multiple_losses");
+
+	Trainer stochastic_lbfgs;
+	stringstream stochastic_prog_text(prog);
+	lbfgs_options.stochastic = true;
+	assert_equal_int(stochastic_lbfgs.build(stochastic_prog_text, lbfgs_options), OTHER_ERROR, "test_train_multiple_losses");
+
+	// seeds are only for losses, and only when there are several
+	Trainer bad_seed;
+	stringstream bad_seed_prog_text(prog);
+	options.loss_seeds["e"] = 1;
+	assert_equal_int(bad_seed.build(bad_seed_prog_text, options), OTHER_ERROR, "test_train_multiple_losses");
+
+	Trainer one_loss;
+	TrainOptions one_loss_options;
+	one_loss_options.loss_seeds["LAMBDA"] = 1;
+	assert_equal_int(one_loss.build("tests/test_files/inputs/small_net_shape.tf", one_loss_options), OTHER_ERROR, "test_train_multiple_losses");
+
+	pass("test_train_multiple_losses");
+
+}
+
+
+
+void test_train_tree_reductions() {
+
+	// the squared error of a linear model over six inputs, whose dot product can be a chain or a tree
+	string prog = "declare_vector input x 6\ndeclare_vector weight w 6\ndeclare exp_output y\n"
+		"declare intvar z\ndefine z = dot x w\ndeclare intvar e\ndefine e = sub z y\ndeclare loss L\ndefine L = pow e 2\n";
+
+	Trainer chain, tree;
+	TrainOptions options;
+	stringstream chain_prog(prog), tree_prog(prog);
+	assert_equal_int(chain.build(chain_prog, options), 0, "test_train_tree_reductions");
+	options.tree_reductions = true;
+	assert_equal_int(tree.build(tree_prog, options), 0, "test_train_tree_reductions");
+
+	// a tree has as many sums as a chain, and gives the same partials
+	assert_equal_int(tree.get_gcp()->get_num_instructions(), chain.get_gcp()->get_num_instructions(), "test_train_tree_reductions");
+
+	unordered_map<string, double> inputs = {{"y", 1}};
+	for (int i = 0; i < 6; i++) {
+		inputs["x." + to_string(i)] = 0.5 * i - 1;
+		inputs["w." + to_string(i)] = 0.1 * i;
+	}
+	unordered_map<string, double> chain_outputs, tree_outputs;
+	assert_equal_int(chain.get_gcp()->execute(inputs, &chain_outputs), 0, "test_train_tree_reductions");
+	assert_equal_int(tree.get_gcp()->execute(inputs, &tree_outputs), 0, "test_train_tree_reductions");
+	for (size_t i = 0; i < chain.get_partial_names().size(); i++) {
+		const string& partial = chain.get_partial_names()[i];
+		assert_approximately_equal_double(tree_outputs.at(partial), chain_outputs.at(partial), 1e-9, "test_train_tree_reductions");
+	}
+
+	pass("test_train_tree_reductions");
+
+}
+
+
+
+void test_train_vectorized_gcp() {
+
+	// with the default options the GCP is scheduled, and its vector operations are still packed into Vector Instructions
+	string prog = "declare_vector input x 64\ndeclare_vector weight w 64\ndeclare_vector input b 64\ndeclare exp_output y\n"
+		"declare_vector intvar z 64\ndefine_vector z = mul x w\ndeclare_vector intvar q 64\ndefine_vector q = add z b\n"
+		"declare intvar s\ndefine s = dot q w\ndeclare intvar e\ndefine e = sub s y\ndeclare loss L\ndefine L = pow e 2\n";
+
+	Trainer scheduled, unscheduled;
+	TrainOptions options;
+	stringstream scheduled_prog(prog), unscheduled_prog(prog);
+	assert_true(options.schedule, "The GCP is scheduled by default", "test_train_vectorized_gcp");
+	assert_equal_int(scheduled.build(scheduled_prog, options), 0, "test_train_vectorized_gcp");
+	const Program *gcp = scheduled.get_gcp();
+	assert_true(gcp->get_vector_instructions().size() < gcp->get_num_instructions(), "The scheduled GCP is vectorized", "test_train_vectorized_gcp");
+
+	// it packs as many Instructions as the GCP in the order the Compiler wrote it
+	options.schedule = false;
+	assert_equal_int(unscheduled.build(unscheduled_prog, options), 0, "test_train_vectorized_gcp");
+	assert_equal_int(gcp->get_vector_instructions().size(), unscheduled.get_gcp()->get_vector_instructions().size(), "test_train_vectorized_gcp");
+
+	pass("test_train_vectorized_gcp");
+
+}
+
+
+
+void test_train_sparse_data() {
+
+	// a linear model over a bag of six words, whose data only have a few of them
+	string prog = "declare_vector input x 6\ndeclare_vector weight w 6\ndeclare exp_output y\n"
+		"declare intvar z\ndefine z = dot x w\ndeclare intvar e\ndefine e = sub z y\ndeclare loss L\ndefine L = pow e 2\n";
+	string sparse_data_text = "x\t0:1 3:1\ny\t1\n\nx\t1:2\ny\t-1\n\ny\t0.5\nx\t0:1 1:1 3:0.5\n";
+	string dense_data_text =
+		"x.0\t1\nx.1\t0\nx.2\t0\nx.3\t1\nx.4\t0\nx.5\t0\ny\t1\n\n"
+		"x.0\t0\nx.1\t2\nx.2\t0\nx.3\t0\nx.4\t0\nx.5\t0\ny\t-1\n\n"
+		"x.0\t1\nx.1\t1\nx.2\t0\nx.3\t0.5\nx.4\t0\nx.5\t0\ny\t0.5\n";
+
+	Trainer t;
+	stringstream prog_text(prog);
+	assert_equal_int(t.build(prog_text, TrainOptions()), 0, "test_train_sparse_data");
+
+	// each datum's sparse vectors are kept sparse, alongside its other inputs and expected outputs
+	vector<pair<VariableVector, VariableVector> > training_data, dense_training_data;
+	vector<SparseVariableVector> sparse_data;
+	stringstream sparse_text(sparse_data_text), dense_text(dense_data_text);
+	assert_equal_int(t.parse_training_data(sparse_text, &training_data, &sparse_data), 0, "test_train_sparse_data");
+	assert_equal_int(t.parse_training_data(dense_text, &dense_training_data), 0, "test_train_sparse_data");
+	assert_equal_int(training_data.size(), 3, "test_train_sparse_data");
+	assert_equal_int(sparse_data.size(), 3, "test_train_sparse_data");
+	assert_equal_int(training_data[1].first.size(), 0, "test_train_sparse_data");
+	assert_equal_double(training_data[1].second.at("y"), -1, "test_train_sparse_data");
+	assert_equal_double(get_sparse_component(sparse_data[2].at("x"), 3), 0.5, "test_train_sparse_data");
+
+	// sparse data learns the weights dense data does, and the weights of words never seen stay 0
+	VariableVector sparse_weights, dense_weights;
+	assert_equal_int(t.train(training_data, sparse_data, &sparse_weights), 0, "test_train_sparse_data");
+	assert_equal_int(t.train(dense_training_data, &dense_weights), 0, "test_train_sparse_data");
+	for (int i = 0; i < 6; i++) {
+		string w = "w." + to_string(i);
+		assert_approximately_equal_double(sparse_weights.at(w), dense_weights.at(w), 1e-6, "test_train_sparse_data");
+	}
+	assert_equal_double(sparse_weights.at("w.4"), 0, "test_train_sparse_data");
+
+	// the dense parser refuses sparse lines, and a sparse vector must be one of the program's vectors, and fit in it
+	vector<SparseVariableVector> errors;
+	stringstream dense_only("x\t0:1\ny\t1\n");
+	assert_equal_int(t.parse_training_data(dense_only, &training_data), INVALID_LINE, "test_train_sparse_data");
+	stringstream not_data("w\t0:1\ny\t1\n");
+	assert_equal_int(t.parse_training_data(not_data, &training_data, &errors), INVALID_VAR_NAME, "test_train_sparse_data");
+	stringstream too_long("x\t6:1\ny\t1\n");
+	assert_equal_int(t.parse_training_data(too_long, &training_data, &errors), INVALID_VAR_NAME, "test_train_sparse_data");
+
+	// a component is given once, by itself or by its vector
+	stringstream twice("x\t0:1\nx\t1:1\ny\t1\n");
+	assert_equal_int(t.parse_training_data(twice, &training_data, &errors), VAR_DEFINED_TWICE, "test_train_sparse_data");
+	stringstream dense_then_sparse("x.0\t1\nx\t1:1\ny\t1\n");
+	assert_equal_int(t.parse_training_data(dense_then_sparse, &training_data, &errors), VAR_DEFINED_TWICE, "test_train_sparse_data");
+	stringstream sparse_then_dense("x\t1:1\nx.0\t1\ny\t1\n");
+	assert_equal_int(t.parse_training_data(sparse_then_dense, &training_data, &errors), VAR_DEFINED_TWICE, "test_train_sparse_data");
+	stringstream incomplete("x\t1:1\n\ny\t1\n");
+	assert_equal_int(t.parse_training_data(incomplete, &training_data, &errors), INPUT_VALUE_NOT_PROVIDED, "test_train_sparse_data");
+
+	pass("test_train_sparse_data");
+
+}
+
+
+
+void test_train_streaming() {
+
+	// training from a record file streams it, and learns exactly the weights training on the same data in memory learns
+	vector<string> column_names = {"a", "b", "c", "m", "n", "p"};
+	Trainer t;
+	TrainOptions options;
+	vector<pair<VariableVector, VariableVector> > training_data;
+	assert_equal_int(t.build("tests/test_files/inputs/small_net_shape.tf", options), 0, "test_train_streaming");
+	assert_equal_int(t.parse_training_data("tests/test_files/inputs/small_net_training_data.txt", &training_data), 0, "test_train_streaming");
+	assert_equal_int(write_record_file("scratch.rec", column_names, training_data), 0, "test_train_streaming");
+
+	VariableVector expected, weights;
+	assert_equal_int(t.train(training_data, &expected), 0, "test_train_streaming");
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "scratch.rec", options, &weights), 0, "test_train_streaming");
+	assert_equal_int(weights.size(), 3, "test_train_streaming");
+	for (VariableVector::const_iterator it = expected.begin(); it != expected.end(); ++it) {
+		assert_true(weights.at(it->first) == it->second, "streamed weights are exactly those learned in memory", "test_train_streaming");
+	}
+
+	// and so does stochastic training, with checkpoints too, but not in several threads
+	options.stochastic = true;
+	options.sgd.batch_size = 3;
+	options.sgd.max_epochs = 400;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "scratch.rec", options, &weights), 0, "test_train_streaming");
+	assert_approximately_equal_double(weights.at("f"), 0.4, 0.03, "test_train_streaming");
+	assert_approximately_equal_double(weights.at("g"), 0.2, 0.03, "test_train_streaming");
+	assert_approximately_equal_double(weights.at("h"), 0.1, 0.03, "test_train_streaming");
+	options.sgd.num_threads = 2;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "scratch.rec", options, &weights), OTHER_ERROR, "test_train_streaming");
+	options.sgd.num_threads = 1;
+	options.checkpoint.filename = "scratch.ckpt";
+	VariableVector checkpointed;
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "scratch.rec", options, &checkpointed), 0, "test_train_streaming");
+	TrainingState state;
+	assert_equal_int(read_training_state("scratch.ckpt", &state), 0, "test_train_streaming");
+	assert_equal_int(state.epoch, 400, "test_train_streaming");
+	for (VariableVector::const_iterator it = checkpointed.begin(); it != checkpointed.end(); ++it) {
+		assert_true(weights.at(it->first) == it->second, "checkpoints do not change the weights learned", "test_train_streaming");
+	}
+	options.checkpoint.filename = "";
+	remove("scratch.ckpt");
+
+	// the seeds of several losses are bound once, for every datum
+	string prog = "declare input x\ndeclare weight w\ndeclare exp_output y\n"
+		"declare intvar z\ndefine z = mul x w\ndeclare intvar e\ndefine e = sub z y\n"
+		"declare loss A\ndefine A = pow e 2\ndeclare loss B\ndefine B = pow w 2\n";
+	Trainer penalized;
+	stringstream prog_text(prog);
+	assert_equal_int(penalized.build(prog_text, TrainOptions()), 0, "test_train_streaming");
+	vector<pair<VariableVector, VariableVector> > line_data = {{{{"x", 1}}, {{"y", 2}}}, {{{"x", 2}}, {{"y", 4}}}, {{{"x", 0.5}}, {{"y", 1}}}};
+	vector<string> line_columns = {"x", "y"};
+	assert_equal_int(write_record_file("scratch.rec", line_columns, line_data), 0, "test_train_streaming");
+	RecordFileSource source;
+	assert_equal_int(source.open("scratch.rec"), 0, "test_train_streaming");
+	assert_equal_int(penalized.train(&source, &weights), 0, "test_train_streaming");
+	assert_approximately_equal_double(weights.at("w"), 3.5 / 2.75, 0.01, "test_train_streaming");
+	source.close();
+
+	// every column must be an input or an expected output
+	vector<string> other_columns = {"x", "q"};
+	assert_equal_int(write_record_file("scratch.rec", other_columns, {{{{"x", 1}}, {{"q", 2}}}}), 0, "test_train_streaming");
+	assert_equal_int(source.open("scratch.rec"), 0, "test_train_streaming");
+	assert_equal_int(penalized.train(&source, &weights), INVALID_VAR_NAME, "test_train_streaming");
+	source.close();
+
+	remove("scratch.rec");
+	remove("scratch.ckpt");
+	pass("test_train_streaming");
+}
+
+
+void test_train_columnar() {
+
+	// training from a converted columnar file maps it, and learns exactly the weights training on the same data in memory learns
+	Trainer t;
+	TrainOptions options;
+	vector<pair<VariableVector, VariableVector> > training_data;
+	assert_equal_int(t.build("tests/test_files/inputs/small_net_shape.tf", options), 0, "test_train_columnar");
+	assert_equal_int(t.parse_training_data("tests/test_files/inputs/small_net_training_data.txt", &training_data), 0, "test_train_columnar");
+	ColumnarOptions columnar_options;
+	columnar_options.chunk_rows = 2;
+	assert_equal_int(t.convert_training_data("tests/test_files/inputs/small_net_training_data.txt", "scratch.col", columnar_options), 0,
+		"test_train_columnar");
+
+	// the columns are the inputs and expected outputs, in the order they are declared
+	ColumnarSource source;
+	assert_equal_int(source.open("scratch.col"), 0, "test_train_columnar");
+	assert_true(source.get_column_names() == vector<string>({"a", "b", "c", "m", "n", "p"}), "the columns are in declared order",
+		"test_train_columnar");
+	assert_true(source.get_column_kind(3) == VariableType::EXP_OUTPUT, "an expected output is one", "test_train_columnar");
+	assert_equal_int(source.get_num_records(), training_data.size(), "test_train_columnar");
+	source.close();
+
+	VariableVector expected, weights;
+	assert_equal_int(t.train(training_data, &expected), 0, "test_train_columnar");
+	assert_equal_int(train("tests/test_files/inputs/small_net_shape.tf", "scratch.col", options, &weights), 0, "test_train_columnar");
+	assert_equal_int(weights.size(), 3, "test_train_columnar");
+	for (VariableVector::const_iterator it = expected.begin(); it != expected.end(); ++it) {
+		assert_true(weights.at(it->first) == it->second, "mapped weights are exactly those learned in memory", "test_train_columnar");
+	}
+
+	// CSV data give the columns in any order, and convert to the same data
+	stringstream csv("p, a,b,c,m,n\n0.574443,1,2,3,0.598688,0.598688\n\n0.512497,2,1,0.5,0.689974,0.549834\n");
+	assert_equal_int(t.convert_csv_data(csv, "scratch.col", ColumnarOptions()), 0, "test_train_columnar");
+	assert_equal_int(source.open("scratch.col"), 0, "test_train_columnar");
+	assert_true(source.get_column_names() == vector<string>({"p", "a", "b", "c", "m", "n"}), "the columns are those of the CSV data",
+		"test_train_columnar");
+	DataBatch batch;
+	assert_equal_int(source.start_pass(4, NULL), 0, "test_train_columnar");
+	assert_equal_int(source.next_batch(&batch), 0, "test_train_columnar");
+	assert_equal_int(batch.num_rows, 2, "test_train_columnar");
+	assert_equal_double(batch.columns[0][1], 0.512497, "test_train_columnar");
+	assert_equal_double(batch.columns[3][1], 0.5, "test_train_columnar");
+	source.close();
+
+	// the header must name every input and expected output once, and every datum give a number for every column
+	stringstream unknown("a,b,c,m,n,q\n1,2,3,4,5,6\n"), twice("a,b,c,m,n,a\n"), missing("a,b,c,m,n\n"), short_line("a,b,c,m,n,p\n1,2,3\n");
+	stringstream not_number("a,b,c,m,n,p\n1,2,3,4,5,six\n");
+	assert_equal_int(t.convert_csv_data(unknown, "scratch.col", ColumnarOptions()), INVALID_VAR_NAME, "test_train_columnar");
+	assert_equal_int(t.convert_csv_data(twice, "scratch.col", ColumnarOptions()), VAR_DEFINED_TWICE, "test_train_columnar");
+	assert_equal_int(t.convert_csv_data(missing, "scratch.col", ColumnarOptions()), INPUT_VALUE_NOT_PROVIDED, "test_train_columnar");
+	assert_equal_int(t.convert_csv_data(short_line, "scratch.col", ColumnarOptions()), INVALID_LINE, "test_train_columnar");
+	assert_equal_int(t.convert_csv_data(not_number, "scratch.col", ColumnarOptions()), INVALID_LINE, "test_train_columnar");
+	assert_true(!is_columnar_file("scratch.col"), "a failed conversion leaves no file", "test_train_columnar");
+
+	// vectors given sparsely are written out whole, and the seeds of several losses have no columns
+	string prog = "declare_vector input x 3\ndeclare_vector weight w 3\ndeclare exp_output y\n"
+		"declare intvar z\ndefine z = dot x w\ndeclare intvar e\ndefine e = sub z y\n"
+		"declare loss A\ndefine A = pow e 2\ndeclare intvar v\ndefine v = dot w w\ndeclare loss B\ndefine B = mul v 0.01\n";
+	Trainer penalized;
+	stringstream prog_text(prog);
+	assert_equal_int(penalized.build(prog_text, TrainOptions()), 0, "test_train_columnar");
+	stringstream sparse_text("x\t2:4\ny\t1\n\nx.0\t1\nx.1\t2\nx.2\t3\ny\t0\n");
+	assert_equal_int(penalized.convert_training_data(sparse_text, "scratch.col", ColumnarOptions()), 0, "test_train_columnar");
+	assert_equal_int(source.open("scratch.col"), 0, "test_train_columnar");
+	assert_true(source.get_column_names() == vector<string>({"x.0", "x.1", "x.2", "y"}), "only data have columns", "test_train_columnar");
+	assert_equal_int(source.start_pass(4, NULL), 0, "test_train_columnar");
+	assert_equal_int(source.next_batch(&batch), 0, "test_train_columnar");
+	assert_equal_int(batch.num_rows, 2, "test_train_columnar");
+	assert_equal_double(batch.columns[0][0], 0, "test_train_columnar");
+	assert_equal_double(batch.columns[2][0], 4, "test_train_columnar");
+	assert_equal_double(batch.columns[1][1], 2, "test_train_columnar");
+	assert_equal_int(penalized.train(&source, &weights), 0, "test_train_columnar");
+	source.close();
+
+	// data are converted a batch at a time, and an error in a later batch still leaves no file
+	stringstream many_text, bad_text;
+	for (int i = 0; i < 10000; i++) {
+		many_text << "x\t0:" << i << "\ny\t" << -i << "\n\n";
+		bad_text << "x\t0:" << i << "\ny\t" << (i == 9000 ? "bad" : "0") << "\n\n";
+	}
+	assert_equal_int(penalized.convert_training_data(many_text, "scratch.col", ColumnarOptions()), 0, "test_train_columnar");
+	assert_equal_int(source.open("scratch.col"), 0, "test_train_columnar");
+	assert_equal_int(source.get_num_records(), 10000, "test_train_columnar");
+	assert_equal_int(source.start_pass(10000, NULL), 0, "test_train_columnar");
+	assert_equal_int(source.next_batch(&batch), 0, "test_train_columnar");
+	assert_equal_int(batch.num_rows, 10000, "test_train_columnar");
+	assert_equal_double(batch.columns[0][4096], 4096, "test_train_columnar");
+	assert_equal_double(batch.columns[3][9999], -9999, "test_train_columnar");
+	source.close();
+	assert_equal_int(penalized.convert_training_data(bad_text, "scratch.col", ColumnarOptions()), INVALID_LINE, "test_train_columnar");
+	assert_true(!is_columnar_file("scratch.col"), "a failed conversion leaves no file", "test_train_columnar");
+
+	remove("scratch.col");
+	pass("test_train_columnar");
+}
+
+
+void run_train_tests() {
+
+	cout << "\nTesting Trainer Class... " << endl << endl;
+
+	test_train_build();
+	test_train_build_errors();
+	test_train_parse_training_data();
+	test_train_pipeline();
+	test_train_multiple_losses();
+	test_train_tree_reductions();
+	test_train_vectorized_gcp();
+	test_train_sparse_data();
+	test_train_streaming();
+	test_train_columnar();
+
+	cout << "\nAll Trainer Tests Passed." << endl << endl;
+}
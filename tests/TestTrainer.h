@@ -0,0 +1,25 @@
+#ifndef TEST_TRAINER_H
+#define TEST_TRAINER_H
+
+#include "stdlib.h"
+
+using namespace std;
+
+
+/* Tests for the Trainer class, and the train pipeline. */
+
+void test_train_build();
+void test_train_build_errors();
+void test_train_parse_training_data();
+void test_train_pipeline();
+void test_train_multiple_losses();
+void test_train_tree_reductions();
+void test_train_vectorized_gcp();
+void test_train_sparse_data();
+void test_train_streaming();
+void test_train_columnar();
+
+void run_train_tests();
+
+
+#endif
@@ -47,10 +47,14 @@ declare intvar LAMBDA
 define LAMBDA = mul loss_two one_third
 declare intvar d/LAMBDA/d/LAMBDA
 define d/LAMBDA/d/LAMBDA = 1
-declare intvar d/LAMBDA/d/loss_two
+declare intvar d/LAMBDA/d/loss_two:edge
+declare intvar d/LAMBDA/d/one_third:edge
+define d/LAMBDA/d/loss_two:edge = one_third
+define d/LAMBDA/d/one_third:edge = loss_two
 declare intvar d/LAMBDA/d/one_third
-define d/LAMBDA/d/loss_two = one_third
-define d/LAMBDA/d/one_third = loss_two
+define d/LAMBDA/d/one_third = mul d/LAMBDA/d/LAMBDA d/LAMBDA/d/one_third:edge
+declare intvar d/LAMBDA/d/loss_two
+define d/LAMBDA/d/loss_two = mul d/LAMBDA/d/LAMBDA d/LAMBDA/d/loss_two:edge
 declare intvar d/loss_two/d/loss_one
 declare intvar d/loss_two/d/k_minus_p_squared
 define d/loss_two/d/loss_one = 1